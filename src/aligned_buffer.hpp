@@ -17,15 +17,20 @@
 
 #pragma once
 #include "waveform_config.hpp"
+#include <cassert>
 #include <cstddef>
 #include <type_traits>
 #include <memory>
 #include <new>
+#include <utility>
 
 // RAII uninitialized memory buffer with suitable alignment
 // for data processing on the target architecture.
-// 32-byte aligned on x86 with SIMD enabled,
+// WAVEFORM_BUFFER_ALIGNMENT (64 by default, a cache line and an AVX-512 vector) with SIMD enabled,
 // otherwise default alignment of operator new.
+// bind() makes it a view of memory it doesn't own instead, see BufferArena.
+// reset(count) keeps the storage it has when the count fits, unless that wastes over three quarters of it.
+// Indexing is bounds checked in debug builds.
 
 template<typename T>
 class AlignedBuffer
@@ -35,23 +40,49 @@ public:
     AlignedBuffer() = default;
     AlignedBuffer(const AlignedBuffer&) = delete;
     AlignedBuffer& operator=(const AlignedBuffer&) = delete;
-    AlignedBuffer(AlignedBuffer&&) = default;
-    AlignedBuffer& operator=(AlignedBuffer&&) = default;
+    AlignedBuffer(AlignedBuffer&& other) noexcept
+        : m_buf(std::move(other.m_buf)), m_size(std::exchange(other.m_size, 0)), m_capacity(std::exchange(other.m_capacity, 0)) {}
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept
+    {
+        m_buf = std::move(other.m_buf);
+        m_size = std::exchange(other.m_size, 0);
+        m_capacity = std::exchange(other.m_capacity, 0);
+        return *this;
+    }
     ~AlignedBuffer() = default;
 
-    T& operator[](std::size_t i) const { return m_buf[i]; }
+    T& operator[](std::size_t i) const
+    {
+        assert(i < m_size);
+        return m_buf[i];
+    }
     T *get() const noexcept { return m_buf.get(); }
+    std::size_t size() const noexcept { return m_size; } // elements, not bytes
+    std::size_t capacity() const noexcept { return m_capacity; } // elements owned, 0 when bound
     explicit operator bool() const noexcept { return static_cast<bool>(m_buf); }
 
-    void reset() { m_buf.reset(); }
-    void reset(std::size_t count) { m_buf.reset(alloc(count)); }
+    void reset() { m_buf.reset(); m_size = 0; m_capacity = 0; }
+    void reset(std::size_t count)
+    {
+        m_size = count;
+        if(m_buf && (count <= m_capacity) && (count >= m_capacity / 4))
+            return; // old contents are left, same as fresh uninitialized memory
+        m_buf.reset(alloc(count));
+        m_buf.get_deleter().owned = true;
+        m_capacity = count;
+    }
+
+    // point at memory owned elsewhere, see BufferArena
+    void bind(T *p, std::size_t count) { m_buf.reset(p); m_buf.get_deleter().owned = false; m_size = count; m_capacity = 0; }
 
 private:
-#ifdef ENABLE_X86_SIMD
-    static constexpr std::size_t ALIGNMENT = ((alignof(T) > 32u) ? alignof(T) : 32u);
+#if defined(ENABLE_X86_SIMD) || defined(ENABLE_ARM_SIMD)
+    static_assert((WAVEFORM_BUFFER_ALIGNMENT >= 32) && ((WAVEFORM_BUFFER_ALIGNMENT & (WAVEFORM_BUFFER_ALIGNMENT - 1)) == 0),
+        "WAVEFORM_BUFFER_ALIGNMENT must be a power of two of at least 32");
+    static constexpr std::size_t ALIGNMENT = ((alignof(T) > WAVEFORM_BUFFER_ALIGNMENT) ? alignof(T) : WAVEFORM_BUFFER_ALIGNMENT);
 #else
     static constexpr std::size_t ALIGNMENT = alignof(T);
-#endif // ENABLE_X86_SIMD
+#endif // ENABLE_X86_SIMD || ENABLE_ARM_SIMD
 
     T *alloc(std::size_t count)
     {
@@ -64,8 +95,12 @@ private:
     class Deleter
     {
     public:
+        bool owned = true;
+
         void operator()(void *p)
         {
+            if(!owned)
+                return;
             if constexpr (ALIGNMENT > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
                 ::operator delete(p, std::align_val_t{ ALIGNMENT });
             else
@@ -77,4 +112,6 @@ private:
     friend bool operator!=(const AlignedBuffer& a, std::nullptr_t) { return a.m_buf != nullptr; }
 
     std::unique_ptr<T[], Deleter> m_buf;
+    std::size_t m_size = 0;
+    std::size_t m_capacity = 0;
 };
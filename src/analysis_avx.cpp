@@ -0,0 +1,277 @@
+/*
+    Copyright (C) 2022 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "analysis_kernels.hpp"
+#include "simd_helpers.hpp"
+#include <immintrin.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+// see spectrum_bins in analysis_avx2.cpp
+template<bool POWER, bool SMOOTH, bool FAST_PEAKS, bool ACCUMULATE, bool PEAK, bool ONSET, bool PAIR>
+static void spectrum_bins(const SpectrumBins& args)
+{
+    constexpr auto step = sizeof(__m256) / sizeof(float);
+    constexpr auto channels = PAIR ? 2u : 1u;
+    constexpr auto shuffle_mask_r = 0 | (2 << 2) | (0 << 4) | (2 << 6);
+    constexpr auto shuffle_mask_i = 1 | (3 << 2) | (1 << 4) | (3 << 6);
+    const auto g = _mm256_set1_ps(args.gravity);
+    const auto g2 = _mm256_sub_ps(_mm256_set1_ps(1.0), g);
+    auto flux = _mm256_setzero_ps();
+    auto total = _mm256_setzero_ps();
+    for(size_t i = args.first_bin; i < args.last_bin; i += step)
+    {
+        const auto gain = _mm256_load_ps(&args.gains[i]); // window normalization, slope and roll-off
+        for(auto channel = 0u; channel < channels; ++channel)
+        {
+            const auto history = args.history[channel];
+            const auto out = args.out[channel];
+
+            // load 8 real/imaginary pairs and group the r/i components in the low/high halves
+            // de-interleaving 256-bit float vectors is nigh impossible without AVX2, so we'll
+            // use 128-bit vectors and merge them, but i question if this is better than a 128-bit loop
+            const float *buf = &args.in[channel][i][0];
+            auto chunk1 = _mm_load_ps(buf);
+            auto chunk2 = _mm_load_ps(&buf[4]);
+            auto rvec = _mm256_castps128_ps256(_mm_shuffle_ps(chunk1, chunk2, shuffle_mask_r)); // group octwords
+            auto ivec = _mm256_castps128_ps256(_mm_shuffle_ps(chunk1, chunk2, shuffle_mask_i));
+            chunk1 = _mm_load_ps(&buf[8]);
+            chunk2 = _mm_load_ps(&buf[12]);
+            rvec = _mm256_insertf128_ps(rvec, _mm_shuffle_ps(chunk1, chunk2, shuffle_mask_r), 1); // pack r/i octwords into separate 256-bit vecs
+            ivec = _mm256_insertf128_ps(ivec, _mm_shuffle_ps(chunk1, chunk2, shuffle_mask_i), 1);
+
+            auto mag = _mm256_fmadd_ps(ivec, ivec, _mm256_mul_ps(rvec, rvec)); // power r^2 + i^2
+            if constexpr(POWER)
+                mag = _mm256_mul_ps(mag, _mm256_mul_ps(gain, gain));
+            else
+                mag = _mm256_mul_ps(_mm256_sqrt_ps(mag), gain);
+
+            if constexpr(SMOOTH || ONSET)
+            {
+                auto oldval = _mm256_load_ps(&history[i]);
+                if constexpr(ONSET)
+                {
+                    flux = _mm256_add_ps(flux, _mm256_max_ps(_mm256_sub_ps(mag, oldval), _mm256_setzero_ps()));
+                    total = _mm256_add_ps(total, mag);
+                }
+                if constexpr(SMOOTH)
+                {
+                    if constexpr(FAST_PEAKS)
+                        oldval = _mm256_max_ps(mag, oldval);
+                    mag = _mm256_fmadd_ps(g, oldval, _mm256_mul_ps(g2, mag));
+                }
+                _mm256_store_ps(&history[i], mag);
+            }
+
+            if constexpr(ACCUMULATE)
+            {
+                const auto prev = _mm256_load_ps(&out[i]);
+                mag = PEAK ? _mm256_max_ps(mag, prev) : _mm256_add_ps(mag, prev);
+            }
+            _mm256_store_ps(&out[i], mag);
+        }
+    }
+    if constexpr(ONSET)
+    {
+        args.flux[0] += horizontal_sum(flux);
+        args.flux[1] += horizontal_sum(total);
+    }
+}
+
+// also used by the avx2 tier, there is nothing for AVX2 to improve on here
+template<bool POWER, bool MIX, bool STEREO, bool COPY>
+static void spectrum_post(const SpectrumPost& args)
+{
+    constexpr auto step = sizeof(__m256) / sizeof(float);
+    const auto scale0 = _mm256_set1_ps(args.scale[0]);
+    const auto scale1 = _mm256_set1_ps(args.scale[1]);
+    const auto compensation = _mm256_set1_ps(args.compensation);
+    const auto dbmin = _mm256_set1_ps(args.db_min);
+    const auto half = _mm256_set1_ps(0.5f);
+    const auto dbscale = _mm256_set1_ps(POWER ? 0.5f : 1.0f); // 10 * log10 for power
+    const auto post = [&](__m256 mag) {
+        return _mm256_fmadd_ps(dbfs_avx(mag, dbmin), dbscale, compensation);
+    };
+    for(size_t i = args.first_bin; i < args.last_bin; i += step)
+    {
+        auto mag = _mm256_mul_ps(_mm256_load_ps(&args.out[0][i]), scale0);
+        if constexpr(MIX)
+            mag = _mm256_mul_ps(half, _mm256_fmadd_ps(_mm256_load_ps(&args.out[1][i]), scale1, mag));
+        const auto db = post(mag);
+        _mm256_store_ps(&args.out[0][i], db);
+        if constexpr(STEREO)
+            _mm256_store_ps(&args.out[1][i], COPY ? db : post(_mm256_mul_ps(_mm256_load_ps(&args.out[1][i]), scale1)));
+    }
+}
+
+SpectrumBinsFn select_spectrum_bins_avx(const SpectrumVariant& variant)
+{
+    return select_variant([]<bool... F>() -> SpectrumBinsFn { return &spectrum_bins<F...>; },
+        variant.power, variant.smooth, variant.fast_peaks, variant.accumulate, variant.peak, variant.onset, variant.pair);
+}
+
+SpectrumPostFn select_spectrum_post_avx(const SpectrumPostVariant& variant)
+{
+    return select_variant([]<bool... F>() -> SpectrumPostFn { return &spectrum_post<F...>; },
+        variant.power, variant.mix, variant.stereo, variant.copy);
+}
+
+bool window_input_avx(float *dst, const float *src, const float *window, size_t count)
+{
+    return window_input<SimdVec<8>>(dst, src, window, count);
+}
+
+void mix_input_avx(float *dst, const float *src, float weight, size_t count, bool accumulate)
+{
+    mix_input<SimdVec<8>>(dst, src, weight, count, accumulate);
+}
+
+bool all_below_avx(const float *values, size_t first, size_t last, float limit)
+{
+    return all_below<SimdVec<8>>(values, first, last, limit);
+}
+
+void peak_hold_avx(const PeakHold& args)
+{
+    constexpr auto step = sizeof(__m256) / sizeof(float); // first and last bin are 8 bin aligned
+    const auto fall = _mm256_set1_ps(args.fall);
+    const auto dt = _mm256_set1_ps(args.seconds);
+    const auto hold = _mm256_set1_ps(args.hold_time);
+    const auto dbmin = _mm256_set1_ps(args.db_min);
+    const auto zero = _mm256_setzero_ps();
+    for(auto channel = 0u; channel < args.channels; ++channel)
+    {
+        const auto db = args.db[channel];
+        const auto peak = args.peak[channel];
+        const auto timer = args.timer[channel];
+        for(size_t i = args.first_bin; i < args.last_bin; i += step)
+        {
+            const auto val = _mm256_load_ps(&db[i]);
+            const auto oldpeak = _mm256_load_ps(&peak[i]);
+            const auto oldtimer = _mm256_load_ps(&timer[i]);
+            const auto falling = _mm256_max_ps(_mm256_sub_ps(oldpeak, fall), dbmin);
+            const auto held = _mm256_blendv_ps(falling, oldpeak, _mm256_cmp_ps(oldtimer, zero, _CMP_GT_OQ));
+            const auto hit = _mm256_cmp_ps(val, held, _CMP_GE_OQ);
+            _mm256_store_ps(&peak[i], _mm256_blendv_ps(held, val, hit));
+            _mm256_store_ps(&timer[i], _mm256_blendv_ps(_mm256_sub_ps(oldtimer, dt), hold, hit));
+        }
+    }
+}
+
+void meter_reduce_avx(const float *src, size_t frames, uint32_t lanes, float *peaks, float *squares)
+{
+    // one register holds 8 / lanes whole frames, lane i is channel i % lanes
+    // folded back to the channels once at the end instead of per frame
+    constexpr auto step = sizeof(__m256) / sizeof(float);
+    const auto count = frames * lanes;
+    const auto signbit = _mm256_set1_ps(-0.0f);
+    auto max = _mm256_setzero_ps();
+    auto sum = _mm256_setzero_ps();
+    size_t i = 0;
+    for(; (i + step) <= count; i += step)
+    {
+        const auto x = _mm256_loadu_ps(&src[i]);
+        max = _mm256_max_ps(max, _mm256_andnot_ps(signbit, x));
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(x, x));
+    }
+    alignas(32) float maxs[step];
+    alignas(32) float sums[step];
+    _mm256_store_ps(maxs, max);
+    _mm256_store_ps(sums, sum);
+    for(auto lane = 0u; lane < lanes; ++lane)
+    {
+        peaks[lane] = 0.0f;
+        squares[lane] = 0.0f;
+    }
+    for(auto j = 0u; j < step; ++j)
+    {
+        peaks[j % lanes] = std::max(peaks[j % lanes], maxs[j]);
+        squares[j % lanes] += sums[j];
+    }
+    for(; i < count; ++i)
+    {
+        peaks[i % lanes] = std::max(peaks[i % lanes], std::abs(src[i]));
+        squares[i % lanes] += src[i] * src[i];
+    }
+}
+
+float waveform_peak_avx(const float *src, size_t count)
+{
+    // the capture copy has no alignment, columns start anywhere
+    constexpr auto step = sizeof(__m256) / sizeof(float);
+    const auto signbit = _mm256_set1_ps(-0.0f);
+    auto max = _mm256_setzero_ps();
+    size_t i = 0;
+    for(; (i + step) <= count; i += step)
+        max = _mm256_max_ps(max, _mm256_andnot_ps(signbit, _mm256_loadu_ps(&src[i])));
+    auto out = horizontal_max(max);
+    for(; i < count; ++i)
+        out = std::max(out, std::abs(src[i]));
+    return out;
+}
+
+void waveform_post_avx(const WaveformPost& args)
+{
+    // unaligned loads with a scalar tail
+    constexpr auto step = sizeof(__m256) / sizeof(float);
+    const auto end = args.pos + args.count;
+    const auto dbmin = _mm256_set1_ps(args.db_min);
+    const auto half = _mm256_set1_ps(0.5f);
+    const auto comp = _mm256_set1_ps(args.compensation);
+    const auto mix = args.mix;
+    for(auto channel = args.stereo ? 2u : 1u; channel-- > 0;) // a copied channel 1 reads channel 0 before it's converted
+    {
+        auto dst = args.values[channel];
+        const auto src = (args.copy && (channel == 1)) ? args.values[0] : dst;
+        const auto other = args.values[1];
+        auto i = args.pos;
+        for(; (i + step) <= end; i += step)
+        {
+            auto mag = _mm256_loadu_ps(&src[i]);
+            if(mix)
+                mag = _mm256_mul_ps(_mm256_add_ps(mag, _mm256_loadu_ps(&other[i])), half);
+            _mm256_storeu_ps(&dst[i], _mm256_add_ps(dbfs_avx(mag, dbmin), comp));
+        }
+        for(; i < end; ++i)
+        {
+            const auto mag = mix ? ((src[i] + other[i]) * 0.5f) : src[i];
+            dst[i] = mag_to_db(mag, args.db_min) + args.compensation;
+        }
+    }
+}
+
+size_t scope_trigger_avx(const float *src, size_t count, float level)
+{
+    // newest pairs first, one compare and movemask of each side per block
+    constexpr auto step = sizeof(__m256) / sizeof(float);
+    const auto lvl = _mm256_set1_ps(level);
+    auto i = count;
+    while(i >= step)
+    {
+        i -= step;
+        const auto below = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(&src[i]), lvl, _CMP_LE_OQ));
+        const auto above = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(&src[i + 1]), lvl, _CMP_GT_OQ));
+        const auto hits = (unsigned int)(below & above);
+        if(hits != 0)
+            return i + std::bit_width(hits) - 1; // the highest set bit is the newest crossing
+    }
+    while(i-- > 0)
+        if((src[i] <= level) && (src[i + 1] > level))
+            return i;
+    return count;
+}
@@ -0,0 +1,111 @@
+/*
+    Copyright (C) 2022 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "analysis_kernels.hpp"
+#include "simd_helpers.hpp"
+#include <immintrin.h>
+#include <algorithm>
+
+// magnitude (or power) of one frame, smoothed and combined with the frames before it
+// every setting the loop depends on is a template argument, see SpectrumVariant
+// PAIR runs both channels in the same loop, the gains are loaded once for the two of them
+template<bool POWER, bool SMOOTH, bool FAST_PEAKS, bool FP16, bool ACCUMULATE, bool PEAK, bool ONSET, bool PAIR>
+static void spectrum_bins(const SpectrumBins& args)
+{
+    constexpr auto step = sizeof(__m256) / sizeof(float);
+    constexpr auto channels = PAIR ? 2u : 1u;
+    const auto shuffle_mask = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    const auto g = _mm256_set1_ps(args.gravity);
+    const auto g2 = _mm256_sub_ps(_mm256_set1_ps(1.0), g); // 1 - gravity
+    auto flux = _mm256_setzero_ps(); // beat detection, positive spectral flux and total
+    auto total = _mm256_setzero_ps();
+    for(size_t i = args.first_bin; i < args.last_bin; i += step)
+    {
+        const auto gain = _mm256_load_ps(&args.gains[i]); // window normalization, slope and roll-off
+        for(auto channel = 0u; channel < channels; ++channel)
+        {
+            const auto history = args.history[channel];
+            const auto halfbuf = reinterpret_cast<__m128i*>(history); // fp16 smoothing history, F16C
+            const auto out = args.out[channel];
+
+            // this *should* be faster than 2x vgatherxxx instructions
+            // load 8 real/imaginary pairs and group the r/i components in the low/high halves
+            const float *buf = &args.in[channel][i][0]; // first element of complex (float[2])
+            auto chunk1 = _mm256_permutevar8x32_ps(_mm256_load_ps(buf), shuffle_mask);
+            auto chunk2 = _mm256_permutevar8x32_ps(_mm256_load_ps(&buf[step]), shuffle_mask);
+
+            // pack the real and imaginary components into separate vectors
+            auto rvec = _mm256_insertf128_ps(chunk1, _mm256_castps256_ps128(chunk2), 1); // faster than vperm2f128 on AMD until Zen2
+            auto ivec = _mm256_permute2f128_ps(chunk1, chunk2, 1 | (3 << 4)); // no choice here (without using more instructions)
+
+            // calculate normalized magnitude
+            // 2 * magnitude / window
+            // power r^2 + i^2, or magnitude sqrt(r^2 + i^2)
+            auto mag = _mm256_fmadd_ps(ivec, ivec, _mm256_mul_ps(rvec, rvec));
+            if constexpr(POWER)
+                mag = _mm256_mul_ps(mag, _mm256_mul_ps(gain, gain)); // power domain from the transform to dBFS, no sqrt
+            else
+                mag = _mm256_mul_ps(_mm256_sqrt_ps(mag), gain);
+
+            // time domain smoothing, beat detection keeps the history without it too
+            if constexpr(SMOOTH || ONSET)
+            {
+                auto oldval = FP16 ? _mm256_cvtph_ps(_mm_load_si128(&halfbuf[i / step])) : _mm256_load_ps(&history[i]);
+
+                // positive spectral flux, the rise over the history before it's updated
+                if constexpr(ONSET)
+                {
+                    flux = _mm256_add_ps(flux, _mm256_max_ps(_mm256_sub_ps(mag, oldval), _mm256_setzero_ps()));
+                    total = _mm256_add_ps(total, mag);
+                }
+
+                if constexpr(SMOOTH)
+                {
+                    // take new values immediately if larger
+                    if constexpr(FAST_PEAKS)
+                        oldval = _mm256_max_ps(mag, oldval);
+
+                    // (gravity * oldval) + ((1 - gravity) * newval)
+                    mag = _mm256_fmadd_ps(g, oldval, _mm256_mul_ps(g2, mag));
+                }
+                if constexpr(FP16)
+                    _mm_store_si128(&halfbuf[i / step], _mm256_cvtps_ph(mag, _MM_FROUND_TO_NEAREST_INT));
+                else
+                    _mm256_store_ps(&history[i], mag);
+            }
+
+            if constexpr(ACCUMULATE)
+            {
+                const auto prev = _mm256_load_ps(&out[i]);
+                mag = PEAK ? _mm256_max_ps(mag, prev) : _mm256_add_ps(mag, prev);
+            }
+            _mm256_store_ps(&out[i], mag); // end of the line for AVX
+        }
+    }
+    if constexpr(ONSET)
+    {
+        args.flux[0] += horizontal_sum(flux);
+        args.flux[1] += horizontal_sum(total);
+    }
+}
+
+// the post pass and the sample kernels are the same as the avx tier, only the bins change
+SpectrumBinsFn select_spectrum_bins_avx2(const SpectrumVariant& variant)
+{
+    return select_variant([]<bool... F>() -> SpectrumBinsFn { return &spectrum_bins<F...>; },
+        variant.power, variant.smooth, variant.fast_peaks, variant.half_history, variant.accumulate, variant.peak, variant.onset, variant.pair);
+}
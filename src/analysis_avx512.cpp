@@ -0,0 +1,173 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "analysis_kernels.hpp"
+#include "simd_helpers.hpp"
+#include <immintrin.h>
+#include <algorithm>
+
+// partial vector at the end of the bin range, last_bin is only 8 aligned
+static inline __mmask16 tail_mask(size_t i, size_t last_bin)
+{
+    constexpr auto step = sizeof(__m512) / sizeof(float);
+    return ((last_bin - i) >= step) ? (__mmask16)0xffff : (__mmask16)((1u << (last_bin - i)) - 1u);
+}
+
+// same for the interleaved complex input, a bin mask spread to the (re, im) float pairs
+static inline __mmask16 pair_mask(unsigned int bins)
+{
+    unsigned int ret = 0;
+    for(unsigned int bit = 0; bit < 8; ++bit)
+        if(bins & (1u << bit))
+            ret |= 3u << (bit * 2);
+    return (__mmask16)ret;
+}
+
+// see spectrum_bins in analysis_avx2.cpp
+template<bool POWER, bool SMOOTH, bool FAST_PEAKS, bool FP16, bool ACCUMULATE, bool PEAK, bool ONSET, bool PAIR>
+static void spectrum_bins(const SpectrumBins& args)
+{
+    constexpr auto step = sizeof(__m512) / sizeof(float);
+    constexpr auto channels = PAIR ? 2u : 1u;
+    const auto g = _mm512_set1_ps(args.gravity);
+    const auto g2 = _mm512_sub_ps(_mm512_set1_ps(1.0), g); // 1 - gravity
+    auto flux = _mm512_setzero_ps();
+    auto total = _mm512_setzero_ps();
+    const auto real_idx = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    const auto imag_idx = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+    for(size_t i = args.first_bin; i < args.last_bin; i += step)
+    {
+        const auto mask = tail_mask(i, args.last_bin);
+        const auto gain = _mm512_maskz_loadu_ps(mask, &args.gains[i]); // window normalization, slope and roll-off
+        for(auto channel = 0u; channel < channels; ++channel)
+        {
+            const auto history = args.history[channel];
+            const auto out = args.out[channel];
+
+            // 16 real/imaginary pairs, two-source permutes split them without any lane crossing fixups
+            const float *buf = &args.in[channel][i][0];
+            const auto chunk1 = _mm512_maskz_loadu_ps(pair_mask(mask & 0xff), buf);
+            const auto chunk2 = _mm512_maskz_loadu_ps(pair_mask(mask >> 8), &buf[step]);
+            const auto rvec = _mm512_permutex2var_ps(chunk1, real_idx, chunk2);
+            const auto ivec = _mm512_permutex2var_ps(chunk1, imag_idx, chunk2);
+
+            // 2 * magnitude / window
+            auto mag = _mm512_fmadd_ps(ivec, ivec, _mm512_mul_ps(rvec, rvec)); // power r^2 + i^2
+            if constexpr(POWER)
+                mag = _mm512_mul_ps(mag, _mm512_mul_ps(gain, gain));
+            else
+                mag = _mm512_mul_ps(_mm512_maskz_sqrt_ps(ALL_LANES, mag), gain);
+
+            // time domain smoothing, beat detection keeps the history without it too
+            if constexpr(SMOOTH || ONSET)
+            {
+                // fp16 tails are a single 8 bin half, last_bin is 8 aligned
+                const auto halfbuf = reinterpret_cast<uint16_t*>(history) + i;
+                const auto full = mask == (__mmask16)0xffff;
+                __m512 oldval;
+                if constexpr(FP16)
+                    oldval = _mm512_maskz_cvtph_ps(ALL_LANES, full ? _mm256_loadu_si256((const __m256i*)halfbuf) : _mm256_zextsi128_si256(_mm_loadu_si128((const __m128i*)halfbuf)));
+                else
+                    oldval = _mm512_maskz_loadu_ps(mask, &history[i]);
+                if constexpr(ONSET)
+                {
+                    flux = _mm512_add_ps(flux, _mm512_maskz_max_ps(ALL_LANES, _mm512_sub_ps(mag, oldval), _mm512_setzero_ps()));
+                    total = _mm512_add_ps(total, mag);
+                }
+                if constexpr(SMOOTH)
+                {
+                    if constexpr(FAST_PEAKS)
+                        oldval = _mm512_maskz_max_ps(ALL_LANES, mag, oldval);
+
+                    // (gravity * oldval) + ((1 - gravity) * newval)
+                    mag = _mm512_fmadd_ps(g, oldval, _mm512_mul_ps(g2, mag));
+                }
+                if constexpr(!FP16)
+                    _mm512_mask_storeu_ps(&history[i], mask, mag);
+                else if(full)
+                    _mm256_storeu_si256((__m256i*)halfbuf, _mm512_maskz_cvtps_ph(ALL_LANES, mag, _MM_FROUND_TO_NEAREST_INT));
+                else
+                    _mm_storeu_si128((__m128i*)halfbuf, _mm256_castsi256_si128(_mm512_maskz_cvtps_ph(ALL_LANES, mag, _MM_FROUND_TO_NEAREST_INT)));
+            }
+
+            if constexpr(ACCUMULATE)
+            {
+                const auto prev = _mm512_maskz_loadu_ps(mask, &out[i]);
+                mag = PEAK ? _mm512_maskz_max_ps(ALL_LANES, mag, prev) : _mm512_add_ps(mag, prev);
+            }
+            _mm512_mask_storeu_ps(&out[i], mask, mag);
+        }
+    }
+    if constexpr(ONSET)
+    {
+        args.flux[0] += horizontal_sum(flux);
+        args.flux[1] += horizontal_sum(total);
+    }
+}
+
+template<bool POWER, bool MIX, bool STEREO, bool COPY>
+static void spectrum_post(const SpectrumPost& args)
+{
+    constexpr auto step = sizeof(__m512) / sizeof(float);
+    const auto scale0 = _mm512_set1_ps(args.scale[0]);
+    const auto scale1 = _mm512_set1_ps(args.scale[1]);
+    const auto compensation = _mm512_set1_ps(args.compensation);
+    const auto dbmin = _mm512_set1_ps(args.db_min);
+    const auto half = _mm512_set1_ps(0.5f);
+    const auto dbscale = _mm512_set1_ps(POWER ? 0.5f : 1.0f); // 10 * log10 for power
+    const auto post = [&](__m512 mag) {
+        return _mm512_fmadd_ps(dbfs_avx512(mag, dbmin), dbscale, compensation);
+    };
+    for(size_t i = args.first_bin; i < args.last_bin; i += step)
+    {
+        const auto mask = tail_mask(i, args.last_bin);
+        auto mag = _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, &args.out[0][i]), scale0);
+        if constexpr(MIX)
+            mag = _mm512_mul_ps(half, _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, &args.out[1][i]), scale1, mag));
+        const auto db = post(mag);
+        _mm512_mask_storeu_ps(&args.out[0][i], mask, db);
+        if constexpr(STEREO)
+            _mm512_mask_storeu_ps(&args.out[1][i], mask, COPY ? db : post(_mm512_mul_ps(_mm512_maskz_loadu_ps(mask, &args.out[1][i]), scale1)));
+    }
+}
+
+SpectrumBinsFn select_spectrum_bins_avx512(const SpectrumVariant& variant)
+{
+    return select_variant([]<bool... F>() -> SpectrumBinsFn { return &spectrum_bins<F...>; },
+        variant.power, variant.smooth, variant.fast_peaks, variant.half_history, variant.accumulate, variant.peak, variant.onset, variant.pair);
+}
+
+SpectrumPostFn select_spectrum_post_avx512(const SpectrumPostVariant& variant)
+{
+    return select_variant([]<bool... F>() -> SpectrumPostFn { return &spectrum_post<F...>; },
+        variant.power, variant.mix, variant.stereo, variant.copy);
+}
+
+bool window_input_avx512(float *dst, const float *src, const float *window, size_t count)
+{
+    return window_input<SimdVec<16>>(dst, src, window, count);
+}
+
+void mix_input_avx512(float *dst, const float *src, float weight, size_t count, bool accumulate)
+{
+    mix_input<SimdVec<16>>(dst, src, weight, count, accumulate);
+}
+
+bool all_below_avx512(const float *values, size_t first, size_t last, float limit)
+{
+    return all_below<SimdVec<16>>(values, first, last, limit);
+}
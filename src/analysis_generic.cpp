@@ -0,0 +1,232 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "analysis_kernels.hpp"
+#include "simd_helpers.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// magnitude (or power) of one frame, smoothed and combined with the frames before it
+// every setting the loop depends on is a template argument, see SpectrumVariant
+// PAIR runs both channels in the same loop, sharing the gain of each bin
+template<bool POWER, bool SMOOTH, bool FAST_PEAKS, bool ACCUMULATE, bool PEAK, bool ONSET, bool PAIR>
+static void spectrum_bins(const SpectrumBins& args)
+{
+    constexpr auto channels = PAIR ? 2u : 1u;
+    const auto g = args.gravity;
+    const auto g2 = 1.0f - g;
+    float flux = 0.0f;
+    float total = 0.0f;
+    for(size_t i = args.first_bin; i < args.last_bin; ++i)
+    {
+        // window normalization, slope and roll-off in one precomputed gain
+        const auto gain = args.gains[i];
+        for(auto channel = 0u; channel < channels; ++channel)
+        {
+            const auto real = args.in[channel][i][0];
+            const auto imag = args.in[channel][i][1];
+            const auto history = args.history[channel];
+
+            float mag;
+            if constexpr(POWER)
+                mag = ((real * real) + (imag * imag)) * (gain * gain); // power domain from the transform to dBFS, no sqrt
+            else
+                mag = std::hypot(real, imag) * gain;
+
+            // positive spectral flux for beat detection, the rise over the history before it's updated
+            // without smoothing the history is just the last frame
+            if constexpr(ONSET)
+            {
+                flux += std::max(mag - history[i], 0.0f);
+                total += mag;
+                if constexpr(!SMOOTH)
+                    history[i] = mag;
+            }
+
+            if constexpr(SMOOTH)
+            {
+                auto oldval = history[i];
+                if constexpr(FAST_PEAKS)
+                    oldval = std::max(mag, oldval);
+
+                // flushed to zero below the smallest normal float, not every target has FTZ
+                mag = (g * oldval) + (g2 * mag);
+                mag = (mag >= std::numeric_limits<float>::min()) ? mag : 0.0f;
+                history[i] = mag;
+            }
+
+            const auto out = args.out[channel];
+            if constexpr(ACCUMULATE)
+                mag = PEAK ? std::max(mag, out[i]) : (mag + out[i]);
+            out[i] = mag;
+        }
+    }
+    if constexpr(ONSET)
+    {
+        args.flux[0] += flux;
+        args.flux[1] += total;
+    }
+}
+
+template<bool POWER, bool MIX, bool STEREO, bool COPY>
+static void spectrum_post(const SpectrumPost& args)
+{
+    constexpr auto dbscale = POWER ? 0.5f : 1.0f; // 10 * log10 for power
+    const auto post = [&](float mag) {
+        return (mag_to_db(mag, args.db_min) * dbscale) + args.compensation;
+    };
+    for(size_t i = args.first_bin; i < args.last_bin; ++i)
+    {
+        auto mag = args.out[0][i] * args.scale[0];
+        if constexpr(MIX)
+            mag = (mag + (args.out[1][i] * args.scale[1])) * 0.5f;
+        const auto db = post(mag);
+        args.out[0][i] = db;
+        if constexpr(STEREO)
+            args.out[1][i] = COPY ? db : post(args.out[1][i] * args.scale[1]);
+    }
+}
+
+// bars that average in power, linear power with the volume compensation as a gain
+template<bool POWER, bool MIX, bool STEREO, bool COPY>
+static void spectrum_power_post(const SpectrumPost& args)
+{
+    const auto gain = std::pow(10.0f, args.compensation * 0.1f);
+    const auto post = [&](float mag) { return (POWER ? mag : mag * mag) * gain; };
+    for(size_t i = args.first_bin; i < args.last_bin; ++i)
+    {
+        auto mag = args.out[0][i] * args.scale[0];
+        if constexpr(MIX)
+            mag = (mag + (args.out[1][i] * args.scale[1])) * 0.5f;
+        const auto power = post(mag);
+        args.out[0][i] = power;
+        if constexpr(STEREO)
+            args.out[1][i] = COPY ? power : post(args.out[1][i] * args.scale[1]);
+    }
+}
+
+SpectrumBinsFn select_spectrum_bins_generic(const SpectrumVariant& variant)
+{
+    return select_variant([]<bool... F>() -> SpectrumBinsFn { return &spectrum_bins<F...>; },
+        variant.power, variant.smooth, variant.fast_peaks, variant.accumulate, variant.peak, variant.onset, variant.pair);
+}
+
+SpectrumPostFn select_spectrum_post_generic(const SpectrumPostVariant& variant)
+{
+    return select_variant([]<bool... F>() -> SpectrumPostFn { return &spectrum_post<F...>; },
+        variant.power, variant.mix, variant.stereo, variant.copy);
+}
+
+SpectrumPostFn select_spectrum_power_post(const SpectrumPostVariant& variant)
+{
+    return select_variant([]<bool... F>() -> SpectrumPostFn { return &spectrum_power_post<F...>; },
+        variant.power, variant.mix, variant.stereo, variant.copy);
+}
+
+bool window_input_generic(float *dst, const float *src, const float *window, size_t count)
+{
+    return window_input<SimdVec<1>>(dst, src, window, count);
+}
+
+void mix_input_generic(float *dst, const float *src, float weight, size_t count, bool accumulate)
+{
+    mix_input<SimdVec<1>>(dst, src, weight, count, accumulate);
+}
+
+bool all_below_generic(const float *values, size_t first, size_t last, float limit)
+{
+    return all_below<SimdVec<1>>(values, first, last, limit);
+}
+
+void meter_reduce_generic(const float *src, size_t frames, uint32_t lanes, float *peaks, float *squares)
+{
+    for(auto lane = 0u; lane < lanes; ++lane)
+    {
+        peaks[lane] = 0.0f;
+        squares[lane] = 0.0f;
+    }
+    for(size_t i = 0; i < frames; ++i, src += lanes)
+    {
+        for(auto lane = 0u; lane < lanes; ++lane)
+        {
+            peaks[lane] = std::max(peaks[lane], std::abs(src[lane]));
+            squares[lane] += src[lane] * src[lane];
+        }
+    }
+}
+
+float waveform_peak_generic(const float *src, size_t count)
+{
+    auto out = 0.0f;
+    for(size_t i = 0; i < count; ++i)
+        out = std::max(out, std::abs(src[i]));
+    return out;
+}
+
+void waveform_post_generic(const WaveformPost& args)
+{
+    const auto begin = args.pos;
+    const auto end = args.pos + args.count;
+    if(args.copy && args.stereo)
+        for(auto i = begin; i < end; ++i)
+            args.values[1][i] = args.values[0][i];
+
+    if(args.stereo)
+    {
+        for(auto channel = 0; channel < 2; ++channel)
+            for(auto i = begin; i < end; ++i)
+                args.values[channel][i] = mag_to_db(args.values[channel][i], args.db_min) + args.compensation;
+    }
+    else if(args.mix)
+    {
+        for(auto i = begin; i < end; ++i)
+            args.values[0][i] = mag_to_db((args.values[0][i] + args.values[1][i]) * 0.5f, args.db_min) + args.compensation;
+    }
+    else
+    {
+        for(auto i = begin; i < end; ++i)
+            args.values[0][i] = mag_to_db(args.values[0][i], args.db_min) + args.compensation;
+    }
+}
+
+size_t scope_trigger_generic(const float *src, size_t count, float level)
+{
+    for(auto i = count; i-- > 0;)
+        if((src[i] <= level) && (src[i + 1] > level))
+            return i;
+    return count;
+}
+
+void peak_hold_generic(const PeakHold& args)
+{
+    for(auto channel = 0u; channel < args.channels; ++channel)
+    {
+        const auto db = args.db[channel];
+        const auto peak = args.peak[channel];
+        const auto timer = args.timer[channel];
+        for(size_t i = args.first_bin; i < args.last_bin; ++i)
+        {
+            // held peaks start falling once their timer runs out, a new peak resets the timer
+            const auto held = (timer[i] > 0.0f) ? peak[i] : std::max(peak[i] - args.fall, args.db_min);
+            const auto hit = db[i] >= held;
+            peak[i] = hit ? db[i] : held;
+            timer[i] = hit ? args.hold_time : timer[i] - args.seconds;
+        }
+    }
+}
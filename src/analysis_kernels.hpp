@@ -0,0 +1,185 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include "waveform_config.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <fftw3.h>
+
+// Analysis side kernels, the per sample and per bin passes from the window through to dBFS.
+// Everything comes in through plain structs so they build, test and time without the plugin.
+// DSPKernels resolves one tier for all of them, the spectrum passes are specialized on their settings by the select functions.
+// the avx tier needs FMA3 as well, avx2 and avx512 add their own spectrum_bins and reuse the rest
+
+// per bin pass over one transformed frame of one channel, or both channels at once
+// the paired kernels read [1] as well and load the gains once for both
+struct SpectrumBins
+{
+    const fftwf_complex *in[2]{};
+    const float *gains = nullptr;   // AnalysisTables::bin_gains
+    float *history[2]{};            // time smoothing, fp16 pairs with SpectrumVariant::half_history
+    float *out[2]{};                // magnitude or power, accumulated over the frames of a tick
+    float *flux = nullptr;          // beat detection, positive change against history and total of the frame added to flux[0] and flux[1]
+    size_t first_bin = 0;
+    size_t last_bin = 0;
+    float gravity = 0.0f;
+};
+
+// frame average, channel mix, dBFS and volume compensation after the last frame
+struct SpectrumPost
+{
+    float *out[2]{};
+    size_t first_bin = 0;
+    size_t last_bin = 0;
+    float scale[2]{};               // frame average per channel
+    float compensation = 0.0f;      // dB
+    float db_min = 0.0f;
+};
+
+// settings a SpectrumBins pass is specialized on
+struct SpectrumVariant
+{
+    bool power = false;         // power instead of magnitude, no sqrt
+    bool smooth = false;        // time smoothing against the history
+    bool fast_peaks = false;    // rises skip the smoothing
+    bool half_history = false;  // fp16 history, only where DSPKernels::half_history
+    bool accumulate = false;    // not the first frame of the tick, combined with out
+    bool peak = false;          // frames combine by max instead of sum
+    bool onset = false;         // spectral flux for beat detection
+    bool pair = false;          // both channels in one loop
+};
+
+// settings a SpectrumPost pass is specialized on
+struct SpectrumPostVariant
+{
+    bool power = false;         // out holds power, 10 * log10
+    bool mix = false;           // both channels averaged into out[0]
+    bool stereo = false;        // out[1] is displayed as well
+    bool copy = false;          // out[1] repeats out[0], a mono capture shown on both channels
+};
+
+// new waveform columns of the ring, channel mix, dBFS and volume compensation of their peaks in place
+// runs start anywhere in the ring, nothing is aligned
+struct WaveformPost
+{
+    float *values[2]{};
+    size_t pos = 0;
+    size_t count = 0;
+    float compensation = 0.0f;  // dB
+    float db_min = 0.0f;
+    bool stereo = false;
+    bool mix = false;           // both channels averaged into values[0], never with stereo or copy
+    bool copy = false;          // values[1] repeats values[0], only read with stereo
+};
+
+// held peaks of the displayed bins, a new peak resets its timer and peaks start falling once it runs out
+struct PeakHold
+{
+    const float *db[2]{};
+    float *peak[2]{};
+    float *timer[2]{};
+    uint32_t channels = 0;
+    size_t first_bin = 0;       // 8 bin aligned, as is last_bin
+    size_t last_bin = 0;
+    float seconds = 0.0f;       // since the last pass
+    float fall = 0.0f;          // dB every peak past its timer falls in that time
+    float hold_time = 0.0f;
+    float db_min = 0.0f;
+};
+
+// 20 * log10(mag), db_min for anything below the smallest normal float (denormals would land below it)
+static inline float mag_to_db(float mag, float db_min)
+{
+    return (mag >= std::numeric_limits<float>::min()) ? 20.0f * std::log10(mag) : db_min;
+}
+
+using SpectrumBinsFn = void (*)(const SpectrumBins&);
+using SpectrumPostFn = void (*)(const SpectrumPost&);
+
+// turn runtime flags into template arguments once instead of branching on them per bin
+// returns make.template operator()<flags...>()
+template<bool... B, typename F>
+auto select_variant(F&& make)
+{
+    return make.template operator()<B...>();
+}
+
+template<bool... B, typename F, typename... Flags>
+auto select_variant(F&& make, bool flag, Flags... flags)
+{
+    if(flag)
+        return select_variant<B..., true>(make, flags...);
+    return select_variant<B..., false>(make, flags...);
+}
+
+// portable versions, every tier falls back to these
+SpectrumBinsFn select_spectrum_bins_generic(const SpectrumVariant& variant);
+SpectrumPostFn select_spectrum_post_generic(const SpectrumPostVariant& variant);
+SpectrumPostFn select_spectrum_power_post(const SpectrumPostVariant& variant); // bars that average in power, linear power with the compensation as a gain
+
+// copy count samples from src to dst multiplied by window (if not null)
+// returns false if every input sample is zero, neither pointer needs to be aligned
+bool window_input_generic(float *dst, const float *src, const float *window, size_t count);
+// dst = src * weight, or dst += src * weight when accumulating
+void mix_input_generic(float *dst, const float *src, float weight, size_t count, bool accumulate);
+// true if every value in [first, last) is below limit
+bool all_below_generic(const float *values, size_t first, size_t last, float limit);
+
+// peak and sum of squares of each channel of interleaved frames, lanes of 1, 2, 4 or 8
+void meter_reduce_generic(const float *src, size_t frames, uint32_t lanes, float *peaks, float *squares);
+// largest magnitude of a waveform column's samples
+float waveform_peak_generic(const float *src, size_t count);
+void waveform_post_generic(const WaveformPost& args);
+// last i below count with src[i] <= level < src[i + 1], count if there is none, reads count + 1 samples
+size_t scope_trigger_generic(const float *src, size_t count, float level);
+void peak_hold_generic(const PeakHold& args);
+
+#ifdef ENABLE_X86_SIMD
+SpectrumBinsFn select_spectrum_bins_avx(const SpectrumVariant& variant);
+SpectrumPostFn select_spectrum_post_avx(const SpectrumPostVariant& variant);
+bool window_input_avx(float *dst, const float *src, const float *window, size_t count);
+void mix_input_avx(float *dst, const float *src, float weight, size_t count, bool accumulate);
+bool all_below_avx(const float *values, size_t first, size_t last, float limit);
+void meter_reduce_avx(const float *src, size_t frames, uint32_t lanes, float *peaks, float *squares);
+float waveform_peak_avx(const float *src, size_t count);
+void waveform_post_avx(const WaveformPost& args);
+size_t scope_trigger_avx(const float *src, size_t count, float level);
+void peak_hold_avx(const PeakHold& args);
+
+SpectrumBinsFn select_spectrum_bins_avx2(const SpectrumVariant& variant);
+
+SpectrumBinsFn select_spectrum_bins_avx512(const SpectrumVariant& variant);
+SpectrumPostFn select_spectrum_post_avx512(const SpectrumPostVariant& variant);
+bool window_input_avx512(float *dst, const float *src, const float *window, size_t count);
+void mix_input_avx512(float *dst, const float *src, float weight, size_t count, bool accumulate);
+bool all_below_avx512(const float *values, size_t first, size_t last, float limit);
+#endif // ENABLE_X86_SIMD
+
+#ifdef ENABLE_ARM_SIMD
+SpectrumBinsFn select_spectrum_bins_neon(const SpectrumVariant& variant);
+SpectrumPostFn select_spectrum_post_neon(const SpectrumPostVariant& variant);
+bool window_input_neon(float *dst, const float *src, const float *window, size_t count);
+void mix_input_neon(float *dst, const float *src, float weight, size_t count, bool accumulate);
+bool all_below_neon(const float *values, size_t first, size_t last, float limit);
+void meter_reduce_neon(const float *src, size_t frames, uint32_t lanes, float *peaks, float *squares);
+size_t scope_trigger_neon(const float *src, size_t count, float level);
+void peak_hold_neon(const PeakHold& args);
+#endif // ENABLE_ARM_SIMD
@@ -0,0 +1,227 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "analysis_kernels.hpp"
+#include "simd_helpers.hpp"
+#include <arm_neon.h>
+#include <algorithm>
+#include <cmath>
+
+// see spectrum_bins in analysis_avx2.cpp
+template<bool POWER, bool SMOOTH, bool FAST_PEAKS, bool ACCUMULATE, bool PEAK, bool ONSET, bool PAIR>
+static void spectrum_bins(const SpectrumBins& args)
+{
+    constexpr auto step = sizeof(float32x4_t) / sizeof(float);
+    constexpr auto channels = PAIR ? 2u : 1u;
+    const auto g = vdupq_n_f32(args.gravity);
+    const auto g2 = vsubq_f32(vdupq_n_f32(1.0), g);
+    auto flux = vdupq_n_f32(0.0f);
+    auto total = vdupq_n_f32(0.0f);
+    for(size_t i = args.first_bin; i < args.last_bin; i += step)
+    {
+        const auto gain = vld1q_f32(&args.gains[i]); // window normalization, slope and roll-off
+        for(auto channel = 0u; channel < channels; ++channel)
+        {
+            const auto history = args.history[channel];
+            const auto out = args.out[channel];
+
+            // de-interleaving load, 4 real/imaginary pairs into separate vectors
+            const auto chunk = vld2q_f32(&args.in[channel][i][0]);
+            const auto rvec = chunk.val[0];
+            const auto ivec = chunk.val[1];
+
+            auto mag = vfmaq_f32(vmulq_f32(rvec, rvec), ivec, ivec); // power r^2 + i^2
+            if constexpr(POWER)
+                mag = vmulq_f32(mag, vmulq_f32(gain, gain));
+            else
+                mag = vmulq_f32(vsqrtq_f32(mag), gain);
+
+            if constexpr(SMOOTH || ONSET)
+            {
+                auto oldval = vld1q_f32(&history[i]);
+                if constexpr(ONSET)
+                {
+                    flux = vaddq_f32(flux, vmaxq_f32(vsubq_f32(mag, oldval), vdupq_n_f32(0.0f)));
+                    total = vaddq_f32(total, mag);
+                }
+                if constexpr(SMOOTH)
+                {
+                    if constexpr(FAST_PEAKS)
+                        oldval = vmaxq_f32(mag, oldval);
+                    mag = vfmaq_f32(vmulq_f32(g2, mag), g, oldval);
+                }
+                vst1q_f32(&history[i], mag);
+            }
+
+            if constexpr(ACCUMULATE)
+            {
+                const auto prev = vld1q_f32(&out[i]);
+                mag = PEAK ? vmaxq_f32(mag, prev) : vaddq_f32(mag, prev);
+            }
+            vst1q_f32(&out[i], mag);
+        }
+    }
+    if constexpr(ONSET)
+    {
+        args.flux[0] += horizontal_sum(flux);
+        args.flux[1] += horizontal_sum(total);
+    }
+}
+
+template<bool POWER, bool MIX, bool STEREO, bool COPY>
+static void spectrum_post(const SpectrumPost& args)
+{
+    constexpr auto step = sizeof(float32x4_t) / sizeof(float);
+    const auto scale0 = vdupq_n_f32(args.scale[0]);
+    const auto scale1 = vdupq_n_f32(args.scale[1]);
+    const auto compensation = vdupq_n_f32(args.compensation);
+    const auto dbmin = vdupq_n_f32(args.db_min);
+    const auto dbscale = vdupq_n_f32(POWER ? 0.5f : 1.0f); // 10 * log10 for power
+    const auto post = [&](float32x4_t mag) {
+        return vfmaq_f32(compensation, dbfs_neon(mag, dbmin), dbscale);
+    };
+    for(size_t i = args.first_bin; i < args.last_bin; i += step)
+    {
+        auto mag = vmulq_f32(vld1q_f32(&args.out[0][i]), scale0);
+        if constexpr(MIX)
+            mag = vmulq_n_f32(vfmaq_f32(mag, vld1q_f32(&args.out[1][i]), scale1), 0.5f);
+        const auto db = post(mag);
+        vst1q_f32(&args.out[0][i], db);
+        if constexpr(STEREO)
+            vst1q_f32(&args.out[1][i], COPY ? db : post(vmulq_f32(vld1q_f32(&args.out[1][i]), scale1)));
+    }
+}
+
+SpectrumBinsFn select_spectrum_bins_neon(const SpectrumVariant& variant)
+{
+    return select_variant([]<bool... F>() -> SpectrumBinsFn { return &spectrum_bins<F...>; },
+        variant.power, variant.smooth, variant.fast_peaks, variant.accumulate, variant.peak, variant.onset, variant.pair);
+}
+
+SpectrumPostFn select_spectrum_post_neon(const SpectrumPostVariant& variant)
+{
+    return select_variant([]<bool... F>() -> SpectrumPostFn { return &spectrum_post<F...>; },
+        variant.power, variant.mix, variant.stereo, variant.copy);
+}
+
+// NEON is baseline on 64-bit ARM, there is no runtime dispatch below this tier
+bool window_input_neon(float *dst, const float *src, const float *window, size_t count)
+{
+    return window_input<SimdVec<4>>(dst, src, window, count);
+}
+
+void mix_input_neon(float *dst, const float *src, float weight, size_t count, bool accumulate)
+{
+    mix_input<SimdVec<4>>(dst, src, weight, count, accumulate);
+}
+
+bool all_below_neon(const float *values, size_t first, size_t last, float limit)
+{
+    return all_below<SimdVec<4>>(values, first, last, limit);
+}
+
+void peak_hold_neon(const PeakHold& args)
+{
+    constexpr auto step = sizeof(float32x4_t) / sizeof(float); // first and last bin are 8 bin aligned
+    const auto fall = vdupq_n_f32(args.fall);
+    const auto dt = vdupq_n_f32(args.seconds);
+    const auto hold = vdupq_n_f32(args.hold_time);
+    const auto dbmin = vdupq_n_f32(args.db_min);
+    const auto zero = vdupq_n_f32(0.0f);
+    for(auto channel = 0u; channel < args.channels; ++channel)
+    {
+        const auto db = args.db[channel];
+        const auto peak = args.peak[channel];
+        const auto timer = args.timer[channel];
+        for(size_t i = args.first_bin; i < args.last_bin; i += step)
+        {
+            const auto val = vld1q_f32(&db[i]);
+            const auto oldpeak = vld1q_f32(&peak[i]);
+            const auto oldtimer = vld1q_f32(&timer[i]);
+            const auto falling = vmaxq_f32(vsubq_f32(oldpeak, fall), dbmin);
+            const auto held = vbslq_f32(vcgtq_f32(oldtimer, zero), oldpeak, falling);
+            const auto hit = vcgeq_f32(val, held);
+            vst1q_f32(&peak[i], vbslq_f32(hit, val, held));
+            vst1q_f32(&timer[i], vbslq_f32(hit, hold, vsubq_f32(oldtimer, dt)));
+        }
+    }
+}
+
+void meter_reduce_neon(const float *src, size_t frames, uint32_t lanes, float *peaks, float *squares)
+{
+    // two registers hold 8 / lanes whole frames, lane i is channel i % lanes
+    // folded back to the channels once at the end instead of per frame
+    constexpr auto step = 2 * sizeof(float32x4_t) / sizeof(float);
+    const auto count = frames * lanes;
+    auto max_lo = vdupq_n_f32(0.0f);
+    auto max_hi = vdupq_n_f32(0.0f);
+    auto sum_lo = vdupq_n_f32(0.0f);
+    auto sum_hi = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for(; (i + step) <= count; i += step)
+    {
+        const auto lo = vld1q_f32(&src[i]);
+        const auto hi = vld1q_f32(&src[i + 4]);
+        max_lo = vmaxq_f32(max_lo, vabsq_f32(lo));
+        max_hi = vmaxq_f32(max_hi, vabsq_f32(hi));
+        sum_lo = vfmaq_f32(sum_lo, lo, lo);
+        sum_hi = vfmaq_f32(sum_hi, hi, hi);
+    }
+    float maxs[step];
+    float sums[step];
+    vst1q_f32(maxs, max_lo);
+    vst1q_f32(maxs + 4, max_hi);
+    vst1q_f32(sums, sum_lo);
+    vst1q_f32(sums + 4, sum_hi);
+    for(auto lane = 0u; lane < lanes; ++lane)
+    {
+        peaks[lane] = 0.0f;
+        squares[lane] = 0.0f;
+    }
+    for(auto j = 0u; j < step; ++j)
+    {
+        peaks[j % lanes] = std::max(peaks[j % lanes], maxs[j]);
+        squares[j % lanes] += sums[j];
+    }
+    for(; i < count; ++i)
+    {
+        peaks[i % lanes] = std::max(peaks[i % lanes], std::abs(src[i]));
+        squares[i % lanes] += src[i] * src[i];
+    }
+}
+
+size_t scope_trigger_neon(const float *src, size_t count, float level)
+{
+    // newest pairs first, a block with a crossing is searched again one pair at a time
+    constexpr auto step = sizeof(float32x4_t) / sizeof(float);
+    const auto lvl = vdupq_n_f32(level);
+    auto i = count;
+    while(i >= step)
+    {
+        i -= step;
+        const auto hits = vandq_u32(vcgeq_f32(lvl, vld1q_f32(&src[i])), vcgtq_f32(vld1q_f32(&src[i + 1]), lvl));
+        if(vmaxvq_u32(hits) == 0)
+            continue;
+        for(auto j = step; j-- > 0;)
+            if((src[i + j] <= level) && (src[i + j + 1] > level))
+                return i + j;
+    }
+    while(i-- > 0)
+        if((src[i] <= level) && (src[i + 1] > level))
+            return i;
+    return count;
+}
@@ -0,0 +1,243 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "analysis_tables.hpp"
+#include "math_funcs.hpp"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <numbers>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // only a handful of distinct configurations exist at once, linear search is fine
+    std::mutex s_mtx;
+    std::condition_variable s_cv;
+    std::vector<std::weak_ptr<AnalysisTables>> s_tables;
+    std::vector<std::weak_ptr<AnalysisTables>> s_pending;
+    bool s_stop = false;
+    std::thread s_worker;
+
+    // windows by function, size and exponent, held by the tables using them
+    struct WindowKey
+    {
+        int window_func;
+        size_t size;
+        int sine_exponent;
+
+        bool operator==(const WindowKey&) const = default;
+    };
+
+    std::mutex s_window_mtx;
+    std::vector<std::pair<WindowKey, std::weak_ptr<const WindowTable>>> s_windows;
+
+    // fill buf with size coefficients of a window function, returns their sum
+    float make_window(AlignedBuffer<float>& buf, size_t size, FFTWindow func, int sine_exponent)
+    {
+        buf.reset(size);
+        const auto N = size - 1;
+        constexpr auto pi = std::numbers::pi_v<float>;
+        constexpr auto pi2 = 2 * pi;
+        constexpr auto pi4 = 4 * pi;
+        constexpr auto pi6 = 6 * pi;
+        switch(func)
+        {
+        case FFTWindow::HAMMING:
+            for(size_t i = 0; i < size; ++i)
+                buf[i] = 0.53836f - (0.46164f * std::cos((pi2 * i) / N));
+            break;
+
+        case FFTWindow::BLACKMAN:
+            for(size_t i = 0; i < size; ++i)
+                buf[i] = 0.42f - (0.5f * std::cos((pi2 * i) / N)) + (0.08f * std::cos((pi4 * i) / N));
+            break;
+
+        case FFTWindow::BLACKMAN_HARRIS:
+            for(size_t i = 0; i < size; ++i)
+                buf[i] = 0.35875f - (0.48829f * std::cos((pi2 * i) / N)) + (0.14128f * std::cos((pi4 * i) / N)) - (0.01168f * std::cos((pi6 * i) / N));
+            break;
+
+        case FFTWindow::POWER_OF_SINE:
+            for(size_t i = 0; i < size; ++i)
+                buf[i] = std::pow(std::sin((pi * i) / N), (float)sine_exponent);
+            break;
+
+        case FFTWindow::NONE:
+            std::fill(buf.get(), buf.get() + size, 1.0f);
+            break;
+
+        case FFTWindow::HANN:
+        default:
+            for(size_t i = 0; i < size; ++i)
+                buf[i] = 0.5f * (1 - std::cos((pi2 * i) / N));
+            break;
+        }
+
+        auto sum = 0.0f;
+        for(size_t i = 0; i < size; ++i)
+            sum += buf[i];
+        return sum;
+    }
+
+    void build(AnalysisTables& tables)
+    {
+        const auto& p = tables.params;
+        const auto func = (FFTWindow)p.window_func;
+
+        // window function, a window on the bins sums to its center tap at every sample
+        if(p.bin_window_gain > 0.0f)
+            tables.window_sum = p.bin_window_gain * (float)p.fft_size;
+        else if(func != FFTWindow::NONE)
+        {
+            tables.window = AnalysisBuilder::window(p.window_func, p.fft_size, p.sine_exponent);
+            tables.window_sum = tables.window->sum;
+        }
+        else
+            tables.window_sum = (float)p.fft_size;
+
+        if(p.decimation > 1)
+            tables.decimated_window = AnalysisBuilder::window(p.window_func, p.fft_size / p.decimation, p.sine_exponent);
+
+        // window normalization, slope and roll-off
+        const auto sz = p.fft_size / 2;
+        const auto window_sum = p.direct_decimation ? tables.decimated_window->sum : tables.window_sum;
+        const auto mag_coefficient = 2.0f / window_sum; // 2 * magnitude / window
+        auto& gains = tables.bin_gains;
+        gains.reset(sz);
+        for(size_t i = 0; i < sz; ++i)
+            gains[i] = mag_coefficient;
+
+        // slope
+        if(p.slope > 0.0f)
+        {
+            const auto maxmod = (float)(sz - 1);
+            for(size_t i = 0; i < sz; ++i)
+                gains[i] *= std::log10(log_interp(10.0f, 10000.0f, ((float)i * p.slope) / maxmod));
+        }
+
+        // roll-off, attenuation in dB converted to a linear factor
+        // gains that underflow are caught by the DB_MIN clamp in dbfs
+        if((p.rolloff_q > 0.0f) && (p.rolloff_rate > 0.0f))
+        {
+            const auto coeff = (float)p.sample_rate / (float)p.fft_size;
+            const auto ratio = std::exp2(p.rolloff_q);
+            const auto freq_low = (float)p.cutoff_low * ratio;
+            const auto freq_high = (float)p.cutoff_high / ratio;
+            for(size_t i = 1u; i < sz; ++i)
+            {
+                auto freq = i * coeff;
+                auto ratio_low = freq_low / freq;
+                auto ratio_high = freq / freq_high;
+                auto low_attenuation = (ratio_low > 1.0f) ? (p.rolloff_rate * std::log2(ratio_low)) : 0.0f;
+                auto high_attenuation = (ratio_high > 1.0f) ? (p.rolloff_rate * std::log2(ratio_high)) : 0.0f;
+                gains[i] *= std::pow(10.0f, -(low_attenuation + high_attenuation) / 20.0f);
+            }
+        }
+
+        tables.ready.store(true, std::memory_order_release);
+    }
+
+    void worker()
+    {
+        std::unique_lock lock(s_mtx);
+        while(true)
+        {
+            s_cv.wait(lock, [] { return s_stop || !s_pending.empty(); });
+            if(s_stop)
+                break;
+            auto tables = s_pending.front().lock();
+            s_pending.erase(s_pending.begin());
+            if(tables == nullptr)
+                continue; // superseded before we got to it
+            lock.unlock();
+            build(*tables);
+            tables.reset(); // free outside of the lock if nobody else wants them
+            lock.lock();
+        }
+    }
+}
+
+void AnalysisBuilder::start()
+{
+    std::lock_guard lock(s_mtx);
+    s_stop = false;
+    if(!s_worker.joinable())
+        s_worker = std::thread(worker);
+}
+
+void AnalysisBuilder::stop()
+{
+    {
+        std::lock_guard lock(s_mtx);
+        s_stop = true;
+        s_pending.clear();
+    }
+    s_cv.notify_all();
+    if(s_worker.joinable())
+        s_worker.join();
+}
+
+std::shared_ptr<const AnalysisTables> AnalysisBuilder::request(const AnalysisParams& params)
+{
+    std::shared_ptr<AnalysisTables> tables;
+    {
+        std::lock_guard lock(s_mtx);
+        std::erase_if(s_tables, [](const auto& weak) { return weak.expired(); });
+        for(const auto& weak : s_tables)
+        {
+            auto existing = weak.lock();
+            if((existing != nullptr) && (existing->params == params))
+                return existing;
+        }
+
+        tables = std::make_shared<AnalysisTables>(params);
+        s_tables.push_back(tables);
+        if(s_worker.joinable() && !s_stop)
+        {
+            s_pending.push_back(tables);
+            s_cv.notify_one();
+            return tables;
+        }
+    }
+
+    build(*tables);
+    return tables;
+}
+
+std::shared_ptr<const WindowTable> AnalysisBuilder::window(int window_func, size_t size, int sine_exponent)
+{
+    if((FFTWindow)window_func != FFTWindow::POWER_OF_SINE)
+        sine_exponent = 0;
+    const WindowKey key{ window_func, size, sine_exponent };
+
+    // built under the lock, a second asker for the same window waits instead of computing it again
+    std::lock_guard lock(s_window_mtx);
+    std::erase_if(s_windows, [](const auto& entry) { return entry.second.expired(); });
+    for(const auto& [k, weak] : s_windows)
+        if(k == key)
+            if(auto existing = weak.lock())
+                return existing;
+
+    auto table = std::make_shared<WindowTable>();
+    table->sum = make_window(table->coefficients, size, (FFTWindow)window_func, sine_exponent);
+    s_windows.emplace_back(key, table);
+    return table;
+}
@@ -0,0 +1,94 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include "aligned_buffer.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum class FFTWindow
+{
+    NONE,
+    HANN,
+    HAMMING,
+    BLACKMAN,
+    BLACKMAN_HARRIS,
+    POWER_OF_SINE
+};
+
+// Everything the analysis tables are built from.
+// Equal params give identical tables, sources with equal params share them.
+struct AnalysisParams
+{
+    size_t fft_size = 0;
+    size_t decimation = 1;          // the decimated window has fft_size / decimation points
+    bool direct_decimation = false; // bins come straight from the decimated transform, normalized to its window
+    int window_func = 0;            // FFTWindow
+    int sine_exponent = 0;
+    float bin_window_gain = 0.0f;   // center tap of a window applied to the bins, 0 for the time domain window
+    uint32_t sample_rate = 0;
+    float slope = 0.0f;
+    int cutoff_low = 0;
+    int cutoff_high = 0;
+    float rolloff_q = 0.0f;
+    float rolloff_rate = 0.0f;
+
+    bool operator==(const AnalysisParams&) const = default;
+};
+
+// Coefficients of one window function at one size, shared by every table that uses them.
+struct WindowTable
+{
+    AlignedBuffer<float> coefficients;
+    float sum = 0.0f;
+};
+
+// Per configuration tables of the spectrum analysis, never modified once ready.
+struct AnalysisTables
+{
+    const AnalysisParams params;
+    std::shared_ptr<const WindowTable> window;              // null without a window function or with one on the bins
+    float window_sum = 1.0f;                                // fft_size without a window function
+    std::shared_ptr<const WindowTable> decimated_window;    // only with decimation, flat without a window function
+    AlignedBuffer<float> bin_gains;         // per bin linear gain, window normalization * slope * roll-off
+
+    // set by the worker after it wrote the tables above, read nothing before it's true
+    std::atomic<bool> ready = false;
+
+    explicit AnalysisTables(const AnalysisParams& p) : params(p) {}
+};
+
+// Builds analysis tables on a worker thread so update() doesn't compute windows and gains
+// on the UI thread with the source locked.
+// tick picks them up once ready, swapping a single pointer, and keeps the last spectrum until then.
+// Requests nobody holds anymore (e.g. intermediate values while dragging a slider) are skipped.
+class AnalysisBuilder
+{
+public:
+    static void start();    // start the worker
+    static void stop();     // stop the worker, only once every source is gone
+
+    // tables for params, shared with every other holder of equal params
+    // built right away if the worker isn't running
+    static std::shared_ptr<const AnalysisTables> request(const AnalysisParams& params);
+
+    // coefficients of window_func (FFTWindow, NONE is flat) at size, computed once for all holders
+    static std::shared_ptr<const WindowTable> window(int window_func, size_t size, int sine_exponent);
+};
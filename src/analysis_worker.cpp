@@ -0,0 +1,329 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "analysis_worker.hpp"
+#include "module.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <avrt.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <pthread/qos.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    struct Job
+    {
+        const void *owner;
+        std::function<void()> run;
+    };
+
+    std::mutex s_mtx;
+    std::condition_variable s_cv;       // new jobs or stop
+    std::condition_variable s_done_cv;  // a job finished
+    std::vector<Job> s_queue;           // oldest first
+    std::vector<const void*> s_running; // owners with a job on a thread right now
+    bool s_stop = false;
+    std::vector<std::thread> s_threads;
+
+    struct Phase
+    {
+        const void *owner;
+        uint32_t interval;
+        uint32_t phase;
+    };
+
+    std::mutex s_phase_mtx;
+    std::vector<Phase> s_phases;
+
+    // priority and cores of the threads, from the [analysis] section of the module config.ini
+    // priority=high raises the threads above normal, priority=realtime asks for
+    // MMCSS "Pro Audio" on Windows, SCHED_FIFO on Linux (nice -10 without the rights for it)
+    // and the user interactive QoS class on macOS, which is also what high gets there
+    // affinity=0x... limits the threads to the cores of the mask, exclude=0x... keeps them off those
+    // cores past the 64th and affinity on macOS aren't supported
+    enum class Priority
+    {
+        NORMAL,
+        HIGH,
+        REALTIME
+    };
+
+    struct Tuning
+    {
+        Priority priority = Priority::NORMAL;
+        uint64_t cores = 0; // 0 for every core
+    };
+
+    Tuning s_tuning;                        // set by start() before the threads are
+    std::atomic<bool> s_tuning_warned = false;
+
+    uint64_t parse_mask(const std::string& str)
+    {
+        try
+        {
+            return str.empty() ? 0 : std::stoull(str, nullptr, 0);
+        }
+        catch(const std::exception&)
+        {
+            LogWarn << "Invalid core mask \"" << str << "\" in the module config";
+            return 0;
+        }
+    }
+
+    Tuning read_tuning()
+    {
+        Tuning tuning;
+        const auto priority = module_config_string("analysis", "priority");
+        if(priority == "high")
+            tuning.priority = Priority::HIGH;
+        else if(priority == "realtime")
+            tuning.priority = Priority::REALTIME;
+        else if(!priority.empty() && (priority != "normal"))
+            LogWarn << "Unknown analysis thread priority \"" << priority << "\"";
+
+        const auto cores = std::min(std::max(std::thread::hardware_concurrency(), 1u), 64u);
+        const auto all = (cores < 64) ? ((uint64_t)1 << cores) - 1 : ~(uint64_t)0;
+        auto mask = parse_mask(module_config_string("analysis", "affinity"));
+        mask = ((mask != 0) ? mask : all) & ~parse_mask(module_config_string("analysis", "exclude")) & all;
+        if(mask == 0)
+            LogWarn << "Analysis thread core masks leave no cores, using all of them";
+        else if(mask != all)
+            tuning.cores = mask;
+        return tuning;
+    }
+
+    void warn_tuning(const char *what)
+    {
+        // the same for every thread, said once
+        if(!s_tuning_warned.exchange(true))
+            LogWarn << "Analysis threads: " << what;
+    }
+
+    // on the thread itself
+    void apply_tuning(const Tuning& tuning)
+    {
+#ifdef _WIN32
+        if(tuning.priority == Priority::REALTIME)
+        {
+            DWORD task = 0;
+            if(AvSetMmThreadCharacteristicsW(L"Pro Audio", &task) == nullptr)
+                warn_tuning("MMCSS Pro Audio not available");
+        }
+        else if((tuning.priority == Priority::HIGH) && !SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST))
+            warn_tuning("failed to raise the priority");
+        if((tuning.cores != 0) && (SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)tuning.cores) == 0))
+            warn_tuning("failed to set the core affinity");
+#elif defined(__APPLE__)
+        if((tuning.priority != Priority::NORMAL) && (pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0) != 0))
+            warn_tuning("failed to set the QoS class");
+        if(tuning.cores != 0)
+            warn_tuning("core affinity is not supported on macOS");
+#elif defined(__linux__)
+        auto niced = tuning.priority == Priority::HIGH;
+        if(tuning.priority == Priority::REALTIME)
+        {
+            // low in the FIFO range, above every normal thread but below the audio servers
+            sched_param param{};
+            param.sched_priority = std::min(sched_get_priority_min(SCHED_FIFO) + 9, sched_get_priority_max(SCHED_FIFO));
+            niced = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0;
+        }
+        // the nice value of a Linux thread is its own, set through its id
+        if(niced && (setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), -10) != 0))
+            warn_tuning("no rights for a higher priority (rtprio or CAP_SYS_NICE)");
+        if(tuning.cores != 0)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for(auto i = 0; i < 64; ++i)
+                if(tuning.cores & ((uint64_t)1 << i))
+                    CPU_SET(i, &set);
+            if(pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+                warn_tuning("failed to set the core affinity");
+        }
+#else
+        if((tuning.priority != Priority::NORMAL) || (tuning.cores != 0))
+            warn_tuning("priority and core affinity are not supported on this platform");
+#endif
+    }
+
+    // one thread per core but the video thread's, unless the module config says otherwise
+    // [analysis] threads=N in config.ini of the module config directory, 0 or missing for automatic
+    // the automatic count only goes by the cores the threads may use
+    constexpr unsigned int MAX_AUTO_THREADS = 8;
+
+    unsigned int thread_count(const Tuning& tuning)
+    {
+        const auto hw = std::max(std::thread::hardware_concurrency(), 1u);
+        const auto configured = module_config_uint("analysis", "threads");
+        if(configured > 0)
+            return (unsigned int)std::min<uint64_t>(configured, hw);
+        if(tuning.cores != 0)
+            return std::clamp((unsigned int)std::popcount(tuning.cores), 1u, MAX_AUTO_THREADS);
+        return std::clamp(hw - 1, 1u, MAX_AUTO_THREADS);
+    }
+
+    bool busy(const void *owner)
+    {
+        return (std::find(s_running.begin(), s_running.end(), owner) != s_running.end())
+            || std::any_of(s_queue.begin(), s_queue.end(), [owner](const Job& job) { return job.owner == owner; });
+    }
+
+    void worker()
+    {
+        apply_tuning(s_tuning);
+        std::unique_lock lock(s_mtx);
+        while(true)
+        {
+            s_cv.wait(lock, [] { return s_stop || !s_queue.empty(); });
+            if(s_stop)
+                break;
+            auto job = std::move(s_queue.front());
+            s_queue.erase(s_queue.begin());
+            s_running.push_back(job.owner);
+            lock.unlock();
+            job.run();
+            job.run = nullptr; // release captures outside of the lock
+            lock.lock();
+            s_running.erase(std::find(s_running.begin(), s_running.end(), job.owner));
+            s_done_cv.notify_all();
+        }
+    }
+}
+
+void AnalysisWorker::start()
+{
+    std::lock_guard lock(s_mtx);
+    s_stop = false;
+    if(!s_threads.empty())
+        return;
+    s_tuning = read_tuning();
+    s_tuning_warned = false;
+    const auto count = thread_count(s_tuning);
+    for(auto i = 0u; i < count; ++i)
+        s_threads.emplace_back(worker);
+    LogInfo << "Analysis on " << count << " worker threads";
+    if(s_tuning.priority != Priority::NORMAL)
+        LogInfo << "Analysis threads at " << ((s_tuning.priority == Priority::REALTIME) ? "realtime" : "high") << " priority";
+    if(s_tuning.cores != 0)
+    {
+        char mask[24];
+        std::snprintf(mask, sizeof(mask), "0x%llx", (unsigned long long)s_tuning.cores);
+        LogInfo << "Analysis threads on cores " << mask;
+    }
+}
+
+void AnalysisWorker::stop()
+{
+    {
+        std::lock_guard lock(s_mtx);
+        s_stop = true;
+        s_queue.clear();
+    }
+    s_cv.notify_all();
+    for(auto& thread : s_threads)
+        thread.join();
+    s_threads.clear();
+}
+
+bool AnalysisWorker::queue(const void *owner, std::function<void()> job)
+{
+    {
+        std::lock_guard lock(s_mtx);
+        if(busy(owner))
+            return false;
+        if(!s_threads.empty() && !s_stop)
+        {
+            s_queue.push_back({ owner, std::move(job) });
+            s_cv.notify_one();
+            return true;
+        }
+    }
+
+    job();
+    return true;
+}
+
+void AnalysisWorker::wait(const void *owner)
+{
+    std::unique_lock lock(s_mtx);
+    auto it = std::find_if(s_queue.begin(), s_queue.end(), [owner](const Job& job) { return job.owner == owner; });
+    if(it != s_queue.end())
+    {
+        // nobody got to it yet, run it here instead of waiting for a thread to free up
+        auto job = std::move(*it);
+        s_queue.erase(it);
+        s_running.push_back(owner);
+        lock.unlock();
+        job.run();
+        job.run = nullptr;
+        lock.lock();
+        s_running.erase(std::find(s_running.begin(), s_running.end(), owner));
+        s_done_cv.notify_all();
+        return;
+    }
+    s_done_cv.wait(lock, [owner] { return std::find(s_running.begin(), s_running.end(), owner) == s_running.end(); });
+}
+
+void AnalysisWorker::cancel(const void *owner)
+{
+    {
+        std::lock_guard lock(s_phase_mtx);
+        std::erase_if(s_phases, [owner](const Phase& phase) { return phase.owner == owner; });
+    }
+    std::unique_lock lock(s_mtx);
+    std::erase_if(s_queue, [owner](const Job& job) { return job.owner == owner; });
+    s_done_cv.wait(lock, [owner] { return std::find(s_running.begin(), s_running.end(), owner) == s_running.end(); });
+}
+
+uint32_t AnalysisWorker::assign_phase(const void *owner, uint32_t interval)
+{
+    std::lock_guard lock(s_phase_mtx);
+    std::erase_if(s_phases, [owner](const Phase& phase) { return phase.owner == owner; });
+    if(interval <= 1)
+        return 0;
+
+    // least used phase among owners on the same interval
+    std::vector<uint32_t> counts(interval);
+    for(const auto& phase : s_phases)
+        if(phase.interval == interval)
+            ++counts[phase.phase];
+    const auto phase = (uint32_t)(std::min_element(counts.begin(), counts.end()) - counts.begin());
+    s_phases.push_back({ owner, interval, phase });
+    return phase;
+}
@@ -0,0 +1,47 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <cstdint>
+#include <functional>
+
+// Pooled threads running source analysis, so FFTs and the rest of the DSP stay off the OBS video thread.
+// Each owner has at most one job queued or running at a time, the jobs of different owners run in parallel.
+// Threads take the oldest job of a single queue, so a slow source never holds up the jobs behind it.
+class AnalysisWorker
+{
+public:
+    static void start();    // start the threads
+    static void stop();     // stop the threads, queued jobs are dropped
+
+    // run job on a worker thread, right away on this one if none are running
+    // returns false without taking the job if owner's last one hasn't finished yet
+    static bool queue(const void *owner, std::function<void()> job);
+
+    // wait for owner's job, one nobody started yet runs on the calling thread
+    static void wait(const void *owner);
+
+    // drop owner's queued job and wait for a running one, call before destroying what jobs use
+    // also gives up owner's phase
+    static void cancel(const void *owner);
+
+    // phase in [0, interval) for an owner analyzing every interval video frames
+    // owners with the same interval are spread evenly over the phases so their frames don't line up
+    // replaces owner's previous phase, an interval of 1 or less just gives it up
+    static uint32_t assign_phase(const void *owner, uint32_t interval);
+};
@@ -0,0 +1,68 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "buffer_arena.hpp"
+#include <new>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+BufferArena::Block BufferArena::allocate(std::size_t bytes)
+{
+    if(s_large_pages.load(std::memory_order_relaxed) && (bytes >= LARGE_PAGE_MIN))
+    {
+#ifdef _WIN32
+        // needs the lock pages in memory privilege, without it this fails and normal pages are used
+        const auto page = GetLargePageMinimum();
+        if(page > 0)
+        {
+            const auto size = (bytes + page - 1) & ~(page - 1);
+            auto p = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if(p != nullptr)
+                return Block(static_cast<std::byte*>(p), Deleter{ size });
+        }
+#elif defined(__linux__)
+        // a hint, the kernel backs what it can with huge pages when THP is "always" or "madvise"
+        const auto size = (bytes + LARGE_PAGE_MIN - 1) & ~(LARGE_PAGE_MIN - 1);
+        auto p = ::operator new(size, std::align_val_t{ LARGE_PAGE_MIN });
+#ifdef MADV_HUGEPAGE
+        madvise(p, size, MADV_HUGEPAGE);
+#endif
+        return Block(static_cast<std::byte*>(p), Deleter{ size });
+#endif
+    }
+    return Block(static_cast<std::byte*>(::operator new(bytes, std::align_val_t{ BLOCK_ALIGNMENT })), Deleter{ 0 });
+}
+
+void BufferArena::Deleter::operator()(std::byte *p) const
+{
+    if(large == 0)
+    {
+        ::operator delete(p, std::align_val_t{ BLOCK_ALIGNMENT });
+        return;
+    }
+#ifdef _WIN32
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    ::operator delete(p, std::align_val_t{ LARGE_PAGE_MIN });
+#endif
+}
@@ -0,0 +1,107 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include "aligned_buffer.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// One allocation carved into AlignedBuffers, for buffers that are rebuilt together.
+// add() every buffer of the layout, then commit() allocates and binds them all at once.
+// The block is kept for the next layout unless it's too small or over four times too large,
+// so rebuilding with similar sizes allocates nothing.
+// Bound buffers don't own their memory, they must be reset or rebound before the next commit().
+// With set_large_pages() blocks of LARGE_PAGE_MIN bytes or more are backed by large pages where the OS allows,
+// transparent huge pages on Linux, MEM_LARGE_PAGES on Windows, falling back to normal pages.
+class BufferArena
+{
+public:
+    // a cache line, adjacent buffers don't share one
+    static constexpr std::size_t SLICE_ALIGNMENT = (WAVEFORM_BUFFER_ALIGNMENT > 64) ? WAVEFORM_BUFFER_ALIGNMENT : 64;
+    static constexpr std::size_t BLOCK_ALIGNMENT = 4096;
+    static constexpr std::size_t LARGE_PAGE_MIN = 2 << 20;
+
+    static void set_large_pages(bool enable) noexcept { s_large_pages.store(enable, std::memory_order_relaxed); }
+
+    BufferArena() = default;
+    BufferArena(const BufferArena&) = delete;
+    BufferArena& operator=(const BufferArena&) = delete;
+
+    template<typename T>
+    void add(AlignedBuffer<T>& buf, std::size_t count)
+    {
+        static_assert(alignof(T) <= SLICE_ALIGNMENT);
+        m_used = (m_used + SLICE_ALIGNMENT - 1) & ~(SLICE_ALIGNMENT - 1);
+        m_slots.push_back({ &buf, count, m_used, [](void *b, std::byte *p, std::size_t n) {
+            static_cast<AlignedBuffer<T>*>(b)->bind(reinterpret_cast<T*>(p), n);
+            } });
+        m_used += count * sizeof(T);
+    }
+
+    // allocate if needed and bind every buffer added since the last commit()
+    void commit()
+    {
+        if((m_used > m_capacity) || (m_used < m_capacity / 4))
+        {
+            m_block.reset();
+            m_capacity = 0;
+            if(m_used > 0)
+            {
+                // headroom so a slider dragged upward doesn't reallocate every step
+                const auto capacity = m_used + (m_used / 4);
+                m_block = allocate(capacity);
+                m_capacity = capacity;
+            }
+        }
+        for(const auto& slot : m_slots)
+            slot.bind(slot.buf, m_block.get() + slot.offset, slot.count);
+        m_slots.clear();
+        m_used = 0;
+    }
+
+    void release() { m_slots.clear(); m_used = 0; m_block.reset(); m_capacity = 0; }
+    std::size_t capacity() const noexcept { return m_capacity; }    // bytes
+
+private:
+    struct Slot
+    {
+        void *buf;
+        std::size_t count;
+        std::size_t offset;
+        void (*bind)(void *buf, std::byte *p, std::size_t count);
+    };
+
+    struct Deleter
+    {
+        Deleter() noexcept : large(0) {}
+        explicit Deleter(std::size_t bytes) noexcept : large(bytes) {}
+        void operator()(std::byte *p) const;
+        std::size_t large;      // bytes mapped for large pages, 0 for operator new
+    };
+    using Block = std::unique_ptr<std::byte, Deleter>;
+
+    static Block allocate(std::size_t bytes);
+    static inline std::atomic<bool> s_large_pages = false;
+
+    Block m_block;
+    std::size_t m_capacity = 0;
+    std::size_t m_used = 0;     // bytes laid out so far
+    std::vector<Slot> m_slots;
+};
@@ -0,0 +1,583 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "capture_hub.hpp"
+#include "profile_scope.hpp"
+#include <util/platform.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <vector>
+
+#ifdef ENABLE_X86_SIMD
+#include <emmintrin.h>
+#elif defined(ENABLE_ARM_SIMD)
+#include <arm_neon.h>
+#endif
+
+// int16 history to float, sse2 is part of the x86-64 baseline
+static void expand_history(const int16_t *src, std::size_t count, float scale, float *dst) noexcept
+{
+    std::size_t i = 0;
+#ifdef ENABLE_X86_SIMD
+    const auto factor = _mm_set1_ps(scale);
+    for(; i + 8 <= count; i += 8)
+    {
+        const auto v = _mm_loadu_si128((const __m128i*)&src[i]);
+        const auto low = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);   // sign extend
+        const auto high = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_cvtepi32_ps(low), factor));
+        _mm_storeu_ps(&dst[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(high), factor));
+    }
+#elif defined(ENABLE_ARM_SIMD)
+    for(; i + 8 <= count; i += 8)
+    {
+        const auto v = vld1q_s16(&src[i]);
+        vst1q_f32(&dst[i], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+        vst1q_f32(&dst[i + 4], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+#endif
+    for(; i < count; ++i)
+        dst[i] = (float)src[i] * scale;
+}
+
+// float block to int16 scaled by its peak, returns the scale, NaN is stored as the peak
+static float quantize_history(const float *src, std::size_t count, int16_t *dst) noexcept
+{
+    auto peak = 0.0f;
+    for(auto i = 0u; i < count; ++i)
+        peak = std::max(peak, std::abs(src[i]));
+    peak = std::min(peak, std::numeric_limits<float>::max());
+    if(peak == 0.0f)
+    {
+        std::memset(dst, 0, count * sizeof(int16_t));
+        return 0.0f;
+    }
+    const auto factor = 32767.0f / peak;
+    for(auto i = 0u; i < count; ++i)
+        dst[i] = (int16_t)std::lrint(std::fmax(std::fmin(src[i] * factor, 32767.0f), -32767.0f));
+    return peak / 32767.0f;
+}
+
+void AudioClock::reset(uint32_t sample_rate) noexcept
+{
+    m_sample_rate = sample_rate;
+    m_nominal = (sample_rate > 0) ? 1000000000.0 / sample_rate : 0.0;
+    m_period = m_nominal;
+    m_anchor = 0;
+    m_ts = 0.0;
+    m_valid = false;
+}
+
+uint64_t AudioClock::update(uint64_t measured_ts, std::size_t frames) noexcept
+{
+    const auto predicted = m_ts + (m_period * (double)frames);
+    const auto err = (double)((int64_t)measured_ts - m_anchor) - predicted;
+    if(!m_valid || (frames == 0) || (std::abs(err) > RESYNC_THRESHOLD))
+    {
+        m_anchor = (int64_t)measured_ts;
+        m_ts = 0.0;
+        m_period = m_nominal;
+        m_valid = (m_sample_rate > 0);
+        return measured_ts;
+    }
+
+    // loop coefficients depend on the block length, OBS blocks are usually but not always the same size
+    const auto omega = 2.0 * std::numbers::pi * BANDWIDTH * ((double)frames / m_sample_rate);
+    m_ts = predicted + (std::numbers::sqrt2 * omega * err);
+    m_period += (omega * omega * err) / (double)frames;
+    m_period = std::clamp(m_period, m_nominal * (1.0 - MAX_DRIFT), m_nominal * (1.0 + MAX_DRIFT));
+    return (uint64_t)(m_anchor + std::llround(m_ts));
+}
+
+// registry of live streams, entries expire with their last reader
+static std::mutex s_streams_mtx;
+static std::map<CaptureStream::Key, std::weak_ptr<CaptureStream>> s_streams;
+
+static std::shared_ptr<CaptureStream> find_stream(const CaptureStream::Key& key)
+{
+    auto it = s_streams.find(key);
+    if(it == s_streams.end())
+        return nullptr;
+    auto ret = it->second.lock();
+    if(ret == nullptr)
+        s_streams.erase(it);
+    return ret;
+}
+
+std::shared_ptr<CaptureStream> CaptureStream::get_source_stream(obs_source_t *source, bool ignore_mute)
+{
+    if(source == nullptr)
+        return nullptr;
+
+    std::lock_guard lock(s_streams_mtx);
+    auto weak = obs_source_get_weak_source(source);
+    Key key{ weak, ignore_mute, 0 };
+    auto ret = find_stream(key);
+    if(ret != nullptr)
+    {
+        obs_weak_source_release(weak);
+        return ret;
+    }
+
+    // the stream takes over our weak reference
+    ret.reset(new CaptureStream(weak, ignore_mute));
+    if(!ret->attach())
+        return nullptr;
+    s_streams[key] = ret;
+    return ret;
+}
+
+std::shared_ptr<CaptureStream> CaptureStream::get_output_stream(std::size_t mix_idx)
+{
+    if(mix_idx >= MAX_AUDIO_MIXES)
+        return nullptr;
+
+    std::lock_guard lock(s_streams_mtx);
+    Key key{ nullptr, true, mix_idx };
+    auto ret = find_stream(key);
+    if(ret != nullptr)
+        return ret;
+
+    ret.reset(new CaptureStream(nullptr, true, mix_idx));
+    if(!ret->attach())
+        return nullptr;
+    s_streams[key] = ret;
+    return ret;
+}
+
+CaptureStream::CaptureStream(obs_weak_source_t *source, bool ignore_mute, std::size_t mix_idx)
+    : m_source(source), m_ignore_mute(ignore_mute), m_mix_idx(mix_idx)
+{
+    if(!obs_get_audio_info(&m_audio_info))
+    {
+        m_audio_info.samples_per_sec = 44100;
+        m_audio_info.speakers = SPEAKERS_UNKNOWN;
+    }
+    m_channels = std::min(get_audio_channels(m_audio_info.speakers), (uint32_t)MAX_AUDIO_CHANNELS);
+    m_sample_rate = m_audio_info.samples_per_sec;
+    m_clock.reset(m_sample_rate);
+    m_capture_ts.store(os_gettime_ns(), std::memory_order_relaxed);
+    m_compact_history = s_compact_history.load(std::memory_order_relaxed);
+    resize(AUDIO_OUTPUT_FRAMES * 4);
+}
+
+CaptureStream::~CaptureStream()
+{
+    detach();
+    if(m_source != nullptr)
+        obs_weak_source_release(m_source);
+}
+
+bool CaptureStream::attach()
+{
+    if(m_attached)
+        return true;
+    if(m_channels == 0)
+        return false;
+
+    if(m_source == nullptr)
+    {
+        auto audio = obs_get_audio();
+        auto info = audio_output_get_info(audio);
+        if((info->format == audio_format::AUDIO_FORMAT_FLOAT_PLANAR) && (info->samples_per_sec == m_audio_info.samples_per_sec) && (info->speakers == m_audio_info.speakers))
+        {
+            m_attached = audio_output_connect(audio, m_mix_idx, nullptr, &output_callback, this);
+        }
+        else
+        {
+            audio_convert_info cvt{};
+            cvt.format = audio_format::AUDIO_FORMAT_FLOAT_PLANAR;
+            cvt.samples_per_sec = m_audio_info.samples_per_sec;
+            cvt.speakers = m_audio_info.speakers;
+            m_attached = audio_output_connect(audio, m_mix_idx, &cvt, &output_callback, this);
+        }
+    }
+    else
+    {
+        auto src = obs_weak_source_get_source(m_source);
+        if(src == nullptr)
+            return false;
+        obs_source_add_audio_capture_callback(src, &source_callback, this);
+        obs_source_release(src);
+        m_attached = true;
+    }
+
+    return m_attached;
+}
+
+void CaptureStream::detach()
+{
+    // both of these wait for an in-flight callback to finish
+    if(!m_attached)
+        return;
+    m_attached = false;
+
+    if(m_source == nullptr)
+        audio_output_disconnect(obs_get_audio(), m_mix_idx, &output_callback, this);
+    else
+    {
+        auto src = obs_weak_source_get_source(m_source);
+        if(src != nullptr)
+        {
+            obs_source_remove_audio_capture_callback(src, &source_callback, this);
+            obs_source_release(src);
+        }
+    }
+}
+
+// not thread-safe, the callback must be detached
+void CaptureStream::resize(std::size_t capacity)
+{
+    capacity = std::bit_ceil(capacity);
+    if(capacity <= m_capacity)
+        return;
+
+    const auto hot = m_compact_history ? std::min(capacity, HOT_CAPACITY) : capacity;
+
+    // the producer starts one full ring in so that readers can prime from silence
+    auto head = m_head.load(std::memory_order_relaxed);
+    const auto old_capacity = m_capacity;
+    std::vector<float> old;
+    if(old_capacity == 0)
+        head = capacity;
+    else
+    {
+        // carry over the existing history, positions stay valid
+        old.resize(old_capacity * m_channels);
+        const auto history_end = m_history_end.load(std::memory_order_relaxed);
+        for(auto channel = 0u; channel < m_channels; ++channel)
+            read(channel, head - old_capacity, old_capacity, &old[channel * old_capacity], history_end);
+    }
+
+    m_buf.reset(hot * m_channels);
+    std::memset(m_buf.get(), 0, hot * m_channels * sizeof(float));
+    m_capacity = capacity;
+    m_mask = capacity - 1;
+    m_hot_capacity = hot;
+    m_hot_mask = hot - 1;
+
+    // the newest half of the float ring is never read from the history
+    std::size_t history_end = 0;
+    if(compact())
+    {
+        m_history.reset(capacity * m_channels);
+        m_history_scale.reset((capacity / HISTORY_BLOCK) * m_channels);
+        std::memset(m_history.get(), 0, capacity * m_channels * sizeof(int16_t));
+        std::memset(m_history_scale.get(), 0, (capacity / HISTORY_BLOCK) * m_channels * sizeof(float));
+        history_end = (head - (hot / 2) + (HISTORY_BLOCK - 1)) & ~(HISTORY_BLOCK - 1);
+    }
+    else
+    {
+        m_history.reset();
+        m_history_scale.reset();
+    }
+
+    const auto start = head - old_capacity;
+    for(auto channel = 0u; channel < m_channels; ++channel)
+    {
+        const auto src = old.data() + (channel * old_capacity);
+        auto ring = &m_buf[channel * hot];
+        for(std::size_t i = 0; i < std::min(old_capacity, hot); ++i)
+        {
+            const auto pos = head - i - 1;
+            ring[pos & m_hot_mask] = src[pos - start];
+        }
+
+        // blocks straddling the start of the old ring are padded with silence
+        float block[HISTORY_BLOCK];
+        for(auto pos = start & ~(HISTORY_BLOCK - 1); compact() && ((std::ptrdiff_t)(history_end - pos) > 0); pos += HISTORY_BLOCK)
+        {
+            for(auto i = 0u; i < HISTORY_BLOCK; ++i)
+            {
+                const auto offset = pos + i - start;
+                block[i] = (offset < old_capacity) ? src[offset] : 0.0f;
+            }
+            const auto idx = pos & m_mask;
+            m_history_scale[(channel * (capacity / HISTORY_BLOCK)) + (idx / HISTORY_BLOCK)] = quantize_history(block, HISTORY_BLOCK, &m_history[(channel * capacity) + idx]);
+        }
+    }
+
+    m_head.store(head, std::memory_order_relaxed);
+    m_history_end.store(history_end, std::memory_order_relaxed);
+}
+
+void CaptureStream::quantize_block(std::size_t pos) noexcept
+{
+    const auto idx = pos & m_mask;
+    for(auto channel = 0u; channel < m_channels; ++channel)
+    {
+        const auto src = &m_buf[(channel * m_hot_capacity) + (pos & m_hot_mask)];
+        m_history_scale[(channel * (m_capacity / HISTORY_BLOCK)) + (idx / HISTORY_BLOCK)] = quantize_history(src, HISTORY_BLOCK, &m_history[(channel * m_capacity) + idx]);
+    }
+}
+
+void CaptureStream::read_history(uint32_t channel, std::size_t pos, std::size_t count, float *dst) const noexcept
+{
+    // blocks never straddle the end of the ring
+    while(count > 0)
+    {
+        const auto idx = pos & m_mask;
+        const auto n = std::min(count, HISTORY_BLOCK - (idx & (HISTORY_BLOCK - 1)));
+        const auto scale = m_history_scale[(channel * (m_capacity / HISTORY_BLOCK)) + (idx / HISTORY_BLOCK)];
+        expand_history(&m_history[(channel * m_capacity) + idx], n, scale, dst);
+        dst += n;
+        pos += n;
+        count -= n;
+    }
+}
+
+void CaptureStream::read(uint32_t channel, std::size_t pos, std::size_t count, float *dst, std::size_t history_end) const noexcept
+{
+    // positions are free running, compare their distance
+    if(compact() && ((std::ptrdiff_t)(history_end - pos) > 0))
+    {
+        const auto n = std::min(count, history_end - pos);
+        read_history(channel, pos, n, dst);
+        dst += n;
+        pos += n;
+        count -= n;
+    }
+    const auto ring = &m_buf[channel * m_hot_capacity];
+    const auto idx = pos & m_hot_mask;
+    const auto first = std::min(count, m_hot_capacity - idx);
+    std::memcpy(dst, &ring[idx], first * sizeof(float));
+    std::memcpy(dst + first, ring, (count - first) * sizeof(float));
+}
+
+void CaptureStream::reserve(std::size_t history)
+{
+    // readers only trust the older half of the ring, the rest is headroom for the producer
+    const auto capacity = std::bit_ceil(history * 2);
+    std::lock_guard lock(m_mtx);
+    if(capacity <= m_capacity)
+        return;
+    const auto attached = m_attached;
+    detach();
+    resize(capacity);
+    if(attached)
+        attach();
+}
+
+// lock must be held
+void CaptureStream::replace_log(std::shared_ptr<CaptureLog> log)
+{
+    if(log == m_log)
+        return;
+    const auto attached = m_attached;
+    detach();
+    m_log = std::move(log);
+    if(attached)
+        attach();
+}
+
+void CaptureStream::set_log(std::shared_ptr<CaptureLog> log)
+{
+    std::lock_guard lock(m_mtx);
+    replace_log(std::move(log));
+}
+
+void CaptureStream::drop_log(const CaptureLog *log)
+{
+    std::lock_guard lock(m_mtx);
+    if((log != nullptr) && (m_log.get() == log))
+        replace_log(nullptr);
+}
+
+void CaptureStream::capture(const audio_data *audio, bool muted)
+{
+    if(audio == nullptr)
+        return;
+    const ProfileScope scope("waveform capture push");
+
+    // audio sync
+    const auto capture_ts = os_gettime_ns();
+    if(m_log != nullptr)
+        m_log->push_block(audio, m_channels, muted, capture_ts);
+    auto audio_len = audio_frames_to_ns(m_sample_rate, audio->frames);
+    auto delta = std::max(audio->timestamp, capture_ts) - std::min(audio->timestamp, capture_ts);
+    const auto measured_ts = (delta > MAX_TS_DELTA) ? capture_ts : audio->timestamp + audio_len; // attempt to handle extreme / bogus timestamps (e.g. VLC)
+    const auto frames = (std::size_t)audio->frames;
+    const auto audio_ts = m_clock.update(measured_ts, frames);
+
+    // a block larger than the ring only keeps its newest samples
+    // compact rings keep a block of headroom in the newest half of the float ring for the history to catch up
+    const auto head = m_head.load(std::memory_order_relaxed);
+    const auto count = std::min(frames, compact() ? (m_hot_capacity / 2) - HISTORY_BLOCK : m_capacity);
+    const auto skip = frames - count;
+    const auto pos = (head + skip) & m_hot_mask;
+    const auto first = std::min(count, m_hot_capacity - pos);
+
+    // move complete blocks about to leave the newest half of the float ring into the history
+    // readers only look below the published end, so the blocks are written outside the seqlock
+    auto history_end = m_history_end.load(std::memory_order_relaxed);
+    if(compact())
+    {
+        const auto target = head + frames - (m_hot_capacity / 2);
+        while(((std::ptrdiff_t)(target - history_end) > 0) && ((std::ptrdiff_t)(head - history_end) >= (std::ptrdiff_t)HISTORY_BLOCK))
+        {
+            quantize_block(history_end);
+            history_end += HISTORY_BLOCK;
+        }
+        if((std::ptrdiff_t)(target - history_end) > 0)
+            history_end = (target + (HISTORY_BLOCK - 1)) & ~(HISTORY_BLOCK - 1); // truncated, skipped blocks keep stale data
+    }
+
+    const auto seq = m_seq.load(std::memory_order_relaxed);
+    m_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for(auto channel = 0u; channel < m_channels; ++channel)
+    {
+        auto ring = &m_buf[channel * m_hot_capacity];
+        auto data = (const float*)audio->data[channel];
+        if((muted && !m_ignore_mute) || (data == nullptr))
+        {
+            std::memset(&ring[pos], 0, first * sizeof(float));
+            std::memset(ring, 0, (count - first) * sizeof(float));
+        }
+        else
+        {
+            std::memcpy(&ring[pos], data + skip, first * sizeof(float));
+            std::memcpy(ring, data + skip + first, (count - first) * sizeof(float));
+
+            // track the newest nonzero sample so readers can detect silence without scanning
+            // searching backwards stops right away on anything but silence, NaN counts as nonzero
+            for(auto i = count; i > 0; --i)
+            {
+                if(!(data[skip + i - 1] == 0.0f))
+                {
+                    m_signal_end[channel].store(head + skip + i, std::memory_order_relaxed);
+                    break;
+                }
+            }
+        }
+    }
+
+    m_head.store(head + frames, std::memory_order_relaxed);
+    m_history_end.store(history_end, std::memory_order_relaxed);
+    m_capture_ts.store(capture_ts, std::memory_order_relaxed);
+    m_audio_ts.store(audio_ts, std::memory_order_relaxed);
+    m_seq.store(seq + 2, std::memory_order_release);
+
+    // single producer, no need for a locked increment
+    m_blocks.store(m_blocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if(skip > 0)
+        m_truncated_samples.store(m_truncated_samples.load(std::memory_order_relaxed) + skip, std::memory_order_relaxed);
+}
+
+void CaptureStream::source_callback(void *data, [[maybe_unused]] obs_source_t *source, const audio_data *audio, bool muted)
+{
+    static_cast<CaptureStream*>(data)->capture(audio, muted);
+}
+
+void CaptureStream::output_callback(void *data, [[maybe_unused]] size_t mix_idx, audio_data *audio)
+{
+    static_cast<CaptureStream*>(data)->capture(audio, false);
+}
+
+bool CaptureReader::attach(std::shared_ptr<CaptureStream> stream, uint32_t base, uint32_t count, std::size_t history, std::size_t prime)
+{
+    detach();
+    if((stream == nullptr) || (count == 0) || (count > MAX_CHANNELS) || ((base + count) > stream->channels()))
+        return false;
+
+    stream->reserve(std::max(history, prime));
+    m_stream = std::move(stream);
+    m_base = base;
+    m_count = count;
+
+    latch();
+    for(auto i = 0u; i < m_count; ++i)
+        m_tail[i] = m_head - prime;
+    return true;
+}
+
+void CaptureReader::detach()
+{
+    m_stream.reset();
+    m_count = 0;
+    m_head = 0;
+    for(auto& i : m_tail)
+        i = 0;
+    m_history_end = 0;
+    m_capture_ts = 0;
+    m_audio_ts = 0;
+    m_overrun_samples = 0;
+}
+
+void CaptureReader::latch()
+{
+    if(m_stream == nullptr)
+        return;
+
+    // seqlock reader, the audio thread holds an odd sequence number while it's writing
+    auto& stream = *m_stream;
+    std::lock_guard lock(stream.m_mtx);
+    uint32_t seq;
+    do
+    {
+        seq = stream.m_seq.load(std::memory_order_acquire);
+        m_head = stream.m_head.load(std::memory_order_relaxed);
+        m_capture_ts = stream.m_capture_ts.load(std::memory_order_relaxed);
+        m_audio_ts = stream.m_audio_ts.load(std::memory_order_relaxed);
+        m_history_end = stream.m_history_end.load(std::memory_order_relaxed);
+        for(auto i = 0u; i < m_count; ++i)
+            m_signal_end[i] = stream.m_signal_end[m_base + i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while((seq & 1) || (seq != stream.m_seq.load(std::memory_order_relaxed)));
+
+    // skip ahead if we fell so far behind that the producer is overwriting our data
+    const auto max_size = stream.m_capacity / 2;
+    std::size_t overrun = 0;
+    for(auto i = 0u; i < m_count; ++i)
+    {
+        if((m_head - m_tail[i]) > max_size)
+        {
+            overrun = std::max(overrun, (m_head - m_tail[i]) - max_size);
+            m_tail[i] = m_head - max_size;
+        }
+    }
+    m_overrun_samples += overrun;
+}
+
+std::size_t CaptureReader::size(uint32_t channel) const noexcept
+{
+    // channels we aren't subscribed to are always empty
+    return (channel < m_count) ? m_head - m_tail[channel] : 0;
+}
+
+void CaptureReader::peek(uint32_t channel, float *dst, std::size_t count, std::size_t offset) const
+{
+    assert((offset + count) <= size(channel));
+    auto& stream = *m_stream;
+    std::lock_guard lock(stream.m_mtx);
+    stream.read(m_base + channel, m_tail[channel] + offset, count, dst, m_history_end);
+}
+
+void CaptureReader::pop(uint32_t channel, float *dst, std::size_t count)
+{
+    if(dst != nullptr)
+        peek(channel, dst, count);
+    assert(count <= size(channel));
+    m_tail[channel] += count;
+}
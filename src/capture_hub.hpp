@@ -0,0 +1,262 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <obs-module.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "aligned_buffer.hpp"
+#include "capture_log.hpp"
+
+// Process-wide audio capture shared by every source listening to the same audio.
+// A CaptureStream owns the one OBS callback for an audio source (or the output bus)
+// and broadcasts each block into a fixed size ring per channel.
+// Storage is reserved up front by the readers (outside the audio thread) and never grows while attached.
+// Overflow policy: the audio thread never blocks, drops or allocates, it overwrites the oldest samples.
+// Each subscriber tracks its own read position through a CaptureReader,
+// a reader that falls behind skips ahead to the oldest intact sample and counts the loss.
+// With set_compact_history() rings larger than HOT_CAPACITY keep only their newest samples as float,
+// older ones live in an int16 copy with one scale per HISTORY_BLOCK and are expanded on read.
+
+// Model of the system time at the end of the captured audio.
+// A second order delay locked loop fed one block at a time, it smooths out callback jitter
+// and follows the drift between the audio clock and the system clock.
+// Large errors (timestamp jumps, gaps in the audio) re-anchor the model on the measurement.
+class AudioClock
+{
+public:
+    void reset(uint32_t sample_rate) noexcept;
+
+    // feed the measured end timestamp of a block of frames, returns the filtered timestamp
+    uint64_t update(uint64_t measured_ts, std::size_t frames) noexcept;
+
+    double period() const noexcept { return m_period; } // estimated ns per sample
+
+private:
+    static constexpr double BANDWIDTH = 0.1;                    // loop bandwidth in Hz
+    static constexpr double MAX_DRIFT = 0.02;                   // limit of the rate estimate, relative to nominal
+    static constexpr double RESYNC_THRESHOLD = 100000000.0;     // 100 ms in ns
+
+    uint32_t m_sample_rate = 0;
+    double m_nominal = 0.0;
+    double m_period = 0.0;
+    int64_t m_anchor = 0;   // timestamp the model was last synced to
+    double m_ts = 0.0;      // relative to m_anchor, keeps full precision in a double
+    bool m_valid = false;
+};
+
+class CaptureStream
+{
+public:
+    struct Key
+    {
+        obs_weak_source_t *source;
+        bool ignore_mute;
+        std::size_t mix_idx;
+        bool operator<(const Key& other) const noexcept
+        {
+            if(source != other.source)
+                return source < other.source;
+            return (ignore_mute != other.ignore_mute) ? (ignore_mute < other.ignore_mute) : (mix_idx < other.mix_idx);
+        }
+    };
+
+    CaptureStream(const CaptureStream&) = delete;
+    CaptureStream& operator=(const CaptureStream&) = delete;
+    ~CaptureStream();
+
+    // shared stream for an audio source, muted audio is captured as silence unless ignore_mute is set
+    static std::shared_ptr<CaptureStream> get_source_stream(obs_source_t *source, bool ignore_mute);
+
+    // shared stream for an output mix track
+    // when OBS has to convert the mix to our format the one converter is shared by every reader
+    static std::shared_ptr<CaptureStream> get_output_stream(std::size_t mix_idx = 0);
+
+    uint32_t channels() const noexcept { return m_channels; }
+    uint32_t sample_rate() const noexcept { return m_sample_rate; }
+
+    // producer side accounting, for diagnostics
+    uint64_t blocks() const noexcept { return m_blocks.load(std::memory_order_relaxed); }
+    uint64_t truncated_samples() const noexcept { return m_truncated_samples.load(std::memory_order_relaxed); }
+
+    // make sure at least history samples per channel can be read back
+    // may briefly detach the OBS callback to grow the buffers
+    void reserve(std::size_t history);
+
+    // also hand every block to log, replacing the current one, null stops
+    // briefly detaches the OBS callback like reserve()
+    void set_log(std::shared_ptr<CaptureLog> log);
+    void drop_log(const CaptureLog *log);   // stop logging if log is the current one
+
+    // applies to streams created afterwards, [memory] compact_history=1 in the module config.ini
+    static void set_compact_history(bool enable) noexcept { s_compact_history.store(enable, std::memory_order_relaxed); }
+
+private:
+    friend class CaptureReader;
+
+    static constexpr std::size_t HOT_CAPACITY = 1u << 15;  // float samples kept per channel in compact mode
+    static constexpr std::size_t HISTORY_BLOCK = 256;      // samples per int16 scale
+    static inline std::atomic<bool> s_compact_history = false;
+
+    CaptureStream(obs_weak_source_t *source, bool ignore_mute, std::size_t mix_idx = 0);
+
+    bool attach();
+    void detach();
+    void resize(std::size_t capacity);
+    void replace_log(std::shared_ptr<CaptureLog> log);
+
+    bool compact() const noexcept { return m_hot_capacity < m_capacity; }
+    void quantize_block(std::size_t pos) noexcept;  // copy the float block at pos into the history
+
+    // copy count samples from stream position pos, positions before history_end come from the int16 history
+    void read(uint32_t channel, std::size_t pos, std::size_t count, float *dst, std::size_t history_end) const noexcept;
+    void read_history(uint32_t channel, std::size_t pos, std::size_t count, float *dst) const noexcept;
+
+    void capture(const audio_data *audio, bool muted);
+
+    static constexpr uint64_t MAX_TS_DELTA = 1000000000ull * 16u;   // 16 seconds in ns
+
+    static void source_callback(void *data, obs_source_t *source, const audio_data *audio, bool muted);
+    static void output_callback(void *data, size_t mix_idx, audio_data *audio);
+
+    // guards readers and buffer layout, never taken by the audio thread
+    std::mutex m_mtx;
+
+    obs_weak_source_t *m_source = nullptr; // null for the output bus
+    bool m_ignore_mute = false;
+    bool m_compact_history = false;
+    std::size_t m_mix_idx = 0;             // output mix track, output bus only
+    bool m_attached = false;
+    obs_audio_info m_audio_info{};
+    uint32_t m_channels = 0;
+    uint32_t m_sample_rate = 0;
+    AudioClock m_clock;                         // audio thread only
+    std::shared_ptr<CaptureLog> m_log;          // only changed while detached
+
+    // free running producer position and timestamps, published together under m_seq
+    alignas(64) std::atomic<uint32_t> m_seq = 0;
+    std::atomic<std::size_t> m_head = 0;
+    std::atomic<std::size_t> m_history_end = 0; // positions before this are read from the int16 history
+    std::atomic<uint64_t> m_capture_ts = 0;     // timestamp of last audio callback in nanoseconds
+    std::atomic<uint64_t> m_audio_ts = 0;       // timestamp of the end of available audio in nanoseconds
+    std::atomic<uint64_t> m_blocks = 0;         // audio callbacks received
+    std::atomic<uint64_t> m_truncated_samples = 0; // samples lost to blocks larger than the ring
+    std::atomic<std::size_t> m_signal_end[MAX_AUDIO_CHANNELS]{}; // position just past the newest nonzero sample
+
+    alignas(64) AlignedBuffer<float> m_buf;     // channel rings back to back
+    std::size_t m_capacity = 0;                 // per channel, power of 2
+    std::size_t m_mask = 0;
+    std::size_t m_hot_capacity = 0;             // float samples per channel, m_capacity unless compact
+    std::size_t m_hot_mask = 0;
+
+    // compact only, m_capacity samples and m_capacity / HISTORY_BLOCK scales per channel
+    AlignedBuffer<int16_t> m_history;
+    AlignedBuffer<float> m_history_scale;
+};
+
+// Per-subscriber view of a CaptureStream.
+// Covers a contiguous run of channels, each with its own read position.
+// Everything works on the producer state captured by the last latch().
+class CaptureReader
+{
+public:
+    static constexpr uint32_t MAX_CHANNELS = MAX_AUDIO_CHANNELS;
+
+    CaptureReader() = default;
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    // subscribe to channels [base, base + count) of stream
+    // the read position starts prime samples behind the producer, anything before the stream began reads as silence
+    bool attach(std::shared_ptr<CaptureStream> stream, uint32_t base, uint32_t count, std::size_t history, std::size_t prime);
+    void detach();
+    bool attached() const noexcept { return m_stream != nullptr; }
+    const std::shared_ptr<CaptureStream>& stream() const noexcept { return m_stream; }
+    uint32_t channels() const noexcept { return m_count; }
+
+    // consistent snapshot of the producer position and timestamps
+    void latch();
+    uint64_t capture_ts() const noexcept { return m_capture_ts; }
+    uint64_t audio_ts() const noexcept { return m_audio_ts; }
+    uint64_t overrun_samples() const noexcept { return m_overrun_samples; } // samples skipped because we fell behind
+
+    std::size_t size(uint32_t channel) const noexcept;
+
+    // true if there is no nonzero sample from the front up to the latched producer position
+    // found without touching the samples, a false result means nothing for windows shorter than size()
+    bool silent(uint32_t channel) const noexcept { return m_signal_end[channel] <= m_tail[channel]; }
+
+    // absolute stream position of the front sample
+    std::size_t position(uint32_t channel) const noexcept { return m_tail[channel]; }
+
+    // copy count samples starting at offset from the front without consuming them
+    void peek(uint32_t channel, float *dst, std::size_t count, std::size_t offset = 0) const;
+
+    // call fn(src, count, offset) for each contiguous run of the first count samples, without copying them
+    // src is only valid for the duration of the call and may not be aligned
+    template<typename F>
+    void visit(uint32_t channel, std::size_t count, F&& fn) const
+    {
+        assert(count <= size(channel));
+        auto& stream = *m_stream;
+        std::lock_guard lock(stream.m_mtx);
+        auto tail = m_tail[channel];
+        std::size_t done = 0;
+        if(stream.compact() && ((std::ptrdiff_t)(m_history_end - tail) > 0))
+        {
+            // the part in the int16 history is expanded first
+            auto& scratch = m_scratch[channel];
+            done = std::min(count, m_history_end - tail);
+            if(scratch.size() < done)
+                scratch.resize(done);
+            stream.read_history(m_base + channel, tail, done, scratch.data());
+            fn((const float*)scratch.data(), done, (std::size_t)0);
+            if(done == count)
+                return;
+            tail += done;
+        }
+        const auto ring = &stream.m_buf[(m_base + channel) * stream.m_hot_capacity];
+        const auto pos = tail & stream.m_hot_mask;
+        const auto rest = count - done;
+        const auto first = std::min(rest, stream.m_hot_capacity - pos);
+        fn((const float*)&ring[pos], first, done);
+        if(first < rest)
+            fn((const float*)ring, rest - first, done + first);
+    }
+
+    // consume count samples from the front, discarding them if dst is null
+    void pop(uint32_t channel, float *dst, std::size_t count);
+
+private:
+    std::shared_ptr<CaptureStream> m_stream;
+    uint32_t m_base = 0;
+    uint32_t m_count = 0;
+    std::size_t m_head = 0;
+    std::size_t m_tail[MAX_CHANNELS]{};
+    std::size_t m_signal_end[MAX_CHANNELS]{};
+    std::size_t m_history_end = 0;
+    mutable std::vector<float> m_scratch[MAX_CHANNELS]; // expanded history for visit()
+    uint64_t m_capture_ts = 0;
+    uint64_t m_audio_ts = 0;
+    uint64_t m_overrun_samples = 0;
+};
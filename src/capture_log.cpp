@@ -0,0 +1,243 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "capture_log.hpp"
+#include "log.hpp"
+#include <obs-module.h>
+#include <util/platform.h>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+    constexpr char FILE_MAGIC[8] = { 'W', 'A', 'V', 'E', 'C', 'A', 'P', '1' };
+    constexpr uint32_t FILE_VERSION = 1;
+    constexpr uint8_t FLAG_MUTED = 1;
+    constexpr uint8_t FLAG_LOST = 2;
+
+    // the format is little endian, so are all the targets
+    static_assert(std::endian::native == std::endian::little);
+
+#pragma pack(push, 1)
+    struct RecordHeader
+    {
+        uint8_t type;
+        uint8_t flags;
+        uint16_t channels;
+        uint32_t frames;    // float32 seconds for ticks
+        uint64_t timestamp;
+        uint64_t arrival_ts;
+    };
+
+    struct EntryHeader
+    {
+        uint64_t seq;
+        uint32_t bytes;     // record after this header
+        uint32_t reserved;
+    };
+#pragma pack(pop)
+
+    constexpr size_t entry_size(size_t bytes) noexcept
+    {
+        return (sizeof(EntryHeader) + bytes + 7) & ~(size_t)7;
+    }
+}
+
+void CaptureLog::Ring::reset(size_t bytes)
+{
+    buf = std::make_unique<uint8_t[]>(bytes);
+    mask = bytes - 1;
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    dropped = 0;
+    lost = false;
+}
+
+void CaptureLog::Ring::write(size_t pos, const void *src, size_t count) noexcept
+{
+    pos &= mask;
+    const auto first = std::min(count, mask + 1 - pos);
+    if(src == nullptr)
+    {
+        std::memset(&buf[pos], 0, first);
+        std::memset(&buf[0], 0, count - first);
+        return;
+    }
+    std::memcpy(&buf[pos], src, first);
+    std::memcpy(&buf[0], static_cast<const uint8_t*>(src) + first, count - first);
+}
+
+void CaptureLog::Ring::read(size_t pos, void *dst, size_t count) const noexcept
+{
+    pos &= mask;
+    const auto first = std::min(count, mask + 1 - pos);
+    std::memcpy(dst, &buf[pos], first);
+    std::memcpy(static_cast<uint8_t*>(dst) + first, &buf[0], count - first);
+}
+
+bool CaptureLog::open(const std::string& path, uint32_t sample_rate)
+{
+    close();
+    if(path.empty())
+        return false;
+    auto file = os_fopen(path.c_str(), "wb");
+    if(file == nullptr)
+    {
+        LogWarn << "Could not create capture log \"" << path << "\"";
+        return false;
+    }
+    const uint32_t header[] = { FILE_VERSION, sample_rate, 0 };
+    if((std::fwrite(FILE_MAGIC, sizeof(FILE_MAGIC), 1, file) != 1) || (std::fwrite(header, sizeof(header), 1, file) != 1))
+    {
+        LogWarn << "Could not write capture log \"" << path << "\"";
+        std::fclose(file);
+        return false;
+    }
+
+    m_blocks.reset(BLOCK_RING_BYTES);
+    m_ticks.reset(TICK_RING_BYTES);
+    m_seq.store(0, std::memory_order_relaxed);
+    m_next = 0;
+    m_failed = false;
+    m_stop.store(false, std::memory_order_relaxed);
+    m_file = file;
+    m_path = path;
+    m_thread = std::thread(&CaptureLog::writer, this);
+    return true;
+}
+
+void CaptureLog::close()
+{
+    if(m_file == nullptr)
+        return;
+    m_stop.store(true, std::memory_order_release);
+    m_thread.join();
+    std::fclose(m_file);
+    m_file = nullptr;
+    if((m_blocks.dropped > 0) || (m_ticks.dropped > 0))
+        LogWarn << "Capture log \"" << m_path << "\" dropped " << m_blocks.dropped << " blocks and " << m_ticks.dropped << " ticks, the disk couldn't keep up";
+    m_path.clear();
+    m_blocks.buf.reset();
+    m_ticks.buf.reset();
+}
+
+size_t CaptureLog::begin(Ring& ring, size_t bytes) noexcept
+{
+    const auto size = entry_size(bytes);
+    const auto head = ring.head.load(std::memory_order_relaxed);
+    const auto used = head - ring.tail.load(std::memory_order_acquire);
+    if((size + used) > (ring.mask + 1))
+    {
+        ++ring.dropped;
+        ring.lost = true;
+        return SIZE_MAX;
+    }
+    return head;
+}
+
+void CaptureLog::commit(Ring& ring, size_t pos, size_t bytes) noexcept
+{
+    // numbered only once the record is complete, the writer waits for every number in turn
+    const EntryHeader entry{ m_seq.fetch_add(1, std::memory_order_relaxed), (uint32_t)bytes, 0 };
+    ring.write(pos, &entry, sizeof(entry));
+    ring.head.store(pos + entry_size(bytes), std::memory_order_release);
+    ring.lost = false;
+}
+
+void CaptureLog::push_block(const audio_data *audio, uint32_t channels, bool muted, uint64_t arrival_ts) noexcept
+{
+    if((m_file == nullptr) || (audio == nullptr))
+        return;
+    channels = std::min(channels, (uint32_t)MAX_AV_PLANES);
+    const auto plane = (size_t)audio->frames * sizeof(float);
+    const auto bytes = sizeof(RecordHeader) + (plane * channels);
+    const auto pos = begin(m_blocks, bytes);
+    if(pos == SIZE_MAX)
+        return;
+    const RecordHeader header{ BLOCK, (uint8_t)((muted ? FLAG_MUTED : 0) | (m_blocks.lost ? FLAG_LOST : 0)), (uint16_t)channels, audio->frames, audio->timestamp, arrival_ts };
+    auto dst = pos + sizeof(EntryHeader);
+    m_blocks.write(dst, &header, sizeof(header));
+    dst += sizeof(header);
+    for(auto channel = 0u; channel < channels; ++channel, dst += plane)
+        m_blocks.write(dst, audio->data[channel], plane);
+    commit(m_blocks, pos, bytes);
+}
+
+void CaptureLog::push_tick(uint64_t tick_ts, float seconds) noexcept
+{
+    if(m_file == nullptr)
+        return;
+    const auto pos = begin(m_ticks, sizeof(RecordHeader));
+    if(pos == SIZE_MAX)
+        return;
+    const RecordHeader header{ TICK, (uint8_t)(m_ticks.lost ? FLAG_LOST : 0), 0, std::bit_cast<uint32_t>(seconds), tick_ts, tick_ts };
+    m_ticks.write(pos + sizeof(EntryHeader), &header, sizeof(header));
+    commit(m_ticks, pos, sizeof(header));
+}
+
+void CaptureLog::writer()
+{
+    while(!m_stop.load(std::memory_order_acquire))
+        if(!drain())
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_MS));
+    drain(); // every producer is gone, nothing is left half written
+    if(!m_failed)
+        std::fflush(m_file);
+}
+
+bool CaptureLog::drain()
+{
+    auto wrote = false;
+    while(true)
+    {
+        // the front of either ring is the next record once it carries the next number
+        Ring *ring = nullptr;
+        EntryHeader entry{};
+        for(auto candidate : { &m_blocks, &m_ticks })
+        {
+            const auto tail = candidate->tail.load(std::memory_order_relaxed);
+            if(tail == candidate->head.load(std::memory_order_acquire))
+                continue;
+            candidate->read(tail, &entry, sizeof(entry));
+            if(entry.seq == m_next)
+            {
+                ring = candidate;
+                break;
+            }
+        }
+        if(ring == nullptr)
+            return wrote;
+
+        const auto tail = ring->tail.load(std::memory_order_relaxed);
+        if(!m_failed)
+        {
+            m_scratch.resize(entry.bytes);
+            ring->read(tail + sizeof(EntryHeader), m_scratch.data(), entry.bytes);
+            if(std::fwrite(m_scratch.data(), m_scratch.size(), 1, m_file) != 1)
+            {
+                LogWarn << "Writing capture log \"" << m_path << "\" failed, it stops here";
+                m_failed = true;
+            }
+        }
+        ring->tail.store(tail + entry_size(entry.bytes), std::memory_order_release);
+        ++m_next;
+        wrote = true;
+    }
+}
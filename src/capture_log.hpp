@@ -0,0 +1,108 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct audio_data;
+
+// Debug log of the raw blocks a CaptureStream receives and the ticks of the source that asked for it,
+// for replaying a session's exact block and tick interleaving offline, see CaptureReplay.
+// The audio thread never blocks or allocates: blocks go into a ring sized up front and a full ring drops them,
+// counted and logged on close. A writer thread drains both rings in arrival order and does all the I/O.
+//
+// File layout, little endian and packed:
+//     "WAVECAP1", uint32 version (1), uint32 sample rate, uint32 reserved
+//     records of: uint8 type (1 block, 2 tick), uint8 flags (1 muted, 2 records were dropped before this one),
+//     uint16 channels, uint32 frames (blocks) or float32 seconds (ticks), uint64 timestamp, uint64 arrival ns
+//     blocks then hold channels * frames float32, one channel after the other, missing channels as zeros
+// Blocks carry audio_data::timestamp, ticks the tick time. Arrival is os_gettime_ns() when either came in.
+class CaptureLog
+{
+public:
+    CaptureLog() = default;
+    ~CaptureLog() { close(); }
+    CaptureLog(const CaptureLog&) = delete;
+    CaptureLog& operator=(const CaptureLog&) = delete;
+
+    // start writing to path, replacing the file, false and logged if it can't be created
+    bool open(const std::string& path, uint32_t sample_rate);
+    void close();                   // write out what's queued and stop the writer
+    bool is_open() const noexcept { return m_file != nullptr; }
+    const std::string& path() const noexcept { return m_path; }
+
+    // audio thread, one producer
+    void push_block(const audio_data *audio, uint32_t channels, bool muted, uint64_t arrival_ts) noexcept;
+
+    // the owning source's tick, one producer
+    void push_tick(uint64_t tick_ts, float seconds) noexcept;
+
+private:
+    enum : uint8_t
+    {
+        BLOCK = 1,
+        TICK = 2
+    };
+
+    // single producer single consumer byte ring, records are a uint64 sequence number and a uint32 size,
+    // then the file record, padded to 8 bytes
+    struct Ring
+    {
+        std::unique_ptr<uint8_t[]> buf;
+        size_t mask = 0;
+        alignas(64) std::atomic<size_t> head = 0;   // producer
+        alignas(64) std::atomic<size_t> tail = 0;   // writer
+        uint64_t dropped = 0;                       // producer only
+        bool lost = false;                          // producer only, flags the next record
+
+        void reset(size_t bytes);
+        void write(size_t pos, const void *src, size_t count) noexcept;   // src null writes zeros
+        void read(size_t pos, void *dst, size_t count) const noexcept;
+    };
+
+    static constexpr size_t BLOCK_RING_BYTES = 1 << 23;    // seconds of 8 channel blocks at 48 kHz
+    static constexpr size_t TICK_RING_BYTES = 1 << 16;
+    static constexpr int POLL_MS = 10;                      // the audio thread doesn't wake the writer
+
+    // room for an entry with a record of bytes, its ring position or SIZE_MAX when the ring is full
+    size_t begin(Ring& ring, size_t bytes) noexcept;
+    void commit(Ring& ring, size_t pos, size_t bytes) noexcept;
+
+    void writer();
+    bool drain();                   // writer thread, true if anything was written
+
+    std::FILE *m_file = nullptr;
+    std::string m_path;
+    std::thread m_thread;
+    std::atomic<bool> m_stop = false;
+    alignas(64) std::atomic<uint64_t> m_seq = 0;    // arrival order across both rings
+    Ring m_blocks;
+    Ring m_ticks;
+
+    // writer thread only
+    uint64_t m_next = 0;            // sequence number written next
+    std::vector<uint8_t> m_scratch;
+    bool m_failed = false;          // a write failed, further records are discarded
+};
@@ -0,0 +1,103 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "capture_replay.hpp"
+#include <bit>
+#include <cstring>
+
+namespace
+{
+    // see capture_log.hpp for the layout
+    constexpr char FILE_MAGIC[8] = { 'W', 'A', 'V', 'E', 'C', 'A', 'P', '1' };
+    constexpr uint32_t FILE_VERSION = 1;
+    constexpr uint8_t FLAG_MUTED = 1;
+    constexpr uint8_t FLAG_LOST = 2;
+    constexpr uint32_t MAX_CHANNELS = 8;    // MAX_AV_PLANES
+    constexpr uint32_t MAX_FRAMES = 1024;   // AUDIO_OUTPUT_FRAMES, a corrupt count shouldn't allocate the world
+
+    static_assert(std::endian::native == std::endian::little);
+
+    template<typename T>
+    T get(const uint8_t *src)
+    {
+        T value;
+        std::memcpy(&value, src, sizeof(T));
+        return value;
+    }
+}
+
+bool CaptureReplay::open(const std::string& path)
+{
+    close();
+    auto file = std::fopen(path.c_str(), "rb");
+    if(file == nullptr)
+        return false;
+    char magic[sizeof(FILE_MAGIC)];
+    uint32_t header[3];
+    if((std::fread(magic, sizeof(magic), 1, file) != 1) || (std::memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0)
+        || (std::fread(header, sizeof(header), 1, file) != 1) || (header[0] != FILE_VERSION))
+    {
+        std::fclose(file);
+        return false;
+    }
+    m_file = file;
+    m_sample_rate = header[1];
+    return true;
+}
+
+void CaptureReplay::close()
+{
+    if(m_file == nullptr)
+        return;
+    std::fclose(m_file);
+    m_file = nullptr;
+    m_sample_rate = 0;
+}
+
+bool CaptureReplay::next(Event& event)
+{
+    uint8_t header[24];
+    if((m_file == nullptr) || (std::fread(header, sizeof(header), 1, m_file) != 1))
+        return false;
+    const auto type = header[0];
+    const auto flags = header[1];
+    const auto channels = (uint32_t)get<uint16_t>(&header[2]);
+    const auto frames = get<uint32_t>(&header[4]);
+    if(((type != (uint8_t)Type::BLOCK) && (type != (uint8_t)Type::TICK)) || (channels > MAX_CHANNELS)
+        || ((type == (uint8_t)Type::BLOCK) && (frames > MAX_FRAMES)))
+        return false;
+
+    event.type = (Type)type;
+    event.muted = (flags & FLAG_MUTED) != 0;
+    event.lost = (flags & FLAG_LOST) != 0;
+    event.timestamp = get<uint64_t>(&header[8]);
+    event.arrival_ts = get<uint64_t>(&header[16]);
+    if(event.type == Type::TICK)
+    {
+        event.channels = 0;
+        event.frames = 0;
+        event.seconds = std::bit_cast<float>(frames);
+        event.samples.clear();
+        return true;
+    }
+    event.channels = channels;
+    event.frames = frames;
+    event.seconds = 0.0f;
+    event.samples.resize((size_t)channels * frames);
+    return event.samples.empty() || (std::fread(event.samples.data(), event.samples.size() * sizeof(float), 1, m_file) == 1);
+}
@@ -0,0 +1,71 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Reader for the files CaptureLog writes, steps through the recorded blocks and ticks in arrival order.
+// A profiling harness feeds the blocks to its capture and runs a tick for each tick record,
+// which reproduces the block and tick interleaving of the recorded session without OBS.
+class CaptureReplay
+{
+public:
+    enum class Type : uint8_t
+    {
+        BLOCK = 1,
+        TICK = 2
+    };
+
+    struct Event
+    {
+        Type type = Type::TICK;
+        bool muted = false;             // blocks only, as OBS reported it, the samples are as they arrived
+        bool lost = false;              // records were dropped right before this one
+        uint32_t channels = 0;
+        uint32_t frames = 0;
+        float seconds = 0.0f;           // ticks only, the frame time OBS passed
+        uint64_t timestamp = 0;         // audio_data::timestamp for blocks, the tick time for ticks
+        uint64_t arrival_ts = 0;        // when it came in, same clock for both
+        std::vector<float> samples;     // channels * frames, one channel after the other
+
+        const float *channel(uint32_t index) const noexcept { return &samples[(size_t)index * frames]; }
+    };
+
+    CaptureReplay() = default;
+    ~CaptureReplay() { close(); }
+    CaptureReplay(const CaptureReplay&) = delete;
+    CaptureReplay& operator=(const CaptureReplay&) = delete;
+
+    // false if path can't be read or isn't a capture log
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const noexcept { return m_file != nullptr; }
+    uint32_t sample_rate() const noexcept { return m_sample_rate; }
+
+    // next record, false at the end of the file or on a truncated or malformed record
+    // event keeps its sample storage from one call to the next
+    bool next(Event& event);
+
+private:
+    std::FILE *m_file = nullptr;
+    uint32_t m_sample_rate = 0;
+};
@@ -0,0 +1,114 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// Log-linear histogram of durations in the style of HdrHistogram.
+// Microsecond resolution below 16 us, above that 16 buckets per power of two, so any value is
+// within about 6% of its bucket. Covers up to 16 seconds, longer durations land in the last bucket.
+// Fixed size and no allocations, adding is a couple of instructions.
+class CostHistogram
+{
+public:
+    static constexpr unsigned int SUB_BITS = 4;
+    static constexpr unsigned int SUB_COUNT = 1u << SUB_BITS;
+    static constexpr unsigned int MAX_BITS = 24; // 2^24 us
+    static constexpr std::size_t BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+    void add(uint64_t ns) noexcept
+    {
+        ++m_counts[index(ns / 1000)];
+        ++m_total;
+    }
+
+    void clear() noexcept
+    {
+        m_counts.fill(0);
+        m_total = 0;
+    }
+
+    uint64_t count() const noexcept { return m_total; }
+
+    // upper edge of the bucket holding the p quantile in ms, 0 when empty
+    double percentile(double p) const noexcept
+    {
+        if(m_total == 0)
+            return 0.0;
+        const auto rank = std::max((uint64_t)((p * (double)m_total) + 0.5), (uint64_t)1);
+        uint64_t seen = 0;
+        for(std::size_t i = 0; i < BUCKETS; ++i)
+        {
+            seen += m_counts[i];
+            if(seen >= rank)
+                return (double)upper(i) / 1000.0;
+        }
+        return (double)upper(BUCKETS - 1) / 1000.0;
+    }
+
+    // {"count":N,"p50":ms,"p90":ms,"p99":ms,"p999":ms,"buckets":[[lower_us,upper_us,count],...]}, empty buckets left out
+    std::string json() const
+    {
+        std::ostringstream out;
+        out << "{\"count\":" << m_total << ",\"p50\":" << percentile(0.5) << ",\"p90\":" << percentile(0.9)
+            << ",\"p99\":" << percentile(0.99) << ",\"p999\":" << percentile(0.999) << ",\"buckets\":[";
+        auto first = true;
+        for(std::size_t i = 0; i < BUCKETS; ++i)
+        {
+            if(m_counts[i] == 0)
+                continue;
+            out << (first ? "" : ",") << "[" << lower(i) << "," << upper(i) << "," << m_counts[i] << "]";
+            first = false;
+        }
+        out << "]}";
+        return out.str();
+    }
+
+private:
+    static std::size_t index(uint64_t us) noexcept
+    {
+        if(us < SUB_COUNT)
+            return (std::size_t)us;
+        const auto shift = std::min((unsigned int)std::bit_width(us) - 1 - SUB_BITS, MAX_BITS - SUB_BITS);
+        const auto sub = std::min<uint64_t>((us >> shift) - SUB_COUNT, SUB_COUNT - 1); // clamped in the last octave
+        return ((std::size_t)(shift + 1) * SUB_COUNT) + (std::size_t)sub;
+    }
+
+    // bucket edges in us
+    static uint64_t lower(std::size_t i) noexcept
+    {
+        if(i < SUB_COUNT)
+            return i;
+        const auto shift = (i / SUB_COUNT) - 1;
+        return (uint64_t)(SUB_COUNT + (i % SUB_COUNT)) << shift;
+    }
+
+    static uint64_t upper(std::size_t i) noexcept
+    {
+        return (i < SUB_COUNT) ? i + 1 : lower(i) + (uint64_t(1) << ((i / SUB_COUNT) - 1));
+    }
+
+    std::array<uint32_t, BUCKETS> m_counts{};
+    uint64_t m_total = 0;
+};
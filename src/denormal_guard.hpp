@@ -0,0 +1,91 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <cstdint>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+#include <xmmintrin.h>
+#define WAV_DENORMAL_GUARD_X86
+#elif defined(_M_ARM64)
+#include <intrin.h>
+#define WAV_DENORMAL_GUARD_ARM64
+#elif defined(__aarch64__)
+#define WAV_DENORMAL_GUARD_ARM64
+#endif
+
+// Flushes denormal results (FTZ) and reads denormal inputs as zero (DAZ, x86 only) while in scope.
+// Smoothing history decays geometrically through the denormal range on the way to zero,
+// which is many times slower on a lot of CPUs. The previous mode is restored on exit.
+// Per thread, nothing the plugin computes needs gradual underflow.
+class DenormalGuard
+{
+public:
+    DenormalGuard() noexcept
+    {
+#if defined(WAV_DENORMAL_GUARD_X86)
+        m_saved = _mm_getcsr();
+        _mm_setcsr(m_saved | FTZ | DAZ);
+#elif defined(WAV_DENORMAL_GUARD_ARM64)
+        m_saved = read_fpcr();
+        write_fpcr(m_saved | FZ);
+#endif
+    }
+
+    ~DenormalGuard()
+    {
+#if defined(WAV_DENORMAL_GUARD_X86)
+        _mm_setcsr(m_saved);
+#elif defined(WAV_DENORMAL_GUARD_ARM64)
+        write_fpcr(m_saved);
+#endif
+    }
+
+    DenormalGuard(const DenormalGuard&) = delete;
+    DenormalGuard& operator=(const DenormalGuard&) = delete;
+
+private:
+#if defined(WAV_DENORMAL_GUARD_X86)
+    static constexpr unsigned int FTZ = 0x8000;
+    static constexpr unsigned int DAZ = 0x0040; // every x86-64 CPU has it, and the SSE2 baseline
+    unsigned int m_saved = 0;
+#elif defined(WAV_DENORMAL_GUARD_ARM64)
+    static constexpr uint64_t FZ = 1ull << 24;  // flushes inputs too on AArch64
+    uint64_t m_saved = 0;
+
+    static uint64_t read_fpcr() noexcept
+    {
+#ifdef _MSC_VER
+        return (uint64_t)_ReadStatusReg(ARM64_FPCR);
+#else
+        uint64_t fpcr;
+        __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+        return fpcr;
+#endif
+    }
+
+    static void write_fpcr(uint64_t fpcr) noexcept
+    {
+#ifdef _MSC_VER
+        _WriteStatusReg(ARM64_FPCR, (__int64)fpcr);
+#else
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr));
+#endif
+    }
+#endif
+};
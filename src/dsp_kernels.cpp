@@ -0,0 +1,140 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "dsp_kernels.hpp"
+
+namespace
+{
+    // written once by select() before the first source exists
+    DSPKernels s_kernels;
+}
+
+DSPKernels DSPKernels::resolve(const Levels& levels)
+{
+    DSPKernels kernels;
+    kernels.prefix_width = levels.prefix_width;
+#ifdef ENABLE_X86_SIMD
+    // sse4.1 only covers the 128-bit kernels, the others stay generic below avx
+    if(levels.interp >= 4)
+    {
+        kernels.interp = &apply_interp_filter_avx512;
+        kernels.bands = &apply_interp_filter_avx512;
+    }
+    else if((levels.interp >= 2) && levels.fma)
+    {
+        kernels.interp = &apply_interp_filter_fma3;
+        kernels.bands = &apply_interp_filter_fma3;
+    }
+    else if(levels.interp >= 2)
+    {
+        kernels.interp = &apply_interp_filter_avx;
+        kernels.bands = &apply_interp_filter_avx;
+    }
+    if(levels.filter >= 2)
+    {
+        kernels.filter = levels.fma ? &apply_filter_fma3 : &apply_filter_avx;
+        kernels.heights = levels.fma ? &map_db_heights_fma3 : &map_db_heights_avx;
+    }
+    else if(levels.filter >= 1)
+        kernels.filter = &apply_filter_sse41;
+    if(levels.filterbank >= 2)
+        kernels.filterbank = levels.fma ? &apply_filterbank_fma3 : &apply_filterbank_avx;
+    else if(levels.filterbank >= 1)
+        kernels.filterbank = &apply_filterbank_sse41;
+    if(levels.iir >= 2)
+        kernels.iir = levels.fma ? &iir_bank_fma3 : &iir_bank_avx;
+
+    // the avx analysis tier needs FMA3, AVX cpus without it stay generic
+    if((levels.analysis >= 2) && levels.fma)
+    {
+        kernels.bins = &select_spectrum_bins_avx;
+        kernels.post = &select_spectrum_post_avx;
+        kernels.window = &window_input_avx;
+        kernels.mix = &mix_input_avx;
+        kernels.below = &all_below_avx;
+        kernels.meter_reduce = &meter_reduce_avx;
+        kernels.waveform_peak = &waveform_peak_avx;
+        kernels.waveform_post = &waveform_post_avx;
+        kernels.scope_trigger = &scope_trigger_avx;
+        kernels.peak_hold = &peak_hold_avx;
+        kernels.analysis_name = "AVX";
+    }
+    if((levels.analysis >= 3) && levels.fma)
+    {
+        kernels.bins = &select_spectrum_bins_avx2;
+        kernels.half_history = levels.f16c;
+        kernels.analysis_name = "AVX2";
+    }
+    if((levels.analysis >= 4) && levels.fma)
+    {
+        kernels.bins = &select_spectrum_bins_avx512;
+        kernels.post = &select_spectrum_post_avx512;
+        kernels.window = &window_input_avx512;
+        kernels.mix = &mix_input_avx512;
+        kernels.below = &all_below_avx512;
+        kernels.analysis_name = "AVX512";
+    }
+#elif defined(ENABLE_ARM_SIMD)
+    if(levels.interp >= 1)
+    {
+        kernels.interp = &apply_interp_filter_neon;
+        kernels.bands = &apply_interp_filter_neon;
+    }
+#ifdef ENABLE_ACCELERATE_FFT
+    // vDSP gathers the strided dot products better than our loops, interp and iir have no vDSP match
+    if(levels.filter >= 2)
+        kernels.filter = &apply_filter_accelerate;
+    else
+#endif
+    if(levels.filter >= 1)
+        kernels.filter = &apply_filter_neon;
+    if(levels.filter >= 1)
+        kernels.heights = &map_db_heights_neon;
+#ifdef ENABLE_ACCELERATE_FFT
+    if(levels.filterbank >= 2)
+        kernels.filterbank = &apply_filterbank_accelerate;
+    else
+#endif
+    if(levels.filterbank >= 1)
+        kernels.filterbank = &apply_filterbank_neon;
+    if(levels.iir >= 1)
+        kernels.iir = &iir_bank_neon;
+    if(levels.analysis >= 1)
+    {
+        kernels.bins = &select_spectrum_bins_neon;
+        kernels.post = &select_spectrum_post_neon;
+        kernels.window = &window_input_neon;
+        kernels.mix = &mix_input_neon;
+        kernels.below = &all_below_neon;
+        kernels.meter_reduce = &meter_reduce_neon;
+        kernels.scope_trigger = &scope_trigger_neon;
+        kernels.peak_hold = &peak_hold_neon;
+        kernels.analysis_name = "NEON";
+    }
+#endif // ENABLE_X86_SIMD
+    return kernels;
+}
+
+void DSPKernels::select(const Levels& levels)
+{
+    s_kernels = resolve(levels);
+}
+
+const DSPKernels& DSPKernels::get() noexcept
+{
+    return s_kernels;
+}
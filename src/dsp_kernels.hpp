@@ -0,0 +1,88 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include "filter.hpp"
+#include "analysis_kernels.hpp"
+#include "iir_filterbank.hpp"
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Analysis and display kernels, resolved once when the module registers instead of branching on the CPU per call.
+// Every display kernel picks its own tier, so they can be mixed, e.g. an AVX512 interpolation with an FMA3 filter.
+// the analysis kernels share one tier, see analysis_kernels.hpp
+// levels follow the [cpu] tier names: x86 0 generic, 1 sse4.1, 2 avx, 3 avx2, 4 avx512, ARM 0 generic, 1 neon, 2 accelerate
+// AVX cpus without FMA3 (Sandy Bridge, Ivy Bridge) get the same kernels with separate multiply and add
+struct DSPKernels
+{
+    using InterpFn = void (*)(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output);
+    using BandsFn = void (*)(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output);
+    using FilterFn = void (*)(const float *samples, size_t sz, const Kernel<float>& kernel, std::span<float> output);
+    using FilterbankFn = void (*)(const float *samples, const Filterbank<float>& bank, std::span<float> output);
+    using IIRBankFn = void (*)(const IIRFilterbank::Pass& pass);
+    using HeightsFn = size_t (*)(float *values, size_t count, float ceiling, float range, float top, float bottom, float& miny);
+    using BinsSelectFn = SpectrumBinsFn (*)(const SpectrumVariant& variant);
+    using PostSelectFn = SpectrumPostFn (*)(const SpectrumPostVariant& variant);
+    using WindowFn = bool (*)(float *dst, const float *src, const float *window, size_t count);
+    using MixFn = void (*)(float *dst, const float *src, float weight, size_t count, bool accumulate);
+    using BelowFn = bool (*)(const float *values, size_t first, size_t last, float limit);
+    using MeterReduceFn = void (*)(const float *src, size_t frames, uint32_t lanes, float *peaks, float *squares);
+    using WaveformPeakFn = float (*)(const float *src, size_t count);
+    using WaveformPostFn = void (*)(const WaveformPost& args);
+    using TriggerFn = size_t (*)(const float *src, size_t count, float level);
+    using PeakHoldFn = void (*)(const PeakHold& args);
+
+    // highest tier each kernel may use, already capped to what the CPU has
+    struct Levels
+    {
+        int interp = 0;
+        int filter = 0;
+        int filterbank = 0;
+        int iir = 0;
+        int analysis = 0;
+        bool fma = false;   // x86 tiers from avx up use FMA3
+        bool f16c = false;  // fp16 smoothing history from avx2 up
+        float prefix_width = 1.0f;  // passed through to DSPKernels::prefix_width
+    };
+
+    InterpFn interp = &apply_interp_filter<float>;          // curve display points
+    BandsFn bands = nullptr;                                // narrow bar bands, null for apply_interp_filter_prefix() only
+    FilterFn filter = &apply_filter<float>;                 // gaussian smoothing of the display points
+    FilterbankFn filterbank = &apply_filterbank<float>;     // perceptual bar bands
+    IIRBankFn iir = &iir_bank;
+    HeightsFn heights = &map_db_heights<float>;            // dB to pixels, shares the filter tier
+    float prefix_width = 1.0f;  // bars take the running sum once bands average this many kernel sizes, see KernelTuning
+
+    BinsSelectFn bins = &select_spectrum_bins_generic;      // magnitude, smoothing and frame combining of the transform
+    PostSelectFn post = &select_spectrum_post_generic;      // frame average, channel mix and dBFS of a tick
+    PostSelectFn power_post = &select_spectrum_power_post;  // the same in linear power for power averaged bars, every tier
+    WindowFn window = &window_input_generic;                // capture ring to transform input
+    MixFn mix = &mix_input_generic;                         // weighted downmix of the capture channels
+    BelowFn below = &all_below_generic;                     // silence check of the last spectrum
+    MeterReduceFn meter_reduce = &meter_reduce_generic;     // meter ring blocks
+    WaveformPeakFn waveform_peak = &waveform_peak_generic;
+    WaveformPostFn waveform_post = &waveform_post_generic;
+    TriggerFn scope_trigger = &scope_trigger_generic;
+    PeakHoldFn peak_hold = &peak_hold_generic;
+    bool half_history = false;                              // bins takes SpectrumVariant::half_history
+    const char *analysis_name = "generic";                  // tier of the analysis kernels, for the stats
+
+    static DSPKernels resolve(const Levels& levels);    // the kernels for levels, without selecting them
+    static void select(const Levels& levels);
+    static const DSPKernels& get() noexcept;
+};
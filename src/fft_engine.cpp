@@ -0,0 +1,125 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "fft_engine.hpp"
+#include "fft_planner.hpp"
+
+#ifdef ENABLE_ACCELERATE_FFT
+#include <bit>
+#endif
+
+bool FFTEngine::update(int n, int howmany, float *in, fftwf_complex *out)
+{
+    if((n != m_n) || (howmany != m_howmany) || (in != m_in) || (out != m_out))
+    {
+        reset();
+        m_n = n;
+        m_howmany = howmany;
+        m_in = in;
+        m_out = out;
+    }
+
+#ifdef ENABLE_ACCELERATE_FFT
+    if(std::has_single_bit((unsigned int)n))
+    {
+        if(m_setup == nullptr)
+        {
+            m_log2n = (vDSP_Length)std::countr_zero((unsigned int)n);
+            m_setup = vDSP_create_fftsetup(m_log2n, kFFTRadix2);
+            m_split.reset((size_t)n);
+        }
+        if(m_setup != nullptr)
+            return true;
+    }
+#endif
+
+    const auto gen = FFTPlanner::generation();
+    if(m_plan_measured || ((m_plan != nullptr) && (gen == m_plan_gen)))
+        return true;
+    const auto result = FFTPlanner::acquire_r2c(n, howmany, in, out, m_plan);
+    if(result == FFTPlanner::Result::BUSY)
+        return false; // try again next tick
+    m_plan_gen = gen;
+    m_plan_measured = (result == FFTPlanner::Result::MEASURED);
+    return true;
+}
+
+void FFTEngine::reset()
+{
+    FFTPlanner::release(m_plan);
+    m_plan = nullptr;
+    m_plan_measured = false;
+#ifdef ENABLE_ACCELERATE_FFT
+    if(m_setup != nullptr)
+        vDSP_destroy_fftsetup(m_setup);
+    m_setup = nullptr;
+    m_split.reset();
+#endif
+    m_in = nullptr;
+    m_out = nullptr;
+    m_n = 0;
+    m_howmany = 0;
+}
+
+bool FFTEngine::ready() const noexcept
+{
+#ifdef ENABLE_ACCELERATE_FFT
+    if(m_setup != nullptr)
+        return true;
+#endif
+    return m_plan != nullptr;
+}
+
+void FFTEngine::execute()
+{
+#ifdef ENABLE_ACCELERATE_FFT
+    if(m_setup != nullptr)
+    {
+        // zrip packs nyquist into the imaginary part of DC and scales everything by 2
+        const auto half = (vDSP_Length)m_n / 2;
+        DSPSplitComplex split{ m_split.get(), m_split.get() + half };
+        for(auto i = 0; i < m_howmany; ++i)
+        {
+            const auto in = m_in + ((size_t)i * m_n);
+            const auto out = m_out + ((size_t)i * m_n);
+            vDSP_ctoz(reinterpret_cast<const DSPComplex*>(in), 2, &split, 1, half);
+            vDSP_fft_zrip(m_setup, &split, 1, m_log2n, kFFTDirection_Forward);
+            out[0][0] = split.realp[0] * 0.5f;
+            out[0][1] = 0.0f;
+            out[half][0] = split.imagp[0] * 0.5f;
+            out[half][1] = 0.0f;
+            for(vDSP_Length k = 1; k < half; ++k)
+            {
+                out[k][0] = split.realp[k] * 0.5f;
+                out[k][1] = split.imagp[k] * 0.5f;
+            }
+        }
+        return;
+    }
+#endif
+    if(m_plan != nullptr)
+        fftwf_execute_dft_r2c(m_plan, m_in, m_out); // shared plan, run on our own buffers
+}
+
+const char *FFTEngine::backend_name() noexcept
+{
+#ifdef ENABLE_ACCELERATE_FFT
+    return "Accelerate (FFTW fallback)";
+#else
+    return "FFTW";
+#endif
+}
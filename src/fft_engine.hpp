@@ -0,0 +1,70 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include "waveform_config.hpp"
+#include "aligned_buffer.hpp"
+#include <cstdint>
+#include <fftw3.h>
+
+#ifdef ENABLE_ACCELERATE_FFT
+#include <Accelerate/Accelerate.h>
+#endif
+
+// Batched real to complex transforms behind the backend the build selected.
+// FFTW is always available and goes through FFTPlanner. On Apple builds with ENABLE_ACCELERATE_FFT
+// power of two sizes use vDSP_fft_zrip instead, other sizes fall back to FFTW.
+// Output is always in FFTW's layout, n / 2 + 1 bins per transform, each transform n elements apart.
+// Batching is per source only: the channels of one source share a plan, different sources never do.
+// One plan across sources times the same as running each source's plan on its own buffers, even with the
+// sources windowing straight into the batch (the batching case of waveform_bench), so it would only tie every
+// source to the slowest, hidden or sleeping one each frame. Identical inputs already share through TransformCache.
+class FFTEngine
+{
+public:
+    FFTEngine() = default;
+    FFTEngine(const FFTEngine&) = delete;
+    FFTEngine& operator=(const FFTEngine&) = delete;
+    ~FFTEngine() { reset(); }
+
+    // prepare howmany transforms of n points from in to out
+    // call again with the same arguments to swap in a better plan once one is available
+    // returns false if the backend is busy, ready() stays as it was
+    bool update(int n, int howmany, float *in, fftwf_complex *out);
+    void reset();
+
+    bool ready() const noexcept;
+    void execute();
+
+    static const char *backend_name() noexcept;
+
+private:
+    float *m_in = nullptr;
+    fftwf_complex *m_out = nullptr;
+    int m_n = 0;
+    int m_howmany = 0;
+
+    fftwf_plan m_plan{};
+    uint64_t m_plan_gen = 0;        // FFTPlanner::generation() when the plan was made
+    bool m_plan_measured = false;
+
+#ifdef ENABLE_ACCELERATE_FFT
+    FFTSetup m_setup{};
+    vDSP_Length m_log2n = 0;
+    AlignedBuffer<float> m_split;   // split complex scratch, n / 2 real then n / 2 imaginary
+#endif
+};
@@ -0,0 +1,338 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "fft_planner.hpp"
+#include "aligned_buffer.hpp"
+#include "module.hpp"
+#include "log.hpp"
+#include <obs-module.h>
+#include <util/platform.h>
+#include <atomic>
+#include <condition_variable>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <set>
+#include <tuple>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // held for every FFTW planner call, the worker holds it while measuring
+    std::mutex s_planner_mtx;
+
+    // plans waiting for the planner to become free
+    std::mutex s_deferred_mtx;
+    std::vector<fftwf_plan> s_deferred;
+
+    // measure queue
+    std::mutex s_queue_mtx;
+    std::condition_variable s_queue_cv;
+    using Problem = std::pair<int, int>; // size, batch count
+    std::vector<Problem> s_pending;
+    std::set<Problem> s_queued; // every problem ever queued, measured wisdom doesn't go stale
+    bool s_stop = false;
+    std::thread s_worker;
+
+    std::atomic<uint64_t> s_generation = 0;
+
+    // shared plans, taken before the planner lock and never held while waiting on it
+    struct PlanKey
+    {
+        int n;
+        int howmany;
+        int in_align;   // fftwf_alignment_of, plans only run on buffers with the same alignment
+        int out_align;
+
+        friend bool operator<(const PlanKey& a, const PlanKey& b)
+        {
+            return std::tie(a.n, a.howmany, a.in_align, a.out_align) < std::tie(b.n, b.howmany, b.in_align, b.out_align);
+        }
+    };
+
+    struct PlanEntry
+    {
+        fftwf_plan plan = nullptr;  // newest plan for the key
+        uint64_t generation = 0;    // s_generation when it was made
+        bool measured = false;
+    };
+
+    std::mutex s_registry_mtx;
+    std::map<PlanKey, PlanEntry> s_plans;
+    std::map<fftwf_plan, std::size_t> s_refs; // includes superseded plans still in use
+
+    constexpr auto WISDOM_FILE = "fftw_wisdom.txt";
+
+    // transforms this large are planned to run on several threads, smaller ones don't win back the overhead
+    // [fft] threads=N in the module config.ini, 0 or missing for automatic, 1 never splits
+    constexpr int THREADED_MIN_SIZE = 32768;
+    constexpr unsigned int MAX_AUTO_THREADS = 4;
+    int s_plan_threads = 1; // set by start()
+
+    // planner lock must be held
+    void destroy_deferred()
+    {
+        std::vector<fftwf_plan> plans;
+        {
+            std::lock_guard lock(s_deferred_mtx);
+            plans.swap(s_deferred);
+        }
+        for(auto plan : plans)
+            fftwf_destroy_plan(plan);
+    }
+
+    // planner lock must be held
+    void save_wisdom()
+    {
+        auto dir = obs_module_config_path("");
+        if(dir != nullptr)
+        {
+            os_mkdirs(dir);
+            bfree(dir);
+        }
+        auto path = obs_module_config_path(WISDOM_FILE);
+        if(path == nullptr)
+            return;
+        if(!fftwf_export_wisdom_to_filename(path))
+            LogWarn << "Failed to save FFTW wisdom to \"" << path << "\"";
+        bfree(path);
+    }
+
+    // planner lock must be held, fftwf_plan_with_nthreads is planner state too
+    fftwf_plan make_plan(int n, int howmany, float *in, fftwf_complex *out, unsigned int flags)
+    {
+#ifdef ENABLE_FFTW_THREADS
+        fftwf_plan_with_nthreads((n >= THREADED_MIN_SIZE) ? s_plan_threads : 1);
+#endif
+        return fftwf_plan_many_dft_r2c(1, &n, howmany, in, nullptr, 1, n, out, nullptr, 1, n, flags);
+    }
+
+    // destroy a plan, deferred to the next planner call if the planner is busy
+    void destroy(fftwf_plan plan)
+    {
+        std::unique_lock planner(s_planner_mtx, std::try_to_lock);
+        if(planner.owns_lock())
+        {
+            destroy_deferred();
+            fftwf_destroy_plan(plan);
+        }
+        else
+        {
+            std::lock_guard lock(s_deferred_mtx);
+            s_deferred.push_back(plan);
+        }
+    }
+
+    // registry lock must be held, returns true if the plan is no longer referenced
+    bool unref(fftwf_plan plan)
+    {
+        auto it = s_refs.find(plan);
+        if((it == s_refs.end()) || (--it->second > 0))
+            return false;
+        s_refs.erase(it);
+        for(auto entry = s_plans.begin(); entry != s_plans.end(); ++entry)
+        {
+            if(entry->second.plan == plan)
+            {
+                s_plans.erase(entry);
+                break;
+            }
+        }
+        return true;
+    }
+
+    void queue_measure(const Problem& problem)
+    {
+        std::lock_guard lock(s_queue_mtx);
+        if(!s_worker.joinable() || !s_queued.insert(problem).second)
+            return;
+        s_pending.push_back(problem);
+        s_queue_cv.notify_one();
+    }
+
+    // planner lock must be held
+    void load_wisdom()
+    {
+        auto path = obs_module_config_path(WISDOM_FILE);
+        if(path == nullptr)
+            return;
+        if(os_file_exists(path) && !fftwf_import_wisdom_from_filename(path))
+            LogWarn << "Failed to load FFTW wisdom from \"" << path << "\"";
+        bfree(path);
+    }
+
+    void worker()
+    {
+        // wisdom is read here instead of in start() to keep it off the OBS startup path
+        // sources get BUSY until it's in, then replan their estimated plans with it
+        {
+            std::lock_guard planner(s_planner_mtx);
+            load_wisdom();
+        }
+        s_generation.fetch_add(1, std::memory_order_release);
+
+        std::unique_lock lock(s_queue_mtx);
+        while(true)
+        {
+            s_queue_cv.wait(lock, [] { return s_stop || !s_pending.empty(); });
+            if(s_stop)
+                break;
+            const auto [n, howmany] = s_pending.back();
+            s_pending.pop_back();
+            lock.unlock();
+
+            {
+                // same allocator as the sources so the wisdom matches their alignment
+                AlignedBuffer<float> in;
+                AlignedBuffer<fftwf_complex> out;
+                in.reset((std::size_t)n * howmany);
+                out.reset((std::size_t)n * howmany);
+                std::lock_guard planner(s_planner_mtx);
+                destroy_deferred();
+                auto plan = make_plan(n, howmany, in.get(), out.get(), FFTW_MEASURE);
+                if(plan != nullptr)
+                {
+                    fftwf_destroy_plan(plan);
+                    save_wisdom();
+                }
+            }
+            s_generation.fetch_add(1, std::memory_order_release);
+
+            lock.lock();
+        }
+    }
+}
+
+void FFTPlanner::start()
+{
+    {
+        std::lock_guard planner(s_planner_mtx);
+#ifdef ENABLE_FFTW_THREADS
+        static const auto threads_ok = (fftwf_init_threads() != 0); // once per process, there is no undoing it
+        if(threads_ok)
+        {
+            const auto cores = std::max(std::thread::hardware_concurrency(), 1u);
+            const auto configured = module_config_uint("fft", "threads");
+            s_plan_threads = (int)((configured > 0) ? std::min<uint64_t>(configured, cores) : std::clamp(cores / 2, 1u, MAX_AUTO_THREADS));
+        }
+        else
+            LogWarn << "FFTW threads unavailable, large transforms run single threaded";
+#endif
+    }
+
+    std::lock_guard lock(s_queue_mtx);
+    s_stop = false;
+    if(!s_worker.joinable())
+        s_worker = std::thread(worker);
+}
+
+void FFTPlanner::stop()
+{
+    {
+        std::lock_guard lock(s_queue_mtx);
+        s_stop = true;
+        s_pending.clear();
+    }
+    s_queue_cv.notify_all();
+    if(s_worker.joinable())
+        s_worker.join();
+
+    std::lock_guard planner(s_planner_mtx);
+    destroy_deferred();
+    save_wisdom();
+}
+
+FFTPlanner::Result FFTPlanner::acquire_r2c(int n, int howmany, float *in, fftwf_complex *out, fftwf_plan& plan)
+{
+    const PlanKey key{ n, howmany, fftwf_alignment_of(in), fftwf_alignment_of(reinterpret_cast<float*>(out)) };
+    const auto gen = s_generation.load(std::memory_order_acquire);
+    fftwf_plan unused = nullptr;
+    auto result = Result::MEASURED;
+    {
+        std::lock_guard registry(s_registry_mtx);
+        auto& entry = s_plans[key];
+
+        // replan only if there is none yet, or new wisdom may have arrived for an estimated one
+        if((entry.plan == nullptr) || (!entry.measured && (entry.generation != gen)))
+        {
+            std::unique_lock planner(s_planner_mtx, std::try_to_lock);
+            if(!planner.owns_lock())
+            {
+                if(entry.plan == nullptr)
+                {
+                    s_plans.erase(key);
+                    return Result::BUSY;
+                }
+            }
+            else
+            {
+                destroy_deferred();
+                auto newplan = make_plan(n, howmany, in, out, FFTW_MEASURE | FFTW_WISDOM_ONLY);
+                const auto measured = (newplan != nullptr);
+                if(!measured && (entry.plan == nullptr))
+                    newplan = make_plan(n, howmany, in, out, FFTW_ESTIMATE);
+                if(newplan != nullptr)
+                {
+                    // a superseded plan stays alive in s_refs until its last user moves on
+                    entry.plan = newplan;
+                    entry.measured = measured;
+                }
+                entry.generation = gen;
+            }
+        }
+
+        if(entry.plan == nullptr)
+        {
+            s_plans.erase(key);
+            return Result::BUSY;
+        }
+        if(!entry.measured)
+            result = Result::ESTIMATED;
+        if(plan != entry.plan)
+        {
+            ++s_refs[entry.plan];
+            if((plan != nullptr) && unref(plan))
+                unused = plan;
+            plan = entry.plan;
+        }
+    }
+
+    if(unused != nullptr)
+        destroy(unused);
+    if(result == Result::ESTIMATED)
+        queue_measure({ n, howmany });
+    return result;
+}
+
+void FFTPlanner::release(fftwf_plan plan)
+{
+    if(plan == nullptr)
+        return;
+    {
+        std::lock_guard registry(s_registry_mtx);
+        if(!unref(plan))
+            return;
+    }
+    destroy(plan);
+}
+
+uint64_t FFTPlanner::generation() noexcept
+{
+    return s_generation.load(std::memory_order_acquire);
+}
@@ -0,0 +1,54 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <cstdint>
+#include <fftw3.h>
+
+// Owner of all FFTW planner calls, which are not thread-safe.
+// Sizes without measured wisdom get an FFTW_ESTIMATE plan right away and are queued
+// for FFTW_MEASURE on a worker thread. The result is kept as wisdom (saved to the module config
+// directory) and sources swap in the measured plan once generation() changes.
+// Nothing here blocks on the worker, calls that would have to wait report BUSY instead.
+// Plans are shared process-wide and refcounted, one per size, batch count and buffer alignment.
+// Run them with fftwf_execute_dft_r2c on the caller's own buffers, never fftwf_execute.
+// Large transforms are planned multithreaded when FFTW was built with threads, see the module config.ini.
+class FFTPlanner
+{
+public:
+    enum class Result
+    {
+        BUSY,       // planner in use, plan unchanged
+        ESTIMATED,  // planned without measuring, a measured plan will follow
+        MEASURED    // planned from measured wisdom
+    };
+
+    static void start();    // start the worker, which loads the wisdom first
+    static void stop();     // stop the worker and save wisdom
+
+    // replace plan with a shared plan for howmany real to complex transforms of n points
+    // input and output of each transform are n elements apart
+    // in and out are only used to plan new sizes and pick the alignment, they are not kept
+    // the previous plan is released unless the result is BUSY
+    static Result acquire_r2c(int n, int howmany, float *in, fftwf_complex *out, fftwf_plan& plan);
+
+    // drop a reference from acquire_r2c, the last one destroys the plan
+    static void release(fftwf_plan plan);
+
+    // bumped every time the worker adds wisdom
+    static uint64_t generation() noexcept;
+};
@@ -20,10 +20,15 @@
 #include "aligned_buffer.hpp"
 #include "math_funcs.hpp"
 #include <cmath>
+#include <algorithm>
+#include <cassert>
 #include <cstdint>
+#include <span>
+#include <utility>
 #include <vector>
 #include <type_traits>
 #include <numbers>
+#include <limits>
 
 template<typename T>
 struct Kernel
@@ -35,8 +40,56 @@ struct Kernel
     int sse_size = 0;
     int avx_size = 0;
     T sum = (T)0;
+    std::vector<uint32_t> offsets;  // interpolation kernels only, start of each point's weights
+    bool catrom = false;            // no table, weights come from catrom_weights()
+    T tension = (T)0;               // catmull-rom only
+    size_t interior_begin = 0;      // points [interior_begin, interior_end) only reach samples inside the input
+    size_t interior_end = 0;
+    size_t interior_sz = 0;         // input size the interior was found for
 };
 
+// interpolation kernels are tables of weights by fractional phase instead of by point
+// a point uses the phase nearest to its position, 256 phases keep lanczos within L1
+constexpr int INTERP_PHASES = 256;
+
+template<typename T>
+void make_phase_offsets(Kernel<T>& kernel, const std::vector<T>& indices)
+{
+    kernel.offsets.resize(indices.size());
+    for(size_t i = 0; i < indices.size(); ++i)
+    {
+        const auto u = indices[i] - (T)(intmax_t)indices[i]; // NOTE: positive indices only, same as the filters
+        kernel.offsets[i] = (uint32_t)std::lround(u * INTERP_PHASES) * (uint32_t)kernel.size; // phase INTERP_PHASES is u = 1
+    }
+}
+
+// interpolation points come in ascending order, so the points that need bounds checks are at either end
+template<typename T>
+std::pair<size_t, size_t> find_interior(const Kernel<T>& kernel, const std::vector<T>& indices, size_t sz)
+{
+    const auto first = std::partition_point(indices.begin(), indices.end(), [&](T v) { return ((intmax_t)v - kernel.radius + 1) < 0; });
+    const auto last = std::partition_point(first, indices.end(), [&](T v) { return ((intmax_t)v + kernel.radius) < (intmax_t)sz; });
+    return { (size_t)(first - indices.begin()), (size_t)(last - indices.begin()) };
+}
+
+// done once with the indices, the filters only search again if they run on a different input size
+template<typename T>
+void set_interior(Kernel<T>& kernel, const std::vector<T>& indices, size_t sz)
+{
+    const auto [begin, end] = find_interior(kernel, indices, sz);
+    kernel.interior_begin = begin;
+    kernel.interior_end = end;
+    kernel.interior_sz = sz;
+}
+
+template<typename T>
+std::pair<size_t, size_t> get_interior(const Kernel<T>& kernel, const std::vector<T>& indices, size_t sz)
+{
+    if((kernel.interior_sz == sz) && (kernel.interior_end <= indices.size()))
+        return { kernel.interior_begin, kernel.interior_end };
+    return find_interior(kernel, indices, sz);
+}
+
 template<typename T>
 Kernel<T> make_gauss_kernel(T sigma)
 {
@@ -64,82 +117,134 @@ Kernel<T> make_gauss_kernel(T sigma)
     return ret;
 }
 
+// catmull-rom weights are a cheap cubic in each point's fraction, so they are computed inline instead of stored
 template<typename T>
-Kernel<T> make_catrom_kernel(const std::vector<T>& indices, T t)
+Kernel<T> make_catrom_kernel(T t)
 {
     Kernel<T> ret;
-    T matrix[4][4] = {
-        { 0, -t,       2 * t,    -t },
-        { 1,  0,       t - 3, 2 - t },
-        { 0,  t, 3 - (2 * t), t - 2 },
-        { 0,  0,          -t,     t }
-    };
-
-    const auto size = (intmax_t)indices.size();
-    if(size <= 0)
-        return ret;
-    const auto ksize = size * 4;
-    ret.weights.reset(ksize);
     ret.radius = 2;
     ret.size = 4;
     ret.sse_size = 4 & -(16 / (int)sizeof(T));
     ret.avx_size = 4 & -(32 / (int)sizeof(T));
+    ret.catrom = true;
+    ret.tension = t;
+    return ret;
+}
 
-    for(intmax_t i = 0; i < size; ++i)
-    {
-        auto u = indices[i] - std::floor(indices[i]);
-        T row[4] = { 1, u, u * u, u * u * u };
-
-        for(intmax_t j = 0; j < 4; ++j)
-        {
-            T sum = 0;
-            for(intmax_t k = 0; k < 4; ++k)
-                sum += row[k] * matrix[j][k];
-            ret.weights[(i * 4) + j] = sum;
-        }
-    }
+// weights of the sample before the point's integer part up to two after it, u is the fraction
+// rows of the catmull-rom basis matrix in horner form
+template<typename T>
+WAV_FORCE_INLINE void catrom_weights(T u, T t, T *w)
+{
+    const auto u2 = u * u;
+    w[0] = u * ((u * (((T)2 * t) - (t * u))) - t);
+    w[1] = (T)1 + (u2 * ((t - (T)3) + (((T)2 - t) * u)));
+    w[2] = u * (t + (u * (((T)3 - ((T)2 * t)) + ((t - (T)2) * u))));
+    w[3] = u2 * t * (u - (T)1);
+}
 
-    return ret;
+// weights of point k, from the phase table or computed into tmp (at least 4 elements) for catmull-rom
+template<typename T>
+WAV_FORCE_INLINE const T *point_weights(const Kernel<T>& kernel, const std::vector<T>& x, size_t k, T *tmp)
+{
+    if(!kernel.catrom)
+        return &kernel.weights[kernel.offsets[k]];
+    catrom_weights(x[k] - (T)(intmax_t)x[k], kernel.tension, tmp); // NOTE: positive indices only, same as the filters
+    return tmp;
 }
 
-// this creates a rather large lookup table, size * (radius * 2) * sizeof(T) bytes
+// (INTERP_PHASES + 1) * (radius * 2) * sizeof(T) bytes, independent of the number of points
 template<typename T>
 Kernel<T> make_lanczos_kernel(const std::vector<T>& indices, const intmax_t radius)
 {
     Kernel<T> ret;
-    const auto size = (intmax_t)indices.size();
-    if((size <= 0) || (radius <= 0))
+    if(indices.empty() || (radius <= 0))
         return ret;
-    const auto ksize = size * (radius * 2);
-    ret.weights.reset(ksize);
+    const auto size = radius * 2;
+    ret.weights.reset((INTERP_PHASES + 1) * size);
     ret.radius = (int)radius;
-    ret.size = (int)(radius * 2);
+    ret.size = (int)size;
     ret.sse_size = ret.size & -(16 / (int)sizeof(T));
     ret.avx_size = ret.size & -(32 / (int)sizeof(T));
     const auto fradius = (T)radius;
-    for(intmax_t i = 0; i < size; ++i)
+    for(intmax_t i = 0; i <= INTERP_PHASES; ++i)
     {
-        const auto x = indices[i];
-        const auto ix = (intmax_t)x; // NOTE: technically std::floor(x) but negatives are out of our domain so this is slightly faster
-        const auto start = ix - radius + 1;
-        const auto stop = ix + radius;
-        const auto base = i * radius * 2;
-        for(auto j = start; j <= stop; ++j)
-            ret.weights[base + (j - start)] = lanczos(x - j, fradius);
+        // weights of the samples from radius - 1 before the point's integer part to radius after it
+        const auto u = (T)i / (T)INTERP_PHASES;
+        for(intmax_t j = 0; j < size; ++j)
+            ret.weights[(i * size) + j] = lanczos(u + (T)(radius - 1 - j), fradius);
     }
+
+    make_phase_offsets(ret, indices);
     return ret;
 }
 
+// Young-van Vliet recursive gaussian, a causal and an anti-causal third order IIR pass
+// the cost per sample doesn't depend on sigma
 template<typename T>
-T weighted_avg(const std::vector<T>& samples, const Kernel<T>& kernel, intmax_t index)
+struct RecursiveGauss
+{
+    static_assert(std::is_floating_point_v<T>, "RecursiveGauss must be a floating point type.");
+    T b = (T)1;         // input gain
+    T a[3] = {};        // feedback of the last three outputs
+};
+
+template<typename T>
+RecursiveGauss<T> make_recursive_gauss(T sigma)
+{
+    RecursiveGauss<T> ret;
+    sigma = std::max(std::abs(sigma), (T)0.5); // below 0.5 the approximation breaks down
+    const auto q = (sigma >= (T)2.5) ? ((T)0.98711 * sigma) - (T)0.96330 : (T)3.97156 - ((T)4.14554 * std::sqrt((T)1 - ((T)0.26891 * sigma)));
+    const auto q2 = q * q;
+    const auto q3 = q2 * q;
+    const auto b0 = (T)1.57825 + ((T)2.44413 * q) + ((T)1.4281 * q2) + ((T)0.422205 * q3);
+    ret.a[0] = (((T)2.44413 * q) + ((T)2.85619 * q2) + ((T)1.26661 * q3)) / b0;
+    ret.a[1] = -(((T)1.4281 * q2) + ((T)1.26661 * q3)) / b0;
+    ret.a[2] = ((T)0.422205 * q3) / b0;
+    ret.b = (T)1 - (ret.a[0] + ret.a[1] + ret.a[2]);
+    return ret;
+}
+
+// edges are extended with the edge value, the state runs in double so large sigmas don't drift
+template<typename T>
+void apply_recursive_gauss(const T *samples, size_t sz, const RecursiveGauss<T>& coeffs, std::span<T> output)
+{
+    assert(output.size() >= sz);
+    if(sz == 0)
+        return;
+    const double b = coeffs.b, a0 = coeffs.a[0], a1 = coeffs.a[1], a2 = coeffs.a[2];
+
+    double w1 = samples[0], w2 = w1, w3 = w1;
+    for(size_t i = 0; i < sz; ++i)
+    {
+        const auto w = (b * samples[i]) + (a0 * w1) + (a1 * w2) + (a2 * w3);
+        w3 = w2;
+        w2 = w1;
+        w1 = w;
+        output[i] = (T)w;
+    }
+
+    w1 = w2 = w3 = output[sz - 1];
+    for(auto i = sz; i-- > 0;)
+    {
+        const auto w = (b * output[i]) + (a0 * w1) + (a1 * w2) + (a2 * w3);
+        w3 = w2;
+        w2 = w1;
+        w1 = w;
+        output[i] = (T)w;
+    }
+}
+
+template<typename T>
+T weighted_avg(const T *samples, size_t sz, const Kernel<T>& kernel, intmax_t index)
 {
     const auto start = (index - kernel.radius) + 1;
     const auto stop = index + kernel.radius;
     T sum = (T)0;
-    if((start < 0) || (stop > (intmax_t)samples.size()))
+    if((start < 0) || (stop > (intmax_t)sz))
     {
         const auto loopstart = std::max(start, (intmax_t)0);
-        const auto loopstop = std::min(stop, (intmax_t)samples.size());
+        const auto loopstop = std::min(stop, (intmax_t)sz);
         T wsum = (T)0;
         for(auto i = loopstart; i < loopstop; ++i)
         {
@@ -158,67 +263,371 @@ T weighted_avg(const std::vector<T>& samples, const Kernel<T>& kernel, intmax_t
 }
 
 template<typename T>
-WAV_FORCE_INLINE T kernel_convolve(const T *samples, size_t sz, const Kernel<T>& kernel, intmax_t index, intmax_t kernel_base)
+WAV_FORCE_INLINE T kernel_convolve(const T *samples, size_t sz, const Kernel<T>& kernel, intmax_t index, const T *weights)
 {
     const auto start = (index - kernel.radius) + 1;
     const auto stop = std::min(index + kernel.radius + 1, (intmax_t)sz);
     T sum = (T)0;
     for(auto i = std::max(start, (intmax_t)0); i < stop; ++i)
-        sum += samples[i] * kernel.weights[kernel_base + (i - start)];
+        sum += samples[i] * weights[i - start];
     return sum;
 }
 
+// no bounds checks, samples points at the first tap
+template<int Radius, typename T>
+WAV_FORCE_INLINE T kernel_convolve_fixed(const T *samples, const T *weights)
+{
+    return [&]<size_t... I>(std::index_sequence<I...>) {
+        return (... + (samples[I] * weights[I]));
+    }(std::make_index_sequence<Radius * 2>());
+}
+
 template<typename T>
-std::vector<T>& apply_filter(const std::vector<T>& samples, const Kernel<T>& kernel, std::vector<T>& output)
+void apply_filter(const T *samples, size_t sz, const Kernel<T>& kernel, std::span<T> output)
 {
-    const auto sz = samples.size();
-    if(output.size() < sz)
-        output.resize(sz);
+    assert(output.size() >= sz);
     for(auto i = 0u; i < sz; ++i)
-        output[i] = weighted_avg(samples, kernel, i);
-    return output;
+        output[i] = weighted_avg(samples, sz, kernel, i);
+}
+
+// fully unrolled taps for the interior, the bounds checked path only runs at the edges
+template<int Radius, typename T>
+void apply_interp_filter_fixed(const T *samples, size_t sz, const std::vector<T>& x, const Kernel<T>& kernel, std::span<T> output)
+{
+    const auto xsz = x.size();
+    assert(output.size() >= xsz);
+    const auto [begin, end] = get_interior(kernel, x, sz);
+    T tmp[Radius * 2];
+    for(size_t i = 0; i < begin; ++i)
+        output[i] = kernel_convolve(samples, sz, kernel, (intmax_t)x[i], point_weights(kernel, x, i, tmp));
+    for(auto i = begin; i < end; ++i)
+        output[i] = kernel_convolve_fixed<Radius>(&samples[(intmax_t)x[i] - Radius + 1], point_weights(kernel, x, i, tmp));
+    for(auto i = end; i < xsz; ++i)
+        output[i] = kernel_convolve(samples, sz, kernel, (intmax_t)x[i], point_weights(kernel, x, i, tmp));
+}
+
+// bar graph version
+template<int Radius, typename T>
+void apply_interp_filter_fixed(const T *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<T>& x, const Kernel<T>& kernel, std::span<T> output)
+{
+    const auto bands = band_widths.size();
+    assert(output.size() >= bands);
+    const auto [begin, end] = get_interior(kernel, x, sz);
+    T tmp[Radius * 2];
+    for(size_t i = 0, k = 0; i < bands; ++i)
+    {
+        auto sum = (T)0;
+        const auto count = (size_t)band_widths[i];
+        for(size_t j = 0; j < count; ++j, ++k)
+        {
+            if((k >= begin) && (k < end))
+                sum += kernel_convolve_fixed<Radius>(&samples[(intmax_t)x[k] - Radius + 1], point_weights(kernel, x, k, tmp));
+            else
+                sum += kernel_convolve(samples, sz, kernel, (intmax_t)x[k], point_weights(kernel, x, k, tmp));
+        }
+        output[i] = sum / (T)count;
+    }
 }
 
 template<typename T>
-std::vector<T>& apply_interp_filter(const T *samples, size_t sz, const std::vector<T>& x, const Kernel<T>& kernel, std::vector<T>& output)
+void apply_interp_filter(const T *samples, size_t sz, const std::vector<T>& x, const Kernel<T>& kernel, std::span<T> output)
 {
+    if(kernel.radius == 4)
+        return apply_interp_filter_fixed<4>(samples, sz, x, kernel, output); // lanczos
+    else if(kernel.radius == 2)
+        return apply_interp_filter_fixed<2>(samples, sz, x, kernel, output); // catmull-rom
     const auto xsz = (intmax_t)x.size();
-    const auto d = (intmax_t)kernel.radius * 2;
-    if((intmax_t)output.size() < xsz)
-        output.resize(xsz);
-    for(intmax_t i = 0, j = 0; i < xsz; ++i, j += d)
-        output[i] = kernel_convolve(samples, sz, kernel, (intmax_t)x[i], j);
-    return output;
+    assert((intmax_t)output.size() >= xsz);
+    for(intmax_t i = 0; i < xsz; ++i)
+        output[i] = kernel_convolve(samples, sz, kernel, (intmax_t)x[i], &kernel.weights[kernel.offsets[i]]);
 }
 
 // bar graph version
 template<typename T>
-std::vector<T>& apply_interp_filter(const T *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<T>& x, const Kernel<T>& kernel, std::vector<T>& output)
+void apply_interp_filter(const T *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<T>& x, const Kernel<T>& kernel, std::span<T> output)
 {
-    const auto d = (intmax_t)kernel.radius * 2;
+    if(kernel.radius == 4)
+        return apply_interp_filter_fixed<4>(samples, sz, band_widths, x, kernel, output);
+    else if(kernel.radius == 2)
+        return apply_interp_filter_fixed<2>(samples, sz, band_widths, x, kernel, output);
     const auto bands = (intmax_t)band_widths.size();
-    if((intmax_t)output.size() < bands)
-        output.resize(bands);
-    for(intmax_t i = 0, k = 0, l = 0; i < bands; ++i)
+    assert((intmax_t)output.size() >= bands);
+    for(intmax_t i = 0, k = 0; i < bands; ++i)
     {
         auto sum = (T)0;
         auto count = (intmax_t)band_widths[i];
-        for(intmax_t j = 0; j < count; ++j, ++k, l += d)
-            sum += kernel_convolve(samples, sz, kernel, (intmax_t)x[k], l);
+        for(intmax_t j = 0; j < count; ++j, ++k)
+            sum += kernel_convolve(samples, sz, kernel, (intmax_t)x[k], &kernel.weights[kernel.offsets[k]]);
         output[i] = sum / (T)count;
     }
-    return output;
+}
+
+// bar graph version over a running sum of the input
+// points of a band are consecutive bins sharing one phase, so each band is one kernel over window sums
+// O(kernel size) per band regardless of its width, plus one pass over the samples
+template<typename T>
+void apply_interp_filter_prefix(const T *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<T>& x, const Kernel<T>& kernel, std::vector<double>& prefix, std::span<T> output)
+{
+    const auto bands = band_widths.size();
+    assert(output.size() >= bands);
+    if(x.empty())
+        return;
+
+    // running sum over every sample any band's kernel reaches, samples outside of the input are zero
+    const auto base = (intmax_t)x.front() - kernel.radius + 1;
+    const auto end = (intmax_t)x.back() + kernel.radius + 1;
+    prefix.resize((size_t)(end - base) + 1);
+    prefix[0] = 0.0;
+    for(auto i = base; i < end; ++i)
+        prefix[(size_t)(i - base) + 1] = prefix[(size_t)(i - base)] + (((i >= 0) && (i < (intmax_t)sz)) ? samples[i] : (T)0);
+
+    T tmp[4]; // catmull-rom weights
+    for(size_t i = 0, k = 0; i < bands; k += (size_t)band_widths[i++])
+    {
+        const auto count = (size_t)band_widths[i];
+        const auto first = &prefix[(size_t)((intmax_t)x[k] - kernel.radius + 1 - base)];
+        const auto weights = point_weights(kernel, x, k, tmp);
+        double sum = 0.0;
+        for(intmax_t t = 0; t < kernel.size; ++t)
+            sum += weights[t] * (first[t + count] - first[t]);
+        output[i] = (T)(sum / (double)count);
+    }
+}
+
+// perceptual frequency scales for bar bands, see make_filterbank()
+enum class BandScale
+{
+    NONE,   // bars follow the display points, see apply_interp_filter()
+    MEL,    // O'Shaughnessy
+    BARK,   // Traunmuller
+    ERB,    // Glasberg and Moore ERB-rate
+    OCTAVE  // log2, each band 1/N octave for N bands per octave of the range
+};
+
+template<typename T>
+T hz_to_scale(BandScale scale, T hz)
+{
+    switch(scale)
+    {
+    case BandScale::MEL:
+        return (T)2595 * std::log10((T)1 + (hz / (T)700));
+    case BandScale::BARK:
+        return (((T)26.81 * hz) / ((T)1960 + hz)) - (T)0.53;
+    case BandScale::ERB:
+        return (T)21.4 * std::log10((T)1 + ((T)0.00437 * hz));
+    case BandScale::OCTAVE:
+        return std::log2(std::max(hz, (T)1));
+    default:
+        return hz;
+    }
+}
+
+template<typename T>
+T scale_to_hz(BandScale scale, T v)
+{
+    switch(scale)
+    {
+    case BandScale::MEL:
+        return (T)700 * (std::pow((T)10, v / (T)2595) - (T)1);
+    case BandScale::BARK:
+        return ((T)1960 * (v + (T)0.53)) / ((T)26.28 - v);
+    case BandScale::ERB:
+        return (std::pow((T)10, v / (T)21.4) - (T)1) / (T)0.00437;
+    case BandScale::OCTAVE:
+        return std::exp2(v);
+    default:
+        return v;
+    }
+}
+
+// triangular filters evenly spaced on a perceptual scale, stored sparse
+// band i is the dot product of bins [start[i], start[i] + count[i]) with its weights, which sum to one
+template<typename T>
+struct Filterbank
+{
+    std::vector<uint32_t> start;
+    std::vector<uint32_t> count;
+    std::vector<uint32_t> offsets;  // first weight of each band
+    AlignedBuffer<T> weights;
+    std::vector<T> edges;           // Hz, band i rises from edges[i] to edges[i + 1] and falls to edges[i + 2]
+    size_t first_bin = 0;           // lowest bin any band reads
+    size_t last_bin = 0;            // one past the highest
+
+    bool empty() const noexcept { return start.empty(); }
+};
+
+// bands between low and high Hz over bins of bin_hz each, bins past sz are never read
+// spread > 1 reaches the top of the range early and repeats the top band after, for mirrored layouts
+// triangles narrower than a bin become linear interpolation at their center, so no band is ever empty
+template<typename T>
+Filterbank<T> make_filterbank(BandScale scale, size_t bands, T low, T high, T bin_hz, size_t sz, T spread = (T)1)
+{
+    Filterbank<T> ret;
+    if((bands == 0) || (sz < 2) || (bin_hz <= (T)0) || (scale == BandScale::NONE))
+        return ret;
+    const auto lo = hz_to_scale(scale, std::max(low, bin_hz));
+    const auto hi = hz_to_scale(scale, std::clamp(high, std::max(low, bin_hz), bin_hz * (T)(sz - 1)));
+    ret.edges.resize(bands + 2);
+    for(size_t k = 0; k < bands + 2; ++k)
+        ret.edges[k] = scale_to_hz(scale, lerp(lo, hi, std::min(((T)k * spread) / (T)(bands + 1), (T)1)));
+
+    std::vector<T> weights;
+    ret.start.resize(bands);
+    ret.count.resize(bands);
+    ret.offsets.resize(bands);
+    ret.first_bin = sz;
+    for(size_t i = 0; i < bands; ++i)
+    {
+        const auto left = ret.edges[i];
+        const auto center = ret.edges[i + 1];
+        const auto right = ret.edges[i + 2];
+        const auto first = (size_t)std::ceil(left / bin_hz);
+        const auto last = std::min((size_t)std::floor(right / bin_hz), sz - 1);
+        ret.offsets[i] = (uint32_t)weights.size();
+        T sum = (T)0;
+        size_t begin = sz, end = 0;
+        for(auto bin = first; bin <= last; ++bin)
+        {
+            const auto hz = (T)bin * bin_hz;
+            const auto w = (hz <= center) ? ((center > left) ? (hz - left) / (center - left) : (T)1) : ((right > center) ? (right - hz) / (right - center) : (T)0);
+            if(w <= (T)0)
+            {
+                if(begin < sz)
+                    break; // past the falling edge
+                continue;
+            }
+            if(begin == sz)
+                begin = bin;
+            end = bin + 1;
+            weights.push_back(w);
+            sum += w;
+        }
+        if(sum <= (T)0)
+        {
+            // between two bins
+            const auto x = std::clamp(center / bin_hz, (T)0, (T)(sz - 1));
+            begin = std::min((size_t)x, sz - 2);
+            end = begin + 2;
+            const auto u = x - (T)begin;
+            weights.resize(ret.offsets[i]);
+            weights.push_back((T)1 - u);
+            weights.push_back(u);
+            sum = (T)1;
+        }
+        for(auto j = ret.offsets[i]; j < weights.size(); ++j)
+            weights[j] /= sum;
+        ret.start[i] = (uint32_t)begin;
+        ret.count[i] = (uint32_t)(end - begin);
+        ret.first_bin = std::min(ret.first_bin, begin);
+        ret.last_bin = std::max(ret.last_bin, end);
+    }
+    ret.weights.reset(weights.size());
+    std::copy(weights.begin(), weights.end(), ret.weights.get());
+    return ret;
+}
+
+template<typename T>
+void apply_filterbank(const T *samples, const Filterbank<T>& bank, std::span<T> output)
+{
+    const auto bands = bank.start.size();
+    assert(output.size() >= bands);
+    for(size_t i = 0; i < bands; ++i)
+    {
+        const auto src = &samples[bank.start[i]];
+        const auto w = &bank.weights[bank.offsets[i]];
+        T sum = (T)0;
+        for(uint32_t j = 0; j < bank.count[i]; ++j)
+            sum += src[j] * w[j];
+        output[i] = sum;
+    }
+}
+
+// dB to pixel heights in place, ceiling maps to top and ceiling - range or lower to bottom
+// returns the index of the first smallest height and the height in miny
+template<typename T>
+size_t map_db_heights(T *values, size_t count, T ceiling, T range, T top, T bottom, T& miny)
+{
+    const auto span = bottom - top;
+    size_t minpos = 0;
+    miny = std::numeric_limits<T>::max();
+    for(size_t i = 0; i < count; ++i)
+    {
+        const auto val = top + (span * (std::clamp(ceiling - values[i], (T)0, range) / range));
+        if(val < miny)
+        {
+            miny = val;
+            minpos = i;
+        }
+        values[i] = val;
+    }
+    return minpos;
 }
 
 #ifdef ENABLE_X86_SIMD
 
-float weighted_avg_fma3(const std::vector<float>& samples, const Kernel<float>& kernel, intmax_t index);
+float weighted_avg_fma3(const float *samples, size_t sz, const Kernel<float>& kernel, intmax_t index);
+
+void apply_filter_fma3(const float *samples, size_t sz, const Kernel<float>& kernel, std::span<float> output);
+
+void apply_interp_filter_fma3(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output);
+
+// bar graph version
+void apply_interp_filter_fma3(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output);
+
+void apply_interp_filter_avx512(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output);
+
+// bar graph version
+void apply_interp_filter_avx512(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output);
+
+void apply_filterbank_fma3(const float *samples, const Filterbank<float>& bank, std::span<float> output);
+
+size_t map_db_heights_fma3(float *values, size_t count, float ceiling, float range, float top, float bottom, float& miny);
 
-std::vector<float>& apply_filter_fma3(const std::vector<float>& samples, const Kernel<float>& kernel, std::vector<float>& output);
+// same kernels without FMA, for AVX cpus that lack it
+float weighted_avg_avx(const float *samples, size_t sz, const Kernel<float>& kernel, intmax_t index);
 
-std::vector<float>& apply_interp_filter_fma3(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::vector<float>& output);
+void apply_filter_avx(const float *samples, size_t sz, const Kernel<float>& kernel, std::span<float> output);
+
+void apply_interp_filter_avx(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output);
 
 // bar graph version
-std::vector<float>& apply_interp_filter_fma3(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::vector<float>& output);
+void apply_interp_filter_avx(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output);
+
+void apply_filterbank_avx(const float *samples, const Filterbank<float>& bank, std::span<float> output);
+
+size_t map_db_heights_avx(float *values, size_t count, float ceiling, float range, float top, float bottom, float& miny);
+
+// 128-bit kernels only, the interpolation filters need AVX
+float weighted_avg_sse41(const float *samples, size_t sz, const Kernel<float>& kernel, intmax_t index);
+
+void apply_filter_sse41(const float *samples, size_t sz, const Kernel<float>& kernel, std::span<float> output);
+
+void apply_filterbank_sse41(const float *samples, const Filterbank<float>& bank, std::span<float> output);
 
 #endif // ENABLE_X86_SIMD
+
+#ifdef ENABLE_ARM_SIMD
+
+float weighted_avg_neon(const float *samples, size_t sz, const Kernel<float>& kernel, intmax_t index);
+
+void apply_filter_neon(const float *samples, size_t sz, const Kernel<float>& kernel, std::span<float> output);
+
+void apply_interp_filter_neon(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output);
+
+// bar graph version
+void apply_interp_filter_neon(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output);
+
+void apply_filterbank_neon(const float *samples, const Filterbank<float>& bank, std::span<float> output);
+
+size_t map_db_heights_neon(float *values, size_t count, float ceiling, float range, float top, float bottom, float& miny);
+
+#endif // ENABLE_ARM_SIMD
+
+#ifdef ENABLE_ACCELERATE_FFT
+
+// vDSP versions for Apple builds, output must not overlap samples
+void apply_filter_accelerate(const float *samples, size_t sz, const Kernel<float>& kernel, std::span<float> output);
+
+void apply_filterbank_accelerate(const float *samples, const Filterbank<float>& bank, std::span<float> output);
+
+#endif // ENABLE_ACCELERATE_FFT
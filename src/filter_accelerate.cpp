@@ -0,0 +1,51 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "filter.hpp"
+#include <Accelerate/Accelerate.h>
+#include <algorithm>
+#include <cassert>
+
+// the interior is one vDSP_conv over every point whose window fits in the input, scaled by the kernel sum
+// the few points at either edge renormalize by the weights they reach, same as weighted_avg
+void apply_filter_accelerate(const float *samples, size_t sz, const Kernel<float>& kernel, std::span<float> output)
+{
+    assert(output.size() >= sz);
+    const auto radius = (size_t)kernel.radius;
+    const auto length = (2 * radius) - 1;
+    if((radius == 0) || (sz < length))
+        return apply_filter(samples, sz, kernel, output);
+
+    const auto interior = (sz - length) + 1; // points radius - 1 through sz - radius
+    vDSP_conv(samples, 1, kernel.weights.get(), 1, &output[radius - 1], 1, (vDSP_Length)interior, (vDSP_Length)length);
+    const auto scale = 1.0f / kernel.sum;
+    vDSP_vsmul(&output[radius - 1], 1, &scale, &output[radius - 1], 1, (vDSP_Length)interior);
+
+    for(size_t i = 0; i < radius - 1; ++i)
+        output[i] = weighted_avg(samples, sz, kernel, i);
+    for(auto i = (radius - 1) + interior; i < sz; ++i)
+        output[i] = weighted_avg(samples, sz, kernel, i);
+}
+
+void apply_filterbank_accelerate(const float *samples, const Filterbank<float>& bank, std::span<float> output)
+{
+    const auto bands = bank.start.size();
+    assert(output.size() >= bands);
+    for(size_t i = 0; i < bands; ++i)
+        vDSP_dotpr(&samples[bank.start[i]], 1, &bank.weights[bank.offsets[i]], 1, &output[i], (vDSP_Length)bank.count[i]);
+}
@@ -0,0 +1,53 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "filter_x86.hpp"
+
+float weighted_avg_avx(const float *samples, size_t sz, const Kernel<float>& kernel, intmax_t index)
+{
+    return weighted_avg_x86<false>(samples, sz, kernel, index);
+}
+
+void apply_filter_avx(const float *samples, size_t sz, const Kernel<float>& kernel, std::span<float> output)
+{
+    apply_filter_x86<false>(samples, sz, kernel, output);
+}
+
+void apply_interp_filter_avx(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    apply_interp_filter_x86<false>(samples, sz, x, kernel, output);
+}
+
+void apply_interp_filter_avx(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    apply_interp_filter_x86<false>(samples, sz, band_widths, x, kernel, output);
+}
+
+void apply_filterbank_avx(const float *samples, const Filterbank<float>& bank, std::span<float> output)
+{
+    apply_filterbank_x86<false>(samples, bank, output);
+}
+
+void iir_bank_avx(const IIRFilterbank::Pass& pass)
+{
+    iir_bank_x86<false>(pass);
+}
+
+size_t map_db_heights_avx(float *values, size_t count, float ceiling, float range, float top, float bottom, float& miny)
+{
+    return map_db_heights_x86<false>(values, count, ceiling, range, top, bottom, miny);
+}
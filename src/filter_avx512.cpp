@@ -0,0 +1,125 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "filter.hpp"
+#include "simd_helpers.hpp"
+#include <immintrin.h>
+#include <algorithm>
+#include <cassert>
+
+// two lanczos points per 512-bit vector, each point's 8 weights come from its phase in the kernel table
+// lanes of a point that hang off either end of the input are masked out instead of taking the scalar path
+
+// mask and base offset for the 8 samples around index, clipped to [0, sz)
+static WAV_FORCE_INLINE __mmask16 point_mask(intmax_t index, intmax_t sz, intmax_t& start)
+{
+    start = index - 3;
+    const auto lo = std::max(-start, (intmax_t)0);
+    const auto hi = std::min(sz - start, (intmax_t)8);
+    if(hi <= lo)
+        return 0;
+    return (__mmask16)(((1u << hi) - 1u) & ~((1u << lo) - 1u));
+}
+
+// samples [index - 3, index + 5) of one point into 8 lanes, masked lanes are zero and never read
+static WAV_FORCE_INLINE __m256 load_point(const float *samples, intmax_t sz, intmax_t index)
+{
+    intmax_t start;
+    const auto mask = point_mask(index, sz, start);
+    if(mask == 0xff)
+        return _mm256_loadu_ps(&samples[start]);
+    // shift the mask instead of forming a pointer before the start of the buffer
+    const auto base = std::max(start, (intmax_t)0);
+    const auto shift = (int)(base - start);
+    auto lanes = _mm512_maskz_loadu_ps((__mmask16)(mask >> shift), &samples[base]);
+    if(shift > 0) // move the loaded samples up to their lanes
+        lanes = _mm512_maskz_permutexvar_ps(mask, _mm512_sub_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(shift)), lanes);
+    return low_half(lanes);
+}
+
+static WAV_FORCE_INLINE __m512 load_pair(const float *samples, intmax_t sz, intmax_t index0, intmax_t index1)
+{
+    const auto lo = load_point(samples, sz, index0);
+    const auto hi = load_point(samples, sz, index1);
+    return join_halves(lo, hi);
+}
+
+// weights of points k and k + 1
+static WAV_FORCE_INLINE __m512 load_weights(const Kernel<float>& kernel, size_t k)
+{
+    const auto lo = _mm256_load_ps(&kernel.weights[kernel.offsets[k]]);
+    const auto hi = _mm256_load_ps(&kernel.weights[kernel.offsets[k + 1]]);
+    return join_halves(lo, hi);
+}
+
+// specialized for kernel.size = 8
+static void apply_interp_filter_avx512_x8(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    assert(kernel.radius == 4);
+    const auto xsz = x.size();
+    assert(output.size() >= xsz);
+    size_t i = 0;
+    for(; i + 1 < xsz; i += 2)
+    {
+        const auto prod = _mm512_mul_ps(load_pair(samples, (intmax_t)sz, (intmax_t)x[i], (intmax_t)x[i + 1]), load_weights(kernel, i));
+        output[i] = horizontal_sum(low_half(prod));
+        output[i + 1] = horizontal_sum(high_half(prod));
+    }
+    if(i < xsz)
+        output[i] = horizontal_sum(_mm256_mul_ps(load_point(samples, (intmax_t)sz, (intmax_t)x[i]), _mm256_load_ps(&kernel.weights[kernel.offsets[i]])));
+}
+
+// bar graph version
+// specialized for kernel.size = 8
+static void apply_interp_filter_avx512_x8(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    assert(kernel.radius == 4);
+    const auto bands = (intmax_t)band_widths.size();
+    assert((intmax_t)output.size() >= bands);
+    for(intmax_t i = 0, k = 0; i < bands; ++i)
+    {
+        auto vecsum = _mm512_setzero_ps();
+        const auto count = (intmax_t)band_widths[i];
+        const auto end = k + count;
+        for(; k + 1 < end; k += 2)
+            vecsum = _mm512_fmadd_ps(load_pair(samples, (intmax_t)sz, (intmax_t)x[k], (intmax_t)x[k + 1]), load_weights(kernel, (size_t)k), vecsum);
+        if(k < end)
+        {
+            const auto prod = _mm256_mul_ps(load_point(samples, (intmax_t)sz, (intmax_t)x[k]), _mm256_load_ps(&kernel.weights[kernel.offsets[k]]));
+            vecsum = _mm512_add_ps(vecsum, join_halves(prod, _mm256_setzero_ps()));
+            ++k;
+        }
+        output[i] = horizontal_sum(vecsum) / count;
+    }
+}
+
+void apply_interp_filter_avx512(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    if(kernel.size == 8)
+        return apply_interp_filter_avx512_x8(samples, sz, x, kernel, output); // lanczos
+    else
+        return apply_interp_filter_fma3(samples, sz, x, kernel, output); // catmull-rom fits 128-bit vectors already
+}
+
+void apply_interp_filter_avx512(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    if(kernel.size == 8)
+        return apply_interp_filter_avx512_x8(samples, sz, band_widths, x, kernel, output); // lanczos
+    else
+        return apply_interp_filter_fma3(samples, sz, band_widths, x, kernel, output);
+}
@@ -0,0 +1,323 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "filter.hpp"
+#include "simd_helpers.hpp"
+#include "iir_filterbank.hpp"
+#include <arm_neon.h>
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <utility>
+
+float weighted_avg_neon(const float *samples, size_t sz, const Kernel<float>& kernel, intmax_t index)
+{
+    const auto start = (index - kernel.radius) + 1;
+    const auto stop = index + kernel.radius;
+    float sum = 0.0f;
+    if((start < 0) || (stop > (intmax_t)sz))
+    {
+        const auto loopstart = std::max(start, (intmax_t)0);
+        const auto loopstop = std::min(stop, (intmax_t)sz);
+        float wsum = 0.0f;
+        for(auto i = loopstart; i < loopstop; ++i)
+        {
+            auto weight = kernel.weights[i - start];
+            wsum += weight;
+            sum += samples[i] * weight;
+        }
+        return sum / wsum;
+    }
+    else
+    {
+        constexpr auto step = sizeof(float32x4_t) / sizeof(float);
+        const auto simdstop = start + kernel.sse_size;
+        auto vecsum = vdupq_n_f32(0.0f);
+        auto i = start;
+        for(; i < simdstop; i += step)
+            vecsum = vfmaq_f32(vecsum, vld1q_f32(&samples[i]), vld1q_f32(&kernel.weights[i - start]));
+        sum = horizontal_sum(vecsum);
+        for(; i < stop; ++i)
+            sum += samples[i] * kernel.weights[i - start];
+        return sum / kernel.sum;
+    }
+}
+
+void apply_filter_neon(const float *samples, size_t sz, const Kernel<float>& kernel, std::span<float> output)
+{
+    assert(output.size() >= sz);
+    if((size_t)kernel.sse_size >= ((sizeof(float32x4_t) / sizeof(float)) * 2)) // make sure we get at least 2 SIMD iterations
+    {
+        for(auto i = 0u; i < sz; ++i)
+            output[i] = weighted_avg_neon(samples, sz, kernel, i);
+    }
+    else // otherwise use the plain C version
+    {
+        for(auto i = 0u; i < sz; ++i)
+            output[i] = weighted_avg(samples, sz, kernel, i);
+    }
+}
+
+// edge of the input, only the samples inside [0, sz) contribute
+static WAV_FORCE_INLINE float convolve_edge(const float *samples, intmax_t sz, const float *weights, intmax_t start, intmax_t size)
+{
+    float sum = 0.0f;
+    const auto stop = std::min(start + size, sz);
+    for(auto k = std::max(start, (intmax_t)0); k < stop; ++k)
+        sum += samples[k] * weights[k - start];
+    return sum;
+}
+
+// specialized for kernel.size = 8
+static void apply_interp_filter_neon_x8(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    assert(kernel.radius == 4);
+    const auto simd_stop = (intmax_t)sz - 4;
+    const auto xsz = x.size();
+    assert(output.size() >= xsz);
+    for(size_t i = 0; i < xsz; ++i)
+    {
+        const auto j = kernel.offsets[i];
+        auto index = (intmax_t)x[i];
+        if((index >= 3) && (index < simd_stop))
+        {
+            const auto src = &samples[index - 3];
+            const auto sum = vfmaq_f32(vmulq_f32(vld1q_f32(src), vld1q_f32(&kernel.weights[j])), vld1q_f32(&src[4]), vld1q_f32(&kernel.weights[j + 4]));
+            output[i] = horizontal_sum(sum);
+        }
+        else
+            output[i] = convolve_edge(samples, (intmax_t)sz, &kernel.weights[j], index - 3, 8);
+    }
+}
+
+// bar graph version
+// specialized for kernel.size = 8
+static void apply_interp_filter_neon_x8(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    assert(kernel.radius == 4);
+    const auto simd_stop = (intmax_t)sz - 4;
+    const auto bands = (intmax_t)band_widths.size();
+    assert((intmax_t)output.size() >= bands);
+    for(intmax_t i = 0, k = 0; i < bands; ++i)
+    {
+        auto vecsum = vdupq_n_f32(0.0f);
+        float edgesum = 0.0f;
+        auto count = (intmax_t)band_widths[i];
+        for(intmax_t j = 0; j < count; ++j, ++k)
+        {
+            const auto l = kernel.offsets[k];
+            auto index = (intmax_t)x[k];
+            if((index >= 3) && (index < simd_stop))
+            {
+                const auto src = &samples[index - 3];
+                vecsum = vfmaq_f32(vecsum, vld1q_f32(src), vld1q_f32(&kernel.weights[l]));
+                vecsum = vfmaq_f32(vecsum, vld1q_f32(&src[4]), vld1q_f32(&kernel.weights[l + 4]));
+            }
+            else
+                edgesum += convolve_edge(samples, (intmax_t)sz, &kernel.weights[l], index - 3, 8);
+        }
+        output[i] = (horizontal_sum(vecsum) + edgesum) / count;
+    }
+}
+
+// specialized for kernel.size = 4, catmull-rom
+static void apply_interp_filter_neon_x4(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    assert(kernel.radius == 2);
+    const auto simd_stop = (intmax_t)sz - 2;
+    const auto xsz = x.size();
+    assert(output.size() >= xsz);
+    float tmp[4];
+    for(size_t i = 0; i < xsz; ++i)
+    {
+        const auto weights = point_weights(kernel, x, i, tmp);
+        auto index = (intmax_t)x[i];
+        if((index >= 1) && (index < simd_stop))
+            output[i] = horizontal_sum(vmulq_f32(vld1q_f32(&samples[index - 1]), vld1q_f32(weights)));
+        else
+            output[i] = convolve_edge(samples, (intmax_t)sz, weights, index - 1, 4);
+    }
+}
+
+// bar graph version
+// specialized for kernel.size = 4, catmull-rom
+static void apply_interp_filter_neon_x4(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    assert(kernel.radius == 2);
+    const auto simd_stop = (intmax_t)sz - 2;
+    const auto bands = (intmax_t)band_widths.size();
+    assert((intmax_t)output.size() >= bands);
+    float tmp[4];
+    for(intmax_t i = 0, k = 0; i < bands; ++i)
+    {
+        // points of a band share one fraction
+        const auto weights = point_weights(kernel, x, (size_t)k, tmp);
+        const auto vweights = vld1q_f32(weights);
+        auto vecsum = vdupq_n_f32(0.0f);
+        float edgesum = 0.0f;
+        auto count = (intmax_t)band_widths[i];
+        for(intmax_t j = 0; j < count; ++j, ++k)
+        {
+            auto index = (intmax_t)x[k];
+            if((index >= 1) && (index < simd_stop))
+                vecsum = vfmaq_f32(vecsum, vld1q_f32(&samples[index - 1]), vweights);
+            else
+                edgesum += convolve_edge(samples, (intmax_t)sz, weights, index - 1, 4);
+        }
+        output[i] = (horizontal_sum(vecsum) + edgesum) / count;
+    }
+}
+
+void apply_interp_filter_neon(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    if(kernel.size == 8)
+        return apply_interp_filter_neon_x8(samples, sz, x, kernel, output); // lanczos
+    else if(kernel.size == 4)
+        return apply_interp_filter_neon_x4(samples, sz, x, kernel, output); // catmull-rom
+    else
+        return apply_interp_filter(samples, sz, x, kernel, output); // fallback
+}
+
+void apply_interp_filter_neon(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    if(kernel.size == 8)
+        return apply_interp_filter_neon_x8(samples, sz, band_widths, x, kernel, output); // lanczos
+    else if(kernel.size == 4)
+        return apply_interp_filter_neon_x4(samples, sz, band_widths, x, kernel, output); // catmull-rom
+    else
+        return apply_interp_filter(samples, sz, band_widths, x, kernel, output); // fallback
+}
+
+// one dot product per band, most bands are a handful of weights
+void apply_filterbank_neon(const float *samples, const Filterbank<float>& bank, std::span<float> output)
+{
+    const auto bands = bank.start.size();
+    assert(output.size() >= bands);
+    constexpr auto step = sizeof(float32x4_t) / sizeof(float);
+    for(size_t i = 0; i < bands; ++i)
+    {
+        const auto src = &samples[bank.start[i]];
+        const auto w = &bank.weights[bank.offsets[i]];
+        const auto count = (size_t)bank.count[i];
+        const auto vecstop = count & ~(step - 1);
+        auto vecsum = vdupq_n_f32(0.0f);
+        size_t j = 0;
+        for(; j < vecstop; j += step)
+            vecsum = vfmaq_f32(vecsum, vld1q_f32(&src[j]), vld1q_f32(&w[j]));
+        auto sum = horizontal_sum(vecsum);
+        for(; j < count; ++j)
+            sum += src[j] * w[j];
+        output[i] = sum;
+    }
+}
+
+// 8 bands per pair of vectors, the sample loop runs inside so the state stays in registers
+void iir_bank_neon(const IIRFilterbank::Pass& pass)
+{
+    static_assert(IIRFilterbank::LANES % 8 == 0);
+    const auto lanes = pass.lanes;
+    const auto src = pass.src;
+    const auto count = pass.count;
+    auto state = pass.state + IIRFilterbank::LANES;
+    for(size_t i = 0; i < lanes; i += 8)
+    {
+        float32x4_t b0[2], a1[2], a2[2], c0[2], c1[2], c2[2], u1[2], u2[2], v1[2], v2[2], sum[2];
+        for(size_t j = 0; j < 2; ++j)
+        {
+            const auto k = i + (j * 4);
+            b0[j] = vld1q_f32(&pass.coefs[k]);
+            a1[j] = vld1q_f32(&pass.coefs[lanes + k]);
+            a2[j] = vld1q_f32(&pass.coefs[(2 * lanes) + k]);
+            c0[j] = vld1q_f32(&pass.coefs[(3 * lanes) + k]);
+            c1[j] = vld1q_f32(&pass.coefs[(4 * lanes) + k]);
+            c2[j] = vld1q_f32(&pass.coefs[(5 * lanes) + k]);
+            u1[j] = vld1q_f32(&state[k]);
+            u2[j] = vld1q_f32(&state[lanes + k]);
+            v1[j] = vld1q_f32(&state[(2 * lanes) + k]);
+            v2[j] = vld1q_f32(&state[(3 * lanes) + k]);
+            sum[j] = vdupq_n_f32(0.0f);
+        }
+        auto xm1 = pass.state[0];
+        auto xm2 = pass.state[1];
+        for(size_t n = 0; n < count; ++n)
+        {
+            const auto x = src[n];
+            const auto d = vdupq_n_f32(x - xm2);
+            xm2 = std::exchange(xm1, x);
+            for(size_t j = 0; j < 2; ++j)
+            {
+                const auto u = vfmsq_f32(vfmsq_f32(vmulq_f32(b0[j], d), a1[j], u1[j]), a2[j], u2[j]);
+                const auto v = vfmsq_f32(vfmsq_f32(vmulq_f32(c0[j], vsubq_f32(u, u2[j])), c1[j], v1[j]), c2[j], v2[j]);
+                u2[j] = std::exchange(u1[j], u);
+                v2[j] = std::exchange(v1[j], v);
+                sum[j] = vfmaq_f32(sum[j], v, v);
+            }
+        }
+        for(size_t j = 0; j < 2; ++j)
+        {
+            const auto k = i + (j * 4);
+            vst1q_f32(&state[k], u1[j]);
+            vst1q_f32(&state[lanes + k], u2[j]);
+            vst1q_f32(&state[(2 * lanes) + k], v1[j]);
+            vst1q_f32(&state[(3 * lanes) + k], v2[j]);
+            vst1q_f32(&pass.energy[k], vaddq_f32(vld1q_f32(&pass.energy[k]), sum[j]));
+        }
+    }
+    iir_bank_history(pass);
+}
+
+// each lane keeps its own first minimum and where it was, indices are exact in a float up to 2^24
+size_t map_db_heights_neon(float *values, size_t count, float ceiling, float range, float top, float bottom, float& miny)
+{
+    const auto vceiling = vdupq_n_f32(ceiling);
+    const auto vrange = vdupq_n_f32(range);
+    const auto vtop = vdupq_n_f32(top);
+    const auto vspan = vdupq_n_f32(bottom - top);
+    const auto zero = vdupq_n_f32(0.0f);
+    const auto none = vdupq_n_f32(std::numeric_limits<float>::max());
+    const float lanes[] = { 0.0f, 1.0f, 2.0f, 3.0f };
+    auto index = vld1q_f32(lanes);
+    auto vmin = none;
+    auto vpos = zero;
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        const auto t = vminq_f32(vmaxq_f32(vsubq_f32(vceiling, vld1q_f32(&values[i])), zero), vrange);
+        const auto val = vfmaq_f32(vtop, vspan, vdivq_f32(t, vrange));
+        vst1q_f32(&values[i], val);
+        const auto lower = vcltq_f32(val, vmin);
+        vmin = vbslq_f32(lower, val, vmin);
+        vpos = vbslq_f32(lower, index, vpos);
+        index = vaddq_f32(index, vdupq_n_f32(4.0f));
+    }
+
+    // smallest value, then the first index among the lanes holding it
+    miny = vminvq_f32(vmin);
+    auto minpos = (size_t)vminvq_f32(vbslq_f32(vceqq_f32(vmin, vdupq_n_f32(miny)), vpos, none));
+    for(; i < count; ++i)
+    {
+        const auto val = top + ((bottom - top) * (std::clamp(ceiling - values[i], 0.0f, range) / range));
+        if(val < miny)
+        {
+            miny = val;
+            minpos = i;
+        }
+        values[i] = val;
+    }
+    return minpos;
+}
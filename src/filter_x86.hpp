@@ -0,0 +1,462 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include "filter.hpp"
+#include "simd_helpers.hpp"
+#include "iir_filterbank.hpp"
+#include <immintrin.h>
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <utility>
+
+// kernel bodies shared by the x86 filter translation units, each instantiates them for its own
+// instruction set: FMA for filter_fma3.cpp, separate multiply and add for the AVX and SSE4.1 ones
+// the kernels outside of the __AVX__ section only use 128-bit vectors
+
+// a * b + c
+template<bool FMA>
+static WAV_FORCE_INLINE __m128 fmadd(__m128 a, __m128 b, __m128 c)
+{
+    if constexpr(FMA)
+        return _mm_fmadd_ps(a, b, c);
+    else
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+
+template<bool FMA>
+static WAV_FORCE_INLINE __m128 fmadd_ss(__m128 a, __m128 b, __m128 c)
+{
+    if constexpr(FMA)
+        return _mm_fmadd_ss(a, b, c);
+    else
+        return _mm_add_ss(_mm_mul_ss(a, b), c);
+}
+
+template<bool FMA>
+static float weighted_avg_x86(const float *samples, size_t sz, const Kernel<float>& kernel, intmax_t index)
+{
+    // NOTE: Initial tests with 'usuable' radius values seemed to reveal performance benefit for 128-bit vectors
+    // averaging 2-3 iterations vs 1 iteration of 256-bit, but this could use re-tesing and can definitely be done better in any case.
+    const auto start = (index - kernel.radius) + 1;
+    const auto stop = index + kernel.radius;
+    float sum = 0.0f;
+    if((start < 0) || (stop > (intmax_t)sz))
+    {
+        const auto loopstart = std::max(start, (intmax_t)0);
+        const auto loopstop = std::min(stop, (intmax_t)sz);
+        float wsum = 0.0f;
+        for(auto i = loopstart; i < loopstop; ++i)
+        {
+            auto weight = kernel.weights[i - start];
+            wsum += weight;
+            sum += samples[i] * weight;
+        }
+        return sum / wsum;
+    }
+    else
+    {
+        constexpr auto step = sizeof(__m128) / sizeof(float);
+        const auto ssestop = start + kernel.sse_size;
+        auto vecsum = _mm_setzero_ps();
+        auto i = start;
+        for(; i < ssestop; i += step)
+            vecsum = fmadd<FMA>(_mm_loadu_ps(&samples[i]), _mm_load_ps(&kernel.weights[i - start]), vecsum);
+        sum = horizontal_sum(vecsum);
+        for(; i < stop; ++i)
+            sum += samples[i] * kernel.weights[i - start];
+        return sum / kernel.sum;
+    }
+}
+
+template<bool FMA>
+static void apply_filter_x86(const float *samples, size_t sz, const Kernel<float>& kernel, std::span<float> output)
+{
+    assert(output.size() >= sz);
+    if((size_t)kernel.sse_size >= ((sizeof(__m128) / sizeof(float)) * 2)) // make sure we get at least 2 SIMD iterations
+    {
+        for(auto i = 0u; i < sz; ++i)
+            output[i] = weighted_avg_x86<FMA>(samples, sz, kernel, i);
+    }
+    else // otherwise use the plain C version
+    {
+        for(auto i = 0u; i < sz; ++i)
+            output[i] = weighted_avg(samples, sz, kernel, i);
+    }
+}
+
+// one dot product per band, most bands are a handful of weights so 128-bit vectors cover them
+template<bool FMA>
+static void apply_filterbank_x86(const float *samples, const Filterbank<float>& bank, std::span<float> output)
+{
+    const auto bands = bank.start.size();
+    assert(output.size() >= bands);
+    constexpr auto step = sizeof(__m128) / sizeof(float);
+    for(size_t i = 0; i < bands; ++i)
+    {
+        const auto src = &samples[bank.start[i]];
+        const auto w = &bank.weights[bank.offsets[i]];
+        const auto count = (size_t)bank.count[i];
+        const auto vecstop = count & ~(step - 1);
+        auto vecsum = _mm_setzero_ps();
+        size_t j = 0;
+        for(; j < vecstop; j += step)
+            vecsum = fmadd<FMA>(_mm_loadu_ps(&src[j]), _mm_loadu_ps(&w[j]), vecsum);
+        auto sum = horizontal_sum(vecsum);
+        for(; j < count; ++j)
+            sum += src[j] * w[j];
+        output[i] = sum;
+    }
+}
+
+#ifdef __AVX__
+
+// a * b + c
+template<bool FMA>
+static WAV_FORCE_INLINE __m256 fmadd(__m256 a, __m256 b, __m256 c)
+{
+    if constexpr(FMA)
+        return _mm256_fmadd_ps(a, b, c);
+    else
+        return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+}
+
+// a * b - c
+template<bool FMA>
+static WAV_FORCE_INLINE __m256 fmsub(__m256 a, __m256 b, __m256 c)
+{
+    if constexpr(FMA)
+        return _mm256_fmsub_ps(a, b, c);
+    else
+        return _mm256_sub_ps(_mm256_mul_ps(a, b), c);
+}
+
+// c - a * b
+template<bool FMA>
+static WAV_FORCE_INLINE __m256 fnmadd(__m256 a, __m256 b, __m256 c)
+{
+    if constexpr(FMA)
+        return _mm256_fnmadd_ps(a, b, c);
+    else
+        return _mm256_sub_ps(c, _mm256_mul_ps(a, b));
+}
+
+// lane i of the result is the sum of all lanes of v[i] for the x8 kernel,
+// for the x4 kernel each v[i] holds point i in the low half and point i + 4 in the high half
+static WAV_FORCE_INLINE __m256 horizontal_sum8(const __m256 v[8])
+{
+    const auto a = _mm256_hadd_ps(_mm256_hadd_ps(v[0], v[1]), _mm256_hadd_ps(v[2], v[3]));
+    const auto b = _mm256_hadd_ps(_mm256_hadd_ps(v[4], v[5]), _mm256_hadd_ps(v[6], v[7]));
+    return _mm256_add_ps(_mm256_permute2f128_ps(a, b, 0x20), _mm256_permute2f128_ps(a, b, 0x31));
+}
+
+static WAV_FORCE_INLINE __m256 horizontal_sum4(const __m256 v[4])
+{
+    return _mm256_hadd_ps(_mm256_hadd_ps(v[0], v[1]), _mm256_hadd_ps(v[2], v[3]));
+}
+
+// edge of the input, only the samples inside [0, sz) contribute
+template<bool FMA>
+static WAV_FORCE_INLINE float convolve_edge(const float *samples, intmax_t sz, const float *weights, intmax_t start, intmax_t size)
+{
+    // this could be done better with asm, but this'll just have to do
+    auto sum = _mm_setzero_ps();
+    const auto stop = std::min(start + size, sz);
+    for(auto k = std::max(start, (intmax_t)0); k < stop; ++k)
+        sum = fmadd_ss<FMA>(_mm_load_ss(&samples[k]), _mm_load_ss(&weights[k - start]), sum);
+    return _mm_cvtss_f32(sum);
+}
+
+// only the points outside of the kernel's interior range take the bounds checked path
+// interior blocks of 8 points reduce together instead of one horizontal sum per point
+// output must be 32-byte aligned (AlignedBuffer), blocks start on a multiple of 8 points for aligned stores
+
+// specialized for kernel.size = 8
+template<bool FMA>
+static void apply_interp_filter_x86_x8(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    assert(kernel.radius == 4);
+    const auto xsz = x.size();
+    assert(output.size() >= xsz);
+    assert(((uintptr_t)output.data() % sizeof(__m256)) == 0);
+    const auto [begin, end] = get_interior(kernel, x, sz);
+    for(size_t i = 0; i < begin; ++i)
+        output[i] = convolve_edge<FMA>(samples, (intmax_t)sz, &kernel.weights[kernel.offsets[i]], (intmax_t)x[i] - 3, 8);
+
+    const auto point = [&](size_t i) {
+        return horizontal_sum(_mm256_mul_ps(_mm256_loadu_ps(&samples[(intmax_t)x[i] - 3]), _mm256_load_ps(&kernel.weights[kernel.offsets[i]])));
+    };
+    auto i = begin;
+    for(; (i < end) && ((i % 8) != 0); ++i)
+        output[i] = point(i);
+    for(; i + 8 <= end; i += 8)
+    {
+        __m256 prod[8];
+        for(auto k = 0; k < 8; ++k)
+            prod[k] = _mm256_mul_ps(_mm256_loadu_ps(&samples[(intmax_t)x[i + k] - 3]), _mm256_load_ps(&kernel.weights[kernel.offsets[i + k]]));
+        _mm256_store_ps(&output[i], horizontal_sum8(prod));
+    }
+    for(; i < end; ++i)
+        output[i] = point(i);
+
+    for(i = end; i < xsz; ++i)
+        output[i] = convolve_edge<FMA>(samples, (intmax_t)sz, &kernel.weights[kernel.offsets[i]], (intmax_t)x[i] - 3, 8);
+}
+
+// bar graph version
+// specialized for kernel.size = 8
+template<bool FMA>
+static void apply_interp_filter_x86_x8(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    assert(kernel.radius == 4);
+    const auto bands = band_widths.size();
+    assert(output.size() >= bands);
+    const auto [begin, end] = get_interior(kernel, x, sz);
+    for(size_t i = 0, k = 0; i < bands; ++i)
+    {
+        auto vecsum = _mm256_setzero_ps();
+        auto edgesum = 0.0f;
+        const auto count = (size_t)band_widths[i];
+        for(size_t j = 0; j < count; ++j, ++k)
+        {
+            const auto l = kernel.offsets[k];
+            const auto index = (intmax_t)x[k];
+            if((k >= begin) && (k < end))
+                vecsum = fmadd<FMA>(_mm256_loadu_ps(&samples[index - 3]), _mm256_load_ps(&kernel.weights[l]), vecsum);
+            else
+                edgesum += convolve_edge<FMA>(samples, (intmax_t)sz, &kernel.weights[l], index - 3, 8);
+        }
+        output[i] = (horizontal_sum(vecsum) + edgesum) / count;
+    }
+}
+
+// catmull-rom weights of 8 points, w[j] holds weight j of each point
+template<bool FMA>
+static WAV_FORCE_INLINE void catrom_weights8(__m256 x, float t, __m256 w[4])
+{
+    const auto u = _mm256_sub_ps(x, _mm256_round_ps(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+    const auto u2 = _mm256_mul_ps(u, u);
+    const auto vt = _mm256_set1_ps(t);
+    w[0] = _mm256_mul_ps(u, fmsub<FMA>(u, fnmadd<FMA>(vt, u, _mm256_set1_ps(2.0f * t)), vt));
+    w[1] = fmadd<FMA>(u2, fmadd<FMA>(_mm256_set1_ps(2.0f - t), u, _mm256_set1_ps(t - 3.0f)), _mm256_set1_ps(1.0f));
+    w[2] = _mm256_mul_ps(u, fmadd<FMA>(u, fmadd<FMA>(_mm256_set1_ps(t - 2.0f), u, _mm256_set1_ps(3.0f - (2.0f * t))), vt));
+    w[3] = _mm256_mul_ps(_mm256_mul_ps(u2, vt), _mm256_sub_ps(u, _mm256_set1_ps(1.0f)));
+}
+
+// specialized for kernel.size = 4, catmull-rom
+template<bool FMA>
+static void apply_interp_filter_x86_x4(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    assert(kernel.radius == 2);
+    assert(kernel.catrom);
+    const auto xsz = x.size();
+    assert(output.size() >= xsz);
+    assert(((uintptr_t)output.data() % sizeof(__m256)) == 0);
+    const auto [begin, end] = get_interior(kernel, x, sz);
+    alignas(16) float tmp[4];
+    for(size_t i = 0; i < begin; ++i)
+        output[i] = convolve_edge<FMA>(samples, (intmax_t)sz, point_weights(kernel, x, i, tmp), (intmax_t)x[i] - 1, 4);
+
+    const auto point = [&](size_t i) {
+        return horizontal_sum(_mm_mul_ps(_mm_loadu_ps(&samples[(intmax_t)x[i] - 1]), _mm_load_ps(point_weights(kernel, x, i, tmp))));
+    };
+    auto i = begin;
+    for(; (i < end) && ((i % 8) != 0); ++i)
+        output[i] = point(i);
+    for(; i + 8 <= end; i += 8)
+    {
+        // weights are computed across points, transposing within each 128-bit lane
+        // leaves point k in the low half and point k + 4 in the high half
+        __m256 w[4];
+        catrom_weights8<FMA>(_mm256_loadu_ps(&x[i]), kernel.tension, w);
+        const auto t0 = _mm256_unpacklo_ps(w[0], w[1]);
+        const auto t1 = _mm256_unpackhi_ps(w[0], w[1]);
+        const auto t2 = _mm256_unpacklo_ps(w[2], w[3]);
+        const auto t3 = _mm256_unpackhi_ps(w[2], w[3]);
+        const __m256 weights[4] = {
+            _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)),
+            _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)),
+            _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)),
+            _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2))
+        };
+
+        __m256 prod[4];
+        for(auto k = 0; k < 4; ++k)
+        {
+            const auto lo = _mm_loadu_ps(&samples[(intmax_t)x[i + k] - 1]);
+            const auto hi = _mm_loadu_ps(&samples[(intmax_t)x[i + k + 4] - 1]);
+            prod[k] = _mm256_mul_ps(_mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1), weights[k]);
+        }
+        _mm256_store_ps(&output[i], horizontal_sum4(prod));
+    }
+    for(; i < end; ++i)
+        output[i] = point(i);
+
+    for(i = end; i < xsz; ++i)
+        output[i] = convolve_edge<FMA>(samples, (intmax_t)sz, point_weights(kernel, x, i, tmp), (intmax_t)x[i] - 1, 4);
+}
+
+// bar graph version
+// specialized for kernel.size = 4, catmull-rom
+// points of a band share one fraction, so its weights are found once
+template<bool FMA>
+static void apply_interp_filter_x86_x4(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    assert(kernel.radius == 2);
+    const auto bands = band_widths.size();
+    assert(output.size() >= bands);
+    const auto [begin, end] = get_interior(kernel, x, sz);
+    alignas(16) float tmp[4];
+    for(size_t i = 0, k = 0; i < bands; ++i)
+    {
+        const auto count = (size_t)band_widths[i];
+        const auto weights = point_weights(kernel, x, k, tmp);
+        const auto vweights = _mm_load_ps(weights);
+        auto vecsum = _mm_setzero_ps();
+        auto edgesum = 0.0f;
+        for(size_t j = 0; j < count; ++j, ++k)
+        {
+            const auto index = (intmax_t)x[k];
+            if((k >= begin) && (k < end))
+                vecsum = fmadd<FMA>(_mm_loadu_ps(&samples[index - 1]), vweights, vecsum);
+            else
+                edgesum += convolve_edge<FMA>(samples, (intmax_t)sz, weights, index - 1, 4);
+        }
+        output[i] = (horizontal_sum(vecsum) + edgesum) / count;
+    }
+}
+
+template<bool FMA>
+static void apply_interp_filter_x86(const float *samples, size_t sz, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    if(kernel.size == 8)
+        return apply_interp_filter_x86_x8<FMA>(samples, sz, x, kernel, output); // lanczos
+    else if(kernel.size == 4)
+        return apply_interp_filter_x86_x4<FMA>(samples, sz, x, kernel, output); // catmull-rom
+    else
+        return apply_interp_filter(samples, sz, x, kernel, output); // fallback
+}
+
+template<bool FMA>
+static void apply_interp_filter_x86(const float *samples, size_t sz, const std::vector<int>& band_widths, const std::vector<float>& x, const Kernel<float>& kernel, std::span<float> output)
+{
+    if(kernel.size == 8)
+        return apply_interp_filter_x86_x8<FMA>(samples, sz, band_widths, x, kernel, output); // lanczos
+    else if(kernel.size == 4)
+        return apply_interp_filter_x86_x4<FMA>(samples, sz, band_widths, x, kernel, output); // catmull-rom
+    else
+        return apply_interp_filter(samples, sz, band_widths, x, kernel, output); // fallback
+}
+
+// 8 bands per vector, the sample loop runs inside so the state stays in registers
+template<bool FMA>
+static void iir_bank_x86(const IIRFilterbank::Pass& pass)
+{
+    static_assert(IIRFilterbank::LANES % 8 == 0);
+    const auto lanes = pass.lanes;
+    const auto src = pass.src;
+    const auto count = pass.count;
+    auto state = pass.state + IIRFilterbank::LANES;
+    for(size_t i = 0; i < lanes; i += 8)
+    {
+        const auto b0 = _mm256_load_ps(&pass.coefs[i]);
+        const auto a1 = _mm256_load_ps(&pass.coefs[lanes + i]);
+        const auto a2 = _mm256_load_ps(&pass.coefs[(2 * lanes) + i]);
+        const auto c0 = _mm256_load_ps(&pass.coefs[(3 * lanes) + i]);
+        const auto c1 = _mm256_load_ps(&pass.coefs[(4 * lanes) + i]);
+        const auto c2 = _mm256_load_ps(&pass.coefs[(5 * lanes) + i]);
+        auto u1 = _mm256_load_ps(&state[i]);
+        auto u2 = _mm256_load_ps(&state[lanes + i]);
+        auto v1 = _mm256_load_ps(&state[(2 * lanes) + i]);
+        auto v2 = _mm256_load_ps(&state[(3 * lanes) + i]);
+        auto sum = _mm256_setzero_ps();
+        auto xm1 = pass.state[0];
+        auto xm2 = pass.state[1];
+        for(size_t n = 0; n < count; ++n)
+        {
+            const auto x = src[n];
+            const auto d = _mm256_set1_ps(x - xm2);
+            xm2 = std::exchange(xm1, x);
+            const auto u = fnmadd<FMA>(a2, u2, fnmadd<FMA>(a1, u1, _mm256_mul_ps(b0, d)));
+            const auto v = fnmadd<FMA>(c2, v2, fnmadd<FMA>(c1, v1, _mm256_mul_ps(c0, _mm256_sub_ps(u, u2))));
+            u2 = std::exchange(u1, u);
+            v2 = std::exchange(v1, v);
+            sum = fmadd<FMA>(v, v, sum);
+        }
+        _mm256_store_ps(&state[i], u1);
+        _mm256_store_ps(&state[lanes + i], u2);
+        _mm256_store_ps(&state[(2 * lanes) + i], v1);
+        _mm256_store_ps(&state[(3 * lanes) + i], v2);
+        _mm256_store_ps(&pass.energy[i], _mm256_add_ps(_mm256_load_ps(&pass.energy[i]), sum));
+    }
+    iir_bank_history(pass);
+}
+
+// smallest lane in every lane
+static WAV_FORCE_INLINE __m256 broadcast_min(__m256 v)
+{
+    v = _mm256_min_ps(v, _mm256_permute2f128_ps(v, v, 1));
+    v = _mm256_min_ps(v, _mm256_permute_ps(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm256_min_ps(v, _mm256_permute_ps(v, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+// each lane keeps its own first minimum and where it was, indices are exact in a float up to 2^24
+template<bool FMA>
+static size_t map_db_heights_x86(float *values, size_t count, float ceiling, float range, float top, float bottom, float& miny)
+{
+    const auto vceiling = _mm256_set1_ps(ceiling);
+    const auto vrange = _mm256_set1_ps(range);
+    const auto vtop = _mm256_set1_ps(top);
+    const auto vspan = _mm256_set1_ps(bottom - top);
+    const auto zero = _mm256_setzero_ps();
+    const auto none = _mm256_set1_ps(std::numeric_limits<float>::max());
+    const auto step = _mm256_set1_ps(8.0f);
+    auto index = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    auto vmin = none;
+    auto vpos = zero;
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+        const auto t = _mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(vceiling, _mm256_loadu_ps(&values[i])), zero), vrange);
+        const auto val = fmadd<FMA>(vspan, _mm256_div_ps(t, vrange), vtop);
+        _mm256_storeu_ps(&values[i], val);
+        const auto lower = _mm256_cmp_ps(val, vmin, _CMP_LT_OQ);
+        vmin = _mm256_blendv_ps(vmin, val, lower);
+        vpos = _mm256_blendv_ps(vpos, index, lower);
+        index = _mm256_add_ps(index, step);
+    }
+
+    // smallest value, then the first index among the lanes holding it
+    const auto low = broadcast_min(vmin);
+    const auto first = broadcast_min(_mm256_blendv_ps(none, vpos, _mm256_cmp_ps(vmin, low, _CMP_EQ_OQ)));
+    miny = _mm256_cvtss_f32(low);
+    auto minpos = (size_t)_mm256_cvtss_f32(first);
+    for(; i < count; ++i)
+    {
+        const auto val = top + ((bottom - top) * (std::clamp(ceiling - values[i], 0.0f, range) / range));
+        if(val < miny)
+        {
+            miny = val;
+            minpos = i;
+        }
+        values[i] = val;
+    }
+    return minpos;
+}
+
+#endif // __AVX__
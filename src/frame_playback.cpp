@@ -0,0 +1,239 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "frame_playback.hpp"
+#include "waveform_config.hpp"
+#include "log.hpp"
+#include <util/platform.h>
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#ifdef ENABLE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace
+{
+    // see frame_recorder.hpp for the layout
+    constexpr char FILE_MAGIC[8] = { 'W', 'A', 'V', 'E', 'R', 'E', 'C', '1' };
+    constexpr uint32_t FILE_VERSION = 1;
+    constexpr uint32_t BLOCK_MAGIC = 0x4b4c4257; // "WBLK"
+    constexpr uint8_t FLAG_KEY = 1;
+    constexpr uint32_t MAX_BLOCK_BYTES = 1u << 28; // a corrupt size shouldn't allocate the world
+    constexpr size_t FRAME_HEADER_BYTES = 24;
+
+    template<typename T>
+    T get(const uint8_t *src)
+    {
+        T value;
+        std::memcpy(&value, src, sizeof(T));
+        return value;
+    }
+
+    struct FileCloser
+    {
+        void operator()(std::FILE *file) const { std::fclose(file); }
+    };
+}
+
+float FramePlayback::from_half(uint16_t value) noexcept
+{
+    const auto sign = (uint32_t)(value & 0x8000) << 16;
+    const auto exp = (value >> 10) & 0x1f;
+    auto mant = (uint32_t)(value & 0x3ff);
+    if(exp == 0x1f)
+        return std::bit_cast<float>(sign | 0x7f800000 | (mant << 13));
+    if(exp != 0)
+        return std::bit_cast<float>(sign | ((uint32_t)(exp + 127 - 15) << 23) | (mant << 13));
+    if(mant == 0)
+        return std::bit_cast<float>(sign);
+    // subnormal, normalize into a float
+    auto e = 127 - 15 + 1;
+    while((mant & 0x400) == 0)
+    {
+        mant <<= 1;
+        --e;
+    }
+    return std::bit_cast<float>(sign | ((uint32_t)e << 23) | ((mant & 0x3ff) << 13));
+}
+
+void FramePlayback::open(const std::string& path)
+{
+    close();
+    if(path.empty())
+        return;
+    m_path = path;
+    m_stop.store(false, std::memory_order_relaxed);
+    m_thread = std::thread(&FramePlayback::load, this);
+}
+
+void FramePlayback::close()
+{
+    if(m_thread.joinable())
+    {
+        m_stop.store(true, std::memory_order_relaxed);
+        m_thread.join();
+    }
+    m_ready.store(false, std::memory_order_relaxed);
+    m_path.clear();
+    m_entries.clear();
+    m_values.clear();
+    m_hz.clear();
+    m_first_ts = 0;
+}
+
+uint64_t FramePlayback::duration() const noexcept
+{
+    if(!ready() || m_entries.empty())
+        return 0;
+    return m_entries.back().time;
+}
+
+bool FramePlayback::find(uint64_t time, Frame& frame) const
+{
+    if(!ready() || m_entries.empty())
+        return false;
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), time, [](uint64_t t, const Entry& e) { return t < e.time; });
+    if(it != m_entries.begin())
+        --it;
+    frame.index = (size_t)(it - m_entries.begin());
+    frame.time = it->time;
+    frame.audio_ts = it->audio_ts;
+    frame.channels = it->channels;
+    frame.count = it->count;
+    frame.values = &m_values[it->values];
+    frame.hz = &m_hz[it->hz];
+    return true;
+}
+
+void FramePlayback::load()
+{
+    std::unique_ptr<std::FILE, FileCloser> file(os_fopen(m_path.c_str(), "rb"));
+    if(!file)
+    {
+        LogWarn << "Could not open recording \"" << m_path << "\"";
+        return;
+    }
+    char magic[sizeof(FILE_MAGIC)];
+    uint32_t header[2];
+    if((std::fread(magic, sizeof(magic), 1, file.get()) != 1) || (std::fread(header, sizeof(header), 1, file.get()) != 1)
+        || (std::memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0) || (header[0] != FILE_VERSION))
+    {
+        LogWarn << "\"" << m_path << "\" is not a waveform recording";
+        return;
+    }
+
+    const auto start = os_gettime_ns();
+    std::vector<uint8_t> stored, block;
+    uint32_t block_header[5];
+    while(!m_stop.load(std::memory_order_relaxed) && (std::fread(block_header, sizeof(block_header), 1, file.get()) == 1))
+    {
+        const auto [magic_word, codec, frames, raw_bytes, stored_bytes] = block_header;
+        if((magic_word != BLOCK_MAGIC) || (raw_bytes > MAX_BLOCK_BYTES) || (stored_bytes > MAX_BLOCK_BYTES))
+        {
+            LogWarn << "Recording \"" << m_path << "\" is damaged, playing what came before";
+            break;
+        }
+        stored.resize(stored_bytes);
+        if((stored_bytes > 0) && (std::fread(stored.data(), stored_bytes, 1, file.get()) != 1))
+            break; // cut short, likely still being written
+        if(codec == 0)
+            block.swap(stored);
+#ifdef ENABLE_ZSTD
+        else if(codec == 1)
+        {
+            block.resize(raw_bytes);
+            const auto size = ZSTD_decompress(block.data(), block.size(), stored.data(), stored.size());
+            if(ZSTD_isError(size) || (size != raw_bytes))
+            {
+                LogWarn << "Recording \"" << m_path << "\" is damaged, playing what came before";
+                break;
+            }
+        }
+#endif
+        else
+        {
+            LogWarn << "Recording \"" << m_path << "\" is compressed and this build has no zstd";
+            break;
+        }
+        if(!decode(block, frames))
+        {
+            LogWarn << "Recording \"" << m_path << "\" is damaged, playing what came before";
+            break;
+        }
+    }
+    if(m_stop.load(std::memory_order_relaxed))
+        return;
+
+    const auto length = m_entries.empty() ? 0 : m_entries.back().time;
+    LogInfo << "Loaded " << m_entries.size() << " frames of \"" << m_path << "\", " << ((double)length / 1e9)
+        << " s in " << ((double)(os_gettime_ns() - start) / 1e6) << " ms";
+    m_ready.store(true, std::memory_order_release);
+}
+
+bool FramePlayback::decode(const std::vector<uint8_t>& block, uint32_t frames)
+{
+    size_t pos = 0;
+    size_t prev = 0;    // values of the previous frame in m_values
+    size_t hz = 0;
+    auto have_prev = false;
+    for(auto i = 0u; i < frames; ++i)
+    {
+        if(block.size() - pos < FRAME_HEADER_BYTES)
+            return false;
+        const auto src = &block[pos];
+        const auto frame_ts = get<uint64_t>(src);
+        const auto audio_ts = get<uint64_t>(src + 8);
+        const auto count = get<uint32_t>(src + 16);
+        const uint32_t channels = src[20];
+        const auto key = (src[21] & FLAG_KEY) != 0;
+        pos += FRAME_HEADER_BYTES;
+        const auto values = (size_t)channels * count;
+        if(((channels < 1) || (channels > 2) || (count == 0)) || (!key && (!have_prev || (m_entries.back().count != count) || (m_entries.back().channels != channels))))
+            return false;
+        if(key)
+        {
+            if(block.size() - pos < count * sizeof(float))
+                return false;
+            hz = m_hz.size();
+            m_hz.resize(hz + count);
+            std::memcpy(&m_hz[hz], &block[pos], count * sizeof(float));
+            pos += count * sizeof(float);
+        }
+        if(block.size() - pos < values * sizeof(uint16_t))
+            return false;
+
+        if(m_entries.empty() && (i == 0))
+            m_first_ts = frame_ts;
+        const auto offset = m_values.size();
+        m_values.resize(offset + values);
+        for(size_t j = 0; j < values; ++j)
+        {
+            const auto delta = get<uint16_t>(&block[pos + (j * sizeof(uint16_t))]);
+            m_values[offset + j] = key ? delta : (uint16_t)(m_values[prev + j] + delta);
+        }
+        pos += values * sizeof(uint16_t);
+        const auto time = (frame_ts > m_first_ts) ? frame_ts - m_first_ts : 0;
+        m_entries.push_back({ std::max(time, m_entries.empty() ? 0 : m_entries.back().time), audio_ts, channels, count, offset, hz });
+        prev = offset;
+        have_prev = true;
+    }
+    return true;
+}
@@ -0,0 +1,85 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Reads a FrameRecorder file back for display in place of live analysis.
+// A background thread decodes the whole file into memory as fast as it can, kept as fp16 (64 stereo
+// bars at 60 fps take about a megabyte a minute), then find() indexes it from any thread without locking.
+// Frame times count from the first frame of the recording.
+class FramePlayback
+{
+public:
+    struct Frame
+    {
+        size_t index = 0;
+        uint64_t time = 0;          // ns from the first frame
+        uint64_t audio_ts = 0;      // as recorded
+        uint32_t channels = 0;
+        size_t count = 0;
+        const uint16_t *values = nullptr;   // channels * count fp16 dBFS
+        const float *hz = nullptr;          // count frequencies
+    };
+
+    FramePlayback() = default;
+    ~FramePlayback() { close(); }
+    FramePlayback(const FramePlayback&) = delete;
+    FramePlayback& operator=(const FramePlayback&) = delete;
+
+    // start loading path, replacing the current file, failures are logged by the loader
+    void open(const std::string& path);
+    void close();
+    bool is_open() const noexcept { return !m_path.empty(); }
+    const std::string& path() const noexcept { return m_path; }
+    bool ready() const noexcept { return m_ready.load(std::memory_order_acquire); }
+
+    uint64_t duration() const noexcept;             // ns from the first to the last frame, 0 until ready()
+    bool find(uint64_t time, Frame& frame) const;   // last frame at or before time, false until ready() or if empty
+
+    static float from_half(uint16_t value) noexcept;
+
+private:
+    struct Entry
+    {
+        uint64_t time;
+        uint64_t audio_ts;
+        uint32_t channels;
+        uint32_t count;
+        size_t values;  // into m_values
+        size_t hz;      // into m_hz
+    };
+
+    void load();                                    // loader thread
+    bool decode(const std::vector<uint8_t>& block, uint32_t frames);
+
+    std::string m_path;
+    std::thread m_thread;
+    std::atomic<bool> m_stop = false;
+    std::atomic<bool> m_ready = false;              // the rest is only touched by the loader until set
+
+    std::vector<Entry> m_entries;
+    std::vector<uint16_t> m_values;
+    std::vector<float> m_hz;
+    uint64_t m_first_ts = 0;
+};
@@ -0,0 +1,289 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "frame_recorder.hpp"
+#include "waveform_config.hpp"
+#include "log.hpp"
+#include <util/platform.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#ifdef ENABLE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace
+{
+    constexpr char FILE_MAGIC[8] = { 'W', 'A', 'V', 'E', 'R', 'E', 'C', '1' };
+    constexpr uint32_t FILE_VERSION = 1;
+    constexpr uint32_t BLOCK_MAGIC = 0x4b4c4257; // "WBLK"
+    constexpr uint8_t FLAG_KEY = 1;
+
+    enum Codec : uint32_t
+    {
+        RAW = 0,
+        ZSTD = 1
+    };
+
+    // the format is little endian, so are all the targets
+    static_assert(std::endian::native == std::endian::little);
+
+    template<typename T>
+    void put(std::vector<uint8_t>& out, const T& value)
+    {
+        const auto pos = out.size();
+        out.resize(pos + sizeof(T));
+        std::memcpy(&out[pos], &value, sizeof(T));
+    }
+}
+
+// round to nearest even, overflow saturates to infinity and NaN stays NaN
+uint16_t FrameRecorder::to_half(float value) noexcept
+{
+    const auto bits = std::bit_cast<uint32_t>(value);
+    const auto sign = (uint16_t)((bits >> 16) & 0x8000);
+    const auto exp = (int)((bits >> 23) & 0xff);
+    auto mant = bits & 0x7fffff;
+    if(exp == 0xff)
+        return sign | 0x7c00 | (mant ? 0x200 : 0);
+    const auto e = exp - 127 + 15;
+    if(e >= 31)
+        return sign | 0x7c00;
+    if(e <= 0)
+    {
+        if(e < -10)
+            return sign;
+        mant |= 0x800000;
+        const auto shift = (uint32_t)(14 - e);
+        auto half = mant >> shift;
+        const auto rem = mant & ((1u << shift) - 1);
+        const auto mid = 1u << (shift - 1);
+        if((rem > mid) || ((rem == mid) && (half & 1)))
+            ++half;
+        return sign | (uint16_t)half;
+    }
+    auto half = (uint32_t)(e << 10) | (mant >> 13);
+    const auto rem = mant & 0x1fff;
+    if((rem > 0x1000) || ((rem == 0x1000) && (half & 1)))
+        ++half; // may carry into the exponent, up to infinity
+    return sign | (uint16_t)half;
+}
+
+bool FrameRecorder::open(const std::string& path)
+{
+    close();
+    if(path.empty())
+        return false;
+    auto file = os_fopen(path.c_str(), "wb");
+    if(file == nullptr)
+    {
+        LogWarn << "Could not create recording \"" << path << "\"";
+        return false;
+    }
+    const uint32_t header[] = { FILE_VERSION, 0 };
+    if((std::fwrite(FILE_MAGIC, sizeof(FILE_MAGIC), 1, file) != 1) || (std::fwrite(header, sizeof(header), 1, file) != 1))
+    {
+        LogWarn << "Could not write recording \"" << path << "\"";
+        std::fclose(file);
+        return false;
+    }
+
+    m_file = file;
+    m_path = path;
+    m_stop = false;
+    m_dropped = 0;
+    m_last_hz.clear();
+    m_last_channels = 0;
+    m_block.clear();
+    m_prev.clear();
+    m_hz.clear();
+    m_block_frames = 0;
+    m_key = true;
+    m_failed = false;
+    m_thread = std::thread(&FrameRecorder::writer, this);
+#ifndef ENABLE_ZSTD
+    LogInfo << "Recording \"" << path << "\" uncompressed, built without zstd";
+#endif
+    return true;
+}
+
+void FrameRecorder::close()
+{
+    if(m_file == nullptr)
+        return;
+    {
+        std::lock_guard lock(m_mtx);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+    std::fclose(m_file);
+    m_file = nullptr;
+    if(m_dropped > 0)
+        LogWarn << "Recording \"" << m_path << "\" dropped " << m_dropped << " frames, the disk couldn't keep up";
+    m_path.clear();
+    m_queue.clear();
+    m_free.clear();
+}
+
+void FrameRecorder::push(const Frame& frame)
+{
+    if((m_file == nullptr) || (frame.count == 0) || (frame.channels == 0))
+        return;
+
+    // converted here so the writer never reads the caller's buffers
+    Record record;
+    {
+        std::lock_guard lock(m_mtx);
+        if(m_queue.size() >= MAX_QUEUE)
+        {
+            ++m_dropped;
+            return;
+        }
+        if(!m_free.empty())
+        {
+            record = std::move(m_free.back());
+            m_free.pop_back();
+        }
+    }
+    record.frame_ts = frame.frame_ts;
+    record.audio_ts = frame.audio_ts;
+    record.channels = frame.channels;
+    record.count = frame.count;
+    record.values.resize(frame.channels * frame.count);
+    for(auto channel = 0u; channel < frame.channels; ++channel)
+    {
+        const auto src = frame.values[channel] ? frame.values[channel] : frame.values[0];
+        auto dst = &record.values[channel * frame.count];
+        for(size_t i = 0; i < frame.count; ++i)
+            dst[i] = to_half(src[i]);
+    }
+    const auto same = (frame.channels == m_last_channels) && (m_last_hz.size() == frame.count)
+        && ((frame.hz == nullptr) ? std::all_of(m_last_hz.begin(), m_last_hz.end(), [](float f) { return f == 0.0f; })
+            : std::equal(m_last_hz.begin(), m_last_hz.end(), frame.hz));
+    record.layout = !same;
+    if(record.layout)
+    {
+        if(frame.hz != nullptr)
+            m_last_hz.assign(frame.hz, frame.hz + frame.count);
+        else
+            m_last_hz.assign(frame.count, 0.0f);
+        m_last_channels = frame.channels;
+        record.hz = m_last_hz;
+    }
+
+    {
+        std::lock_guard lock(m_mtx);
+        m_queue.push_back(std::move(record));
+    }
+    m_cv.notify_one();
+}
+
+void FrameRecorder::writer()
+{
+    std::unique_lock lock(m_mtx);
+    while(true)
+    {
+        m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+        if(m_queue.empty())
+            break; // stopping with everything written
+        auto record = std::move(m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+
+        encode(record);
+        if(m_block.size() >= BLOCK_BYTES)
+            flush_block();
+
+        lock.lock();
+        m_free.push_back(std::move(record));
+    }
+    lock.unlock();
+    flush_block();
+    if(!m_failed)
+        std::fflush(m_file);
+}
+
+void FrameRecorder::encode(const Record& record)
+{
+    if(m_failed)
+        return;
+    if(record.layout)
+    {
+        m_hz = record.hz;
+        m_key = true;
+    }
+    const auto key = m_key || (m_prev.size() != record.values.size());
+    put(m_block, record.frame_ts);
+    put(m_block, record.audio_ts);
+    put(m_block, (uint32_t)record.count);
+    put(m_block, (uint8_t)record.channels);
+    put(m_block, (uint8_t)(key ? FLAG_KEY : 0));
+    put(m_block, (uint16_t)0);
+    if(key)
+    {
+        m_hz.resize(record.count);
+        const auto pos = m_block.size();
+        m_block.resize(pos + (m_hz.size() * sizeof(float)));
+        std::memcpy(&m_block[pos], m_hz.data(), m_hz.size() * sizeof(float));
+        m_prev.assign(record.values.size(), 0);
+    }
+
+    // frame to frame differences are mostly tiny, which is what makes the blocks compress
+    const auto pos = m_block.size();
+    m_block.resize(pos + (record.values.size() * sizeof(uint16_t)));
+    auto dst = &m_block[pos];
+    for(size_t i = 0; i < record.values.size(); ++i)
+    {
+        const auto delta = (uint16_t)(record.values[i] - m_prev[i]);
+        std::memcpy(dst + (i * sizeof(uint16_t)), &delta, sizeof(uint16_t));
+    }
+    m_prev = record.values;
+    m_key = false;
+    ++m_block_frames;
+}
+
+void FrameRecorder::flush_block()
+{
+    if(m_block.empty() || m_failed)
+        return;
+
+    auto codec = RAW;
+    const uint8_t *payload = m_block.data();
+    auto stored = m_block.size();
+#ifdef ENABLE_ZSTD
+    m_stored.resize(ZSTD_compressBound(m_block.size()));
+    const auto size = ZSTD_compress(m_stored.data(), m_stored.size(), m_block.data(), m_block.size(), ZSTD_LEVEL);
+    if(!ZSTD_isError(size) && (size < m_block.size()))
+    {
+        codec = ZSTD;
+        payload = m_stored.data();
+        stored = size;
+    }
+#endif
+
+    const uint32_t header[] = { BLOCK_MAGIC, codec, m_block_frames, (uint32_t)m_block.size(), (uint32_t)stored };
+    if((std::fwrite(header, sizeof(header), 1, m_file) != 1) || (std::fwrite(payload, stored, 1, m_file) != 1))
+    {
+        LogWarn << "Writing recording \"" << m_path << "\" failed, it stops here";
+        m_failed = true;
+    }
+    m_block.clear();
+    m_block_frames = 0;
+    m_key = true;
+}
@@ -0,0 +1,114 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Streams displayed frames to a file from a background thread, for lining the graph up with a recording.
+// The caller converts and queues, the writer encodes and does all the I/O. A full queue drops frames
+// rather than waiting, they're counted and logged on close.
+//
+// File layout, little endian and packed:
+//     "WAVEREC1", uint32 version (1), uint32 reserved
+//     blocks of: uint32 "WBLK", uint32 codec (0 raw, 1 zstd), uint32 frames, uint32 raw bytes, uint32 stored bytes, payload
+// Each block decodes on its own. The raw payload is a run of frames:
+//     uint64 video frame ns, uint64 audio ns, uint32 count, uint8 channels, uint8 flags (1 key), uint16 reserved
+//     key frames only: count float32 Hz
+//     channels * count fp16 dBFS, key frames as is, the others as the uint16 difference from the previous frame
+// A block starts with a key frame, as does every frame whose layout changed.
+class FrameRecorder
+{
+public:
+    // one displayed frame, pointers are read during push() only
+    struct Frame
+    {
+        uint64_t frame_ts = 0;
+        uint64_t audio_ts = 0;
+        uint32_t channels = 1;
+        const float *values[2]{};   // count dB values per channel
+        const float *hz = nullptr;  // count frequencies, nullptr for none
+        size_t count = 0;
+    };
+
+    FrameRecorder() = default;
+    ~FrameRecorder() { close(); }
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    // start writing to path, replacing the current file, false and logged if it can't be created
+    bool open(const std::string& path);
+    void close();                   // flush what's queued and stop the writer
+    bool is_open() const noexcept { return m_file != nullptr; }
+    const std::string& path() const noexcept { return m_path; }
+
+    // queue a frame without waiting on the writer, one producer
+    void push(const Frame& frame);
+
+    static uint16_t to_half(float value) noexcept;
+
+private:
+    struct Record
+    {
+        uint64_t frame_ts = 0;
+        uint64_t audio_ts = 0;
+        uint32_t channels = 0;
+        size_t count = 0;
+        bool layout = false;        // hz changed since the last frame queued
+        std::vector<uint16_t> values;
+        std::vector<float> hz;
+    };
+
+    static constexpr size_t MAX_QUEUE = 256;            // frames, several seconds at any frame rate
+    static constexpr size_t BLOCK_BYTES = 1 << 20;      // raw payload per block
+    static constexpr int ZSTD_LEVEL = 3;
+
+    void writer();
+    void encode(const Record& record);  // into m_block, writer thread
+    void flush_block();                 // writer thread
+
+    std::FILE *m_file = nullptr;
+    std::string m_path;
+    std::thread m_thread;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::deque<Record> m_queue;         // under m_mtx
+    std::vector<Record> m_free;         // under m_mtx, drained records kept for their capacity
+    bool m_stop = false;                // under m_mtx
+    uint64_t m_dropped = 0;             // producer only
+
+    // producer's view of the last layout queued
+    std::vector<float> m_last_hz;
+    uint32_t m_last_channels = 0;
+
+    // writer thread only
+    std::vector<uint8_t> m_block;
+    std::vector<uint8_t> m_stored;
+    std::vector<uint16_t> m_prev;
+    std::vector<float> m_hz;            // layout of m_prev, rewritten with each key frame
+    uint32_t m_block_frames = 0;
+    bool m_key = true;                  // next frame starts fresh
+    bool m_failed = false;              // a write failed, further frames are discarded
+};
@@ -0,0 +1,84 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "goertzel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+void GoertzelBank::init(std::size_t n, const std::vector<uint32_t>& bins)
+{
+    m_n = n;
+    m_bins = bins;
+    const auto count = bins.size();
+    m_coeff.resize(count);
+    m_cos.resize(count);
+    m_sin.resize(count);
+    m_s1.resize(count);
+    m_s2.resize(count);
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        const auto w = (2.0 * std::numbers::pi * bins[i]) / (double)n;
+        m_cos[i] = std::cos(w);
+        m_sin[i] = std::sin(w);
+        m_coeff[i] = 2.0 * m_cos[i];
+    }
+}
+
+void GoertzelBank::clear()
+{
+    m_n = 0;
+    m_bins.clear();
+    m_coeff.clear();
+    m_cos.clear();
+    m_sin.clear();
+    m_s1.clear();
+    m_s2.clear();
+}
+
+void GoertzelBank::transform(const float *input, fftwf_complex *out)
+{
+    std::memset(out, 0, ((m_n / 2) + 1) * sizeof(fftwf_complex));
+    const auto count = m_bins.size();
+    if(count == 0)
+        return;
+
+    std::fill(m_s1.begin(), m_s1.end(), 0.0);
+    std::fill(m_s2.begin(), m_s2.end(), 0.0);
+    const auto s1 = m_s1.data();
+    const auto s2 = m_s2.data();
+    const auto coeff = m_coeff.data();
+    for(std::size_t m = 0; m < m_n; ++m)
+    {
+        // s[m] = x[m] + 2 cos(w) s[m - 1] - s[m - 2]
+        const auto x = (double)input[m];
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            const auto s = x + (coeff[i] * s1[i]) - s2[i];
+            s2[i] = s1[i];
+            s1[i] = s;
+        }
+    }
+
+    // for an integer bin X[k] = s[n - 1] e^(jw) - s[n - 2]
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        out[m_bins[i]][0] = (float)((s1[i] * m_cos[i]) - s2[i]);
+        out[m_bins[i]][1] = (float)(s1[i] * m_sin[i]);
+    }
+}
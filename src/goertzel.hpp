@@ -0,0 +1,46 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <fftw3.h>
+
+// Goertzel filters for an arbitrary set of bins of an n point real DFT.
+// Each bin costs O(n) per frame, which beats a full FFT when only a handful of bins are read.
+// Accumulates in double precision so the low bins of large transforms stay accurate.
+class GoertzelBank
+{
+public:
+    void init(std::size_t n, const std::vector<uint32_t>& bins);
+    void clear();
+    bool empty() const noexcept { return m_bins.empty(); }
+    const std::vector<uint32_t>& bins() const noexcept { return m_bins; }
+
+    // one (already windowed) frame of n samples to FFTW's r2c layout, bins outside of the bank are zeroed
+    void transform(const float *input, fftwf_complex *out);
+
+private:
+    std::size_t m_n = 0;
+    std::vector<uint32_t> m_bins;
+    std::vector<double> m_coeff;    // 2 cos(w), SoA so the per-sample update vectorizes across bins
+    std::vector<double> m_cos;
+    std::vector<double> m_sin;
+    std::vector<double> m_s1;       // filter state
+    std::vector<double> m_s2;
+};
@@ -0,0 +1,156 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "gpu_envelope.hpp"
+#include "log.hpp"
+#include <obs-module.h>
+#include <graphics/vec2.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+bool GpuEnvelope::create(uint32_t count, uint32_t rows, uint32_t display_rows, uint32_t columns)
+{
+    destroy();
+    if((count < 2) || (count > MAX_SAMPLES) || (rows == 0) || (rows > 2) || (display_rows == 0) || (columns == 0))
+        return false;
+
+    auto filename = obs_module_file("envelope.effect");
+    m_effect = gs_effect_create_from_file(filename, nullptr);
+    bfree(filename);
+    if(m_effect == nullptr)
+    {
+        LogWarn << "Could not load envelope.effect, drawing the waveform on the CPU";
+        return false;
+    }
+    m_envelope = gs_effect_get_technique(m_effect, "Envelope");
+    m_env_samples = gs_effect_get_param_by_name(m_effect, "env_samples");
+    m_env_layout = gs_effect_get_param_by_name(m_effect, "env_layout");
+    m_env_count = gs_effect_get_param_by_name(m_effect, "env_count");
+    m_env_end = gs_effect_get_param_by_name(m_effect, "env_end");
+    m_env_step = gs_effect_get_param_by_name(m_effect, "env_step");
+    m_env_last_row = gs_effect_get_param_by_name(m_effect, "env_last_row");
+    m_env_mix = gs_effect_get_param_by_name(m_effect, "env_mix");
+    m_out_size = gs_effect_get_param_by_name(m_effect, "out_size");
+    m_db_floor = gs_effect_get_param_by_name(m_effect, "db_floor");
+    m_db_ceiling = gs_effect_get_param_by_name(m_effect, "db_ceiling");
+    m_graph_scale = gs_effect_get_param_by_name(m_effect, "graph_scale");
+
+    // long windows wrap onto more texture rows, one block of them per ring
+    m_width = std::min(count, MAX_WIDTH);
+    m_lines = (count + m_width - 1) / m_width;
+    m_input = gs_texture_create(m_width, m_lines * rows, GS_R32F, 1, nullptr, GS_DYNAMIC);
+    m_out = gs_texrender_create(GS_R32F, GS_ZS_NONE);
+    if((m_envelope == nullptr) || (m_input == nullptr) || (m_out == nullptr))
+    {
+        LogWarn << "GPU envelope resources unavailable, drawing the waveform on the CPU";
+        destroy();
+        return false;
+    }
+
+    m_count = count;
+    m_rows = rows;
+    m_display_rows = display_rows;
+    m_columns = columns;
+    return true;
+}
+
+void GpuEnvelope::destroy()
+{
+    gs_texrender_destroy(std::exchange(m_out, nullptr));
+    gs_texture_destroy(std::exchange(m_input, nullptr));
+    gs_effect_destroy(std::exchange(m_effect, nullptr));
+    m_count = m_width = m_lines = m_rows = m_display_rows = m_columns = 0;
+    m_drawn = false;
+}
+
+gs_texture_t *GpuEnvelope::run(const Params& params)
+{
+    if(!ready())
+        return output();
+
+    // the rings are unrolled on the way in, the shader indexes the window oldest first
+    uint8_t *ptr;
+    uint32_t linesize;
+    if(!gs_texture_map(m_input, &ptr, &linesize))
+        return output();
+    const auto head = params.head % m_count;
+    for(auto row = 0u; row < m_rows; ++row)
+    {
+        const auto src = params.input[row];
+        for(auto line = 0u; line < m_lines; ++line)
+        {
+            const auto dst = reinterpret_cast<float*>(ptr + ((size_t)((row * m_lines) + line) * linesize));
+            const auto start = (size_t)line * m_width;
+            const auto len = std::min<size_t>(m_width, m_count - start);
+            if(src == nullptr)
+                std::fill_n(dst, m_width, 0.0f);
+            else
+            {
+                const auto pos = (head + start) % m_count;
+                const auto first = std::min(len, m_count - pos);
+                memcpy(dst, src + pos, first * sizeof(float));
+                memcpy(dst + first, src, (len - first) * sizeof(float));
+                std::fill(dst + len, dst + m_width, 0.0f);
+            }
+        }
+    }
+    gs_texture_unmap(m_input);
+
+    gs_blend_state_push();
+    gs_enable_blending(false);
+    vec2 size;
+    vec2_set(&size, (float)m_width, (float)m_lines);
+    gs_effect_set_texture(m_env_samples, m_input);
+    gs_effect_set_vec2(m_env_layout, &size);
+    gs_effect_set_float(m_env_count, (float)m_count);
+    gs_effect_set_float(m_env_end, (float)m_count + params.end);
+    gs_effect_set_float(m_env_step, params.step);
+    gs_effect_set_float(m_env_last_row, (float)(m_rows - 1));
+    gs_effect_set_bool(m_env_mix, params.mix && (m_rows > 1));
+    vec2_set(&size, (float)m_columns, (float)m_display_rows);
+    gs_effect_set_vec2(m_out_size, &size);
+    gs_effect_set_float(m_db_floor, params.floor);
+    gs_effect_set_float(m_db_ceiling, params.ceiling);
+    gs_effect_set_float(m_graph_scale, params.scale);
+
+    // one full screen quad, one texel per column of each display row
+    gs_texrender_reset(m_out);
+    if(gs_texrender_begin(m_out, m_columns, m_display_rows))
+    {
+        gs_ortho(0.0f, (float)m_columns, 0.0f, (float)m_display_rows, -100.0f, 100.0f);
+        gs_technique_begin(m_envelope);
+        gs_technique_begin_pass(m_envelope, 0);
+        gs_draw_sprite(nullptr, 0, m_columns, m_display_rows);
+        gs_technique_end_pass(m_envelope);
+        gs_technique_end(m_envelope);
+        gs_texrender_end(m_out);
+        m_drawn = true;
+    }
+    gs_blend_state_pop();
+    return output();
+}
+
+gs_texture_t *GpuEnvelope::output() const
+{
+    return m_drawn ? gs_texrender_get_texture(m_out) : nullptr;
+}
+
+size_t GpuEnvelope::gpu_bytes() const noexcept
+{
+    return ((size_t)m_width * m_lines * m_rows * sizeof(float)) + ((size_t)m_columns * m_display_rows * sizeof(float));
+}
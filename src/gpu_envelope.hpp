@@ -0,0 +1,85 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <cstdint>
+#include <graphics/graphics.h>
+
+// Waveform envelope on the GPU, the shader is in envelope.effect.
+// The raw samples of the whole window go up as a float texture and one pass finds the
+// peak of every column's span and turns it into the pixel height the geometry shaders read as graph_values.
+// Nothing is read back, columns are placed by position so no sample is skipped at any width.
+// Every call needs the graphics context.
+class GpuEnvelope
+{
+public:
+    static constexpr uint32_t MAX_WIDTH = 16384;        // texture width every OBS renderer supports
+    static constexpr uint32_t MAX_SAMPLES = 1u << 22;   // positions stay exact in a float
+
+    struct Params
+    {
+        const float *input[2]{};    // sample ring of each row, count samples
+        size_t head = 0;            // oldest sample of the rings
+        float end = 0.0f;           // end of the newest column in samples after the newest sample, may be negative
+        float step = 0.0f;          // samples per column
+        bool mix = false;           // mono display from two rows
+        float floor = 0.0f;         // dB
+        float ceiling = 0.0f;
+        float scale = 0.0f;         // pixels from the top of a channel to its base
+    };
+
+    GpuEnvelope() = default;
+    GpuEnvelope(const GpuEnvelope&) = delete;
+    GpuEnvelope& operator=(const GpuEnvelope&) = delete;
+    ~GpuEnvelope() { destroy(); }
+
+    // rows rings of count samples, shown as columns texels per display row
+    bool create(uint32_t count, uint32_t rows, uint32_t display_rows, uint32_t columns);
+    void destroy();
+    bool ready() const noexcept { return m_effect != nullptr; }
+
+    // upload the rings and return the heights, the last result if nothing could be drawn
+    gs_texture_t *run(const Params& params);
+    gs_texture_t *output() const;
+
+    size_t gpu_bytes() const noexcept;
+
+private:
+    gs_effect_t *m_effect = nullptr;
+    gs_technique_t *m_envelope = nullptr;
+    gs_eparam_t *m_env_samples = nullptr;
+    gs_eparam_t *m_env_layout = nullptr;
+    gs_eparam_t *m_env_count = nullptr;
+    gs_eparam_t *m_env_end = nullptr;
+    gs_eparam_t *m_env_step = nullptr;
+    gs_eparam_t *m_env_last_row = nullptr;
+    gs_eparam_t *m_env_mix = nullptr;
+    gs_eparam_t *m_out_size = nullptr;
+    gs_eparam_t *m_db_floor = nullptr;
+    gs_eparam_t *m_db_ceiling = nullptr;
+    gs_eparam_t *m_graph_scale = nullptr;
+
+    gs_texture_t *m_input = nullptr;        // R32F, width x (lines * rows), each ring unrolled oldest first
+    gs_texrender_t *m_out = nullptr;        // R32F, columns x display rows
+    uint32_t m_count = 0;
+    uint32_t m_width = 0;
+    uint32_t m_lines = 0;                   // texture rows per ring
+    uint32_t m_rows = 0;
+    uint32_t m_display_rows = 0;
+    uint32_t m_columns = 0;
+    bool m_drawn = false;
+};
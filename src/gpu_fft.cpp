@@ -0,0 +1,177 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "gpu_fft.hpp"
+#include "log.hpp"
+#include <obs-module.h>
+#include <graphics/vec2.h>
+#include <bit>
+#include <cstring>
+#include <utility>
+
+bool GpuFFT::create(uint32_t n, uint32_t rows, uint32_t display_rows, uint32_t columns, const float *bin_pos)
+{
+    destroy();
+    if(!std::has_single_bit(n) || (n < 2) || (n > MAX_SIZE) || (rows == 0) || (rows > 2) || (display_rows == 0) || (columns == 0) || (bin_pos == nullptr))
+        return false;
+
+    auto filename = obs_module_file("fft.effect");
+    m_effect = gs_effect_create_from_file(filename, nullptr);
+    bfree(filename);
+    if(m_effect == nullptr)
+    {
+        LogWarn << "Could not load fft.effect, analyzing on the CPU";
+        return false;
+    }
+    m_stage = gs_effect_get_technique(m_effect, "Stage");
+    m_bins = gs_effect_get_technique(m_effect, "Bins");
+    m_fft_input = gs_effect_get_param_by_name(m_effect, "fft_input");
+    m_fft_size = gs_effect_get_param_by_name(m_effect, "fft_size");
+    m_fft_span = gs_effect_get_param_by_name(m_effect, "fft_span");
+    m_fft_bins = gs_effect_get_param_by_name(m_effect, "fft_bins");
+    m_bin_pos = gs_effect_get_param_by_name(m_effect, "bin_pos");
+    m_bin_gains = gs_effect_get_param_by_name(m_effect, "bin_gains");
+    m_out_size = gs_effect_get_param_by_name(m_effect, "out_size");
+    m_bin_last = gs_effect_get_param_by_name(m_effect, "bin_last");
+    m_bins_mix = gs_effect_get_param_by_name(m_effect, "bins_mix");
+    m_bins_linear = gs_effect_get_param_by_name(m_effect, "bins_linear");
+    m_db_floor = gs_effect_get_param_by_name(m_effect, "db_floor");
+    m_db_ceiling = gs_effect_get_param_by_name(m_effect, "db_ceiling");
+    m_graph_scale = gs_effect_get_param_by_name(m_effect, "graph_scale");
+
+    const uint8_t *positions[] = { reinterpret_cast<const uint8_t*>(bin_pos) };
+    m_input = gs_texture_create(n, rows, GS_R32F, 1, nullptr, GS_DYNAMIC);
+    m_positions = gs_texture_create(columns, 1, GS_R32F, 1, positions, 0);
+    for(auto& pass : m_pass)
+        pass = gs_texrender_create(GS_RG32F, GS_ZS_NONE);
+    m_out = gs_texrender_create(GS_R32F, GS_ZS_NONE);
+    if((m_stage == nullptr) || (m_bins == nullptr) || (m_input == nullptr) || (m_positions == nullptr) || (m_pass[0] == nullptr) || (m_pass[1] == nullptr) || (m_out == nullptr))
+    {
+        LogWarn << "GPU FFT resources unavailable, analyzing on the CPU";
+        destroy();
+        return false;
+    }
+
+    m_n = n;
+    m_rows = rows;
+    m_display_rows = display_rows;
+    m_columns = columns;
+    return true;
+}
+
+void GpuFFT::destroy()
+{
+    for(auto& pass : m_pass)
+        gs_texrender_destroy(std::exchange(pass, nullptr));
+    gs_texrender_destroy(std::exchange(m_out, nullptr));
+    gs_texture_destroy(std::exchange(m_input, nullptr));
+    gs_texture_destroy(std::exchange(m_positions, nullptr));
+    gs_texture_destroy(std::exchange(m_gains, nullptr));
+    gs_effect_destroy(std::exchange(m_effect, nullptr));
+    m_n = m_rows = m_display_rows = m_columns = 0;
+    m_has_gains = false;
+    m_drawn = false;
+}
+
+void GpuFFT::set_gains(const float *gains)
+{
+    if(!ready() || (gains == nullptr))
+        return;
+    const uint8_t *data[] = { reinterpret_cast<const uint8_t*>(gains) };
+    gs_texture_destroy(m_gains);
+    m_gains = gs_texture_create(m_n / 2, 1, GS_R32F, 1, data, 0);
+    m_has_gains = m_gains != nullptr;
+}
+
+gs_texture_t *GpuFFT::run(const Params& params)
+{
+    if(!ready() || !m_has_gains)
+        return output();
+
+    uint8_t *ptr;
+    uint32_t linesize;
+    if(!gs_texture_map(m_input, &ptr, &linesize))
+        return output();
+    for(auto row = 0u; row < m_rows; ++row)
+    {
+        if(params.input[row] != nullptr)
+            memcpy(ptr + (row * linesize), params.input[row], m_n * sizeof(float));
+        else
+            memset(ptr + (row * linesize), 0, m_n * sizeof(float));
+    }
+    gs_texture_unmap(m_input);
+
+    // one full screen quad per pass, nothing blends into the targets
+    const auto draw = [](gs_texrender_t *target, gs_technique_t *tech, uint32_t cx, uint32_t cy) {
+        gs_texrender_reset(target);
+        if(!gs_texrender_begin(target, cx, cy))
+            return false;
+        gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
+        gs_technique_begin(tech);
+        gs_technique_begin_pass(tech, 0);
+        gs_draw_sprite(nullptr, 0, cx, cy);
+        gs_technique_end_pass(tech);
+        gs_technique_end(tech);
+        gs_texrender_end(target);
+        return true;
+    };
+
+    gs_blend_state_push();
+    gs_enable_blending(false);
+    vec2 size;
+    vec2_set(&size, (float)m_n, (float)m_rows);
+    gs_effect_set_vec2(m_fft_size, &size);
+    auto src = m_input;
+    auto ok = true;
+    auto pass = 0u;
+    for(uint32_t span = 1; ok && (span < m_n); span *= 2, pass ^= 1u)
+    {
+        gs_effect_set_texture(m_fft_input, src);
+        gs_effect_set_float(m_fft_span, (float)span);
+        ok = draw(m_pass[pass], m_stage, m_n, m_rows);
+        src = gs_texrender_get_texture(m_pass[pass]);
+    }
+
+    if(ok)
+    {
+        vec2_set(&size, (float)m_columns, (float)m_display_rows);
+        gs_effect_set_texture(m_fft_bins, src);
+        gs_effect_set_texture(m_bin_pos, m_positions);
+        gs_effect_set_texture(m_bin_gains, m_gains);
+        gs_effect_set_vec2(m_out_size, &size);
+        gs_effect_set_float(m_bin_last, (float)(m_n / 2 - 1));
+        gs_effect_set_bool(m_bins_mix, params.mix && (m_rows > 1));
+        gs_effect_set_bool(m_bins_linear, params.linear);
+        gs_effect_set_float(m_db_floor, params.floor);
+        gs_effect_set_float(m_db_ceiling, params.ceiling);
+        gs_effect_set_float(m_graph_scale, params.scale);
+        m_drawn = draw(m_out, m_bins, m_columns, m_display_rows) || m_drawn;
+    }
+    gs_blend_state_pop();
+    return output();
+}
+
+gs_texture_t *GpuFFT::output() const
+{
+    return m_drawn ? gs_texrender_get_texture(m_out) : nullptr;
+}
+
+size_t GpuFFT::gpu_bytes() const noexcept
+{
+    const auto points = (size_t)m_n * m_rows;
+    return (points * sizeof(float)) + (2 * points * 2 * sizeof(float)) + ((size_t)m_columns * (m_display_rows + 1) * sizeof(float)) + ((m_n / 2) * sizeof(float));
+}
@@ -0,0 +1,92 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <cstdint>
+#include <graphics/graphics.h>
+
+// Experimental spectrum analysis on the GPU, the shaders are in fft.effect.
+// A radix-2 Stockham FFT runs as log2(n) ping-pong render passes over an RG32F target,
+// then one pass turns magnitudes into the pixel heights the geometry shaders read as graph_values.
+// Nothing is read back, the CPU only uploads the windowed input.
+// Every call needs the graphics context.
+class GpuFFT
+{
+public:
+    static constexpr uint32_t MAX_SIZE = 16384; // texture width every OBS renderer supports
+
+    struct Params
+    {
+        const float *input[2]{};    // windowed input of each row, n points
+        bool mix = false;           // mono display from two rows
+        bool linear = false;        // interpolate between bins
+        float floor = 0.0f;         // dB
+        float ceiling = 0.0f;
+        float scale = 0.0f;         // pixels from the top of a channel to its base
+    };
+
+    GpuFFT() = default;
+    GpuFFT(const GpuFFT&) = delete;
+    GpuFFT& operator=(const GpuFFT&) = delete;
+    ~GpuFFT() { destroy(); }
+
+    // rows transforms of n points, n a power of two, shown as columns texels per display row
+    // bin_pos has the fractional bin of each column
+    bool create(uint32_t n, uint32_t rows, uint32_t display_rows, uint32_t columns, const float *bin_pos);
+    void destroy();
+    bool ready() const noexcept { return m_effect != nullptr; }
+
+    // bins n / 2 gains, only needed once, analysis tables may arrive after create()
+    void set_gains(const float *gains);
+    bool has_gains() const noexcept { return m_has_gains; }
+
+    // run the transform and return the heights, the last result if nothing could be drawn
+    gs_texture_t *run(const Params& params);
+    gs_texture_t *output() const;
+
+    size_t gpu_bytes() const noexcept;
+
+private:
+    gs_effect_t *m_effect = nullptr;
+    gs_technique_t *m_stage = nullptr;
+    gs_technique_t *m_bins = nullptr;
+    gs_eparam_t *m_fft_input = nullptr;
+    gs_eparam_t *m_fft_size = nullptr;
+    gs_eparam_t *m_fft_span = nullptr;
+    gs_eparam_t *m_fft_bins = nullptr;
+    gs_eparam_t *m_bin_pos = nullptr;
+    gs_eparam_t *m_bin_gains = nullptr;
+    gs_eparam_t *m_out_size = nullptr;
+    gs_eparam_t *m_bin_last = nullptr;
+    gs_eparam_t *m_bins_mix = nullptr;
+    gs_eparam_t *m_bins_linear = nullptr;
+    gs_eparam_t *m_db_floor = nullptr;
+    gs_eparam_t *m_db_ceiling = nullptr;
+    gs_eparam_t *m_graph_scale = nullptr;
+
+    gs_texture_t *m_input = nullptr;        // R32F, n x rows
+    gs_texture_t *m_positions = nullptr;    // R32F, columns x 1
+    gs_texture_t *m_gains = nullptr;        // R32F, n / 2 x 1
+    gs_texrender_t *m_pass[2]{};            // RG32F ping-pong, n x rows
+    gs_texrender_t *m_out = nullptr;        // R32F, columns x display rows
+    uint32_t m_n = 0;
+    uint32_t m_rows = 0;
+    uint32_t m_display_rows = 0;
+    uint32_t m_columns = 0;
+    bool m_has_gains = false;
+    bool m_drawn = false;
+};
@@ -0,0 +1,201 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "iir_filterbank.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <numbers>
+
+namespace
+{
+    // terms per lane in the coefficient and state arrays
+    constexpr std::size_t COEF_TERMS = 6;
+    constexpr std::size_t STATE_TERMS = 4;
+}
+
+void IIRFilterbank::init(uint32_t sample_rate, unsigned int fraction, float low, float high)
+{
+    clear();
+    const auto fs = (double)std::max(sample_rate, 1u);
+    fraction = std::max(fraction, 1u);
+    const auto half = std::exp2(0.5 / fraction);
+
+    // base 2 centers 1000 * 2^(k / fraction), any band reaching into [low, high] is kept
+    std::vector<double> centers;
+    const auto kmin = (int)std::floor(std::log2(std::max(low, 1.0f) / 1000.0) * fraction) - 1;
+    const auto kmax = (int)std::ceil(std::log2(std::max(high, 1.0f) / 1000.0) * fraction) + 1;
+    for(auto k = kmin; k <= kmax; ++k)
+    {
+        const auto fc = 1000.0 * std::exp2((double)k / fraction);
+        if((fc * half <= low) || (fc / half >= high) || (fc * half >= 0.49 * fs))
+            continue;
+        centers.push_back(fc);
+    }
+    if(centers.empty())
+        return;
+
+    m_bands = centers.size();
+    m_lanes = ((m_bands + LANES - 1) / LANES) * LANES;
+    m_coefs.reset(m_lanes * COEF_TERMS);
+    std::fill_n(m_coefs.get(), m_coefs.size(), 0.0f);
+    for(auto& state : m_state)
+        state.reset(LANES + (m_lanes * STATE_TERMS));
+    for(auto& energy : m_energy)
+        energy.reset(m_lanes);
+    m_centers.resize(m_bands);
+    m_edges.resize(m_bands);
+
+    // 2nd order butterworth prototype shifted to bandpass gives two pole pairs, one biquad each
+    // prewarped bilinear transform, the numerators are K s so both sections are b0 * (1 - z^-2)
+    const auto K = 2.0 * fs;
+    const auto proto = std::polar(1.0, 0.75 * std::numbers::pi);
+    for(std::size_t i = 0; i < m_bands; ++i)
+    {
+        const auto f1 = centers[i] / half;
+        const auto f2 = centers[i] * half;
+        const auto w1 = K * std::tan(std::numbers::pi * f1 / fs);
+        const auto w2 = K * std::tan(std::numbers::pi * f2 / fs);
+        const auto w0 = std::sqrt(w1 * w2);
+        const auto bw = w2 - w1;
+        const auto disc = std::sqrt((proto * proto * bw * bw) - (4.0 * w0 * w0));
+        const std::complex<double> poles[2] = { (proto * bw + disc) / 2.0, (proto * bw - disc) / 2.0 };
+
+        // unity gain at the digital center
+        const auto center = std::polar(1.0, 2.0 * std::atan(w0 / K));
+        double coefs[2][3];
+        auto gain = 1.0;
+        for(auto j = 0; j < 2; ++j)
+        {
+            const auto a1 = -2.0 * poles[j].real();
+            const auto a0 = std::norm(poles[j]);
+            const auto d = (K * K) + (a1 * K) + a0;
+            coefs[j][0] = K / d;
+            coefs[j][1] = 2.0 * (a0 - (K * K)) / d;
+            coefs[j][2] = ((K * K) - (a1 * K) + a0) / d;
+            const auto zi = 1.0 / center;
+            gain *= std::abs(coefs[j][0] * (1.0 - zi * zi) / (1.0 + coefs[j][1] * zi + coefs[j][2] * zi * zi));
+        }
+        const auto norm = 1.0 / std::sqrt(gain);
+        for(auto j = 0; j < 2; ++j)
+        {
+            m_coefs[((j * 3) + 0) * m_lanes + i] = (float)(coefs[j][0] * norm);
+            m_coefs[((j * 3) + 1) * m_lanes + i] = (float)coefs[j][1];
+            m_coefs[((j * 3) + 2) * m_lanes + i] = (float)coefs[j][2];
+        }
+        m_centers[i] = (float)centers[i];
+        m_edges[i] = (float)f1;
+    }
+
+    reset();
+}
+
+void IIRFilterbank::reset()
+{
+    for(uint32_t ch = 0; ch < MAX_CHANNELS; ++ch)
+    {
+        if(m_state[ch])
+            std::fill_n(m_state[ch].get(), m_state[ch].size(), 0.0f);
+        if(m_energy[ch])
+            std::fill_n(m_energy[ch].get(), m_energy[ch].size(), 0.0f);
+        m_samples[ch] = 0;
+    }
+}
+
+void IIRFilterbank::clear()
+{
+    m_bands = 0;
+    m_lanes = 0;
+    m_centers.clear();
+    m_edges.clear();
+    m_coefs.reset();
+    for(uint32_t ch = 0; ch < MAX_CHANNELS; ++ch)
+    {
+        m_state[ch].reset();
+        m_energy[ch].reset();
+        m_samples[ch] = 0;
+    }
+}
+
+std::size_t IIRFilterbank::bytes() const noexcept
+{
+    auto total = (m_coefs.size() + m_centers.size() + m_edges.size()) * sizeof(float);
+    for(uint32_t ch = 0; ch < MAX_CHANNELS; ++ch)
+        total += (m_state[ch].size() + m_energy[ch].size()) * sizeof(float);
+    return total;
+}
+
+IIRFilterbank::Pass IIRFilterbank::pass(uint32_t channel, const float *src, std::size_t count) noexcept
+{
+    m_samples[channel] += count;
+    return { m_coefs.get(), m_state[channel].get(), m_energy[channel].get(), src, count, m_lanes };
+}
+
+std::size_t IIRFilterbank::take_energy(uint32_t channel, float *out) noexcept
+{
+    const auto samples = std::exchange(m_samples[channel], 0);
+    if(samples == 0)
+        return 0;
+    auto energy = m_energy[channel].get();
+    const auto scale = 2.0f / (float)samples;
+    for(std::size_t i = 0; i < m_bands; ++i)
+        out[i] = energy[i] * scale;
+    std::fill_n(energy, m_lanes, 0.0f);
+    return samples;
+}
+
+void iir_bank(const IIRFilterbank::Pass& pass)
+{
+    const auto lanes = pass.lanes;
+    const auto src = pass.src;
+    const auto count = pass.count;
+    const auto b0 = pass.coefs;
+    const auto a1 = b0 + lanes;
+    const auto a2 = a1 + lanes;
+    const auto c0 = a2 + lanes;
+    const auto c1 = c0 + lanes;
+    const auto c2 = c1 + lanes;
+    auto u1 = pass.state + IIRFilterbank::LANES;
+    auto u2 = u1 + lanes;
+    auto v1 = u2 + lanes;
+    auto v2 = v1 + lanes;
+    for(std::size_t i = 0; i < lanes; ++i)
+    {
+        auto xm1 = pass.state[0];
+        auto xm2 = pass.state[1];
+        auto um1 = u1[i], um2 = u2[i], vm1 = v1[i], vm2 = v2[i];
+        auto sum = 0.0f;
+        for(std::size_t n = 0; n < count; ++n)
+        {
+            const auto x = src[n];
+            const auto u = (b0[i] * (x - xm2)) - (a1[i] * um1) - (a2[i] * um2);
+            const auto v = (c0[i] * (u - um2)) - (c1[i] * vm1) - (c2[i] * vm2);
+            xm2 = std::exchange(xm1, x);
+            um2 = std::exchange(um1, u);
+            vm2 = std::exchange(vm1, v);
+            sum += v * v;
+        }
+        u1[i] = um1;
+        u2[i] = um2;
+        v1[i] = vm1;
+        v2[i] = vm2;
+        pass.energy[i] += sum;
+    }
+
+    iir_bank_history(pass);
+}
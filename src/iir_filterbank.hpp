@@ -0,0 +1,99 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include "waveform_config.hpp"
+#include "aligned_buffer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ISO 266 octave or third octave bands as 4th order Butterworth bandpass filters, two biquads per band.
+// Every band sees every sample, several bands per vector: coefficients and state are stored one array
+// per term with a lane per band, padded to LANES. The numerators are b0 * (x[n] - x[n-2]), so the input
+// history of the first section is shared by all bands and the second section's is the first's output.
+// Energy is summed per band until it's taken, the cost follows the audio and not the frame rate.
+class IIRFilterbank
+{
+public:
+    static constexpr std::size_t LANES = 8;     // band padding, one AVX vector
+    static constexpr uint32_t MAX_CHANNELS = 2;
+
+    // fraction is 1 for octaves or 3 for third octaves, every band overlapping [low, high] below nyquist
+    void init(uint32_t sample_rate, unsigned int fraction, float low, float high);
+    void reset();   // silence the filters and drop the energy
+    void clear();   // no bands
+    bool empty() const noexcept { return m_bands == 0; }
+    std::size_t bands() const noexcept { return m_bands; }
+    std::size_t lanes() const noexcept { return m_lanes; }
+    const std::vector<float>& centers() const noexcept { return m_centers; }   // exact base 2 centers, Hz
+    const std::vector<float>& edges() const noexcept { return m_edges; }       // lower edges, Hz
+    std::size_t bytes() const noexcept;
+
+    // one pass of iir_bank() or a SIMD variant over count samples of channel
+    struct Pass
+    {
+        const float *coefs = nullptr;   // b0, a1, a2 of the first section then of the second, lanes each
+        float *state = nullptr;         // x[n-1] and x[n-2] in the first LANES floats, then u1, u2, v1, v2 of lanes each
+        float *energy = nullptr;        // squared outputs summed, lanes
+        const float *src = nullptr;
+        std::size_t count = 0;
+        std::size_t lanes = 0;
+    };
+    Pass pass(uint32_t channel, const float *src, std::size_t count) noexcept;
+
+    // twice the mean square of each band since the last call, a full scale sine at the center reads 1
+    // returns how many samples were summed, out is left untouched if none were
+    std::size_t take_energy(uint32_t channel, float *out) noexcept;
+
+private:
+    std::size_t m_bands = 0;
+    std::size_t m_lanes = 0;
+    std::vector<float> m_centers;
+    std::vector<float> m_edges;
+    AlignedBuffer<float> m_coefs;
+    AlignedBuffer<float> m_state[MAX_CHANNELS];
+    AlignedBuffer<float> m_energy[MAX_CHANNELS];
+    std::size_t m_samples[MAX_CHANNELS] = {};   // summed into m_energy
+};
+
+void iir_bank(const IIRFilterbank::Pass& pass);
+
+// after the bands have run, the first section's input history is shared
+inline void iir_bank_history(const IIRFilterbank::Pass& pass) noexcept
+{
+    if(pass.count >= 2)
+    {
+        pass.state[0] = pass.src[pass.count - 1];
+        pass.state[1] = pass.src[pass.count - 2];
+    }
+    else if(pass.count == 1)
+    {
+        pass.state[1] = pass.state[0];
+        pass.state[0] = pass.src[0];
+    }
+}
+
+#ifdef ENABLE_X86_SIMD
+void iir_bank_fma3(const IIRFilterbank::Pass& pass);
+void iir_bank_avx(const IIRFilterbank::Pass& pass);
+#endif // ENABLE_X86_SIMD
+
+#ifdef ENABLE_ARM_SIMD
+void iir_bank_neon(const IIRFilterbank::Pass& pass);
+#endif // ENABLE_ARM_SIMD
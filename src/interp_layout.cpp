@@ -0,0 +1,192 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "interp_layout.hpp"
+#include "math_funcs.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <utility>
+
+namespace
+{
+    // only a handful of distinct layouts exist at once, linear search is fine
+    std::mutex s_mtx;
+    std::vector<std::pair<InterpParams, std::weak_ptr<const InterpLayout>>> s_layouts;
+
+    // the exports still report every bar, the right half of a mirrored layout repeats the left
+    void mirror_bands(std::vector<float>& band_hz)
+    {
+        const auto half = band_hz.size() / 2;
+        for(auto i = half + 1; i < band_hz.size(); ++i)
+            band_hz[i] = band_hz[half - (i - half)];
+    }
+
+    // keep the first count bands, their weights stay where they are
+    void truncate_filterbank(Filterbank<float>& bank, size_t count)
+    {
+        if(count >= bank.start.size())
+            return;
+        bank.start.resize(count);
+        bank.count.resize(count);
+        bank.offsets.resize(count);
+        bank.edges.resize(count + 2);
+        bank.first_bin = std::numeric_limits<size_t>::max();
+        bank.last_bin = 0;
+        for(size_t i = 0; i < count; ++i)
+        {
+            bank.first_bin = std::min(bank.first_bin, (size_t)bank.start[i]);
+            bank.last_bin = std::max(bank.last_bin, (size_t)(bank.start[i] + bank.count[i]));
+        }
+    }
+
+    void build(InterpLayout& layout, const InterpParams& p)
+    {
+        const auto sz = p.size;
+        const auto display_mode = (DisplayMode)p.display_mode;
+        const auto interp_mode = (InterpMode)p.interp_mode;
+        const auto time_domain = (display_mode == DisplayMode::WAVEFORM) || (display_mode == DisplayMode::SCOPE); // samples, not bins
+        const auto maxbin = (p.fft_size / 2) - 1;
+        const auto sr = (float)p.sample_rate;
+        float lowbin, highbin;
+        if(time_domain)
+        {
+            lowbin = 0.0f;
+            highbin = (float)(p.fft_size - 1);
+        }
+        else
+        {
+            lowbin = std::clamp((float)p.cutoff_low * p.fft_size / sr, 1.0f, (float)maxbin);
+            highbin = std::clamp((float)p.cutoff_high * p.fft_size / sr, 1.0f, (float)maxbin);
+        }
+
+        auto& indices = layout.indices;
+        indices.resize(sz);
+        if(p.log_scale)
+        {
+            for(auto i = 0u; i < sz; ++i)
+                indices[i] = std::clamp(log_interp(lowbin, highbin, (p.mirror_freq_axis ? i * 2.0f : (float)i) / (float)(sz - 1)), lowbin, highbin);
+        }
+        else
+        {
+            for(auto i = 0u; i < sz; ++i)
+                indices[i] = std::clamp(lerp(lowbin, highbin, (p.mirror_freq_axis ? i * 2.0f : (float)i) / (float)(sz - 1)), lowbin, highbin);
+        }
+
+        // bar bands
+        const auto bars = (display_mode == DisplayMode::BAR) || (display_mode == DisplayMode::STEPPED_BAR);
+        const auto num_bars = p.num_bars;
+        if(bars)
+        {
+            layout.band_widths.resize(num_bars);
+            layout.band_hz.resize(num_bars);
+            for(auto i = 0; i < num_bars; ++i)
+            {
+                layout.band_widths[i] = std::max((int)(indices[i + 1] - indices[i]), 1);
+                layout.band_hz[i] = indices[i] * sr / (float)p.fft_size;
+            }
+        }
+
+        // the right half of a mirrored axis repeats the left, only the unique points are laid out
+        // the display mirrors them, see mirror_points()
+        const auto unique = !p.mirror_freq_axis ? (bars ? (size_t)num_bars : (size_t)sz) : (bars ? (size_t)(num_bars / 2) : (size_t)(sz / 2)) + 1;
+        if(p.mirror_freq_axis)
+        {
+            indices.resize(std::min(indices.size(), unique));
+            if(bars)
+            {
+                layout.band_widths.resize(std::min(layout.band_widths.size(), unique));
+                mirror_bands(layout.band_hz);
+            }
+        }
+
+        // perceptual bands are read like point sampled ones by the pruning and the active bin range
+        if(bars && ((BandScale)p.band_scale != BandScale::NONE))
+        {
+            layout.filterbank = make_filterbank((BandScale)p.band_scale, (size_t)num_bars, (float)p.cutoff_low, (float)p.cutoff_high, sr / (float)p.fft_size, p.fft_size / 2, p.mirror_freq_axis ? 2.0f : 1.0f);
+            if(p.mirror_freq_axis)
+                truncate_filterbank(layout.filterbank, unique);
+            const auto bands = layout.filterbank.start.size();
+            indices.resize(bands);
+            layout.band_widths.resize(bands);
+            for(size_t i = 0; i < bands; ++i)
+            {
+                indices[i] = (float)layout.filterbank.start[i];
+                layout.band_widths[i] = (int)layout.filterbank.count[i];
+                layout.band_hz[i] = layout.filterbank.edges[i];
+            }
+            if(p.mirror_freq_axis)
+                mirror_bands(layout.band_hz);
+            return;
+        }
+
+        // interpolation filter
+        if(interp_mode != InterpMode::POINT)
+        {
+            if((display_mode != DisplayMode::CURVE) && !time_domain && (display_mode != DisplayMode::SPECTROGRAM))
+            {
+                // at this point indices only contains the start of each band
+                // so we'll fill in the intermediate points here
+                std::vector<float> samples;
+                samples.reserve((size_t)std::ceil(highbin - lowbin));
+                for(size_t i = 0; i < layout.band_widths.size(); ++i)
+                {
+                    auto count = layout.band_widths[i];
+                    for(auto j = 0; j < count; ++j)
+                        samples.push_back(indices[i] + j);
+                }
+                indices = std::move(samples);
+            }
+
+            if(interp_mode == InterpMode::LANCZOS)
+                layout.kernel = make_lanczos_kernel(indices, 4);
+            else if(interp_mode == InterpMode::CATROM)
+                layout.kernel = make_catrom_kernel(0.5f);
+
+            // input size the filters will run on, so they don't have to find the edge points every frame
+            set_interior(layout.kernel, indices, time_domain ? p.fft_size : p.fft_size / 2);
+        }
+    }
+}
+
+size_t InterpLayout::bytes() const
+{
+    const auto bytes = [](const auto& buf) -> size_t { return buf.size() * sizeof(buf[0]); };
+    return bytes(indices) + bytes(band_widths) + bytes(band_hz) + bytes(filterbank.weights) + bytes(kernel.weights) + bytes(kernel.offsets);
+}
+
+std::shared_ptr<const InterpLayout> InterpLayout::request(const InterpParams& params)
+{
+    std::lock_guard lock(s_mtx);
+    std::erase_if(s_layouts, [](const auto& entry) { return entry.second.expired(); });
+    for(const auto& [key, weak] : s_layouts)
+        if(key == params)
+            if(auto existing = weak.lock())
+                return existing;
+
+    auto layout = std::make_shared<InterpLayout>();
+    build(*layout, params);
+    s_layouts.emplace_back(params, layout);
+    return layout;
+}
+
+std::shared_ptr<const InterpLayout> InterpLayout::none()
+{
+    static const auto empty = std::make_shared<const InterpLayout>();
+    return empty;
+}
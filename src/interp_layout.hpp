@@ -0,0 +1,82 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include "filter.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+enum class InterpMode
+{
+    POINT,
+    LANCZOS,
+    CATROM
+};
+
+enum class DisplayMode
+{
+    CURVE,
+    BAR,
+    STEPPED_BAR,
+    METER,
+    STEPPED_METER,
+    WAVEFORM,
+    SPECTROGRAM,    // curve analysis, one row per frame scrolling down
+    SCOPE,          // triggered window of samples, drawn as a curve
+    VECTORSCOPE     // stereo sample pairs accumulated on the GPU
+};
+
+// Everything a display point layout is built from.
+// Equal params give identical layouts, sources with equal params share them.
+struct InterpParams
+{
+    unsigned int size = 0;      // display points, bars have one more for the end of the last band
+    size_t fft_size = 0;
+    uint32_t sample_rate = 0;
+    int cutoff_low = 0;
+    int cutoff_high = 0;
+    int display_mode = 0;       // DisplayMode
+    int interp_mode = 0;        // InterpMode
+    int band_scale = 0;         // BandScale, bars only
+    int num_bars = 0;           // bars only
+    bool log_scale = false;
+    bool mirror_freq_axis = false;
+
+    bool operator==(const InterpParams&) const = default;
+};
+
+// Where each display point reads the bins (or samples in waveform mode) and the kernel reading them,
+// never modified once built.
+struct InterpLayout
+{
+    std::vector<float> indices;     // only the left half and the middle point when the axis is mirrored
+    std::vector<int> band_widths;   // size of the band each bar represents, same
+    std::vector<float> band_hz;     // frequency each bar starts at, for the exports
+    Filterbank<float> filterbank;   // bars with a band scale, replaces the interpolation
+    Kernel<float> kernel;           // lanczos or catmull-rom, empty for point sampling
+
+    size_t bytes() const;
+
+    // layout for params, shared with every other holder of equal params
+    // built on the calling thread, a second asker for the same layout waits instead of building it again
+    static std::shared_ptr<const InterpLayout> request(const InterpParams& params);
+
+    // no display points, meters and sources without a layout yet
+    static std::shared_ptr<const InterpLayout> none();
+};
@@ -0,0 +1,309 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "kernel_tuning.hpp"
+#include "filter.hpp"
+#include "iir_filterbank.hpp"
+#include "aligned_buffer.hpp"
+#include "math_funcs.hpp"
+#include "module.hpp"
+#include "log.hpp"
+#include <obs-module.h>
+#include <util/config-file.h>
+#include <util/platform.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef ENABLE_X86_SIMD
+#include "cpuinfo_x86.h"
+#endif
+
+namespace
+{
+    constexpr auto CACHE_FILE = "kernel_tuning.ini";
+    constexpr auto SECTION = "tuning";
+    constexpr size_t SPECTRUM_SIZE = 4096;  // bins, an 8192 point FFT
+    constexpr size_t POINTS = 1920;         // curve columns
+
+    std::thread s_worker;
+    std::atomic<bool> s_stop = false;
+
+    // what the cached winners are only valid for
+    std::string cache_key(const DSPKernels::Levels& levels)
+    {
+        std::ostringstream key;
+        key << WAVEFORM_VERSION << " ";
+#ifdef ENABLE_X86_SIMD
+        const auto info = cpu_features::GetX86Info();
+        key << info.brand_string;
+#else
+        key << os_get_logical_cores() << " cores";
+#endif
+        key << " " << levels.interp << levels.filter << levels.filterbank << levels.iir << (levels.fma ? "f" : "");
+        return key.str();
+    }
+
+    int tier_index(std::span<const char *const> tiers, const char *name)
+    {
+        if(name == nullptr)
+            return -1;
+        const auto it = std::find_if(tiers.begin(), tiers.end(), [=](const char *tier) { return std::string(tier) == name; });
+        return (it == tiers.end()) ? -1 : (int)(it - tiers.begin());
+    }
+
+    // deterministic spectrum in dB, the same tilted sweep as the kernel check
+    AlignedBuffer<float> make_spectrum()
+    {
+        AlignedBuffer<float> ret;
+        ret.reset(SPECTRUM_SIZE);
+        uint32_t state = 0x12345678u;
+        for(size_t i = 0; i < SPECTRUM_SIZE; ++i)
+        {
+            state = (state * 1664525u) + 1013904223u;
+            const auto noise = (float)(state >> 8) / (float)(1u << 24);
+            const auto t = (float)i / (float)SPECTRUM_SIZE;
+            ret[i] = -30.0f - (40.0f * t) + (20.0f * std::sin(200.0f * t * t)) + (6.0f * noise);
+        }
+        return ret;
+    }
+
+    std::vector<float> make_indices(size_t count)
+    {
+        std::vector<float> ret(count);
+        for(size_t i = 0; i < count; ++i)
+            ret[i] = std::clamp(log_interp(1.0f, (float)(SPECTRUM_SIZE - 1), (float)i / (float)(count - 1)), 1.0f, (float)(SPECTRUM_SIZE - 1));
+        return ret;
+    }
+
+    // best of a few batches, the first batch also warms the caches
+    template<typename Fn>
+    double time_call(const Fn& fn)
+    {
+        constexpr auto batches = 5;
+        constexpr auto calls = 16;
+        auto best = std::numeric_limits<double>::max();
+        for(auto batch = 0; batch < batches; ++batch)
+        {
+            const auto start = os_gettime_ns();
+            for(auto i = 0; i < calls; ++i)
+                fn();
+            best = std::min(best, (double)(os_gettime_ns() - start) / calls);
+        }
+        return best;
+    }
+
+    // fastest level of one kernel up to its cap, levels that resolve to the same kernel are timed once
+    // ties go to the lower level
+    template<typename Fn, typename Time>
+    int fastest(const DSPKernels::Levels& caps, int DSPKernels::Levels::*level, Fn DSPKernels::*kernel, const Time& time)
+    {
+        auto best = 0;
+        auto best_ns = std::numeric_limits<double>::max();
+        Fn prev = nullptr;
+        for(auto i = 0; (i <= caps.*level) && !s_stop; ++i)
+        {
+            auto levels = caps;
+            levels.*level = i;
+            const auto fn = DSPKernels::resolve(levels).*kernel;
+            if(fn == prev)
+                continue;
+            prev = fn;
+            const auto ns = time(fn);
+            if(ns < best_ns)
+            {
+                best = i;
+                best_ns = ns;
+            }
+        }
+        return best;
+    }
+
+    void save(const DSPKernels::Levels& caps, const DSPKernels::Levels& tuned, std::span<const char *const> tiers)
+    {
+        auto dir = obs_module_config_path("");
+        if(dir != nullptr)
+        {
+            os_mkdirs(dir);
+            bfree(dir);
+        }
+        auto path = obs_module_config_path(CACHE_FILE);
+        if(path == nullptr)
+            return;
+        config_t *config = nullptr;
+        if(config_open(&config, path, CONFIG_OPEN_ALWAYS) == CONFIG_SUCCESS)
+        {
+            config_set_string(config, SECTION, "key", cache_key(caps).c_str());
+            config_set_string(config, SECTION, "interp", tiers[tuned.interp]);
+            config_set_string(config, SECTION, "filter", tiers[tuned.filter]);
+            config_set_string(config, SECTION, "filterbank", tiers[tuned.filterbank]);
+            config_set_string(config, SECTION, "iir", tiers[tuned.iir]);
+            config_set_double(config, SECTION, "prefix_width", tuned.prefix_width);
+            if(config_save(config) != CONFIG_SUCCESS)
+                LogWarn << "Failed to save kernel tuning to \"" << path << "\"";
+            config_close(config);
+        }
+        bfree(path);
+    }
+
+    void worker(DSPKernels::Levels caps, std::span<const char *const> tiers)
+    {
+        const auto spectrum = make_spectrum();
+        const auto samples = spectrum.get();
+        const auto sz = spectrum.size();
+        AlignedBuffer<float> out;
+        out.reset(POINTS);
+        const std::span<float> span(out.get(), POINTS);
+        auto tuned = caps;
+
+        // curve interpolation, both specialized kernel sizes, the bar bands go with it
+        const auto points = make_indices(POINTS);
+        auto lanczos = make_lanczos_kernel(points, 4);
+        auto catrom = make_catrom_kernel(0.5f);
+        set_interior(lanczos, points, sz);
+        set_interior(catrom, points, sz);
+        tuned.interp = fastest(caps, &DSPKernels::Levels::interp, &DSPKernels::interp, [&](DSPKernels::InterpFn fn) {
+            return time_call([&] { fn(samples, sz, points, lanczos, span); }) + time_call([&] { fn(samples, sz, points, catrom, span); });
+            });
+
+        // smoothing, a typical radius over the curve
+        const auto gauss = make_gauss_kernel(1.0f);
+        tuned.filter = fastest(caps, &DSPKernels::Levels::filter, &DSPKernels::filter, [&](DSPKernels::FilterFn fn) {
+            return time_call([&] { fn(samples, POINTS, gauss, span); });
+            });
+
+        // perceptual bands, as if the spectrum came from a 48 kHz FFT
+        const auto bank = make_filterbank(BandScale::MEL, 64, 20.0f, 20000.0f, 24000.0f / (float)sz, sz);
+        tuned.filterbank = fastest(caps, &DSPKernels::Levels::filterbank, &DSPKernels::filterbank, [&](DSPKernels::FilterbankFn fn) {
+            return time_call([&] { fn(samples, bank, span); });
+            });
+
+        // third octave bands, about one 60 fps frame of audio per call
+        IIRFilterbank iir;
+        iir.init(48000, 3, 20.0f, 20000.0f);
+        tuned.iir = fastest(caps, &DSPKernels::Levels::iir, &DSPKernels::iir, [&](DSPKernels::IIRBankFn fn) {
+            return time_call([&] { fn(iir.pass(0, samples, 800)); });
+            });
+
+        // where the running sum starts beating the winning bar convolution, over bar counts from narrow to wide bands
+        const auto kernels = DSPKernels::resolve(tuned);
+        if((kernels.bands != nullptr) && !s_stop)
+        {
+            struct Timing
+            {
+                float width;    // average band width in kernel sizes
+                double conv;
+                double prefix;
+            };
+            std::vector<Timing> timings;
+            std::vector<double> prefix;
+            for(auto bars : { 8, 16, 32, 64, 128, 256 })
+            {
+                const auto starts = make_indices((size_t)bars + 1);
+                std::vector<int> band_widths((size_t)bars);
+                std::vector<float> bins;
+                for(auto i = 0; i < bars; ++i)
+                {
+                    band_widths[i] = std::max((int)(starts[i + 1] - starts[i]), 1);
+                    for(auto j = 0; j < band_widths[i]; ++j)
+                        bins.push_back(starts[i] + j);
+                }
+                for(auto use_lanczos : { true, false })
+                {
+                    auto kernel = use_lanczos ? make_lanczos_kernel(bins, 4) : make_catrom_kernel(0.5f);
+                    set_interior(kernel, bins, sz);
+                    timings.push_back({ (float)bins.size() / (float)(kernel.size * bars),
+                        time_call([&] { kernels.bands(samples, sz, band_widths, bins, kernel, span); }),
+                        time_call([&] { apply_interp_filter_prefix(samples, sz, band_widths, bins, kernel, prefix, span); }) });
+                }
+            }
+            auto best_ns = std::numeric_limits<double>::max();
+            for(auto width : { 1.0f, 0.5f, 2.0f, 0.25f, 4.0f, 8.0f }) // ties keep the default
+            {
+                auto ns = 0.0;
+                for(const auto& timing : timings)
+                    ns += (timing.width >= width) ? timing.prefix : timing.conv;
+                if(ns < best_ns)
+                {
+                    best_ns = ns;
+                    tuned.prefix_width = width;
+                }
+            }
+        }
+
+        if(s_stop)
+            return;
+        save(caps, tuned, tiers);
+        LogInfo << "Kernel autotune: interp " << tiers[tuned.interp] << ", filter " << tiers[tuned.filter] << ", filterbank " << tiers[tuned.filterbank]
+            << ", iir " << tiers[tuned.iir] << ", bars prefix width " << tuned.prefix_width << ", used from the next start";
+    }
+}
+
+bool KernelTuning::apply(DSPKernels::Levels& levels, std::span<const char *const> tiers)
+{
+    auto path = obs_module_config_path(CACHE_FILE);
+    if(path == nullptr)
+        return false;
+    auto found = false;
+    config_t *config = nullptr;
+    if(os_file_exists(path) && (config_open(&config, path, CONFIG_OPEN_EXISTING) == CONFIG_SUCCESS))
+    {
+        const auto key = config_get_string(config, SECTION, "key");
+        const auto interp = tier_index(tiers, config_get_string(config, SECTION, "interp"));
+        const auto filter = tier_index(tiers, config_get_string(config, SECTION, "filter"));
+        const auto filterbank = tier_index(tiers, config_get_string(config, SECTION, "filterbank"));
+        const auto iir = tier_index(tiers, config_get_string(config, SECTION, "iir"));
+        const auto prefix_width = (float)config_get_double(config, SECTION, "prefix_width");
+        found = (key != nullptr) && (key == cache_key(levels)) && (interp >= 0) && (filter >= 0) && (filterbank >= 0) && (iir >= 0) && (prefix_width > 0.0f);
+        if(found)
+        {
+            levels.interp = std::min(levels.interp, interp);
+            levels.filter = std::min(levels.filter, filter);
+            levels.filterbank = std::min(levels.filterbank, filterbank);
+            levels.iir = std::min(levels.iir, iir);
+            levels.prefix_width = prefix_width;
+            LogInfo << "Using tuned kernels: interp " << tiers[levels.interp] << ", filter " << tiers[levels.filter] << ", filterbank " << tiers[levels.filterbank]
+                << ", iir " << tiers[levels.iir] << ", bars prefix width " << levels.prefix_width;
+        }
+        config_close(config);
+    }
+    bfree(path);
+    return found;
+}
+
+void KernelTuning::start(const DSPKernels::Levels& levels, std::span<const char *const> tiers)
+{
+    if((module_config_uint("cpu", "autotune") == 0) || s_worker.joinable())
+        return;
+    LogInfo << "Kernel autotune started";
+    s_stop = false;
+    s_worker = std::thread(worker, levels, tiers);
+}
+
+void KernelTuning::stop()
+{
+    s_stop = true;
+    if(s_worker.joinable())
+        s_worker.join();
+}
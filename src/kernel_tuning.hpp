@@ -0,0 +1,38 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include "dsp_kernels.hpp"
+#include <span>
+
+// Optional autotune of the display kernels, [cpu] autotune=1 in the module config.ini.
+// The winners are cached in kernel_tuning.ini in the module config directory, keyed by the plugin version,
+// the CPU model and the tier caps they were measured under. A matching cache lowers the levels before
+// DSPKernels::select(), otherwise a worker times every tier on representative sizes and saves the winners.
+// The dispatch table is fixed once sources exist, so a fresh result takes effect on the next load.
+class KernelTuning
+{
+public:
+    // cap levels with the cached winners, false if there are none for this CPU and these levels
+    static bool apply(DSPKernels::Levels& levels, std::span<const char *const> tiers);
+
+    // tune on a worker when autotune is enabled, levels are the caps from the [cpu] config
+    // tiers must outlive the worker, they name the levels in the cache and the log
+    static void start(const DSPKernels::Levels& levels, std::span<const char *const> tiers);
+    static void stop();
+};
@@ -0,0 +1,162 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "loudness.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+void LoudnessMeter::init(uint32_t sample_rate, std::size_t peak_blocks)
+{
+    // K-weighting coefficients for any rate, from the analog prototypes of the 48 kHz filters in BS.1770
+    const auto fs = (double)std::max(sample_rate, 1u);
+    {
+        constexpr auto f0 = 1681.974450955533;
+        constexpr auto gain = 3.999843853973347;
+        constexpr auto q = 0.7071752369554196;
+        const auto k = std::tan(std::numbers::pi * f0 / fs);
+        const auto vh = std::pow(10.0, gain / 20.0);
+        const auto vb = std::pow(vh, 0.4996667741545416);
+        const auto a0 = 1.0 + (k / q) + (k * k);
+        m_stage[0] = { (vh + (vb * k / q) + (k * k)) / a0, 2.0 * ((k * k) - vh) / a0, (vh - (vb * k / q) + (k * k)) / a0,
+            2.0 * ((k * k) - 1.0) / a0, (1.0 - (k / q) + (k * k)) / a0 };
+    }
+    {
+        constexpr auto f0 = 38.13547087602444;
+        constexpr auto q = 0.5003270373238773;
+        const auto k = std::tan(std::numbers::pi * f0 / fs);
+        const auto a0 = 1.0 + (k / q) + (k * k);
+        m_stage[1] = { 1.0, -2.0, 1.0, 2.0 * ((k * k) - 1.0) / a0, (1.0 - (k / q) + (k * k)) / a0 };
+    }
+
+    // blackman windowed sinc at the input nyquist, each phase normalized to unity gain
+    constexpr auto taps = PHASE_TAPS * OVERSAMPLE;
+    for(std::size_t phase = 0; phase < OVERSAMPLE; ++phase)
+    {
+        auto sum = 0.0;
+        double h[PHASE_TAPS];
+        for(std::size_t k = 0; k < PHASE_TAPS; ++k)
+        {
+            const auto n = (double)((k * OVERSAMPLE) + phase);
+            const auto x = (n - ((taps - 1) / 2.0)) / OVERSAMPLE;
+            const auto sinc = (x == 0.0) ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+            const auto t = 2.0 * std::numbers::pi * n / (taps - 1);
+            h[k] = sinc * (0.42 - (0.5 * std::cos(t)) + (0.08 * std::cos(2.0 * t)));
+            sum += h[k];
+        }
+        // tap k weights the sample k steps back, history is newest last
+        for(std::size_t k = 0; k < PHASE_TAPS; ++k)
+            m_taps[PHASE_TAPS - 1 - k][phase] = (float)(h[k] / sum);
+    }
+
+    m_block_size = std::max((std::size_t)std::lround(fs / 10.0), (std::size_t)1);
+    for(auto& channel : m_channels)
+    {
+        channel.energy.assign(SHORT_TERM_BLOCKS, 0.0);
+        channel.peaks.assign(std::max(peak_blocks, (std::size_t)1), 0.0f);
+    }
+    reset();
+}
+
+void LoudnessMeter::reset()
+{
+    for(auto& channel : m_channels)
+    {
+        for(auto& z : channel.z)
+            z[0] = z[1] = 0.0;
+        channel.sum = 0.0;
+        channel.peak = 0.0f;
+        channel.fill = 0;
+        channel.blocks = 0;
+        std::fill(channel.energy.begin(), channel.energy.end(), 0.0);
+        std::fill(channel.peaks.begin(), channel.peaks.end(), 0.0f);
+        std::fill(std::begin(channel.history), std::end(channel.history), 0.0f);
+    }
+}
+
+void LoudnessMeter::process(uint32_t channel, const float *src, std::size_t count)
+{
+    if((channel >= MAX_CHANNELS) || (m_block_size == 0))
+        return;
+    auto& state = m_channels[channel];
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        // K-weighting
+        double x = src[i];
+        for(auto stage = 0; stage < 2; ++stage)
+        {
+            const auto& c = m_stage[stage];
+            auto& z = state.z[stage];
+            const auto w = x - (c.a1 * z[0]) - (c.a2 * z[1]);
+            x = (c.b0 * w) + (c.b1 * z[0]) + (c.b2 * z[1]);
+            z[1] = z[0];
+            z[0] = w;
+        }
+        state.sum += x * x;
+
+        // true peak, the 4 phases side by side vectorize as one register
+        std::copy(&state.history[1], &state.history[PHASE_TAPS], &state.history[0]);
+        state.history[PHASE_TAPS - 1] = src[i];
+        float y[OVERSAMPLE]{};
+        for(std::size_t k = 0; k < PHASE_TAPS; ++k)
+            for(std::size_t phase = 0; phase < OVERSAMPLE; ++phase)
+                y[phase] += m_taps[k][phase] * state.history[k];
+        for(auto val : y)
+            state.peak = std::max(state.peak, std::abs(val));
+        state.peak = std::max(state.peak, std::abs(src[i]));
+
+        if(++state.fill == m_block_size)
+        {
+            state.energy[state.blocks % state.energy.size()] = state.sum / (double)m_block_size;
+            state.peaks[state.blocks % state.peaks.size()] = state.peak;
+            ++state.blocks;
+            state.sum = 0.0;
+            state.peak = 0.0f;
+            state.fill = 0;
+        }
+    }
+}
+
+float LoudnessMeter::level(std::size_t window) const noexcept
+{
+    // sum of the channels' mean square over the window, every channel weighted 1 (no surround here)
+    // -0.691 dB offsets the K-weighting gain at 1 kHz
+    auto power = 0.0;
+    for(const auto& channel : m_channels)
+    {
+        const auto count = std::min({ window, channel.blocks, channel.energy.size() });
+        if(count == 0)
+            continue;
+        auto sum = 0.0;
+        for(std::size_t i = 1; i <= count; ++i)
+            sum += channel.energy[(channel.blocks - i) % channel.energy.size()];
+        power += sum / (double)window; // a window that hasn't filled yet counts the missing blocks as silence
+    }
+    return (float)std::sqrt(power * std::pow(10.0, -0.0691));
+}
+
+float LoudnessMeter::true_peak(uint32_t channel) const noexcept
+{
+    if(channel >= MAX_CHANNELS)
+        return 0.0f;
+    const auto& state = m_channels[channel];
+    auto peak = state.peak;
+    for(auto val : state.peaks)
+        peak = std::max(peak, val);
+    return peak;
+}
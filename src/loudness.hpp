@@ -0,0 +1,73 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ITU-R BS.1770 / EBU R128 loudness and true peak of up to two channels.
+// Audio is fed one channel at a time as it leaves the capture ring, nothing is buffered beyond the filter state.
+// K-weighted energy is summed into 100 ms blocks, momentary loudness averages the last 4 and short-term the last 30.
+// True peak runs a 4x polyphase interpolator over every sample and keeps the largest magnitude per block.
+// Every level is linear amplitude, 20 * log10 gives LUFS or dBTP.
+class LoudnessMeter
+{
+public:
+    static constexpr uint32_t MAX_CHANNELS = 2;
+    static constexpr std::size_t MOMENTARY_BLOCKS = 4;  // 400 ms
+    static constexpr std::size_t SHORT_TERM_BLOCKS = 30; // 3 s
+
+    // peak_blocks is how many 100 ms blocks true_peak() looks back over
+    void init(uint32_t sample_rate, std::size_t peak_blocks);
+    void reset();
+
+    void process(uint32_t channel, const float *src, std::size_t count);
+
+    float momentary() const noexcept { return level(MOMENTARY_BLOCKS); }
+    float short_term() const noexcept { return level(SHORT_TERM_BLOCKS); }
+    float true_peak(uint32_t channel) const noexcept;
+
+private:
+    static constexpr std::size_t OVERSAMPLE = 4;
+    static constexpr std::size_t PHASE_TAPS = 12;       // 48 tap interpolator
+
+    struct Biquad
+    {
+        double b0, b1, b2, a1, a2;
+    };
+
+    struct Channel
+    {
+        double z[2][2]{};                   // direct form II state of the two K-weighting stages
+        double sum = 0.0;                   // K-weighted energy of the current block
+        float peak = 0.0f;                  // true peak of the current block
+        std::size_t fill = 0;               // samples in the current block
+        std::size_t blocks = 0;             // completed blocks
+        std::vector<double> energy;         // mean square of the last SHORT_TERM_BLOCKS blocks, ring
+        std::vector<float> peaks;           // true peak of the last peak_blocks blocks, ring
+        float history[PHASE_TAPS]{};        // newest input last
+    };
+
+    float level(std::size_t window) const noexcept;
+
+    Biquad m_stage[2]{};                    // high shelf, then high pass
+    float m_taps[PHASE_TAPS][OVERSAMPLE]{}; // interpolator, phases interleaved so a tap updates all 4 at once
+    std::size_t m_block_size = 0;
+    Channel m_channels[MAX_CHANNELS];
+};
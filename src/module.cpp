@@ -17,7 +17,17 @@
 
 #include "module.hpp"
 #include "source.hpp"
+#include "fft_planner.hpp"
+#include "analysis_tables.hpp"
+#include "analysis_worker.hpp"
+#include "source_list.hpp"
+#include "kernel_tuning.hpp"
+#include "buffer_arena.hpp"
+#include "capture_hub.hpp"
+#include "websocket_vendor.hpp"
 #include <obs-module.h>
+#include <util/config-file.h>
+#include <mutex>
 
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE(MODULE_NAME, "en-US")
@@ -32,13 +42,82 @@ MODULE_EXPORT const char *obs_module_description()
     return "Audio Spectral Analysis Plugin";
 }
 
+namespace
+{
+    // config.ini is parsed once on first use instead of once per value, it's only read while the module loads
+    std::mutex s_config_mtx;
+    config_t *s_config = nullptr;
+    bool s_config_opened = false;
+
+    // config lock must be held, null if there is no config.ini
+    config_t *module_config()
+    {
+        if(!s_config_opened)
+        {
+            s_config_opened = true;
+            auto path = obs_module_config_path("config.ini");
+            if(path != nullptr)
+            {
+                if(config_open(&s_config, path, CONFIG_OPEN_EXISTING) != CONFIG_SUCCESS)
+                    s_config = nullptr;
+                bfree(path);
+            }
+        }
+        return s_config;
+    }
+
+    void module_config_close()
+    {
+        std::lock_guard lock(s_config_mtx);
+        if(s_config != nullptr)
+            config_close(s_config);
+        s_config = nullptr;
+        s_config_opened = false;
+    }
+}
+
+uint64_t module_config_uint(const char *section, const char *name)
+{
+    std::lock_guard lock(s_config_mtx);
+    const auto config = module_config();
+    return (config != nullptr) ? config_get_uint(config, section, name) : 0;
+}
+
+std::string module_config_string(const char *section, const char *name)
+{
+    std::lock_guard lock(s_config_mtx);
+    const auto config = module_config();
+    const auto value = (config != nullptr) ? config_get_string(config, section, name) : nullptr;
+    return (value != nullptr) ? value : std::string();
+}
+
 MODULE_EXPORT bool obs_module_load()
 {
+    // [memory] large_pages=1 in config.ini backs big FFT buffers with large pages
+    BufferArena::set_large_pages(module_config_uint("memory", "large_pages") != 0);
+    // [memory] compact_history=1 keeps capture history older than the newest 32768 samples as int16
+    CaptureStream::set_compact_history(module_config_uint("memory", "compact_history") != 0);
+    FFTPlanner::start();
+    AnalysisBuilder::start();
+    AnalysisWorker::start();
+    AudioSourceList::start();
     WAVSource::register_source();
+    module_config_close(); // reopened if anything reads it later
     return true;
 }
 
+// obs-websocket sets up its vendor API while it loads, which may be after us
+MODULE_EXPORT void obs_module_post_load()
+{
+    WebsocketVendor::start();
+}
+
 MODULE_EXPORT void obs_module_unload()
 {
-    //...
+    WebsocketVendor::stop();
+    KernelTuning::stop();
+    AudioSourceList::stop();
+    AnalysisWorker::stop();
+    AnalysisBuilder::stop();
+    FFTPlanner::stop();
 }
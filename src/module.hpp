@@ -20,3 +20,13 @@
 
 #define MODULE_DISPLAY_NAME "Waveform Visualizer"
 #define MODULE_NAME "phandasm_waveform"
+
+#include <cstdint>
+#include <string>
+
+// value from config.ini in the module config directory, for tuning that has no place in any source's settings
+// 0 if the file or the value is missing
+uint64_t module_config_uint(const char *section, const char *name);
+
+// same for text, empty if missing
+std::string module_config_string(const char *section, const char *name);
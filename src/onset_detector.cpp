@@ -0,0 +1,194 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "onset_detector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+void OnsetDetector::reset()
+{
+    *this = OnsetDetector();
+}
+
+bool OnsetDetector::feed(float flux, float total, float seconds)
+{
+    constexpr auto THRESHOLD_SECONDS = 1.0f;    // memory of the adaptive threshold, no onsets before it has settled
+    constexpr auto THRESHOLD_DEVIATIONS = 1.5f;
+    constexpr auto THRESHOLD_MIN = 0.02f;       // above the mean, steady noise never counts
+    constexpr auto MIN_ONSET_INTERVAL = 0.1;    // seconds
+    constexpr auto BEAT_WINDOW = 0.25f;         // fraction of the period an onset may be off a beat and still move it
+    constexpr auto BEAT_PULL = 0.3f;            // fraction of that offset corrected per onset
+    constexpr auto MAX_MISSED_BEATS = 4.0f;     // behind by more than this many periods restarts the phase
+    constexpr auto MAX_MISSES = 3u;             // off beat onsets in a row that restart the phase, it locked onto the wrong one
+
+    seconds = std::max(seconds, 0.0f);
+    m_time += seconds;
+    const auto strength = (total > 0.0f) ? std::clamp(flux / total, 0.0f, 1.0f) : 0.0f;
+    m_strength = strength;
+
+    // rising edge above mean + k * deviation, the frame itself only moves the threshold after the test
+    const auto threshold = m_mean + (THRESHOLD_DEVIATIONS * m_deviation) + THRESHOLD_MIN;
+    const auto above = strength > threshold;
+    const auto onset = above && !m_above && (m_time >= THRESHOLD_SECONDS) && ((m_time - m_last_onset) >= MIN_ONSET_INTERVAL);
+    m_above = above;
+    const auto novelty = std::max(strength - m_mean, 0.0f);
+    const auto a = 1.0f - std::exp(-seconds / THRESHOLD_SECONDS);
+    m_mean += a * (strength - m_mean);
+    m_deviation += a * (std::abs(strength - m_mean) - m_deviation);
+
+    // fixed rate envelope for the tempo, frames come at the hop or tick rate
+    constexpr auto step = 1.0f / ENVELOPE_RATE;
+    m_envelope_peak = std::max(m_envelope_peak, novelty);
+    m_envelope_time += seconds;
+    for(std::size_t pushed = 0; (m_envelope_time >= step) && (pushed < ENVELOPE_SIZE); ++pushed)
+    {
+        push_envelope(std::exchange(m_envelope_peak, 0.0f));
+        m_envelope_time -= step;
+    }
+    if(m_envelope_time >= step)
+        m_envelope_time = 0.0f; // a gap longer than the ring is all zeros anyway
+
+    if(onset)
+    {
+        ++m_onsets;
+        m_last_onset = m_time;
+    }
+    if(m_period <= 0.0f)
+    {
+        m_next_beat = 0.0;
+        m_misses = 0;
+        return onset && fire();
+    }
+
+    if(onset)
+    {
+        // pull the nearer of the last and next beat towards the onset
+        const auto window = BEAT_WINDOW * m_period;
+        const auto early = m_next_beat - m_time;
+        const auto late = m_time - m_last_beat;
+        const auto pull_early = (early <= late) && (early < window);
+        const auto pull_late = !pull_early && (late < window);
+        m_misses = (pull_early || pull_late) ? 0 : m_misses + 1;
+        if((m_next_beat <= 0.0) || (m_misses >= MAX_MISSES))
+        {
+            // the first onset with a tempo sets the phase, so do enough off beat ones in a row
+            m_next_beat = m_time;
+            m_misses = 0;
+        }
+        else if(pull_early)
+            m_next_beat -= BEAT_PULL * early;
+        else if(pull_late)
+            m_next_beat += BEAT_PULL * late;
+    }
+    if((m_next_beat <= 0.0) || (m_time < m_next_beat))
+        return false;
+    if((m_time - m_next_beat) > (MAX_MISSED_BEATS * m_period))
+        m_next_beat = m_time;
+    while(m_time >= m_next_beat)
+    {
+        m_last_beat = m_next_beat;
+        m_next_beat += m_period;
+    }
+    return fire(); // skipped periods still make a single beat
+}
+
+void OnsetDetector::push_envelope(float value)
+{
+    m_envelope[m_envelope_pos] = value;
+    m_envelope_pos = (m_envelope_pos + 1) % ENVELOPE_SIZE;
+    m_envelope_fill = std::min(m_envelope_fill + 1, ENVELOPE_SIZE);
+    if((++m_since_tempo >= TEMPO_INTERVAL) && (m_envelope_fill >= ENVELOPE_SIZE / 2))
+    {
+        m_since_tempo = 0;
+        estimate_tempo();
+    }
+}
+
+void OnsetDetector::estimate_tempo()
+{
+    constexpr auto MIN_CONFIDENCE = 0.1f;
+    constexpr auto CENTER_LAG = ENVELOPE_RATE * 60.0f / 120.0f; // preferred tempo
+    constexpr auto TEMPO_OCTAVES = 1.0f;                        // width of the preference
+    constexpr auto TEMPO_FOLLOW = 0.25f;                        // of the difference to an agreeing estimate
+
+    // oldest first, mean removed
+    const auto count = m_envelope_fill;
+    const auto start = (m_envelope_pos + ENVELOPE_SIZE - count) % ENVELOPE_SIZE;
+    float env[ENVELOPE_SIZE];
+    double mean = 0.0;
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        env[i] = m_envelope[(start + i) % ENVELOPE_SIZE];
+        mean += env[i];
+    }
+    mean /= (double)count;
+    double r0 = 0.0;
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        env[i] -= (float)mean;
+        r0 += (double)env[i] * env[i];
+    }
+    r0 /= (double)count;
+
+    // weighted autocorrelation of every lag in range, and one either side for the interpolation
+    float r[MAX_LAG + 2]{};
+    float score[MAX_LAG + 2]{};
+    auto best = MIN_LAG;
+    for(auto lag = MIN_LAG - 1; (r0 > 1e-12) && (lag <= MAX_LAG + 1) && (lag < count); ++lag)
+    {
+        double sum = 0.0;
+        for(auto i = lag; i < count; ++i)
+            sum += (double)env[i] * env[i - lag];
+        r[lag] = (float)(sum / (double)(count - lag) / r0);
+        const auto octaves = std::log2((float)lag / CENTER_LAG) / TEMPO_OCTAVES;
+        score[lag] = r[lag] * std::exp(-0.5f * octaves * octaves);
+        if((lag >= MIN_LAG) && (lag <= MAX_LAG) && (score[lag] > score[best]))
+            best = lag;
+    }
+
+    m_confidence = std::clamp(r[best], 0.0f, 1.0f);
+    if(m_confidence < MIN_CONFIDENCE)
+    {
+        // two weak estimates in a row drop the tempo
+        if(m_candidate <= 0.0f)
+            m_period = 0.0f;
+        m_candidate = 0.0f;
+        return;
+    }
+
+    // parabola through the neighbouring scores for a fractional lag
+    const auto prev = score[best - 1];
+    const auto next = score[best + 1];
+    const auto denom = prev - (2.0f * score[best]) + next;
+    const auto offset = (denom < 0.0f) ? std::clamp(0.5f * (prev - next) / denom, -0.5f, 0.5f) : 0.0f;
+    const auto period = ((float)best + offset) / ENVELOPE_RATE;
+
+    const auto agrees = [](float a, float b) { return std::abs(a - b) <= (0.08f * b); };
+    if((m_period > 0.0f) && agrees(period, m_period))
+        m_period += TEMPO_FOLLOW * (period - m_period);
+    else if((m_candidate > 0.0f) && agrees(period, m_candidate))
+        m_period = period;
+    m_candidate = period;
+}
+
+bool OnsetDetector::fire()
+{
+    ++m_beats;
+    return true;
+}
@@ -0,0 +1,78 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Onsets and beats from the positive spectral flux of each analysis frame.
+// An onset is the flux rising above an adaptive threshold, the recent mean plus a multiple of its deviation.
+// The flux above the mean is resampled to a fixed rate envelope, its strongest autocorrelation lag over
+// the last few seconds (weighted towards 120 BPM) is the tempo, and beats follow that period with their
+// phase pulled towards the onsets that land near them. Without a tempo every onset is a beat.
+class OnsetDetector
+{
+public:
+    void reset();
+
+    // one analysis frame, seconds after the previous one
+    // flux is the positive change of every bin against the last frame, total the sum of every bin, same domain
+    // returns true if the frame fired a beat
+    bool feed(float flux, float total, float seconds);
+
+    uint64_t onsets() const noexcept { return m_onsets; }
+    uint64_t beats() const noexcept { return m_beats; }
+    float strength() const noexcept { return m_strength; }      // flux / total of the last frame
+    float period() const noexcept { return m_period; }          // seconds per beat, 0 without a tempo
+    float bpm() const noexcept { return (m_period > 0.0f) ? 60.0f / m_period : 0.0f; }
+    float confidence() const noexcept { return m_confidence; }  // autocorrelation of the tempo lag, 0 to 1
+
+private:
+    static constexpr float ENVELOPE_RATE = 100.0f;          // Hz
+    static constexpr std::size_t ENVELOPE_SIZE = 512;       // about 5 s
+    static constexpr std::size_t TEMPO_INTERVAL = 50;       // envelope samples between tempo estimates
+    static constexpr std::size_t MIN_LAG = 30;              // 200 BPM
+    static constexpr std::size_t MAX_LAG = 100;             // 60 BPM
+
+    void push_envelope(float value);
+    void estimate_tempo();
+    bool fire();
+
+    double m_time = 0.0;            // seconds fed so far
+    float m_strength = 0.0f;
+    float m_mean = 0.0f;            // adaptive threshold state
+    float m_deviation = 0.0f;
+    bool m_above = false;           // last frame was above the threshold
+    double m_last_onset = -1.0;
+    uint64_t m_onsets = 0;
+
+    float m_envelope[ENVELOPE_SIZE]{};  // ring
+    std::size_t m_envelope_pos = 0;
+    std::size_t m_envelope_fill = 0;    // valid samples, up to ENVELOPE_SIZE
+    std::size_t m_since_tempo = 0;      // samples since the last estimate
+    float m_envelope_peak = 0.0f;       // largest value since the last sample
+    float m_envelope_time = 0.0f;
+
+    float m_period = 0.0f;
+    float m_candidate = 0.0f;       // a new tempo is only taken once two estimates agree on it, 0 after a weak one
+    float m_confidence = 0.0f;
+    double m_next_beat = 0.0;       // predicted, 0 until the first onset with a tempo
+    double m_last_beat = 0.0;
+    uint32_t m_misses = 0;          // onsets in a row too far off the beats to move them
+    uint64_t m_beats = 0;
+};
@@ -0,0 +1,113 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include "waveform_config.hpp"
+
+#ifdef ENABLE_PROFILER
+#include <util/profiler.h>
+#endif
+
+#ifdef WAVEFORM_TRACY
+#include <tracy/TracyC.h>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <source_location>
+#include <string>
+#endif
+
+// Section of the libobs profiler from construction to end() or destruction.
+// The names show up in the OBS performance log under whatever section the calling thread is in,
+// they must be string literals because the profiler tells sections apart by pointer.
+// With WAVEFORM_TRACY the same section is also a Tracy zone at the call site.
+// Compiled out unless the plugin is built with ENABLE_PROFILER or WAVEFORM_TRACY.
+class ProfileScope
+{
+public:
+#if defined(ENABLE_PROFILER) || defined(WAVEFORM_TRACY)
+#ifdef WAVEFORM_TRACY
+    explicit ProfileScope(const char *name, const std::source_location loc = std::source_location::current()) noexcept : m_name(name)
+    {
+        // call sites only know their location at run time, so the zone allocates its source location
+        const auto file = loc.file_name();
+        const auto function = loc.function_name();
+        const auto srcloc = ___tracy_alloc_srcloc_name(loc.line(), file, std::strlen(file), function, std::strlen(function), name, std::strlen(name), 0);
+        m_zone = ___tracy_emit_zone_begin_alloc(srcloc, 1);
+#else
+    explicit ProfileScope(const char *name) noexcept : m_name(name)
+    {
+#endif
+#ifdef ENABLE_PROFILER
+        profile_start(name);
+#endif
+    }
+    ~ProfileScope() { end(); }
+
+    void end() noexcept
+    {
+        if(m_name == nullptr)
+            return;
+#ifdef ENABLE_PROFILER
+        profile_end(m_name);
+#endif
+#ifdef WAVEFORM_TRACY
+        ___tracy_emit_zone_end(m_zone);
+#endif
+        m_name = nullptr;
+    }
+#else
+    explicit ProfileScope(const char *) noexcept {}
+    void end() noexcept {}
+#endif
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+#if defined(ENABLE_PROFILER) || defined(WAVEFORM_TRACY)
+private:
+    const char *m_name;
+#endif
+#ifdef WAVEFORM_TRACY
+    TracyCZoneCtx m_zone;
+#endif
+};
+
+// name of a Tracy plot of one source, "waveform <counter> (<source>)"
+// Tracy keeps plot names by pointer, they stay allocated until the module unloads
+// nullptr without WAVEFORM_TRACY, which profile_plot() ignores
+inline const char *profile_plot_name([[maybe_unused]] const char *source, [[maybe_unused]] const char *counter)
+{
+#ifdef WAVEFORM_TRACY
+    static std::mutex s_mtx;
+    static std::set<std::string> s_names;
+    std::lock_guard lock(s_mtx);
+    return s_names.insert(std::string("waveform ") + counter + " (" + ((source != nullptr) ? source : "") + ")").first->c_str();
+#else
+    return nullptr;
+#endif
+}
+
+// add a value to a Tracy plot, nothing without WAVEFORM_TRACY
+inline void profile_plot([[maybe_unused]] const char *name, [[maybe_unused]] double value) noexcept
+{
+#ifdef WAVEFORM_TRACY
+    if(name != nullptr)
+        ___tracy_emit_plot(name, value);
+#endif
+}
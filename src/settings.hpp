@@ -27,11 +27,33 @@ static inline bool p_equ(const char *s1, const char *s2) { return std::strcmp(s1
 
 // localizable property strings
 #define P_AUDIO_SRC         "audio_source"
+#define P_AUDIO_SRC_UUID    "audio_source_uuid"
 #define P_NONE              "none"
 #define P_OUTPUT_BUS        "output_bus"
+#define P_OUTPUT_TRACK      "output_track"
+#define P_ANALYSIS_PARENT   "analysis_parent"
+#define P_PLAYBACK          "playback_path"
+#define P_PLAYBACK_OFFSET   "playback_offset"
 
 #define P_HIDE_SILENT       "hide_on_silent"
 #define P_IGNORE_MUTE       "ignore_mute"
+#define P_LOG_STATS         "log_stats"
+#define P_LOG_LATENCY       "log_latency"
+#define P_SHARED_MEMORY     "shared_memory_name"
+#define P_ENVELOPE          "envelope_signal"
+#define P_RECORD_PATH       "record_path"
+#define P_CAPTURE_LOG       "capture_log_path"
+#define P_ENVELOPE_ATTACK   "envelope_attack"
+#define P_ENVELOPE_RELEASE  "envelope_release"
+#define P_HEADLESS          "headless"
+#define P_ASYNC_ANALYSIS    "async_analysis"
+#define P_JOIN_ANALYSIS     "join_analysis"
+#define P_ANALYSIS_INTERVAL "analysis_interval"
+#define P_PREVIEW_INTERVAL  "preview_analysis_interval"
+#define P_MIN_HOP           "min_analysis_hop"
+#define P_CPU_BUDGET        "cpu_budget"
+#define P_SLEEP_TIMEOUT     "sleep_timeout"
+#define P_GPU_FFT           "gpu_fft"
 
 #define P_NORMALIZE_VOLUME  "normalize_volume"
 #define P_VOLUME_TARGET     "volume_target"
@@ -47,6 +69,7 @@ static inline bool p_equ(const char *s1, const char *s2) { return std::strcmp(s1
 #define P_PULSE_MODE        "pulse_mode"
 #define P_PEAK_MAG          "peak_magnitude"
 #define P_PEAK_FREQ         "peak_frequency"
+#define P_BEAT              "beat"
 
 #define P_WIDTH             "width"
 #define P_HEIGHT            "height"
@@ -54,6 +77,16 @@ static inline bool p_equ(const char *s1, const char *s2) { return std::strcmp(s1
 #define P_LOG_SCALE         "log_scale"
 
 #define P_MIRROR_FREQ_AXIS  "mirror_freq_axis"
+#define P_BAND_SCALE        "band_scale"
+#define P_MEL               "mel"
+#define P_BARK              "bark"
+#define P_ERB               "erb"
+#define P_OCTAVE            "octave"
+#define P_BAR_ANALYSIS      "bar_analysis"
+#define P_FFT               "fft"
+#define P_IIR_OCTAVE        "iir_octave"
+#define P_IIR_THIRD_OCTAVE  "iir_third_octave"
+#define P_POWER_BANDS       "power_bands"
 
 #define P_RADIAL            "radial_layout"
 #define P_INVERT            "invert_direction"
@@ -62,8 +95,10 @@ static inline bool p_equ(const char *s1, const char *s2) { return std::strcmp(s1
 #define P_RADIAL_ROTATION   "radial_rotation"
 
 #define P_CAPS              "rounded_caps"
+#define P_AFTERGLOW         "afterglow"
 
 #define P_WINDOW            "window"
+#define P_BIN_WINDOW        "bin_window"
 #define P_HANN              "hann"
 #define P_HAMMING           "hamming"
 #define P_BLACKMAN          "blackman"
@@ -76,28 +111,49 @@ static inline bool p_equ(const char *s1, const char *s2) { return std::strcmp(s1
 #define P_AUTO_FFT_SIZE     "auto_fft_size"
 #define P_FFT_SIZE          "fft_size"
 
+#define P_STFT_HOP          "stft_hop"
+#define P_STFT_COMBINE      "stft_combine"
+#define P_PEAK              "peak"
+#define P_AVERAGE           "average"
+
+#define P_SLIDING_DFT       "sliding_dft"
+#define P_MULTIRES          "multires"
+#define P_DECIMATE          "decimate"
+#define P_BEAT_DETECTION    "beat_detection"
+
 #define P_CHANNEL_MODE      "channel_mode"
 #define P_MONO              "mono"
 #define P_STEREO            "stereo"
 #define P_SINGLE            "single"
+#define P_SURROUND          "surround"
+#define P_MID_SIDE          "mid_side"
 
 #define P_CHANNEL           "channel"
 
 #define P_CHANNEL_SPACING   "channel_spacing"
 
+#define P_DOWNMIX           "downmix_before_fft"
+
+#define P_CENTER_WEIGHT     "center_weight"
+#define P_LFE_WEIGHT        "lfe_weight"
+#define P_SURROUND_WEIGHT   "surround_weight"
+
 #define P_INTERP_MODE       "interp_mode"
 #define P_POINT             "point"
 #define P_LANCZOS           "lanczos"
 #define P_CATROM            "catmull_rom"
+#define P_CURVE_POINTS      "curve_points"
 
 #define P_FILTER_MODE       "filter_mode"
 #define P_FILTER_RADIUS     "filter_radius"
 #define P_GAUSS             "gauss"
+#define P_RECURSIVE_GAUSS   "recursive_gauss"
 
 #define P_CUTOFF_LOW        "cutoff_low"
 #define P_CUTOFF_HIGH       "cutoff_high"
 #define P_FLOOR             "floor"
 #define P_CEILING           "ceiling"
+#define P_AUTO_RANGE        "auto_range"
 #define P_SLOPE             "slope"
 #define P_ROLLOFF_Q         "rolloff_q"
 #define P_ROLLOFF_RATE      "rolloff_rate"
@@ -106,7 +162,10 @@ static inline bool p_equ(const char *s1, const char *s2) { return std::strcmp(s1
 #define P_TSMOOTHING        "temporal_smoothing"
 #define P_EXPAVG            "exp_moving_avg"
 #define P_TVEXPAVG          "tv_exp_moving_avg"
+#define P_POWEREXPAVG       "power_exp_moving_avg"
 #define P_FAST_PEAKS        "fast_peaks"
+#define P_HALF_HISTORY      "half_precision_history"
+#define P_DISPLAY_TSMOOTH   "display_resolution_smoothing"
 
 #define P_COLOR_BASE        "color_base"
 #define P_COLOR_MIDDLE      "color_middle"
@@ -122,17 +181,31 @@ static inline bool p_equ(const char *s1, const char *s2) { return std::strcmp(s1
 #define P_LEVEL_METER       "level_meter"
 #define P_STEPPED_METER     "stepped_level_meter"
 #define P_WAVEFORM          "waveform"
+#define P_SPECTROGRAM       "spectrogram"
+#define P_SCOPE             "scope"
+#define P_SCOPE_TRIGGER     "scope_trigger"
+#define P_VECTORSCOPE       "vectorscope"
+#define P_SCOPE_DECAY       "vectorscope_decay"
 
 #define P_RMS_MODE          "rms_mode"
+#define P_METER_CHANNELS    "meter_all_channels"
 #define P_METER_BUF         "meter_buf"
+#define P_LOUDNESS          "loudness"
+#define P_MOMENTARY         "momentary"
+#define P_SHORT_TERM        "short_term"
+#define P_TRUE_PEAK         "true_peak"
 
 #define P_BAR_WIDTH         "bar_width"
 #define P_BAR_GAP           "bar_gap"
 #define P_STEP_WIDTH        "step_width"
 #define P_STEP_GAP          "step_gap"
 #define P_MIN_BAR_HEIGHT    "min_bar_height"
+#define P_PEAK_HOLD         "peak_hold"
+#define P_PEAK_HOLD_TIME    "peak_hold_time"
+#define P_PEAK_FALL_RATE    "peak_fall_rate"
 
 #define P_AUDIO_SYNC_OFFSET "audio_sync_offset"
+#define P_LOW_LATENCY       "low_latency"
 
 // tooltip descriptions
 #define P_CHAN_DESC         "chan_desc"
@@ -142,16 +215,55 @@ static inline bool p_equ(const char *s1, const char *s2) { return std::strcmp(s1
 #define P_TEMPORAL_DESC     "temporal_desc"
 #define P_GRAVITY_DESC      "gravity_desc"
 #define P_FAST_PEAKS_DESC   "fast_peaks_desc"
+#define P_HALF_HISTORY_DESC "half_precision_history_desc"
+#define P_DISPLAY_TSMOOTH_DESC "display_resolution_smoothing_desc"
 #define P_INTERP_DESC       "interp_desc"
 #define P_FILTER_DESC       "filter_desc"
 #define P_SLOPE_DESC        "slope_desc"
 #define P_DEADZONE_DESC     "deadzone_desc"
 #define P_CAPS_DESC         "caps_desc"
+#define P_AFTERGLOW_DESC    "afterglow_desc"
 #define P_ROLLOFF_Q_DESC    "rolloff_q_desc"
 #define P_ROLLOFF_RATE_DESC "rolloff_rate_desc"
 #define P_VOLUME_NORM_DESC  "volume_normalization_desc"
 #define P_MIRROR_DESC       "mirror_desc"
+#define P_BAND_SCALE_DESC   "band_scale_desc"
+#define P_BAR_ANALYSIS_DESC "bar_analysis_desc"
+#define P_POWER_BANDS_DESC  "power_bands_desc"
 #define P_RADIAL_ARC_DESC   "radial_arc_desc"
 #define P_IGNORE_MUTE_DESC  "ignore_mute_desc"
+#define P_LOG_STATS_DESC    "log_stats_desc"
+#define P_LOG_LATENCY_DESC  "log_latency_desc"
+#define P_SHARED_MEMORY_DESC "shared_memory_name_desc"
+#define P_HEADLESS_DESC     "headless_desc"
+#define P_ENVELOPE_DESC     "envelope_signal_desc"
+#define P_AUTO_RANGE_DESC   "auto_range_desc"
+#define P_RECORD_PATH_DESC  "record_path_desc"
+#define P_CAPTURE_LOG_DESC  "capture_log_path_desc"
+#define P_ASYNC_ANALYSIS_DESC "async_analysis_desc"
+#define P_JOIN_ANALYSIS_DESC "join_analysis_desc"
+#define P_ANALYSIS_INTERVAL_DESC "analysis_interval_desc"
+#define P_PREVIEW_INTERVAL_DESC "preview_analysis_interval_desc"
+#define P_MIN_HOP_DESC      "min_analysis_hop_desc"
+#define P_CURVE_POINTS_DESC "curve_points_desc"
+#define P_SCOPE_TRIGGER_DESC "scope_trigger_desc"
+#define P_SCOPE_DECAY_DESC  "vectorscope_decay_desc"
+#define P_CPU_BUDGET_DESC   "cpu_budget_desc"
+#define P_SLEEP_TIMEOUT_DESC "sleep_timeout_desc"
+#define P_GPU_FFT_DESC      "gpu_fft_desc"
 #define P_LARGE_FFT_DESC    "large_fft_desc"
 #define P_AUDIO_SYNC_DESC   "audio_sync_desc"
+#define P_ANALYSIS_PARENT_DESC "analysis_parent_desc"
+#define P_PLAYBACK_DESC     "playback_path_desc"
+#define P_LOW_LATENCY_DESC  "low_latency_desc"
+#define P_DOWNMIX_DESC      "downmix_desc"
+#define P_SURROUND_DESC     "surround_desc"
+#define P_STFT_HOP_DESC     "stft_hop_desc"
+#define P_SLIDING_DFT_DESC  "sliding_dft_desc"
+#define P_BIN_WINDOW_DESC   "bin_window_desc"
+#define P_MULTIRES_DESC     "multires_desc"
+#define P_DECIMATE_DESC     "decimate_desc"
+#define P_BEAT_DETECTION_DESC "beat_detection_desc"
+#define P_PEAK_HOLD_DESC    "peak_hold_desc"
+#define P_LOUDNESS_DESC     "loudness_desc"
+#define P_METER_CHANNELS_DESC "meter_all_channels_desc"
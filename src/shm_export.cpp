@@ -0,0 +1,181 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "shm_export.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::atomic_ref<uint64_t>::is_always_lock_free, "readers in other processes need lock-free atomics");
+static_assert(sizeof(waveform_shm_frame) % 64 == 0);
+static_assert(offsetof(waveform_shm_header, frames) == 64);
+
+bool SharedMemoryExport::open(const std::string& name)
+{
+    close();
+    if(name.empty())
+        return false;
+
+    // both APIs take a flat name, anything unusual becomes an underscore
+    std::string flat = name;
+    std::transform(flat.begin(), flat.end(), flat.begin(), [](unsigned char c) {
+        return (std::isalnum(c) || (c == '_') || (c == '-') || (c == '.')) ? (char)c : '_';
+        });
+    const auto size = sizeof(waveform_shm_header);
+#ifdef _WIN32
+    const auto path = "Local\\" + flat;
+    const auto mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, path.c_str());
+    if(mapping == nullptr)
+    {
+        LogWarn << "Could not create shared memory \"" << path << "\"";
+        return false;
+    }
+    if(GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        LogWarn << "Shared memory \"" << path << "\" is already in use";
+        CloseHandle(mapping);
+        return false;
+    }
+    auto view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if(view == nullptr)
+    {
+        LogWarn << "Could not map shared memory \"" << path << "\"";
+        CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+#else
+    const auto path = "/" + flat;
+    auto fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if((fd < 0) && (errno == EEXIST))
+    {
+        // left behind by a crash, or another source with the same name, which then stops being read
+        LogWarn << "Replacing existing shared memory \"" << path << "\"";
+        shm_unlink(path.c_str());
+        fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if(fd < 0)
+    {
+        LogWarn << "Could not create shared memory \"" << path << "\": " << std::strerror(errno);
+        return false;
+    }
+    void *view = MAP_FAILED;
+    struct stat info = {};
+    if((ftruncate(fd, (off_t)size) == 0) && (fstat(fd, &info) == 0))
+        view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    m_inode = (uint64_t)info.st_ino;
+    if(view == MAP_FAILED)
+    {
+        LogWarn << "Could not map shared memory \"" << path << "\": " << std::strerror(errno);
+        shm_unlink(path.c_str());
+        return false;
+    }
+#endif
+
+    // fresh mappings are zeroed, readers wait for magic
+    m_header = static_cast<waveform_shm_header*>(view);
+    m_header->version = WAVEFORM_SHM_VERSION;
+    m_header->slots = WAVEFORM_SHM_SLOTS;
+    m_header->frame_size = sizeof(waveform_shm_frame);
+    std::atomic_ref(m_header->magic).store(WAVEFORM_SHM_MAGIC, std::memory_order_release);
+    m_name = name;
+    m_path = path;
+    LogInfo << "Exporting to shared memory \"" << path << "\"";
+    return true;
+}
+
+void SharedMemoryExport::close()
+{
+    if(m_header == nullptr)
+        return;
+    std::atomic_ref(m_header->magic).store(0, std::memory_order_release);
+#ifdef _WIN32
+    UnmapViewOfFile(m_header);
+    CloseHandle((HANDLE)m_mapping);
+    m_mapping = nullptr;
+#else
+    munmap(m_header, sizeof(waveform_shm_header));
+    // readers keep their mapping, the name goes unless somebody replaced it since
+    const auto fd = shm_open(m_path.c_str(), O_RDONLY, 0);
+    if(fd >= 0)
+    {
+        struct stat info = {};
+        const auto ours = (fstat(fd, &info) == 0) && ((uint64_t)info.st_ino == m_inode);
+        ::close(fd);
+        if(ours)
+            shm_unlink(m_path.c_str());
+    }
+#endif
+    m_header = nullptr;
+    m_name.clear();
+    m_path.clear();
+}
+
+void SharedMemoryExport::publish(const Frame& frame) noexcept
+{
+    if(m_header == nullptr)
+        return;
+    std::atomic_ref latest(m_header->latest);
+    const auto number = latest.load(std::memory_order_relaxed) + 1;
+    auto& slot = m_header->frames[number % WAVEFORM_SHM_SLOTS];
+
+    // sequence lock, odd while the values are inconsistent
+    std::atomic_ref seq(slot.seq);
+    const auto start = seq.load(std::memory_order_relaxed);
+    seq.store(start + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const auto channels = std::clamp(frame.channels, 1u, 2u);
+    const auto bins = std::min(frame.bin_count, (size_t)WAVEFORM_SHM_MAX_BINS);
+    const auto bands = std::min(frame.band_count, (size_t)WAVEFORM_SHM_MAX_BANDS);
+    slot.frame = number;
+    slot.audio_ts = frame.audio_ts;
+    slot.channels = channels;
+    slot.bin_count = (uint32_t)bins;
+    slot.first_bin = (uint32_t)frame.first_bin;
+    slot.bin_hz = frame.bin_hz;
+    slot.band_count = (uint32_t)bands;
+    slot.meter[0] = frame.meter[0];
+    slot.meter[1] = frame.meter[1];
+    for(auto channel = 0u; channel < channels; ++channel)
+    {
+        if((bins > 0) && (frame.bins[channel] != nullptr))
+            std::memcpy(slot.bins[channel], frame.bins[channel], bins * sizeof(float));
+        if((bands > 0) && (frame.bands[channel] != nullptr))
+            std::memcpy(slot.bands[channel], frame.bands[channel], bands * sizeof(float));
+    }
+    if((bands > 0) && (frame.band_hz != nullptr))
+        std::memcpy(slot.band_hz, frame.band_hz, bands * sizeof(float));
+
+    seq.store(start + 2, std::memory_order_release);
+    latest.store(number, std::memory_order_release);
+}
@@ -0,0 +1,69 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include "waveform_api.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Writer side of the waveform_shm_header mapping, see waveform_api.h.
+// Opened with a fixed capacity so readers never have to follow a resize.
+// One writer, open(), close() and publish() must not run concurrently.
+class SharedMemoryExport
+{
+public:
+    // one displayed frame, pointers are read during publish() only
+    struct Frame
+    {
+        uint64_t audio_ts = 0;
+        uint32_t channels = 1;
+        const float *bins[2]{};     // bin_count values per channel
+        size_t bin_count = 0;
+        size_t first_bin = 0;
+        float bin_hz = 0.0f;
+        const float *bands[2]{};    // band_count values per channel
+        const float *band_hz = nullptr;
+        size_t band_count = 0;
+        float meter[2]{};
+    };
+
+    SharedMemoryExport() = default;
+    ~SharedMemoryExport() { close(); }
+    SharedMemoryExport(const SharedMemoryExport&) = delete;
+    SharedMemoryExport& operator=(const SharedMemoryExport&) = delete;
+
+    // map name, replacing the current mapping, false and logged if it can't be created or is taken
+    bool open(const std::string& name);
+    void close();
+    bool is_open() const noexcept { return m_header != nullptr; }
+    const std::string& name() const noexcept { return m_name; }
+
+    // write the next slot, values beyond the slot capacity are cut off
+    void publish(const Frame& frame) noexcept;
+
+private:
+    waveform_shm_header *m_header = nullptr;
+    std::string m_name;
+    std::string m_path;         // os name of the mapping
+#ifdef _WIN32
+    void *m_mapping = nullptr;  // HANDLE
+#else
+    uint64_t m_inode = 0;       // of the object we created, m_path may have been replaced since
+#endif
+};
@@ -0,0 +1,157 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "sliding_dft.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+void SlidingDFT::init(std::size_t n, std::size_t first, std::size_t last, const std::vector<double>& taps)
+{
+    const auto half = n / 2;
+    const auto reach = taps.empty() ? 0 : taps.size() - 1;
+    m_n = n;
+    m_first = std::min(first, half);
+    m_last = std::clamp(last, m_first, half);
+    m_lo = (m_first > reach) ? m_first - reach : 0;
+    const auto hi = std::min(m_last + reach, half);
+    const auto bins = hi - m_lo + 1;
+    m_taps = taps.empty() ? std::vector<double>{ 1.0 } : taps;
+
+    m_re.assign(bins, 0.0);
+    m_im.assign(bins, 0.0);
+    m_wr.resize(bins);
+    m_wi.resize(bins);
+    for(std::size_t i = 0; i < bins; ++i)
+    {
+        const auto angle = (2.0 * std::numbers::pi * (double)(m_lo + i)) / (double)n;
+        m_wr[i] = std::cos(angle);
+        m_wi[i] = std::sin(angle);
+    }
+    m_history.assign(n, 0.0f);
+    m_delta.assign(n, 0.0);
+    m_pos = 0;
+    m_end = 0;
+    m_valid = false;
+}
+
+void SlidingDFT::recompute(const float *input)
+{
+    std::memcpy(m_history.data(), input, m_n * sizeof(float));
+    m_pos = 0;
+    for(std::size_t i = 0; i < m_re.size(); ++i)
+    {
+        // rotate a phasor instead of calling sin/cos per sample
+        const auto wr = m_wr[i];
+        const auto wi = -m_wi[i];
+        double pr = 1.0, pi = 0.0;
+        double re = 0.0, im = 0.0;
+        for(std::size_t m = 0; m < m_n; ++m)
+        {
+            re += input[m] * pr;
+            im += input[m] * pi;
+            const auto tmp = (pr * wr) - (pi * wi);
+            pi = (pr * wi) + (pi * wr);
+            pr = tmp;
+        }
+        m_re[i] = re;
+        m_im[i] = im;
+    }
+    m_valid = true;
+}
+
+void SlidingDFT::update(const float *input, uint64_t end)
+{
+    if(m_n == 0)
+        return;
+    if(m_valid && (end == m_end))
+        return;
+    if(!m_valid || (end < m_end) || ((end - m_end) >= m_n))
+    {
+        recompute(input);
+        m_end = end;
+        return;
+    }
+
+    // the d newest input samples enter the window, the d oldest leave it
+    const auto d = (std::size_t)(end - m_end);
+    const auto src = &input[m_n - d];
+    for(std::size_t i = 0; i < d; ++i)
+    {
+        auto& old = m_history[(m_pos + i) % m_n];
+        m_delta[i] = (double)src[i] - (double)old;
+        old = src[i];
+    }
+    m_pos = (m_pos + d) % m_n;
+
+    // X[k] = (X[k] + x[new] - x[old]) * e^(j 2 pi k / n)
+    const auto bins = m_re.size();
+    const auto re = m_re.data();
+    const auto im = m_im.data();
+    const auto wr = m_wr.data();
+    const auto wi = m_wi.data();
+    for(std::size_t i = 0; i < d; ++i)
+    {
+        const auto delta = m_delta[i];
+        for(std::size_t k = 0; k < bins; ++k)
+        {
+            const auto xr = re[k] + delta;
+            const auto xi = im[k];
+            re[k] = (xr * wr[k]) - (xi * wi[k]);
+            im[k] = (xr * wi[k]) + (xi * wr[k]);
+        }
+    }
+    m_end = end;
+}
+
+void SlidingDFT::output(fftwf_complex *out, std::size_t count) const
+{
+    std::memset(out, 0, count * sizeof(fftwf_complex));
+    if(!m_valid)
+        return;
+
+    // bins past either end of the state mirror around DC or nyquist as complex conjugates
+    const auto n = (int64_t)m_n;
+    const auto lo = (int64_t)m_lo;
+    const auto reach = (int64_t)m_taps.size() - 1;
+    const auto last = std::min(m_last, count - 1);
+    for(auto k = (int64_t)m_first; k <= (int64_t)last; ++k)
+    {
+        double re = 0.0, im = 0.0;
+        for(auto j = -reach; j <= reach; ++j)
+        {
+            auto idx = k + j;
+            auto sign = 1.0;
+            if(idx < 0)
+            {
+                idx = -idx;
+                sign = -1.0;
+            }
+            else if(idx > (n / 2))
+            {
+                idx = n - idx;
+                sign = -1.0;
+            }
+            const auto tap = m_taps[(std::size_t)std::abs(j)];
+            re += tap * m_re[(std::size_t)(idx - lo)];
+            im += tap * sign * m_im[(std::size_t)(idx - lo)];
+        }
+        out[k][0] = (float)re;
+        out[k][1] = (float)im;
+    }
+}
@@ -0,0 +1,62 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <fftw3.h>
+
+// Sliding DFT over a band of bins of an n point transform.
+// Each new sample costs O(bins) instead of a full FFT per frame, which wins when the band is narrow.
+// Cosine-sum windows are applied in the frequency domain as a short kernel over neighbouring bins.
+// State is kept in double precision so rounding error doesn't build up over long runs.
+class SlidingDFT
+{
+public:
+    // taps is the frequency domain kernel of a cosine-sum window, taps[0] weights the center bin
+    // and taps[j] both bins j away, e.g. { 0.5, -0.25 } for hann
+    // bins [first, last] are output, the state covers the kernel's reach on either side
+    void init(std::size_t n, std::size_t first, std::size_t last, const std::vector<double>& taps);
+    void reset() noexcept { m_valid = false; }
+    bool empty() const noexcept { return m_n == 0; }
+
+    // raw (unwindowed) input holds the newest n samples, ending at absolute sample position end
+    // slides forward from the last update when possible, otherwise recomputes from scratch
+    void update(const float *input, uint64_t end);
+
+    // windowed bins [0, count) into out, zero outside of the band
+    void output(fftwf_complex *out, std::size_t count) const;
+
+private:
+    void recompute(const float *input);
+
+    std::size_t m_n = 0;
+    std::size_t m_first = 0;        // output band
+    std::size_t m_last = 0;
+    std::size_t m_lo = 0;           // state band, the output band plus the kernel reach
+    std::vector<double> m_taps;     // frequency domain window kernel, symmetric about the center bin
+    std::vector<double> m_re;       // state, SoA so the per-sample update vectorizes across bins
+    std::vector<double> m_im;
+    std::vector<double> m_wr;       // per bin twiddle e^(j 2 pi k / n)
+    std::vector<double> m_wi;
+    std::vector<float> m_history;   // last n input samples, ring
+    std::vector<double> m_delta;    // new - old sample, per update
+    std::size_t m_pos = 0;          // oldest sample in m_history
+    uint64_t m_end = 0;
+    bool m_valid = false;
+};
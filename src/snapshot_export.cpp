@@ -0,0 +1,95 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "snapshot_export.hpp"
+#include <algorithm>
+
+struct SnapshotExport::Snapshot : waveform_snapshot
+{
+    std::atomic<int> refs = 0;
+    std::vector<float> data;    // channel values then frequencies
+};
+
+void SnapshotExport::release(const waveform_snapshot *snapshot)
+{
+    auto snap = static_cast<Snapshot*>(const_cast<waveform_snapshot*>(snapshot));
+    if(snap->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete snap;
+}
+
+void SnapshotExport::publish(uint32_t channels, std::size_t count, const float *const *values, const float *frequencies, uint64_t audio_ts)
+{
+    channels = std::clamp(channels, 1u, 2u);
+    auto snap = m_spare;
+    m_spare = nullptr;
+    if(snap == nullptr)
+        snap = new Snapshot();
+    snap->data.resize(count * (channels + 1));
+    for(auto channel = 0u; channel < channels; ++channel)
+        std::copy(values[channel], values[channel] + count, &snap->data[channel * count]);
+    std::copy(frequencies, frequencies + count, &snap->data[channels * count]);
+
+    snap->api_version = WAVEFORM_API_VERSION;
+    snap->channels = channels;
+    snap->sequence = ++m_sequence;
+    snap->audio_ts = audio_ts;
+    snap->count = count;
+    snap->values[0] = snap->data.data();
+    snap->values[1] = (channels > 1) ? &snap->data[count] : nullptr;
+    snap->frequencies = &snap->data[channels * count];
+    snap->release = &release;
+    snap->refs.store(1, std::memory_order_relaxed); // ours, as m_latest
+
+    Snapshot *old;
+    {
+        std::lock_guard lock(m_mtx);
+        old = m_latest;
+        m_latest = snap;
+    }
+
+    // recycle the old one if no consumer kept it, references are only taken from m_latest under the lock
+    if(old != nullptr)
+    {
+        if(old->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            m_spare = old;
+    }
+}
+
+void SnapshotExport::clear()
+{
+    Snapshot *old;
+    {
+        std::lock_guard lock(m_mtx);
+        old = m_latest;
+        m_latest = nullptr;
+    }
+    if(old != nullptr)
+        release(old);
+    delete m_spare;
+    m_spare = nullptr;
+}
+
+const waveform_snapshot *SnapshotExport::acquire()
+{
+    m_active.store(true, std::memory_order_relaxed);
+    std::lock_guard lock(m_mtx);
+    if(m_latest == nullptr)
+        return nullptr;
+    m_latest->refs.fetch_add(1, std::memory_order_relaxed);
+    return m_latest;
+}
@@ -0,0 +1,60 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include "waveform_api.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Publisher side of waveform_api.h, one per kind of snapshot a source exports.
+// Costs nothing until the first acquire(), from then on every publish() makes an immutable
+// refcounted snapshot. Consumers hold references, the newest is kept for the next acquire().
+// publish() and clear() are called from one thread at a time, acquire() from any.
+class SnapshotExport
+{
+public:
+    SnapshotExport() = default;
+    ~SnapshotExport() { clear(); }
+    SnapshotExport(const SnapshotExport&) = delete;
+    SnapshotExport& operator=(const SnapshotExport&) = delete;
+
+    // somebody asked for snapshots, publishing is wasted work otherwise
+    bool active() const noexcept { return m_active.load(std::memory_order_relaxed); }
+
+    // copy count values of each channel, frequencies in Hz
+    void publish(uint32_t channels, std::size_t count, const float *const *values, const float *frequencies, uint64_t audio_ts);
+
+    // forget the newest snapshot, e.g. when the source stops producing this kind
+    void clear();
+
+    // referenced newest snapshot or nullptr, the caller releases it through its release()
+    const waveform_snapshot *acquire();
+
+private:
+    struct Snapshot;
+    static void release(const waveform_snapshot *snapshot);
+
+    std::mutex m_mtx;               // m_latest and taking references to it
+    Snapshot *m_latest = nullptr;
+    Snapshot *m_spare = nullptr;    // previous snapshot nobody referenced anymore, publisher only
+    uint64_t m_sequence = 0;
+    std::atomic<bool> m_active = false;
+};
@@ -19,10 +19,16 @@
 #include "math_funcs.hpp"
 #include "source.hpp"
 #include "settings.hpp"
+#include "source_list.hpp"
+#include "analysis_worker.hpp"
+#include "denormal_guard.hpp"
+#include "kernel_tuning.hpp"
 #include "log.hpp"
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <bit>
+#include <cctype>
 #include <limits>
 #include <cassert>
 #include <numbers>
@@ -33,41 +39,188 @@
 
 #include "cpuinfo_x86.h"
 
-static const auto CPU_INFO = cpu_features::GetX86Info();
-const bool WAVSource::HAVE_AVX2 = CPU_INFO.features.avx2 && CPU_INFO.features.fma3;
-const bool WAVSource::HAVE_AVX = CPU_INFO.features.avx && CPU_INFO.features.fma3;
-const bool WAVSource::HAVE_FMA3 = CPU_INFO.features.fma3;
+// filled in by register_source(), nothing runs cpuid while the library is merely loaded
+bool WAVSource::HAVE_AVX512 = false;
+bool WAVSource::HAVE_AVX2 = false;
+bool WAVSource::HAVE_AVX = false;
+bool WAVSource::HAVE_FMA3 = false;
+bool WAVSource::HAVE_F16C = false;
+bool WAVSource::HAVE_AVX1 = false;
+bool WAVSource::HAVE_SSE41 = false;
 
 #endif // ENABLE_X86_SIMD
 
+#ifdef ENABLE_ARM_SIMD
+bool WAVSource::HAVE_NEON = true; // baseline on every ARM target we build for
+#endif // ENABLE_ARM_SIMD
+
 const float WAVSource::DB_MIN = 20.0f * std::log10(std::numeric_limits<float>::min());
 
 #ifndef HAVE_OBS_PROP_ALPHA
 #define obs_properties_add_color_alpha obs_properties_add_color
 #endif
 
-static bool enum_callback(void *data, obs_source_t *src)
+static void update_audio_info(obs_audio_info *info)
 {
-    if(obs_source_get_output_flags(src) & OBS_SOURCE_AUDIO) // filter sources without audio
-        static_cast<std::vector<std::string>*>(data)->push_back(obs_source_get_name(src));
-    return true;
+    if(!obs_get_audio_info(info))
+    {
+        LogWarn << "Could not determine audio configuration";
+        info->samples_per_sec = 44100;
+        info->speakers = SPEAKERS_UNKNOWN;
+    }
 }
 
-static std::vector<std::string> enumerate_audio_sources()
+static double get_video_fps()
 {
-    std::vector<std::string> ret;
-    obs_enum_sources(&enum_callback, &ret);
-    return ret;
+    obs_video_info vinfo = {};
+    if(obs_get_video_info(&vinfo) && (vinfo.fps_den > 0))
+        return double(vinfo.fps_num) / double(vinfo.fps_den);
+    return 60.0;
 }
 
-static void update_audio_info(obs_audio_info *info)
+// per channel weights for mixing a speaker layout down to mono
+// obs orders channels FL FR FC LFE RL RR SL SR, smaller layouts drop from that list
+// the front pair is averaged, everything else is scaled relative to it
+static void get_surround_weights(speaker_layout layout, float center, float lfe, float surround, float *weights)
 {
-    if(!obs_get_audio_info(info))
+    const auto front = 0.5f;
+    center *= front;
+    lfe *= front;
+    surround *= front;
+    switch(layout)
     {
-        LogWarn << "Could not determine audio configuration";
-        info->samples_per_sec = 44100;
-        info->speakers = SPEAKERS_UNKNOWN;
+    case SPEAKERS_MONO:
+        weights[0] = 1.0f;
+        break;
+    case SPEAKERS_2POINT1:
+        weights[0] = weights[1] = front;
+        weights[2] = lfe;
+        break;
+    case SPEAKERS_4POINT0:
+        weights[0] = weights[1] = front;
+        weights[2] = center;
+        weights[3] = surround;
+        break;
+    case SPEAKERS_4POINT1:
+        weights[0] = weights[1] = front;
+        weights[2] = center;
+        weights[3] = lfe;
+        weights[4] = surround;
+        break;
+    case SPEAKERS_5POINT1:
+        weights[0] = weights[1] = front;
+        weights[2] = center;
+        weights[3] = lfe;
+        weights[4] = weights[5] = surround;
+        break;
+    case SPEAKERS_7POINT1:
+        weights[0] = weights[1] = front;
+        weights[2] = center;
+        weights[3] = lfe;
+        weights[4] = weights[5] = weights[6] = weights[7] = surround;
+        break;
+    default:
+        weights[0] = weights[1] = front;
+        break;
+    }
+}
+
+// smallest multiple of 16 (so that N/2 is AVX aligned) at or above size that only has factors 2, 3, 5 and at most one 7
+static size_t get_fast_fft_size(size_t size)
+{
+    for(auto n = (size + 15) & -16; ; n += 16)
+    {
+        auto rem = n;
+        for(auto factor : { 2u, 3u, 5u })
+            while((rem % factor) == 0)
+                rem /= factor;
+        if((rem == 1) || (rem == 7))
+            return n;
+    }
+}
+
+// adds the time from construction to destruction to a CallCost, and to a Tracy plot in ms if given one
+class CostTimer
+{
+public:
+    CostTimer(CallCost& cost, uint64_t start, const char *plot = nullptr) : m_cost(cost), m_start(start), m_plot(plot) {}
+    ~CostTimer()
+    {
+        const auto ns = os_gettime_ns() - m_start;
+        m_cost.add(ns);
+        profile_plot(m_plot, (double)ns / 1e6);
+    }
+
+private:
+    CallCost& m_cost;
+    uint64_t m_start;
+    const char *m_plot;
+};
+
+// lock_guard that adds the time spent waiting for the mutex to a CallCost, which the mutex guards
+class TimedLock
+{
+public:
+    TimedLock(std::mutex& mtx, CallCost& wait, std::atomic<uint64_t>& contended, const char *plot = nullptr) : m_mtx(mtx)
+    {
+        const auto start = os_gettime_ns();
+        if(!m_mtx.try_lock())
+        {
+            HealthCounters::count(contended);
+            m_mtx.lock();
+        }
+        const auto ns = os_gettime_ns() - start;
+        wait.add(ns);
+        profile_plot(plot, (double)ns / 1e6);
     }
+    ~TimedLock() { m_mtx.unlock(); }
+    TimedLock(const TimedLock&) = delete;
+    TimedLock& operator=(const TimedLock&) = delete;
+
+private:
+    std::mutex& m_mtx;
+};
+
+// the right half of a mirrored axis repeats the left, see InterpLayout
+static void mirror_points(float *buf, size_t count)
+{
+    const auto half = count / 2;
+    for(auto i = half + 1; i < count; ++i)
+        buf[i] = buf[half - (i - half)];
+}
+
+// structural rebuilds handed out per video frame, shared by every source
+// a template pushed to many sources at once then spreads over a few frames instead of freezing one
+static bool claim_rebuild(unsigned int limit)
+{
+    static std::mutex mtx;
+    static uint64_t frame = 0;
+    static unsigned int claimed = 0;
+    std::lock_guard lock(mtx);
+    const auto now = obs_get_video_frame_time();
+    if(now != frame)
+    {
+        frame = now;
+        claimed = 0;
+    }
+    if(claimed >= limit)
+        return false;
+    ++claimed;
+    return true;
+}
+
+// scale the contents of the current render target by keep, a solid quad's alpha as the blend factor
+static void fade_target(uint32_t width, uint32_t height, float keep)
+{
+    auto solid = obs_get_base_effect(OBS_EFFECT_SOLID);
+    vec4 color;
+    vec4_set(&color, 0.0f, 0.0f, 0.0f, keep);
+    gs_effect_set_vec4(gs_effect_get_param_by_name(solid, "color"), &color);
+    gs_blend_state_push();
+    gs_blend_function(GS_BLEND_ZERO, GS_BLEND_SRCALPHA);
+    while(gs_effect_loop(solid, "Solid"))
+        gs_draw_sprite(nullptr, 0, width, height);
+    gs_blend_state_pop();
 }
 
 // hide and disable a property
@@ -77,6 +230,15 @@ static inline void set_prop_visible(obs_properties_t *props, const char *prop_na
     obs_property_set_visible(obs_properties_get(props, prop_name), vis);
 }
 
+// the auto range follows the CPU spectrum, which a GPU curve never fills
+static bool auto_range_visible(obs_data_t *settings)
+{
+    const auto disp = obs_data_get_string(settings, P_DISPLAY_MODE);
+    if(p_equ(disp, P_WAVEFORM) || p_equ(disp, P_SCOPE) || p_equ(disp, P_VECTORSCOPE))
+        return false;
+    return !(p_equ(disp, P_CURVE) && obs_data_get_bool(settings, P_GPU_FFT));
+}
+
 // Callbacks for obs_source_info structure
 namespace callbacks {
     static const char *get_name([[maybe_unused]] void *data)
@@ -84,20 +246,65 @@ namespace callbacks {
         return T("source_name");
     }
 
+    static void get_capture_stats(void *data, calldata_t *cd)
+    {
+        static_cast<WAVSource*>(data)->get_capture_stats(cd);
+    }
+
+    static void get_stats(void *data, calldata_t *cd)
+    {
+        static_cast<WAVSource*>(data)->get_stats(cd);
+    }
+
+    static void get_health(void *data, calldata_t *cd)
+    {
+        static_cast<WAVSource*>(data)->get_health(cd);
+    }
+
+    static void get_spectrum(void *data, calldata_t *cd)
+    {
+        static_cast<WAVSource*>(data)->get_spectrum(cd);
+    }
+
+    static void get_bands(void *data, calldata_t *cd)
+    {
+        static_cast<WAVSource*>(data)->get_bands(cd);
+    }
+
+    static void get_meter(void *data, calldata_t *cd)
+    {
+        static_cast<WAVSource*>(data)->get_meter(cd);
+    }
+
+    static void get_beat(void *data, calldata_t *cd)
+    {
+        static_cast<WAVSource*>(data)->get_beat(cd);
+    }
+
+    static void get_frame_times(void *data, calldata_t *cd)
+    {
+        static_cast<WAVSource*>(data)->get_frame_times(cd);
+    }
+
+    static void reset_frame_times(void *data, [[maybe_unused]] calldata_t *cd)
+    {
+        static_cast<WAVSource*>(data)->reset_frame_times();
+    }
+
     static void *create(obs_data_t *settings, obs_source_t *source)
     {
-#ifdef ENABLE_X86_SIMD
-        WAVSource *obj;
-        if(WAVSource::HAVE_AVX2)
-            obj = new WAVSourceAVX2(source);
-        else if(WAVSource::HAVE_AVX)
-            obj = new WAVSourceAVX(source);
-        else
-            obj = new WAVSourceGeneric(source);
-#else
-        WAVSource *obj = new WAVSourceGeneric(source);
-#endif // ENABLE_X86_SIMD
-        obj->update(settings); // must be fully constructed before calling update()
+        auto obj = new WAVSource(source); // the instruction set is in DSPKernels
+        obj->defer_update(settings); // must be fully constructed before calling update()
+        proc_handler_add(obs_source_get_proc_handler(source), "void get_capture_stats(out int blocks, out int truncated_samples, out int overrun_samples)", &get_capture_stats, obj);
+        proc_handler_add(obs_source_get_proc_handler(source), "void get_stats(out int bytes, out float tick_ms, out float tick_max_ms, out float render_ms, out float render_max_ms)", &get_stats, obj);
+        proc_handler_add(obs_source_get_proc_handler(source), "void get_frame_times(out string json)", &get_frame_times, obj);
+        proc_handler_add(obs_source_get_proc_handler(source), "void get_health(out int overflows, out int underruns, out int resyncs, out int contended)", &get_health, obj);
+        proc_handler_add(obs_source_get_proc_handler(source), "void get_spectrum(out ptr snapshot)", &get_spectrum, obj);
+        proc_handler_add(obs_source_get_proc_handler(source), "void get_bands(out ptr snapshot)", &get_bands, obj);
+        proc_handler_add(obs_source_get_proc_handler(source), "void get_meter(out float left, out float right, out int audio_ts)", &get_meter, obj);
+        proc_handler_add(obs_source_get_proc_handler(source), "void get_beat(out bool enabled, out float bpm, out float confidence, out float strength, out int beats, out int onsets, out int audio_ts)", &get_beat, obj);
+        proc_handler_add(obs_source_get_proc_handler(source), "void reset_frame_times()", &reset_frame_times, obj);
+        signal_handler_add(obs_source_get_signal_handler(source), "void envelope(ptr source, float level, float db, ptr bands, int count, int audio_ts)");
         return static_cast<void*>(obj);
     }
 
@@ -119,11 +326,18 @@ namespace callbacks {
     static void get_defaults(obs_data_t *settings)
     {
         obs_data_set_default_string(settings, P_AUDIO_SRC, P_NONE);
+        obs_data_set_default_string(settings, P_AUDIO_SRC_UUID, "");
+        obs_data_set_default_string(settings, P_ANALYSIS_PARENT, P_NONE);
+        obs_data_set_default_string(settings, P_PLAYBACK, "");
+        obs_data_set_default_int(settings, P_PLAYBACK_OFFSET, 0);
         obs_data_set_default_string(settings, P_DISPLAY_MODE, P_CURVE);
         obs_data_set_default_int(settings, P_WIDTH, 800);
         obs_data_set_default_int(settings, P_HEIGHT, 225);
         obs_data_set_default_bool(settings, P_LOG_SCALE, true);
         obs_data_set_default_bool(settings, P_MIRROR_FREQ_AXIS, false);
+        obs_data_set_default_string(settings, P_BAND_SCALE, P_NONE);
+        obs_data_set_default_string(settings, P_BAR_ANALYSIS, P_FFT);
+        obs_data_set_default_bool(settings, P_POWER_BANDS, false);
         obs_data_set_default_bool(settings, P_RADIAL, false);
         obs_data_set_default_bool(settings, P_INVERT, false);
         obs_data_set_default_double(settings, P_DEADZONE, 20.0);
@@ -133,21 +347,36 @@ namespace callbacks {
         obs_data_set_default_string(settings, P_CHANNEL_MODE, P_MONO);
         obs_data_set_default_int(settings, P_CHANNEL, 0);
         obs_data_set_default_int(settings, P_CHANNEL_SPACING, 0);
+        obs_data_set_default_bool(settings, P_DOWNMIX, false);
+        obs_data_set_default_double(settings, P_CENTER_WEIGHT, 0.707);
+        obs_data_set_default_double(settings, P_LFE_WEIGHT, 0.0);
+        obs_data_set_default_double(settings, P_SURROUND_WEIGHT, 0.707);
         obs_data_set_default_int(settings, P_FFT_SIZE, 4096);
         obs_data_set_default_bool(settings, P_AUTO_FFT_SIZE, false);
         obs_data_set_default_bool(settings, P_ENABLE_LARGE_FFT, false);
+        obs_data_set_default_int(settings, P_STFT_HOP, 0);
+        obs_data_set_default_string(settings, P_STFT_COMBINE, P_PEAK);
+        obs_data_set_default_bool(settings, P_SLIDING_DFT, false);
+        obs_data_set_default_bool(settings, P_MULTIRES, false);
+        obs_data_set_default_bool(settings, P_DECIMATE, false);
+        obs_data_set_default_bool(settings, P_BEAT_DETECTION, false);
         obs_data_set_default_string(settings, P_WINDOW, P_HANN);
+        obs_data_set_default_bool(settings, P_BIN_WINDOW, false);
         obs_data_set_default_int(settings, P_SINE_EXPONENT, 2);
         obs_data_set_default_string(settings, P_INTERP_MODE, P_CATROM);
+        obs_data_set_default_int(settings, P_CURVE_POINTS, 0);
         obs_data_set_default_string(settings, P_FILTER_MODE, P_NONE);
         obs_data_set_default_double(settings, P_FILTER_RADIUS, 1.5);
         obs_data_set_default_string(settings, P_TSMOOTHING, P_EXPAVG);
         obs_data_set_default_double(settings, P_GRAVITY, 0.65);
         obs_data_set_default_bool(settings, P_FAST_PEAKS, false);
+        obs_data_set_default_bool(settings, P_HALF_HISTORY, false);
+        obs_data_set_default_bool(settings, P_DISPLAY_TSMOOTH, false);
         obs_data_set_default_int(settings, P_CUTOFF_LOW, 30);
         obs_data_set_default_int(settings, P_CUTOFF_HIGH, 17500);
         obs_data_set_default_int(settings, P_FLOOR, -65);
         obs_data_set_default_int(settings, P_CEILING, 0);
+        obs_data_set_default_bool(settings, P_AUTO_RANGE, false);
         obs_data_set_default_double(settings, P_SLOPE, 0.0);
         obs_data_set_default_double(settings, P_ROLLOFF_Q, 0.0);
         obs_data_set_default_double(settings, P_ROLLOFF_RATE, 0.0);
@@ -163,14 +392,41 @@ namespace callbacks {
         obs_data_set_default_int(settings, P_STEP_WIDTH, 8);
         obs_data_set_default_int(settings, P_STEP_GAP, 4);
         obs_data_set_default_int(settings, P_MIN_BAR_HEIGHT, 0);
+        obs_data_set_default_bool(settings, P_PEAK_HOLD, false);
+        obs_data_set_default_int(settings, P_PEAK_HOLD_TIME, 1000);
+        obs_data_set_default_double(settings, P_PEAK_FALL_RATE, 20.0);
         obs_data_set_default_int(settings, P_METER_BUF, 150);
+        obs_data_set_default_double(settings, P_SCOPE_TRIGGER, 0.0);
+        obs_data_set_default_int(settings, P_SCOPE_DECAY, 200);
+        obs_data_set_default_int(settings, P_AFTERGLOW, 0);
         obs_data_set_default_bool(settings, P_RMS_MODE, true);
+        obs_data_set_default_bool(settings, P_METER_CHANNELS, false);
+        obs_data_set_default_string(settings, P_LOUDNESS, P_NONE);
         obs_data_set_default_bool(settings, P_HIDE_SILENT, false);
         obs_data_set_default_bool(settings, P_IGNORE_MUTE, false);
+        obs_data_set_default_bool(settings, P_LOG_STATS, false);
+        obs_data_set_default_bool(settings, P_LOG_LATENCY, false);
+        obs_data_set_default_string(settings, P_SHARED_MEMORY, "");
+        obs_data_set_default_string(settings, P_RECORD_PATH, "");
+        obs_data_set_default_string(settings, P_CAPTURE_LOG, "");
+        obs_data_set_default_bool(settings, P_ENVELOPE, false);
+        obs_data_set_default_int(settings, P_ENVELOPE_ATTACK, 10);
+        obs_data_set_default_int(settings, P_ENVELOPE_RELEASE, 300);
+        obs_data_set_default_bool(settings, P_HEADLESS, false);
+        obs_data_set_default_bool(settings, P_ASYNC_ANALYSIS, true);
+        obs_data_set_default_bool(settings, P_JOIN_ANALYSIS, true);
+        obs_data_set_default_int(settings, P_ANALYSIS_INTERVAL, 1);
+        obs_data_set_default_int(settings, P_PREVIEW_INTERVAL, 1);
+        obs_data_set_default_int(settings, P_MIN_HOP, 512);
+        obs_data_set_default_double(settings, P_CPU_BUDGET, 0.0);
+        obs_data_set_default_int(settings, P_SLEEP_TIMEOUT, 0);
+        obs_data_set_default_bool(settings, P_GPU_FFT, false);
+        obs_data_set_default_int(settings, P_OUTPUT_TRACK, 1);
         obs_data_set_default_bool(settings, P_NORMALIZE_VOLUME, false);
         obs_data_set_default_int(settings, P_VOLUME_TARGET, -8);
         obs_data_set_default_int(settings, P_MAX_GAIN, 30);
         obs_data_set_default_int(settings, P_AUDIO_SYNC_OFFSET, 0);
+        obs_data_set_default_bool(settings, P_LOW_LATENCY, false);
     }
 
     static obs_properties_t *get_properties([[maybe_unused]] void *data)
@@ -184,17 +440,58 @@ namespace callbacks {
         obs_property_set_modified_callback(srclist, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
             auto src = obs_data_get_string(settings, P_AUDIO_SRC);
             auto enable = (src == nullptr) || !p_equ(src, P_OUTPUT_BUS);
+
+            // bind by UUID, a name no source has any more is the bound source after a rename
+            if((src == nullptr) || p_equ(src, P_NONE) || p_equ(src, P_OUTPUT_BUS))
+                obs_data_set_string(settings, P_AUDIO_SRC_UUID, "");
+            else if(auto uuid = AudioSourceList::uuid_of(src); !uuid.empty())
+                obs_data_set_string(settings, P_AUDIO_SRC_UUID, uuid.c_str());
+            else if(auto name = AudioSourceList::name_of(obs_data_get_string(settings, P_AUDIO_SRC_UUID)); !name.empty())
+                obs_data_set_string(settings, P_AUDIO_SRC, name.c_str());
             set_prop_visible(props, P_IGNORE_MUTE, enable);
+            set_prop_visible(props, P_OUTPUT_TRACK, !enable);
             return true;
             });
 
-        for(const auto& str : enumerate_audio_sources())
+        for(const auto& str : AudioSourceList::names())
             obs_property_list_add_string(srclist, str.c_str(), str.c_str());
 
+        // output bus mix track
+        obs_properties_add_int(props, P_OUTPUT_TRACK, T(P_OUTPUT_TRACK), 1, MAX_AUDIO_MIXES, 1);
+
+        // view of another waveform source, every one but this
+        auto parentlist = obs_properties_add_list(props, P_ANALYSIS_PARENT, T(P_ANALYSIS_PARENT), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+        obs_property_list_add_string(parentlist, T(P_NONE), P_NONE);
+        obs_property_set_long_description(parentlist, T(P_ANALYSIS_PARENT_DESC));
+        struct ParentList
+        {
+            obs_property_t *list;
+            void *self;
+        } parents{ parentlist, data };
+        obs_enum_sources([](void *param, obs_source_t *src) {
+            const auto& p = *static_cast<ParentList*>(param);
+            const auto id = obs_source_get_unversioned_id(src);
+            if((id != nullptr) && p_equ(id, WAVSource::SOURCE_ID) && (obs_obj_get_data(src) != p.self))
+                obs_property_list_add_string(p.list, obs_source_get_name(src), obs_source_get_name(src));
+            return true;
+            }, &parents);
+
+        // recorded analysis, played as a view
+        auto playback = obs_properties_add_path(props, P_PLAYBACK, T(P_PLAYBACK), OBS_PATH_FILE, "Waveform recording (*.wfr)", nullptr);
+        obs_property_set_long_description(playback, T(P_PLAYBACK_DESC));
+        auto playback_offset = obs_properties_add_int_slider(props, P_PLAYBACK_OFFSET, T(P_PLAYBACK_OFFSET), -WAVSource::MAX_SYNC_OFFSET, WAVSource::MAX_SYNC_OFFSET, 10);
+        obs_property_int_set_suffix(playback_offset, " ms");
+
         // audio sync
-        auto audio_sync = obs_properties_add_int_slider(props, P_AUDIO_SYNC_OFFSET, T(P_AUDIO_SYNC_OFFSET), -1000, 1000, 10);
+        auto audio_sync = obs_properties_add_int_slider(props, P_AUDIO_SYNC_OFFSET, T(P_AUDIO_SYNC_OFFSET), -WAVSource::MAX_SYNC_OFFSET, WAVSource::MAX_SYNC_OFFSET, 10);
         obs_property_int_set_suffix(audio_sync, " ms");
         obs_property_set_long_description(audio_sync, T(P_AUDIO_SYNC_DESC));
+        auto low_latency = obs_properties_add_bool(props, P_LOW_LATENCY, T(P_LOW_LATENCY));
+        obs_property_set_long_description(low_latency, T(P_LOW_LATENCY_DESC));
+        obs_property_set_modified_callback(low_latency, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
+            set_prop_visible(props, P_AUDIO_SYNC_OFFSET, !obs_data_get_bool(settings, P_LOW_LATENCY));
+            return true;
+            });
 
         // hide on silent audio
         obs_properties_add_bool(props, P_HIDE_SILENT, T(P_HIDE_SILENT));
@@ -203,6 +500,59 @@ namespace callbacks {
         auto ignore_mute = obs_properties_add_bool(props, P_IGNORE_MUTE, T(P_IGNORE_MUTE));
         obs_property_set_long_description(ignore_mute, T(P_IGNORE_MUTE_DESC));
 
+        // accounting
+        auto log_stats = obs_properties_add_bool(props, P_LOG_STATS, T(P_LOG_STATS));
+        obs_property_set_long_description(log_stats, T(P_LOG_STATS_DESC));
+        auto log_latency = obs_properties_add_bool(props, P_LOG_LATENCY, T(P_LOG_LATENCY));
+        obs_property_set_long_description(log_latency, T(P_LOG_LATENCY_DESC));
+        auto shm = obs_properties_add_text(props, P_SHARED_MEMORY, T(P_SHARED_MEMORY), OBS_TEXT_DEFAULT);
+        obs_property_set_long_description(shm, T(P_SHARED_MEMORY_DESC));
+        auto record = obs_properties_add_path(props, P_RECORD_PATH, T(P_RECORD_PATH), OBS_PATH_FILE_SAVE, "Waveform recording (*.wfr)", nullptr);
+        obs_property_set_long_description(record, T(P_RECORD_PATH_DESC));
+        auto capture_log = obs_properties_add_path(props, P_CAPTURE_LOG, T(P_CAPTURE_LOG), OBS_PATH_FILE_SAVE, "Capture log (*.wcap)", nullptr);
+        obs_property_set_long_description(capture_log, T(P_CAPTURE_LOG_DESC));
+        auto envelope = obs_properties_add_bool(props, P_ENVELOPE, T(P_ENVELOPE));
+        obs_property_set_long_description(envelope, T(P_ENVELOPE_DESC));
+        auto attack = obs_properties_add_int_slider(props, P_ENVELOPE_ATTACK, T(P_ENVELOPE_ATTACK), 0, 1000, 1);
+        auto release = obs_properties_add_int_slider(props, P_ENVELOPE_RELEASE, T(P_ENVELOPE_RELEASE), 0, 5000, 10);
+        obs_property_int_set_suffix(attack, " ms");
+        obs_property_int_set_suffix(release, " ms");
+        obs_property_set_modified_callback(envelope, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
+            const auto enable = obs_data_get_bool(settings, P_ENVELOPE);
+            set_prop_visible(props, P_ENVELOPE_ATTACK, enable);
+            set_prop_visible(props, P_ENVELOPE_RELEASE, enable);
+            return true;
+            });
+        auto headless = obs_properties_add_bool(props, P_HEADLESS, T(P_HEADLESS));
+        obs_property_set_long_description(headless, T(P_HEADLESS_DESC));
+        auto async = obs_properties_add_bool(props, P_ASYNC_ANALYSIS, T(P_ASYNC_ANALYSIS));
+        obs_property_set_long_description(async, T(P_ASYNC_ANALYSIS_DESC));
+        auto join = obs_properties_add_bool(props, P_JOIN_ANALYSIS, T(P_JOIN_ANALYSIS));
+        obs_property_set_long_description(join, T(P_JOIN_ANALYSIS_DESC));
+        obs_property_set_modified_callback(async, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
+            set_prop_visible(props, P_JOIN_ANALYSIS, obs_data_get_bool(settings, P_ASYNC_ANALYSIS));
+            return true;
+            });
+        auto interval = obs_properties_add_int_slider(props, P_ANALYSIS_INTERVAL, T(P_ANALYSIS_INTERVAL), 1, WAVSource::MAX_ANALYSIS_INTERVAL, 1);
+        obs_property_set_long_description(interval, T(P_ANALYSIS_INTERVAL_DESC));
+        auto preview = obs_properties_add_int_slider(props, P_PREVIEW_INTERVAL, T(P_PREVIEW_INTERVAL), 1, WAVSource::MAX_ANALYSIS_INTERVAL, 1);
+        obs_property_set_long_description(preview, T(P_PREVIEW_INTERVAL_DESC));
+        auto minhop = obs_properties_add_int_slider(props, P_MIN_HOP, T(P_MIN_HOP), 0, 4096, 32);
+        obs_property_int_set_suffix(minhop, " samples");
+        obs_property_set_long_description(minhop, T(P_MIN_HOP_DESC));
+        auto budget = obs_properties_add_float_slider(props, P_CPU_BUDGET, T(P_CPU_BUDGET), 0.0, 10.0, 0.05);
+        obs_property_float_set_suffix(budget, " ms");
+        obs_property_set_long_description(budget, T(P_CPU_BUDGET_DESC));
+        auto sleep = obs_properties_add_int_slider(props, P_SLEEP_TIMEOUT, T(P_SLEEP_TIMEOUT), 0, 3600, 10);
+        obs_property_int_set_suffix(sleep, " s");
+        obs_property_set_long_description(sleep, T(P_SLEEP_TIMEOUT_DESC));
+        auto gpu_fft = obs_properties_add_bool(props, P_GPU_FFT, T(P_GPU_FFT));
+        obs_property_set_long_description(gpu_fft, T(P_GPU_FFT_DESC));
+        obs_property_set_modified_callback(gpu_fft, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
+            set_prop_visible(props, P_AUTO_RANGE, auto_range_visible(settings));
+            return true;
+            });
+
         // volume normalization
         auto vol = obs_properties_add_bool(props, P_NORMALIZE_VOLUME, T(P_NORMALIZE_VOLUME));
         auto target = obs_properties_add_int_slider(props, P_VOLUME_TARGET, T(P_VOLUME_TARGET), -60, 0, 1);
@@ -225,11 +575,26 @@ namespace callbacks {
         obs_property_list_add_string(displaylist, T(P_LEVEL_METER), P_LEVEL_METER);
         obs_property_list_add_string(displaylist, T(P_STEPPED_METER), P_STEPPED_METER);
         obs_property_list_add_string(displaylist, T(P_WAVEFORM), P_WAVEFORM);
+        obs_property_list_add_string(displaylist, T(P_SPECTROGRAM), P_SPECTROGRAM);
+        obs_property_list_add_string(displaylist, T(P_SCOPE), P_SCOPE);
+        obs_property_list_add_string(displaylist, T(P_VECTORSCOPE), P_VECTORSCOPE);
         obs_properties_add_int(props, P_BAR_WIDTH, T(P_BAR_WIDTH), 1, 256, 1);
         obs_properties_add_int(props, P_BAR_GAP, T(P_BAR_GAP), 0, 256, 1);
         obs_properties_add_int(props, P_STEP_WIDTH, T(P_STEP_WIDTH), 1, 256, 1);
         obs_properties_add_int(props, P_STEP_GAP, T(P_STEP_GAP), 0, 256, 1);
         obs_properties_add_int(props, P_MIN_BAR_HEIGHT, T(P_MIN_BAR_HEIGHT), 0, 1080, 1);
+        auto peak_hold = obs_properties_add_bool(props, P_PEAK_HOLD, T(P_PEAK_HOLD));
+        auto hold_time = obs_properties_add_int_slider(props, P_PEAK_HOLD_TIME, T(P_PEAK_HOLD_TIME), 0, 10000, 10);
+        auto fall_rate = obs_properties_add_float_slider(props, P_PEAK_FALL_RATE, T(P_PEAK_FALL_RATE), 0.0, 200.0, 0.1);
+        obs_property_int_set_suffix(hold_time, " ms");
+        obs_property_float_set_suffix(fall_rate, " dB/s");
+        obs_property_set_long_description(peak_hold, T(P_PEAK_HOLD_DESC));
+        obs_property_set_modified_callback(peak_hold, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
+            auto enable = obs_data_get_bool(settings, P_PEAK_HOLD) && obs_property_visible(obs_properties_get(props, P_PEAK_HOLD));
+            set_prop_visible(props, P_PEAK_HOLD_TIME, enable);
+            set_prop_visible(props, P_PEAK_FALL_RATE, enable);
+            return true;
+            });
         obs_property_set_modified_callback(displaylist, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
             auto disp = obs_data_get_string(settings, P_DISPLAY_MODE);
             auto meter = p_equ(disp, P_LEVEL_METER);
@@ -237,12 +602,19 @@ namespace callbacks {
             auto bar = p_equ(disp, P_BARS) || meter;
             auto step = p_equ(disp, P_STEP_BARS) || step_meter;
             auto curve = p_equ(disp, P_CURVE);
-            auto waveform = p_equ(disp, P_WAVEFORM);
+            auto scope = p_equ(disp, P_SCOPE);
+            auto vectorscope = p_equ(disp, P_VECTORSCOPE); // points of both channels, no curve or bars
+            auto waveform = p_equ(disp, P_WAVEFORM) || scope || vectorscope; // time domain, nothing of the spectrum applies
+            auto spectrogram = p_equ(disp, P_SPECTROGRAM);
             set_prop_visible(props, P_BAR_WIDTH, bar || step);
             set_prop_visible(props, P_BAR_GAP, bar || step);
             set_prop_visible(props, P_STEP_WIDTH, step);
             set_prop_visible(props, P_STEP_GAP, step);
             set_prop_visible(props, P_MIN_BAR_HEIGHT, bar || step);
+            auto peaks = p_equ(disp, P_BARS) || p_equ(disp, P_STEP_BARS);
+            set_prop_visible(props, P_PEAK_HOLD, peaks);
+            set_prop_visible(props, P_PEAK_HOLD_TIME, peaks && obs_data_get_bool(settings, P_PEAK_HOLD));
+            set_prop_visible(props, P_PEAK_FALL_RATE, peaks && obs_data_get_bool(settings, P_PEAK_HOLD));
             set_prop_visible(props, P_CAPS, bar);
             obs_property_list_item_disable(obs_properties_get(props, P_RENDER_MODE), 0, !curve && !waveform);
             obs_property_list_item_disable(obs_properties_get(props, P_PULSE_MODE), 1, !curve && !p_equ(disp, P_BARS) && !p_equ(disp, P_STEP_BARS));
@@ -254,31 +626,63 @@ namespace callbacks {
             set_prop_visible(props, P_ROLLOFF_RATE, notmeter && !waveform);
             set_prop_visible(props, P_CUTOFF_LOW, notmeter && !waveform);
             set_prop_visible(props, P_CUTOFF_HIGH, notmeter && !waveform);
-            set_prop_visible(props, P_FILTER_MODE, notmeter);
-            set_prop_visible(props, P_FILTER_RADIUS, notmeter && !p_equ(obs_data_get_string(settings, P_FILTER_MODE), P_NONE));
-            set_prop_visible(props, P_INTERP_MODE, notmeter);
-            set_prop_visible(props, P_CHANNEL_MODE, notmeter);
-            set_prop_visible(props, P_CHANNEL, notmeter && p_equ(obs_data_get_string(settings, P_CHANNEL_MODE), P_SINGLE));
-            set_prop_visible(props, P_CHANNEL_SPACING, notmeter && p_equ(obs_data_get_string(settings, P_CHANNEL_MODE), P_STEREO));
+            set_prop_visible(props, P_FILTER_MODE, notmeter && !vectorscope);
+            set_prop_visible(props, P_FILTER_RADIUS, notmeter && !vectorscope && !p_equ(obs_data_get_string(settings, P_FILTER_MODE), P_NONE));
+            set_prop_visible(props, P_INTERP_MODE, notmeter && !vectorscope);
+            set_prop_visible(props, P_CURVE_POINTS, curve);
+            set_prop_visible(props, P_CHANNEL_MODE, notmeter && !vectorscope);
+            set_prop_visible(props, P_CHANNEL, notmeter && !vectorscope && p_equ(obs_data_get_string(settings, P_CHANNEL_MODE), P_SINGLE));
+            set_prop_visible(props, P_CHANNEL_SPACING, notmeter && !spectrogram && !vectorscope && (p_equ(obs_data_get_string(settings, P_CHANNEL_MODE), P_STEREO) || p_equ(obs_data_get_string(settings, P_CHANNEL_MODE), P_MID_SIDE)));
+            set_prop_visible(props, P_DOWNMIX, notmeter && !waveform && p_equ(obs_data_get_string(settings, P_CHANNEL_MODE), P_MONO));
+            auto surround = notmeter && !waveform && p_equ(obs_data_get_string(settings, P_CHANNEL_MODE), P_SURROUND);
+            set_prop_visible(props, P_CENTER_WEIGHT, surround);
+            set_prop_visible(props, P_LFE_WEIGHT, surround);
+            set_prop_visible(props, P_SURROUND_WEIGHT, surround);
+            obs_property_list_item_disable(obs_properties_get(props, P_CHANNEL_MODE), 3, waveform);
             set_prop_visible(props, P_WINDOW, notmeter && !waveform);
+            set_prop_visible(props, P_BIN_WINDOW, notmeter && !waveform);
             set_prop_visible(props, P_SINE_EXPONENT, notmeter && !waveform && p_equ(obs_data_get_string(settings, P_WINDOW), P_POWER_OF_SINE));
             set_prop_visible(props, P_TSMOOTHING, !waveform);
             set_prop_visible(props, P_GRAVITY, !waveform && !p_equ(obs_data_get_string(settings, P_TSMOOTHING), P_NONE));
             set_prop_visible(props, P_FAST_PEAKS, !waveform && !p_equ(obs_data_get_string(settings, P_TSMOOTHING), P_NONE));
-            set_prop_visible(props, P_RADIAL, notmeter);
-            set_prop_visible(props, P_DEADZONE, notmeter && obs_data_get_bool(settings, P_RADIAL));
-            set_prop_visible(props, P_RADIAL_ARC, notmeter && obs_data_get_bool(settings, P_RADIAL));
-            set_prop_visible(props, P_RADIAL_ROTATION, notmeter && obs_data_get_bool(settings, P_RADIAL));
-            set_prop_visible(props, P_INVERT, notmeter && obs_data_get_bool(settings, P_RADIAL));
+            set_prop_visible(props, P_HALF_HISTORY, !waveform && !p_equ(obs_data_get_string(settings, P_TSMOOTHING), P_NONE));
+            set_prop_visible(props, P_DISPLAY_TSMOOTH, notmeter && !waveform && !p_equ(obs_data_get_string(settings, P_TSMOOTHING), P_NONE));
+            const auto radial = notmeter && !spectrogram && !vectorscope && obs_data_get_bool(settings, P_RADIAL);
+            set_prop_visible(props, P_RADIAL, notmeter && !spectrogram && !vectorscope);
+            set_prop_visible(props, P_DEADZONE, radial);
+            set_prop_visible(props, P_RADIAL_ARC, radial);
+            set_prop_visible(props, P_RADIAL_ROTATION, radial);
+            set_prop_visible(props, P_INVERT, radial);
             set_prop_visible(props, P_LOG_SCALE, notmeter && !waveform);
             set_prop_visible(props, P_MIRROR_FREQ_AXIS, notmeter && !waveform);
+            set_prop_visible(props, P_BAND_SCALE, p_equ(disp, P_BARS) || p_equ(disp, P_STEP_BARS));
+            set_prop_visible(props, P_BAR_ANALYSIS, p_equ(disp, P_BARS) || p_equ(disp, P_STEP_BARS));
+            set_prop_visible(props, P_POWER_BANDS, p_equ(disp, P_BARS) || p_equ(disp, P_STEP_BARS));
             set_prop_visible(props, P_WIDTH, notmeter);
             set_prop_visible(props, P_AUTO_FFT_SIZE, notmeter && !waveform);
             set_prop_visible(props, P_FFT_SIZE, notmeter && !waveform);
             set_prop_visible(props, P_ENABLE_LARGE_FFT, notmeter && !waveform);
-            set_prop_visible(props, P_RMS_MODE, !notmeter);
-            set_prop_visible(props, P_METER_BUF, !notmeter || waveform);
+            set_prop_visible(props, P_STFT_HOP, notmeter && !waveform);
+            set_prop_visible(props, P_SLIDING_DFT, notmeter && !waveform);
+            set_prop_visible(props, P_MULTIRES, notmeter && !waveform);
+            set_prop_visible(props, P_DECIMATE, notmeter && !waveform);
+            set_prop_visible(props, P_BEAT_DETECTION, notmeter && !waveform);
+            obs_property_list_item_disable(obs_properties_get(props, P_PULSE_MODE), 2, !notmeter || waveform || !obs_data_get_bool(settings, P_BEAT_DETECTION));
+            set_prop_visible(props, P_STFT_COMBINE, notmeter && !waveform && (obs_data_get_int(settings, P_STFT_HOP) > 0));
+            set_prop_visible(props, P_ANALYSIS_INTERVAL, notmeter && !waveform);
+            set_prop_visible(props, P_PREVIEW_INTERVAL, notmeter && !waveform);
+            set_prop_visible(props, P_MIN_HOP, notmeter && !waveform);
+            const auto loudness = obs_data_get_string(settings, P_LOUDNESS);
+            const auto lufs = p_equ(loudness, P_MOMENTARY) || p_equ(loudness, P_SHORT_TERM);
+            set_prop_visible(props, P_LOUDNESS, !notmeter);
+            set_prop_visible(props, P_RMS_MODE, !notmeter && p_equ(loudness, P_NONE));
+            set_prop_visible(props, P_METER_CHANNELS, !notmeter);
+            set_prop_visible(props, P_METER_BUF, (!notmeter && !lufs) || (waveform && !vectorscope));
+            set_prop_visible(props, P_SCOPE_TRIGGER, scope);
+            set_prop_visible(props, P_SCOPE_DECAY, vectorscope);
+            set_prop_visible(props, P_AFTERGLOW, !spectrogram && !vectorscope);
             set_prop_visible(props, P_NORMALIZE_VOLUME, notmeter);
+            set_prop_visible(props, P_AUTO_RANGE, auto_range_visible(settings));
             set_prop_visible(props, P_VOLUME_TARGET, notmeter && obs_data_get_bool(settings, P_NORMALIZE_VOLUME));
             return true;
             });
@@ -290,6 +694,24 @@ namespace callbacks {
         // log scale
         obs_properties_add_bool(props, P_LOG_SCALE, T(P_LOG_SCALE));
 
+        // perceptual bands
+        auto bandscale = obs_properties_add_list(props, P_BAND_SCALE, T(P_BAND_SCALE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+        obs_property_list_add_string(bandscale, T(P_NONE), P_NONE);
+        obs_property_list_add_string(bandscale, T(P_MEL), P_MEL);
+        obs_property_list_add_string(bandscale, T(P_BARK), P_BARK);
+        obs_property_list_add_string(bandscale, T(P_ERB), P_ERB);
+        obs_property_list_add_string(bandscale, T(P_OCTAVE), P_OCTAVE);
+        obs_property_set_long_description(bandscale, T(P_BAND_SCALE_DESC));
+
+        // filterbank bars
+        auto baranalysis = obs_properties_add_list(props, P_BAR_ANALYSIS, T(P_BAR_ANALYSIS), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+        obs_property_list_add_string(baranalysis, T(P_FFT), P_FFT);
+        obs_property_list_add_string(baranalysis, T(P_IIR_OCTAVE), P_IIR_OCTAVE);
+        obs_property_list_add_string(baranalysis, T(P_IIR_THIRD_OCTAVE), P_IIR_THIRD_OCTAVE);
+        obs_property_set_long_description(baranalysis, T(P_BAR_ANALYSIS_DESC));
+        auto powerbands = obs_properties_add_bool(props, P_POWER_BANDS, T(P_POWER_BANDS));
+        obs_property_set_long_description(powerbands, T(P_POWER_BANDS_DESC));
+
         // mirror frequency axis
         auto mirror = obs_properties_add_bool(props, P_MIRROR_FREQ_AXIS, T(P_MIRROR_FREQ_AXIS));
         obs_property_set_long_description(mirror, T(P_MIRROR_DESC));
@@ -318,38 +740,113 @@ namespace callbacks {
         auto caps = obs_properties_add_bool(props, P_CAPS, T(P_CAPS));
         obs_property_set_long_description(caps, T(P_CAPS_DESC));
 
+        // afterglow
+        auto afterglow = obs_properties_add_int_slider(props, P_AFTERGLOW, T(P_AFTERGLOW), 0, 5000, 10);
+        obs_property_int_set_suffix(afterglow, " ms");
+        obs_property_set_long_description(afterglow, T(P_AFTERGLOW_DESC));
+
         // meter
         obs_properties_add_bool(props, P_RMS_MODE, T(P_RMS_MODE));
+        auto meter_channels = obs_properties_add_bool(props, P_METER_CHANNELS, T(P_METER_CHANNELS));
+        obs_property_set_long_description(meter_channels, T(P_METER_CHANNELS_DESC));
         auto meterbuf = obs_properties_add_int(props, P_METER_BUF, T(P_METER_BUF), 10, 600000, 10);
         obs_property_int_set_suffix(meterbuf, " ms");
+        auto trigger = obs_properties_add_float_slider(props, P_SCOPE_TRIGGER, T(P_SCOPE_TRIGGER), -1.0, 1.0, 0.01);
+        obs_property_set_long_description(trigger, T(P_SCOPE_TRIGGER_DESC));
+        auto decay = obs_properties_add_int_slider(props, P_SCOPE_DECAY, T(P_SCOPE_DECAY), 10, 5000, 10);
+        obs_property_int_set_suffix(decay, " ms");
+        obs_property_set_long_description(decay, T(P_SCOPE_DECAY_DESC));
+        auto loudnesslist = obs_properties_add_list(props, P_LOUDNESS, T(P_LOUDNESS), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+        obs_property_list_add_string(loudnesslist, T(P_NONE), P_NONE);
+        obs_property_list_add_string(loudnesslist, T(P_MOMENTARY), P_MOMENTARY);
+        obs_property_list_add_string(loudnesslist, T(P_SHORT_TERM), P_SHORT_TERM);
+        obs_property_list_add_string(loudnesslist, T(P_TRUE_PEAK), P_TRUE_PEAK);
+        obs_property_set_long_description(loudnesslist, T(P_LOUDNESS_DESC));
+        obs_property_set_modified_callback(loudnesslist, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
+            const auto meter = obs_property_visible(obs_properties_get(props, P_LOUDNESS));
+            const auto loudness = obs_data_get_string(settings, P_LOUDNESS);
+            const auto lufs = p_equ(loudness, P_MOMENTARY) || p_equ(loudness, P_SHORT_TERM);
+            set_prop_visible(props, P_RMS_MODE, meter && p_equ(loudness, P_NONE));
+            if(meter)
+                set_prop_visible(props, P_METER_BUF, !lufs);
+            return true;
+            });
 
         // channels
         auto chanlst = obs_properties_add_list(props, P_CHANNEL_MODE, T(P_CHANNEL_MODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
         obs_property_list_add_string(chanlst, T(P_MONO), P_MONO);
         obs_property_list_add_string(chanlst, T(P_STEREO), P_STEREO);
         obs_property_list_add_string(chanlst, T(P_SINGLE), P_SINGLE);
+        obs_property_list_add_string(chanlst, T(P_SURROUND), P_SURROUND);
+        obs_property_list_add_string(chanlst, T(P_MID_SIDE), P_MID_SIDE);
         obs_property_set_long_description(chanlst, T(P_CHAN_DESC));
 
         obs_properties_add_int(props, P_CHANNEL, T(P_CHANNEL), 0, MAX_AUDIO_CHANNELS - 1, 1);
 
         // channel spacing
         obs_properties_add_int(props, P_CHANNEL_SPACING, T(P_CHANNEL_SPACING), 0, 2160, 1);
+
+        // downmix
+        auto downmix = obs_properties_add_bool(props, P_DOWNMIX, T(P_DOWNMIX));
+        obs_property_set_long_description(downmix, T(P_DOWNMIX_DESC));
+
+        // surround mix weights
+        auto center_weight = obs_properties_add_float_slider(props, P_CENTER_WEIGHT, T(P_CENTER_WEIGHT), 0.0, 2.0, 0.001);
+        auto lfe_weight = obs_properties_add_float_slider(props, P_LFE_WEIGHT, T(P_LFE_WEIGHT), 0.0, 2.0, 0.001);
+        auto surround_weight = obs_properties_add_float_slider(props, P_SURROUND_WEIGHT, T(P_SURROUND_WEIGHT), 0.0, 2.0, 0.001);
+        obs_property_set_long_description(center_weight, T(P_SURROUND_DESC));
+        obs_property_set_long_description(lfe_weight, T(P_SURROUND_DESC));
+        obs_property_set_long_description(surround_weight, T(P_SURROUND_DESC));
         obs_property_set_modified_callback(chanlst, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
             auto vis = obs_property_visible(obs_properties_get(props, P_CHANNEL_MODE));
-            auto enable_spacing = p_equ(obs_data_get_string(settings, P_CHANNEL_MODE), P_STEREO) && vis;
+            auto enable_spacing = (p_equ(obs_data_get_string(settings, P_CHANNEL_MODE), P_STEREO) || p_equ(obs_data_get_string(settings, P_CHANNEL_MODE), P_MID_SIDE)) && vis;
             auto enable_channel = p_equ(obs_data_get_string(settings, P_CHANNEL_MODE), P_SINGLE) && vis;
+            const auto disp = obs_data_get_string(settings, P_DISPLAY_MODE);
+            const auto time_domain = p_equ(disp, P_WAVEFORM) || p_equ(disp, P_SCOPE) || p_equ(disp, P_VECTORSCOPE);
+            auto enable_downmix = p_equ(obs_data_get_string(settings, P_CHANNEL_MODE), P_MONO) && !time_domain && vis;
+            auto enable_surround = p_equ(obs_data_get_string(settings, P_CHANNEL_MODE), P_SURROUND) && !time_domain && vis;
             set_prop_visible(props, P_CHANNEL_SPACING, enable_spacing);
             set_prop_visible(props, P_CHANNEL, enable_channel);
+            set_prop_visible(props, P_DOWNMIX, enable_downmix);
+            set_prop_visible(props, P_CENTER_WEIGHT, enable_surround);
+            set_prop_visible(props, P_LFE_WEIGHT, enable_surround);
+            set_prop_visible(props, P_SURROUND_WEIGHT, enable_surround);
             return true;
             });
 
         // fft size
         auto autofftsz = obs_properties_add_bool(props, P_AUTO_FFT_SIZE, T(P_AUTO_FFT_SIZE));
         auto largefft = obs_properties_add_bool(props, P_ENABLE_LARGE_FFT, T(P_ENABLE_LARGE_FFT));
-        auto fftsz = obs_properties_add_int_slider(props, P_FFT_SIZE, T(P_FFT_SIZE), 128, 8192, 64);
+        auto fftsz = obs_properties_add_int_slider(props, P_FFT_SIZE, T(P_FFT_SIZE), 128, (int)WAVSource::MAX_FFT_SIZE, 64);
         obs_property_set_long_description(autofftsz, T(P_AUTO_FFT_DESC));
         obs_property_set_long_description(fftsz, T(P_FFT_DESC));
         obs_property_set_long_description(largefft, T(P_LARGE_FFT_DESC));
+
+        // stft
+        auto hop = obs_properties_add_int_slider(props, P_STFT_HOP, T(P_STFT_HOP), 0, (int)WAVSource::MAX_FFT_SIZE, 32);
+        obs_property_int_set_suffix(hop, " samples");
+        obs_property_set_long_description(hop, T(P_STFT_HOP_DESC));
+        auto combinelst = obs_properties_add_list(props, P_STFT_COMBINE, T(P_STFT_COMBINE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+        obs_property_list_add_string(combinelst, T(P_PEAK), P_PEAK);
+        obs_property_list_add_string(combinelst, T(P_AVERAGE), P_AVERAGE);
+        auto sdft = obs_properties_add_bool(props, P_SLIDING_DFT, T(P_SLIDING_DFT));
+        obs_property_set_long_description(sdft, T(P_SLIDING_DFT_DESC));
+        auto multires = obs_properties_add_bool(props, P_MULTIRES, T(P_MULTIRES));
+        obs_property_set_long_description(multires, T(P_MULTIRES_DESC));
+        auto decimate = obs_properties_add_bool(props, P_DECIMATE, T(P_DECIMATE));
+        obs_property_set_long_description(decimate, T(P_DECIMATE_DESC));
+        auto beat = obs_properties_add_bool(props, P_BEAT_DETECTION, T(P_BEAT_DETECTION));
+        obs_property_set_long_description(beat, T(P_BEAT_DETECTION_DESC));
+        obs_property_set_modified_callback(beat, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
+            auto enable = obs_data_get_bool(settings, P_BEAT_DETECTION) && obs_property_visible(obs_properties_get(props, P_BEAT_DETECTION));
+            obs_property_list_item_disable(obs_properties_get(props, P_PULSE_MODE), 2, !enable);
+            return true;
+            });
+        obs_property_set_modified_callback(hop, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
+            auto vis = obs_property_visible(obs_properties_get(props, P_STFT_HOP));
+            set_prop_visible(props, P_STFT_COMBINE, vis && (obs_data_get_int(settings, P_STFT_HOP) > 0));
+            return true;
+            });
         obs_property_set_modified_callback(autofftsz, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
             auto enable = !obs_data_get_bool(settings, P_AUTO_FFT_SIZE);
             obs_property_set_enabled(obs_properties_get(props, P_FFT_SIZE), enable);
@@ -358,7 +855,7 @@ namespace callbacks {
             });
         obs_property_set_modified_callback(largefft, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
             auto enable = obs_data_get_bool(settings, P_ENABLE_LARGE_FFT);
-            obs_property_int_set_limits(obs_properties_get(props, P_FFT_SIZE), 128, enable ? (1 << 16) : 8192, 64);
+            obs_property_int_set_limits(obs_properties_get(props, P_FFT_SIZE), 128, enable ? (1 << 16) : (int)WAVSource::MAX_FFT_SIZE, 64);
             return true;
             });
 
@@ -372,6 +869,8 @@ namespace callbacks {
         obs_property_list_add_string(wndlist, T(P_POWER_OF_SINE), P_POWER_OF_SINE);
         obs_property_set_long_description(wndlist, T(P_WINDOW_DESC));
         obs_properties_add_int(props, P_SINE_EXPONENT, T(P_SINE_EXPONENT), 1, 16, 1);
+        auto binwnd = obs_properties_add_bool(props, P_BIN_WINDOW, T(P_BIN_WINDOW));
+        obs_property_set_long_description(binwnd, T(P_BIN_WINDOW_DESC));
         obs_property_set_modified_callback(wndlist, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
             auto enable = p_equ(obs_data_get_string(settings, P_WINDOW), P_POWER_OF_SINE) && obs_property_visible(obs_properties_get(props, P_WINDOW));
             set_prop_visible(props, P_SINE_EXPONENT, enable);
@@ -383,15 +882,28 @@ namespace callbacks {
         obs_property_list_add_string(tsmoothlist, T(P_NONE), P_NONE);
         obs_property_list_add_string(tsmoothlist, T(P_EXPAVG), P_EXPAVG);
         obs_property_list_add_string(tsmoothlist, T(P_TVEXPAVG), P_TVEXPAVG);
+        obs_property_list_add_string(tsmoothlist, T(P_POWEREXPAVG), P_POWEREXPAVG);
         auto grav = obs_properties_add_float_slider(props, P_GRAVITY, T(P_GRAVITY), 0.0, 1.0, 0.01);
         auto peaks = obs_properties_add_bool(props, P_FAST_PEAKS, T(P_FAST_PEAKS));
         obs_property_set_long_description(tsmoothlist, T(P_TEMPORAL_DESC));
         obs_property_set_long_description(grav, T(P_GRAVITY_DESC));
         obs_property_set_long_description(peaks, T(P_FAST_PEAKS_DESC));
+#ifdef ENABLE_X86_SIMD
+        if(DSPKernels::get().half_history)
+        {
+            auto half = obs_properties_add_bool(props, P_HALF_HISTORY, T(P_HALF_HISTORY));
+            obs_property_set_long_description(half, T(P_HALF_HISTORY_DESC));
+        }
+#endif // ENABLE_X86_SIMD
+        auto display_tsmooth = obs_properties_add_bool(props, P_DISPLAY_TSMOOTH, T(P_DISPLAY_TSMOOTH));
+        obs_property_set_long_description(display_tsmooth, T(P_DISPLAY_TSMOOTH_DESC));
         obs_property_set_modified_callback(tsmoothlist, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
             auto enable = !p_equ(obs_data_get_string(settings, P_TSMOOTHING), P_NONE) && obs_property_visible(obs_properties_get(props, P_TSMOOTHING));
             set_prop_visible(props, P_GRAVITY, enable);
             set_prop_visible(props, P_FAST_PEAKS, enable);
+            set_prop_visible(props, P_HALF_HISTORY, enable);
+            auto display = obs_data_get_string(settings, P_DISPLAY_MODE);
+            set_prop_visible(props, P_DISPLAY_TSMOOTH, enable && !p_equ(display, P_LEVEL_METER) && !p_equ(display, P_STEPPED_METER));
             return true;
             });
 
@@ -401,11 +913,14 @@ namespace callbacks {
         obs_property_list_add_string(interplist, T(P_LANCZOS), P_LANCZOS);
         obs_property_list_add_string(interplist, T(P_CATROM), P_CATROM);
         obs_property_set_long_description(interplist, T(P_INTERP_DESC));
+        auto curvepts = obs_properties_add_int_slider(props, P_CURVE_POINTS, T(P_CURVE_POINTS), 0, 4096, 16);
+        obs_property_set_long_description(curvepts, T(P_CURVE_POINTS_DESC));
 
         // filter
         auto filterlist = obs_properties_add_list(props, P_FILTER_MODE, T(P_FILTER_MODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
         obs_property_list_add_string(filterlist, T(P_NONE), P_NONE);
         obs_property_list_add_string(filterlist, T(P_GAUSS), P_GAUSS);
+        obs_property_list_add_string(filterlist, T(P_RECURSIVE_GAUSS), P_RECURSIVE_GAUSS);
         obs_properties_add_float_slider(props, P_FILTER_RADIUS, T(P_FILTER_RADIUS), 0.0, 32.0, 0.01);
         obs_property_set_long_description(filterlist, T(P_FILTER_DESC));
         obs_property_set_modified_callback(filterlist, [](obs_properties_t *props, [[maybe_unused]] obs_property_t *property, obs_data_t *settings) -> bool {
@@ -423,6 +938,8 @@ namespace callbacks {
         auto ceiling = obs_properties_add_int_slider(props, P_CEILING, T(P_CEILING), -120, 0, 1);
         obs_property_int_set_suffix(floor, " dBFS");
         obs_property_int_set_suffix(ceiling, " dBFS");
+        auto auto_range = obs_properties_add_bool(props, P_AUTO_RANGE, T(P_AUTO_RANGE));
+        obs_property_set_long_description(auto_range, T(P_AUTO_RANGE_DESC));
         auto slope = obs_properties_add_float_slider(props, P_SLOPE, T(P_SLOPE), 0.0, 10.0, 0.01);
         obs_property_set_long_description(slope, T(P_SLOPE_DESC));
         auto rolloff_q = obs_properties_add_float_slider(props, P_ROLLOFF_Q, T(P_ROLLOFF_Q), 0.0, 10.0, 0.01);
@@ -438,6 +955,7 @@ namespace callbacks {
         auto pulselist = obs_properties_add_list(props, P_PULSE_MODE, T(P_PULSE_MODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
         obs_property_list_add_string(pulselist, T(P_PEAK_MAG), P_PEAK_MAG);
         obs_property_list_add_string(pulselist, T(P_PEAK_FREQ), P_PEAK_FREQ);
+        obs_property_list_add_string(pulselist, T(P_BEAT), P_BEAT);
         obs_properties_add_color_alpha(props, P_COLOR_BASE, T(P_COLOR_BASE));
         obs_properties_add_color_alpha(props, P_COLOR_MIDDLE, T(P_COLOR_MIDDLE));
         obs_properties_add_color_alpha(props, P_COLOR_CREST, T(P_COLOR_CREST));
@@ -464,7 +982,7 @@ namespace callbacks {
 
     static void update(void *data, obs_data_t *settings)
     {
-        static_cast<WAVSource*>(data)->update(settings);
+        static_cast<WAVSource*>(data)->request_update(settings);
     }
 
     static void show(void *data)
@@ -477,6 +995,16 @@ namespace callbacks {
         static_cast<WAVSource*>(data)->hide();
     }
 
+    static void activate(void *data)
+    {
+        static_cast<WAVSource*>(data)->set_active(true);
+    }
+
+    static void deactivate(void *data)
+    {
+        static_cast<WAVSource*>(data)->set_active(false);
+    }
+
     static void tick(void *data, float seconds)
     {
         static_cast<WAVSource*>(data)->tick(seconds);
@@ -486,78 +1014,254 @@ namespace callbacks {
     {
         static_cast<WAVSource*>(data)->render(effect);
     }
+}
+
+// settings that only reach uniforms, the dB to pixel mapping or per tick math
+// changing nothing else skips the rebuild in update()
+static const char *const LIVE_SETTINGS[] = {
+    P_INVERT, P_RADIAL_ROTATION, P_GRAVITY, P_FLOOR, P_CEILING, P_AUTO_RANGE, P_PULSE_MODE,
+    P_COLOR_BASE, P_COLOR_MIDDLE, P_COLOR_CREST, P_GRAD_RATIO, P_RANGE_MIDDLE, P_RANGE_CREST,
+    P_PEAK_HOLD_TIME, P_PEAK_FALL_RATE, P_HIDE_SILENT, P_VOLUME_TARGET, P_MAX_GAIN, P_LOG_STATS,
+    P_LOG_LATENCY, P_ASYNC_ANALYSIS, P_JOIN_ANALYSIS, P_CPU_BUDGET, P_SLEEP_TIMEOUT, P_SHARED_MEMORY, P_RECORD_PATH, P_CAPTURE_LOG, P_PLAYBACK_OFFSET, P_ENVELOPE,
+    P_ENVELOPE_ATTACK, P_ENVELOPE_RELEASE
+};
+
+void WAVSource::get_live_settings(obs_data_t *settings)
+{
+    m_invert = obs_data_get_bool(settings, P_INVERT);
+    m_radial_rotation = ((float)obs_data_get_double(settings, P_RADIAL_ROTATION) / 360.0f) * (std::numbers::pi_v<float> * 2);
+    m_gravity = (float)obs_data_get_double(settings, P_GRAVITY);
+    m_floor = (int)obs_data_get_int(settings, P_FLOOR);
+    m_ceiling = (int)obs_data_get_int(settings, P_CEILING);
+    m_auto_range = obs_data_get_bool(settings, P_AUTO_RANGE) && !time_domain() && !m_gpu_fft;
+    auto pulsemode = obs_data_get_string(settings, P_PULSE_MODE);
+    auto color_base = obs_data_get_int(settings, P_COLOR_BASE);
+    auto color_middle = obs_data_get_int(settings, P_COLOR_MIDDLE);
+    auto color_crest = obs_data_get_int(settings, P_COLOR_CREST);
+    m_grad_ratio = (float)obs_data_get_double(settings, P_GRAD_RATIO);
+    m_range_middle = (int)obs_data_get_int(settings, P_RANGE_MIDDLE);
+    m_range_crest = (int)obs_data_get_int(settings, P_RANGE_CREST);
+    m_peak_hold_time = (float)obs_data_get_int(settings, P_PEAK_HOLD_TIME) / 1000.0f;
+    m_peak_fall_rate = (float)obs_data_get_double(settings, P_PEAK_FALL_RATE);
+    m_hide_on_silent = obs_data_get_bool(settings, P_HIDE_SILENT);
+    m_volume_target = (float)obs_data_get_int(settings, P_VOLUME_TARGET);
+    m_max_gain = (float)obs_data_get_int(settings, P_MAX_GAIN);
+    m_log_stats = obs_data_get_bool(settings, P_LOG_STATS);
+    m_log_latency = obs_data_get_bool(settings, P_LOG_LATENCY);
+    m_async_analysis = obs_data_get_bool(settings, P_ASYNC_ANALYSIS);
+    m_join_analysis = obs_data_get_bool(settings, P_JOIN_ANALYSIS);
+    m_cpu_budget = std::max((float)obs_data_get_double(settings, P_CPU_BUDGET), 0.0f);
+    m_sleep_timeout = (float)std::max(obs_data_get_int(settings, P_SLEEP_TIMEOUT), 0ll);
+    m_envelope = obs_data_get_bool(settings, P_ENVELOPE) && !time_domain();
+    m_envelope_attack = (float)obs_data_get_int(settings, P_ENVELOPE_ATTACK) / 1000.0f;
+    m_envelope_release = (float)obs_data_get_int(settings, P_ENVELOPE_RELEASE) / 1000.0f;
+    const std::string shm_name = obs_data_get_string(settings, P_SHARED_MEMORY);
+    if(shm_name.empty())
+        m_shm_export.close();
+    else if(shm_name != m_shm_name)
+        m_shm_export.open(shm_name);
+    m_shm_name = shm_name;
+    m_playback_offset = obs_data_get_int(settings, P_PLAYBACK_OFFSET) * 1000000;
+    const std::string record_path = obs_data_get_string(settings, P_RECORD_PATH);
+    if(record_path.empty())
+        m_recorder.close();
+    else if(record_path != m_record_path)
+        m_recorder.open(record_path);
+    m_record_path = record_path;
+    const std::string capture_log = obs_data_get_string(settings, P_CAPTURE_LOG);
+    if((m_capture_log != nullptr) && (capture_log != m_capture_log->path()))
+        close_capture_log();
+    if(!capture_log.empty() && (m_capture_log == nullptr))
+    {
+        m_capture_log = std::make_shared<CaptureLog>();
+        if(!m_capture_log->open(capture_log, m_audio_info.samples_per_sec))
+            m_capture_log.reset();
+        bind_capture_log();
+    }
+
+    m_color_base = { {{(uint8_t)color_base / 255.0f, (uint8_t)(color_base >> 8) / 255.0f, (uint8_t)(color_base >> 16) / 255.0f, (uint8_t)(color_base >> 24) / 255.0f}} };
+    m_color_middle = { {{(uint8_t)color_middle / 255.0f, (uint8_t)(color_middle >> 8) / 255.0f, (uint8_t)(color_middle >> 16) / 255.0f, (uint8_t)(color_middle >> 24) / 255.0f}} };
+    m_color_crest = { {{(uint8_t)color_crest / 255.0f, (uint8_t)(color_crest >> 8) / 255.0f, (uint8_t)(color_crest >> 16) / 255.0f, (uint8_t)(color_crest >> 24) / 255.0f}} };
+
+    if((m_ceiling - m_floor) < 1)
+    {
+        m_ceiling = 0;
+        m_floor = -120;
+    }
 
-    static void capture_audio(void *data, obs_source_t *source, const audio_data *audio, bool muted)
+    // the auto range carries on from the levels it has seen, it starts out at the fixed one
+    if(!m_auto_range || (m_range_weight <= 0.0f))
     {
-        static_cast<WAVSource*>(data)->capture_audio(source, audio, muted);
+        m_range_floor = m_floor;
+        m_range_ceiling = m_ceiling;
+        std::fill(std::begin(m_range_hist), std::end(m_range_hist), 0.0f);
+        m_range_weight = 0.0f;
     }
 
-    static void capture_output_bus(void *param, size_t mix_idx, audio_data *data)
+    // the pulse only follows frequency in spectrum modes, beats need beat detection
+    if(p_equ(pulsemode, P_PEAK_FREQ) && !m_meter_mode && !time_domain())
+        m_pulse_mode = PulseMode::FREQUENCY;
+    else if(p_equ(pulsemode, P_BEAT) && m_beat_detection)
+        m_pulse_mode = PulseMode::BEAT;
+    else
+        m_pulse_mode = PulseMode::MAGNITUDE;
+
+    bake_color_lut();
+}
+
+// texel i holds the color at (i + 0.5) / COLOR_LUT_SIZE, where a sample at that position reads it back
+// one fetch per pixel however many stops the scheme has
+void WAVSource::bake_color_lut()
+{
+    struct Stop
+    {
+        float pos;
+        vec4 color;
+    };
+    const auto ramp = [](std::initializer_list<Stop> stops, float t) {
+        auto prev = stops.begin();
+        for(auto stop = prev; stop != stops.end(); prev = stop++)
+        {
+            if(t >= stop->pos)
+                continue;
+            if(stop == stops.begin())
+                return stop->color;
+            const auto u = saturate((t - prev->pos) / std::max(stop->pos - prev->pos, 0.0001f));
+            vec4 color;
+            vec4_set(&color, lerp(prev->color.x, stop->color.x, u), lerp(prev->color.y, stop->color.y, u), lerp(prev->color.z, stop->color.z, u), lerp(prev->color.w, stop->color.w, u));
+            return color;
+        }
+        return prev->color;
+    };
+    const auto pack = [](const vec4& color) {
+        const auto byte = [](float c) { return (uint32_t)std::lround(saturate(c) * 255.0f); };
+        return byte(color.x) | (byte(color.y) << 8) | (byte(color.z) << 16) | (byte(color.w) << 24);
+    };
+
+    const auto dbrange = (float)(m_range_ceiling - m_range_floor);
+    auto clear = m_color_base;
+    clear.w = 0.0f;
+    // range levels as distances from the base, the top of the graph is the ceiling
+    const auto range_middle = 1.0f - ((float)(m_range_middle - m_range_ceiling) / (float)m_range_floor);
+    const auto range_crest = 1.0f - ((float)(m_range_crest - m_range_ceiling) / (float)m_range_floor);
+    // spectrogram intensities, base fades in from the floor then blends through middle to crest
+    const auto spectrogram_middle = std::clamp((float)(m_range_middle - m_range_floor) / dbrange, 0.0f, 1.0f);
+    const auto spectrogram_crest = std::clamp((float)(m_range_crest - m_range_floor) / dbrange, 0.0f, 1.0f);
+
+    m_color_lut.resize(COLOR_LUT_SIZE);
+    for(auto i = 0u; i < COLOR_LUT_SIZE; ++i)
     {
-        static_cast<WAVSource*>(param)->capture_output_bus(mix_idx, data);
+        const auto t = ((float)i + 0.5f) / (float)COLOR_LUT_SIZE;
+        vec4 color;
+        if(m_display_mode == DisplayMode::SPECTROGRAM)
+            color = ramp({ { 0.0f, clear }, { spectrogram_middle, m_color_base }, { spectrogram_crest, m_color_middle }, { 1.0f, m_color_crest } }, t);
+        else if(m_render_mode == RenderMode::RANGE)
+            color = (t < range_middle) ? m_color_base : (t > range_crest) ? m_color_crest : m_color_middle;
+        else
+            color = ramp({ { 0.0f, m_color_base }, { 1.0f, m_color_crest } }, t);
+        m_color_lut[i] = pack(color);
     }
 }
 
+void WAVSource::upload_color_lut()
+{
+    if(m_color_lut.size() != COLOR_LUT_SIZE)
+        return;
+    if(m_color_lut_tex == nullptr)
+        m_color_lut_tex = gs_texture_create(COLOR_LUT_SIZE, 1, GS_RGBA, 1, nullptr, GS_DYNAMIC);
+    if(m_color_lut_tex == nullptr)
+        return;
+    gs_texture_set_image(m_color_lut_tex, reinterpret_cast<const uint8_t*>(m_color_lut.data()), COLOR_LUT_SIZE * sizeof(uint32_t), false);
+    gs_effect_set_texture(m_params.color_lut, m_color_lut_tex);
+}
+
+// everything but the live settings, to tell whether update() has to rebuild
+std::string WAVSource::get_structure_key(obs_data_t *settings) const
+{
+    auto copy = obs_data_create();
+    obs_data_apply(copy, settings);
+    for(auto name : LIVE_SETTINGS)
+        obs_data_erase(copy, name);
+    std::string key = obs_data_get_json(copy);
+    obs_data_release(copy);
+    key += ';' + std::to_string(m_audio_info.samples_per_sec) + ';' + std::to_string((int)m_audio_info.speakers);
+    if(obs_data_get_bool(settings, P_AUTO_FFT_SIZE))
+        key += ';' + std::to_string(m_fps); // only sizes the FFT
+    key += ';' + std::to_string(m_view_fft_size.load(std::memory_order_relaxed)); // a view follows its parent's size
+    key += ';' + std::to_string(m_quality_level);
+    return key;
+}
+
 void WAVSource::get_settings(obs_data_t *settings)
 {
     auto src_name = obs_data_get_string(settings, P_AUDIO_SRC);
+    auto parent_name = obs_data_get_string(settings, P_ANALYSIS_PARENT);
+    m_playback_path = obs_data_get_string(settings, P_PLAYBACK);
     m_width = (unsigned int)obs_data_get_int(settings, P_WIDTH);
     m_height = (unsigned int)obs_data_get_int(settings, P_HEIGHT);
+    m_headless = obs_data_get_bool(settings, P_HEADLESS);
+    m_gpu_fft = obs_data_get_bool(settings, P_GPU_FFT);
+    m_gpu_waveform = m_gpu_fft; // one setting, the spectrum and waveform paths each check what they support
     m_log_scale = obs_data_get_bool(settings, P_LOG_SCALE);
     m_mirror_freq_axis = obs_data_get_bool(settings, P_MIRROR_FREQ_AXIS);
     m_radial = obs_data_get_bool(settings, P_RADIAL);
-    m_invert = obs_data_get_bool(settings, P_INVERT);
     auto deadzone = (float)obs_data_get_double(settings, P_DEADZONE) / 100.0f;
     m_radial_arc = (float)obs_data_get_double(settings, P_RADIAL_ARC) / 360.0f;
-    m_radial_rotation = ((float)obs_data_get_double(settings, P_RADIAL_ROTATION) / 360.0f) * (std::numbers::pi_v<float> * 2);
     m_rounded_caps = obs_data_get_bool(settings, P_CAPS);
+    m_afterglow = (float)std::max(obs_data_get_int(settings, P_AFTERGLOW), 0ll) / 1000.0f;
     auto channel_mode = obs_data_get_string(settings, P_CHANNEL_MODE);
-    m_stereo = p_equ(channel_mode, P_STEREO);
+    m_stereo = p_equ(channel_mode, P_STEREO) || p_equ(channel_mode, P_MID_SIDE);
     m_channel_base = (int)obs_data_get_int(settings, P_CHANNEL);
     m_channel_spacing = (int)obs_data_get_int(settings, P_CHANNEL_SPACING);
+    m_downmix = obs_data_get_bool(settings, P_DOWNMIX);
+    m_center_weight = (float)obs_data_get_double(settings, P_CENTER_WEIGHT);
+    m_lfe_weight = (float)obs_data_get_double(settings, P_LFE_WEIGHT);
+    m_surround_weight = (float)obs_data_get_double(settings, P_SURROUND_WEIGHT);
     m_fft_size = (size_t)obs_data_get_int(settings, P_FFT_SIZE);
     m_auto_fft_size = obs_data_get_bool(settings, P_AUTO_FFT_SIZE);
+    m_stft_hop = (size_t)std::max(obs_data_get_int(settings, P_STFT_HOP), 0ll);
+    m_stft_peak = !p_equ(obs_data_get_string(settings, P_STFT_COMBINE), P_AVERAGE);
+    m_sliding_dft = obs_data_get_bool(settings, P_SLIDING_DFT);
+    m_multires = obs_data_get_bool(settings, P_MULTIRES);
+    m_decimate = obs_data_get_bool(settings, P_DECIMATE);
+    m_beat_detection = obs_data_get_bool(settings, P_BEAT_DETECTION);
     auto wnd = obs_data_get_string(settings, P_WINDOW);
+    m_bin_window = obs_data_get_bool(settings, P_BIN_WINDOW);
     m_sine_exponent = (int)obs_data_get_int(settings, P_SINE_EXPONENT);
     auto tsmoothing = obs_data_get_string(settings, P_TSMOOTHING);
-    m_gravity = (float)obs_data_get_double(settings, P_GRAVITY);
     m_fast_peaks = obs_data_get_bool(settings, P_FAST_PEAKS);
+    m_half_history = obs_data_get_bool(settings, P_HALF_HISTORY);
     auto interp = obs_data_get_string(settings, P_INTERP_MODE);
+    m_curve_points = (unsigned int)std::max(obs_data_get_int(settings, P_CURVE_POINTS), 0ll);
+    auto bandscale = obs_data_get_string(settings, P_BAND_SCALE);
+    auto baranalysis = obs_data_get_string(settings, P_BAR_ANALYSIS);
+    m_power_bands = obs_data_get_bool(settings, P_POWER_BANDS);
     auto filtermode = obs_data_get_string(settings, P_FILTER_MODE);
     m_filter_radius = (float)obs_data_get_double(settings, P_FILTER_RADIUS);
     m_cutoff_low = (int)obs_data_get_int(settings, P_CUTOFF_LOW);
     m_cutoff_high = (int)obs_data_get_int(settings, P_CUTOFF_HIGH);
-    m_floor = (int)obs_data_get_int(settings, P_FLOOR);
-    m_ceiling = (int)obs_data_get_int(settings, P_CEILING);
     m_slope = (float)obs_data_get_double(settings, P_SLOPE);
     m_rolloff_q = (float)obs_data_get_double(settings, P_ROLLOFF_Q);
     m_rolloff_rate = (float)obs_data_get_double(settings, P_ROLLOFF_RATE);
     auto rendermode = obs_data_get_string(settings, P_RENDER_MODE);
-    auto pulsemode = obs_data_get_string(settings, P_PULSE_MODE);
-    auto color_base = obs_data_get_int(settings, P_COLOR_BASE);
-    auto color_middle = obs_data_get_int(settings, P_COLOR_MIDDLE);
-    auto color_crest = obs_data_get_int(settings, P_COLOR_CREST);
-    m_grad_ratio = (float)obs_data_get_double(settings, P_GRAD_RATIO);
-    m_range_middle = (int)obs_data_get_int(settings, P_RANGE_MIDDLE);
-    m_range_crest = (int)obs_data_get_int(settings, P_RANGE_CREST);
     auto display = obs_data_get_string(settings, P_DISPLAY_MODE);
     m_bar_width = (int)obs_data_get_int(settings, P_BAR_WIDTH);
     m_bar_gap = (int)obs_data_get_int(settings, P_BAR_GAP);
     m_step_width = (int)obs_data_get_int(settings, P_STEP_WIDTH);
     m_step_gap = (int)obs_data_get_int(settings, P_STEP_GAP);
     m_min_bar_height = (int)obs_data_get_int(settings, P_MIN_BAR_HEIGHT);
+    m_peak_hold = obs_data_get_bool(settings, P_PEAK_HOLD);
     m_meter_rms = obs_data_get_bool(settings, P_RMS_MODE);
+    m_meter_all_channels = obs_data_get_bool(settings, P_METER_CHANNELS);
+    auto loudness = obs_data_get_string(settings, P_LOUDNESS);
     m_meter_ms = (int)obs_data_get_int(settings, P_METER_BUF);
-    m_hide_on_silent = obs_data_get_bool(settings, P_HIDE_SILENT);
+    m_scope_level = (float)obs_data_get_double(settings, P_SCOPE_TRIGGER);
+    m_scope_decay = (float)std::max(obs_data_get_int(settings, P_SCOPE_DECAY), 1ll) / 1000.0f;
     m_ignore_mute = obs_data_get_bool(settings, P_IGNORE_MUTE);
+    m_output_track = (size_t)std::clamp((int)obs_data_get_int(settings, P_OUTPUT_TRACK), 1, MAX_AUDIO_MIXES) - 1;
     m_normalize_volume = obs_data_get_bool(settings, P_NORMALIZE_VOLUME);
-    m_volume_target = (float)obs_data_get_int(settings, P_VOLUME_TARGET);
-    m_max_gain = (float)obs_data_get_int(settings, P_MAX_GAIN);
-    m_ts_offset = (int64_t)obs_data_get_int(settings, P_AUDIO_SYNC_OFFSET) * 1000000ll;
-
-    m_color_base = { {{(uint8_t)color_base / 255.0f, (uint8_t)(color_base >> 8) / 255.0f, (uint8_t)(color_base >> 16) / 255.0f, (uint8_t)(color_base >> 24) / 255.0f}} };
-    m_color_middle = { {{(uint8_t)color_middle / 255.0f, (uint8_t)(color_middle >> 8) / 255.0f, (uint8_t)(color_middle >> 16) / 255.0f, (uint8_t)(color_middle >> 24) / 255.0f}} };
-    m_color_crest = { {{(uint8_t)color_crest / 255.0f, (uint8_t)(color_crest >> 8) / 255.0f, (uint8_t)(color_crest >> 16) / 255.0f, (uint8_t)(color_crest >> 24) / 255.0f}} };
+    m_ts_offset = std::clamp((int64_t)obs_data_get_int(settings, P_AUDIO_SYNC_OFFSET), (int64_t)-MAX_SYNC_OFFSET, (int64_t)MAX_SYNC_OFFSET) * 1000000ll;
+    m_low_latency = obs_data_get_bool(settings, P_LOW_LATENCY);
 
     if(m_fft_size < 128)
         m_fft_size = 128;
@@ -570,12 +1274,6 @@ void WAVSource::get_settings(obs_data_t *settings)
         m_cutoff_low = 120;
     }
 
-    if((m_ceiling - m_floor) < 1)
-    {
-        m_ceiling = 0;
-        m_floor = -120;
-    }
-
     if(!m_stereo || (((int)m_height - m_channel_spacing) < 1))
         m_channel_spacing = 0;
 
@@ -583,6 +1281,12 @@ void WAVSource::get_settings(obs_data_t *settings)
         m_audio_source_name = src_name;
     else
         m_audio_source_name.clear();
+    m_audio_source_uuid = obs_data_get_string(settings, P_AUDIO_SRC_UUID);
+
+    if((parent_name != nullptr) && !p_equ(parent_name, P_NONE))
+        m_parent_name = parent_name;
+    else
+        m_parent_name.clear();
 
     if(p_equ(wnd, P_HANN))
         m_window_func = FFTWindow::HANN;
@@ -604,8 +1308,28 @@ void WAVSource::get_settings(obs_data_t *settings)
     else
         m_interp_mode = InterpMode::POINT;
 
+    if(p_equ(bandscale, P_MEL))
+        m_band_scale = BandScale::MEL;
+    else if(p_equ(bandscale, P_BARK))
+        m_band_scale = BandScale::BARK;
+    else if(p_equ(bandscale, P_ERB))
+        m_band_scale = BandScale::ERB;
+    else if(p_equ(bandscale, P_OCTAVE))
+        m_band_scale = BandScale::OCTAVE;
+    else
+        m_band_scale = BandScale::NONE;
+
+    if(p_equ(baranalysis, P_IIR_OCTAVE))
+        m_iir_fraction = 1;
+    else if(p_equ(baranalysis, P_IIR_THIRD_OCTAVE))
+        m_iir_fraction = 3;
+    else
+        m_iir_fraction = 0;
+
     if(p_equ(filtermode, P_GAUSS))
         m_filter_mode = FilterMode::GAUSS;
+    else if(p_equ(filtermode, P_RECURSIVE_GAUSS))
+        m_filter_mode = FilterMode::RECURSIVE_GAUSS;
     else
         m_filter_mode = FilterMode::NONE;
 
@@ -613,9 +1337,28 @@ void WAVSource::get_settings(obs_data_t *settings)
         m_tsmoothing = TSmoothingMode::EXPONENTIAL;
     else if(p_equ(tsmoothing, P_TVEXPAVG))
         m_tsmoothing = TSmoothingMode::TVEXPONENTIAL;
+    else if(p_equ(tsmoothing, P_POWEREXPAVG))
+        m_tsmoothing = TSmoothingMode::POWER;
     else
         m_tsmoothing = TSmoothingMode::NONE;
 
+    if(p_equ(loudness, P_MOMENTARY))
+        m_loudness_mode = LoudnessMode::MOMENTARY;
+    else if(p_equ(loudness, P_SHORT_TERM))
+        m_loudness_mode = LoudnessMode::SHORT_TERM;
+    else if(p_equ(loudness, P_TRUE_PEAK))
+        m_loudness_mode = LoudnessMode::TRUE_PEAK;
+    else
+        m_loudness_mode = LoudnessMode::NONE;
+
+    // fp16 is only read by the AVX2 and AVX-512 spectrum paths
+    // and doesn't have the range for power, which spans twice the dB of magnitude
+#ifdef ENABLE_X86_SIMD
+    m_half_history = m_half_history && DSPKernels::get().half_history && (m_tsmoothing != TSmoothingMode::NONE) && (m_tsmoothing != TSmoothingMode::POWER);
+#else
+    m_half_history = false;
+#endif // ENABLE_X86_SIMD
+
     if(p_equ(rendermode, P_LINE))
         m_render_mode = RenderMode::LINE;
     else if(p_equ(rendermode, P_GRADIENT))
@@ -627,11 +1370,6 @@ void WAVSource::get_settings(obs_data_t *settings)
     else
         m_render_mode = RenderMode::SOLID;
 
-    if(p_equ(pulsemode, P_PEAK_FREQ))
-        m_pulse_mode = PulseMode::FREQUENCY;
-    else
-        m_pulse_mode = PulseMode::MAGNITUDE;
-
     if(p_equ(display, P_BARS))
         m_display_mode = DisplayMode::BAR;
     else if(p_equ(display, P_STEP_BARS))
@@ -642,18 +1380,107 @@ void WAVSource::get_settings(obs_data_t *settings)
         m_display_mode = DisplayMode::STEPPED_METER;
     else if(p_equ(display, P_WAVEFORM))
         m_display_mode = DisplayMode::WAVEFORM;
+    else if(p_equ(display, P_SPECTROGRAM))
+        m_display_mode = DisplayMode::SPECTROGRAM;
+    else if(p_equ(display, P_SCOPE))
+        m_display_mode = DisplayMode::SCOPE;
+    else if(p_equ(display, P_VECTORSCOPE))
+        m_display_mode = DisplayMode::VECTORSCOPE;
     else
         m_display_mode = DisplayMode::CURVE;
 
     if((m_display_mode != DisplayMode::BAR) && (m_display_mode != DisplayMode::METER))
         m_rounded_caps = false;
+    if((m_display_mode == DisplayMode::SPECTROGRAM) || (m_display_mode == DisplayMode::VECTORSCOPE))
+        m_afterglow = 0.0f; // their history already is the image
 
+    m_peak_hold = m_peak_hold && ((m_display_mode == DisplayMode::BAR) || (m_display_mode == DisplayMode::STEPPED_BAR));
     m_meter_mode = false;
     if((m_display_mode == DisplayMode::METER) || (m_display_mode == DisplayMode::STEPPED_METER))
     {
         m_radial = false;
         m_meter_mode = true;
     }
+    else if(m_display_mode == DisplayMode::SPECTROGRAM)
+    {
+        // one flat image, the rows are time
+        m_radial = false;
+        m_stereo = false;
+    }
+    else if(m_display_mode == DisplayMode::VECTORSCOPE)
+    {
+        // left against right, a mono source draws its one channel as both
+        m_radial = false;
+        m_stereo = true;
+        channel_mode = P_STEREO;
+    }
+
+    m_beat_detection = m_beat_detection && !m_meter_mode && !time_domain();
+
+    // a view only maps and draws, the waveform and scope have nothing to share
+    m_view = (!m_parent_name.empty() || !m_playback_path.empty()) && !time_domain();
+    m_meter_all_channels = m_meter_all_channels && !m_view; // views and recordings carry the first two meters only
+    if(m_view)
+    {
+        m_iir_fraction = 0;
+        m_beat_detection = false;
+        m_auto_fft_size = false;
+        m_stft_hop = 0;
+        m_sliding_dft = false;
+        m_multires = false;
+        m_decimate = false;
+        m_half_history = false;
+        m_downmix = false;
+        m_normalize_volume = false;
+    }
+
+    // filterbank bars have one value per band and nothing of the transform
+    if((m_display_mode != DisplayMode::BAR) && (m_display_mode != DisplayMode::STEPPED_BAR))
+        m_iir_fraction = 0;
+    if(m_iir_fraction > 0)
+    {
+        m_auto_fft_size = false;
+        m_stft_hop = 0;
+        m_sliding_dft = false;
+        m_multires = false;
+        m_decimate = false;
+        m_beat_detection = false;
+        m_half_history = false;
+        m_mirror_freq_axis = false;
+        m_window_func = FFTWindow::NONE;
+        m_interp_mode = InterpMode::POINT;
+        m_band_scale = BandScale::NONE;
+    }
+
+    // power stays linear until interp_bars(), peak hold and views work on the dB of every bin
+    m_power_bands = m_power_bands && ((m_display_mode == DisplayMode::BAR) || (m_display_mode == DisplayMode::STEPPED_BAR))
+        && (m_iir_fraction == 0) && !m_peak_hold && !m_view;
+
+    // only spectra are worth staggering, the other modes are cheap to analyze every frame
+    m_analysis_interval = 1;
+    m_preview_interval = 1;
+    m_min_hop = 0;
+    if(!m_meter_mode && !time_domain() && (m_iir_fraction == 0) && !m_view)
+    {
+        m_analysis_interval = (uint32_t)std::clamp((int)obs_data_get_int(settings, P_ANALYSIS_INTERVAL), 1, MAX_ANALYSIS_INTERVAL);
+        // headless sources feed exports and views, nobody watches them in program
+        if(!m_headless)
+            m_preview_interval = (uint32_t)std::clamp((int)obs_data_get_int(settings, P_PREVIEW_INTERVAL), 1, MAX_ANALYSIS_INTERVAL);
+        // hop frames already wait for a full hop of new audio
+        if(m_stft_hop == 0)
+            m_min_hop = (size_t)std::max(obs_data_get_int(settings, P_MIN_HOP), 0ll);
+    }
+    m_analysis_phase = AnalysisWorker::assign_phase(this, m_analysis_interval);
+    m_preview_phase = AnalysisWorker::assign_phase(&m_preview_phase, m_preview_interval);
+    m_active.store(obs_source_active(m_source), std::memory_order_relaxed);
+
+    // smoothing moves from the bins to the display points, the bin stage then runs without it
+    m_display_tsmoothing = TSmoothingMode::NONE;
+    if(obs_data_get_bool(settings, P_DISPLAY_TSMOOTH) && !m_meter_mode && !time_domain())
+    {
+        std::swap(m_display_tsmoothing, m_tsmoothing);
+        m_half_history = false;
+    }
 
     if(m_radial)
     {
@@ -665,9 +1492,15 @@ void WAVSource::get_settings(obs_data_t *settings)
         m_height -= (int)m_deadzone;
     }
 
+    get_live_settings(settings);
+
     if(!m_meter_mode && p_equ(channel_mode, P_SINGLE))
         m_channel_mode = ChannelMode::SINGLE;
-    else if(p_equ(channel_mode, P_STEREO))
+    else if(!m_meter_mode && !time_domain() && p_equ(channel_mode, P_SURROUND))
+        m_channel_mode = ChannelMode::SURROUND;
+    else if(!m_meter_mode && !time_domain() && !m_view && (m_iir_fraction == 0) && m_stereo && p_equ(channel_mode, P_MID_SIDE))
+        m_channel_mode = ChannelMode::MID_SIDE; // a view draws the parent's channels, the filterbank has no transform to combine
+    else if(p_equ(channel_mode, P_STEREO) || p_equ(channel_mode, P_MID_SIDE))
         m_channel_mode = ChannelMode::STEREO;
     else
         m_channel_mode = ChannelMode::MONO;
@@ -677,8 +1510,11 @@ void WAVSource::recapture_audio()
 {
     // release old capture
     release_audio_capture();
+    if(m_view)
+        return; // the parent is found by tick_view()
 
     // add new capture
+    std::shared_ptr<CaptureStream> stream;
     auto src_name = m_audio_source_name.c_str();
     if(p_equ(src_name, P_NONE))
         return;
@@ -686,28 +1522,20 @@ void WAVSource::recapture_audio()
     {
         if(m_audio_info.speakers != speaker_layout::SPEAKERS_UNKNOWN)
         {
-            auto audio = obs_get_audio();
-            auto info = audio_output_get_info(audio);
-            if((info->format == audio_format::AUDIO_FORMAT_FLOAT_PLANAR) && (info->samples_per_sec == m_audio_info.samples_per_sec) && (info->speakers == m_audio_info.speakers))
-            {
-                m_output_bus_captured = audio_output_connect(audio, 0, nullptr, &callbacks::capture_output_bus, this);
-            }
-            else
-            {
-                audio_convert_info cvt{};
-                cvt.format = audio_format::AUDIO_FORMAT_FLOAT_PLANAR;
-                cvt.samples_per_sec = m_audio_info.samples_per_sec;
-                cvt.speakers = m_audio_info.speakers;
-                m_output_bus_captured = audio_output_connect(audio, 0, &cvt, &callbacks::capture_output_bus, this);
-            }
+            stream = CaptureStream::get_output_stream(m_output_track);
+            m_output_bus_captured = (stream != nullptr);
         }
     }
     else
     {
-        auto asrc = obs_get_source_by_name(src_name);
+        // loaded before the lookup, a source created meanwhile bumps it again
+        m_source_gen = AudioSourceList::generation();
+        auto asrc = AudioSourceList::get(m_audio_source_uuid);
+        if(asrc == nullptr)
+            asrc = obs_get_source_by_name(src_name);
         if(asrc != nullptr)
         {
-            obs_source_add_audio_capture_callback(asrc, &callbacks::capture_audio, this);
+            stream = CaptureStream::get_source_stream(asrc, m_ignore_mute);
             m_audio_source = obs_source_get_weak_source(asrc);
             obs_source_release(asrc);
         }
@@ -717,41 +1545,196 @@ void WAVSource::recapture_audio()
                 LogWarn << "Failed to get audio source: \"" << src_name << "\"";
         }
     }
+
+    if((stream == nullptr) || (m_capture_channels == 0))
+        return;
+
+    // start a window behind the live position to avoid startup lag e.g. when changing settings
+    // a stream that was already running primes us with real audio, a new one with silence
+    // spectrum modes reserve for the largest regular FFT so resizing it doesn't grow the stream again
+    // the filterbank takes every sample once, like the meter it starts from the live position
+    const auto iir = m_iir_fraction > 0;
+    auto window = time_domain() ? m_waveform_samples : iir ? m_iir_window : m_fft_size;
+    if(!m_meter_mode && !time_domain() && !iir)
+        window = std::max(window, MAX_FFT_SIZE) + (m_stft_hop * MAX_STFT_FRAMES);
+    m_capture.attach(stream, m_channel_base, m_mix_channels, window + m_capture_lag, (m_meter_mode || iir) ? 0 : m_fft_size);
+    // the loudness window too, so volume normalization doesn't boost a mostly silent window after every update
+    if(m_normalize_volume)
+        m_rms_capture.attach(stream, m_channel_base, m_mix_channels, m_input_rms_size + m_capture_lag, m_input_rms_size);
+    bind_capture_log();
+}
+
+// the log follows this source's capture, the blocks of a stream go to the last source that bound it
+void WAVSource::bind_capture_log()
+{
+    const auto& stream = m_capture.stream();
+    auto current = m_capture_log_stream.lock();
+    if((m_capture_log == nullptr) || (current == stream))
+        return;
+    if(current != nullptr)
+        current->drop_log(m_capture_log.get());
+    m_capture_log_stream = stream;
+    if(stream != nullptr)
+        stream->set_log(m_capture_log);
+}
+
+void WAVSource::close_capture_log()
+{
+    // the stream lets go first, a log is only closed once the audio thread can't reach it
+    if(auto stream = m_capture_log_stream.lock())
+        stream->drop_log(m_capture_log.get());
+    m_capture_log_stream.reset();
+    m_capture_log.reset();
 }
 
 void WAVSource::release_audio_capture()
 {
     if(m_audio_source != nullptr)
     {
-        auto src = obs_weak_source_get_source(m_audio_source);
         obs_weak_source_release(m_audio_source);
         m_audio_source = nullptr;
-        if(src != nullptr)
-        {
-            obs_source_remove_audio_capture_callback(src, &callbacks::capture_audio, this);
-            obs_source_release(src);
-        }
     }
-
-    if(m_output_bus_captured)
+    if(m_parent != nullptr)
     {
-        m_output_bus_captured = false;
-        audio_output_disconnect(obs_get_audio(), 0, &callbacks::capture_output_bus, this);
+        obs_weak_source_release(m_parent);
+        m_parent = nullptr;
     }
-
-    // reset circular buffers
-    for(auto& i : m_capturebufs)
+    if(m_playback_clock != nullptr)
     {
-        i.end_pos = 0;
-        i.start_pos = 0;
-        i.size = 0;
+        obs_weak_source_release(m_playback_clock);
+        m_playback_clock = nullptr;
     }
-    m_rms_sync_buf.end_pos = 0;
-    m_rms_sync_buf.start_pos = 0;
-    m_rms_sync_buf.size = 0;
+    m_output_bus_captured = false;
+
+    if(m_capture_overruns > 0)
+        LogInfo << "Audio capture dropped " << m_capture_overruns << " samples in total";
+    m_capture_overruns = 0;
 
+    // the stream detaches from OBS once its last reader is gone
+    m_capture.detach();
+    m_rms_capture.detach();
     m_capture_ts = 0;
     m_audio_ts = 0;
+
+    // cached spectra are only valid for the capture they came from
+    SpectrumCache::release(this);
+    TransformCache::release(this);
+    for(auto& sdft : m_sdft)
+        sdft.reset();
+}
+
+SpectrumKey WAVSource::get_spectrum_key() const
+{
+    SpectrumKey key;
+    key.stream = m_capture.stream().get();
+    key.channel_base = m_channel_base;
+    key.capture_channels = m_capture_channels;
+    key.stereo = m_stereo;
+    key.mid_side = m_channel_mode == ChannelMode::MID_SIDE;
+    key.downmix = m_downmix;
+    key.mix_channels = m_mix_channels;
+    if(m_downmix)
+        std::copy(std::begin(m_mix_weights), std::end(m_mix_weights), key.mix_weights.begin());
+    key.fft_size = m_fft_size;
+    key.stft_hop = m_stft_hop;
+    key.stft_peak = m_stft_peak;
+    key.sliding_dft = m_sliding_dft;
+    key.multires = m_multires;
+    key.decimation = (uint32_t)m_decimation;
+    key.pruned_bins = m_goertzel.bins();
+    key.first_bin = m_first_bin;
+    key.last_bin = m_last_bin;
+    key.window_func = (int)m_window_func;
+    key.sine_exponent = (m_window_func == FFTWindow::POWER_OF_SINE) ? m_sine_exponent : 0;
+    key.bin_window = !m_window_taps.empty();
+    key.power_bands = m_power_bands;
+    key.tsmoothing = (int)m_tsmoothing;
+    key.gravity = m_gravity;
+    key.fast_peaks = m_fast_peaks;
+    key.half_history = m_half_history;
+    key.slope = m_slope;
+    key.ts_offset = m_ts_offset;
+    key.low_latency = m_low_latency;
+    key.floor = m_floor;
+    key.cutoff_low = m_cutoff_low;
+    key.cutoff_high = m_cutoff_high;
+    key.rolloff_q = m_rolloff_q;
+    key.rolloff_rate = m_rolloff_rate;
+    key.normalize_volume = m_normalize_volume;
+    if(m_normalize_volume)
+    {
+        key.volume_target = m_volume_target;
+        key.max_gain = m_max_gain;
+    }
+    return key;
+}
+
+TransformKey WAVSource::get_transform_key() const
+{
+    TransformKey key;
+    key.stream = m_capture.stream().get();
+    key.channel_base = m_channel_base;
+    key.capture_channels = m_capture_channels;
+    key.fft_channels = m_fft_channels;
+    key.downmix = m_downmix;
+    if(m_downmix)
+        std::copy(std::begin(m_mix_weights), std::end(m_mix_weights), key.mix_weights.begin());
+    key.fft_size = m_fft_size;
+    key.window_func = (int)m_window_func;
+    key.sine_exponent = (m_window_func == FFTWindow::POWER_OF_SINE) ? m_sine_exponent : 0;
+    key.bin_window = !m_window_taps.empty();
+    key.ts_offset = m_ts_offset;
+    key.low_latency = m_low_latency;
+    return key;
+}
+
+bool WAVSource::share_transform() const
+{
+    // one plain FFT per tick, hops, the sliding DFT and the other transforms keep state of their own
+    // shared transforms stop short of nyquist, a window on the bins mustn't reach it
+    const auto bin_window = m_window_taps.empty() || ((m_last_bin + m_window_taps.size() - 1) <= (m_fft_size / 2));
+    return m_show && (m_capture.stream() != nullptr) && (m_stft_hop == 0) && !m_sliding_dft && m_goertzel.empty() && (m_decimation == 1) && !m_gpu_fft && bin_window;
+}
+
+bool WAVSource::fetch_transform(bool silent[2])
+{
+    return share_transform() && TransformCache::fetch(get_transform_key(), m_frame_ts, m_fft_output.get(), silent);
+}
+
+void WAVSource::publish_transform(const bool transform[2], const bool silent[2])
+{
+    // channels skipped for silence hold no transform, only publish complete sets
+    for(auto channel = 0u; channel < m_fft_channels; ++channel)
+        if(!transform[channel])
+            return;
+    if(share_transform())
+        TransformCache::publish(this, get_transform_key(), m_frame_ts, m_fft_output.get(), silent);
+}
+
+bool WAVSource::park_audio_capture(float seconds)
+{
+    // a source hidden for a while lets go of its capture, the stream stops copying for it
+    // and the last reader leaving detaches it from OBS, nothing is left on the audio thread
+    if(m_show || m_headless)
+    {
+        m_hidden_seconds = 0.0f;
+        if(m_parked)
+        {
+            // primed a window behind the live position, real audio if the stream kept running for others
+            m_parked = false;
+            m_next_retry = 0.0f;
+            recapture_audio();
+        }
+        return true;
+    }
+    if(m_parked)
+        return false;
+    m_hidden_seconds += seconds;
+    if(m_hidden_seconds < PARK_DELAY)
+        return true; // the display is already silent, a quick show() finds the capture still running
+    release_audio_capture();
+    m_parked = true;
+    return false;
 }
 
 bool WAVSource::check_audio_capture(float seconds)
@@ -759,6 +1742,24 @@ bool WAVSource::check_audio_capture(float seconds)
     if(m_output_bus_captured)
         return true;
 
+    // the output bus has no source signals, it is retried on a timer
+    if(p_equ(m_audio_source_name.c_str(), P_OUTPUT_BUS))
+    {
+        m_next_retry -= seconds;
+        if(m_next_retry <= 0.0f)
+        {
+            m_next_retry = RETRY_DELAY;
+            recapture_audio();
+        }
+        return m_output_bus_captured;
+    }
+
+    // sources only come and go with the signals AudioSourceList follows, nothing to check until one fires
+    const auto gen = AudioSourceList::generation();
+    if(gen == m_source_gen)
+        return m_audio_source != nullptr;
+    m_source_gen = gen;
+
     // check if the source still exists
     if(m_audio_source != nullptr)
     {
@@ -769,20 +1770,10 @@ bool WAVSource::check_audio_capture(float seconds)
             obs_source_release(src);
     }
 
-    // if we've lost our source, periodically try to recapture it
+    // if we've lost our source, look for one that took its name
     if(m_audio_source == nullptr)
-    {
-        m_next_retry -= seconds;
-        if(m_next_retry <= 0.0f)
-        {
-            m_next_retry = RETRY_DELAY;
-            recapture_audio();
-            if((m_audio_source != nullptr) || m_output_bus_captured)
-                return true;
-        }
-        return false;
-    }
-    return true;
+        recapture_audio();
+    return m_audio_source != nullptr;
 }
 
 void WAVSource::free_bufs()
@@ -791,879 +1782,4013 @@ void WAVSource::free_bufs()
     {
         m_decibels[i].reset();
         m_tsmooth_buf[i].reset();
+        m_peak_db[i].reset();
+        m_peak_timer[i].reset();
+        m_display_db[i] = nullptr; // the frames keep their storage, reset_frames() resizes it
     }
+    m_meter_window.reset();
 
     m_fft_input.reset();
     m_fft_output.reset();
-    m_window_coefficients.reset();
-    m_slope_modifiers.reset();
     m_input_rms_buf.reset();
-    m_rms_temp_buf.reset();
-    m_rolloff_modifiers.reset();
+    m_decimated_input.reset();
+    m_decimated_output.reset();
+    m_analysis.reset();
+    m_tables = nullptr;
+    m_iir.clear();
+    m_iir_input.reset();
 
     m_kernel = {};
-    m_interp_kernel = {};
+    m_interp = InterpLayout::none();
+    m_window_taps.clear();
 
-    if(m_fft_plan != nullptr)
-    {
-        fftwf_destroy_plan(m_fft_plan);
-        m_fft_plan = nullptr;
-    }
+    m_fft.reset();
 
     m_fft_size = 0;
 }
 
-bool WAVSource::sync_rms_buffer()
+void WAVSource::update_fft_plan()
 {
-    const int64_t dtaudio = get_audio_sync(m_tick_ts);
-    const size_t dtsize = (dtaudio > 0) ? size_t(ns_to_audio_frames(m_audio_info.samples_per_sec, (uint64_t)dtaudio)) * sizeof(float) : 0;
-
-    if(m_rms_sync_buf.size <= dtsize)
-        return false;
+    // busy is retried next tick
+    if(m_decimation > 1)
+        m_fft.update((int)(m_fft_size / m_decimation), (int)m_fft_channels * (m_multires ? 2 : 1), m_decimated_input.get(), m_decimated_output.get());
+    else
+        m_fft.update((int)m_fft_size, (int)m_fft_channels, m_fft_input.get(), m_fft_output.get());
+}
 
-    while(m_rms_sync_buf.size > dtsize)
+void WAVSource::fill_meter_window(size_t dtsize)
+{
+    // m_meter_window holds the last m_fft_size frames of every channel as one interleaved ring
+    // so the reductions run across all channels at once, the kernel sees one block of frames
+    // for RMS the sum of squares follows along, minus what is overwritten plus what replaces it
+    // so the cost goes with the new samples, not the window
+    // for peak only the blocks that were written are rescanned and their path up the max tree redone
+    // loudness meters take the new samples as they land in the ring
+    const auto loudness = m_loudness_mode != LoudnessMode::NONE;
+    const auto rms = m_meter_rms && !loudness;
+    const auto lanes = m_meter_lanes;
+    const auto channels = m_capture_channels;
+    if((channels == 0) || !m_meter_window)
+        return;
+    float peaks[MAX_AUDIO_CHANNELS];
+    float squares[MAX_AUDIO_CHANNELS];
+    const auto update_peaks = [&](size_t begin, size_t end) {
+        auto& tree = m_meter_peaks;
+        if(tree.empty() || (begin >= end))
+            return;
+        auto lo = begin / METER_BLOCK;
+        auto hi = (end - 1) / METER_BLOCK;
+        for(auto block = lo; block <= hi; ++block)
+        {
+            const auto first = block * METER_BLOCK;
+            const auto last = std::min(first + METER_BLOCK, m_fft_size);
+            DSPKernels::get().meter_reduce(&m_meter_window[first * lanes], last - first, lanes, &tree[(m_meter_leaves + block) * lanes], squares);
+        }
+        for(lo = (m_meter_leaves + lo) / 2, hi = (m_meter_leaves + hi) / 2; lo > 0; lo /= 2, hi /= 2)
+            for(auto node = lo; node <= hi; ++node)
+                for(auto lane = 0u; lane < lanes; ++lane)
+                    tree[(node * lanes) + lane] = std::max(tree[(2 * node * lanes) + lane], tree[(((2 * node) + 1) * lanes) + lane]);
+    };
+
+    // channels move together, whatever one of them is short waits for the next tick
+    auto avail = std::numeric_limits<size_t>::max();
+    for(auto channel = 0u; channel < channels; ++channel)
+        avail = std::min(avail, (m_capture.size(channel) > dtsize) ? m_capture.size(channel) - dtsize : 0);
+    float chunk[METER_BLOCK];
+    while(avail > 0)
     {
-        auto consume = m_rms_sync_buf.size - dtsize;
-        auto max = (m_input_rms_size - m_input_rms_pos) * sizeof(float);
-        if(consume >= max)
+        // at most one peak block at a time, popped per channel and interleaved into the ring
+        const auto pos = m_meter_pos;
+        const auto count = std::min({ avail, m_fft_size - pos, METER_BLOCK - (pos % METER_BLOCK) });
+        const auto dst = &m_meter_window[pos * lanes];
+        if(rms)
         {
-            circlebuf_pop_front(&m_rms_sync_buf, &m_input_rms_buf[m_input_rms_pos], max);
-            m_input_rms_pos = 0;
+            DSPKernels::get().meter_reduce(dst, count, lanes, peaks, squares);
+            for(auto channel = 0u; channel < channels; ++channel)
+                m_meter_sum[channel] -= squares[channel];
+        }
+        for(auto channel = 0u; channel < channels; ++channel)
+        {
+            m_capture.pop(channel, chunk, count);
+            for(size_t i = 0; i < count; ++i)
+                dst[(i * lanes) + channel] = chunk[i];
+            if(loudness)
+                m_loudness.process(channel, chunk, count);
+        }
+        m_meter_pos = (pos + count == m_fft_size) ? 0 : pos + count;
+        avail -= count;
+        if(loudness)
+            continue;
+        if(!rms)
+        {
+            update_peaks(pos, pos + count);
+            continue;
+        }
+        if(m_meter_pos == 0)
+        {
+            // exact once per lap, rounding never builds up
+            std::fill(std::begin(m_meter_sum), std::end(m_meter_sum), 0.0);
+            for(size_t first = 0; first < m_fft_size; first += METER_BLOCK)
+            {
+                DSPKernels::get().meter_reduce(&m_meter_window[first * lanes], std::min(METER_BLOCK, m_fft_size - first), lanes, peaks, squares);
+                for(auto channel = 0u; channel < channels; ++channel)
+                    m_meter_sum[channel] += squares[channel];
+            }
         }
         else
         {
-            circlebuf_pop_front(&m_rms_sync_buf, &m_input_rms_buf[m_input_rms_pos], consume);
-            m_input_rms_pos += consume / sizeof(float);
+            DSPKernels::get().meter_reduce(dst, count, lanes, peaks, squares);
+            for(auto channel = 0u; channel < channels; ++channel)
+                m_meter_sum[channel] += squares[channel];
         }
     }
+}
 
-    return true;
+void WAVSource::reset_meter_window()
+{
+    m_loudness.reset();
+    for(auto& i : m_meter_sum)
+        i = 0.0;
+    std::fill(m_meter_peaks.begin(), m_meter_peaks.end(), 0.0f);
 }
 
-void WAVSource::init_interp(unsigned int sz)
+void WAVSource::tick_iir_bands(float seconds)
 {
-    const auto maxbin = (m_fft_size / 2) - 1;
-    const auto sr = (float)m_audio_info.samples_per_sec;
-    float lowbin, highbin;
-    if(m_display_mode == DisplayMode::WAVEFORM)
+    // every sample goes through the filters once as it leaves the capture ring, like the loudness meter
+    // the energy summed since the last tick is the band level, smoothed like the bins of a spectrum
+    const auto bands = m_iir.bands();
+    const auto display_channels = m_stereo ? 2u : 1u;
+    const auto dtcapture = m_tick_ts - m_capture_ts;
+    if(!m_show || (dtcapture > CAPTURE_TIMEOUT))
     {
-        lowbin = 0.0f;
-        highbin = (float)(m_fft_size - 1);
+        if(m_last_silent)
+            return;
+        m_iir.reset();
+        for(auto channel = 0u; channel < m_fft_channels; ++channel)
+            if(m_tsmooth_buf[channel] != nullptr)
+                std::fill_n(m_tsmooth_buf[channel].get(), m_tsmooth_buf[channel].size(), 0.0f);
+        for(auto channel = 0u; channel < display_channels; ++channel)
+            std::fill_n(m_decibels[channel].get(), bands, DB_MIN);
+        m_last_silent = true;
+        return;
     }
-    else
+
+    const int64_t dtaudio = get_audio_sync(m_sync_ts);
+    const size_t reserve = audio_frames(dtaudio);
+    auto available = m_capture.size(0);
+    for(auto i = 1u; i < m_capture.channels(); ++i)
+        available = std::min(available, m_capture.size(i));
+    if(available <= reserve)
+        return; // nothing new, keep the last levels
+    auto pending = available - reserve;
+
+    // silence stays silence without running the filters
+    auto silent = m_last_silent;
+    for(auto i = 0u; silent && (i < m_capture.channels()); ++i)
+        silent = m_capture.silent(i);
+    if(silent)
     {
-        lowbin = std::clamp((float)m_cutoff_low * m_fft_size / sr, 1.0f, (float)maxbin);
-        highbin = std::clamp((float)m_cutoff_high * m_fft_size / sr, 1.0f, (float)maxbin);
+        for(auto i = 0u; i < m_capture.channels(); ++i)
+            m_capture.pop(i, nullptr, pending);
+        m_iir.reset();
+        return;
     }
 
-    m_interp_indices.resize(sz);
-    if(m_log_scale)
+    const auto src = m_iir_input.get();
+    while(pending > 0)
     {
-        for(auto i = 0u; i < sz; ++i)
-            m_interp_indices[i] = std::clamp(log_interp(lowbin, highbin, (m_mirror_freq_axis ? i * 2.0f : (float)i) / (float)(sz - 1)), lowbin, highbin);
+        const auto count = std::min(pending, IIR_CHUNK);
+        for(auto channel = 0u; channel < m_fft_channels; ++channel)
+        {
+            if(m_downmix)
+            {
+                // weighted sum to mono, every subscribed channel shares the same read position
+                auto mixed = false;
+                for(auto i = 0u; i < m_capture.channels(); ++i)
+                {
+                    const auto weight = m_mix_weights[i];
+                    if(weight != 0.0f)
+                    {
+                        m_capture.visit(i, count, [&](const float *in, size_t n, size_t offset) {
+                            for(size_t j = 0; j < n; ++j)
+                                src[offset + j] = (mixed ? src[offset + j] : 0.0f) + (in[j] * weight);
+                            });
+                        mixed = true;
+                    }
+                    m_capture.pop(i, nullptr, count);
+                }
+                if(!mixed)
+                    std::fill_n(src, count, 0.0f);
+            }
+            else
+                m_capture.pop(channel, src, count);
+
+            DSPKernels::get().iir(m_iir.pass(channel, src, count));
+        }
+        pending -= count;
     }
-    else
+
+    // magnitude, or power for power smoothing, then time smoothing the same as the spectrum bins
+    const auto power = m_tsmoothing == TSmoothingMode::POWER;
+    const auto g = get_gravity(seconds);
+    const auto g2 = 1.0f - g;
+    for(auto channel = 0u; channel < m_fft_channels; ++channel)
     {
-        for(auto i = 0u; i < sz; ++i)
-            m_interp_indices[i] = std::clamp(lerp(lowbin, highbin, (m_mirror_freq_axis ? i * 2.0f : (float)i) / (float)(sz - 1)), lowbin, highbin);
+        const auto level = m_decibels[channel].get();
+        m_iir.take_energy(channel, level);
+        if(!power)
+            for(size_t i = 0; i < bands; ++i)
+                level[i] = std::sqrt(level[i]);
+        if(m_tsmoothing == TSmoothingMode::NONE)
+            continue;
+        const auto history = m_tsmooth_buf[channel].get();
+        for(size_t i = 0; i < bands; ++i)
+        {
+            const auto oldval = m_fast_peaks ? std::max(level[i], history[i]) : history[i];
+            const auto mag = (g * oldval) + (g2 * level[i]);
+            history[i] = level[i] = (mag >= std::numeric_limits<float>::min()) ? mag : 0.0f;
+        }
+    }
+
+    // channel mix, dBFS and volume compensation
+    const auto dbscale = power ? 0.5f : 1.0f;
+    const auto compensation = m_normalize_volume ? std::min(m_volume_target - dbfs(m_input_rms), m_max_gain) : 0.0f;
+    const auto mix = !m_stereo && (m_fft_channels > 1);
+    const auto copy = m_stereo && (m_fft_channels < 2);
+    auto outsilent = true;
+    const auto floor = (float)(m_floor - 10);
+    for(size_t i = 0; i < bands; ++i)
+    {
+        auto mag = m_decibels[0][i];
+        if(mix)
+            mag = (mag + m_decibels[1][i]) * 0.5f;
+        const auto db = (dbfs(mag) * dbscale) + compensation;
+        m_decibels[0][i] = db;
+        outsilent = outsilent && (db <= floor);
+        if(!m_stereo)
+            continue;
+        const auto db2 = copy ? db : (dbfs(m_decibels[1][i]) * dbscale) + compensation;
+        m_decibels[1][i] = db2;
+        outsilent = outsilent && (db2 <= floor);
     }
+    m_last_silent = outsilent;
+}
+
+bool WAVSource::check_view_layout()
+{
+    std::lock_guard lock(m_mtx);
+    if(!m_view || m_meter_mode)
+        return false;
+    const auto size = m_view_fft_size.load(std::memory_order_relaxed);
+    return (size >= 16) && (size != m_fft_size);
+}
+
+void WAVSource::silence_view()
+{
+    if(m_last_silent)
+        return;
+    if(m_meter_mode)
+        std::fill(std::begin(m_meter_val), std::end(m_meter_val), DB_MIN);
+    else
+        for(auto channel = 0u; channel < (m_stereo ? 2u : 1u); ++channel)
+            std::fill_n(m_decibels[channel].get(), m_fft_size / 2, DB_MIN);
+    m_last_silent = true;
+}
 
-    // bar bands
-    if((m_display_mode == DisplayMode::BAR) || (m_display_mode == DisplayMode::STEPPED_BAR))
+void WAVSource::tick_playback(float seconds)
+{
+    if(!m_playback.ready())
     {
-        m_band_widths.resize(m_num_bars);
-        for(auto i = 0; i < m_num_bars; ++i)
-            m_band_widths[i] = std::max((int)(m_interp_indices[i + 1] - m_interp_indices[i]), 1);
+        silence_view();
+        return;
     }
 
-    // interpolation filter
-    if(m_interp_mode != InterpMode::POINT)
+    // a media source as the audio source is the clock, anything else loops the recording
+    auto clock = (m_playback_clock != nullptr) ? obs_weak_source_get_source(m_playback_clock) : nullptr;
+    if(clock == nullptr)
     {
-        if((m_display_mode != DisplayMode::CURVE) && (m_display_mode != DisplayMode::WAVEFORM))
+        if(m_playback_clock != nullptr)
         {
-            // at this point m_interp_indices only contains the start of each band
-            // so we'll fill in the intermediate points here
-            std::vector<float> samples;
-            samples.reserve((size_t)std::ceil(highbin - lowbin));
-            for(auto i = 0; i < m_num_bars; ++i)
+            obs_weak_source_release(m_playback_clock);
+            m_playback_clock = nullptr;
+        }
+        m_parent_retry -= seconds;
+        if((m_parent_retry <= 0.0f) && !p_equ(m_audio_source_name.c_str(), P_NONE) && !m_audio_source_name.empty())
+        {
+            m_parent_retry = RETRY_DELAY;
+            clock = obs_get_source_by_name(m_audio_source_name.c_str());
+            if((clock != nullptr) && ((obs_source_get_output_flags(clock) & OBS_SOURCE_CONTROLLABLE_MEDIA) == 0))
             {
-                auto count = m_band_widths[i];
-                for(auto j = 0; j < count; ++j)
-                    samples.push_back(m_interp_indices[i] + j);
+                obs_source_release(clock);
+                clock = nullptr;
             }
-            m_interp_indices = std::move(samples);
+            if(clock != nullptr)
+                m_playback_clock = obs_source_get_weak_source(clock);
         }
-
-        if(m_interp_mode == InterpMode::LANCZOS)
-            m_interp_kernel = make_lanczos_kernel(m_interp_indices, 4);
-        else if(m_interp_mode == InterpMode::CATROM)
-            m_interp_kernel = make_catrom_kernel(m_interp_indices, 0.5f);
     }
-}
+    int64_t position;
+    if(clock != nullptr)
+    {
+        position = obs_source_media_get_time(clock) * 1000000;
+        obs_source_release(clock);
+    }
+    else
+    {
+        const auto duration = (double)m_playback.duration() / 1e9;
+        m_playback_elapsed += seconds;
+        if((duration > 0.0) && (m_playback_elapsed > duration))
+            m_playback_elapsed = std::fmod(m_playback_elapsed, duration);
+        position = (int64_t)(m_playback_elapsed * 1e9);
+    }
 
-void WAVSource::init_rolloff()
-{
-    const auto sz = m_fft_size / 2;
-    const auto sr = (float)m_audio_info.samples_per_sec;
-    const auto coeff = sr / (float)m_fft_size;
-    const auto ratio = std::exp2(m_rolloff_q);
-    const auto freq_low = (float)m_cutoff_low * ratio;
-    const auto freq_high = (float)m_cutoff_high / ratio;
+    FramePlayback::Frame frame;
+    if(!m_playback.find((uint64_t)std::max(position + m_playback_offset, (int64_t)0), frame) || (frame.index + 1 == m_parent_sequence))
+        return;
+    if(m_meter_mode)
+    {
+        if(frame.count != 1)
+            return warn_playback("it holds no meter");
+        m_parent_sequence = frame.index + 1;
+        m_last_silent = true;
+        for(auto channel = 0u; channel < 2u; ++channel)
+        {
+            m_meter_val[channel] = FramePlayback::from_half(frame.values[std::min(channel, frame.channels - 1)]);
+            if(channel < m_capture_channels)
+                m_last_silent = m_last_silent && (m_meter_val[channel] < (m_floor - 10));
+        }
+        return;
+    }
 
-    m_rolloff_modifiers.reset(m_fft_size / 2);
-    m_rolloff_modifiers[0] = 0.0f;
-    for(size_t i = 1u; i < sz; ++i)
+    // bins are evenly spaced, bars aren't and can't be mapped back to them
+    const auto step = (frame.count > 2) ? (frame.hz[frame.count - 1] - frame.hz[0]) / (float)(frame.count - 1) : 0.0f;
+    if((step <= 0.0f) || (std::abs((frame.hz[1] - frame.hz[0]) - step) > (step * 0.01f)))
+        return warn_playback("it holds no spectrum bins");
+    for(auto channel = 0u; channel < frame.channels; ++channel)
     {
-        auto freq = i * coeff;
-        auto ratio_low = freq_low / freq;
-        auto ratio_high = freq / freq_high;
-        auto low_attenuation = (ratio_low > 1.0f) ? (m_rolloff_rate * std::log2(ratio_low)) : 0.0f;
-        auto high_attenuation = (ratio_high > 1.0f) ? (m_rolloff_rate * std::log2(ratio_high)) : 0.0f;
-        m_rolloff_modifiers[i] = low_attenuation + high_attenuation;
+        m_playback_values[channel].resize(frame.count);
+        const auto src = &frame.values[channel * frame.count];
+        for(size_t i = 0; i < frame.count; ++i)
+            m_playback_values[channel][i] = FramePlayback::from_half(src[i]);
     }
+    waveform_snapshot snapshot{};
+    snapshot.api_version = WAVEFORM_API_VERSION;
+    snapshot.channels = frame.channels;
+    snapshot.sequence = frame.index + 1;
+    snapshot.count = frame.count;
+    snapshot.values[0] = m_playback_values[0].data();
+    snapshot.values[1] = (frame.channels > 1) ? m_playback_values[1].data() : nullptr;
+    snapshot.frequencies = frame.hz;
+    copy_view_spectrum(&snapshot); // no audio_ts, the recorded ones belong to another session
 }
 
-void WAVSource::init_steps()
+void WAVSource::warn_playback(const char *reason)
 {
-    const auto x1 = 0.0f;
-    const auto x2 = (float)m_bar_width;
-    const auto y1 = 0.0f;
-    const auto y2 = (float)m_step_width;
-
-    vec3_set(&m_step_verts[0], x1, y1, 0);
-    vec3_set(&m_step_verts[1], x2, y1, 0);
-    vec3_set(&m_step_verts[2], x1, y2, 0);
-    vec3_set(&m_step_verts[3], x2, y1, 0);
-    vec3_set(&m_step_verts[4], x1, y2, 0);
-    vec3_set(&m_step_verts[5], x2, y2, 0);
+    if(std::exchange(m_playback_warned, true))
+        return;
+    LogWarn << "\"" << obs_source_get_name(m_source) << "\" can't play \"" << m_playback.path() << "\" in this display mode, " << reason;
 }
 
-WAVSource::WAVSource(obs_source_t *source)
+void WAVSource::tick_view(float seconds)
 {
-    m_source = source;
-    for(auto& i : m_capturebufs)
-        circlebuf_init(&i);
-    circlebuf_init(&m_rms_sync_buf);
+    if(m_playback.is_open())
+        return tick_playback(seconds);
 
-    obs_enter_graphics();
+    // a view finds its parent by name like the audio source, and lets go of it when it's gone
+    auto parent = (m_parent != nullptr) ? obs_weak_source_get_source(m_parent) : nullptr;
+    if(parent == nullptr)
+    {
+        if(m_parent != nullptr)
+        {
+            obs_weak_source_release(m_parent);
+            m_parent = nullptr;
+        }
+        m_parent_retry -= seconds;
+        if(m_parent_retry <= 0.0f)
+        {
+            m_parent_retry = RETRY_DELAY;
+            parent = obs_get_source_by_name(m_parent_name.c_str());
+            const auto id = (parent != nullptr) ? obs_source_get_unversioned_id(parent) : nullptr;
+            if((id == nullptr) || !p_equ(id, SOURCE_ID) || (parent == m_source))
+            {
+                if(parent != nullptr)
+                    LogWarn << "\"" << obs_source_get_name(m_source) << "\" can't show the analysis of \"" << m_parent_name << "\", not another waveform source";
+                obs_source_release(parent);
+                parent = nullptr;
+            }
+            else
+                m_parent = obs_source_get_weak_source(parent);
+        }
+    }
 
-    // create shader
-    auto filename = obs_module_file("gradient.effect");
-    m_shader = gs_effect_create_from_file(filename, nullptr);
-    bfree(filename);
+    // views of views could wait on each other's analysis, only a source that analyzes itself can be a parent
+    if((parent != nullptr) && static_cast<WAVSource*>(obs_obj_get_data(parent))->m_published_view.load(std::memory_order_relaxed))
+    {
+        obs_source_release(parent);
+        parent = nullptr;
+    }
 
-    obs_leave_graphics();
+    if(parent == nullptr)
+        return silence_view();
+
+    calldata_t cd = {};
+    const auto proc = obs_source_get_proc_handler(parent);
+    if(m_meter_mode)
+    {
+        if(proc_handler_call(proc, "get_meter", &cd))
+        {
+            m_meter_val[0] = (float)calldata_float(&cd, "left");
+            m_meter_val[1] = (float)calldata_float(&cd, "right");
+            m_audio_ts = (uint64_t)calldata_int(&cd, "audio_ts");
+            m_last_silent = true;
+            for(auto channel = 0u; channel < m_capture_channels; ++channel)
+                m_last_silent = m_last_silent && (m_meter_val[channel] < (m_floor - 10));
+        }
+    }
+    else if(proc_handler_call(proc, "get_spectrum", &cd))
+    {
+        const auto snapshot = static_cast<const waveform_snapshot*>(calldata_ptr(&cd, "snapshot"));
+        if((snapshot != nullptr) && (snapshot->api_version == WAVEFORM_API_VERSION) && (snapshot->sequence != m_parent_sequence))
+            copy_view_spectrum(snapshot);
+        if(snapshot != nullptr)
+            snapshot->release(snapshot);
+    }
+    calldata_free(&cd);
+    obs_source_release(parent);
 }
 
-WAVSource::~WAVSource()
+void WAVSource::copy_view_spectrum(const waveform_snapshot *snapshot)
 {
-    std::lock_guard lock(m_mtx);
-    obs_enter_graphics();
+    // the bin width gives the parent's transform size, bins of another size don't line up with ours
+    if(snapshot->count < 2)
+        return;
+    const auto bin_hz = (snapshot->frequencies[snapshot->count - 1] - snapshot->frequencies[0]) / (float)(snapshot->count - 1);
+    if(bin_hz <= 0.0f)
+        return;
+    const auto size = (size_t)std::llround((double)m_audio_info.samples_per_sec / bin_hz);
+    m_view_fft_size.store(size, std::memory_order_relaxed);
+    if(size != m_fft_size)
+        return; // tick() runs update() for the new size
+    m_parent_sequence = snapshot->sequence;
+    m_audio_ts = snapshot->audio_ts;
+
+    // bins the parent doesn't analyze stay at DB_MIN from update()
+    const auto bins = m_fft_size / 2;
+    const auto first = std::min((size_t)std::llround(snapshot->frequencies[0] / bin_hz), bins);
+    const auto count = std::min(snapshot->count, bins - first);
+    const auto floor = (float)(m_floor - 10);
+    auto silent = true;
+    for(auto channel = 0u; channel < (m_stereo ? 2u : 1u); ++channel)
+    {
+        const auto dst = &m_decibels[channel][first];
+        const auto src = snapshot->values[std::min(channel, snapshot->channels - 1)];
+        if(!m_stereo && (snapshot->channels > 1))
+        {
+            // mono of a stereo parent, the same magnitude average the spectrum takes
+            for(size_t i = 0; i < count; ++i)
+                dst[i] = dbfs((std::pow(10.0f, src[i] / 20.0f) + std::pow(10.0f, snapshot->values[1][i] / 20.0f)) * 0.5f);
+        }
+        else
+            std::copy(src, src + count, dst);
+        for(size_t i = 0; silent && (i < count); ++i)
+            silent = dst[i] <= floor;
+    }
+    m_last_silent = silent;
+}
 
-    gs_vertexbuffer_destroy(m_vbuf);
-    gs_effect_destroy(m_shader);
+size_t WAVSource::get_stft_frames(size_t dtsize)
+{
+    if((m_capture.channels() > 0) && (m_capture.size(0) < dtsize))
+    {
+        HealthCounters::count(m_health.underruns);
+        if(m_stft_hop > 0)
+            return 0;
+    }
+    if(m_stft_hop == 0)
+        return 1; // channels short of dtsize are skipped
 
-    obs_leave_graphics();
+    // every subscribed channel shares the same read position
+    auto frames = ((m_capture.size(0) - dtsize) / m_stft_hop) + 1;
+    if(frames > MAX_STFT_FRAMES)
+    {
+        // fell too far behind, drop the oldest hops
+        HealthCounters::count(m_health.overflows);
+        for(auto channel = 0u; channel < m_capture.channels(); ++channel)
+            m_capture.pop(channel, nullptr, (frames - MAX_STFT_FRAMES) * m_stft_hop);
+        frames = MAX_STFT_FRAMES;
+    }
+    return frames;
+}
 
-    release_audio_capture();
-    free_bufs();
+void WAVSource::advance_stft_frame()
+{
+    if(m_stft_hop == 0)
+        return;
+    for(auto channel = 0u; channel < m_capture.channels(); ++channel)
+        m_capture.pop(channel, nullptr, std::min(m_stft_hop, m_capture.size(channel)));
+}
 
-    for(auto& i : m_capturebufs)
-        circlebuf_free(&i);
-    circlebuf_free(&m_rms_sync_buf);
+void WAVSource::detect_onset(float frame_seconds)
+{
+    m_onset.feed(m_onset_flux[0], m_onset_flux[1], frame_seconds);
+    m_onset_flux[0] = m_onset_flux[1] = 0.0f;
 }
 
-unsigned int WAVSource::width()
+const fftwf_complex *WAVSource::transform_output(uint32_t channel) const
 {
-    std::lock_guard lock(m_mtx);
+    if(direct_decimation())
+        return &m_decimated_output[channel * (m_fft_size / m_decimation)];
+    return &m_fft_output[channel * m_fft_size];
+}
 
-    if(m_meter_mode)
-        return (m_bar_width * m_capture_channels) + ((m_capture_channels > 1) ? m_bar_gap : 0);
-    if(m_radial)
-        return (unsigned int)((m_height + m_deadzone) * 2);
-    return m_width;
+SpectrumBins WAVSource::bins_args(uint32_t channel, float frame_seconds)
+{
+    SpectrumBins args;
+    args.in[0] = transform_output(channel);
+    args.gains = m_tables->bin_gains.get();
+    args.history[0] = m_tsmooth_buf[channel].get();
+    args.out[0] = m_decibels[channel].get();
+    args.flux = m_beat_detection ? m_onset_flux : nullptr;
+    args.first_bin = m_first_bin;
+    args.last_bin = m_last_bin;
+    args.gravity = get_gravity(frame_seconds);
+    return args;
 }
 
-unsigned int WAVSource::height()
+void WAVSource::process_bins(const bool *transform, uint32_t *combined, float frame_seconds)
 {
-    std::lock_guard lock(m_mtx);
+    // both channels in one pass when they are at the same frame, the usual stereo case
+    if((m_fft_channels > 1) && transform[0] && transform[1] && (combined[0] == combined[1]))
+    {
+        auto args = bins_args(0, frame_seconds);
+        args.in[1] = transform_output(1);
+        args.history[1] = m_tsmooth_buf[1].get();
+        args.out[1] = m_decibels[1].get();
+        m_bins_fn[combined[0] > 0][1](args);
+        ++combined[0];
+        ++combined[1];
+        return;
+    }
 
-    if(m_radial)
-        return (unsigned int)((m_height + m_deadzone) * 2);
-    return m_height;
+    for(auto channel = 0u; channel < m_fft_channels; ++channel)
+    {
+        if(!transform[channel])
+            continue;
+        const auto accumulate = combined[channel]++ > 0;
+        m_bins_fn[accumulate][0](bins_args(channel, frame_seconds));
+    }
 }
 
-void WAVSource::create_vbuf() {
-    size_t num_verts = 0;
-    bool curve = (m_display_mode == DisplayMode::CURVE) || (m_display_mode == DisplayMode::WAVEFORM);
+SpectrumPost WAVSource::post_args(const uint32_t *combined)
+{
+    SpectrumPost args;
+    args.out[0] = m_decibels[0].get();
+    args.out[1] = m_decibels[1].get();
+    args.first_bin = m_first_bin;
+    args.last_bin = m_last_bin;
+    for(auto channel = 0u; channel < 2u; ++channel)
+        args.scale[channel] = (!m_stft_peak && (combined[channel] > 1)) ? 1.0f / (float)combined[channel] : 1.0f;
+    args.compensation = m_normalize_volume ? std::min(m_volume_target - dbfs(m_input_rms), m_max_gain) : 0.0f;
+    args.db_min = DB_MIN;
+    return args;
+}
 
-    if(curve)
-        num_verts = (size_t)((m_render_mode == RenderMode::LINE) ? m_width : (m_width * 2));
-    else
+void WAVSource::latch_capture()
+{
+    m_capture.latch();
+    m_rms_capture.latch();
+    m_capture_ts = m_capture.capture_ts();
+    m_audio_ts = m_capture.audio_ts();
+
+    // the stream overwrites audio we were too slow to read rather than stall the audio thread
+    const auto overruns = m_capture.overrun_samples();
+    if(overruns != m_capture_overruns)
     {
-        const auto step_stride = m_step_width + m_step_gap;
-        const auto center = (float)m_height / 2;
-        const auto bottom = (float)m_height;
-        const auto cpos = m_stereo ? center : bottom;
-        const auto channel_offset = m_channel_spacing * 0.5f;
+        if(m_capture_overruns == 0)
+            LogWarn << "Audio capture overrun, dropped " << (overruns - m_capture_overruns) << " samples";
+        HealthCounters::count(m_health.overflows);
+        m_capture_overruns = overruns;
+    }
+}
 
-        auto max_steps = (size_t)((cpos - channel_offset) / step_stride);
-        if(((int)cpos - (int)(max_steps * step_stride) - (int)channel_offset) > m_step_width)
-            ++max_steps;
+void WAVSource::trim_capture_bufs()
+{
+    // drop audio older than this tick could use, regardless of whether it goes on to consume anything
+    const int64_t dtaudio = get_audio_sync(m_sync_ts);
+    const size_t dtsamples = audio_frames(dtaudio);
+    const auto history = time_domain() ? m_waveform_samples : (m_iir_fraction > 0) ? m_iir_window : m_fft_size;
+    const auto max_size = dtsamples + history + (m_stft_hop * (MAX_STFT_FRAMES - 1));
+    for(auto channel = 0u; channel < m_capture.channels(); ++channel)
+        if(m_capture.size(channel) > max_size)
+            m_capture.pop(channel, nullptr, m_capture.size(channel) - max_size);
+
+    const auto max_rms_size = dtsamples + m_input_rms_size;
+    for(auto channel = 0u; channel < m_rms_capture.channels(); ++channel)
+        if(m_rms_capture.size(channel) > max_rms_size)
+            m_rms_capture.pop(channel, nullptr, m_rms_capture.size(channel) - max_rms_size);
+}
 
-        num_verts = (size_t)(m_num_bars * 6);
-        if((m_display_mode == DisplayMode::STEPPED_BAR) || (m_display_mode == DisplayMode::STEPPED_METER))
-            num_verts *= max_steps;
-        else if(m_rounded_caps)
-            num_verts += m_cap_tris * ((m_channel_spacing > 0) ? 12 : 6) * m_num_bars; // 2 caps per bar (middle omitted when 0 spacing)
-    }
+bool WAVSource::sync_rms_buffer()
+{
+    const int64_t dtaudio = get_audio_sync(m_sync_ts);
+    const size_t dtsize = audio_frames(dtaudio);
 
-    obs_enter_graphics();
+    // all channels share the same read position
+    if((m_rms_capture.channels() == 0) || (m_rms_capture.size(0) <= dtsize))
+        return false;
 
-    gs_vertexbuffer_destroy(m_vbuf);
+    while(m_rms_capture.size(0) > dtsize)
+    {
+        auto count = std::min(m_rms_capture.size(0) - dtsize, m_input_rms_size - m_input_rms_pos);
+        auto dst = &m_input_rms_buf[m_input_rms_pos];
 
-    auto vbdata = gs_vbdata_create();
-    vbdata->num = num_verts;
-    vbdata->points = (vec3*)bmalloc(num_verts * sizeof(vec3));
-    vbdata->num_tex = 1;
-    vbdata->tvarray = (gs_tvertarray*)bzalloc(sizeof(gs_tvertarray));
-    vbdata->tvarray->width = 2;
-    vbdata->tvarray->array = bmalloc(2 * num_verts * sizeof(float));
-    m_vbuf = gs_vertexbuffer_create(vbdata, GS_DYNAMIC);
+        // the running sum drops the squares about to be overwritten and takes the new ones below
+        for(size_t i = 0; i < count; ++i)
+            m_input_rms_sum -= dst[i];
 
-    if(curve) {
-        if(m_render_mode == RenderMode::LINE)
+        // sum only the largest sample of all channels from each time point
+        // this prevents excessive boosting when one channel is quiet (and reduces the amount of buffering required)
+        // read in place from the shared capture ring, nothing is copied out first
+        for(auto channel = 0u; channel < m_rms_capture.channels(); ++channel)
         {
-            for(auto i = 0u; i < m_width; ++i)
-                vec3_set(&vbdata->points[i], (float)i, 0, 0);
+            m_rms_capture.visit(channel, count, [=](const float *src, size_t n, size_t offset) {
+                for(size_t i = 0; i < n; ++i)
+                {
+                    auto val = std::abs(src[i]);
+                    dst[offset + i] = (channel == 0) ? val : std::max(val, dst[offset + i]);
+                }
+            });
+            m_rms_capture.pop(channel, nullptr, count);
         }
-        else
+        for(size_t i = 0; i < count; ++i)
         {
-            for(auto i = 0u; i < m_width; ++i)
-            {
-                vec3_set(&vbdata->points[i * 2], (float)i, 0, 0);
-                vec3_set(&vbdata->points[(i * 2) + 1], (float)i, 0, 0);
-            }
+            dst[i] *= dst[i];
+            m_input_rms_sum += dst[i];
         }
-    }
 
-    obs_leave_graphics();
+        m_input_rms_pos += count;
+        if(m_input_rms_pos >= m_input_rms_size)
+        {
+            m_input_rms_pos = 0;
+            m_input_rms_sum = 0.0; // exact once per lap, rounding never builds up
+            for(size_t i = 0; i < m_input_rms_size; ++i)
+                m_input_rms_sum += m_input_rms_buf[i];
+        }
+    }
+
+    return true;
 }
 
-void WAVSource::update(obs_data_t *settings)
+void WAVSource::update_input_rms()
 {
-    std::lock_guard lock(m_mtx);
-    constexpr auto pi = std::numbers::pi_v<float>;
+    assert(m_normalize_volume);
 
-    release_audio_capture();
-    free_bufs();
-    get_settings(settings);
+    if(!sync_rms_buffer())
+        return;
+    m_input_rms = (float)std::sqrt(std::max(m_input_rms_sum, 0.0) / (double)m_input_rms_size);
+}
 
-    // get current audio settings
-    update_audio_info(&m_audio_info);
-    const auto max_channels = get_audio_channels(m_audio_info.speakers);
-    m_capture_channels = std::min(max_channels, 2u);
-    if(m_capture_channels == 0)
-        LogWarn << "Unknown channel config: " << (unsigned int)m_audio_info.speakers;
-    if(m_channel_mode == ChannelMode::SINGLE)
+void WAVSource::init_interp(unsigned int sz)
+{
+    // filterbank bars read their band straight from m_decibels
+    if(m_iir_fraction > 0)
     {
-        if((m_channel_base < 0) || (m_channel_base >= (int)max_channels) || (m_channel_base >= MAX_AUDIO_CHANNELS))
+        auto layout = std::make_shared<InterpLayout>();
+        layout->indices.resize(sz);
+        layout->band_widths.assign(sz, 1);
+        layout->band_hz.resize(sz);
+        for(auto i = 0u; i < sz; ++i)
         {
-            m_capture_channels = 0;
-            m_channel_base = 0;
+            layout->indices[i] = (float)i;
+            layout->band_hz[i] = m_iir.edges()[i];
         }
-        else
-            m_capture_channels = std::min(m_capture_channels, 1u);
+        m_interp = std::move(layout);
+        return;
     }
-    else
-        m_channel_base = 0;
 
-    // meter mode
-    if(m_meter_mode)
-    {
-        // turn off stuff we don't need in this mode
-        m_window_func = FFTWindow::NONE;
-        m_interp_mode = InterpMode::POINT;
-        m_filter_mode = FilterMode::NONE;
-        m_pulse_mode = PulseMode::MAGNITUDE;
-        m_auto_fft_size = false;
-        m_slope = 0.0f;
-        m_stereo = false;
-        m_radial = false;
-        m_normalize_volume = false;
-        m_mirror_freq_axis = false;
-
-        // repurpose m_fft_size for meter buffer size
-        m_fft_size = size_t(m_audio_info.samples_per_sec * (m_meter_ms / 1000.0)) & -16;
+    // identical layouts are common across scenes, the bar count and band scale only matter to bars
+    const auto bars = (m_display_mode == DisplayMode::BAR) || (m_display_mode == DisplayMode::STEPPED_BAR);
+    InterpParams params;
+    params.size = sz;
+    params.fft_size = m_fft_size;
+    params.sample_rate = m_audio_info.samples_per_sec;
+    params.cutoff_low = m_cutoff_low;
+    params.cutoff_high = m_cutoff_high;
+    params.display_mode = (int)m_display_mode;
+    params.interp_mode = (int)m_interp_mode;
+    params.band_scale = bars ? (int)m_band_scale : 0;
+    params.num_bars = bars ? m_num_bars : 0;
+    params.log_scale = m_log_scale;
+    params.mirror_freq_axis = m_mirror_freq_axis;
+    m_interp = InterpLayout::request(params);
+}
 
-        memset(m_meter_pos, 0, sizeof(m_meter_pos));
-        for(auto& i : m_meter_buf)
-            i = DB_MIN;
-        for(auto& i : m_meter_val)
-            i = DB_MIN;
+// frequency domain kernel of the window, the periodic form of each cosine-sum window
+// empty for windows that aren't one
+std::vector<double> WAVSource::window_taps() const
+{
+    std::vector<double> taps;
+    switch(m_window_func)
+    {
+    case FFTWindow::NONE:
+        taps = { 1.0 };
+        break;
+    case FFTWindow::HANN:
+        taps = { 0.5, -0.25 };
+        break;
+    case FFTWindow::HAMMING:
+        taps = { 0.53836, -0.46164 / 2 };
+        break;
+    case FFTWindow::BLACKMAN:
+        taps = { 0.42, -0.5 / 2, 0.08 / 2 };
+        break;
+    case FFTWindow::BLACKMAN_HARRIS:
+        taps = { 0.35875, -0.48829 / 2, 0.14128 / 2, -0.01168 / 2 };
+        break;
+    case FFTWindow::POWER_OF_SINE:
+        // sin^2p is a cosine sum with binomial coefficients, odd powers aren't
+        if((m_sine_exponent > 0) && ((m_sine_exponent % 2) == 0))
+        {
+            const auto p = m_sine_exponent / 2;
+            const auto scale = std::ldexp(1.0, -2 * p);
+            auto binom = 1.0; // C(2p, p - j), built from j = p down
+            taps.assign((size_t)p + 1, 0.0);
+            for(auto j = p; j >= 0; --j)
+            {
+                taps[(size_t)j] = ((j % 2) ? -scale : scale) * binom;
+                binom = binom * (double)(2 * p - (p - j)) / (double)(p - j + 1);
+            }
+        }
+        break;
     }
-    else if(m_display_mode == DisplayMode::WAVEFORM)
+    return taps;
+}
+
+void WAVSource::init_sliding_dft()
+{
+    const auto taps = window_taps();
+    if(!m_sliding_dft || taps.empty())
     {
-        // turn off stuff we don't need in this mode
-        m_window_func = FFTWindow::NONE;
-        m_pulse_mode = PulseMode::MAGNITUDE;
-        m_auto_fft_size = false;
-        m_slope = 0.0f;
-        m_mirror_freq_axis = false;
-        m_log_scale = false;
+        if(m_sliding_dft)
+            LogInfo << "Sliding DFT does not support this window, using the FFT";
+        m_sliding_dft = false;
+        return;
+    }
 
-        // repurpose m_fft_size for buffer size
-        m_fft_size = m_width;
-        m_waveform_samples = size_t(m_audio_info.samples_per_sec * (m_meter_ms / 1000.0));
-        m_waveform_ts = 0;
+    // a few bins of margin for interpolation and bar edges
+    constexpr size_t margin = 8;
+    const auto sr = (float)m_audio_info.samples_per_sec;
+    const auto first = (size_t)std::max((float)m_cutoff_low * m_fft_size / sr, 0.0f);
+    const auto last = (size_t)std::ceil((float)m_cutoff_high * m_fft_size / sr);
+    for(auto channel = 0u; channel < m_fft_channels; ++channel)
+        m_sdft[channel].init(m_fft_size, (first > margin) ? first - margin : 0, last + margin, taps);
+}
+
+void WAVSource::init_decimation()
+{
+    if(m_decimation <= 1)
+    {
+        m_decimated_input.reset();
+        m_decimated_output.reset();
+        m_decimator.clear();
+        return;
     }
 
-    if(m_normalize_volume)
+    // in multires mode both transforms of a channel are back to back, low band first
+    const auto n = m_fft_size / m_decimation;
+    const auto transforms = m_fft_channels * (m_multires ? 2 : 1);
+    m_decimated_input.reset(n * transforms);
+    m_decimated_output.reset(n * transforms);
+
+    // blackman windowed sinc at the decimated nyquist
+    // the transition spans from the cutoff to its alias, aliasing only folds back above the cutoff
+    // multires has no cutoff, everything below a quarter of the decimated rate is clear there
+    auto taps = 12 * m_decimation;
+    if(!m_multires && (m_cutoff_high > 0))
     {
-        m_input_rms = 0.0f;
-        m_input_rms_size = size_t(m_audio_info.samples_per_sec) & -16;
-        m_input_rms_pos = 0;
-        m_input_rms_buf.reset(m_input_rms_size);
-        m_rms_temp_buf.reset(AUDIO_OUTPUT_FRAMES);
-        memset(m_input_rms_buf.get(), 0, m_input_rms_size * sizeof(float));
+        const auto headroom = 1.0 - ((2.0 * m_cutoff_high * (double)m_decimation) / (double)m_audio_info.samples_per_sec);
+        taps = std::max(taps, (size_t)std::ceil((5.5 * (double)m_decimation) / std::max(headroom, MIN_DECIMATION_HEADROOM)));
+    }
+    const auto cutoff = 0.5 / m_decimation;
+    m_decimator.resize(taps);
+    auto sum = 0.0;
+    for(size_t i = 0; i < taps; ++i)
+    {
+        const auto x = (double)i - ((taps - 1) / 2.0);
+        const auto sinc = (x == 0.0) ? 1.0 : std::sin(2 * std::numbers::pi * cutoff * x) / (2 * std::numbers::pi * cutoff * x);
+        const auto t = (2 * std::numbers::pi * i) / (taps - 1);
+        const auto w = 0.42 - (0.5 * std::cos(t)) + (0.08 * std::cos(2 * t));
+        m_decimator[i] = (float)(sinc * w);
+        sum += m_decimator[i];
     }
+    for(auto& tap : m_decimator)
+        tap = (float)(tap / sum);
+}
 
-    // calculate FFT size based on video FPS
-    obs_video_info vinfo = {};
-    if(obs_get_video_info(&vinfo))
-        m_fps = double(vinfo.fps_num) / double(vinfo.fps_den);
-    else
-        m_fps = 60.0;
-    if(m_auto_fft_size)
+void WAVSource::init_bin_window()
+{
+    // the other transforms window on their own, a flat window needs nothing
+    m_window_taps.clear();
+    if(!m_bin_window || m_sliding_dft || (m_decimation > 1) || (m_window_func == FFTWindow::NONE))
+        return;
+    const auto taps = window_taps();
+    if(taps.empty() || (taps.size() > MAX_WINDOW_TAPS))
     {
-        // align to 64-byte multiple so that N/2 is AVX aligned
-        m_fft_size = size_t(m_audio_info.samples_per_sec / m_fps) & -16;
-        if(m_fft_size < 128)
-            m_fft_size = 128;
+        LogInfo << "Window can't be applied to the bins, using the time domain";
+        return;
     }
+    m_window_taps.assign(taps.begin(), taps.end());
+}
 
-    // initialize buffers
-    auto spectrum_mode = !m_meter_mode && (m_display_mode != DisplayMode::WAVEFORM);
-    m_output_channels = ((m_capture_channels > 1) || m_stereo) ? 2u : 1u;
-    for(auto i = 0u; i < m_output_channels; ++i)
+// the window as a convolution of the bins the display reads, taps[j] weights both bins j away
+// bins below 0 and past nyquist are the conjugates of their mirror images, the spectrum of a real signal
+void WAVSource::window_bins(fftwf_complex *bins) const
+{
+    const auto half = (intmax_t)(m_fft_size / 2);
+    const auto radius = (intmax_t)m_window_taps.size() - 1;
+    const auto first = (intmax_t)m_first_bin;
+    const auto last = (intmax_t)m_last_bin;
+    const auto taps = m_window_taps.data();
+
+    // the pass overwrites the mirror images of the bins past nyquist before it reads them
+    float tail[MAX_WINDOW_TAPS][2];
+    for(intmax_t j = 0; j <= radius; ++j)
+    {
+        tail[j][0] = bins[half - j][0];
+        tail[j][1] = bins[half - j][1];
+    }
+    auto fetch = [&](intmax_t j, float *out) {
+        const auto src = (j < 0) ? bins[-j] : (j > half) ? tail[j - half] : bins[j];
+        const auto conj = (j < 0) || (j > half);
+        out[0] = src[0];
+        out[1] = conj ? -src[1] : src[1];
+    };
+
+    // sliding window of the unwindowed bins around k
+    float x[(2 * MAX_WINDOW_TAPS) - 1][2];
+    const auto width = (2 * radius) + 1;
+    for(intmax_t i = 0; i < width; ++i)
+        fetch(first - radius + i, x[i]);
+    for(auto k = first; k < last; ++k)
     {
-        auto count = spectrum_mode ? m_fft_size / 2 : m_fft_size;
-        m_decibels[i].reset(count);
-        if(spectrum_mode && (m_tsmoothing != TSmoothingMode::NONE))
+        auto re = taps[0] * x[radius][0];
+        auto im = taps[0] * x[radius][1];
+        for(intmax_t j = 1; j <= radius; ++j)
+        {
+            re += taps[j] * (x[radius - j][0] + x[radius + j][0]);
+            im += taps[j] * (x[radius - j][1] + x[radius + j][1]);
+        }
+        bins[k][0] = re;
+        bins[k][1] = im;
+        for(intmax_t i = 1; i < width; ++i)
         {
-            m_tsmooth_buf[i].reset(count);
-            std::fill(m_tsmooth_buf[i].get(), m_tsmooth_buf[i].get() + count, 0.0f);
+            x[i - 1][0] = x[i][0];
+            x[i - 1][1] = x[i][1];
         }
-        std::fill(m_decibels[i].get(), m_decibels[i].get() + count, m_meter_mode ? 0.0f : DB_MIN);
+        fetch(k + 1 + radius, x[width - 1]);
     }
-    if(spectrum_mode)
+}
+
+// the transform is linear, mid and side are half the sum and difference of the left and right bins
+// each channel still gets its own real transform, the pair is combined afterwards over the displayed bins only
+void WAVSource::mid_side_bins()
+{
+    const auto stride = direct_decimation() ? m_fft_size / m_decimation : m_fft_size; // same buffers as transform_output()
+    const auto out = direct_decimation() ? m_decimated_output.get() : m_fft_output.get();
+    const auto mid = &out[0];
+    const auto side = &out[stride];
+    for(auto k = m_first_bin; k < m_last_bin; ++k)
     {
-        m_fft_input.reset(m_fft_size);
-        m_fft_output.reset(m_fft_size);
-        m_fft_plan = fftwf_plan_dft_r2c_1d((int)m_fft_size, m_fft_input.get(), m_fft_output.get(), FFTW_ESTIMATE);
+        for(auto i = 0u; i < 2u; ++i)
+        {
+            const auto l = mid[k][i];
+            const auto r = side[k][i];
+            mid[k][i] = (l + r) * 0.5f;
+            side[k][i] = (l - r) * 0.5f;
+        }
     }
+}
 
-    // window function
-    if(m_window_func != FFTWindow::NONE)
+void WAVSource::decimated_transform(const bool *transform)
+{
+    // the decimated transform sees the whole window at a fraction of the rate, the same bin spacing as the full size FFT
+    // in multires mode the newest fraction of the window is also transformed at the full rate for the highs
+    if(!transform[0] && !transform[1])
+        return;
+    const auto n = m_fft_size / m_decimation;
+    const auto stride = m_multires ? n * 2 : n;
+    const auto taps = (intmax_t)m_decimator.size();
+    const auto delay = taps / 2;
+    const auto window = m_tables->decimated_window->coefficients.get();
+    for(auto channel = 0u; channel < m_fft_channels; ++channel)
     {
-        // precompute window coefficients
-        m_window_coefficients.reset(m_fft_size);
-        const auto N = m_fft_size - 1;
-        constexpr auto pi2 = 2 * pi;
-        constexpr auto pi4 = 4 * pi;
-        constexpr auto pi6 = 6 * pi;
-        switch(m_window_func)
+        if(!transform[channel])
+            continue;
+        const auto inbuf = &m_fft_input[channel * m_fft_size];
+        const auto low = &m_decimated_input[channel * stride];
+        for(size_t i = 0; i < n; ++i)
         {
-        case FFTWindow::HAMMING:
-            for(size_t i = 0; i < m_fft_size; ++i)
-                m_window_coefficients[i] = 0.53836f - (0.46164f * std::cos((pi2 * i) / N));
-            break;
-
-        case FFTWindow::BLACKMAN:
-            for(size_t i = 0; i < m_fft_size; ++i)
-                m_window_coefficients[i] = 0.42f - (0.5f * std::cos((pi2 * i) / N)) + (0.08f * std::cos((pi4 * i) / N));
-            break;
-
-        case FFTWindow::BLACKMAN_HARRIS:
-            for(size_t i = 0; i < m_fft_size; ++i)
-                m_window_coefficients[i] = 0.35875f - (0.48829f * std::cos((pi2 * i) / N)) + (0.14128f * std::cos((pi4 * i) / N)) - (0.01168f * std::cos((pi6 * i) / N));
-            break;
-
-        case FFTWindow::POWER_OF_SINE:
-            for(size_t i = 0; i < m_fft_size; ++i)
-                m_window_coefficients[i] = std::pow(std::sin((pi * i) / N), (float)m_sine_exponent);
-            break;
-
-        case FFTWindow::HANN:
-        default:
-            for(size_t i = 0; i < m_fft_size; ++i)
-                m_window_coefficients[i] = 0.5f * (1 - std::cos((pi2 * i) / N));
-            break;
+            // only the kept outputs are filtered, zero outside of the window since the taper hides the edges
+            const auto start = (intmax_t)(i * m_decimation) - delay;
+            const auto first = std::max(-start, (intmax_t)0);
+            const auto last = std::min(taps, (intmax_t)m_fft_size - start);
+            auto acc = 0.0f;
+            for(auto t = first; t < last; ++t)
+                acc += m_decimator[t] * inbuf[start + t];
+            low[i] = acc * window[i];
+        }
+        if(m_multires)
+        {
+            const auto high = low + n;
+            const auto recent = &inbuf[m_fft_size - n];
+            for(size_t i = 0; i < n; ++i)
+                high[i] = recent[i] * window[i];
         }
-
-        auto sum = 0.0f;
-        for(size_t i = 0; i < m_fft_size; ++i)
-            sum += m_window_coefficients[i];
-        m_window_sum = sum;
     }
-    else
-        m_window_sum = (float)m_fft_size;
 
-    m_last_silent = false;
-    m_show = obs_source_showing(m_source);
-    m_retries = 0;
-    m_next_retry = 0.0f;
+    m_fft.execute();
+    if(direct_decimation())
+        return;
 
-    recapture_audio();
-    m_capture_ts = os_gettime_ns();
-    if(!m_meter_mode)
+    // merge into the full size layout, scaled to match its window
+    // without the multires highs everything above the decimated nyquist is empty
+    const auto scale = m_tables->window_sum / m_tables->decimated_window->sum;
+    const auto bins = m_fft_size / 2;
+    const auto crossover = m_multires ? m_fft_size / (4 * m_decimation) : (n / 2) + 1;
+    for(auto channel = 0u; channel < m_fft_channels; ++channel)
     {
-        // fill input buffers with silent audio to avoid startup lag e.g. when changing settings
-        for(auto i = 0u; i < m_capture_channels; ++i)
-            circlebuf_push_back_zero(&m_capturebufs[i], m_fft_size * sizeof(float));
+        if(!transform[channel])
+            continue;
+        const auto out = &m_fft_output[channel * m_fft_size];
+        const auto low = &m_decimated_output[channel * stride];
+        for(size_t k = 0; k < crossover; ++k)
+        {
+            out[k][0] = low[k][0] * scale;
+            out[k][1] = low[k][1] * scale;
+        }
+        if(m_multires)
+        {
+            const auto high = low + n;
+            for(auto k = crossover; k <= bins; ++k)
+            {
+                const auto src = high[k / m_decimation];
+                out[k][0] = src[0] * scale;
+                out[k][1] = src[1] * scale;
+            }
+        }
+        else
+            memset(&out[crossover], 0, (bins + 1 - crossover) * sizeof(fftwf_complex));
     }
+}
 
-    // precomupte interpolated indices
-    if((m_display_mode == DisplayMode::CURVE) || (m_display_mode == DisplayMode::WAVEFORM))
+void WAVSource::init_active_bins()
+{
+    // bins read in place from the decimated transform end at its nyquist
+    const auto bins = (direct_decimation() ? m_fft_size / m_decimation : m_fft_size) / 2;
+    m_first_bin = 0;
+    m_last_bin = bins;
+    if(m_meter_mode || time_domain() || m_interp->indices.empty())
+        return;
+
+    // the interpolated display points plus the interpolation kernel's reach
+    // the bar filter works on display points, not bins, so it doesn't widen the range
+    if(!m_interp->filterbank.empty())
     {
-        init_interp(m_width);
-        for(auto& i : m_interp_bufs)
-            i.resize(m_width);
+        m_first_bin = m_interp->filterbank.first_bin & ~(size_t)7;
+        m_last_bin = std::min((m_interp->filterbank.last_bin + 7) & ~(size_t)7, bins);
+        return;
     }
-    else if(m_meter_mode)
+    const auto [lo, hi] = std::minmax_element(m_interp->indices.begin(), m_interp->indices.end());
+    const auto radius = (m_interp_mode != InterpMode::POINT) ? (intmax_t)m_interp->kernel.radius : 0;
+    const auto first = std::max((intmax_t)std::floor(*lo) - radius - 1, (intmax_t)0);
+    const auto last = std::min((intmax_t)std::ceil(*hi) + radius + 2, (intmax_t)bins);
+    constexpr size_t align = 8; // one AVX vector
+    m_first_bin = (size_t)first & ~(align - 1);
+    m_last_bin = std::min(((size_t)last + align - 1) & ~(align - 1), bins);
+}
+
+void WAVSource::init_pruning()
+{
+    m_goertzel.clear();
+    const auto bars = (m_display_mode == DisplayMode::BAR) || (m_display_mode == DisplayMode::STEPPED_BAR);
+    if(m_meter_mode || !bars || m_sliding_dft || (m_decimation > 1) || (m_iir_fraction > 0) || m_view || !m_window_taps.empty())
+        return; // a window on the bins reads the neighbours of every bin
+
+    // mark every bin the bar renderer reads, including the interpolation kernel's reach
+    const auto bins = m_fft_size / 2;
+    std::vector<bool> used(bins + 1, false);
+    if((m_interp_mode == InterpMode::POINT) || !m_interp->filterbank.empty())
     {
-        // channel meter rendering through the bar renderer
-        // emulate 1-2 bar spectrum graph
-        m_interp_indices.clear();
-        for(auto& i : m_interp_bufs)
-            i.clear();
-        m_interp_bufs[0].resize(m_capture_channels);
-        m_num_bars = m_capture_channels;
+        for(size_t i = 0; i < m_interp->band_widths.size(); ++i)
+            for(auto j = 0; j < m_interp->band_widths[i]; ++j)
+                used[std::min((size_t)m_interp->indices[i] + j, bins)] = true;
     }
     else
     {
-        const auto bar_stride = m_bar_width + m_bar_gap;
-        m_num_bars = (int)(m_width / bar_stride);
-        if(((int)m_width - (m_num_bars * bar_stride)) >= m_bar_width)
-            ++m_num_bars;
-        init_interp(m_num_bars + 1); // make extra band for last bar
-        for(auto& i : m_interp_bufs)
-            i.resize(m_num_bars);
+        const auto radius = (intmax_t)m_interp->kernel.radius;
+        for(auto x : m_interp->indices)
+            for(auto j = (intmax_t)x - radius; j <= (intmax_t)x + radius; ++j)
+                used[(size_t)std::clamp(j, (intmax_t)0, (intmax_t)bins)] = true;
     }
 
-    // filter
-    if(m_filter_mode == FilterMode::GAUSS)
-        m_kernel = make_gauss_kernel(m_filter_radius);
+    std::vector<uint32_t> needed;
+    for(size_t i = 0; i <= bins; ++i)
+        if(used[i])
+            needed.push_back((uint32_t)i);
 
-    // slope
-    if(m_slope > 0.0f)
-    {
-        const auto num_mods = m_fft_size / 2;
-        const auto maxmod = (float)(num_mods - 1);
-        m_slope_modifiers.reset(num_mods);
-        for(size_t i = 0; i < num_mods; ++i)
-            m_slope_modifiers[i] = std::log10(log_interp(10.0f, 10000.0f, ((float)i * m_slope) / maxmod));
-    }
+    // a goertzel filter is about one multiply-add per sample, the FFT about log2(n) per bin
+    // stay conservative, the FFT vectorizes much better
+    if(needed.size() <= (2 * (size_t)std::bit_width(m_fft_size)))
+        m_goertzel.init(m_fft_size, needed);
+}
 
-    // rounded caps
-    m_cap_verts.clear();
-    if(m_rounded_caps)
-    {
-        // caps are full circles to avoid distortion issues in radial mode
-        m_cap_radius = (float)m_bar_width / 2.0f;
-        m_cap_tris = std::max((int)((2 * pi * m_cap_radius) / 3.0f), 4);
-        if(m_cap_tris & 1) // force even number of triangles
-            m_cap_tris += 1;
-        auto angle = (2 * pi) / (float)m_cap_tris;
-        auto verts = m_cap_tris + 1;
-        m_cap_verts.resize(verts);
-        for(auto j = 0; j < verts; ++j)
-        {
-            auto a = j * angle;
-            vec3_set(&m_cap_verts[j], m_cap_radius * std::cos(a), m_cap_radius * std::sin(a), 0.0f);
-        }
-    }
+size_t WAVSource::buffer_bytes() const
+{
+    const auto bytes = [](const auto& buf) -> size_t { return buf.size() * sizeof(buf[0]); };
+    auto total = m_gpu_bytes;
+    for(auto i = 0; i < 2; ++i)
+        total += bytes(m_decibels[i]) + bytes(m_tsmooth_buf[i]) + bytes(m_peak_db[i]) + bytes(m_peak_timer[i]) + bytes(m_display_history[i]) + bytes(m_peak_bars[i]);
+    for(const auto& buf : m_waveform_display)
+        total += bytes(buf);
+    for(const auto& buf : m_interp_bufs)
+        total += bytes(buf);
+    for(auto i = 0u; i < m_frames.size(); ++i)
+        total += bytes(m_frames[i].values[0]) + bytes(m_frames[i].values[1]) + bytes(m_frames[i].samples[0]) + bytes(m_frames[i].samples[1]);
+    for(const auto& buf : m_waveform_raw)
+        total += bytes(buf);
+    total += bytes(m_fft_input) + bytes(m_fft_output) + bytes(m_decimated_input) + bytes(m_decimated_output);
+    total += bytes(m_input_rms_buf) + bytes(m_waveform_buf) + bytes(m_meter_window) + bytes(m_meter_peaks);
+    total += bytes(m_iir_input) + m_iir.bytes();
+    total += bytes(m_kernel.weights) + m_interp->bytes(); // shared with every source of the same layout
+    return total;
+}
 
-    // stepped bars
-    if((m_display_mode == DisplayMode::STEPPED_BAR) || (m_display_mode == DisplayMode::STEPPED_METER))
-        init_steps();
+void WAVSource::request_tables()
+{
+    AnalysisParams params;
+    params.fft_size = m_fft_size;
+    params.decimation = m_decimation;
+    params.direct_decimation = direct_decimation();
+    params.window_func = (int)m_window_func;
+    params.sine_exponent = (m_window_func == FFTWindow::POWER_OF_SINE) ? m_sine_exponent : 0;
+    params.bin_window_gain = m_window_taps.empty() ? 0.0f : m_window_taps[0];
+    params.sample_rate = m_audio_info.samples_per_sec;
+    params.slope = m_slope;
+    params.cutoff_low = m_cutoff_low;
+    params.cutoff_high = m_cutoff_high;
+    params.rolloff_q = m_rolloff_q;
+    params.rolloff_rate = m_rolloff_rate;
+
+    // tick swaps them in once the worker is done
+    m_analysis = AnalysisBuilder::request(params);
+    m_tables = nullptr;
+}
 
-    // roll-off
-    if((m_rolloff_q > 0.0f) && (m_rolloff_rate > 0.0f))
-        init_rolloff();
+void WAVSource::init_steps()
+{
+    const auto x1 = 0.0f;
+    const auto x2 = (float)m_bar_width;
+    const auto y1 = 0.0f;
+    const auto y2 = (float)m_step_width;
 
-    // vertex buffer must be rebuilt if the settings have changed
-    // this must be done after m_num_bars has been initialized
-    create_vbuf();
+    vec3_set(&m_step_verts[0], x1, y1, 0);
+    vec3_set(&m_step_verts[1], x2, y1, 0);
+    vec3_set(&m_step_verts[2], x1, y2, 0);
+    vec3_set(&m_step_verts[3], x2, y1, 0);
+    vec3_set(&m_step_verts[4], x1, y2, 0);
+    vec3_set(&m_step_verts[5], x2, y2, 0);
 }
 
-void WAVSource::tick(float seconds)
+void ShaderParams::load(gs_effect_t *effect)
 {
-    std::lock_guard lock(m_mtx);
+    *this = {};
+    if(effect == nullptr)
+        return;
 
-    m_tick_ts = os_gettime_ns();
+    color_base = gs_effect_get_param_by_name(effect, "color_base");
+    color_lut = gs_effect_get_param_by_name(effect, "color_lut");
+    grad_center = gs_effect_get_param_by_name(effect, "grad_center");
+    grad_height = gs_effect_get_param_by_name(effect, "grad_height");
+    grad_offset = gs_effect_get_param_by_name(effect, "grad_offset");
+
+    graph_width = gs_effect_get_param_by_name(effect, "graph_width");
+    graph_height = gs_effect_get_param_by_name(effect, "graph_height");
+    graph_deadzone = gs_effect_get_param_by_name(effect, "graph_deadzone");
+    graph_invert = gs_effect_get_param_by_name(effect, "graph_invert");
+    radial_center = gs_effect_get_param_by_name(effect, "radial_center");
+    radial_arc = gs_effect_get_param_by_name(effect, "radial_arc");
+    radial_rotation = gs_effect_get_param_by_name(effect, "radial_rotation");
+
+    graph_values = gs_effect_get_param_by_name(effect, "graph_values");
+    graph_base = gs_effect_get_param_by_name(effect, "graph_base");
+    graph_points = gs_effect_get_param_by_name(effect, "graph_points");
+    graph_center = gs_effect_get_param_by_name(effect, "graph_center");
+    graph_bottom = gs_effect_get_param_by_name(effect, "graph_bottom");
+    graph_step_limit = gs_effect_get_param_by_name(effect, "graph_step_limit");
+    step_width = gs_effect_get_param_by_name(effect, "step_width");
+    step_stride = gs_effect_get_param_by_name(effect, "step_stride");
+    step_count = gs_effect_get_param_by_name(effect, "step_count");
+    cap_radius = gs_effect_get_param_by_name(effect, "cap_radius");
+
+    spectrogram_rows = gs_effect_get_param_by_name(effect, "spectrogram_rows");
+    spectrogram_size = gs_effect_get_param_by_name(effect, "spectrogram_size");
+    spectrogram_offset = gs_effect_get_param_by_name(effect, "spectrogram_offset");
+    spectrogram = gs_effect_get_technique(effect, "Spectrogram");
+
+    scope_center = gs_effect_get_param_by_name(effect, "scope_center");
+    scope_scale = gs_effect_get_param_by_name(effect, "scope_scale");
+    scope_intensity = gs_effect_get_param_by_name(effect, "scope_intensity");
+    vectorscope = gs_effect_get_technique(effect, "Vectorscope");
+
+    const char *prefixes[] = { "", "Geom", "GeomSteps", "GeomCaps" };
+    const char *names[] = { "Solid", "Gradient", "Range", "Radial", "RadialGradient", "RadialRange" };
+    for(auto i = 0u; i < std::size(prefixes); ++i)
+        for(auto j = 0u; j < std::size(names); ++j)
+            techs[i][j] = gs_effect_get_technique(effect, (std::string(prefixes[i]) + names[j]).c_str());
+}
 
-    if(m_normalize_volume)
-        update_input_rms();
+WAVSource::WAVSource(obs_source_t *source)
+{
+    m_source = source;
 
-    if(!check_audio_capture(seconds))
-        return;
-    if(m_capture_channels == 0)
-        return;
+    const auto name = obs_source_get_name(source);
+    m_plots.tick = profile_plot_name(name, "tick ms");
+    m_plots.render = profile_plot_name(name, "render ms");
+    m_plots.analysis = profile_plot_name(name, "analysis ms");
+    m_plots.lock_wait = profile_plot_name(name, "lock wait ms");
+    m_plots.analysis_wait = profile_plot_name(name, "analysis wait ms");
+    m_plots.capture_fill = profile_plot_name(name, "capture samples");
+    m_plots.silent = profile_plot_name(name, "silent");
 
-    if(m_meter_mode)
-        tick_meter(seconds);
-    else if(m_display_mode == DisplayMode::WAVEFORM)
-        tick_waveform(seconds);
-    else
-        tick_spectrum(seconds);
+    obs_enter_graphics();
+
+    // create shader
+    auto filename = obs_module_file("gradient.effect");
+    m_shader = gs_effect_create_from_file(filename, nullptr);
+    bfree(filename);
+    m_params.load(m_shader);
+
+    m_cache = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+
+    obs_leave_graphics();
 }
 
-void WAVSource::render([[maybe_unused]] gs_effect_t *effect)
+WAVSource::~WAVSource()
 {
+    AnalysisWorker::cancel(this);
+    // the preview phase is registered under its own owner, cancel only gives up this one's
+    AnalysisWorker::assign_phase(&m_preview_phase, 0);
     std::lock_guard lock(m_mtx);
-    if(m_last_silent && m_hide_on_silent)
-        return;
+    std::lock_guard analysis_lock(m_analysis_mtx);
+    obs_enter_graphics();
 
-    if((m_display_mode == DisplayMode::CURVE) || (m_display_mode == DisplayMode::WAVEFORM))
-        render_curve(effect);
-    else
-        render_bars(effect);
+    for(auto vbuf : m_vbuf)
+        gs_vertexbuffer_destroy(vbuf);
+    for(auto tex : m_value_tex)
+        gs_texture_destroy(tex);
+    m_gpu_analysis.destroy();
+    m_gpu_envelope.destroy();
+    gs_texture_destroy(m_spectrogram_row);
+    gs_texrender_destroy(m_spectrogram_rows);
+    gs_texrender_destroy(m_scope_target);
+    gs_texrender_destroy(m_glow_target);
+    gs_texrender_destroy(m_cache);
+    gs_texture_destroy(m_color_lut_tex);
+    gs_effect_destroy(m_shader);
+
+    obs_leave_graphics();
+
+    release_audio_capture();
+    close_capture_log();
+    free_bufs();
 }
 
-void WAVSource::render_curve([[maybe_unused]] gs_effect_t *effect)
+unsigned int WAVSource::graph_width() const
 {
-    //std::lock_guard lock(m_mtx); // now locked in render()
-    //if(m_last_silent)
-    //    return;
-
-    auto tech = get_shader_tech();
-    
-    const auto center = (float)m_height / 2;
-    //const auto right = (float)m_width;
-    const auto bottom = (float)m_height;
-    const auto dbrange = m_ceiling - m_floor;
-    const auto cpos = m_stereo ? center : bottom;
-    const auto channel_offset = m_channel_spacing * 0.5f;
+    if(m_meter_mode)
+        return (m_bar_width * m_capture_channels) + ((m_capture_channels > 1) ? m_bar_gap * (m_capture_channels - 1) : 0);
+    if(m_radial)
+        return (unsigned int)((m_height + m_deadzone) * 2);
+    return m_width;
+}
 
-    // interpolation
-    auto miny = cpos;
+unsigned int WAVSource::graph_height() const
+{
+    if(m_radial)
+        return (unsigned int)((m_height + m_deadzone) * 2);
+    return m_height;
+}
+
+void WAVSource::create_vbuf() {
+    size_t num_verts = 0;
+    bool curve = curve_display();
+
+    obs_enter_graphics();
+
+    // peak markers vary in vertex count per bar, those stay on the CPU
+    m_gpu_geometry = (curve || !m_peak_hold) && (m_interp_size > 0) && (m_params.techs[1][0] != nullptr);
+    m_gpu_fft = m_gpu_fft && m_gpu_geometry && (m_interp != nullptr) && (m_interp->indices.size() >= m_interp_size);
+    m_gpu_waveform = m_gpu_waveform && m_gpu_geometry && (m_interp_size == m_fft_size);
+
+    if(curve)
+        num_verts = (size_t)((m_render_mode == RenderMode::LINE) ? curve_columns() : (curve_columns() * 2));
+    else
+    {
+        const auto step_stride = m_step_width + m_step_gap;
+        const auto center = (float)m_height / 2;
+        const auto bottom = (float)m_height;
+        const auto cpos = m_stereo ? center : bottom;
+        const auto channel_offset = m_channel_spacing * 0.5f;
+
+        auto max_steps = (size_t)((cpos - channel_offset) / step_stride);
+        if(((int)cpos - (int)(max_steps * step_stride) - (int)channel_offset) > m_step_width)
+            ++max_steps;
+
+        num_verts = (size_t)(m_num_bars * 6);
+        if(((m_display_mode == DisplayMode::STEPPED_BAR) || (m_display_mode == DisplayMode::STEPPED_METER)) && !m_gpu_geometry)
+            num_verts *= max_steps; // the texture driven path cuts steps out of one quad per bar
+        else if(m_rounded_caps && !m_gpu_geometry)
+            num_verts += m_cap_tris * ((m_channel_spacing > 0) ? 12 : 6) * m_num_bars; // 2 caps per bar (middle omitted when 0 spacing)
+        if(m_peak_hold)
+            num_verts += (size_t)(m_num_bars * 6);
+    }
+
+    // rebuilds that leave the layout alone (FFT size, window, smoothing...) keep the mesh and value textures
+    // the GPU transform is made from the interpolation indices, a build with it or the GPU envelope always starts over
+    const auto layout = mesh_layout(num_verts);
+    const auto keep = (layout.num_verts > 0) && (layout == m_mesh_layout) && !m_gpu_fft && !m_gpu_waveform;
+
+    // one buffer for both channels, channel 1 starts at m_vbuf_stride
+    // data written per frame goes to a ring so the CPU never rewrites a buffer a draw may still be reading
+    if(!keep)
+    {
+        for(auto i = 0u; i < RENDER_RING; ++i)
+        {
+            gs_vertexbuffer_destroy(m_vbuf[i]);
+            gs_texture_destroy(m_value_tex[i]);
+            m_vbuf[i] = nullptr;
+            m_value_tex[i] = nullptr;
+        }
+        m_gpu_analysis.destroy();
+        m_gpu_envelope.destroy();
+        m_mesh_layout = {};
+        m_ring_pos = 0;
+        m_gpu_bytes = 0;
+    }
+    m_vbuf_gen = 0; // kept buffers still get the new values written
+    if(m_headless)
+    {
+        m_gpu_geometry = false;
+        obs_leave_graphics();
+        return;
+    }
+
+    // the trail starts over with the new layout
+    gs_texrender_destroy(m_glow_target);
+    m_glow_target = (m_afterglow > 0.0f) ? gs_texrender_create(GS_RGBA, GS_ZS_NONE) : nullptr;
+    m_glow_fade = 1.0f;
+    m_glow_gen = 0;
+    m_glow_clear = true;
+
+    gs_texture_destroy(m_spectrogram_row);
+    gs_texrender_destroy(m_spectrogram_rows);
+    m_spectrogram_row = nullptr;
+    m_spectrogram_rows = nullptr;
+    if(m_display_mode == DisplayMode::SPECTROGRAM)
+    {
+        // no mesh, the history texture is drawn as one quad
+        m_gpu_geometry = false;
+        if((m_interp_size > 0) && (m_height > 0) && (m_params.spectrogram != nullptr))
+        {
+            m_spectrogram_row = gs_texture_create((uint32_t)m_interp_size, 1, GS_R32F, 1, nullptr, GS_DYNAMIC);
+            m_spectrogram_rows = gs_texrender_create(GS_R32F, GS_ZS_NONE);
+            m_gpu_bytes = (size_t)m_interp_size * (m_height + 1) * sizeof(float);
+        }
+        m_spectrogram_pos = 0;
+        m_spectrogram_gen = 0;
+        m_spectrogram_clear = true;
+        obs_leave_graphics();
+        return;
+    }
+
+    gs_texrender_destroy(m_scope_target);
+    m_scope_target = nullptr;
+    if(m_display_mode == DisplayMode::VECTORSCOPE)
+    {
+        // one point per sample pair, faded and accumulated in a render target that keeps its contents
+        m_gpu_geometry = false;
+        if((m_fft_size > 0) && (m_params.vectorscope != nullptr))
+        {
+            for(auto& vbuf : m_vbuf)
+            {
+                auto vbdata = gs_vbdata_create();
+                vbdata->num = m_fft_size;
+                vbdata->points = (vec3*)bzalloc(m_fft_size * sizeof(vec3));
+                vbuf = gs_vertexbuffer_create(vbdata, GS_DYNAMIC);
+            }
+            m_scope_target = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+            m_gpu_bytes = (RENDER_RING * 2 * m_fft_size * sizeof(vec3)) + ((size_t)m_width * m_height * 4);
+        }
+        m_scope_fade = 1.0f;
+        m_scope_gen = 0;
+        m_scope_clear = true;
+        obs_leave_graphics();
+        return;
+    }
+
+    if(keep)
+    {
+        obs_leave_graphics();
+        return;
+    }
+
+    m_vbuf_stride = (uint32_t)num_verts;
+    m_vbuf_verts[0] = m_vbuf_verts[1] = 0;
+    const auto channels = m_stereo ? 2u : 1u;
+    const auto total_verts = num_verts * channels;
+    const auto tex_width = m_gpu_geometry ? 4u : 0u; // the CPU path shaders only read the position
+
+    auto create_vbdata = [&]() {
+        auto vbdata = gs_vbdata_create();
+        vbdata->num = total_verts;
+        vbdata->points = (vec3*)bmalloc(total_verts * sizeof(vec3));
+        if(tex_width > 0)
+        {
+            vbdata->num_tex = 1;
+            vbdata->tvarray = (gs_tvertarray*)bzalloc(sizeof(gs_tvertarray));
+            vbdata->tvarray->width = tex_width;
+            vbdata->tvarray->array = bmalloc(tex_width * total_verts * sizeof(float));
+        }
+        return vbdata;
+    };
+
+    if(m_gpu_geometry)
+    {
+        // written once, only the value texture changes per frame
+        auto vbdata = create_vbdata();
+        size_t vertpos = 0;
+        for(auto channel = 0u; channel < channels; ++channel)
+        {
+            const auto end = fill_geometry(vbdata, channel, curve, vertpos);
+            m_vbuf_verts[channel] = (uint32_t)(end - vertpos);
+            vertpos = end;
+        }
+        m_vbuf_stride = m_vbuf_verts[0];
+        vbdata->num = vertpos;
+        m_vbuf[0] = gs_vertexbuffer_create(vbdata, 0);
+        for(auto& tex : m_value_tex)
+            tex = gs_texture_create((uint32_t)m_interp_size, channels, GS_R32F, 1, nullptr, GS_DYNAMIC);
+        m_gpu_bytes = (vertpos * (sizeof(vec3) + (tex_width * sizeof(float)))) + (RENDER_RING * m_interp_size * channels * sizeof(float));
+        if(m_gpu_fft)
+        {
+            m_gpu_fft = m_gpu_analysis.create((uint32_t)m_fft_size, m_fft_channels, channels, (uint32_t)m_interp_size, m_interp->indices.data());
+            m_gpu_bytes += m_gpu_analysis.gpu_bytes();
+        }
+        if(m_gpu_waveform)
+        {
+            m_gpu_waveform = m_gpu_envelope.create((uint32_t)(m_waveform_samples + WAVEFORM_RAW_MARGIN), std::max(m_capture_channels, 1u), channels, (uint32_t)m_interp_size);
+            m_gpu_bytes += m_gpu_envelope.gpu_bytes();
+        }
+    }
+    else
+    {
+        // dynamic buffers also keep their vbdata on the CPU
+        m_gpu_bytes = RENDER_RING * 2 * total_verts * (sizeof(vec3) + (tex_width * sizeof(float)));
+        for(auto& vbuf : m_vbuf)
+        {
+            auto vbdata = create_vbdata();
+            vbuf = gs_vertexbuffer_create(vbdata, GS_DYNAMIC);
+
+            // x and the base of a fill never change, render_curve only writes the value vertices
+            if(curve) {
+                if(m_render_mode == RenderMode::LINE)
+                {
+                    for(auto i = 0u; i < total_verts; ++i)
+                        vec3_set(&vbdata->points[i], (float)(i % m_width), 0, 0);
+                }
+                else
+                {
+                    const auto cpos = m_stereo ? (float)m_height / 2 : (float)m_height;
+                    const auto channel_offset = m_channel_spacing * 0.5f;
+                    for(auto i = 0u; i < total_verts / 2; ++i)
+                    {
+                        const auto bot = (i < m_width) ? (cpos - channel_offset) : (cpos + channel_offset);
+                        vec3_set(&vbdata->points[i * 2], (float)(i % m_width), 0, 0);
+                        vec3_set(&vbdata->points[(i * 2) + 1], (float)(i % m_width), bot, 0);
+                    }
+                }
+            }
+        }
+    }
+    if(!m_gpu_fft && !m_gpu_waveform)
+        m_mesh_layout = layout;
+
+    obs_leave_graphics();
+}
+
+// inputs of the mesh create_vbuf() builds, no mesh without vertices
+WAVSource::MeshLayout WAVSource::mesh_layout(size_t num_verts) const
+{
+    if(m_headless || (m_display_mode == DisplayMode::SPECTROGRAM) || (m_display_mode == DisplayMode::VECTORSCOPE))
+        return {};
+    MeshLayout layout;
+    layout.num_verts = num_verts;
+    layout.display_mode = m_display_mode;
+    layout.render_mode = m_render_mode;
+    layout.gpu_geometry = m_gpu_geometry;
+    layout.stereo = m_stereo;
+    layout.radial = m_radial;
+    layout.caps = m_rounded_caps;
+    layout.peak_hold = m_peak_hold;
+    layout.width = m_width;
+    layout.height = m_height;
+    layout.interp_size = m_interp_size;
+    layout.num_bars = m_num_bars;
+    layout.bar_width = m_bar_width;
+    layout.bar_gap = m_bar_gap;
+    layout.channel_spacing = m_channel_spacing;
+    layout.columns = curve_display() ? curve_columns() : 0u;
+    layout.cap_radius = m_cap_radius;
+    return layout;
+}
+
+// control points per pixel of a spline curve, 1 when every column has its own display point
+float WAVSource::spline_scale() const
+{
+    if(!m_spline || (m_width < 2) || (m_interp_size < 2))
+        return 1.0f;
+    return (float)(m_interp_size - 1) / (float)(m_width - 1);
+}
+
+// curve mesh columns, one per display point except for radial curves on the texture driven path
+// those follow the arc length of the outer edge so segments stay the same length on screen
+unsigned int WAVSource::curve_columns() const
+{
+    if(!m_radial || !m_gpu_geometry || (m_width < 2))
+        return m_width;
+    constexpr auto pi = std::numbers::pi_v<float>;
+    const auto arc = 2.0f * pi * ((float)m_height + m_deadzone) * m_radial_arc;
+    return (unsigned int)std::clamp(std::ceil(arc / RADIAL_SEGMENT) + 1.0f, 2.0f, (float)MAX_RADIAL_COLUMNS);
+}
+
+// static mesh of one channel for the texture driven path, written from vertex start, returns the end
+// texcoord is the texel of the column or bar, 1 for vertices that stay at the base, the channel
+// and the cap center x
+// y positions are offsets from the value or base, so one quad serves every bar height
+// stepped bars use the same quad, the pixel shader cuts out the gaps
+size_t WAVSource::fill_geometry(gs_vb_data *vbdata, unsigned int channel, bool curve, size_t start)
+{
+    auto points = vbdata->points;
+    auto uv = (float*)vbdata->tvarray->array;
+    auto vertpos = start;
+    auto add_vert = [&](float x, float y, float u, float v, float cx = 0.0f) {
+        vec3_set(&points[vertpos], x, y, 0.0f);
+        uv[vertpos * 4] = u;
+        uv[(vertpos * 4) + 1] = v;
+        uv[(vertpos * 4) + 2] = (float)channel;
+        uv[(vertpos * 4) + 3] = cx;
+        ++vertpos;
+    };
+
+    if(curve)
+    {
+        // columns off the display points sample between them, the vertex shader interpolates
+        const auto columns = curve_columns();
+        const auto scale = (columns > 1) ? (float)(m_width - 1) / (float)(columns - 1) : 0.0f;
+        const auto texels = spline_scale();
+        for(auto i = 0u; i < columns; ++i)
+        {
+            const auto x = std::min((float)i * scale, (float)(m_width - 1));
+            const auto u = std::min(x * texels, (float)(m_interp_size - 1));
+            add_vert(x, 0.0f, u, 0.0f);
+            if(m_render_mode != RenderMode::LINE)
+                add_vert(x, 0.0f, u, 1.0f);
+        }
+        return vertpos;
+    }
+
+    // rounded caps stretch the quad by the cap radius past the value and the base
+    // the pixel shader rounds it off from the cap center
+    const auto bar_stride = m_bar_width + m_bar_gap;
+    const auto stepped = (m_display_mode == DisplayMode::STEPPED_BAR) || (m_display_mode == DisplayMode::STEPPED_METER);
+    const auto caps = m_rounded_caps && !stepped;
+    const auto dir = channel ? 1.0f : -1.0f; // toward the value
+    const auto top = caps ? dir * m_cap_radius : 0.0f;
+    const auto base = (caps && (!m_stereo || (m_channel_spacing > 0))) ? -dir * m_cap_radius : 0.0f;
+    for(auto i = 0; i < m_num_bars; ++i)
+    {
+        const auto x1 = (float)(i * bar_stride);
+        const auto x2 = x1 + m_bar_width;
+        const auto ccx = caps ? x1 + m_cap_radius : 0.0f;
+        add_vert(x1, top, (float)i, 0.0f, ccx);
+        add_vert(x2, top, (float)i, 0.0f, ccx);
+        add_vert(x1, base, (float)i, 1.0f, ccx);
+        add_vert(x2, top, (float)i, 0.0f, ccx);
+        add_vert(x1, base, (float)i, 1.0f, ccx);
+        add_vert(x2, base, (float)i, 1.0f, ccx);
+    }
+    return vertpos;
+}
+
+void WAVSource::update_audio_rate()
+{
+    constexpr uint64_t NS = 1000000000u;
+    const auto rate = (uint64_t)std::max(m_audio_info.samples_per_sec, 1u);
+    m_frames_per_ns = ((rate << FRAMES_PER_NS_BITS) + NS - 1) / NS;
+    m_ns_per_frame = (NS << NS_PER_FRAME_BITS) / rate;
+}
+
+void WAVSource::update(obs_data_t *settings)
+{
+    std::lock_guard lock(m_mtx);
+    std::lock_guard analysis_lock(m_analysis_mtx);
+    constexpr auto pi = std::numbers::pi_v<float>;
+
+    // only live settings changed, keep the capture, buffers and meshes
+    update_audio_info(&m_audio_info);
+    update_audio_rate();
+    m_fps = get_video_fps();
+    m_format_timer = 0.0f;
+    auto structure = get_structure_key(settings);
+    if(structure == m_structure_key)
+    {
+        get_live_settings(settings);
+        m_shader_dirty = true;
+        m_last_silent = false; // floor and ceiling decide what counts as silent
+        m_display_silent = false;
+        m_idle = false;
+        prepare_display(0.0f);
+        return;
+    }
+    m_structure_key = std::move(structure);
+    m_built.store(true, std::memory_order_release); // under m_mtx, render() sees the whole build
+    m_tick_cost.max_ns = 0;
+    m_render_cost.max_ns = 0;
+    m_analysis_cost.max_ns = 0;
+    m_kernel_cost = {}; // sizes and modes are compared by their own averages
+    m_spectrum_export.clear(); // consumers keep what they hold, new requests wait for the new structure
+    m_bands_export.clear();
+    m_lock_wait.max_ns = 0;
+    m_analysis_wait.max_ns = 0;
+
+    // hold on to the stream while we're detached so it stays subscribed to OBS and keeps its history,
+    // reattaching then primes the new window (whatever its size) with the audio that was already captured
+    auto held_stream = m_capture.stream();
+    release_audio_capture();
+    free_bufs();
+    get_settings(settings);
+
+    // get current audio settings
+    const auto max_channels = get_audio_channels(m_audio_info.speakers);
+    m_capture_channels = std::min(max_channels, 2u);
+    if(m_meter_mode && m_meter_all_channels)
+        m_capture_channels = std::min(max_channels, (m_loudness_mode != LoudnessMode::NONE) ? LoudnessMeter::MAX_CHANNELS : (uint32_t)MAX_AUDIO_CHANNELS); // loudness is measured on the front pair
+    if(m_capture_channels == 0)
+        LogWarn << "Unknown channel config: " << (unsigned int)m_audio_info.speakers;
+    if(m_channel_mode == ChannelMode::SINGLE)
+    {
+        if((m_channel_base < 0) || (m_channel_base >= (int)max_channels) || (m_channel_base >= MAX_AUDIO_CHANNELS))
+        {
+            m_capture_channels = 0;
+            m_channel_base = 0;
+        }
+        else
+            m_capture_channels = std::min(m_capture_channels, 1u);
+    }
+    else
+        m_channel_base = 0;
+    if((m_channel_mode == ChannelMode::MID_SIDE) && (m_capture_channels < 2))
+        m_channel_mode = ChannelMode::STEREO; // nothing to take the side from
+
+    // time domain downmix only makes sense for a mono spectrum of more than one channel
+    m_downmix = m_downmix && (m_channel_mode == ChannelMode::MONO) && (m_capture_channels > 1) && !m_meter_mode && !time_domain();
+    m_mix_channels = m_capture_channels;
+    std::fill(std::begin(m_mix_weights), std::end(m_mix_weights), 0.0f);
+    if((m_channel_mode == ChannelMode::SURROUND) && (max_channels > 0))
+    {
+        // subscribe to every channel and mix them into a single spectrum
+        m_mix_channels = std::min(max_channels, (uint32_t)MAX_AUDIO_CHANNELS);
+        m_capture_channels = 1;
+        m_downmix = true;
+        get_surround_weights(m_audio_info.speakers, m_center_weight, m_lfe_weight, m_surround_weight, m_mix_weights);
+    }
+    else if(m_downmix)
+        m_mix_weights[0] = m_mix_weights[1] = 0.5f;
+
+    // meter mode
+    if(m_meter_mode)
+    {
+        // turn off stuff we don't need in this mode
+        m_window_func = FFTWindow::NONE;
+        m_interp_mode = InterpMode::POINT;
+        m_filter_mode = FilterMode::NONE;
+        m_auto_fft_size = false;
+        m_slope = 0.0f;
+        m_stereo = false;
+        m_radial = false;
+        m_normalize_volume = false;
+        m_mirror_freq_axis = false;
+
+        // repurpose m_fft_size for meter buffer size
+        m_fft_size = ((size_t)m_audio_info.samples_per_sec * (size_t)m_meter_ms / 1000u) & -16;
+
+        m_meter_pos = 0;
+        m_meter_lanes = std::bit_ceil(std::max(m_capture_channels, 1u));
+        m_meter_leaves = (m_meter_rms || (m_loudness_mode != LoudnessMode::NONE)) ? 0 : std::bit_ceil(std::max((m_fft_size + METER_BLOCK - 1) / METER_BLOCK, (size_t)1));
+        if(m_loudness_mode != LoudnessMode::NONE)
+            m_loudness.init(m_audio_info.samples_per_sec, (size_t)std::max((m_meter_ms + 99) / 100, 1));
+        m_meter_peaks.assign(m_meter_leaves * 2 * m_meter_lanes, 0.0f);
+        reset_meter_window();
+        for(auto& i : m_meter_buf)
+            i = DB_MIN;
+        for(auto& i : m_meter_val)
+            i = DB_MIN;
+    }
+    else if(m_display_mode == DisplayMode::WAVEFORM)
+    {
+        // turn off stuff we don't need in this mode
+        m_window_func = FFTWindow::NONE;
+        m_auto_fft_size = false;
+        m_slope = 0.0f;
+        m_mirror_freq_axis = false;
+        m_log_scale = false;
+
+        // repurpose m_fft_size for buffer size
+        m_fft_size = m_width;
+        m_waveform_samples = (size_t)m_audio_info.samples_per_sec * (size_t)m_meter_ms / 1000u;
+        m_waveform_step_ns = ((uint64_t)m_meter_ms * 1000000u) / std::max<uint64_t>(m_fft_size, 1);
+        m_waveform_phase_step = m_waveform_step_ns * m_frames_per_ns;
+        m_waveform_ts = 0;
+        m_waveform_head = 0;
+    }
+    else if(m_display_mode == DisplayMode::SCOPE)
+    {
+        m_window_func = FFTWindow::NONE;
+        m_auto_fft_size = false;
+        m_slope = 0.0f;
+        m_mirror_freq_axis = false;
+        m_log_scale = false;
+
+        // repurpose m_fft_size for the window, the reader holds one more window before it to find the trigger in
+        const auto window = (size_t)m_audio_info.samples_per_sec * (size_t)m_meter_ms / 1000u;
+        m_fft_size = std::clamp(window, (size_t)16, MAX_SCOPE_SAMPLES);
+        m_waveform_samples = (m_fft_size * 2) + 1;
+        m_waveform_head = 0;
+    }
+    else if(m_display_mode == DisplayMode::VECTORSCOPE)
+    {
+        m_window_func = FFTWindow::NONE;
+        m_auto_fft_size = false;
+        m_slope = 0.0f;
+        m_mirror_freq_axis = false;
+        m_log_scale = false;
+        m_filter_mode = FilterMode::NONE;
+
+        // repurpose m_fft_size for the most sample pairs one tick draws, a couple of frames of audio
+        const auto per_frame = (m_fps > 0.0) ? (size_t)(m_audio_info.samples_per_sec / m_fps) : (size_t)m_audio_info.samples_per_sec / 30u;
+        m_fft_size = std::clamp(per_frame * 2, (size_t)256, MAX_SCOPE_SAMPLES);
+        m_waveform_samples = m_fft_size;
+        m_scope_points = 0;
+    }
+
+    if(m_normalize_volume)
+    {
+        m_input_rms = 0.0f;
+        m_input_rms_size = size_t(m_audio_info.samples_per_sec) & -16;
+        m_input_rms_pos = 0;
+        m_input_rms_sum = 0.0;
+    }
+
+    // calculate FFT size based on video FPS
+    if(m_auto_fft_size)
+    {
+        // at least one frame of audio, rounded up to a size FFTW has fast codelets for
+        m_fft_size = get_fast_fft_size(std::max(size_t(m_audio_info.samples_per_sec / m_fps), (size_t)128));
+    }
+
+    // initialize buffers
+    auto spectrum_mode = !m_meter_mode && !time_domain();
+    if(spectrum_mode)
+        apply_quality_level();
+    if(m_iir_fraction > 0)
+    {
+        // repurpose m_fft_size so the spectrum buffers hold one value per band
+        m_iir.init(m_audio_info.samples_per_sec, m_iir_fraction, (float)m_cutoff_low, (float)m_cutoff_high);
+        if(m_iir.empty())
+        {
+            LogWarn << "\"" << obs_source_get_name(m_source) << "\" has no filterbank bands between the cutoffs, using the FFT";
+            m_iir_fraction = 0;
+        }
+        else
+        {
+            m_fft_size = m_iir.lanes() * 2;
+            m_iir_window = (size_t)(m_audio_info.samples_per_sec / 4);
+        }
+    }
+    const auto iir = m_iir_fraction > 0;
+    if(!m_view)
+        m_view_fft_size.store(0, std::memory_order_relaxed);
+    else if(spectrum_mode)
+    {
+        // the bins line up with the parent's once its first spectrum showed its size
+        const auto parent_size = m_view_fft_size.load(std::memory_order_relaxed);
+        if(parent_size >= 16)
+            m_fft_size = parent_size;
+    }
+    const auto analysis = !iir && !m_view; // this source runs the transform itself
+    m_multires = m_multires && spectrum_mode && m_log_scale && !m_sliding_dft;
+    m_decimation = 1;
+    // high rate sessions decimate toward the reference rate even without the setting, what's above the cutoff isn't displayed
+    const auto high_rate = spectrum_mode && analysis && (m_audio_info.samples_per_sec > HIGH_RATE_REFERENCE);
+    if(m_multires)
+        m_decimation = MULTIRES_FACTOR;
+    else if((m_decimate || high_rate) && spectrum_mode && !m_sliding_dft && (m_cutoff_high > 0))
+    {
+        // the decimator keeps everything up to the cutoff clear of aliasing as long as the decimated rate has headroom above twice the cutoff
+        const auto sr = (double)m_audio_info.samples_per_sec;
+        const auto fits = [&](size_t factor) {
+            return (factor <= MAX_DECIMATION) && ((sr / (double)factor) * (1.0 - MIN_DECIMATION_HEADROOM) >= 2.0 * m_cutoff_high);
+        };
+        if(high_rate)
+        {
+            // the FFT size means the window of the reference rate, the decimated transform then costs what it would there
+            size_t factor = 1;
+            while(((double)(factor * 2) * HIGH_RATE_REFERENCE <= sr) && fits(factor * 2))
+                factor *= 2;
+            if(!m_auto_fft_size)
+                m_fft_size *= factor;
+            m_decimation = factor;
+        }
+        while(m_decimate && fits(m_decimation * 2) && ((m_fft_size / (m_decimation * 2)) >= 128))
+            m_decimation *= 2;
+    }
+    if(m_decimation > 1)
+        m_fft_size &= -(16 * (int)m_decimation); // keep the decimated transforms aligned
+    m_stft_hop = spectrum_mode ? std::min(m_stft_hop, m_fft_size) : 0;
+    m_output_channels = ((m_capture_channels > 1) || m_stereo) ? 2u : 1u;
+
+    // every buffer only for the channels its path touches:
+    // the spectrum works per transform, meter and waveform per capture channel, peaks per display channel
+    const auto display_channels = m_stereo ? 2u : 1u;
+    if(spectrum_mode)
+    {
+        m_fft_channels = std::max(m_downmix ? 1u : m_capture_channels, 1u); // channels back to back so both go through a single plan
+        select_spectrum_kernels();
+    }
+    const auto work_channels = m_meter_mode ? 0u : std::max(spectrum_mode ? m_fft_channels : m_capture_channels, display_channels); // meters keep their own ring
+    const auto count = spectrum_mode ? m_fft_size / 2 : m_fft_size;
+    const auto tsmooth = spectrum_mode && !m_view && ((m_tsmoothing != TSmoothingMode::NONE) || m_beat_detection);
+    const auto tsmoothsz = m_half_history ? count / 2 : count; // two fp16 per float
+
+    // everything sized here comes out of one block, in the order an analysis goes through it
+    if(iir)
+        m_arena.add(m_iir_input, IIR_CHUNK);
+    if(spectrum_mode && analysis)
+    {
+        m_arena.add(m_fft_input, m_fft_size * m_fft_channels);
+        if(!direct_decimation())
+            m_arena.add(m_fft_output, m_fft_size * m_fft_channels);
+    }
+    for(auto i = 0u; tsmooth && (i < m_fft_channels); ++i)
+        m_arena.add(m_tsmooth_buf[i], tsmoothsz);
+    for(auto i = 0u; i < work_channels; ++i)
+        m_arena.add(m_decibels[i], count);
+    if(m_meter_mode)
+        m_arena.add(m_meter_window, m_fft_size * m_meter_lanes);
+    for(auto i = 0u; m_peak_hold && (i < display_channels); ++i)
+    {
+        m_arena.add(m_peak_db[i], count);
+        m_arena.add(m_peak_timer[i], count);
+    }
+    if(m_normalize_volume)
+        m_arena.add(m_input_rms_buf, m_input_rms_size);
+    m_arena.commit();
+
+    if(m_meter_mode)
+        std::fill(m_meter_window.get(), m_meter_window.get() + m_meter_window.size(), 0.0f);
+    for(auto i = 0u; i < work_channels; ++i)
+        std::fill(m_decibels[i].get(), m_decibels[i].get() + count, (m_meter_mode || (m_display_mode == DisplayMode::SCOPE) || (m_display_mode == DisplayMode::VECTORSCOPE) || m_power_bands) ? 0.0f : DB_MIN);
+    m_onset.reset();
+    m_display_beats = 0;
+    m_beat_elapsed = std::numeric_limits<float>::infinity();
+    for(auto i = 0u; tsmooth && (i < m_fft_channels); ++i)
+        std::fill(m_tsmooth_buf[i].get(), m_tsmooth_buf[i].get() + tsmoothsz, 0.0f);
+    for(auto i = 0u; m_peak_hold && (i < display_channels); ++i)
+    {
+        std::fill(m_peak_db[i].get(), m_peak_db[i].get() + count, DB_MIN);
+        std::fill(m_peak_timer[i].get(), m_peak_timer[i].get() + count, 0.0f);
+    }
+    if(m_normalize_volume)
+        std::fill(m_input_rms_buf.get(), m_input_rms_buf.get() + m_input_rms_size, 0.0f);
+
+    if(spectrum_mode && analysis)
+    {
+        init_bin_window(); // before the tables, which then skip the window coefficients
+        request_tables();
+        init_sliding_dft();
+        init_decimation();
+        update_fft_plan();
+    }
+    else
+        m_sliding_dft = false;
+
+    m_last_silent = false;
+    m_dormant = false;
+    m_idle = false;
+    m_visible = obs_source_showing(m_source);
+    m_show = m_visible;
+    m_published_view.store(m_view, std::memory_order_relaxed);
+    m_parent_retry = 0.0f;
+    m_parent_sequence = 0;
+    if(!m_view || m_playback_path.empty())
+        m_playback.close();
+    else if(m_playback_path != m_playback.path())
+    {
+        m_playback.open(m_playback_path);
+        m_playback_elapsed = 0.0;
+        m_playback_warned = false;
+    }
+    m_hidden_seconds = 0.0f;
+    m_parked = false;   // recaptured above, a hidden source parks again after the delay
+    m_retries = 0;
+    m_next_retry = 0.0f;
+
+    // the shared capture stream is sized for its most demanding reader, the audio thread never reallocates
+    // leave room for the largest possible sync offset plus some slack for late ticks
+    // the sync point is the frame time, so a late tick only adds the audio that arrived since
+    const auto sr = m_audio_info.samples_per_sec;
+    m_capture_lag = (size_t)(((uint64_t)sr * MAX_SYNC_OFFSET) / 1000u) + (size_t)(sr / 4) + AUDIO_OUTPUT_FRAMES;
+
+    // waveform and scope modes pop everything the reader holds, which is at most its history
+    if(time_domain())
+        m_waveform_buf.resize(m_waveform_samples + m_capture_lag);
+    else
+        std::vector<float>().swap(m_waveform_buf);
+
+    recapture_audio();
+    held_stream.reset();
+
+    // precomupte interpolated indices
+    // a spline curve needs the texture driven path, the same conditions create_vbuf() checks for curves
+    m_spline = (m_display_mode == DisplayMode::CURVE) && (m_curve_points >= 4) && (m_curve_points < m_width) && !m_headless && (m_params.techs[1][0] != nullptr);
+    if(m_spline)
+    {
+        init_interp(m_curve_points);
+        m_interp_size = m_curve_points;
+    }
+    else if(curve_display() || (m_display_mode == DisplayMode::SPECTROGRAM))
+    {
+        init_interp(m_width);
+        m_interp_size = m_width;
+    }
+    else if(m_display_mode == DisplayMode::VECTORSCOPE)
+    {
+        // the samples go to the GPU as they are
+        m_interp = InterpLayout::none();
+        m_interp_size = 0;
+    }
+    else if(m_meter_mode)
+    {
+        // channel meter rendering through the bar renderer
+        // emulate 1-2 bar spectrum graph
+        m_interp = InterpLayout::none();
+        m_interp_size = m_capture_channels;
+        m_num_bars = m_capture_channels;
+    }
+    else if(iir)
+    {
+        // one bar per band, widened to fill the graph
+        m_num_bars = (int)m_iir.bands();
+        m_bar_width = std::max((((int)m_width + m_bar_gap) / m_num_bars) - m_bar_gap, 1);
+        init_interp(m_num_bars);
+        m_interp_size = m_num_bars;
+    }
+    else
+    {
+        const auto bar_stride = m_bar_width + m_bar_gap;
+        m_num_bars = (int)(m_width / bar_stride);
+        if(((int)m_width - (m_num_bars * bar_stride)) >= m_bar_width)
+            ++m_num_bars;
+        init_interp(m_num_bars + 1); // make extra band for last bar
+        m_interp_size = m_num_bars;
+    }
+
+    // display points come out of their own block, the filter output swaps with the channel's buffer by pointer
+    for(auto i = 0u; i < 3u; ++i)
+    {
+        m_interp_bufs[i].reset();
+        const auto used = (i < 2u) ? (i < display_channels) : (m_filter_mode != FilterMode::NONE);
+        if(used)
+            m_display_arena.add(m_interp_bufs[i], m_interp_size);
+    }
+    for(auto i = 0u; i < 2u; ++i)
+    {
+        const auto used = i < display_channels;
+        m_display_history[i].reset();
+        m_peak_bars[i].reset();
+        if(used && (m_display_tsmoothing != TSmoothingMode::NONE))
+            m_display_arena.add(m_display_history[i], m_interp_size);
+        if(used && m_peak_hold && !m_meter_mode)
+            m_display_arena.add(m_peak_bars[i], m_interp_size);
+    }
+    m_display_arena.commit();
+    for(auto& history : m_display_history)
+        if(history)
+            std::fill(history.get(), history.get() + m_interp_size, 0.0f);
+    init_active_bins();
+    init_pruning();
+
+    // filter, the radius is in pixels and control points are further apart
+    const auto filter_radius = m_spline ? m_filter_radius * (float)m_interp_size / (float)m_width : m_filter_radius;
+    if(m_filter_mode == FilterMode::GAUSS)
+        m_kernel = make_gauss_kernel(filter_radius);
+    else if(m_filter_mode == FilterMode::RECURSIVE_GAUSS)
+        m_recursive_gauss = make_recursive_gauss(filter_radius);
+
+    // rounded caps
+    m_cap_verts.clear();
+    if(m_rounded_caps)
+    {
+        // caps are full circles to avoid distortion issues in radial mode
+        m_cap_radius = (float)m_bar_width / 2.0f;
+        m_cap_tris = std::max((int)((2 * pi * m_cap_radius) / 3.0f), 4);
+        if(m_cap_tris & 1) // force even number of triangles
+            m_cap_tris += 1;
+        auto angle = (2 * pi) / (float)m_cap_tris;
+        auto verts = m_cap_tris + 1;
+        m_cap_verts.resize(verts);
+        for(auto j = 0; j < verts; ++j)
+        {
+            auto a = j * angle;
+            vec3_set(&m_cap_verts[j], m_cap_radius * std::cos(a), m_cap_radius * std::sin(a), 0.0f);
+        }
+    }
+
+    // stepped bars
+    if((m_display_mode == DisplayMode::STEPPED_BAR) || (m_display_mode == DisplayMode::STEPPED_METER))
+        init_steps();
+
+    // the plain single frame transform of a curve, with nothing on the CPU reading the spectrum past it
+    // create_vbuf() also needs the texture driven mesh
+    m_gpu_fft = m_gpu_fft && spectrum_mode && analysis && (m_display_mode == DisplayMode::CURVE) && !m_headless
+        && std::has_single_bit(m_fft_size) && (m_fft_size <= GpuFFT::MAX_SIZE) && (m_stft_hop == 0) && !m_sliding_dft && (m_decimation == 1) && m_goertzel.empty()
+        && (m_tsmoothing == TSmoothingMode::NONE) && (m_display_tsmoothing == TSmoothingMode::NONE) && (m_filter_mode == FilterMode::NONE)
+        && !m_peak_hold && !m_beat_detection && !m_mirror_freq_axis && !m_normalize_volume && m_window_taps.empty() && (m_channel_mode != ChannelMode::MID_SIDE);
+    if(m_gpu_fft)
+    {
+        std::fill(m_fft_input.get(), m_fft_input.get() + (m_fft_size * m_fft_channels), 0.0f); // published before the first window
+
+        // m_decibels stays at DB_MIN, the histogram would pin the curve to the ceiling
+        m_auto_range = false;
+        m_range_floor = m_floor;
+        m_range_ceiling = m_ceiling;
+    }
+
+    // the waveform envelope needs every column drawn the same way, nothing on the CPU reads the columns
+    const auto raw_size = m_waveform_samples + WAVEFORM_RAW_MARGIN;
+    m_gpu_waveform = m_gpu_waveform && (m_display_mode == DisplayMode::WAVEFORM) && !m_headless && (m_fft_size > 0) && (raw_size <= GpuEnvelope::MAX_SAMPLES)
+        && (m_display_tsmoothing == TSmoothingMode::NONE) && (m_filter_mode == FilterMode::NONE) && !m_peak_hold && !m_normalize_volume;
+    for(auto channel = 0u; channel < 2u; ++channel)
+    {
+        if(m_gpu_waveform && (channel < m_capture_channels))
+        {
+            m_waveform_raw[channel].reset(raw_size);
+            std::fill(m_waveform_raw[channel].get(), m_waveform_raw[channel].get() + raw_size, 0.0f);
+        }
+        else
+            m_waveform_raw[channel].reset();
+        m_waveform_quiet[channel] = raw_size;
+    }
+    m_waveform_raw_head = 0;
+    m_waveform_raw_written = 0;
+    m_waveform_raw_end = 0.0f;
+
+    // vertex buffer must be rebuilt if the settings have changed
+    // this must be done after m_num_bars has been initialized
+    create_vbuf();
+    m_shader_dirty = true;
+    reset_frames();
+
+    // scene item transforms query the size many times a frame, they never wait on the lock
+    m_published_width.store(m_headless ? 0 : graph_width(), std::memory_order_relaxed);
+    m_published_height.store(m_headless ? 0 : graph_height(), std::memory_order_relaxed);
+
+    const auto budget = m_meter_mode ? METER_MEMORY_BUDGET : time_domain() ? WAVEFORM_MEMORY_BUDGET : SPECTRUM_MEMORY_BUDGET;
+    const auto used = buffer_bytes();
+    if(used > budget)
+        LogWarn << "\"" << obs_source_get_name(m_source) << "\" uses " << (used >> 10) << " KiB, over the " << (budget >> 10) << " KiB budget for its mode";
+    else
+        LogDebug << "\"" << obs_source_get_name(m_source) << "\" uses " << (used >> 10) << " KiB";
+
+    // render() only draws what tick prepared, have something valid before the first tick
+    prepare_display(0.0f);
+}
+
+void WAVSource::apply_quality_level()
+{
+    // cumulative, each level drops one more thing in the order that saves the most for the least visible loss
+    const auto level = m_quality_level;
+    if(level >= 1)
+        m_fft_size = std::max(m_fft_size / 2, (size_t)128) & -16;
+    if(level >= 2)
+        m_fft_size = std::max(m_fft_size / 2, (size_t)128) & -16;
+    if((level >= 3) && (m_interp_mode != InterpMode::POINT))
+        m_interp_mode = (m_interp_mode == InterpMode::LANCZOS) ? InterpMode::CATROM : InterpMode::POINT;
+    if(level >= 4)
+        m_interp_mode = InterpMode::POINT;
+    if(level >= 5)
+        m_filter_mode = FilterMode::NONE;
+    if(level >= 6)
+    {
+        m_analysis_interval = std::min(std::max(m_analysis_interval * 2, 2u), (uint32_t)MAX_ANALYSIS_INTERVAL);
+        m_analysis_phase = AnalysisWorker::assign_phase(this, m_analysis_interval);
+    }
+}
+
+bool WAVSource::govern_quality(float seconds)
+{
+    // tick thread only, apart from what update() reads under the locks
+    double render_ns = 0.0;
+    double analysis_ns = 0.0;
+    {
+        std::lock_guard lock(m_mtx);
+        if(m_cpu_budget <= 0.0f)
+        {
+            m_governor_timer = 0.0f;
+            m_governor_calm = 0.0f;
+            return std::exchange(m_quality_level, 0) != 0;
+        }
+        m_governor_timer += seconds;
+        if(m_governor_timer < GOVERNOR_INTERVAL)
+            return false;
+        m_governor_timer = 0.0f;
+        render_ns = m_render_cost.avg_ns;
+    }
+    {
+        std::lock_guard lock(m_analysis_mtx);
+        analysis_ns = m_analysis_cost.avg_ns;
+    }
+
+    std::lock_guard lock(m_mtx);
+    const auto cost = (render_ns + analysis_ns) / 1e6;
+    const auto old_level = m_quality_level;
+    if(cost > m_cpu_budget)
+    {
+        m_governor_calm = 0.0f;
+        m_quality_level = std::min(m_quality_level + 1, MAX_QUALITY_LEVEL);
+    }
+    else if((m_quality_level > 0) && (cost < (m_cpu_budget * GOVERNOR_HEADROOM)))
+    {
+        // one step up at a time, and only after the cost stayed low for a while
+        m_governor_calm += GOVERNOR_INTERVAL;
+        if(m_governor_calm >= GOVERNOR_RECOVERY)
+        {
+            m_governor_calm = 0.0f;
+            --m_quality_level;
+        }
+    }
+    else
+        m_governor_calm = 0.0f;
+
+    if(m_quality_level == old_level)
+        return false;
+    LogInfo << "\"" << obs_source_get_name(m_source) << "\" " << cost << " ms against a budget of " << m_cpu_budget
+        << " ms, quality level " << old_level << " -> " << m_quality_level;
+    return true;
+}
+
+bool WAVSource::export_demanded() const
+{
+    return (m_export_demand_ts.load(std::memory_order_relaxed) + EXPORT_DEMAND_TIMEOUT) > os_gettime_ns();
+}
+
+bool WAVSource::check_sleep(float seconds)
+{
+    // tick thread only, views of this source and exports keep it awake through the demand timestamp
+    bool awake;
+    float timeout;
+    {
+        std::lock_guard lock(m_mtx);
+        timeout = m_sleep_timeout;
+        awake = (timeout <= 0.0f) || m_headless;
+    }
+    if(awake || obs_source_showing(m_source) || export_demanded())
+    {
+        m_sleep_seconds = 0.0f;
+        return false;
+    }
+    m_sleep_seconds += seconds;
+    if(m_sleep_seconds < timeout)
+        return false;
+    deep_sleep();
+    return true;
+}
+
+void WAVSource::deep_sleep()
+{
+    AnalysisWorker::wait(this);
+    std::lock_guard lock(m_mtx);
+    std::lock_guard analysis_lock(m_analysis_mtx);
+    const auto bytes = buffer_bytes();
+
+    obs_enter_graphics();
+    for(auto i = 0u; i < RENDER_RING; ++i)
+    {
+        gs_vertexbuffer_destroy(m_vbuf[i]);
+        gs_texture_destroy(m_value_tex[i]);
+        m_vbuf[i] = nullptr;
+        m_value_tex[i] = nullptr;
+    }
+    m_gpu_analysis.destroy();
+    m_gpu_envelope.destroy();
+    gs_texture_destroy(m_spectrogram_row);
+    gs_texrender_destroy(m_spectrogram_rows);
+    gs_texrender_destroy(m_scope_target);
+    gs_texrender_destroy(m_glow_target);
+    m_spectrogram_row = nullptr;
+    m_spectrogram_rows = nullptr;
+    m_scope_target = nullptr;
+    m_glow_target = nullptr;
+    // the cache texture only comes back once it's drawn into
+    gs_texrender_destroy(m_cache);
+    m_cache = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+    obs_leave_graphics();
+    m_mesh_layout = {};
+    m_ring_pos = 0;
+    m_gpu_bytes = 0;
+
+    // the stream, FFT plans and tables are shared, the next build finds whatever is still cached
+    release_audio_capture();
+    free_bufs();
+    for(auto& buf : m_interp_bufs)
+        buf.reset();
+    for(auto i = 0u; i < 2u; ++i)
+    {
+        m_peak_bars[i].reset();
+        m_display_history[i].reset();
+        m_tween_from[i].reset();
+        m_tween[i].reset();
+        m_waveform_display[i].reset();
+    }
+    std::vector<float>().swap(m_waveform_buf);
+
+    // update() rebuilds everything once the source is shown again
+    m_structure_key.clear();
+    m_built.store(false, std::memory_order_release);
+    m_update_pending.store(true, std::memory_order_release);
+    m_sleep_seconds = 0.0f;
+    m_asleep = true;
+    LogInfo << "\"" << obs_source_get_name(m_source) << "\" asleep after " << m_sleep_timeout << " s hidden, released about " << (bytes / 1024) << " KiB";
+}
+
+bool WAVSource::check_output_format(float seconds)
+{
+    std::lock_guard lock(m_mtx);
+    m_format_timer += seconds;
+    if(m_format_timer < FORMAT_CHECK_INTERVAL)
+        return false;
+    m_format_timer = 0.0f;
+
+    // nothing to compare against if OBS has no audio, update() already warned about it
+    obs_audio_info info = {};
+    if(!obs_get_audio_info(&info))
+        return false;
+    if((info.samples_per_sec != m_audio_info.samples_per_sec) || (info.speakers != m_audio_info.speakers))
+        return true;
+    return m_auto_fft_size && (get_video_fps() != m_fps);
+}
+
+void WAVSource::request_update(obs_data_t *settings)
+{
+    // settings pushes come in bursts, every change up to the next tick costs one rebuild
+    // the settings are read again then, they may have changed since
+    bool live;
+    {
+        std::lock_guard lock(m_mtx);
+        live = !m_update_pending.load(std::memory_order_relaxed) && (get_structure_key(settings) == m_structure_key);
+    }
+    if(live)
+        update(settings);
+    else
+    {
+        const auto now = os_gettime_ns();
+        if(!m_update_pending.load(std::memory_order_relaxed))
+            m_update_first_ns.store(now, std::memory_order_relaxed);
+        m_update_last_ns.store(now, std::memory_order_relaxed);
+        m_update_pending.store(true, std::memory_order_release);
+    }
+}
+
+void WAVSource::defer_update(obs_data_t *settings)
+{
+    // a collection load creates every source, most sit in scenes nobody opens
+    // capture, tables, plans and meshes wait until the source is first shown
+    // headless sources are never shown, views and exports need them running from the start
+    if(obs_data_get_bool(settings, P_HEADLESS))
+    {
+        update(settings);
+        return;
+    }
+    m_published_width.store((unsigned int)std::max(obs_data_get_int(settings, P_WIDTH), 0ll), std::memory_order_relaxed);
+    m_published_height.store((unsigned int)std::max(obs_data_get_int(settings, P_HEIGHT), 0ll), std::memory_order_relaxed);
+    m_update_pending.store(true, std::memory_order_release);
+}
+
+void WAVSource::tick(float seconds)
+{
+    const auto built = m_built.load(std::memory_order_acquire);
+    auto settled = !built;
+    if(built && m_update_pending.load(std::memory_order_acquire))
+    {
+        // the first build isn't held back, a deferred source should appear as soon as it's shown
+        const auto now = os_gettime_ns();
+        settled = ((now - m_update_last_ns.load(std::memory_order_relaxed)) >= UPDATE_IDLE)
+            || ((now - m_update_first_ns.load(std::memory_order_relaxed)) >= UPDATE_MAX_DELAY);
+    }
+    // a sleeping source also wakes for a consumer asking for its data
+    const auto wake = built || obs_source_showing(m_source) || (m_asleep && export_demanded());
+    if(m_update_pending.load(std::memory_order_acquire) && settled && wake && claim_rebuild(MAX_REBUILDS_PER_FRAME))
+    {
+        m_update_pending.store(false, std::memory_order_relaxed);
+        m_asleep = false;
+        auto settings = obs_source_get_settings(m_source);
+        update(settings);
+        obs_data_release(settings);
+    }
+    if(!m_built.load(std::memory_order_acquire))
+        return;
+    if(check_sleep(seconds))
+        return;
+
+    // OBS doesn't tell sources about video or audio resets, so poll for them
+    // the settings are unchanged, update() rebuilds what depends on the format and keeps the capture subscribed
+    if(check_output_format(seconds))
+    {
+        LogInfo << "\"" << obs_source_get_name(m_source) << "\" adapting to the new output format";
+        auto settings = obs_source_get_settings(m_source);
+        update(settings);
+        obs_data_release(settings);
+    }
+    if(govern_quality(seconds) || check_view_layout())
+    {
+        auto settings = obs_source_get_settings(m_source);
+        update(settings);
+        obs_data_release(settings);
+    }
+
+    // the stats are copied under the lock and logged after it's released
+    auto log_stats = false;
+    size_t bytes = 0;
+    CallCost tick_cost, render_cost, lock_wait;
+    auto log_latency = false;
+    float latency[2][2] = {}; // p50 and p99 of each measurement
+    size_t latency_count = 0;
+    auto envelope = false;
+    float envelope_level = 0.0f, envelope_db = 0.0f;
+    uint64_t envelope_ts = 0;
+    {
+        const TimedLock lock(m_mtx, m_lock_wait, m_health.contended, m_plots.lock_wait);
+        const auto tick_ts = os_gettime_ns();
+        const CostTimer timer(m_tick_cost, tick_ts, m_plots.tick);
+        if(m_capture_log != nullptr)
+            m_capture_log->push_tick(tick_ts, seconds);
+        if(m_log_stats && ((m_stats_timer += seconds) >= STATS_LOG_INTERVAL))
+        {
+            m_stats_timer = 0.0f;
+            log_stats = true;
+            bytes = buffer_bytes();
+            tick_cost = m_tick_cost;
+            render_cost = m_render_cost;
+            lock_wait = m_lock_wait;
+        }
+        if(m_log_latency && ((m_latency_timer += seconds) >= STATS_LOG_INTERVAL))
+        {
+            m_latency_timer = 0.0f;
+            latency_count = m_latency_samples[0].size();
+            log_latency = latency_count > 0;
+            for(auto i = 0u; log_latency && (i < 2u); ++i)
+            {
+                latency[i][0] = percentile(m_latency_samples[i], 0.5);
+                latency[i][1] = percentile(m_latency_samples[i], 0.99);
+            }
+            for(auto& samples : m_latency_samples)
+                samples.clear();
+        }
+
+        // start the next analysis, on a worker it finishes while the rest of the frame is ticked
+        // a worker still busy with the last one gets the time it missed with the next
+        // joined analysis is displayed by render(), which waits for it
+        m_analysis_seconds += seconds;
+        const auto elapsed = m_analysis_seconds;
+        const auto frame_ts = obs_get_video_frame_time();
+        const auto job = [this, elapsed, tick_ts, frame_ts] { analyze(elapsed, tick_ts, frame_ts); };
+        // on frames left to other phases the display blends toward the last result instead
+        if(!skip_analysis(frame_ts, elapsed))
+        {
+            if(!m_async_analysis)
+            {
+                job();
+                m_analysis_seconds = 0.0f;
+            }
+            else if(AnalysisWorker::queue(this, job))
+            {
+                m_analysis_seconds = 0.0f;
+                m_join_pending = m_join_analysis && !m_headless; // nothing renders to join it
+            }
+        }
+
+        if(m_join_pending)
+            m_display_seconds += seconds;
+        else
+            display_frame(seconds);
+
+        if(m_auto_range)
+            update_auto_range(seconds);
+
+        // copied out so handlers can call back into the source
+        envelope = m_envelope && update_envelope(seconds);
+        if(envelope)
+        {
+            m_envelope_signal.assign(m_envelope_bands.begin(), m_envelope_bands.end());
+            envelope_level = m_envelope_level;
+            envelope_db = lerp((float)m_range_floor, (float)m_range_ceiling, m_envelope_level);
+            envelope_ts = m_display_audio_ts;
+        }
+    }
+
+    if(envelope)
+    {
+        calldata_t cd = {};
+        calldata_set_ptr(&cd, "source", m_source);
+        calldata_set_float(&cd, "level", envelope_level);
+        calldata_set_float(&cd, "db", envelope_db);
+        calldata_set_ptr(&cd, "bands", m_envelope_signal.empty() ? nullptr : m_envelope_signal.data());
+        calldata_set_int(&cd, "count", (long long)m_envelope_signal.size());
+        calldata_set_int(&cd, "audio_ts", (long long)envelope_ts);
+        signal_handler_signal(obs_source_get_signal_handler(m_source), "envelope", &cd);
+        calldata_free(&cd);
+    }
+
+    if(log_latency)
+        LogInfo << "\"" << obs_source_get_name(m_source) << "\" latency over " << latency_count << " frames, audio arrival to render "
+            << latency[0][0] << " ms (p99 " << latency[0][1] << "), video frame time ahead of the drawn audio " << latency[1][0] << " ms (p99 " << latency[1][1] << ")";
+
+    if(log_stats)
+    {
+        // events since the last log, out of the lock since they're atomic
+        const uint64_t health[] = { m_health.overflows.load(std::memory_order_relaxed), m_health.underruns.load(std::memory_order_relaxed),
+            m_health.resyncs.load(std::memory_order_relaxed), m_health.contended.load(std::memory_order_relaxed) };
+        if(health[0] + health[1] + health[2] + health[3] != m_health_logged[0] + m_health_logged[1] + m_health_logged[2] + m_health_logged[3])
+            LogInfo << "\"" << obs_source_get_name(m_source) << "\" overflows " << (health[0] - m_health_logged[0]) << ", underruns "
+                << (health[1] - m_health_logged[1]) << ", resyncs " << (health[2] - m_health_logged[2]) << ", contended locks "
+                << (health[3] - m_health_logged[3]);
+        std::copy(std::begin(health), std::end(health), m_health_logged);
+
+        LogInfo << "\"" << obs_source_get_name(m_source) << "\" " << (bytes >> 10) << " KiB, tick " << (tick_cost.avg_ns / 1e6) << " ms (max "
+            << ((double)tick_cost.max_ns / 1e6) << "), render " << (render_cost.avg_ns / 1e6) << " ms (max " << ((double)render_cost.max_ns / 1e6)
+            << "), lock wait " << (lock_wait.avg_ns / 1e6) << " ms (max " << ((double)lock_wait.max_ns / 1e6) << "), tick p99 "
+            << tick_cost.histogram.percentile(0.99) << " ms (p99.9 " << tick_cost.histogram.percentile(0.999) << "), render p99 "
+            << render_cost.histogram.percentile(0.99) << " ms (p99.9 " << render_cost.histogram.percentile(0.999) << ")";
+
+        // kernel time per analysis with what it depends on, comparable between builds and machines
+        CallCost kernel_cost;
+        const char *kernel;
+        size_t size, width;
+        {
+            std::lock_guard lock(m_analysis_mtx);
+            kernel_cost = m_kernel_cost;
+            kernel = kernel_name();
+            size = m_fft_size;
+            width = m_width;
+        }
+        LogInfo << "\"" << obs_source_get_name(m_source) << "\" " << DSPKernels::get().analysis_name << " " << kernel << ", size " << size << ", width " << width
+            << ": " << (kernel_cost.avg_ns / 1e3) << " us per analysis (max " << ((double)kernel_cost.max_ns / 1e3) << ") over " << kernel_cost.calls;
+    }
+}
+
+// nearest rank, reorders values
+float WAVSource::percentile(std::vector<float>& values, double p)
+{
+    if(values.empty())
+        return 0.0f;
+    const auto rank = std::min((size_t)std::ceil(p * (double)values.size()), values.size()) - 1;
+    const auto nth = values.begin() + (std::ptrdiff_t)rank;
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+}
+
+const char *WAVSource::kernel_name() const noexcept
+{
+    if(m_meter_mode)
+        return "meter";
+    if(m_display_mode == DisplayMode::WAVEFORM)
+        return "waveform";
+    if(m_display_mode == DisplayMode::SCOPE)
+        return "scope";
+    if(m_display_mode == DisplayMode::VECTORSCOPE)
+        return "vectorscope";
+    if(m_iir_fraction > 0)
+        return "iir";
+    if(m_view)
+        return "view";
+    return "spectrum";
+}
+
+bool WAVSource::skip_analysis(uint64_t frame_ts, float elapsed) const
+{
+    // the analysis window follows the clock, elapsed time is the audio it would move by
+    // a window that barely moved transforms to nearly the same spectrum, keep the last one
+    if((m_min_hop > 0) && ((double)elapsed * m_audio_info.samples_per_sec < (double)m_min_hop))
+        return true;
+    const auto interval = analysis_interval();
+    if((interval <= 1) || (m_fps <= 0.0))
+        return false;
+    const auto frame = (uint64_t)std::llround((double)frame_ts * m_fps / 1e9);
+    return (frame % interval) != ((interval == m_analysis_interval) ? m_analysis_phase : m_preview_phase);
+}
+
+uint32_t WAVSource::analysis_interval() const
+{
+    if((m_preview_interval <= m_analysis_interval) || m_active.load(std::memory_order_relaxed))
+        return m_analysis_interval;
+    return m_preview_interval;
+}
+
+void WAVSource::set_active(bool active)
+{
+    // switches the interval on the next tick, the blend buffers are already there
+    m_active.store(active, std::memory_order_relaxed);
+}
+
+bool WAVSource::tween_frames() const
+{
+    if(analysis_interval() > 1)
+        return true;
+    // min hop only skips frames on canvases that tick faster than it
+    return (m_min_hop > 0) && ((m_fps * (double)m_min_hop) > (double)m_audio_info.samples_per_sec);
+}
+
+void WAVSource::display_frame(float seconds)
+{
+    // display the newest finished analysis, nothing new keeps the last graph
+    // unless frames are skipped, then the display moves from the previous result to the newest
+    // over the audio time between the two, so the motion keeps its speed whatever the analysis rate
+    const DenormalGuard denormals; // peaks and display smoothing decay too
+    m_display_seconds += seconds;
+    m_beat_elapsed += seconds;
+    const auto tween = tween_frames();
+    if(m_frames.fresh())
+    {
+        // the old front may be refilled once it's released, keep the starting point first
+        if(tween)
+            for(auto channel = 0u; channel < 2u; ++channel)
+                if(m_tween_from[channel])
+                    std::copy(&m_display_db[channel][m_first_bin], &m_display_db[channel][m_last_bin], &m_tween_from[channel][m_first_bin]);
+        const auto prev_ts = m_frames.front().audio_ts;
+        m_frames.acquire();
+        const auto next_ts = m_frames.front().audio_ts;
+        if((prev_ts > 0) && (next_ts > prev_ts))
+            m_tween_period = std::min((float)((double)(next_ts - prev_ts) / 1e9), MAX_TWEEN_PERIOD);
+        else
+            m_tween_period = (m_fps > 0.0) ? (float)(analysis_interval() / m_fps) : 0.0f; // no audio timestamps, one interval
+        m_tween_elapsed = 0.0f;
+        m_latency_pending = true;
+    }
+    else if(!tween || (m_tween_elapsed >= m_tween_period))
+        return;
+    const auto display_seconds = std::exchange(m_display_seconds, 0.0f);
+    const auto& frame = m_frames.front();
+    m_display_audio_ts = frame.audio_ts;
+    m_display_arrival_ts = frame.arrival_ts;
+    if(frame.beats != m_display_beats)
+        m_beat_elapsed = 0.0f;
+    m_display_beats = frame.beats;
+    m_beat_period = frame.beat_period;
+    m_display_db[0] = frame.values[0].get();
+    m_display_db[1] = frame.values[1].get();
+    m_display_samples[0] = frame.samples[0].get();
+    m_display_samples[1] = frame.samples[1].get();
+    m_display_raw_head = frame.raw_head;
+    m_display_raw_end = frame.raw_end;
+    m_display_points = frame.points;
+    if(tween)
+    {
+        m_tween_elapsed += display_seconds;
+        const auto t = (m_tween_period > 0.0f) ? std::min(m_tween_elapsed / m_tween_period, 1.0f) : 1.0f;
+        for(auto channel = 0u; channel < 2u; ++channel)
+        {
+            if(!m_tween[channel])
+                continue;
+            const auto from = m_tween_from[channel].get();
+            const auto to = frame.values[channel].get();
+            const auto dst = m_tween[channel].get();
+            for(auto i = m_first_bin; i < m_last_bin; ++i)
+                dst[i] = from[i] + ((to[i] - from[i]) * t);
+            m_display_db[channel] = dst;
+        }
+    }
+    unroll_waveform();
+    const auto was_silent = m_display_silent;
+    m_display_silent = frame.silent;
+
+    auto idle = false;
+    if(!m_meter_mode && !time_domain())
+    {
+        // per source, after the cache so sources sharing a spectrum keep their own peaks
+        if(m_peak_hold && !m_headless)
+            tick_peak_hold(display_seconds);
+
+        // the spectrum doesn't change while silence continues, nor does anything drawn from it
+        // unless peaks or display smoothing are still decaying, a spectrogram keeps scrolling
+        idle = was_silent && m_display_silent && !m_peak_hold && (m_display_tsmoothing == TSmoothingMode::NONE) && (m_display_mode != DisplayMode::SPECTROGRAM) && (m_afterglow <= 0.0f)
+            && ((m_render_mode != RenderMode::PULSE) || (m_pulse_mode != PulseMode::BEAT) || (beat_pulse() <= 0.0f));
+    }
+
+    // headless only interpolates what the band export reads, never to pixels
+    m_idle = idle;
+    const auto bars = !m_meter_mode && ((m_display_mode == DisplayMode::BAR) || (m_display_mode == DisplayMode::STEPPED_BAR));
+    if(!idle && (!m_headless || (bars && (m_bands_export.active() || m_shm_export.is_open() || m_recorder.is_open() || m_envelope))))
+        prepare_display(display_seconds);
+    if(m_shm_export.is_open())
+        export_shared_frame();
+    if(m_recorder.is_open())
+        record_frame();
+}
+
+void WAVSource::record_frame()
+{
+    FrameRecorder::Frame frame;
+    frame.frame_ts = obs_get_video_frame_time();
+    frame.audio_ts = m_display_audio_ts;
+    frame.channels = m_stereo ? 2 : 1;
+    const auto& front = m_frames.front();
+    if(m_meter_mode)
+    {
+        frame.channels = std::clamp(m_capture_channels, 1u, 2u);
+        frame.values[0] = &front.meter[0];
+        frame.values[1] = &front.meter[1];
+        frame.count = 1;
+    }
+    else if((m_display_mode == DisplayMode::BAR) || (m_display_mode == DisplayMode::STEPPED_BAR))
+    {
+        if((m_export_bands[frame.channels - 1].size() != (size_t)m_num_bars) || (m_export_bands[0].size() != (size_t)m_num_bars)
+            || (m_interp->band_hz.size() != (size_t)m_num_bars))
+            return;
+        for(auto channel = 0u; channel < frame.channels; ++channel)
+            frame.values[channel] = m_export_bands[channel].data();
+        frame.hz = m_interp->band_hz.data();
+        frame.count = (size_t)m_num_bars;
+    }
+    else if(!time_domain() && (m_iir_fraction == 0) && (m_last_bin > m_first_bin) && (m_display_db[0] != nullptr))
+    {
+        frame.count = m_last_bin - m_first_bin;
+        const auto bin_hz = (float)m_audio_info.samples_per_sec / (float)m_fft_size;
+        m_record_hz.resize(frame.count);
+        for(size_t i = 0; i < frame.count; ++i)
+            m_record_hz[i] = (float)(m_first_bin + i) * bin_hz;
+        for(auto channel = 0u; channel < frame.channels; ++channel)
+            frame.values[channel] = (m_display_db[channel] != nullptr) ? &m_display_db[channel][m_first_bin] : nullptr;
+        frame.hz = m_record_hz.data();
+    }
+    m_recorder.push(frame);
+}
+
+float WAVSource::follow_envelope(float current, float target, float seconds) const
+{
+    const auto tau = (target > current) ? m_envelope_attack : m_envelope_release;
+    if((tau <= 0.0f) || (seconds <= 0.0f))
+        return (tau <= 0.0f) ? target : current;
+    return target + ((current - target) * std::exp(-seconds / tau));
+}
+
+bool WAVSource::update_envelope(float seconds)
+{
+    // levels of what's displayed: bars after interpolation, meter channels, or the loudest bin of other modes
+    if(time_domain())
+        return false;
+    const auto dbrange = m_range_ceiling - m_range_floor;
+    if(dbrange <= 0)
+        return false;
+    const auto normalize = [&](float db) { return std::clamp((db - m_range_floor) / (float)dbrange, 0.0f, 1.0f); };
+    const auto& frame = m_frames.front();
+    size_t count = 0;
+    float targets[2]{};
+    const float *bands[2] = {};
+    if(m_meter_mode)
+    {
+        count = std::min<size_t>(m_capture_channels, 2);
+        for(auto i = 0u; i < count; ++i)
+            targets[i] = m_display_silent ? 0.0f : normalize(frame.meter[i]);
+    }
+    else if((m_display_mode == DisplayMode::BAR) || (m_display_mode == DisplayMode::STEPPED_BAR))
+    {
+        count = (size_t)std::max(m_num_bars, 0);
+        for(auto channel = 0u; channel < (m_stereo ? 2u : 1u); ++channel)
+            if(m_export_bands[channel].size() == count)
+                bands[channel] = m_export_bands[channel].data();
+        if(bands[0] == nullptr)
+            count = 0;
+    }
+
+    m_envelope_bands.resize(count);
+    auto overall = 0.0f;
+    for(auto i = 0u; i < count; ++i)
+    {
+        auto target = targets[i];
+        if(bands[0] != nullptr)
+        {
+            // stereo bars follow the louder channel
+            const auto db = (bands[1] != nullptr) ? std::max(bands[0][i], bands[1][i]) : bands[0][i];
+            target = m_display_silent ? 0.0f : normalize(db);
+        }
+        m_envelope_bands[i] = follow_envelope(m_envelope_bands[i], target, seconds);
+        overall = std::max(overall, target);
+    }
+    if((count == 0) && !m_display_silent)
+    {
+        for(auto channel = 0u; channel < (m_stereo ? 2u : 1u); ++channel)
+        {
+            if(m_display_db[channel] == nullptr)
+                continue;
+            for(auto i = m_first_bin; i < m_last_bin; ++i)
+                overall = std::max(overall, normalize(m_display_db[channel][i]));
+        }
+    }
+    m_envelope_level = follow_envelope(m_envelope_level, overall, seconds);
+    return true;
+}
+
+void WAVSource::update_auto_range(float seconds)
+{
+    // the same levels the envelope follows, silence would drag the floor down to DB_MIN
+    // nor is there anything to follow while the GPU curve leaves m_decibels at DB_MIN
+    if(m_display_silent || m_gpu_fft || (seconds <= 0.0f))
+        return;
+    const auto& frame = m_frames.front();
+    const float *levels[MAX_AUDIO_CHANNELS] = {};
+    size_t rows = 0;
+    size_t first = 0, last = 0;
+    if(m_meter_mode)
+    {
+        for(; rows < m_capture_channels; ++rows)
+            levels[rows] = &frame.meter[rows];
+        last = 1;
+    }
+    else if((m_display_mode == DisplayMode::BAR) || (m_display_mode == DisplayMode::STEPPED_BAR))
+    {
+        last = (size_t)std::max(m_num_bars, 0);
+        for(auto channel = 0u; channel < (m_stereo ? 2u : 1u); ++channel)
+            if(m_export_bands[channel].size() == last)
+                levels[rows++] = m_export_bands[channel].data();
+    }
+    else
+    {
+        first = m_first_bin;
+        last = m_last_bin;
+        for(auto channel = 0u; channel < (m_stereo ? 2u : 1u); ++channel)
+            if(m_display_db[channel] != nullptr)
+                levels[rows++] = m_display_db[channel];
+    }
+    const auto count = rows * (std::max(last, first) - first);
+    if(count == 0)
+        return; // nothing on the CPU to measure, the range holds
+
+    const auto decay = std::exp(-seconds / AUTO_RANGE_TIME);
+    const auto weight = (1.0f - decay) / (float)count;
+    for(auto& bin : m_range_hist)
+        bin *= decay;
+    for(size_t row = 0; row < rows; ++row)
+    {
+        for(auto i = first; i < last; ++i)
+        {
+            const auto db = levels[row][i];
+            const auto bin = (db > (float)AUTO_RANGE_LOW) ? std::min((int)(db - (float)AUTO_RANGE_LOW), AUTO_RANGE_BINS - 1) : 0;
+            m_range_hist[bin] += weight;
+        }
+    }
+    m_range_weight = (m_range_weight * decay) + (1.0f - decay);
+
+    // lower edge of the bin the floor percentile falls in, upper edge of the ceiling one
+    const auto percentile = [this](float fraction) {
+        const auto target = fraction * m_range_weight;
+        auto sum = 0.0f;
+        for(auto bin = 0; bin < AUTO_RANGE_BINS; ++bin)
+            if((sum += m_range_hist[bin]) >= target)
+                return bin;
+        return AUTO_RANGE_BINS - 1;
+    };
+    const auto ceiling = AUTO_RANGE_LOW + percentile(AUTO_RANGE_CEILING) + 1 + AUTO_RANGE_HEADROOM;
+    const auto floor = std::min(AUTO_RANGE_LOW + percentile(AUTO_RANGE_FLOOR), ceiling - AUTO_RANGE_MIN_SPAN);
+
+    // a dB of slack keeps levels on a bin edge from rebaking the colors every tick
+    if((std::abs(floor - m_range_floor) > 1) || (std::abs(ceiling - m_range_ceiling) > 1))
+    {
+        m_range_floor = floor;
+        m_range_ceiling = ceiling;
+        bake_color_lut();
+    }
+}
+
+void WAVSource::export_shared_frame()
+{
+    SharedMemoryExport::Frame frame;
+    frame.audio_ts = m_display_audio_ts;
+    frame.channels = m_stereo ? 2 : 1;
+    std::copy(std::begin(m_frames.front().meter), std::end(m_frames.front().meter), frame.meter);
+    if(!m_meter_mode && !time_domain() && (m_iir_fraction == 0) && (m_last_bin > m_first_bin))
+    {
+        for(auto channel = 0u; channel < frame.channels; ++channel)
+        {
+            frame.bins[channel] = (m_display_db[channel] != nullptr) ? &m_display_db[channel][m_first_bin] : nullptr;
+            if(m_power_bands && (frame.bins[channel] != nullptr))
+            {
+                power_to_db(frame.bins[channel], m_last_bin - m_first_bin, m_shm_bins[channel]);
+                frame.bins[channel] = m_shm_bins[channel].data();
+            }
+        }
+        frame.bin_count = m_last_bin - m_first_bin;
+        frame.first_bin = m_first_bin;
+        frame.bin_hz = (float)m_audio_info.samples_per_sec / (float)m_fft_size;
+    }
+    if(!m_meter_mode && ((m_display_mode == DisplayMode::BAR) || (m_display_mode == DisplayMode::STEPPED_BAR))
+        && (m_export_bands[frame.channels - 1].size() == (size_t)m_num_bars) && (m_export_bands[0].size() == (size_t)m_num_bars)
+        && (m_interp->band_hz.size() == (size_t)m_num_bars))
+    {
+        for(auto channel = 0u; channel < frame.channels; ++channel)
+            frame.bands[channel] = m_export_bands[channel].data();
+        frame.band_hz = m_interp->band_hz.data();
+        frame.band_count = (size_t)m_num_bars;
+    }
+    m_shm_export.publish(frame);
+}
+
+void WAVSource::analyze(float seconds, uint64_t ts, uint64_t frame_ts)
+{
+    const TimedLock lock(m_analysis_mtx, m_analysis_wait, m_health.contended, m_plots.analysis_wait);
+    const DenormalGuard denormals;
+
+    m_tick_ts = ts;
+    m_frame_ts = frame_ts;
+    m_sync_ts = (frame_ts != 0) ? frame_ts : ts; // no frame time before the first video frame
+    const CostTimer timer(m_analysis_cost, os_gettime_ns(), m_plots.analysis);
+
+    // headless sources, views and whatever reads the exports keep a hidden source going
+    m_show = m_visible || m_headless || (m_export_demand_ts.load(std::memory_order_relaxed) + EXPORT_DEMAND_TIMEOUT > ts);
+    if(m_view)
+    {
+        if(m_show)
+        {
+            const CostTimer kernel(m_kernel_cost, os_gettime_ns());
+            tick_view(seconds);
+        }
+        publish_frame();
+        return;
+    }
+    ProfileScope capture_scope("waveform capture pop");
+    latch_capture();
+    trim_capture_bufs();
+    capture_scope.end();
+    if(m_capture.channels() > 0)
+        profile_plot(m_plots.capture_fill, (double)m_capture.size(0));
+
+    // the last silent frame is still on display, the buffers stay as they are until audio returns
+    if(m_dormant)
+    {
+        if(capture_silent())
+        {
+            // a removed source only shows as silence, the check costs nothing until a source signal fires
+            if(park_audio_capture(seconds))
+                check_audio_capture(seconds);
+            return;
+        }
+        m_dormant = false;
+    }
+
+    if(m_normalize_volume)
+        update_input_rms();
+
+    if(!park_audio_capture(seconds))
+        return;
+    if(!check_audio_capture(seconds))
+        return;
+    if(m_capture_channels == 0)
+        return;
+
+    if(m_meter_mode)
+    {
+        const CostTimer kernel(m_kernel_cost, os_gettime_ns());
+        tick_meter(seconds);
+    }
+    else if(m_display_mode == DisplayMode::WAVEFORM)
+    {
+        const CostTimer kernel(m_kernel_cost, os_gettime_ns());
+        tick_waveform(seconds);
+    }
+    else if(m_display_mode == DisplayMode::SCOPE)
+    {
+        const CostTimer kernel(m_kernel_cost, os_gettime_ns());
+        tick_scope(seconds);
+    }
+    else if(m_display_mode == DisplayMode::VECTORSCOPE)
+    {
+        const CostTimer kernel(m_kernel_cost, os_gettime_ns());
+        tick_vectorscope(seconds);
+    }
+    else if(m_iir_fraction > 0)
+    {
+        const CostTimer kernel(m_kernel_cost, os_gettime_ns());
+        tick_iir_bands(seconds);
+    }
+    else
+    {
+        // reuse the spectrum of an identically configured source that already ticked this frame
+        const auto key = get_spectrum_key();
+        float *decibels[2] = { m_decibels[0].get(), m_decibels[1].get() };
+        float *tsmooth[2] = { m_tsmooth_buf[0].get(), m_tsmooth_buf[1].get() };
+        // a copied spectrum never went through the bins pass, beat detection runs its own on the shared transform
+        const auto shared = m_show && (key.stream != nullptr) && !m_beat_detection && !m_gpu_fft;
+        if(!shared || !SpectrumCache::fetch(key, frame_ts, decibels, tsmooth, m_last_silent))
+        {
+            if((m_tables == nullptr) && (m_analysis != nullptr) && m_analysis->ready.load(std::memory_order_acquire))
+                m_tables = m_analysis.get();
+            if(m_tables == nullptr)
+                return; // window and gains still being built, keep the last spectrum
+            update_fft_plan();
+            if(!m_fft.ready())
+                return; // planner busy, keep the last spectrum
+            {
+                const CostTimer kernel(m_kernel_cost, os_gettime_ns());
+                tick_spectrum(seconds);
+            }
+            if(shared)
+                SpectrumCache::publish(this, key, frame_ts, decibels, tsmooth, m_last_silent);
+        }
+    }
+
+    profile_plot(m_plots.silent, m_last_silent ? 1.0 : 0.0);
+    m_dormant = m_last_silent && can_be_dormant() && capture_silent();
+    publish_frame();
+}
+
+bool WAVSource::capture_silent() const
+{
+    for(auto channel = 0u; channel < m_capture.channels(); ++channel)
+        if(!m_capture.silent(channel))
+            return false;
+    return true;
+}
+
+bool WAVSource::can_be_dormant() const
+{
+    // the waveform and spectrogram scroll on, peaks, display smoothing and beats decay on fresh frames
+    // exports expect a fresh frame every tick, the vectorscope fades out on them too
+    if(m_view || m_headless || m_spectrum_export.active() || (m_display_mode == DisplayMode::WAVEFORM) || (m_display_mode == DisplayMode::SPECTROGRAM)
+        || (m_display_mode == DisplayMode::VECTORSCOPE))
+        return false;
+    return !m_peak_hold && (m_display_tsmoothing == TSmoothingMode::NONE) && !m_beat_detection && (m_afterglow <= 0.0f);
+}
+
+void WAVSource::publish_frame()
+{
+    auto& frame = m_frames.back();
+    frame.silent = m_last_silent;
+
+    // newest sample of this analysis, the audio held back for sync isn't part of it yet
+    // its arrival is estimated from the newest block's, blocks arrive as fast as they play
+    const auto held = m_view ? 0 : (uint64_t)std::max(get_audio_sync(m_sync_ts), (int64_t)0); // a parent's timestamps are already synced
+    frame.audio_ts = (m_audio_ts > held) ? m_audio_ts - held : 0;
+    frame.arrival_ts = (m_capture_ts > held) ? m_capture_ts - held : 0;
+    std::copy(std::begin(m_meter_val), std::end(m_meter_val), frame.meter);
+    frame.beats = m_onset.beats();
+    frame.beat_period = m_onset.period();
+
+    // only the bins the display reads, the rest keep what reset_frames() filled in
+    const auto spectrum = !m_meter_mode && !time_domain();
+    if(m_display_mode == DisplayMode::VECTORSCOPE)
+    {
+        // only the pairs of this tick, the display draws each of them once
+        frame.points = std::min(m_scope_points, m_fft_size);
+        for(auto channel = 0u; channel < 2u; ++channel)
+            if(frame.values[channel])
+                std::copy_n(m_decibels[channel].get(), frame.points, frame.values[channel].get());
+        m_frames.publish();
+        return;
+    }
+    if(!spectrum && !m_meter_mode)
+    {
+        // waveform, the slot is behind by the columns written since it was last filled
+        // the scope keeps its head at 0 and writes a whole window each tick
+        const auto count = m_gpu_waveform ? 0 : (size_t)std::min<uint64_t>(m_waveform_written - frame.written, m_fft_size);
+        const auto start = (m_waveform_head + m_fft_size - count) % std::max(m_fft_size, (size_t)1);
+        for(auto channel = 0u; channel < 2u; ++channel)
+        {
+            if(!frame.values[channel])
+                continue;
+            for(size_t i = 0, pos = start; i < count; ++i, pos = (pos + 1 < m_fft_size) ? pos + 1 : 0)
+                frame.values[channel][pos] = m_decibels[channel][pos];
+        }
+        frame.head = m_waveform_head;
+        frame.written = m_waveform_written;
+        if(m_gpu_waveform)
+        {
+            // same for the sample rings, behind by the samples consumed since the slot was last filled
+            const auto size = m_waveform_raw[0].size();
+            const auto raw = (size_t)std::min<uint64_t>(m_waveform_raw_written - frame.raw_written, size);
+            const auto raw_start = (m_waveform_raw_head + size - raw) % std::max(size, (size_t)1);
+            for(auto channel = 0u; channel < 2u; ++channel)
+            {
+                if(!frame.samples[channel] || !m_waveform_raw[channel])
+                    continue;
+                for(size_t i = 0, pos = raw_start; i < raw; ++i, pos = (pos + 1 < size) ? pos + 1 : 0)
+                    frame.samples[channel][pos] = m_waveform_raw[channel][pos];
+            }
+            frame.raw_head = m_waveform_raw_head;
+            frame.raw_written = m_waveform_raw_written;
+            frame.raw_end = m_waveform_raw_end;
+        }
+        m_frames.publish();
+        return;
+    }
+    const auto first = spectrum ? m_first_bin : 0;
+    const auto last = spectrum ? m_last_bin : m_fft_size; // meter frames hold no values
+    for(auto channel = 0u; channel < 2u; ++channel)
+        if(frame.values[channel])
+            std::copy(&m_decibels[channel][first], &m_decibels[channel][last], &frame.values[channel][first]);
+    for(auto channel = 0u; channel < 2u; ++channel)
+    {
+        // the input only means something while there is audio, silence draws flat
+        if(!frame.samples[channel])
+            continue;
+        if(m_last_silent)
+            std::fill(frame.samples[channel].get(), frame.samples[channel].get() + m_fft_size, 0.0f);
+        else
+            std::copy(&m_fft_input[channel * m_fft_size], &m_fft_input[(channel + 1) * m_fft_size], frame.samples[channel].get());
+    }
+    m_frames.publish();
+
+    // filterbank bands aren't bins, the band export has them
+    if(spectrum && (m_iir_fraction == 0) && m_spectrum_export.active() && (last > first))
+    {
+        const auto count = last - first;
+        const auto bin_hz = (float)m_audio_info.samples_per_sec / (float)m_fft_size;
+        m_export_freqs.resize(count);
+        for(size_t i = 0; i < count; ++i)
+            m_export_freqs[i] = (float)(first + i) * bin_hz;
+        const float *values[] = { &m_decibels[0][first], m_stereo ? &m_decibels[1][first] : nullptr };
+        for(auto channel = 0u; m_power_bands && (channel < 2u); ++channel)
+        {
+            if(values[channel] == nullptr)
+                continue;
+            power_to_db(values[channel], count, m_export_db[channel]);
+            values[channel] = m_export_db[channel].data();
+        }
+        m_spectrum_export.publish(m_stereo ? 2 : 1, count, values, m_export_freqs.data(), frame.audio_ts);
+    }
+}
+
+void WAVSource::reset_frames()
+{
+    const auto display_channels = m_stereo ? 2u : 1u;
+    for(auto i = 0u; i < m_frames.size(); ++i)
+    {
+        auto& frame = m_frames[i];
+        frame.silent = m_last_silent;
+        std::copy(std::begin(m_meter_val), std::end(m_meter_val), frame.meter);
+        frame.beats = m_onset.beats();
+        frame.beat_period = m_onset.period();
+        frame.head = m_waveform_head;
+        frame.written = m_waveform_written;
+        frame.raw_head = m_waveform_raw_head;
+        frame.raw_written = m_waveform_raw_written;
+        frame.raw_end = m_waveform_raw_end;
+        frame.points = 0;
+        for(auto channel = 0u; channel < 2u; ++channel)
+        {
+            if(m_meter_mode || (channel >= display_channels) || !m_decibels[channel])
+            {
+                frame.values[channel].reset();
+                continue;
+            }
+            const auto count = m_decibels[channel].size();
+            frame.values[channel].reset(count);
+            std::copy(m_decibels[channel].get(), m_decibels[channel].get() + count, frame.values[channel].get());
+        }
+        for(auto channel = 0u; channel < 2u; ++channel)
+        {
+            if(m_gpu_waveform && m_waveform_raw[channel])
+            {
+                const auto count = m_waveform_raw[channel].size();
+                frame.samples[channel].reset(count);
+                std::copy(m_waveform_raw[channel].get(), m_waveform_raw[channel].get() + count, frame.samples[channel].get());
+                continue;
+            }
+            if(!m_gpu_fft || (channel >= m_fft_channels))
+            {
+                frame.samples[channel].reset();
+                continue;
+            }
+            frame.samples[channel].reset(m_fft_size);
+            std::fill(frame.samples[channel].get(), frame.samples[channel].get() + m_fft_size, 0.0f);
+        }
+    }
+    m_frames.reset();
+    m_display_db[0] = m_frames.front().values[0].get();
+    m_display_db[1] = m_frames.front().values[1].get();
+    m_display_samples[0] = m_frames.front().samples[0].get();
+    m_display_samples[1] = m_frames.front().samples[1].get();
+    m_display_raw_head = m_frames.front().raw_head;
+    m_display_raw_end = m_frames.front().raw_end;
+    m_display_points = 0;
+
+    for(auto channel = 0u; channel < 2u; ++channel)
+    {
+        if((m_display_mode == DisplayMode::WAVEFORM) && m_frames.front().values[channel])
+            m_waveform_display[channel].reset(m_frames.front().values[channel].size());
+        else
+            m_waveform_display[channel].reset();
+    }
+    unroll_waveform();
+
+    // blending starts out settled on the current values
+    for(auto channel = 0u; channel < 2u; ++channel)
+    {
+        const auto& values = m_frames.front().values[channel];
+        // going out of program may start blending at any time
+        if(!(tween_frames() || (m_preview_interval > 1)) || !values)
+        {
+            m_tween_from[channel].reset();
+            m_tween[channel].reset();
+            continue;
+        }
+        const auto count = values.size();
+        m_tween_from[channel].reset(count);
+        m_tween[channel].reset(count);
+        std::copy(values.get(), values.get() + count, m_tween_from[channel].get());
+        std::copy(values.get(), values.get() + count, m_tween[channel].get());
+    }
+    m_tween_elapsed = m_tween_period = 0.0f;
+    m_display_silent = m_last_silent;
+    m_analysis_seconds = 0.0f;
+    m_display_seconds = 0.0f;
+    m_join_pending = false;
+}
+
+void WAVSource::append_raw(uint32_t channel, size_t count)
+{
+    auto& ring = m_waveform_raw[channel];
+    const auto size = ring.size();
+    if(size == 0)
+        return;
+    // more than a ring only keeps the newest samples
+    const auto src = m_waveform_buf.data() + ((count > size) ? count - size : 0);
+    const auto n = std::min(count, size);
+    const auto pos = (m_waveform_raw_head + count - n) % size;
+    const auto first = std::min(n, size - pos);
+    std::copy(src, src + first, ring.get() + pos);
+    std::copy(src + first, src + n, ring.get());
+
+    // silence is the ring's trailing zeros covering all of it, no scan of the whole window
+    auto last = n;
+    while((last > 0) && (src[last - 1] == 0.0f))
+        --last;
+    m_waveform_quiet[channel] = (last > 0) ? n - last : std::min(m_waveform_quiet[channel] + n, size);
+}
+
+void WAVSource::unroll_waveform()
+{
+    // the display reads columns oldest first, the ring wraps at the front frame's head
+    const auto& frame = m_frames.front();
+    if((m_display_mode != DisplayMode::WAVEFORM) || (frame.head == 0))
+        return;
+    const auto head = std::min(frame.head, m_fft_size);
+    for(auto channel = 0u; channel < 2u; ++channel)
+    {
+        if(!frame.values[channel] || !m_waveform_display[channel])
+            continue;
+        const auto src = frame.values[channel].get();
+        const auto dst = m_waveform_display[channel].get();
+        std::copy(src + head, src + m_fft_size, dst);
+        std::copy(src, src + head, dst + (m_fft_size - head));
+        m_display_db[channel] = dst;
+    }
+}
+
+void WAVSource::prepare_display(float seconds)
+{
+    const ProfileScope scope("waveform interpolation");
+    ++m_display_gen;
+    if(m_gpu_fft || m_gpu_waveform)
+    {
+        // the heights come out of m_gpu_analysis or m_gpu_envelope, the gradient spans the whole channel
+        m_render_miny = 0.0f;
+        m_render_minpos = 0;
+        return;
+    }
+    if(m_afterglow > 0.0f)
+        m_glow_fade *= std::exp(-seconds / m_afterglow);
+    if(m_display_mode == DisplayMode::VECTORSCOPE)
+    {
+        // the points go up as they are, the trace fades by the time since the last draw into it
+        m_scope_fade *= std::exp(-seconds / m_scope_decay);
+        return;
+    }
+    if(curve_display() || (m_display_mode == DisplayMode::SPECTROGRAM))
+        prepare_curve(seconds);
+    else
+        prepare_bars(seconds);
+}
+
+// exponential smoothing of display points in dB, in the same linear domain the bin stage would use
+// with no time passed the history is shown as is
+void WAVSource::smooth_display(float seconds, float *values, float *history, size_t count)
+{
+    const auto power = m_display_tsmoothing == TSmoothingMode::POWER;
+    const auto dbscale = power ? 0.5f : 1.0f;
+    const auto tolinear = std::numbers::ln10_v<float> / (20.0f * dbscale);
+    if(seconds > 0.0f)
+    {
+        const auto g = get_gravity(seconds, m_display_tsmoothing);
+        const auto g2 = 1.0f - g;
+        for(size_t i = 0; i < count; ++i)
+        {
+            const auto mag = std::exp(values[i] * tolinear);
+            auto oldval = history[i];
+            if(m_fast_peaks)
+                oldval = std::max(mag, oldval);
+            history[i] = (g * oldval) + (g2 * mag);
+        }
+    }
+    for(size_t i = 0; i < count; ++i)
+        values[i] = dbfs(history[i]) * dbscale;
+}
+
+void WAVSource::render([[maybe_unused]] gs_effect_t *effect)
+{
+    const TimedLock lock(m_mtx, m_lock_wait, m_health.contended, m_plots.lock_wait);
+    if(m_headless || !m_built.load(std::memory_order_relaxed))
+        return;
+    const CostTimer timer(m_render_cost, os_gettime_ns(), m_plots.render);
+    if(std::exchange(m_join_pending, false))
+    {
+        // analyze() only takes m_analysis_mtx, so waiting under m_mtx can't deadlock
+        AnalysisWorker::wait(this);
+        display_frame(0.0f);
+    }
+    if(m_log_latency && std::exchange(m_latency_pending, false) && (m_display_arrival_ts != 0) && (m_latency_samples[0].size() < MAX_LATENCY_SAMPLES))
+    {
+        // the first render of each new analysis
+        m_latency_samples[0].push_back((float)(int64_t)(os_gettime_ns() - m_display_arrival_ts) / 1e6f);
+        m_latency_samples[1].push_back((float)((int64_t)obs_get_video_frame_time() - (int64_t)m_display_audio_ts) / 1e6f);
+    }
+    if(m_display_silent && m_hide_on_silent)
+        return;
+
+    // the afterglow and the idle cache are drawn once and shown at every size, they keep full detail
+    m_render_scale = 1.0f;
+    if(m_glow_target != nullptr)
+    {
+        render_afterglow(effect);
+        return;
+    }
+    if(!m_idle || (m_cache == nullptr))
+    {
+        m_render_scale = view_scale();
+        render_graph(effect);
+        return;
+    }
+
+    // idle, draw once into the cache and blit it from then on
+    const auto width = graph_width();
+    const auto height = graph_height();
+    if((width == 0) || (height == 0))
+        return;
+    if(m_cache_gen != m_display_gen)
+    {
+        gs_texrender_reset(m_cache);
+        if(!gs_texrender_begin(m_cache, width, height))
+        {
+            render_graph(effect);
+            return;
+        }
+        vec4 clear;
+        vec4_zero(&clear);
+        gs_clear(GS_CLEAR_COLOR, &clear, 0.0f, 0);
+        gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+        gs_blend_state_push();
+        gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+        render_graph(effect);
+        gs_blend_state_pop();
+        gs_texrender_end(m_cache);
+        m_cache_gen = m_display_gen;
+    }
+
+    auto tex = gs_texrender_get_texture(m_cache);
+    auto default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+    auto image = gs_effect_get_param_by_name(default_effect, "image");
+    gs_blend_state_push();
+    gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+    gs_effect_set_texture(image, tex);
+    while(gs_effect_loop(default_effect, "Draw"))
+        gs_draw_sprite(tex, 0, width, height);
+    gs_blend_state_pop();
+}
+
+// OBS draws a canvas at its base size with the scene item transform on the matrix stack
+// multiview and projectors draw it into a smaller or larger viewport instead
+float WAVSource::view_scale() const
+{
+    obs_video_info ovi{};
+    if(!obs_get_video_info(&ovi) || (ovi.base_width == 0) || (ovi.base_height == 0))
+        return 1.0f;
+    matrix4 transform;
+    gs_matrix_get(&transform);
+    gs_rect viewport;
+    gs_get_viewport(&viewport);
+    const auto sx = std::hypot(transform.x.x, transform.x.y) * (float)viewport.cx / (float)ovi.base_width;
+    const auto sy = std::hypot(transform.y.x, transform.y.y) * (float)viewport.cy / (float)ovi.base_height;
+    return std::min(sx, sy);
+}
+
+unsigned int WAVSource::render_lod() const
+{
+    if(curve_display())
+        return std::clamp((unsigned int)(1.0f / std::max(m_render_scale, 1.0f / MAX_CURVE_LOD)), 1u, MAX_CURVE_LOD);
+    const auto stepped = (m_display_mode == DisplayMode::STEPPED_BAR) || (m_display_mode == DisplayMode::STEPPED_METER);
+    const auto detail = stepped ? (float)std::min(m_bar_width, m_step_width) : (m_rounded_caps ? m_cap_radius * 2.0f : 0.0f);
+    return ((detail > 0.0f) && ((detail * m_render_scale) < LOD_DETAIL_PIXELS)) ? 1u : 0u;
+}
+
+void WAVSource::render_graph(gs_effect_t *effect)
+{
+    const ProfileScope scope("waveform draw");
+    if(m_display_mode == DisplayMode::SPECTROGRAM)
+        render_spectrogram(effect);
+    else if(m_display_mode == DisplayMode::VECTORSCOPE)
+        render_vectorscope(effect);
+    else if(m_gpu_geometry)
+        render_geometry(effect);
+    else if(curve_display())
+        render_curve(effect);
+    else
+        render_bars(effect);
+}
+
+// display points in pixel space, done once per tick instead of once per view
+void WAVSource::prepare_curve(float seconds)
+{
+    const auto center = (float)m_height / 2;
+    const auto bottom = (float)m_height;
+    const auto dbrange = m_range_ceiling - m_range_floor;
+    const auto cpos = m_stereo ? center : bottom;
+    const auto channel_offset = m_channel_spacing * 0.5f;
+
+    // interpolation
+    auto miny = cpos;
+    auto minpos = 0u;
+    for(auto channel = 0u; channel < (m_stereo ? 2u : 1u); ++channel)
+    {
+        // a mirrored axis only interpolates and filters its unique half
+        const auto points = std::min(m_interp->indices.size(), (size_t)m_interp_size);
+        if(m_interp_mode != InterpMode::POINT)
+        {
+            const auto sz = time_domain() ? m_fft_size : m_fft_size / 2u;
+            DSPKernels::get().interp(m_display_db[channel], sz, m_interp->indices, m_interp->kernel, interp_span(m_interp_bufs[channel]));
+        }
+        else
+            for(size_t i = 0; i < points; ++i)
+                m_interp_bufs[channel][i] = m_display_db[channel][(int)m_interp->indices[i]];
+
+        if(m_filter_mode != FilterMode::NONE)
+        {
+            const auto in = m_interp_bufs[channel].get();
+            const auto out = interp_span(m_interp_bufs[2]);
+            if(m_filter_mode == FilterMode::RECURSIVE_GAUSS)
+                apply_recursive_gauss(in, points, m_recursive_gauss, out);
+            else
+                DSPKernels::get().filter(in, points, m_kernel, out);
+            std::swap(m_interp_bufs[channel], m_interp_bufs[2]);
+        }
+        if(m_mirror_freq_axis)
+            mirror_points(m_interp_bufs[channel].get(), m_interp_size);
+
+        if(m_display_tsmoothing != TSmoothingMode::NONE)
+            smooth_display(seconds, m_interp_bufs[channel].get(), m_display_history[channel].get(), m_interp_size);
+
+        if(m_display_mode == DisplayMode::SPECTROGRAM)
+        {
+            // intensity from the floor up to the ceiling, the shader colors it
+            for(auto i = 0u; i < m_interp_size; ++i)
+                m_interp_bufs[channel][i] = std::clamp(m_interp_bufs[channel][i] - m_range_floor, 0.0f, (float)dbrange) / dbrange;
+        }
+        else if(m_display_mode == DisplayMode::SCOPE)
+        {
+            // samples around the middle of the channel, positive up
+            // render_curve() mirrors the second channel, its samples go the other way so they come out upright
+            const auto half = (cpos - channel_offset) * 0.5f;
+            const auto sign = (channel == 0) ? -half : half;
+            for(auto i = 0u; i < m_interp_size; ++i)
+            {
+                auto val = std::clamp(half + (sign * m_interp_bufs[channel][i]), 0.0f, half * 2.0f);
+                if(val < miny)
+                {
+                    miny = val;
+                    minpos = i;
+                }
+                m_interp_bufs[channel][i] = val;
+            }
+        }
+        else
+        {
+            float low;
+            const auto pos = DSPKernels::get().heights(m_interp_bufs[channel].get(), m_interp_size, (float)m_range_ceiling, (float)dbrange, 0.0f, cpos - channel_offset, low);
+            if(low < miny)
+            {
+                miny = low;
+                minpos = (unsigned int)pos;
+            }
+        }
+    }
+
+    m_render_miny = miny;
+    m_render_minpos = m_spline ? (unsigned int)std::lround((float)minpos / spline_scale()) : minpos; // pixels for the pulse and gradient
+}
+
+void WAVSource::render_curve([[maybe_unused]] gs_effect_t *effect)
+{
+    //std::lock_guard lock(m_mtx); // now locked in render()
+    //if(m_last_silent)
+    //    return;
+
+    auto tech = get_shader_tech();
+    
+    const auto center = (float)m_height / 2;
+    //const auto right = (float)m_width;
+    const auto bottom = (float)m_height;
+    const auto cpos = m_stereo ? center : bottom;
+    const auto channel_offset = m_channel_spacing * 0.5f;
+
+    set_shader_vars(cpos, m_render_miny, (float)m_render_minpos, channel_offset, 0.0f, cpos - channel_offset);
+
+    gs_technique_begin(tech);
+    gs_technique_begin_pass(tech, 0);
+    gs_load_indexbuffer(nullptr);
+
+    // vertices only change when tick prepared new data, other views of the same frame and size reuse them
+    // a small view takes every lod-th column and always the last one, x is written along with the value
+    const auto channels = m_stereo ? 2u : 1u;
+    const auto stride = (m_render_mode == RenderMode::LINE) ? 1u : 2u; // fill base y set in create_vbuf()
+    const auto lod = render_lod();
+    const auto columns = (m_width > 0) ? ((m_width + lod - 2) / lod) + 1 : 0u;
+    if((m_vbuf_gen != m_display_gen) || (m_vbuf_lod != lod))
+    {
+        const ProfileScope scope("waveform vertex fill");
+        m_ring_pos = (m_ring_pos + 1) % RENDER_RING;
+        const auto vbuf = m_vbuf[m_ring_pos];
+        auto vbdata = gs_vertexbuffer_get_data(vbuf);
+        for(auto channel = 0u; channel < channels; ++channel)
+        {
+            const auto points = &vbdata->points[channel * m_vbuf_stride];
+            for(auto i = 0u; i < columns; ++i)
+            {
+                const auto column = std::min(i * lod, m_width - 1);
+                auto val = m_interp_bufs[channel][column];
+                points[i * stride].x = (float)column;
+                points[i * stride].y = (channel == 0) ? val : bottom - val;
+                if(stride > 1)
+                    points[(i * stride) + 1].x = (float)column;
+            }
+        }
+
+        // one upload for both channels
+        gs_vertexbuffer_flush(vbuf);
+        m_vbuf_gen = m_display_gen;
+        m_vbuf_lod = lod;
+    }
+
+    // strips can't be joined, one draw per channel range
+    gs_load_vertexbuffer(m_vbuf[m_ring_pos]);
+    for(auto channel = 0u; channel < channels; ++channel)
+        gs_draw((m_render_mode != RenderMode::LINE) ? GS_TRISTRIP : GS_LINESTRIP, channel * m_vbuf_stride, columns * stride);
+
+    gs_load_vertexbuffer(nullptr);
+    gs_technique_end_pass(tech);
+    gs_technique_end(tech);
+}
+
+// bins to bar values, interpolated and filtered
+void WAVSource::interp_bars(const float *bins, AlignedBuffer<float>& buf)
+{
+    const auto out = interp_span(buf);
+    const auto& kernels = DSPKernels::get();
+    const auto bands = std::min(m_interp->band_widths.size(), out.size()); // the unique half of a mirrored axis
+    if(!m_interp->filterbank.empty())
+        kernels.filterbank(bins, m_interp->filterbank, out);
+    else if(m_interp_mode != InterpMode::POINT)
+    {
+        // the running sum wins once bands are about as wide as the kernel (prefix_width of them, tuned per host)
+        // below that the SIMD convolutions are faster
+        const auto wide = (float)m_interp->indices.size() >= (kernels.prefix_width * (float)m_interp->kernel.size * (float)bands);
+        if(wide || (kernels.bands == nullptr))
+            apply_interp_filter_prefix(bins, m_fft_size / 2, m_interp->band_widths, m_interp->indices, m_interp->kernel, m_band_prefix, out);
+        else
+            kernels.bands(bins, m_fft_size / 2, m_interp->band_widths, m_interp->indices, m_interp->kernel, out);
+    }
+    else
+    {
+        for(size_t i = 0; i < bands; ++i)
+        {
+            float sum = 0.0f;
+            auto count = (size_t)m_interp->band_widths[i];
+            for(size_t j = 0; j < count; ++j)
+                sum += bins[(size_t)m_interp->indices[i] + j];
+            out[i] = sum / (float)count;
+        }
+    }
+
+    // one log per bar, the lanczos overshoot below zero is silence
+    if(m_power_bands)
+        for(size_t i = 0; i < bands; ++i)
+            out[i] = power_db(out[i]);
+
+    if(m_filter_mode != FilterMode::NONE)
+    {
+        const auto filtered = interp_span(m_interp_bufs[2]);
+        const auto count = m_mirror_freq_axis ? bands : out.size();
+        if(m_filter_mode == FilterMode::RECURSIVE_GAUSS)
+            apply_recursive_gauss(out.data(), count, m_recursive_gauss, filtered);
+        else
+            kernels.filter(out.data(), count, m_kernel, filtered);
+        std::swap(buf, m_interp_bufs[2]);
+    }
+    if(m_mirror_freq_axis)
+        mirror_points(buf.get(), (size_t)m_num_bars);
+}
+
+// bar heights in pixel space, done once per tick instead of once per view
+void WAVSource::prepare_bars(float seconds)
+{
+    const auto center = (float)m_height / 2;
+    const auto bottom = (float)m_height;
+    const auto dbrange = m_range_ceiling - m_range_floor;
+    const auto cpos = m_stereo ? center : bottom;
+    float border_top, border_bottom;
+    get_bar_borders(border_top, border_bottom);
+
+    // interpolation
+    auto miny = cpos;
     auto minpos = 0u;
+    const auto export_bands = !m_meter_mode && (m_bands_export.active() || m_shm_export.is_open() || m_recorder.is_open() || m_envelope)
+        && (m_num_bars > 0);
     for(auto channel = 0u; channel < (m_stereo ? 2u : 1u); ++channel)
     {
-        if(m_interp_mode != InterpMode::POINT)
+        if(m_meter_mode)
+        {
+            for(auto i = 0u; i < m_capture_channels; ++i)
+                m_interp_bufs[0][i] = m_frames.front().meter[i];
+        }
+        else
+        {
+            interp_bars(m_display_db[channel], m_interp_bufs[channel]);
+            if(m_display_tsmoothing != TSmoothingMode::NONE)
+                smooth_display(seconds, m_interp_bufs[channel].get(), m_display_history[channel].get(), (size_t)m_num_bars);
+            if(export_bands)
+                m_export_bands[channel].assign(m_interp_bufs[channel].get(), m_interp_bufs[channel].get() + m_num_bars);
+            if(m_headless)
+                continue;
+            if(m_peak_hold)
+                interp_bars(m_peak_db[channel].get(), m_peak_bars[channel]);
+        }
+
+        const auto& kernels = DSPKernels::get();
+        float low;
+        const auto pos = kernels.heights(m_interp_bufs[channel].get(), (size_t)m_num_bars, (float)m_range_ceiling, (float)dbrange, border_top, border_bottom, low);
+        if(low < miny)
+        {
+            miny = low;
+            minpos = (unsigned int)pos;
+        }
+
+        // peaks map the same way but don't move the gradient
+        if(m_peak_hold)
+            kernels.heights(m_peak_bars[channel].get(), (size_t)m_num_bars, (float)m_range_ceiling, (float)dbrange, border_top, border_bottom, low);
+    }
+
+    m_render_miny = miny;
+    m_render_minpos = minpos;
+
+    if(export_bands)
+    {
+        const float *values[] = { m_export_bands[0].data(), m_stereo ? m_export_bands[1].data() : nullptr };
+        if(m_bands_export.active())
+            m_bands_export.publish(m_stereo ? 2 : 1, (size_t)m_num_bars, values, m_interp->band_hz.data(), m_display_audio_ts);
+    }
+}
+
+// top and bottom of the range bars are drawn in, caps and spacing excluded
+void WAVSource::get_bar_borders(float& border_top, float& border_bottom) const
+{
+    const auto cpos = m_stereo ? (float)m_height / 2 : (float)m_height;
+    const auto channel_offset = m_channel_spacing * 0.5f;
+    border_top = (m_rounded_caps) ? m_cap_radius : 0.0f;
+    border_bottom = (m_rounded_caps && (!m_stereo || (m_channel_spacing > 0))) ? cpos - m_cap_radius : cpos;
+    if(m_channel_spacing > 0)
+        border_bottom -= channel_offset;
+    if(m_min_bar_height > 0)
+        border_bottom -= m_min_bar_height;
+    border_bottom = std::clamp(border_bottom, border_top, cpos);
+}
+
+void WAVSource::render_bars([[maybe_unused]] gs_effect_t *effect)
+{
+    //std::lock_guard lock(m_mtx); // now locked in render()
+    //if(m_last_silent)
+    //    return;
+
+    auto tech = get_shader_tech();
+
+    const auto bar_stride = m_bar_width + m_bar_gap;
+    const auto step_stride = m_step_width + m_step_gap;
+    const auto center = (float)m_height / 2;
+    const auto bottom = (float)m_height;
+    const auto cpos = m_stereo ? center : bottom;
+    const auto channel_offset = m_channel_spacing * 0.5f;
+    float border_top, border_bottom;
+    get_bar_borders(border_top, border_bottom);
+
+    auto max_steps = (size_t)((cpos - channel_offset) / step_stride);
+    if(((int)cpos - (int)(max_steps * step_stride) - (int)channel_offset) > m_step_width)
+        ++max_steps;
+
+    set_shader_vars(cpos, m_render_miny, (float)m_render_minpos, channel_offset, border_top, border_bottom);
+
+    gs_technique_begin(tech);
+    gs_technique_begin_pass(tech, 0);
+    gs_load_indexbuffer(nullptr);
+
+    // only rebuilt when tick prepared new data or the view size changes the detail, channel 1 follows right after channel 0
+    // small views draw stepped bars solid and leave out the caps
+    const auto lod = render_lod();
+    const auto steps = ((m_display_mode == DisplayMode::STEPPED_BAR) || (m_display_mode == DisplayMode::STEPPED_METER)) && (lod == 0);
+    const auto caps = m_rounded_caps && (lod == 0);
+    if((m_vbuf_gen != m_display_gen) || (m_vbuf_lod != lod))
+    {
+        const ProfileScope scope("waveform vertex fill");
+        m_ring_pos = (m_ring_pos + 1) % RENDER_RING;
+        const auto vbuf = m_vbuf[m_ring_pos];
+        auto vbdata = gs_vertexbuffer_get_data(vbuf);
+        auto vertpos = 0u;
+        for(auto channel = 0u; channel < (m_stereo ? 2u : 1u); ++channel)
+        {
+            const auto first = vertpos;
+
+            for(auto i = 0; i < m_num_bars; ++i)
+            {
+                auto val = m_interp_bufs[channel][i];
+
+                if(steps)
+                {
+                    const auto x = (float)(i * bar_stride);
+                    const auto maxheight = (cpos - val - channel_offset);
+                    for(auto j = 0u; j < max_steps; ++j)
+                    {
+                        auto y = (float)(j * step_stride);
+                        if(y >= maxheight)
+                            break;
+                        if(channel)
+                            y = cpos + y + channel_offset;
+                        else
+                            y = cpos - y - channel_offset - m_step_width;
+
+                        vec3 vert;
+                        vec3_set(&vert, x, y, 0.0f);
+                        vec3_add(&vbdata->points[vertpos], &m_step_verts[0], &vert);
+                        vec3_add(&vbdata->points[vertpos + 1], &m_step_verts[1], &vert);
+                        vec3_add(&vbdata->points[vertpos + 2], &m_step_verts[2], &vert);
+                        vec3_add(&vbdata->points[vertpos + 3], &m_step_verts[3], &vert);
+                        vec3_add(&vbdata->points[vertpos + 4], &m_step_verts[4], &vert);
+                        vec3_add(&vbdata->points[vertpos + 5], &m_step_verts[5], &vert);
+                        vertpos += 6;
+                    }
+                }
+                else
+                {
+                    auto x1 = (float)(i * bar_stride);
+                    auto x2 = x1 + m_bar_width;
+                    auto offset = (caps ? m_cap_radius : 0.0f) + channel_offset;
+                    if(channel)
+                    {
+                        val = bottom - val;
+                        offset = -offset;
+                    }
+                    auto bot = ((caps && !m_stereo) || (m_channel_spacing > 0)) ? (cpos - offset) : cpos;
+                    vec3_set(&vbdata->points[vertpos], x1, val, 0);
+                    vec3_set(&vbdata->points[vertpos + 1], x2, val, 0);
+                    vec3_set(&vbdata->points[vertpos + 2], x1, bot, 0);
+                    vec3_set(&vbdata->points[vertpos + 3], x2, val, 0);
+                    vec3_set(&vbdata->points[vertpos + 4], x1, bot, 0);
+                    vec3_set(&vbdata->points[vertpos + 5], x2, bot, 0);
+                    vertpos += 6;
+
+                    if(caps)
+                    {
+                        auto ccx = (float)(i * bar_stride) + m_cap_radius; // cap center x
+                        auto half = m_cap_tris / 2; // m_cap_tris always even
+                        auto start = m_radial ? 0 : (channel ? 0 : half);
+                        auto stop = m_radial ? m_cap_tris : (start + half);
+                        vec3 cvert;
+                        vec3_set(&cvert, ccx, val, 0.0f);
+                        for(auto j = start; j < stop; ++j)
+                        {
+                            vec3_add(&vbdata->points[vertpos], &m_cap_verts[j], &cvert);
+                            vec3_add(&vbdata->points[vertpos + 1], &m_cap_verts[j + 1], &cvert);
+                            vec3_copy(&vbdata->points[vertpos + 2], &cvert);
+                            vertpos += 3;
+                        }
+                        if(!m_stereo || (m_channel_spacing > 0))
+                        {
+                            auto ccy = cpos - offset;
+                            start = m_radial ? 0 : (channel ? half : 0);
+                            stop = m_radial ? m_cap_tris : (start + half);
+                            vec3_set(&cvert, ccx, ccy, 0.0f);
+                            for(auto j = start; j < stop; ++j)
+                            {
+                                vec3_add(&vbdata->points[vertpos], &m_cap_verts[j], &cvert);
+                                vec3_add(&vbdata->points[vertpos + 1], &m_cap_verts[j + 1], &cvert);
+                                vec3_copy(&vbdata->points[vertpos + 2], &cvert);
+                                vertpos += 3;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // peak markers, one step or a thin line above each bar
+            if(m_peak_hold)
+            {
+                const auto stepped = m_display_mode == DisplayMode::STEPPED_BAR;
+                for(auto i = 0; i < m_num_bars; ++i)
+                {
+                    const auto peak = m_peak_bars[channel][i];
+                    const auto height = cpos - peak - channel_offset;
+                    if((peak >= border_bottom) || (stepped && ((height <= 0.0f) || (max_steps == 0))))
+                        continue;
+                    const auto x1 = (float)(i * bar_stride);
+                    const auto x2 = x1 + m_bar_width;
+                    float y1, y2;
+                    if(stepped)
+                    {
+                        const auto j = std::min((size_t)std::ceil(height / (float)step_stride) - 1, max_steps - 1); // topmost lit step
+                        const auto y = (float)(j * step_stride);
+                        y1 = channel ? (cpos + y + channel_offset) : (cpos - y - channel_offset - m_step_width);
+                        y2 = y1 + m_step_width;
+                    }
+                    else
+                    {
+                        y1 = channel ? (bottom - peak + border_top - PEAK_MARKER_HEIGHT) : (peak - border_top);
+                        y2 = y1 + PEAK_MARKER_HEIGHT;
+                    }
+                    vec3_set(&vbdata->points[vertpos], x1, y1, 0);
+                    vec3_set(&vbdata->points[vertpos + 1], x2, y1, 0);
+                    vec3_set(&vbdata->points[vertpos + 2], x1, y2, 0);
+                    vec3_set(&vbdata->points[vertpos + 3], x2, y1, 0);
+                    vec3_set(&vbdata->points[vertpos + 4], x1, y2, 0);
+                    vec3_set(&vbdata->points[vertpos + 5], x2, y2, 0);
+                    vertpos += 6;
+                }
+            }
+
+            m_vbuf_verts[channel] = vertpos - first;
+        }
+
+        // one upload for both channels
+        gs_vertexbuffer_flush(vbuf);
+        m_vbuf_gen = m_display_gen;
+        m_vbuf_lod = lod;
+    }
+
+    gs_load_vertexbuffer(m_vbuf[m_ring_pos]);
+    const auto total = m_vbuf_verts[0] + m_vbuf_verts[1];
+    if(total > 0)
+        gs_draw(GS_TRIS, 0, total);
+
+    gs_load_vertexbuffer(nullptr);
+    gs_technique_end_pass(tech);
+    gs_technique_end(tech);
+}
+
+// static meshes from fill_geometry(), the vertex shader reads each value from the channel's texture
+void WAVSource::render_geometry([[maybe_unused]] gs_effect_t *effect)
+{
+    const auto curve = curve_display();
+    const auto center = (float)m_height / 2;
+    const auto bottom = (float)m_height;
+    const auto cpos = m_stereo ? center : bottom;
+    const auto channel_offset = m_channel_spacing * 0.5f;
+
+    // the transform draws into its own targets, done before the geometry technique begins
+    gs_texture_t *gpu_values = nullptr;
+    if(m_gpu_fft)
+    {
+        if(!m_gpu_analysis.has_gains() && (m_analysis != nullptr) && m_analysis->ready.load(std::memory_order_acquire))
+            m_gpu_analysis.set_gains(m_analysis->bin_gains.get());
+        if(m_vbuf_gen != m_display_gen)
         {
-            const auto sz = (m_display_mode == DisplayMode::WAVEFORM) ? m_fft_size : m_fft_size / 2u;
-#ifdef ENABLE_X86_SIMD
-            if(HAVE_AVX)
-                apply_interp_filter_fma3(m_decibels[channel].get(), sz, m_interp_indices, m_interp_kernel, m_interp_bufs[channel]);
-            else
-                apply_interp_filter(m_decibels[channel].get(), sz, m_interp_indices, m_interp_kernel, m_interp_bufs[channel]);
-#else
-            apply_interp_filter(m_decibels[channel].get(), sz, m_interp_indices, m_interp_kernel, m_interp_bufs[channel]);
-#endif
+            const ProfileScope scope("waveform gpu fft");
+            GpuFFT::Params params;
+            params.input[0] = m_display_samples[0];
+            params.input[1] = m_display_samples[1];
+            params.mix = !m_stereo;
+            params.linear = (m_interp_mode != InterpMode::POINT);
+            params.floor = (float)m_range_floor;
+            params.ceiling = (float)m_range_ceiling;
+            params.scale = cpos - channel_offset;
+            gpu_values = m_gpu_analysis.run(params);
+            m_vbuf_gen = m_display_gen;
         }
         else
-            for(auto i = 0u; i < m_width; ++i)
-                m_interp_bufs[channel][i] = m_decibels[channel][(int)m_interp_indices[i]];
-
-        if(m_filter_mode != FilterMode::NONE)
-        {
-#ifdef ENABLE_X86_SIMD
-            if(HAVE_AVX)
-                std::swap(m_interp_bufs[channel], apply_filter_fma3(m_interp_bufs[channel], m_kernel, m_interp_bufs[2]));
-            else
-                std::swap(m_interp_bufs[channel], apply_filter(m_interp_bufs[channel], m_kernel, m_interp_bufs[2]));
-#else
-            m_interp_bufs[channel] = apply_filter(m_interp_bufs[channel], m_kernel, m_interp_bufs[2]);
-#endif // ENABLE_X86_SIMD
-        }
-        
-        for(auto i = 0u; i < m_width; ++i)
+            gpu_values = m_gpu_analysis.output();
+        if(gpu_values == nullptr)
+            return; // gains still being built, nothing to draw yet
+    }
+    else if(m_gpu_waveform)
+    {
+        if(m_vbuf_gen != m_display_gen)
         {
-            auto val = lerp(0.0f, cpos - channel_offset, std::clamp(m_ceiling - m_interp_bufs[channel][i], 0.0f, (float)dbrange) / dbrange);
-            if(val < miny)
-            {
-                miny = val;
-                minpos = i;
-            }
-            m_interp_bufs[channel][i] = val;
+            const ProfileScope scope("waveform gpu envelope");
+            GpuEnvelope::Params params;
+            params.input[0] = m_display_samples[0];
+            params.input[1] = m_display_samples[1];
+            params.head = m_display_raw_head;
+            params.end = m_display_raw_end;
+            params.step = (float)((double)m_waveform_phase_step / (double)(uint64_t(1) << FRAMES_PER_NS_BITS));
+            params.mix = !m_stereo;
+            params.floor = (float)m_range_floor;
+            params.ceiling = (float)m_range_ceiling;
+            params.scale = cpos - channel_offset;
+            gpu_values = m_gpu_envelope.run(params);
+            m_vbuf_gen = m_display_gen;
         }
+        else
+            gpu_values = m_gpu_envelope.output();
+        if(gpu_values == nullptr)
+            return;
+    }
 
-        if(m_mirror_freq_axis)
-        {
-            const auto half = (m_width / 2u);
-            for(auto i = half + 1; i < m_width; ++i)
-                m_interp_bufs[channel][i] = m_interp_bufs[channel][half - (i - half)];
-        }
+    auto tech = get_shader_tech();
+    if(curve)
+        set_shader_vars(cpos, m_render_miny, (float)m_render_minpos, channel_offset, 0.0f, cpos - channel_offset);
+    else
+    {
+        float border_top, border_bottom;
+        get_bar_borders(border_top, border_bottom);
+        set_shader_vars(cpos, m_render_miny, (float)m_render_minpos, channel_offset, border_top, border_bottom);
     }
 
-    set_shader_vars(cpos, miny, (float)minpos, channel_offset, 0.0f, cpos - channel_offset);
+    m_shader_dirty = false;
 
     gs_technique_begin(tech);
     gs_technique_begin_pass(tech, 0);
-    gs_load_vertexbuffer(m_vbuf);
     gs_load_indexbuffer(nullptr);
 
-    auto vbdata = gs_vertexbuffer_get_data(m_vbuf);
-
-    for(auto channel = 0u; channel < (m_stereo ? 2u : 1u); ++channel)
+    // one small upload per tick instead of rewriting every vertex
+    const auto channels = m_stereo ? 2u : 1u;
+    if(m_vbuf_gen != m_display_gen)
     {
-        auto offset = channel_offset;
-        if(channel)
-            offset = -offset;
-        auto bot = cpos - offset;
-
-        for(auto i = 0u; i < m_width; ++i)
+        const ProfileScope scope("waveform vertex fill");
+        m_ring_pos = (m_ring_pos + 1) % RENDER_RING;
+        const auto tex = m_value_tex[m_ring_pos];
+        uint8_t *ptr;
+        uint32_t linesize;
+        if(gs_texture_map(tex, &ptr, &linesize))
         {
-            auto val = m_interp_bufs[channel][i];
-            if(m_render_mode == RenderMode::LINE)
-            {
-                if(channel == 0)
-                    vbdata->points[i].y = val;
-                else
-                    vbdata->points[i].y = bottom - val;
-            }
-            else
-            {
-                if(channel == 0)
-                    vbdata->points[i * 2].y = val;
-                else
-                    vbdata->points[i * 2].y = bottom - val;
-                vbdata->points[(i * 2) + 1].y = bot;
-            }
+            for(auto channel = 0u; channel < channels; ++channel)
+                memcpy(ptr + (channel * linesize), m_interp_bufs[channel].get(), m_interp_size * sizeof(float));
+            gs_texture_unmap(tex);
         }
+        m_vbuf_gen = m_display_gen;
+    }
+    gs_effect_set_texture(m_params.graph_values, (gpu_values != nullptr) ? gpu_values : m_value_tex[m_ring_pos]);
 
-        gs_vertexbuffer_flush(m_vbuf);
-
-        gs_draw((m_render_mode != RenderMode::LINE) ? GS_TRISTRIP : GS_LINESTRIP, 0, (uint32_t)vbdata->num);
+    gs_load_vertexbuffer(m_vbuf[0]);
+    if(curve)
+    {
+        // strips can't be joined, one draw per channel range
+        for(auto channel = 0u; channel < channels; ++channel)
+            gs_draw((m_render_mode != RenderMode::LINE) ? GS_TRISTRIP : GS_LINESTRIP, channel * m_vbuf_stride, m_vbuf_verts[channel]);
     }
+    else if((m_vbuf_verts[0] + m_vbuf_verts[1]) > 0)
+        gs_draw(GS_TRIS, 0, m_vbuf_verts[0] + m_vbuf_verts[1]);
 
     gs_load_vertexbuffer(nullptr);
     gs_technique_end_pass(tech);
     gs_technique_end(tech);
 }
 
-void WAVSource::render_bars([[maybe_unused]] gs_effect_t *effect)
+// history rows live in a render target that keeps its contents between frames
+// a new frame draws its one row in above the last and the view scrolls by the ring position
+void WAVSource::render_spectrogram([[maybe_unused]] gs_effect_t *effect)
 {
-    //std::lock_guard lock(m_mtx); // now locked in render()
-    //if(m_last_silent)
-    //    return;
-
-    auto tech = get_shader_tech();
-
-    const auto bar_stride = m_bar_width + m_bar_gap;
-    const auto step_stride = m_step_width + m_step_gap;
-    const auto center = (float)m_height / 2;
-    const auto bottom = (float)m_height;
-    const auto dbrange = m_ceiling - m_floor;
-    const auto cpos = m_stereo ? center : bottom;
-    const auto channel_offset = m_channel_spacing * 0.5f;
-    auto border_top = (m_rounded_caps) ? m_cap_radius : 0.0f;
-    auto border_bottom = (m_rounded_caps && (!m_stereo || (m_channel_spacing > 0))) ? cpos - m_cap_radius : cpos;
-    if(m_channel_spacing > 0)
-        border_bottom -= channel_offset;
-    if(m_min_bar_height > 0)
-        border_bottom -= m_min_bar_height;
-    border_bottom = std::clamp(border_bottom, border_top, cpos);
-
-    auto max_steps = (size_t)((cpos - channel_offset) / step_stride);
-    if(((int)cpos - (int)(max_steps * step_stride) - (int)channel_offset) > m_step_width)
-        ++max_steps;
+    if((m_spectrogram_row == nullptr) || (m_spectrogram_rows == nullptr))
+        return;
+    const auto width = (uint32_t)m_interp_size;
+    const auto rows = m_height;
 
-    // interpolation
-    auto miny = cpos;
-    auto minpos = 0u;
-    for(auto channel = 0u; channel < (m_stereo ? 2u : 1u); ++channel)
+    if(m_spectrogram_gen != m_display_gen)
     {
-        if(m_meter_mode)
+        uint8_t *ptr;
+        uint32_t linesize;
+        if(gs_texture_map(m_spectrogram_row, &ptr, &linesize))
         {
-            for(auto i = 0u; i < m_capture_channels; ++i)
-                m_interp_bufs[0][i] = m_meter_val[i];
+            memcpy(ptr, m_interp_bufs[0].get(), width * sizeof(float));
+            gs_texture_unmap(m_spectrogram_row);
         }
-        else
-        {
-            if(m_interp_mode != InterpMode::POINT)
-            {
-#ifdef ENABLE_X86_SIMD
-                if(HAVE_AVX)
-                    apply_interp_filter_fma3(m_decibels[channel].get(), m_fft_size / 2, m_band_widths, m_interp_indices, m_interp_kernel, m_interp_bufs[channel]);
-                else
-                    apply_interp_filter(m_decibels[channel].get(), m_fft_size / 2, m_band_widths, m_interp_indices, m_interp_kernel, m_interp_bufs[channel]);
-#else
-                apply_interp_filter(m_decibels[channel].get(), m_fft_size / 2, m_band_widths, m_interp_indices, m_interp_kernel, m_interp_bufs[channel]);
-#endif
-            }
-            else
-            {
-                for(auto i = 0; i < m_num_bars; ++i)
-                {
-                    float sum = 0.0f;
-                    auto count = (size_t)m_band_widths[i];
-                    for(size_t j = 0; j < count; ++j)
-                        sum += m_decibels[channel][(size_t)m_interp_indices[i] + j];
-                    m_interp_bufs[channel][i] = sum / (float)count;
-                }
-            }
 
-            if(m_filter_mode != FilterMode::NONE)
+        m_spectrogram_pos = (m_spectrogram_pos + rows - 1) % rows;
+        gs_texrender_reset(m_spectrogram_rows);
+        if(gs_texrender_begin(m_spectrogram_rows, width, rows))
+        {
+            if(std::exchange(m_spectrogram_clear, false))
             {
-#ifdef ENABLE_X86_SIMD
-                if(HAVE_AVX)
-                    std::swap(m_interp_bufs[channel], apply_filter_fma3(m_interp_bufs[channel], m_kernel, m_interp_bufs[2]));
-                else
-                    std::swap(m_interp_bufs[channel], apply_filter(m_interp_bufs[channel], m_kernel, m_interp_bufs[2]));
-#else
-                m_interp_bufs[channel] = apply_filter(m_interp_bufs[channel], m_kernel, m_interp_bufs[2]);
-#endif // ENABLE_X86_SIMD
+                vec4 clear;
+                vec4_zero(&clear);
+                gs_clear(GS_CLEAR_COLOR, &clear, 0.0f, 0);
             }
+            gs_ortho(0.0f, (float)width, 0.0f, (float)rows, -100.0f, 100.0f);
+            gs_blend_state_push();
+            gs_enable_blending(false);
+            gs_matrix_push();
+            gs_matrix_translate3f(0.0f, (float)m_spectrogram_pos, 0.0f);
+            auto default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+            gs_effect_set_texture(gs_effect_get_param_by_name(default_effect, "image"), m_spectrogram_row);
+            while(gs_effect_loop(default_effect, "Draw"))
+                gs_draw_sprite(m_spectrogram_row, 0, width, 1);
+            gs_matrix_pop();
+            gs_blend_state_pop();
+            gs_texrender_end(m_spectrogram_rows);
         }
+        m_spectrogram_gen = m_display_gen;
+    }
+
+    if(m_shader_dirty)
+    {
+        upload_color_lut();
+        m_shader_dirty = false;
+    }
+    vec2 size;
+    vec2_set(&size, (float)width, (float)rows);
+    gs_effect_set_vec2(m_params.spectrogram_size, &size);
+    gs_effect_set_float(m_params.spectrogram_offset, (float)m_spectrogram_pos);
+    gs_effect_set_texture(m_params.spectrogram_rows, gs_texrender_get_texture(m_spectrogram_rows));
+
+    const auto tech = m_params.spectrogram;
+    gs_technique_begin(tech);
+    gs_technique_begin_pass(tech, 0);
+    gs_draw_sprite(nullptr, 0, m_width, m_height);
+    gs_technique_end_pass(tech);
+    gs_technique_end(tech);
+}
 
-        for(auto i = 0; i < m_num_bars; ++i)
+// the trail keeps its contents between frames, each new frame fades it and draws the graph over it
+// one extra full screen pass, views of the same frame only draw the result
+void WAVSource::render_afterglow(gs_effect_t *effect)
+{
+    const auto width = graph_width();
+    const auto height = graph_height();
+    if((width == 0) || (height == 0))
+        return;
+    if(m_glow_gen != m_display_gen)
+    {
+        gs_texrender_reset(m_glow_target);
+        if(!gs_texrender_begin(m_glow_target, width, height))
         {
-            auto val = lerp(border_top, border_bottom, std::clamp(m_ceiling - m_interp_bufs[channel][i], 0.0f, (float)dbrange) / dbrange);
-            if(val < miny)
-            {
-                miny = val;
-                minpos = i;
-            }
-            m_interp_bufs[channel][i] = val;
+            render_graph(effect);
+            return;
         }
-
-        if(m_mirror_freq_axis)
+        gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+        if(std::exchange(m_glow_clear, false))
         {
-            const auto half = (m_num_bars / 2u);
-            for(auto i = half + 1; i < (unsigned int)m_num_bars; ++i)
-                m_interp_bufs[channel][i] = m_interp_bufs[channel][half - (i - half)];
+            vec4 clear;
+            vec4_zero(&clear);
+            gs_clear(GS_CLEAR_COLOR, &clear, 0.0f, 0);
         }
+        else
+            fade_target(width, height, m_glow_fade);
+        gs_blend_state_push();
+        gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+        render_graph(effect);
+        gs_blend_state_pop();
+        gs_texrender_end(m_glow_target);
+        m_glow_fade = 1.0f;
+        m_glow_gen = m_display_gen;
     }
 
-    set_shader_vars(cpos, miny, (float)minpos, channel_offset, border_top, border_bottom);
-
-    gs_technique_begin(tech);
-    gs_technique_begin_pass(tech, 0);
-    gs_load_vertexbuffer(m_vbuf);
-    gs_load_indexbuffer(nullptr);
+    auto tex = gs_texrender_get_texture(m_glow_target);
+    auto default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+    gs_blend_state_push();
+    gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+    gs_effect_set_texture(gs_effect_get_param_by_name(default_effect, "image"), tex);
+    while(gs_effect_loop(default_effect, "Draw"))
+        gs_draw_sprite(tex, 0, width, height);
+    gs_blend_state_pop();
+}
 
-    auto vbdata = gs_vertexbuffer_get_data(m_vbuf);
+// the accumulation keeps its contents between frames, each new frame fades it and adds its points
+// views of the same frame only draw the result
+void WAVSource::render_vectorscope([[maybe_unused]] gs_effect_t *effect)
+{
+    if(m_scope_target == nullptr)
+        return;
+    const auto width = m_width;
+    const auto height = m_height;
 
-    for(auto channel = 0u; channel < (m_stereo ? 2u : 1u); ++channel)
+    if(m_scope_gen != m_display_gen)
     {
-        auto vertpos = 0u;
-
-        for(auto i = 0; i < m_num_bars; ++i)
+        // new points go to the next buffer of the ring, a draw may still be reading the last one
+        const auto count = (uint32_t)std::min(m_display_points, m_fft_size);
+        const auto points = (count > 0) && (m_display_db[0] != nullptr) && (m_display_db[1] != nullptr);
+        if(points)
         {
-            auto val = m_interp_bufs[channel][i];
+            const ProfileScope scope("vectorscope vertex fill");
+            m_ring_pos = (m_ring_pos + 1) % RENDER_RING;
+            auto vbdata = gs_vertexbuffer_get_data(m_vbuf[m_ring_pos]);
+            for(auto i = 0u; i < count; ++i)
+                vec3_set(&vbdata->points[i], m_display_db[0][i], m_display_db[1][i], 0.0f);
+            gs_vertexbuffer_flush(m_vbuf[m_ring_pos]);
+        }
 
-            if((m_display_mode == DisplayMode::STEPPED_BAR) || (m_display_mode == DisplayMode::STEPPED_METER))
+        gs_texrender_reset(m_scope_target);
+        if(gs_texrender_begin(m_scope_target, width, height))
+        {
+            gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+            gs_blend_state_push();
+            if(std::exchange(m_scope_clear, false))
             {
-                const auto x = (float)(i * bar_stride);
-                const auto maxheight = (cpos - val - channel_offset);
-                for(auto j = 0u; j < max_steps; ++j)
-                {
-                    auto y = (float)(j * step_stride);
-                    if(y >= maxheight)
-                        break;
-                    if(channel)
-                        y = cpos + y + channel_offset;
-                    else
-                        y = cpos - y - channel_offset - m_step_width;
-
-                    vec3 vert;
-                    vec3_set(&vert, x, y, 0.0f);
-                    vec3_add(&vbdata->points[vertpos], &m_step_verts[0], &vert);
-                    vec3_add(&vbdata->points[vertpos + 1], &m_step_verts[1], &vert);
-                    vec3_add(&vbdata->points[vertpos + 2], &m_step_verts[2], &vert);
-                    vec3_add(&vbdata->points[vertpos + 3], &m_step_verts[3], &vert);
-                    vec3_add(&vbdata->points[vertpos + 4], &m_step_verts[4], &vert);
-                    vec3_add(&vbdata->points[vertpos + 5], &m_step_verts[5], &vert);
-                    vertpos += 6;
-                }
+                vec4 clear;
+                vec4_zero(&clear);
+                gs_clear(GS_CLEAR_COLOR, &clear, 0.0f, 0);
             }
             else
+                fade_target(width, height, m_scope_fade);
+            if(points)
             {
-                auto x1 = (float)(i * bar_stride);
-                auto x2 = x1 + m_bar_width;
-                auto offset = (m_rounded_caps ? m_cap_radius : 0.0f) + channel_offset;
-                if(channel)
-                {
-                    val = bottom - val;
-                    offset = -offset;
-                }
-                auto bot = ((m_rounded_caps && !m_stereo) || (m_channel_spacing > 0)) ? (cpos - offset) : cpos;
-                vec3_set(&vbdata->points[vertpos], x1, val, 0);
-                vec3_set(&vbdata->points[vertpos + 1], x2, val, 0);
-                vec3_set(&vbdata->points[vertpos + 2], x1, bot, 0);
-                vec3_set(&vbdata->points[vertpos + 3], x2, val, 0);
-                vec3_set(&vbdata->points[vertpos + 4], x1, bot, 0);
-                vec3_set(&vbdata->points[vertpos + 5], x2, bot, 0);
-                vertpos += 6;
-
-                if(m_rounded_caps)
-                {
-                    auto ccx = (float)(i * bar_stride) + m_cap_radius; // cap center x
-                    auto half = m_cap_tris / 2; // m_cap_tris always even
-                    auto start = m_radial ? 0 : (channel ? 0 : half);
-                    auto stop = m_radial ? m_cap_tris : (start + half);
-                    vec3 cvert;
-                    vec3_set(&cvert, ccx, val, 0.0f);
-                    for(auto j = start; j < stop; ++j)
-                    {
-                        vec3_add(&vbdata->points[vertpos], &m_cap_verts[j], &cvert);
-                        vec3_add(&vbdata->points[vertpos + 1], &m_cap_verts[j + 1], &cvert);
-                        vec3_copy(&vbdata->points[vertpos + 2], &cvert);
-                        vertpos += 3;
-                    }
-                    if(!m_stereo || (m_channel_spacing > 0))
-                    {
-                        auto ccy = cpos - offset;
-                        start = m_radial ? 0 : (channel ? half : 0);
-                        stop = m_radial ? m_cap_tris : (start + half);
-                        vec3_set(&cvert, ccx, ccy, 0.0f);
-                        for(auto j = start; j < stop; ++j)
-                        {
-                            vec3_add(&vbdata->points[vertpos], &m_cap_verts[j], &cvert);
-                            vec3_add(&vbdata->points[vertpos + 1], &m_cap_verts[j + 1], &cvert);
-                            vec3_copy(&vbdata->points[vertpos + 2], &cvert);
-                            vertpos += 3;
-                        }
-                    }
-                }
+                vec2 center;
+                vec2_set(&center, (float)width / 2, (float)height / 2);
+                gs_effect_set_vec2(m_params.scope_center, &center);
+                gs_effect_set_float(m_params.scope_scale, (float)std::min(width, height) / 2);
+                gs_effect_set_float(m_params.scope_intensity, VECTORSCOPE_INTENSITY);
+                gs_effect_set_vec4(m_params.color_base, &m_color_base);
+                gs_blend_function(GS_BLEND_ONE, GS_BLEND_ONE);
+                const auto tech = m_params.vectorscope;
+                gs_technique_begin(tech);
+                gs_technique_begin_pass(tech, 0);
+                gs_load_indexbuffer(nullptr);
+                gs_load_vertexbuffer(m_vbuf[m_ring_pos]);
+                gs_draw(GS_POINTS, 0, count);
+                gs_load_vertexbuffer(nullptr);
+                gs_technique_end_pass(tech);
+                gs_technique_end(tech);
             }
+            gs_blend_state_pop();
+            gs_texrender_end(m_scope_target);
         }
-
-        gs_vertexbuffer_flush(m_vbuf);
-
-        if(vertpos > 0)
-            gs_draw(GS_TRIS, 0, vertpos);
+        m_scope_fade = 1.0f;
+        m_scope_gen = m_display_gen;
     }
 
-    gs_load_vertexbuffer(nullptr);
-    gs_technique_end_pass(tech);
-    gs_technique_end(tech);
+    // premultiplied
+    auto tex = gs_texrender_get_texture(m_scope_target);
+    if(tex == nullptr)
+        return;
+    auto default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+    gs_blend_state_push();
+    gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+    gs_effect_set_texture(gs_effect_get_param_by_name(default_effect, "image"), tex);
+    while(gs_effect_loop(default_effect, "Draw"))
+        gs_draw_sprite(tex, 0, width, height);
+    gs_blend_state_pop();
 }
 
 gs_technique_t *WAVSource::get_shader_tech()
 {
-    const char *techname;
+    auto tech = 0u; // Solid
+    if(m_render_mode == RenderMode::GRADIENT)
+        tech = 1;
+    else if(m_render_mode == RenderMode::RANGE)
+        tech = 2;
     if(m_radial)
+        tech += 3;
+
+    // texture driven variants of the same techniques
+    auto variant = 0u;
+    if(m_gpu_geometry)
     {
-        if(m_render_mode == RenderMode::GRADIENT)
-            techname = "RadialGradient";
-        else if(m_render_mode == RenderMode::RANGE)
-            techname = "RadialRange";
-        else
-            techname = "Radial";
+        const auto curve = curve_display();
+        const auto stepped = (m_display_mode == DisplayMode::STEPPED_BAR) || (m_display_mode == DisplayMode::STEPPED_METER);
+        variant = stepped ? 2 : ((m_rounded_caps && !curve) ? 3 : 1);
     }
-    else if(m_render_mode == RenderMode::GRADIENT)
-        techname = "Gradient";
-    else if(m_render_mode == RenderMode::RANGE)
-        techname = "Range";
-    else
-        techname = "Solid";
-    return gs_effect_get_technique(m_shader, techname);
+    return m_params.techs[variant][tech];
 }
 
+// values that only depend on settings are set once after update(), the effect keeps them
 void WAVSource::set_shader_vars(float cpos, float miny, float minpos, float channel_offset, float border_top, float border_bottom)
 {
     if(m_render_mode == RenderMode::PULSE)
@@ -1671,104 +5796,327 @@ void WAVSource::set_shader_vars(float cpos, float miny, float minpos, float chan
         bool bars = (m_display_mode == DisplayMode::BAR) || (m_display_mode == DisplayMode::STEPPED_BAR) || m_meter_mode;
         vec4 color;
         auto range = border_bottom - border_top;
-        auto t = (m_pulse_mode == PulseMode::MAGNITUDE) ? saturate((border_bottom - miny) / (range * m_grad_ratio)) : saturate(minpos / ((bars ? (float)(m_num_bars - 1) : (float)(m_width - 1)) * m_grad_ratio));
+        float t;
+        if(m_pulse_mode == PulseMode::BEAT)
+            t = saturate(beat_pulse() / m_grad_ratio);
+        else if(m_pulse_mode == PulseMode::MAGNITUDE)
+            t = saturate((border_bottom - miny) / (range * m_grad_ratio));
+        else
+            t = saturate(minpos / ((bars ? (float)(m_num_bars - 1) : (float)(m_width - 1)) * m_grad_ratio));
         auto x = lerp(m_color_base.x, m_color_crest.x, t);
         auto y = lerp(m_color_base.y, m_color_crest.y, t);
         auto z = lerp(m_color_base.z, m_color_crest.z, t);
         auto w = lerp(m_color_base.w, m_color_crest.w, t);
         vec4_set(&color, x, y, z, w);
+        gs_effect_set_vec4(m_params.color_base, &color);
+    }
+    else if(m_render_mode == RenderMode::GRADIENT)
+        gs_effect_set_float(m_params.grad_height, (cpos - miny - channel_offset) * m_grad_ratio);
+
+    if(!m_shader_dirty)
+        return;
+    m_shader_dirty = false;
 
-        auto color_base = gs_effect_get_param_by_name(m_shader, "color_base");
-        gs_effect_set_vec4(color_base, &color);
+    if(m_render_mode != RenderMode::PULSE)
+        gs_effect_set_vec4(m_params.color_base, &m_color_base);
+
+    if(m_render_mode == RenderMode::GRADIENT)
+    {
+        upload_color_lut();
+        gs_effect_set_float(m_params.grad_center, cpos);
+        gs_effect_set_float(m_params.grad_offset, channel_offset);
     }
-    else
+    else if(m_render_mode == RenderMode::RANGE)
     {
-        auto color_base = gs_effect_get_param_by_name(m_shader, "color_base");
-        gs_effect_set_vec4(color_base, &m_color_base);
-
-        if(m_render_mode == RenderMode::GRADIENT)
-        {
-            auto color_crest = gs_effect_get_param_by_name(m_shader, "color_crest");
-            gs_effect_set_vec4(color_crest, &m_color_crest);
-            auto grad_height = gs_effect_get_param_by_name(m_shader, "grad_height");
-            gs_effect_set_float(grad_height, (cpos - miny - channel_offset) * m_grad_ratio);
-            auto grad_center = gs_effect_get_param_by_name(m_shader, "grad_center");
-            gs_effect_set_float(grad_center, cpos);
-            auto grad_offset = gs_effect_get_param_by_name(m_shader, "grad_offset");
-            gs_effect_set_float(grad_offset, channel_offset);
-        }
-        else if(m_render_mode == RenderMode::RANGE)
-        {
-            auto color_middle = gs_effect_get_param_by_name(m_shader, "color_middle");
-            gs_effect_set_vec4(color_middle, &m_color_middle);
-            auto color_crest = gs_effect_get_param_by_name(m_shader, "color_crest");
-            gs_effect_set_vec4(color_crest, &m_color_crest);
-            auto grad_height = gs_effect_get_param_by_name(m_shader, "grad_height");
-            gs_effect_set_float(grad_height, cpos - channel_offset);
-            auto grad_center = gs_effect_get_param_by_name(m_shader, "grad_center");
-            gs_effect_set_float(grad_center, cpos);
-            auto grad_offset = gs_effect_get_param_by_name(m_shader, "grad_offset");
-            gs_effect_set_float(grad_offset, channel_offset);
-            auto range_middle = gs_effect_get_param_by_name(m_shader, "range_middle");
-            gs_effect_set_float(range_middle, (float)(m_range_middle - m_ceiling) / m_floor);
-            auto range_crest = gs_effect_get_param_by_name(m_shader, "range_crest");
-            gs_effect_set_float(range_crest, (float)(m_range_crest - m_ceiling) / m_floor);
-        }
+        upload_color_lut();
+        gs_effect_set_float(m_params.grad_height, cpos - channel_offset);
+        gs_effect_set_float(m_params.grad_center, cpos);
+        gs_effect_set_float(m_params.grad_offset, channel_offset);
     }
 
     if(m_radial)
     {
-        auto graph_width = gs_effect_get_param_by_name(m_shader, "graph_width");
-        gs_effect_set_float(graph_width, float(m_width - 1));
-        auto graph_height = gs_effect_get_param_by_name(m_shader, "graph_height");
-        gs_effect_set_float(graph_height, (float)m_height);
-        auto graph_deadzone = gs_effect_get_param_by_name(m_shader, "graph_deadzone");
-        gs_effect_set_float(graph_deadzone, m_deadzone);
-        auto radial_arc = gs_effect_get_param_by_name(m_shader, "radial_arc");
-        gs_effect_set_float(radial_arc, m_radial_arc);
-        auto radial_rotation = gs_effect_get_param_by_name(m_shader, "radial_rotation");
-        gs_effect_set_float(radial_rotation, m_radial_rotation);
-        auto graph_invert = gs_effect_get_param_by_name(m_shader, "graph_invert");
-        gs_effect_set_bool(graph_invert, m_invert);
-        auto radial_center = gs_effect_get_param_by_name(m_shader, "radial_center");
+        gs_effect_set_float(m_params.graph_width, float(m_width - 1));
+        gs_effect_set_float(m_params.graph_height, (float)m_height);
+        gs_effect_set_float(m_params.graph_deadzone, m_deadzone);
+        gs_effect_set_float(m_params.radial_arc, m_radial_arc);
+        gs_effect_set_float(m_params.radial_rotation, m_radial_rotation);
+        gs_effect_set_bool(m_params.graph_invert, m_invert);
         vec2 rc;
         vec2_set(&rc, (float)m_height + m_deadzone, (float)m_height + m_deadzone);
-        gs_effect_set_vec2(radial_center, &rc);
+        gs_effect_set_vec2(m_params.radial_center, &rc);
+    }
+
+    if(m_gpu_geometry)
+    {
+        // base of each channel
+        const auto curve = curve_display();
+        vec2 base;
+        for(auto channel = 0u; channel < 2u; ++channel)
+        {
+            auto offset = (m_rounded_caps && !curve) ? m_cap_radius + channel_offset : channel_offset;
+            if(channel)
+                offset = -offset;
+            base.ptr[channel] = (curve || (m_rounded_caps && !m_stereo) || (m_channel_spacing > 0)) ? (cpos - offset) : cpos;
+        }
+        gs_effect_set_vec2(m_params.graph_base, &base);
+        gs_effect_set_float(m_params.graph_points, m_spline ? (float)m_interp_size : 0.0f);
+        gs_effect_set_float(m_params.graph_center, cpos);
+        gs_effect_set_float(m_params.graph_bottom, (float)m_height);
+        gs_effect_set_float(m_params.graph_step_limit, cpos - channel_offset);
+        gs_effect_set_float(m_params.cap_radius, m_cap_radius);
+        if((m_display_mode == DisplayMode::STEPPED_BAR) || (m_display_mode == DisplayMode::STEPPED_METER))
+        {
+            const auto step_stride = m_step_width + m_step_gap;
+            auto max_steps = (int)((cpos - channel_offset) / step_stride);
+            if(((int)cpos - (max_steps * step_stride) - (int)channel_offset) > m_step_width)
+                ++max_steps;
+            gs_effect_set_float(m_params.step_width, (float)m_step_width);
+            gs_effect_set_float(m_params.step_stride, (float)step_stride);
+            gs_effect_set_float(m_params.step_count, (float)max_steps);
+        }
     }
 }
 
+// only the analysis reads these, none of them need m_mtx
 void WAVSource::show()
 {
-    std::lock_guard lock(m_mtx);
+    std::lock_guard lock(m_analysis_mtx);
+    m_visible = true;
     m_show = true;
 }
 
 void WAVSource::hide()
 {
-    std::lock_guard lock(m_mtx);
+    std::lock_guard lock(m_analysis_mtx);
+    m_visible = false;
     m_show = false;
 }
 
+void WAVSource::get_capture_stats(calldata_t *cd)
+{
+    std::lock_guard lock(m_analysis_mtx);
+    const auto& stream = m_capture.stream();
+    calldata_set_int(cd, "blocks", (stream != nullptr) ? (long long)stream->blocks() : 0);
+    calldata_set_int(cd, "truncated_samples", (stream != nullptr) ? (long long)stream->truncated_samples() : 0);
+    calldata_set_int(cd, "overrun_samples", (long long)m_capture.overrun_samples());
+}
+
+void WAVSource::get_stats(calldata_t *cd)
+{
+    std::lock_guard lock(m_mtx);
+    calldata_set_int(cd, "bytes", (long long)buffer_bytes());
+    calldata_set_float(cd, "tick_ms", m_tick_cost.avg_ns / 1e6);
+    calldata_set_float(cd, "tick_max_ms", (double)m_tick_cost.max_ns / 1e6);
+    calldata_set_float(cd, "render_ms", m_render_cost.avg_ns / 1e6);
+    calldata_set_float(cd, "render_max_ms", (double)m_render_cost.max_ns / 1e6);
+    calldata_set_float(cd, "tick_p99_ms", m_tick_cost.histogram.percentile(0.99));
+    calldata_set_float(cd, "tick_p999_ms", m_tick_cost.histogram.percentile(0.999));
+    calldata_set_float(cd, "render_p99_ms", m_render_cost.histogram.percentile(0.99));
+    calldata_set_float(cd, "render_p999_ms", m_render_cost.histogram.percentile(0.999));
+    calldata_set_float(cd, "lock_wait_ms", m_lock_wait.avg_ns / 1e6);
+    calldata_set_float(cd, "lock_wait_max_ms", (double)m_lock_wait.max_ns / 1e6);
+    std::lock_guard analysis_lock(m_analysis_mtx);
+    calldata_set_float(cd, "analysis_ms", m_analysis_cost.avg_ns / 1e6);
+    calldata_set_float(cd, "analysis_max_ms", (double)m_analysis_cost.max_ns / 1e6);
+    calldata_set_float(cd, "analysis_wait_ms", m_analysis_wait.avg_ns / 1e6);
+    calldata_set_float(cd, "analysis_wait_max_ms", (double)m_analysis_wait.max_ns / 1e6);
+    calldata_set_float(cd, "kernel_ms", m_kernel_cost.avg_ns / 1e6);
+    calldata_set_float(cd, "kernel_max_ms", (double)m_kernel_cost.max_ns / 1e6);
+    calldata_set_string(cd, "kernel", kernel_name());
+    calldata_set_string(cd, "tier", DSPKernels::get().analysis_name);
+}
+
+// {"tick":{...},"render":{...},...} with CostHistogram::json() for each, durations in ms and bucket edges in us
+void WAVSource::get_frame_times(calldata_t *cd)
+{
+    std::string json;
+    {
+        std::lock_guard lock(m_mtx);
+        json = "{\"tick\":" + m_tick_cost.histogram.json() + ",\"render\":" + m_render_cost.histogram.json()
+            + ",\"lock_wait\":" + m_lock_wait.histogram.json();
+    }
+    {
+        std::lock_guard lock(m_analysis_mtx);
+        json += ",\"analysis\":" + m_analysis_cost.histogram.json() + ",\"analysis_wait\":" + m_analysis_wait.histogram.json()
+            + ",\"kernel\":" + m_kernel_cost.histogram.json() + "}";
+    }
+    calldata_set_string(cd, "json", json.c_str());
+}
+
+void WAVSource::get_health(calldata_t *cd)
+{
+    calldata_set_int(cd, "overflows", (long long)m_health.overflows.load(std::memory_order_relaxed));
+    calldata_set_int(cd, "underruns", (long long)m_health.underruns.load(std::memory_order_relaxed));
+    calldata_set_int(cd, "resyncs", (long long)m_health.resyncs.load(std::memory_order_relaxed));
+    calldata_set_int(cd, "contended", (long long)m_health.contended.load(std::memory_order_relaxed));
+}
+
+void WAVSource::get_spectrum(calldata_t *cd)
+{
+    m_export_demand_ts.store(os_gettime_ns(), std::memory_order_relaxed);
+    calldata_set_ptr(cd, "snapshot", const_cast<waveform_snapshot*>(m_spectrum_export.acquire()));
+}
+
+void WAVSource::get_bands(calldata_t *cd)
+{
+    m_export_demand_ts.store(os_gettime_ns(), std::memory_order_relaxed);
+    calldata_set_ptr(cd, "snapshot", const_cast<waveform_snapshot*>(m_bands_export.acquire()));
+}
+
+void WAVSource::get_meter(calldata_t *cd)
+{
+    m_export_demand_ts.store(os_gettime_ns(), std::memory_order_relaxed);
+    std::lock_guard lock(m_analysis_mtx);
+    calldata_set_float(cd, "left", m_meter_val[0]);
+    calldata_set_float(cd, "right", m_meter_val[m_stereo ? 1 : 0]);
+    calldata_set_int(cd, "audio_ts", (long long)m_audio_ts);
+}
+
+void WAVSource::get_beat(calldata_t *cd)
+{
+    std::lock_guard lock(m_analysis_mtx);
+    calldata_set_bool(cd, "enabled", m_beat_detection);
+    calldata_set_float(cd, "bpm", m_onset.bpm());
+    calldata_set_float(cd, "confidence", m_onset.confidence());
+    calldata_set_float(cd, "strength", m_onset.strength());
+    calldata_set_int(cd, "beats", (long long)m_onset.beats());
+    calldata_set_int(cd, "onsets", (long long)m_onset.onsets());
+    calldata_set_int(cd, "audio_ts", (long long)m_audio_ts);
+}
+
+void WAVSource::reset_frame_times()
+{
+    {
+        std::lock_guard lock(m_mtx);
+        m_tick_cost.histogram.clear();
+        m_render_cost.histogram.clear();
+        m_lock_wait.histogram.clear();
+    }
+    std::lock_guard lock(m_analysis_mtx);
+    m_analysis_cost.histogram.clear();
+    m_analysis_wait.histogram.clear();
+    m_kernel_cost.histogram.clear();
+}
+
 void WAVSource::register_source()
 {
+    // [cpu] tier=generic, sse4.1, avx, avx2, avx512, neon or accelerate caps the kernels of every source
+    // for comparing tiers on real scenes, or avoiding one that is slower on a particular CPU
+#ifdef ENABLE_X86_SIMD
+    static constexpr const char *tiers[] = { "generic", "sse4.1", "avx", "avx2", "avx512" };
+#elif defined(ENABLE_ARM_SIMD) && defined(ENABLE_ACCELERATE_FFT)
+    static constexpr const char *tiers[] = { "generic", "neon", "accelerate" }; // vDSP display filters on top of NEON
+#elif defined(ENABLE_ARM_SIMD)
+    static constexpr const char *tiers[] = { "generic", "neon" };
+#else
+    static constexpr const char *tiers[] = { "generic" };
+#endif // ENABLE_X86_SIMD
+    // index into tiers, -1 if the key is missing or unknown
+    const auto config_tier = [](const char *name) {
+        auto tier = module_config_string("cpu", name);
+        std::transform(tier.begin(), tier.end(), tier.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        if(tier.empty())
+            return -1;
+        const auto it = std::find(std::begin(tiers), std::end(tiers), tier);
+        if(it == std::end(tiers))
+        {
+            LogWarn << "Unknown CPU tier \"" << tier << "\" for " << name << " in config.ini, using every available instruction set";
+            return -1;
+        }
+        return (int)(it - std::begin(tiers));
+    };
+#ifdef ENABLE_X86_SIMD
+    const auto cpu = cpu_features::GetX86Info().features;
+    HAVE_AVX512 = cpu.avx512f && cpu.avx2 && cpu.fma3;
+    HAVE_AVX2 = cpu.avx2 && cpu.fma3;
+    HAVE_AVX = cpu.avx && cpu.fma3;
+    HAVE_FMA3 = cpu.fma3;
+    HAVE_F16C = cpu.f16c;
+    HAVE_AVX1 = cpu.avx;
+    HAVE_SSE41 = cpu.sse4_1;
+#endif // ENABLE_X86_SIMD
+
+    [[maybe_unused]] auto tier_level = (int)std::size(tiers) - 1;
+    if(const auto level = config_tier("tier"); level >= 0)
+    {
+        tier_level = level;
+#ifdef ENABLE_X86_SIMD
+        HAVE_AVX512 = HAVE_AVX512 && (level >= 4);
+        HAVE_AVX2 = HAVE_AVX2 && (level >= 3);
+        HAVE_F16C = HAVE_F16C && (level >= 3); // only used with AVX2
+        HAVE_AVX = HAVE_AVX && (level >= 2);
+        HAVE_AVX1 = HAVE_AVX1 && (level >= 2);
+        HAVE_FMA3 = HAVE_FMA3 && (level >= 2);
+        HAVE_SSE41 = HAVE_SSE41 && (level >= 1);
+#elif defined(ENABLE_ARM_SIMD)
+        HAVE_NEON = HAVE_NEON && (level >= 1);
+#endif // ENABLE_X86_SIMD
+        LogInfo << "CPU tier limited to " << tiers[level];
+    }
+
+    // the kernels go by the same tier, interp, filter, filterbank, iir and analysis in [cpu] cap each one further
+#ifdef ENABLE_X86_SIMD
+    const auto cpu_level = HAVE_AVX512 ? 4 : HAVE_AVX2 ? 3 : HAVE_AVX1 ? 2 : HAVE_SSE41 ? 1 : 0;
+#elif defined(ENABLE_ARM_SIMD)
+    const auto cpu_level = HAVE_NEON ? tier_level : 0; // accelerate has no CPU flag of its own
+#else
+    const auto cpu_level = 0;
+#endif // ENABLE_X86_SIMD
+    const auto kernel_level = [&](const char *name) {
+        const auto level = config_tier(name);
+        if(level < 0)
+            return cpu_level;
+        LogInfo << "CPU tier of " << name << " limited to " << tiers[level];
+        return std::min(level, cpu_level);
+    };
+    DSPKernels::Levels levels;
+    levels.interp = kernel_level("interp");
+    levels.filter = kernel_level("filter");
+    levels.filterbank = kernel_level("filterbank");
+    levels.iir = kernel_level("iir");
+    levels.analysis = kernel_level("analysis");
+#ifdef ENABLE_X86_SIMD
+    levels.fma = HAVE_FMA3;
+    levels.f16c = HAVE_F16C;
+#endif // ENABLE_X86_SIMD
+    // measured winners on this host only ever lower the levels, see [cpu] autotune
+    auto tuned = levels;
+    if(!KernelTuning::apply(tuned, tiers))
+        KernelTuning::start(levels, tiers);
+    DSPKernels::select(tuned);
+
     std::string arch;
 #ifdef ENABLE_X86_SIMD
+    if(HAVE_AVX512)
+        arch += " AVX512";
     if(HAVE_AVX2)
         arch += " AVX2";
-    if(HAVE_AVX)
+    if(HAVE_AVX1)
         arch += " AVX";
     if(HAVE_FMA3)
         arch += " FMA3";
+    if(HAVE_F16C)
+        arch += " F16C";
+    if(HAVE_SSE41)
+        arch += " SSE4.1";
     arch += " SSE2";
+#elif defined(ENABLE_ARM_SIMD)
+    arch = HAVE_NEON ? " NEON" : " Generic";
+#ifdef ENABLE_ACCELERATE_FFT
+    if(HAVE_NEON && (tier_level >= 2))
+        arch += " Accelerate";
+#endif
 #else
     arch = " Generic";
 #endif // ENABLE_X86_SIMD
 
     LogInfo << "Registered v" WAVEFORM_VERSION " " WAVEFORM_ARCH;
     LogInfo << "Using CPU capabilities:" << arch;
+    LogInfo << "Using FFT backend: " << FFTEngine::backend_name();
 
     obs_source_info info{};
-    info.id = MODULE_NAME "_source";
+    info.id = SOURCE_ID;
     info.type = OBS_SOURCE_TYPE_INPUT;
     info.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW;
     info.get_name = &callbacks::get_name;
@@ -1781,87 +6129,11 @@ void WAVSource::register_source()
     info.update = &callbacks::update;
     info.show = &callbacks::show;
     info.hide = &callbacks::hide;
+    info.activate = &callbacks::activate;
+    info.deactivate = &callbacks::deactivate;
     info.video_tick = &callbacks::tick;
     info.video_render = &callbacks::render;
     info.icon_type = OBS_ICON_TYPE_AUDIO_OUTPUT;
 
     obs_register_source(&info);
 }
-
-void WAVSource::capture_audio([[maybe_unused]] obs_source_t *source, const audio_data *audio, bool muted)
-{
-    static_assert(AUDIO_OUTPUT_FRAMES > 0, "AUDIO_OUTPUT_FRAMES must be greater than zero."); // sanity check
-    if(audio == nullptr)
-        return;
-    if(!m_mtx.try_lock_for(std::chrono::milliseconds(10)))
-        return;
-    std::lock_guard lock(m_mtx, std::adopt_lock);
-    if(((m_audio_source == nullptr) && !m_output_bus_captured) || (m_capture_channels == 0))
-        return;
-    assert((m_channel_base >= 0) && (m_channel_base < (int)get_audio_channels(m_audio_info.speakers)));
-    assert((m_channel_base == 0) || (m_capture_channels == 1));
-
-    // audio sync
-    m_capture_ts = os_gettime_ns();
-    auto audio_len = audio_frames_to_ns(m_audio_info.samples_per_sec, audio->frames);
-    auto delta = std::max(audio->timestamp, m_capture_ts) - std::min(audio->timestamp, m_capture_ts);
-    if(delta > MAX_TS_DELTA) // attempt to handle extreme / bogus timestamps (e.g. VLC)
-        m_audio_ts = m_capture_ts;
-    else
-        m_audio_ts = audio->timestamp + audio_len;
-    const auto bufsz = ((m_display_mode == DisplayMode::WAVEFORM) ? m_waveform_samples : m_fft_size) * sizeof(float);
-    const int64_t dtaudio = get_audio_sync(m_capture_ts);
-    const size_t dtsamples = (dtaudio > 0) ? (size_t)ns_to_audio_frames(m_audio_info.samples_per_sec, (uint64_t)dtaudio) : 0;
-
-    // RMS
-    if(m_normalize_volume)
-    {
-        auto frames = (size_t)audio->frames;
-        auto data = (float**)&audio->data;
-        while(frames > 0)
-        {
-            auto count = std::min(frames, (size_t)AUDIO_OUTPUT_FRAMES);
-            for(size_t i = 0u; i < count; ++i)
-            {
-                // sum only the largest sample of all channels from each time point
-                // this prevents excessive boosting when one channel is quiet (and reduces the amount of buffering required)
-                float val = 0.0f;
-                for(auto channel = 0u; channel < m_capture_channels; ++channel)
-                {
-                    auto buf = data[m_channel_base + channel];
-                    if(buf != nullptr)
-                        val = std::max(std::abs(buf[i]), val);
-                }
-                m_rms_temp_buf[i] = val * val;
-            }
-            circlebuf_push_back(&m_rms_sync_buf, m_rms_temp_buf.get(), count * sizeof(float));
-            frames -= count;
-        }
-
-        const size_t max_rms_size = (dtsamples * sizeof(float)) + (m_input_rms_size * sizeof(float));
-        auto total = m_rms_sync_buf.size;
-        if(total > max_rms_size)
-            circlebuf_pop_front(&m_rms_sync_buf, nullptr, total - max_rms_size);
-    }
-
-    auto sz = size_t(audio->frames * sizeof(float));
-    for(auto i = m_channel_base; i < (m_channel_base + (int)m_capture_channels); ++i)
-    {
-        auto j = i - m_channel_base;
-        assert((j == 0) || (j == 1));
-        if((muted && !m_ignore_mute) || (audio->data[i] == nullptr))
-            circlebuf_push_back_zero(&m_capturebufs[j], sz);
-        else
-            circlebuf_push_back(&m_capturebufs[j], audio->data[i], sz);
-
-        const size_t max_size = (dtsamples * sizeof(float)) + bufsz;
-        auto total = m_capturebufs[j].size;
-        if(total > max_size)
-            circlebuf_pop_front(&m_capturebufs[j], nullptr, total - max_size);
-    }
-}
-
-void WAVSource::capture_output_bus([[maybe_unused]] size_t mix_idx, const audio_data *audio)
-{
-    capture_audio(nullptr, audio, false);
-}
@@ -16,40 +16,49 @@
 */
 
 #pragma once
+#include <atomic>
+#include <limits>
 #include <mutex>
+#include <span>
+#include <string>
+#include <vector>
 #include <obs-module.h>
-#include <util/circlebuf.h>
 #include <graphics/vec3.h>
 #include <graphics/vec4.h>
 #include <fftw3.h>
 #include "module.hpp"
 #include "aligned_buffer.hpp"
+#include "buffer_arena.hpp"
+#include "capture_hub.hpp"
+#include "spectrum_cache.hpp"
+#include "fft_engine.hpp"
+#include "analysis_tables.hpp"
+#include "interp_layout.hpp"
+#include "sliding_dft.hpp"
+#include "goertzel.hpp"
+#include "loudness.hpp"
+#include "onset_detector.hpp"
+#include "iir_filterbank.hpp"
 #include "filter.hpp"
+#include "dsp_kernels.hpp"
+#include "triple_buffer.hpp"
+#include "profile_scope.hpp"
+#include "cost_histogram.hpp"
+#include "snapshot_export.hpp"
+#include "shm_export.hpp"
+#include "frame_recorder.hpp"
+#include "frame_playback.hpp"
+#include "gpu_fft.hpp"
+#include "gpu_envelope.hpp"
 
 using AVXBufR = AlignedBuffer<float>;
 using AVXBufC = AlignedBuffer<fftwf_complex>;
 
-enum class FFTWindow
-{
-    NONE,
-    HANN,
-    HAMMING,
-    BLACKMAN,
-    BLACKMAN_HARRIS,
-    POWER_OF_SINE
-};
-
-enum class InterpMode
-{
-    POINT,
-    LANCZOS,
-    CATROM
-};
-
 enum class FilterMode
 {
     NONE,
-    GAUSS
+    GAUSS,
+    RECURSIVE_GAUSS
 };
 
 // temporal smoothing
@@ -57,7 +66,8 @@ enum class TSmoothingMode
 {
     NONE,
     EXPONENTIAL,
-    TVEXPONENTIAL
+    TVEXPONENTIAL,
+    POWER           // exponential, on power instead of magnitude (no sqrt per bin)
 };
 
 enum class RenderMode
@@ -72,89 +82,314 @@ enum class RenderMode
 enum class PulseMode
 {
     MAGNITUDE,
-    FREQUENCY
+    FREQUENCY,
+    BEAT
 };
 
-enum class DisplayMode
+enum class LoudnessMode
 {
-    CURVE,
-    BAR,
-    STEPPED_BAR,
-    METER,
-    STEPPED_METER,
-    WAVEFORM
+    NONE,           // sample peak or RMS
+    MOMENTARY,
+    SHORT_TERM,
+    TRUE_PEAK
 };
 
 enum class ChannelMode
 {
     MONO,
     STEREO,
-    SINGLE
+    SINGLE,
+    SURROUND,
+    MID_SIDE    // stereo display of (L + R) / 2 and (L - R) / 2
 };
 
-class WAVSource
+// rolling cost of a callback, an exponential average over roughly the last 64 calls
+struct CallCost
 {
-protected:
-    // audio callback (and posssibly others) run in separate thread
-    // obs_source_remove_audio_capture_callback evidently flushes the callback
-    // so mutex must be recursive to avoid deadlock
-    std::recursive_timed_mutex m_mtx;
+    double avg_ns = 0.0;
+    uint64_t max_ns = 0;    // since the last structural update()
+    uint64_t calls = 0;
+    CostHistogram histogram;    // tails the average hides, kept across updates, see get_frame_times()
+
+    void add(uint64_t ns) noexcept
+    {
+        avg_ns += ((double)ns - avg_ns) * ((calls++ == 0) ? 1.0 : (1.0 / 64.0));
+        max_ns = std::max(max_ns, ns);
+        histogram.add(ns);
+    }
+};
+
+// events behind visual glitches, counted from whichever thread sees them, see get_health()
+// on a cache line of its own in the source, the other threads writing it would share it otherwise
+struct alignas(64) HealthCounters
+{
+    std::atomic<uint64_t> overflows = 0;    // capture ring overwrote unread audio, or stft hops were dropped to catch up
+    std::atomic<uint64_t> underruns = 0;    // less audio than the window needs, the last result is kept
+    std::atomic<uint64_t> resyncs = 0;      // waveform timestamp jumped to the captured audio
+    std::atomic<uint64_t> contended = 0;    // m_mtx or m_analysis_mtx was already held
+
+    static void count(std::atomic<uint64_t>& counter) noexcept { counter.fetch_add(1, std::memory_order_relaxed); }
+};
+
+// analysis output handed from the worker to tick(), everything prepare_display() reads of it
+// cache line aligned so the slot being written and the one on display never share a line
+struct alignas(64) AnalysisFrame
+{
+    AVXBufR values[2];          // m_decibels of the display channels
+    AVXBufR samples[2];         // GPU FFT, windowed input of each transformed channel, or the GPU waveform's sample ring
+    float meter[MAX_AUDIO_CHANNELS]{};  // m_meter_val
+    bool silent = false;        // m_last_silent
+    size_t head = 0;            // waveform mode, oldest column of the values ring
+    uint64_t written = 0;       // waveform mode, m_waveform_written the values are current with
+    size_t raw_head = 0;        // GPU waveform, oldest sample of the samples ring
+    uint64_t raw_written = 0;   // GPU waveform, m_waveform_raw_written the samples are current with
+    float raw_end = 0.0f;       // GPU waveform, m_waveform_raw_end
+    size_t points = 0;          // vectorscope mode, new sample pairs at the start of the values
+    uint64_t audio_ts = 0;      // timestamp of the newest sample analyzed, 0 without audio
+    uint64_t arrival_ts = 0;    // when that sample was captured, estimated
+    uint64_t beats = 0;         // OnsetDetector::beats()
+    float beat_period = 0.0f;   // OnsetDetector::period()
+};
+
+// gradient.effect handles, looked up once after the effect loads
+struct ShaderParams
+{
+    gs_eparam_t *color_base = nullptr;
+    gs_eparam_t *color_lut = nullptr;
+    gs_eparam_t *grad_center = nullptr;
+    gs_eparam_t *grad_height = nullptr;
+    gs_eparam_t *grad_offset = nullptr;
+
+    gs_eparam_t *graph_width = nullptr;
+    gs_eparam_t *graph_height = nullptr;
+    gs_eparam_t *graph_deadzone = nullptr;
+    gs_eparam_t *graph_invert = nullptr;
+    gs_eparam_t *radial_center = nullptr;
+    gs_eparam_t *radial_arc = nullptr;
+    gs_eparam_t *radial_rotation = nullptr;
+
+    gs_eparam_t *graph_values = nullptr;
+    gs_eparam_t *graph_base = nullptr;
+    gs_eparam_t *graph_points = nullptr;
+    gs_eparam_t *graph_center = nullptr;
+    gs_eparam_t *graph_bottom = nullptr;
+    gs_eparam_t *graph_step_limit = nullptr;
+    gs_eparam_t *step_width = nullptr;
+    gs_eparam_t *step_stride = nullptr;
+    gs_eparam_t *step_count = nullptr;
+    gs_eparam_t *cap_radius = nullptr;
+
+    gs_eparam_t *spectrogram_rows = nullptr;
+    gs_eparam_t *spectrogram_size = nullptr;
+    gs_eparam_t *spectrogram_offset = nullptr;
+    gs_technique_t *spectrogram = nullptr;
+
+    gs_eparam_t *scope_center = nullptr;
+    gs_eparam_t *scope_scale = nullptr;
+    gs_eparam_t *scope_intensity = nullptr;
+    gs_technique_t *vectorscope = nullptr;
+
+    // [CPU built, Geom, GeomSteps, GeomCaps][Solid, Gradient, Range, Radial, RadialGradient, RadialRange]
+    gs_technique_t *techs[4][6]{};
+
+    void load(gs_effect_t *effect);
+};
+
+class WAVSource final
+{
+private:
+    // audio is captured by the shared CaptureStream, which never takes this lock
+    // each lock starts a cache line, the tick and render threads contend for one, the analysis worker the other
+    alignas(64) std::mutex m_mtx;
+
+    // analysis state, held by analyze() on the worker, which never takes m_mtx
+    // taken after m_mtx when both are needed, tick() and render() never take it
+    // the capture ring has its own lock in CaptureStream, which the audio thread never takes
+    alignas(64) std::mutex m_analysis_mtx;
+
+    // what every analysis reads first, kept together after its lock, settings and render state are further down
+    uint64_t m_capture_ts = 0;  // timestamp of last audio callback in nanoseconds (latched by tick)
+    uint64_t m_audio_ts = 0;    // timestamp of the end of available audio in nanoseconds (latched by tick)
+    uint64_t m_tick_ts = 0;     // timestamp of last 'tick' in nanoseconds, as of the running analysis
+    uint64_t m_frame_ts = 0;    // video frame of the running analysis, what the caches are keyed on
+    uint64_t m_sync_ts = 0;     // what the audio is synced to, the frame's scheduled time so late ticks don't shift it
+    int64_t m_ts_offset = 0;    // audio sync offset in nanoseconds
+    size_t m_fft_size = 0;                  // number of fft elements, or audio samples in meter/waveform mode (not bytes, multiple of 16)
+                                            // in meter/waveform mode m_fft_size is the size of the circular buffer in samples
+    size_t m_stft_hop = 0;                  // samples between analysis frames, 0 for one frame per tick
+    size_t m_first_bin = 0;                 // bins the display reads, [first, last), 8 bin aligned
+    size_t m_last_bin = 0;
+    SpectrumBinsFn m_bins_fn[2][2]{};       // tick_spectrum per bin pass for the first frame of a tick and the frames after it, one channel or both
+    SpectrumPostFn m_post_fn = nullptr;     // tick_spectrum pass after the last frame
+    uint32_t m_fft_channels = 0;            // transforms per tick, batched into one plan
+    bool m_low_latency = false; // analyze the newest audio instead of syncing it to the video frame
+    bool m_show = true;         // shown or exported to, what the analysis goes by
+    bool m_last_silent = false; // graph was silent last frame
+    TripleBuffer<AnalysisFrame> m_frames;   // analyze() to tick()
+    const float *m_display_db[2]{};         // values of the front frame, what peak hold and prepare_display() read
+    const float *m_display_samples[2]{};    // windowed input of the front frame for the GPU FFT, sample ring for the GPU waveform
+    size_t m_display_raw_head = 0;          // GPU waveform, raw_head and raw_end of the front frame
+    float m_display_raw_end = 0.0f;
+    bool m_async_analysis = true;           // analyze() on AnalysisWorker, the display runs one analysis behind
+    float m_analysis_seconds = 0.0f;        // time not analyzed yet, while the last analysis is still running
+    float m_display_seconds = 0.0f;         // time since the last frame was acquired
+    bool m_join_analysis = true;            // render() waits for the analysis queued by tick() and displays it
+    bool m_join_pending = false;            // tick() queued an analysis render() has to wait for
+    uint32_t m_analysis_interval = 1;       // spectrum analyzed every this many video frames
+    uint32_t m_analysis_phase = 0;          // on frames where frame index % interval equals this, from AnalysisWorker
+    uint32_t m_preview_interval = 1;        // replaces m_analysis_interval when larger while the source isn't in program
+    uint32_t m_preview_phase = 0;
+    std::atomic<bool> m_active = false;     // in the program output, from the activate and deactivate callbacks
+    size_t m_min_hop = 0;                   // spectrum analysis waits for this many samples of new audio, 0 for every frame
+    AVXBufR m_tween_from[2];                // display values when the newest frame was acquired
+    AVXBufR m_tween[2];                     // blend toward the front frame, what m_display_db points at between analyses
+    AVXBufR m_waveform_display[2];          // waveform ring of the front frame unrolled oldest first
+    float m_tween_elapsed = 0.0f;           // display time since the newest frame was acquired
+    float m_tween_period = 0.0f;            // audio time between the newest frame and the one before it, the length of the blend
 
     // obs sources
     obs_source_t *m_source = nullptr;               // our source
     obs_weak_source_t *m_audio_source = nullptr;    // captured audio source
     std::string m_audio_source_name;
+    std::string m_audio_source_uuid;        // found first, the name is the fallback
 
     // audio capture
     obs_audio_info m_audio_info{};
-    circlebuf m_capturebufs[2]{};
+    CaptureReader m_capture;
+    size_t m_capture_lag = 0;               // samples held beyond the analysis window for sync offset and tick jitter
+    uint64_t m_capture_overruns = 0;        // last reported CaptureReader::overrun_samples()
     uint32_t m_capture_channels = 0;        // audio input channels
     uint32_t m_output_channels = 0;         // fft output channels (*not* display channels)
-    bool m_output_bus_captured = false;     // do we have an active audio output callback? (via audio_output_connect())
+    bool m_output_bus_captured = false;     // are we subscribed to the output bus stream?
+
+    // view of another source's analysis, it stands in for the capture
+    bool m_view = false;                    // maps and draws m_parent's published spectrum or meter, no capture or transform here
+    std::string m_parent_name;
+    obs_weak_source_t *m_parent = nullptr;  // under m_analysis_mtx
+    float m_parent_retry = 0.0f;            // seconds until the next lookup of a missing parent
+    uint64_t m_parent_sequence = 0;         // spectrum snapshot last copied
+    alignas(64) std::atomic<size_t> m_view_fft_size = 0; // transform size of the parent as last seen, tick() re-runs update() on a change
+    std::atomic<bool> m_published_view = false; // m_view as of the last update(), views never take a view as their parent
+    std::atomic<bool> m_update_pending = false; // structural settings changed, tick() rebuilds from the current settings
+    std::atomic<bool> m_built = false;          // update() has built the source once, nothing runs before that
+    static constexpr unsigned int MAX_REBUILDS_PER_FRAME = 4; // across all sources, the rest wait for the next frames
+
+    // a slider drag pushes settings every frame, a built source rebuilds once they settle
+    // or at the latest every UPDATE_MAX_DELAY while they keep changing, so the drag still previews
+    std::atomic<uint64_t> m_update_first_ns = 0;    // first request since the last rebuild
+    std::atomic<uint64_t> m_update_last_ns = 0;     // newest request
+    static constexpr uint64_t UPDATE_IDLE = 150000000;         // 150 ms in ns
+    static constexpr uint64_t UPDATE_MAX_DELAY = 500000000;    // 500 ms in ns
+
+    // a view of a recording instead of a parent, it takes precedence
+    std::string m_playback_path;
+    FramePlayback m_playback;                       // under m_analysis_mtx
+    obs_weak_source_t *m_playback_clock = nullptr;  // under m_analysis_mtx, media source the recording follows
+    double m_playback_elapsed = 0.0;                // seconds into the loop without a media source
+    int64_t m_playback_offset = 0;                  // ns, positive plays ahead
+    bool m_playback_warned = false;                 // logged once per file that its frames don't fit the mode
+    std::vector<float> m_playback_values[2];        // under m_analysis_mtx, decoded frame
 
     // 32-byte aligned buffers for FFT/AVX processing
+    BufferArena m_arena;                    // holds the buffers update() sizes together, see update()
     AVXBufR m_fft_input;
     AVXBufC m_fft_output;
-    fftwf_plan m_fft_plan{};
-    AVXBufR m_window_coefficients;
+    FFTEngine m_fft;
     AVXBufR m_tsmooth_buf[2];               // last frames magnitudes
     AVXBufR m_decibels[2];                  // dBFS, or audio sample buffer in meter mode
-    size_t m_fft_size = 0;                  // number of fft elements, or audio samples in meter/waveform mode (not bytes, multiple of 16)
-                                            // in meter/waveform mode m_fft_size is the size of the circular buffer in samples
+    AVXBufR m_peak_db[2];                   // held peaks of m_decibels
+    AVXBufR m_peak_timer[2];                // seconds left before each peak starts falling
+    bool m_stft_peak = true;                // combine the frames of a tick by peak instead of average
+    bool m_sliding_dft = false;             // sliding DFT over the cutoff band instead of the FFT
+    bool m_bin_window = false;              // window as a convolution of the bins when it is a cosine sum
+    bool m_power_bands = false;             // bars average linear power, m_decibels holds power until interp_bars()
+    std::vector<float> m_window_taps;       // set when it is, the input then goes to the FFT unwindowed
+    static constexpr size_t MAX_WINDOW_TAPS = 8;
+    SlidingDFT m_sdft[2];
+    bool m_multires = false;                // decimated FFT for the bass, quarter size FFT for the rest
+    bool m_decimate = false;                // decimate down to the high cutoff, always toward HIGH_RATE_REFERENCE above it
+    size_t m_decimation = 1;                // analysis rate divider, MULTIRES_FACTOR in multiresolution mode
+    AVXBufR m_decimated_input;              // per channel, decimated input then in multires mode the newest full rate samples
+    AVXBufC m_decimated_output;
+    std::vector<float> m_decimator;         // lowpass taps for the decimated band
+    GoertzelBank m_goertzel;                // pruned analysis of only the bins the bar layout reads
+    bool m_beat_detection = false;          // spectral flux onsets and tempo, history is kept even without smoothing
+    OnsetDetector m_onset;                  // under m_analysis_mtx
+    float m_onset_flux[2] = {};             // SpectrumBins::flux of the current frame
 
     // meter mode
-    size_t m_meter_pos[2] = { 0, 0 };       // circular buffer position (per channel)
-    float m_meter_val[2] = { 0.0f, 0.0f };  // dBFS
-    float m_meter_buf[2] = { 0.0f, 0.0f };  // EMA
+    AVXBufR m_meter_window;                 // circular buffer of the last m_fft_size sample frames, channels interleaved m_meter_lanes apart
+    uint32_t m_meter_lanes = 1;             // m_capture_channels rounded up to 1, 2, 4 or 8, the unused lanes stay 0
+    size_t m_meter_pos = 0;                 // circular buffer position in frames, shared by every channel
+    double m_meter_sum[MAX_AUDIO_CHANNELS]{};   // running sum of squares over the circular buffer, RMS only
+    std::vector<float> m_meter_peaks;       // max tree over METER_BLOCK frame peaks of the circular buffer, root at 1, m_meter_lanes per node, peak only
+    size_t m_meter_leaves = 0;              // leaf count of m_meter_peaks, power of 2
+    float m_meter_val[MAX_AUDIO_CHANNELS]{};    // dBFS
+    float m_meter_buf[MAX_AUDIO_CHANNELS]{};    // EMA
     bool m_meter_rms = false;               // RMS mode
+    bool m_meter_all_channels = false;      // setting, one meter per channel of the source instead of the first two
+    LoudnessMode m_loudness_mode = LoudnessMode::NONE;
+    LoudnessMeter m_loudness;               // fed from the meter ring as it fills, not LoudnessMode::NONE
     bool m_meter_mode = false;              // either meter or stepped meter display mode is selected
     int m_meter_ms = 100;                   // milliseconds of audio data to buffer
 
     // waveform
     size_t m_waveform_samples = 0;          // maximum number of input samples to buffer in waveform mode
     size_t m_waveform_ts = 0;               // timestamp of next sample in nanoseconds
+    size_t m_waveform_head = 0;             // oldest column of the m_decibels ring
+    uint64_t m_waveform_written = 0;        // columns written to the ring so far, frames copy only what changed since their last fill
+    uint64_t m_waveform_step_ns = 0;        // nanoseconds per column
+    uint64_t m_waveform_phase_step = 0;     // audio frames per column, 32.32 fixed point
+    AVXBufR m_waveform_raw[2];              // GPU waveform, consumed samples of each capture channel, a ring of the window and a margin
+    size_t m_waveform_raw_head = 0;         // oldest sample of the rings
+    uint64_t m_waveform_raw_written = 0;    // samples written to the rings so far, frames copy only what changed since their last fill
+    float m_waveform_raw_end = 0.0f;        // end of the newest column in samples after the newest one in the rings
+    size_t m_waveform_quiet[2]{};           // zero samples at the end of each ring, silent once it covers the ring
+    float m_scope_level = 0.0f;             // rising edge trigger of the oscilloscope, linear
+    size_t m_scope_points = 0;              // vectorscope, sample pairs of this tick at the start of m_decibels
+    float m_scope_decay = 0.2f;             // vectorscope, seconds for the trace to fade to 1/e
+    float m_afterglow = 0.0f;               // seconds for the trail of earlier frames to fade to 1/e, 0 without one
+
+    // audio rate as fixed point multipliers, set with m_audio_info so the ticks convert without 64-bit divisions
+    static constexpr unsigned int FRAMES_PER_NS_BITS = 32;
+    static constexpr unsigned int NS_PER_FRAME_BITS = 24;
+    uint64_t m_frames_per_ns = 0;           // audio frames per nanosecond, 32.32, rounded up so whole seconds come out exact
+    uint64_t m_ns_per_frame = 0;            // nanoseconds per audio frame, 40.24
 
     // video fps
     double m_fps = 0.0;
 
+    // OBS output format polling, see check_output_format()
+    float m_format_timer = 0.0f;
+    static constexpr float FORMAT_CHECK_INTERVAL = 1.0f;  // seconds
+
     // video size
     unsigned int m_width = 800;
     unsigned int m_height = 225;
+    bool m_headless = false;    // analysis for the exports only, nothing is drawn and the size is 0
 
     // show video source
-    bool m_show = true;
+    bool m_visible = true;      // shown according to OBS
+    alignas(64) std::atomic<uint64_t> m_export_demand_ts = 0;   // last snapshot request from any thread, a consumer keeps a hidden source analyzing
+    float m_hidden_seconds = 0.0f;  // since hide(), the capture is released after PARK_DELAY
+    bool m_parked = false;          // capture released while hidden, show() gets it back
+    bool m_dormant = false;         // settled on silence, only the capture side is watched until audio returns
 
-    // graph was silent last frame
-    bool m_last_silent = false;
+    bool m_display_silent = false;  // m_last_silent for the frame on display
 
-    // audio capture retries
+    // silent and settled, tick() skipped prepare_display() and render() blits m_cache
+    bool m_idle = false;
+
+    // beat pulse, display side of m_onset
+    uint64_t m_display_beats = 0;   // AnalysisFrame::beats of the frame on display
+    float m_beat_elapsed = std::numeric_limits<float>::infinity(); // seconds since it last changed
+    float m_beat_period = 0.0f;
+
+    // audio capture retries, a named source is looked up again only when AudioSourceList::generation() moves
     int m_retries = 0;
-    float m_next_retry = 0.0f;
+    float m_next_retry = 0.0f;      // output bus only
+    uint64_t m_source_gen = 0;      // AudioSourceList::generation() at the last lookup
 
-    uint64_t m_capture_ts = 0;  // timestamp of last audio callback in nanoseconds
-    uint64_t m_audio_ts = 0;    // timestamp of the end of available audio in nanoseconds
-    uint64_t m_tick_ts = 0;     // timestamp of last 'tick' in nanoseconds
-    int64_t m_ts_offset = 0;    // audio sync offset in nanoseconds
 
     // settings
     RenderMode m_render_mode = RenderMode::SOLID;
@@ -171,14 +406,20 @@ protected:
     int m_cutoff_high = 24000;
     int m_floor = -120;
     int m_ceiling = 0;
+    bool m_auto_range = false;
+    int m_range_floor = -120;   // displayed range, m_floor and m_ceiling or percentiles of m_range_hist
+    int m_range_ceiling = 0;
     float m_gravity = 0.0f;
     float m_grad_ratio = 1.0f;
     int m_range_middle = -20;
     int m_range_crest = -9;
     bool m_fast_peaks = false;
+    bool m_half_history = false;            // m_tsmooth_buf holds fp16, AVX2 and up
     vec4 m_color_base{ {{1.0, 1.0, 1.0, 1.0}} };
     vec4 m_color_middle{ {{1.0, 1.0, 1.0, 1.0}} };
     vec4 m_color_crest{ {{1.0, 1.0, 1.0, 1.0}} };
+    static constexpr uint32_t COLOR_LUT_SIZE = 1024;
+    std::vector<uint32_t> m_color_lut;      // RGBA8 texels of the gradient, range or spectrogram colors, see bake_color_lut()
     float m_slope = 0.0f;
     bool m_log_scale = true;
     bool m_mirror_freq_axis = false;
@@ -195,34 +436,57 @@ protected:
     bool m_rounded_caps = false;
     bool m_hide_on_silent = false;
     int m_channel_spacing = 0;
+    bool m_downmix = false;         // sum to mono before the FFT
+    uint32_t m_mix_channels = 0;    // channels subscribed to, more than m_capture_channels when mixing surround
+    float m_mix_weights[MAX_AUDIO_CHANNELS]{};
+    float m_center_weight = 0.707f; // surround mix weights, relative to the front pair
+    float m_lfe_weight = 0.0f;
+    float m_surround_weight = 0.707f;
     float m_rolloff_q = 0.0f;
     float m_rolloff_rate = 0.0f;
     bool m_normalize_volume = false;
     float m_volume_target = -3.0f;  // volume normalization target
     float m_max_gain = 30.0f;       // maximum volume normalization gain
     int m_min_bar_height = 0;
+    bool m_peak_hold = false;
+    float m_peak_hold_time = 1.0f;  // seconds
+    float m_peak_fall_rate = 20.0f; // dB per second
+    AlignedBuffer<float> m_peak_bars[2];    // m_interp_size when peak hold is on
     int m_channel_base = 0; // channel to use in single channel mode
     bool m_ignore_mute = false;
+    size_t m_output_track = 0;  // output bus mix index
     int m_sine_exponent = 2;
 
-    // interpolation
-    std::vector<float> m_interp_indices;
-    std::vector<float> m_interp_bufs[3];    // third buffer used as intermediate for gauss filter
-    std::vector<int> m_band_widths;         // size of the band each bar represents
+    // temporal smoothing of the display points instead of the bins, m_tsmoothing is NONE while active
+    TSmoothingMode m_display_tsmoothing = TSmoothingMode::NONE;
+    AlignedBuffer<float> m_display_history[2];  // linear magnitude (or power) of each display point
 
-    // roll-off
-    AVXBufR m_rolloff_modifiers;
+    // interpolation
+    std::shared_ptr<const InterpLayout> m_interp = InterpLayout::none(); // display point positions and their kernel, set by init_interp()
+    AlignedBuffer<float> m_interp_bufs[3];  // third buffer used as intermediate for gauss filter
+    BufferArena m_display_arena;            // holds m_interp_bufs, m_display_history and m_peak_bars
+    size_t m_interp_size = 0;               // display points in each interp buffer, fixed in update()
+    unsigned int m_curve_points = 0;        // setting, spline control points of a curve, 0 for one per column
+    bool m_spline = false;                  // m_interp_size control points of a curve on the texture driven path, the vertex shader draws the spline
+    std::vector<float> m_waveform_buf;      // popped samples for waveform mode
+    std::vector<double> m_band_prefix;      // running sum for bar interpolation
+    float m_render_miny = 0.0f;             // topmost display point and its index, for the shader
+    unsigned int m_render_minpos = 0;
+    BandScale m_band_scale = BandScale::NONE;
+    unsigned int m_iir_fraction = 0;        // bars from the IIR filterbank instead of the FFT, 1 for octaves 3 for third octaves, 0 off
+    IIRFilterbank m_iir;                    // under m_analysis_mtx, m_decibels holds one value per band
+    AlignedBuffer<float> m_iir_input;       // IIR_CHUNK samples popped from the capture (or their downmix)
+    size_t m_iir_window = 0;                // capture history kept for the filterbank, anything older is dropped
+
+    // window and per bin gains, built off the UI thread
+    std::shared_ptr<const AnalysisTables> m_analysis;   // requested by update()
+    const AnalysisTables *m_tables = nullptr;           // m_analysis once it's ready, all tick_spectrum() reads
 
     // gaussian filter
     Kernel<float> m_kernel;
+    RecursiveGauss<float> m_recursive_gauss;
     float m_filter_radius = 0.0f;
 
-    // lanczos filter
-    Kernel<float> m_interp_kernel;
-
-    // slope
-    AVXBufR m_slope_modifiers;
-
     // rounded caps
     float m_cap_radius = 0.0f;
     int m_cap_tris = 4;             // number of triangles each cap is composed of (4 min)
@@ -233,69 +497,390 @@ protected:
 
     // render vars
     gs_effect_t *m_shader = nullptr;
-    gs_vertbuffer_t *m_vbuf = nullptr;
+    ShaderParams m_params;
+    bool m_shader_dirty = true;     // uniforms that only change with settings need setting
+    std::string m_structure_key;    // settings and audio format everything was built for, see update()
+    static constexpr auto RENDER_RING = 3u; // buffers rotated per upload
+    static constexpr float VECTORSCOPE_INTENSITY = 0.25f; // coverage of one point, overlapping points saturate
+    gs_vertbuffer_t *m_vbuf[RENDER_RING]{}; // both channels, only the first when the mesh is static
+    unsigned int m_ring_pos = 0;    // buffer holding the latest data
+    uint32_t m_vbuf_stride = 0;     // first vertex of channel 1
+    uint32_t m_vbuf_verts[2]{};     // vertices written for each channel
+    uint64_t m_vbuf_gen = 0;        // m_display_gen the buffer was written at
+    unsigned int m_vbuf_lod = 0;    // render_lod() the buffer was written at
+
+    // level of detail of the CPU meshes, views drawn small skip what they can't resolve
+    float m_render_scale = 1.0f;    // screen pixels per source pixel of the current render(), 1 inside our own targets
+    static constexpr unsigned int MAX_CURVE_LOD = 8;    // columns merged into one curve vertex at most
+    static constexpr float LOD_DETAIL_PIXELS = 2.0f;    // caps and steps narrower than this on screen are left out
+
+    // everything the mesh is built from, create_vbuf() keeps the buffers while it stays the same
+    // num_verts is 0 while no mesh is kept
+    struct MeshLayout
+    {
+        size_t num_verts = 0;
+        DisplayMode display_mode = DisplayMode::CURVE;
+        RenderMode render_mode = RenderMode::LINE;
+        bool gpu_geometry = false;
+        bool stereo = false;
+        bool radial = false;
+        bool caps = false;
+        bool peak_hold = false;
+        unsigned int width = 0;
+        unsigned int height = 0;
+        size_t interp_size = 0;
+        int num_bars = 0;
+        int bar_width = 0;
+        int bar_gap = 0;
+        int channel_spacing = 0;
+        unsigned int columns = 0;
+        float cap_radius = 0.0f;
+
+        bool operator==(const MeshLayout&) const = default;
+    };
+    MeshLayout m_mesh_layout;
+    uint64_t m_display_gen = 1;     // bumped every time prepare_display() runs
+    bool m_gpu_geometry = false;    // static mesh placed by the vertex shader from m_value_tex
+    gs_texture_t *m_value_tex[RENDER_RING]{}; // display values, one row per channel and one texel per column or bar
+    bool m_gpu_fft = false;         // experimental, analysis stops at the windowed input and m_gpu_analysis fills graph_values
+    GpuFFT m_gpu_analysis;
+    bool m_gpu_waveform = false;    // experimental, waveform mode keeps the raw samples and m_gpu_envelope fills graph_values
+    GpuEnvelope m_gpu_envelope;
+    gs_texrender_t *m_cache = nullptr; // last graph drawn while idle, premultiplied alpha
+    gs_texture_t *m_color_lut_tex = nullptr; // m_color_lut, uploaded with the other uniforms
+    uint64_t m_cache_gen = 0;       // m_display_gen m_cache was drawn at
+    gs_texrender_t *m_glow_target = nullptr; // afterglow, the last output faded under each new frame
+    float m_glow_fade = 1.0f;       // brightness the trail keeps at its next draw
+    uint64_t m_glow_gen = 0;        // m_display_gen drawn into m_glow_target
+    bool m_glow_clear = true;
+    size_t m_gpu_bytes = 0;         // vertex buffers and value textures made by create_vbuf()
+
+    // spectrogram, history rows stay on the GPU and only the newest row is uploaded
+    gs_texture_t *m_spectrogram_row = nullptr;      // newest row, one texel per column
+    gs_texrender_t *m_spectrogram_rows = nullptr;   // history ring, one row per pixel of height
+    uint32_t m_spectrogram_pos = 0;                 // row of the newest values, older rows follow below it
+    uint64_t m_spectrogram_gen = 0;                 // m_display_gen of the newest row
+    bool m_spectrogram_clear = true;                // history needs clearing before the next row
+    gs_texrender_t *m_scope_target = nullptr;       // vectorscope accumulation, faded and added to per new frame
+    size_t m_display_points = 0;                    // AnalysisFrame::points of the frame on display
+    float m_scope_fade = 1.0f;                      // brightness the accumulation keeps at its next draw
+    uint64_t m_scope_gen = 0;                       // m_display_gen drawn into the accumulation
+    bool m_scope_clear = true;
+
+    // accounting, see get_stats()
+    CallCost m_tick_cost;
+    CallCost m_render_cost;
+    CallCost m_analysis_cost;       // under m_analysis_mtx
+    CallCost m_kernel_cost;         // tick_spectrum, tick_meter or tick_waveform alone, under m_analysis_mtx, reset with the structure
+    CallCost m_lock_wait;           // waits for m_mtx in tick() and render()
+    CallCost m_analysis_wait;       // waits for m_analysis_mtx in analyze()
+    bool m_log_stats = false;       // log them every STATS_LOG_INTERVAL seconds
+    HealthCounters m_health;
+
+    // analysis shared with other plugins, see waveform_api.h
+    SnapshotExport m_spectrum_export;       // published by publish_frame()
+    SnapshotExport m_bands_export;          // published by prepare_bars(), dB before the pixel mapping
+    std::vector<float> m_export_freqs;      // under m_analysis_mtx, publish_frame() scratch
+    std::vector<float> m_export_db[2];      // under m_analysis_mtx, publish_frame() scratch, bins in dB when they hold power
+    std::vector<float> m_shm_bins[2];       // under m_mtx, export_shared_frame() scratch, same
+    std::vector<float> m_export_bands[2];   // under m_mtx, prepare_bars() scratch
+    SharedMemoryExport m_shm_export;        // under m_mtx, written by display_frame()
+    std::string m_shm_name;                 // last name m_shm_export was asked to open, a failed one isn't retried
+    FrameRecorder m_recorder;               // under m_mtx, fed by display_frame()
+    std::string m_record_path;              // last path m_recorder was asked to open, same
+    std::shared_ptr<CaptureLog> m_capture_log;          // under both locks, fed by the capture stream and tick()
+    std::weak_ptr<CaptureStream> m_capture_log_stream;  // stream the log is bound to
+    std::vector<float> m_record_hz;         // under m_mtx, record_frame() scratch
+
+    // envelope follower signalled every tick, levels 0 at the floor to 1 at the ceiling
+    bool m_envelope = false;
+    float m_envelope_attack = 0.01f;            // seconds
+    float m_envelope_release = 0.3f;
+    float m_envelope_level = 0.0f;              // under m_mtx, overall
+    std::vector<float> m_envelope_bands;        // under m_mtx, per bar or meter channel
+    std::vector<float> m_envelope_signal;       // tick thread only, copied out of the lock for the handlers
+
+    // auto range, decayed weight of the displayed levels in 1 dB bins from AUTO_RANGE_LOW
+    // each tick adds a total weight of 1 - decay, so old levels fade out over AUTO_RANGE_TIME
+    static constexpr int AUTO_RANGE_LOW = -150;
+    static constexpr int AUTO_RANGE_BINS = 160;         // up to +10 dBFS
+    static constexpr float AUTO_RANGE_TIME = 3.0f;      // seconds
+    static constexpr float AUTO_RANGE_FLOOR = 0.05f;    // fraction of the levels below the floor
+    static constexpr float AUTO_RANGE_CEILING = 0.995f; // below the ceiling
+    static constexpr int AUTO_RANGE_HEADROOM = 3;       // dB above the ceiling percentile
+    static constexpr int AUTO_RANGE_MIN_SPAN = 24;      // dB
+    float m_range_hist[AUTO_RANGE_BINS] = {};           // under m_mtx
+    float m_range_weight = 0.0f;                        // sum of m_range_hist
+    uint64_t m_health_logged[4] = {};   // m_health at the last stats log, tick thread only
+
+    // audio to pixel latency of each new analysis at its first render, logged every STATS_LOG_INTERVAL seconds
+    bool m_log_latency = false;
+    bool m_latency_pending = false;             // a new analysis was displayed and not rendered yet
+    uint64_t m_display_audio_ts = 0;            // AnalysisFrame::audio_ts of the displayed analysis
+    uint64_t m_display_arrival_ts = 0;          // AnalysisFrame::arrival_ts
+    std::vector<float> m_latency_samples[2];    // ms, arrival to render and video frame time to audio time
+    float m_latency_timer = 0.0f;
+    static constexpr size_t MAX_LATENCY_SAMPLES = 4096;
+
+    // Tracy plots named after the source when it was created, all nullptr without WAVEFORM_TRACY
+    struct
+    {
+        const char *tick = nullptr;
+        const char *render = nullptr;
+        const char *analysis = nullptr;
+        const char *lock_wait = nullptr;        // m_mtx, tick() and render()
+        const char *analysis_wait = nullptr;    // m_analysis_mtx
+        const char *capture_fill = nullptr;     // samples buffered in the first channel after latching
+        const char *silent = nullptr;           // m_last_silent after each analysis
+    } m_plots;
+    float m_stats_timer = 0.0f;
+    static constexpr float STATS_LOG_INTERVAL = 10.0f;
+
+    // cpu budget governor, analysis plus render time per frame against m_cpu_budget
+    float m_cpu_budget = 0.0f;      // ms, 0 for no limit
+
+    // deep sleep, a source hidden for m_sleep_timeout seconds drops everything but its settings
+    float m_sleep_timeout = 0.0f;   // 0 never sleeps
+    float m_sleep_seconds = 0.0f;   // hidden time toward it, tick thread only
+    bool m_asleep = false;          // tick thread only, released by deep_sleep() and waiting to be rebuilt
+    int m_quality_level = 0;        // steps taken down, see apply_quality_level(), part of the structure key
+    float m_governor_timer = 0.0f;  // tick thread only
+    float m_governor_calm = 0.0f;   // seconds spent well under budget, tick thread only
+    static constexpr int MAX_QUALITY_LEVEL = 6;
+    static constexpr float GOVERNOR_INTERVAL = 3.0f;    // seconds between checks, lets the cost averages settle
+    static constexpr float GOVERNOR_HEADROOM = 0.5f;    // fraction of the budget to go under before stepping back up
+    static constexpr float GOVERNOR_RECOVERY = 15.0f;   // seconds under that before each step up
 
     // volume normalization
     float m_input_rms = 0.0f;
     AVXBufR m_input_rms_buf;
-    AVXBufR m_rms_temp_buf;     // temp buffer, bit too large for stack
-    circlebuf m_rms_sync_buf{}; // A/V syncronization buffer
+    CaptureReader m_rms_capture; // separate read position for A/V syncronization
     size_t m_input_rms_size = 0;
     size_t m_input_rms_pos = 0;
+    double m_input_rms_sum = 0.0;   // running sum of m_input_rms_buf
+
+    unsigned int graph_width() const;   // size from the current settings, lock must be held
+    unsigned int graph_height() const;
 
-    // FFT window
-    float m_window_sum = 1.0f;
+    // graph_width() and graph_height() as of the last update(), what OBS sees without taking the lock
+    std::atomic<unsigned int> m_published_width = 0;
+    std::atomic<unsigned int> m_published_height = 0;
 
     void create_vbuf();
+    MeshLayout mesh_layout(size_t num_verts) const;
+    unsigned int curve_columns() const;
+    float spline_scale() const;         // control points per pixel of a spline curve
+    size_t fill_geometry(gs_vb_data *vbdata, unsigned int channel, bool curve, size_t start);
 
     void get_settings(obs_data_t *settings);
+    void get_live_settings(obs_data_t *settings);   // the part of get_settings() update() can apply in place
+    void bake_color_lut();                  // m_color_lut from the colors, range levels and display mode
+    void upload_color_lut();                // graphics context, m_color_lut to color_lut
+    std::string get_structure_key(obs_data_t *settings) const;
 
     void recapture_audio();
     void release_audio_capture();
+    void bind_capture_log();                // hand m_capture_log to the stream we read
+    void close_capture_log();
+    bool park_audio_capture(float seconds);  // release the capture while hidden, false while it is released
     bool check_audio_capture(float seconds); // check if capture is valid and retry if not
+    bool capture_silent() const;            // nothing but silence in the capture up to the latched position
+    bool can_be_dormant() const;            // nothing on display moves while the analysis stays silent
+    bool check_output_format(float seconds); // true if the audio format or the fps used for sizing changed since update()
+    bool govern_quality(float seconds);     // true if the cpu budget governor changed m_quality_level
+    bool check_view_layout();               // true if the parent of a view changed its transform size since update()
+    void apply_quality_level();             // step the spectrum settings down to m_quality_level, in update()
     void free_bufs();
+    bool export_demanded() const;           // a snapshot was requested within EXPORT_DEMAND_TIMEOUT
+    bool check_sleep(float seconds);        // true if the source just went to sleep
+    void deep_sleep();                      // release everything update() rebuilds, keep the settings
+
+    void update_fft_plan();     // swap in a measured plan once one is available
+    size_t get_stft_frames(size_t dtsize);  // analysis frames available this tick
+    std::vector<double> window_taps() const;
+    void init_sliding_dft();
+    void init_bin_window();
+    void window_bins(fftwf_complex *bins) const;    // m_window_taps over [m_first_bin, m_last_bin) of one transform
+    void mid_side_bins();                           // left and right transforms to mid and side over [m_first_bin, m_last_bin)
+    void init_decimation();
+    void decimated_transform(const bool *transform);
+    // without multires the decimated bins line up with the first bins of the full size layout
+    // they are read where the transform wrote them, m_fft_output isn't allocated
+    bool direct_decimation() const { return (m_decimation > 1) && !m_multires; }
+    // waveform, scope and vectorscope analyze samples instead of bins, the first two draw through the curve renderer
+    bool time_domain() const noexcept { return (m_display_mode == DisplayMode::WAVEFORM) || (m_display_mode == DisplayMode::SCOPE) || (m_display_mode == DisplayMode::VECTORSCOPE); }
+    bool curve_display() const noexcept { return (m_display_mode == DisplayMode::CURVE) || (m_display_mode == DisplayMode::WAVEFORM) || (m_display_mode == DisplayMode::SCOPE); }
+    const fftwf_complex *transform_output(uint32_t channel) const;
+    void init_pruning();
+    void init_active_bins();
+    void advance_stft_frame();  // consume one hop
+    void detect_onset(float frame_seconds);    // feed m_onset_flux of the frame to m_onset
+    SpectrumBins bins_args(uint32_t channel, float frame_seconds);  // m_bins_fn input for one transformed channel
+    void process_bins(const bool *transform, uint32_t *combined, float frame_seconds); // m_bins_fn over the transformed channels of a frame
+    SpectrumPost post_args(const uint32_t *combined);  // m_post_fn input, combined is the frame count per channel
+    void latch_capture();       // take a consistent snapshot of the capture state
+    void trim_capture_bufs();   // drop captured audio older than the next tick could use
 
     bool sync_rms_buffer();
 
+    SpectrumKey get_spectrum_key() const;   // identifies sources whose spectra are interchangeable
+    TransformKey get_transform_key() const; // identifies sources whose FFT input is interchangeable
+    bool share_transform() const;           // the tick's transform can go through TransformCache
+    bool fetch_transform(bool silent[2]);   // m_fft_output from a source with the same input this frame
+    void publish_transform(const bool transform[2], const bool silent[2]);
+
     void init_interp(unsigned int sz);
-    void init_rolloff();
+    size_t buffer_bytes() const;            // memory held by this source, shared streams and tables excluded
+    void request_tables();                  // window and bin gains for the current settings, see m_analysis
     void init_steps();
 
+    void analyze(float seconds, uint64_t ts, uint64_t frame_ts);   // capture to m_decibels, published to m_frames
+    void display_frame(float seconds);      // prepare_display() from the newest frame, if there is one
+    bool tween_frames() const;              // analyses come less often than frames, blend between them
+    uint32_t analysis_interval() const;     // m_analysis_interval or m_preview_interval outside program
+    bool skip_analysis(uint64_t frame_ts, float elapsed) const; // true on frames left to other phases of m_analysis_interval or short of m_min_hop
+    void publish_frame();                   // copy what the display reads of the analysis to m_frames
+    void unroll_waveform();                 // point m_display_db at the front waveform ring unrolled oldest first
+    void append_raw(uint32_t channel, size_t count);    // GPU waveform, the first count samples of m_waveform_buf into the channel's ring at m_waveform_raw_head
+    void reset_frames();                    // size m_frames for the current settings and fill them from m_decibels
+    void prepare_display(float seconds);    // display arrays for render(), once per tick, 0 seconds doesn't advance smoothing
+    void prepare_curve(float seconds);
+    void prepare_bars(float seconds);
+    void smooth_display(float seconds, float *values, float *history, size_t count);
+    void get_bar_borders(float& border_top, float& border_bottom) const;
     void render_curve(gs_effect_t *effect);
+    void interp_bars(const float *bins, AlignedBuffer<float>& out);
     void render_bars(gs_effect_t *effect);
+    void render_geometry(gs_effect_t *effect);
+    void render_spectrogram(gs_effect_t *effect);
+    void render_vectorscope(gs_effect_t *effect);
+    void render_afterglow(gs_effect_t *effect);
+    void render_graph(gs_effect_t *effect);
 
     gs_technique_t *get_shader_tech();
     void set_shader_vars(float cpos, float miny, float minpos, float channel_offset, float border_top, float border_bottom);
-
-    virtual void update_input_rms() = 0;    // update RMS window
-
-    virtual void tick_spectrum(float) = 0;  // process audio data in frequency spectrum mode
-    virtual void tick_meter(float) = 0;     // process audio data in meter mode
-    virtual void tick_waveform(float) = 0;  // process audio data in waveform mode
+    float view_scale() const;           // estimate of m_render_scale from the transform and viewport
+    unsigned int render_lod() const;    // curve columns per vertex, or 0 for full bars and 1 for plain bars
+
+    void update_input_rms();                // update RMS window
+
+    void select_spectrum_kernels();          // pick the tick_spectrum passes of DSPKernels for the current settings
+    void tick_spectrum(float seconds);      // process audio data in frequency spectrum mode
+    void fill_meter_window(size_t dtsize);  // move audio up to dtsize before the sync point into the meter ring
+    void reset_meter_window();              // clear the running sums and peaks after the ring is zeroed
+    void tick_iir_bands(float seconds);     // run every sample up to the sync point through m_iir, band levels into m_decibels
+    void tick_view(float seconds);          // copy the newest analysis m_parent published
+    void copy_view_spectrum(const waveform_snapshot *snapshot);
+    void tick_playback(float seconds);      // copy the frame of m_playback at the media position
+    void warn_playback(const char *reason);
+    void silence_view();                    // DB_MIN everywhere, once, while there's nothing to copy
+    float meter_rms(uint32_t channel) const // RMS of the meter ring from the running sum
+    {
+        return std::sqrt((float)(std::max(m_meter_sum[channel], 0.0) / (double)m_fft_size));
+    }
+    float meter_peak(uint32_t channel) const // peak of the meter ring from the block tree
+    {
+        return m_meter_peaks.empty() ? 0.0f : m_meter_peaks[m_meter_lanes + channel];
+    }
+    float meter_level(uint32_t channel) const // linear level the meter shows for the current mode
+    {
+        switch(m_loudness_mode)
+        {
+        case LoudnessMode::MOMENTARY:
+            return m_loudness.momentary();
+        case LoudnessMode::SHORT_TERM:
+            return m_loudness.short_term();
+        case LoudnessMode::TRUE_PEAK:
+            return m_loudness.true_peak(channel);
+        default:
+            return m_meter_rms ? meter_rms(channel) : meter_peak(channel);
+        }
+    }
+    void tick_meter(float seconds);         // process audio data in meter mode
+    void tick_waveform(float seconds);      // process audio data in waveform mode
+    void waveform_post(size_t pos, size_t count); // DSPKernels::waveform_post of new columns
+    void tick_scope(float seconds);         // process audio data in scope mode
+    void tick_vectorscope(float seconds);   // process audio data in vectorscope mode
+    void tick_peak_hold(float seconds);     // update held peaks from m_decibels
+    const char *kernel_name() const noexcept;
+    static float percentile(std::vector<float>& values, double p);
 
     int64_t get_audio_sync(uint64_t ts)     // get delta between end of available audio and given time in nanoseconds
     {
+        if(m_low_latency)
+            return 0;   // nothing held back, the analysis window ends at the newest sample
         auto audio_ts = m_audio_ts + m_ts_offset;
         auto delta = std::max(audio_ts, ts) - std::min(audio_ts, ts);
         delta = std::min(delta, MAX_TS_DELTA);
         return (audio_ts < ts) ? -(int64_t)delta : (int64_t)delta;
     }
 
+    // ns_to_audio_frames and audio_frames_to_ns at the current rate, ns is at most MAX_TS_DELTA
+    size_t audio_frames(int64_t ns) const noexcept { return (ns > 0) ? (size_t)(((uint64_t)ns * m_frames_per_ns) >> FRAMES_PER_NS_BITS) : 0; }
+    uint64_t audio_ns(size_t frames) const noexcept { return ((uint64_t)frames * m_ns_per_frame) >> NS_PER_FRAME_BITS; }
+    void update_audio_rate();
+
+    std::span<float> interp_span(const AlignedBuffer<float>& buf) const noexcept { return { buf.get(), m_interp_size }; }
+
+    // bytes per m_tsmooth_buf element
+    size_t tsmooth_elem_size() const { return m_half_history ? sizeof(uint16_t) : sizeof(float); }
+
     // constants
     static const float DB_MIN;
     static constexpr auto RETRY_DELAY = 2.0f;
+    static constexpr auto PARK_DELAY = 5.0f; // seconds hidden before the capture is released
+    static constexpr size_t METER_BLOCK = 64; // samples per leaf of the peak meter tree
+    static constexpr auto PEAK_MARKER_HEIGHT = 2.0f; // pixels
+    static constexpr auto RADIAL_SEGMENT = 2.0f; // pixels along the outer edge per radial curve segment
+    static constexpr auto MAX_RADIAL_COLUMNS = 16384u;
     static constexpr uint64_t CAPTURE_TIMEOUT = 1000000ull * 500u;  // time in nanoseconds before audio capture is considered "lost" (500 ms)
     static constexpr uint64_t MAX_TS_DELTA = 1000000000ull * 16u;   // 16 seconds in ns
+    static constexpr size_t MAX_STFT_FRAMES = 32;   // analysis frames per tick before skipping ahead
+    static constexpr size_t MULTIRES_FACTOR = 4;    // decimation of the multiresolution bass band
+    static constexpr size_t MAX_DECIMATION = 16;
+    static constexpr uint32_t HIGH_RATE_REFERENCE = 48000; // faster sessions decimate toward this rate
+    static constexpr double MIN_DECIMATION_HEADROOM = 0.25; // of the decimated rate between twice the cutoff and the rate, room for the lowpass transition
+    static constexpr size_t IIR_CHUNK = 1024;       // samples per filterbank pass
+    static constexpr uint64_t EXPORT_DEMAND_TIMEOUT = 1000000ull * 1000u;  // ns after the last snapshot request the source counts as shown
 
     inline float dbfs(float mag)
     {
-        if(mag > 0.0f)
+        if(mag >= std::numeric_limits<float>::min()) // denormals would land below DB_MIN
             return 20.0f * std::log10(mag);
         else
             return DB_MIN;
     }
 
+    // linear power, same as dbfs() * 0.5
+    static inline float power_db(float power)
+    {
+        if(power >= std::numeric_limits<float>::min())
+            return 10.0f * std::log10(power);
+        else
+            return DB_MIN;
+    }
+
+    static void power_to_db(const float *src, size_t count, std::vector<float>& dst)
+    {
+        dst.resize(count);
+        for(size_t i = 0; i < count; ++i)
+            dst[i] = power_db(src[i]);
+    }
+
+    // 1 on a beat, falling to 0 by the next one (or after DEFAULT_BEAT_PULSE seconds without a tempo)
+    inline float beat_pulse() const
+    {
+        constexpr auto DEFAULT_BEAT_PULSE = 0.25f;
+        const auto t = 1.0f - std::min(m_beat_elapsed / ((m_beat_period > 0.0f) ? m_beat_period : DEFAULT_BEAT_PULSE), 1.0f);
+        return t * t;
+    }
+
     inline float get_gravity(float seconds)
+    {
+        return get_gravity(seconds, m_tsmoothing);
+    }
+
+    inline float get_gravity(float seconds, TSmoothingMode mode)
     {
         // FIXME: Scaling on this slider could probably use adjustment.
         // I don't remember what this constant is supposed to be but originally the idea was to tune the slider so the default value behaved
@@ -303,83 +888,80 @@ protected:
         constexpr float denom = 0.03868924705242879469662125316986f;
         constexpr float hi = denom * 5.0f;
         constexpr float lo = 0.0f;
-        if((m_tsmoothing == TSmoothingMode::NONE) || (m_gravity <= 0.0f))
+        if((mode == TSmoothingMode::NONE) || (m_gravity <= 0.0f))
             return 0.0f;
-        return (m_tsmoothing == TSmoothingMode::TVEXPONENTIAL) ? std::exp(-seconds / lerp(lo, hi, m_gravity)) : m_gravity;
+        return (mode == TSmoothingMode::TVEXPONENTIAL) ? std::exp(-seconds / lerp(lo, hi, m_gravity)) : m_gravity;
     }
 
 public:
     WAVSource(obs_source_t *source);
-    virtual ~WAVSource();
+    ~WAVSource();
 
     // no copying
     WAVSource(const WAVSource&) = delete;
     WAVSource& operator=(const WAVSource&) = delete;
 
-    unsigned int width();
-    unsigned int height();
+    unsigned int width() const noexcept { return m_published_width.load(std::memory_order_relaxed); }
+    unsigned int height() const noexcept { return m_published_height.load(std::memory_order_relaxed); }
 
     // main callbacks
-    virtual void update(obs_data_t *settings);
-    virtual void tick(float seconds);
-    virtual void render(gs_effect_t *effect);
+    void update(obs_data_t *settings);
+    void request_update(obs_data_t *settings); // update() for live settings, a rebuild waits for tick()
+    void defer_update(obs_data_t *settings);   // first build, on the first tick the source is shown
+    void tick(float seconds);
+    void render(gs_effect_t *effect);
 
     void show();
     void hide();
+    void set_active(bool active);
+
+    // proc handler, capture loss counters for diagnostics
+    void get_capture_stats(calldata_t *cd);
+    void get_stats(calldata_t *cd);     // memory and callback cost
+    void get_frame_times(calldata_t *cd);   // histograms as json
+    void get_health(calldata_t *cd);        // HealthCounters totals
+    void export_shared_frame();             // display state into m_shm_export
+    void record_frame();                    // display state into m_recorder
+    bool update_envelope(float seconds);    // follow the displayed levels, true if there's a signal to send
+    void update_auto_range(float seconds);  // displayed levels into m_range_hist, m_range_floor and m_range_ceiling from it
+    float follow_envelope(float current, float target, float seconds) const;
+    void get_spectrum(calldata_t *cd);      // waveform_api.h snapshots
+    void get_bands(calldata_t *cd);
+    void get_meter(calldata_t *cd);
+    void get_beat(calldata_t *cd);
+    void reset_frame_times();
 
     static void register_source();
-
-    // audio capture callback
-    void capture_audio(obs_source_t *source, const audio_data *audio, bool muted);
-
-    // for capturing the final OBS audio output stream
-    void capture_output_bus(size_t mix_idx, const audio_data *audio);
-
+    static constexpr auto SOURCE_ID = MODULE_NAME "_source";
+
+    // setting limits
+    static constexpr int MAX_SYNC_OFFSET = 1000;    // audio sync offset limit in ms
+    static constexpr int MAX_ANALYSIS_INTERVAL = 8; // analyze every N frames limit
+    static constexpr float MAX_TWEEN_PERIOD = 0.25f; // longer gaps between analyses are a stall, blend over this instead
+    static constexpr size_t MAX_FFT_SIZE = 8192;    // largest FFT size without P_ENABLE_LARGE_FFT
+    static constexpr size_t MAX_SCOPE_SAMPLES = 16384;  // longest scope window, the trigger search and copy scale with it
+
+    // per source memory budgets, update() warns when the settings need more
+    // a 65536 point stereo FFT with smoothing and peak hold plus a radial curve mesh fits the spectrum budget
+    static constexpr size_t SPECTRUM_MEMORY_BUDGET = 8u << 20;
+    static constexpr size_t WAVEFORM_MEMORY_BUDGET = 4u << 20;  // about 10 seconds of history at 48 kHz
+    static constexpr size_t METER_MEMORY_BUDGET = 1u << 20;
+
+    // GPU waveform rings hold the window and this many samples, the newest column can end a little past the last one consumed
+    static constexpr size_t WAVEFORM_RAW_MARGIN = 64;
+
+    // CPU features, capped by [cpu] tier in the module config.ini when the source is registered
+    // constant once any source exists
 #ifdef ENABLE_X86_SIMD
-    // constants
-    static const bool HAVE_AVX2;
-    static const bool HAVE_AVX;
-    static const bool HAVE_FMA3;
+    static bool HAVE_AVX512;
+    static bool HAVE_AVX2;
+    static bool HAVE_AVX;
+    static bool HAVE_FMA3;
+    static bool HAVE_F16C;
+    static bool HAVE_AVX1;      // AVX with or without FMA3, HAVE_AVX needs both
+    static bool HAVE_SSE41;
 #endif // ENABLE_X86_SIMD
+#ifdef ENABLE_ARM_SIMD
+    static bool HAVE_NEON;
+#endif // ENABLE_ARM_SIMD
 };
-
-class WAVSourceGeneric : public WAVSource
-{
-protected:
-    void tick_spectrum(float seconds) override;
-    void tick_meter(float seconds) override;
-    void tick_waveform(float seconds) override;
-
-    void update_input_rms() override;
-
-public:
-    using WAVSource::WAVSource;
-    ~WAVSourceGeneric() override = default;
-};
-
-#ifdef ENABLE_X86_SIMD
-
-class WAVSourceAVX : public WAVSourceGeneric
-{
-protected:
-    void tick_spectrum(float seconds) override;
-    void tick_meter(float seconds) override;
-
-    void update_input_rms() override;
-
-public:
-    using WAVSourceGeneric::WAVSourceGeneric;
-    ~WAVSourceAVX() override = default;
-};
-
-class WAVSourceAVX2 : public WAVSourceAVX
-{
-protected:
-    void tick_spectrum(float seconds) override;
-
-public:
-    using WAVSourceAVX::WAVSourceAVX;
-    ~WAVSourceAVX2() override = default;
-};
-
-#endif // ENABLE_X86_SIMD
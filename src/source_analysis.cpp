@@ -0,0 +1,696 @@
+/*
+    Copyright (C) 2022 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "source.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <cassert>
+
+// waveform column positions, 32.32 fixed point samples
+static constexpr auto WAVEFORM_PHASE_BITS = 32u;
+static constexpr auto WAVEFORM_PHASE_ONE = uint64_t(1) << WAVEFORM_PHASE_BITS;
+
+// catmull-rom interpolation of src at a fixed point sample position, edges are clamped
+static inline float waveform_cubic(const float *src, size_t count, int64_t pos)
+{
+    const auto index = (int64_t)(pos >> WAVEFORM_PHASE_BITS); // floor, pos can be just below 0
+    const auto t = (float)(pos & (int64_t)(WAVEFORM_PHASE_ONE - 1)) / (float)WAVEFORM_PHASE_ONE;
+    const auto at = [=](int64_t i) { return src[std::clamp<int64_t>(i, 0, (int64_t)count - 1)]; };
+    const auto p0 = at(index - 1);
+    const auto p1 = at(index);
+    const auto p2 = at(index + 1);
+    const auto p3 = at(index + 2);
+    return p1 + 0.5f * t * ((p2 - p0) + t * ((2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) + t * (3.0f * (p1 - p2) + p3 - p0)));
+}
+
+void WAVSource::select_spectrum_kernels()
+{
+    const auto& kernels = DSPKernels::get();
+    SpectrumVariant variant;
+    variant.power = m_tsmoothing == TSmoothingMode::POWER;
+    variant.smooth = m_tsmoothing != TSmoothingMode::NONE;
+    variant.fast_peaks = variant.smooth && m_fast_peaks;
+    variant.half_history = variant.smooth && m_half_history;
+    variant.peak = m_stft_peak;
+    variant.onset = m_beat_detection;
+    for(auto accumulate = 0; accumulate < 2; ++accumulate)
+    {
+        for(auto pair = 0; pair < 2; ++pair)
+        {
+            variant.accumulate = accumulate != 0;
+            variant.pair = pair != 0;
+            m_bins_fn[accumulate][pair] = kernels.bins(variant);
+        }
+    }
+
+    // bars that average in power stay linear until they're drawn
+    SpectrumPostVariant post;
+    post.power = variant.power;
+    post.mix = !m_stereo && (m_fft_channels > 1);
+    post.stereo = m_stereo;
+    post.copy = m_output_channels > m_capture_channels;
+    m_post_fn = m_power_bands ? kernels.power_post(post) : kernels.post(post);
+}
+
+// every tier runs the same loop, only the DSPKernels passes differ
+void WAVSource::tick_spectrum(float seconds)
+{
+    //std::lock_guard lock(m_mtx); // now locked in tick()
+
+    const auto& kernels = DSPKernels::get();
+    const auto outsz = m_fft_size / 2; // discard bins at nyquist and above
+    const auto first_bin = m_first_bin; // only the bins the display reads are processed
+    const auto last_bin = m_last_bin;
+
+    const auto dtcapture = m_tick_ts - m_capture_ts;
+
+    // reset and stop processing when source is not being displayed
+    // or we haven't received audio data for more than the timeout value
+    if(!m_show || (dtcapture > CAPTURE_TIMEOUT))
+    {
+        if(m_last_silent)
+            return;
+        for(auto channel = 0u; channel < m_capture_channels; ++channel)
+            if(m_tsmooth_buf[channel] != nullptr)
+                memset(m_tsmooth_buf[channel].get(), 0, outsz * tsmooth_elem_size());
+        for(auto channel = 0; channel < (m_stereo ? 2 : 1); ++channel)
+            for(size_t i = 0; i < outsz; ++i)
+                m_decibels[channel][i] = m_power_bands ? 0.0f : DB_MIN;
+        m_last_silent = true;
+        return;
+    }
+
+    const int64_t dtaudio = get_audio_sync(m_sync_ts);
+    const size_t dtsize = audio_frames(dtaudio) + m_fft_size;
+    const auto fft_channels = m_fft_channels;
+    // with a hop size every hop since the last tick is analyzed as its own frame, otherwise one frame ends at the sync point
+    const auto frames = get_stft_frames(dtsize);
+    if(frames == 0)
+        return; // no complete hop yet, keep the last spectrum
+    const auto frame_seconds = (m_stft_hop > 0) ? (float)m_stft_hop / (float)m_audio_info.samples_per_sec : seconds;
+    uint32_t combined[2] = {};
+    const auto silence = m_power_bands ? std::pow(10.0f, (float)(m_floor - 10) * 0.1f) : (float)(m_floor - 10);
+    for(size_t frame = 0; frame < frames; ++frame)
+    {
+        // hop frames start at the front of the buffer
+        const auto dtframe = (m_stft_hop > 0) ? m_capture.size(0) : dtsize;
+        auto silent_channels = 0u;
+        bool transform[2] = {};
+        // an identical input was already windowed and transformed this frame, only the bins onward are ours
+        bool frame_silent[2] = {};
+        ProfileScope window_scope("waveform window");
+        const auto shared = fetch_transform(frame_silent);
+        for(auto channel = 0u; channel < fft_channels; ++channel)
+        {
+            // gather, window and check for silence in a single pass straight from the capture ring
+            bool silent = true;
+            bool gathered = true;
+            const auto inbuf = &m_fft_input[channel * m_fft_size];
+            const auto window = (!m_sliding_dft && (m_decimation == 1) && (m_window_func != FFTWindow::NONE) && m_window_taps.empty()) ? m_tables->window->coefficients.get() : nullptr;
+            if(shared)
+                silent = frame_silent[channel];
+            else if(m_downmix)
+            {
+                // weighted sum to mono in the time domain, one FFT instead of one per channel
+                // every subscribed channel shares the same read position
+                if(m_capture.size(0) < dtframe)
+                    continue;
+                auto mixed = false;
+                auto capture_silent = !m_sliding_dft;
+                for(auto i = 0u; i < m_capture.channels(); ++i)
+                {
+                    m_capture.pop(i, nullptr, m_capture.size(i) - dtframe);
+                    if(m_mix_weights[i] != 0.0f)
+                        capture_silent = capture_silent && m_capture.silent(i);
+                }
+                for(auto i = 0u; !capture_silent && (i < m_capture.channels()); ++i)
+                {
+                    const auto weight = m_mix_weights[i];
+                    if(weight == 0.0f)
+                        continue;
+                    m_capture.visit(i, m_fft_size, [&](const float *src, size_t count, size_t offset) {
+                        kernels.mix(&inbuf[offset], src, weight, count, mixed);
+                        });
+                    mixed = true;
+                }
+                if(capture_silent)
+                    gathered = false;
+                else
+                {
+                    if(!mixed)
+                        memset(inbuf, 0, m_fft_size * sizeof(float));
+                    silent = !kernels.window(inbuf, inbuf, window, m_fft_size);
+                }
+            }
+            else if(m_capture.size(channel) >= dtframe)
+            {
+                m_capture.pop(channel, nullptr, m_capture.size(channel) - dtframe);
+                // the capture side already knows when there is nothing but silence, skip the gather
+                // the sliding DFT has to see every sample regardless
+                if(!m_sliding_dft && m_capture.silent(channel))
+                    gathered = false;
+                else
+                    m_capture.visit(channel, m_fft_size, [&](const float *src, size_t count, size_t offset) {
+                        if(kernels.window(&inbuf[offset], src, (window != nullptr) ? &window[offset] : nullptr, count))
+                            silent = false;
+                        });
+            }
+            else
+                continue;
+
+            // the sliding DFT has to see every sample, silent or not
+            if(m_sliding_dft)
+                m_sdft[channel].update(inbuf, m_capture.position(channel) + m_fft_size);
+
+            frame_silent[channel] = silent;
+            if(!silent)
+                m_last_silent = false;
+
+            // the GPU transforms whatever the input holds, silence is zeros
+            if(m_gpu_fft)
+            {
+                if(!gathered)
+                    memset(inbuf, 0, m_fft_size * sizeof(float));
+                if(silent)
+                    ++silent_channels;
+                continue;
+            }
+
+            // wait for gravity
+            if(silent && (combined[channel] == 0))
+            {
+                if(m_last_silent)
+                    continue;
+                const auto ch = (m_stereo) ? channel : 0u;
+                if(kernels.below(m_decibels[ch].get(), first_bin, last_bin, silence))
+                {
+                    if(++silent_channels >= fft_channels)
+                        m_last_silent = true;
+                    continue;
+                }
+            }
+
+            // still decaying, transform silence
+            if(!gathered)
+                memset(inbuf, 0, m_fft_size * sizeof(float));
+            transform[channel] = true;
+        }
+
+        // mid and side are made from both channels, one left out for silence is transformed as zeros
+        if((m_channel_mode == ChannelMode::MID_SIDE) && (transform[0] != transform[1]))
+        {
+            const auto channel = transform[0] ? 1u : 0u;
+            if(frame_silent[channel])
+            {
+                memset(&m_fft_input[channel * m_fft_size], 0, m_fft_size * sizeof(float));
+                transform[channel] = true;
+            }
+        }
+
+        window_scope.end();
+        if(m_gpu_fft)
+        {
+            m_last_silent = (silent_channels >= fft_channels);
+            advance_stft_frame();
+            continue;
+        }
+        ProfileScope fft_scope("waveform fft");
+        // one batched transform covers every channel, laid out m_fft_size apart
+        if(!m_fft.ready())
+            transform[0] = transform[1] = false;
+        else if(m_sliding_dft)
+        {
+            for(auto channel = 0u; channel < fft_channels; ++channel)
+                if(transform[channel])
+                    m_sdft[channel].output(&m_fft_output[channel * m_fft_size], outsz);
+        }
+        else if(!m_goertzel.empty())
+        {
+            for(auto channel = 0u; channel < fft_channels; ++channel)
+                if(transform[channel])
+                    m_goertzel.transform(&m_fft_input[channel * m_fft_size], &m_fft_output[channel * m_fft_size]);
+        }
+        else if(m_decimation > 1)
+            decimated_transform(transform);
+        else if(!shared && (transform[0] || transform[1]))
+        {
+            m_fft.execute();
+            publish_transform(transform, frame_silent);
+        }
+
+        // shared transforms are published unwindowed, every reader windows its own bins
+        if(!m_window_taps.empty())
+            for(auto channel = 0u; channel < fft_channels; ++channel)
+                if(transform[channel])
+                    window_bins(&m_fft_output[channel * m_fft_size]);
+        if((m_channel_mode == ChannelMode::MID_SIDE) && transform[0] && transform[1])
+            mid_side_bins();
+
+        fft_scope.end();
+        const ProfileScope bins_scope("waveform post");
+        process_bins(transform, combined, frame_seconds); // normalize FFT output, smooth and combine frames
+        if(m_beat_detection)
+            detect_onset(frame_seconds);
+
+        advance_stft_frame();
+    }
+
+    if(m_last_silent || m_gpu_fft)
+        return;
+
+    // everything after the transform in a single pass over the bins:
+    // frame average, channel mix, dBFS and volume compensation
+    const ProfileScope post_scope("waveform post");
+    m_post_fn(post_args(combined));
+}
+
+void WAVSource::tick_meter([[maybe_unused]] float seconds)
+{
+    const auto dtcapture = m_tick_ts - m_capture_ts;
+    if(dtcapture > CAPTURE_TIMEOUT)
+    {
+        if(m_last_silent)
+            return;
+        std::fill(m_meter_window.get(), m_meter_window.get() + m_meter_window.size(), 0.0f);
+        reset_meter_window();
+
+        for(auto& i : m_meter_buf)
+            i = 0.0f;
+        for(auto& i : m_meter_val)
+            i = DB_MIN;
+        m_last_silent = true;
+        return;
+    }
+
+    const int64_t dtaudio = get_audio_sync(m_sync_ts);
+    const size_t dtsize = audio_frames(dtaudio);
+    fill_meter_window(dtsize);
+
+    if(!m_show)
+    {
+        for(auto& i : m_meter_buf)
+            i = 0.0f;
+        for(auto& i : m_meter_val)
+            i = DB_MIN;
+        m_last_silent = true;
+        return;
+    }
+
+    for(auto channel = 0u; channel < m_capture_channels; ++channel)
+    {
+        float out = 0.0f;
+        out = meter_level(channel);
+
+        if(m_tsmoothing != TSmoothingMode::NONE)
+        {
+            const auto g = get_gravity(seconds);
+            const auto g2 = 1.0f - g;
+            if(!m_fast_peaks || (out <= m_meter_buf[channel]))
+                out = (g * m_meter_buf[channel]) + (g2 * out);
+        }
+        m_meter_buf[channel] = out;
+        m_meter_val[channel] = dbfs(out);
+    }
+
+    auto silent_channels = 0u;
+    for(auto channel = 0u; channel < m_capture_channels; ++channel)
+        if(m_meter_val[channel] < (m_floor - 10))
+            ++silent_channels;
+
+    m_last_silent = (silent_channels >= m_capture_channels);
+}
+
+void WAVSource::tick_waveform([[maybe_unused]] float seconds)
+{
+    // TODO: optimization
+    const auto outsz = m_fft_size;
+    constexpr auto step = 1;
+
+    const auto dtcapture = m_tick_ts - m_capture_ts;
+
+    if(!m_show || (dtcapture > CAPTURE_TIMEOUT))
+    {
+        if(m_last_silent)
+            return;
+        for(auto channel = 0; channel < (m_stereo ? 2 : 1); ++channel)
+            for(size_t i = 0; i < outsz; ++i)
+                m_decibels[channel][i] = DB_MIN;
+        m_waveform_written += outsz;
+        for(auto channel = 0u; m_gpu_waveform && (channel < 2u); ++channel)
+        {
+            if(!m_waveform_raw[channel])
+                continue;
+            std::fill(m_waveform_raw[channel].get(), m_waveform_raw[channel].get() + m_waveform_raw[channel].size(), 0.0f);
+            m_waveform_quiet[channel] = m_waveform_raw[channel].size();
+        }
+        m_waveform_raw_written += m_waveform_raw[0].size();
+        m_last_silent = true;
+        return;
+    }
+
+    const int64_t dtaudio = get_audio_sync(m_sync_ts);
+    const size_t reserve = audio_frames(dtaudio);
+    // m_waveform_buf is sized in update() for the reader's history, anything beyond that is too old to draw
+    const size_t max_size = std::min(m_waveform_samples + reserve, m_waveform_buf.size());
+    if(max_size <= reserve)
+        return;
+    for(auto i = 0u; i < m_capture_channels; ++i)
+    {
+        if(m_capture.size(i) <= reserve) // check if we have enough audio in advance
+        {
+            HealthCounters::count(m_health.underruns);
+            return;
+        }
+    }
+
+    // m_decibels is a ring of columns, the oldest at m_waveform_head
+    // new columns overwrite the oldest in place and only they are converted to dB
+    size_t counts[2] = {};
+    const auto head = m_waveform_head;
+    const auto column = [=](size_t i) { return (head + i < outsz) ? head + i : head + i - outsz; };
+    auto silent_channels = 0u;
+    size_t raw_used = 0;
+    auto raw_end = m_waveform_raw_end;
+    const auto step_ns = m_waveform_step_ns;
+    for(auto channel = 0u; channel < m_capture_channels; ++channel)
+    {
+        if(m_capture.size(channel) > max_size)
+            m_capture.pop(channel, nullptr, m_capture.size(channel) - max_size);
+        const auto consume = m_capture.size(channel) - reserve;
+        const auto total_samples = m_capture.size(channel);
+        const auto reserve_samples = reserve;
+        assert(total_samples > reserve_samples);
+        if(total_samples <= reserve_samples)
+            return; // sanity check, shouldn't be possible
+
+        // FIXME: spaghetti
+        const auto start_ts = m_audio_ts - audio_ns(total_samples);
+        const auto stop_ts = m_audio_ts - audio_ns(reserve_samples);
+        if((start_ts >= m_audio_ts) || (stop_ts > m_audio_ts))
+            return; // timestamp rollover, give up
+        if(m_waveform_ts < start_ts)
+        {
+            if(m_waveform_ts != 0)
+                HealthCounters::count(m_health.resyncs);
+            m_waveform_ts = start_ts; // catch up if we're falling behind
+        }
+        if((m_waveform_ts > stop_ts) && ((m_waveform_ts - stop_ts) > step_ns))
+        {
+            HealthCounters::count(m_health.resyncs);
+            m_waveform_ts = start_ts; // fix desync
+        }
+        // each column takes the peak of every sample in its span instead of a point sample
+        // only samples under complete columns are consumed, the rest waits for the next tick
+        // the reserve is read too, it's the right hand neighbours for interpolation
+        m_capture.peek(channel, m_waveform_buf.data(), total_samples);
+
+        // column edges as 32.32 fixed point positions in m_waveform_buf, one add per column
+        // instead of converting every column's timestamp
+        // m_waveform_ts is at or after start_ts here, so the lag is at most total_samples long
+        static_assert(WAVEFORM_PHASE_BITS == FRAMES_PER_NS_BITS);
+        const auto phase_step = m_waveform_phase_step;
+        const auto phase_end = (uint64_t)consume << WAVEFORM_PHASE_BITS;
+        const auto lag = (m_audio_ts - m_waveform_ts) * m_frames_per_ns;
+        const auto total_phase = (uint64_t)total_samples << WAVEFORM_PHASE_BITS;
+        auto phase = (lag < total_phase) ? std::min(total_phase - lag, phase_end) : 0;
+        const auto columns = ((phase_step > 0) && (phase_end > phase)) ? std::min<uint64_t>((phase_end - phase) / phase_step, outsz) : 0;
+
+        size_t used = 0;
+        for(size_t i = 0; i < columns; ++i, phase += phase_step)
+        {
+            const auto begin = std::min((size_t)(phase >> WAVEFORM_PHASE_BITS), consume - 1);
+            const auto end = std::max((size_t)((phase + phase_step) >> WAVEFORM_PHASE_BITS), begin + 1);
+            used = end;
+            if(m_gpu_waveform)
+            {
+                ++counts[channel]; // m_gpu_envelope finds the peaks, only the column count is kept
+                continue;
+            }
+            float peak;
+            if(phase_step < WAVEFORM_PHASE_ONE)
+            {
+                // columns narrower than a sample would share it and draw steps
+                // read the signal between samples at the column center instead
+                const auto center = (int64_t)(phase + (phase_step / 2)) - (int64_t)(WAVEFORM_PHASE_ONE / 2); // sample i is centered at i + 0.5
+                peak = std::abs(waveform_cubic(m_waveform_buf.data(), total_samples, center));
+            }
+            else
+                peak = DSPKernels::get().waveform_peak(&m_waveform_buf[begin], end - begin);
+            m_decibels[channel][column(counts[channel]++)] = peak;
+        }
+        if(m_gpu_waveform && (used > 0))
+        {
+            // the rings advance by the first channel's samples, the newest column ends this far past them
+            append_raw(channel, used);
+            if(channel == 0)
+            {
+                raw_used = used;
+                raw_end = (float)((double)(int64_t)(phase - ((uint64_t)used << WAVEFORM_PHASE_BITS)) / (double)WAVEFORM_PHASE_ONE);
+            }
+        }
+        m_capture.pop(channel, nullptr, used);
+
+        if(m_gpu_waveform)
+        {
+            if(m_waveform_quiet[channel] >= m_waveform_raw[channel].size())
+            {
+                if(++silent_channels >= m_capture_channels)
+                    m_last_silent = true;
+            }
+            else
+                m_last_silent = false;
+            continue;
+        }
+
+        bool silent = true;
+        for(auto i = 0u; i < m_fft_size; i += step)
+        {
+            if(m_decibels[channel][i] != 0.0f)
+            {
+                silent = false;
+                m_last_silent = false;
+                break;
+            }
+        }
+
+        if(silent)
+        {
+            if(++silent_channels >= m_capture_channels)
+                m_last_silent = true;
+        }
+    }
+    m_waveform_ts += (counts[0] * step_ns);
+    m_waveform_head = column(counts[0] % outsz);
+    m_waveform_written += counts[0];
+    if(m_gpu_waveform)
+    {
+        const auto size = m_waveform_raw[0].size();
+        m_waveform_raw_head = (size > 0) ? (m_waveform_raw_head + raw_used) % size : 0;
+        m_waveform_raw_written += raw_used;
+        m_waveform_raw_end = raw_end;
+        return; // the columns stay linear peaks nobody reads, the envelope pass does the rest
+    }
+
+    if(m_last_silent)
+    {
+        for(auto channel = 0; channel < (m_stereo ? 2 : 1); ++channel)
+            for(size_t i = 0; i < outsz; ++i)
+                m_decibels[channel][i] = DB_MIN;
+        m_waveform_written += outsz;
+        return;
+    }
+
+    // the new columns are at most two contiguous runs of the ring
+    const auto first = std::min(counts[0], outsz - head);
+    waveform_post(head, first);
+    if(counts[0] > first)
+        waveform_post(0, counts[0] - first);
+}
+
+void WAVSource::waveform_post(size_t pos, size_t count)
+{
+    WaveformPost args;
+    args.values[0] = m_decibels[0].get();
+    args.values[1] = m_decibels[1].get();
+    args.pos = pos;
+    args.count = count;
+    args.compensation = m_normalize_volume ? std::min(m_volume_target - dbfs(m_input_rms), m_max_gain) : 0.0f;
+    args.db_min = DB_MIN;
+    args.stereo = m_stereo;
+    args.mix = !m_stereo && (m_capture_channels > 1);
+    args.copy = m_output_channels > m_capture_channels;
+    DSPKernels::get().waveform_post(args);
+}
+
+void WAVSource::tick_scope([[maybe_unused]] float seconds)
+{
+    // every tick rewrites the whole window with m_waveform_head left at 0, frames copy all of it
+    const auto window = m_fft_size;
+    const auto display_channels = m_stereo ? 2u : 1u;
+
+    const auto dtcapture = m_tick_ts - m_capture_ts;
+    if(!m_show || (dtcapture > CAPTURE_TIMEOUT))
+    {
+        if(m_last_silent)
+            return;
+        for(auto channel = 0u; channel < display_channels; ++channel)
+            std::fill_n(m_decibels[channel].get(), window, 0.0f);
+        m_waveform_written += window;
+        m_last_silent = true;
+        return;
+    }
+
+    const int64_t dtaudio = get_audio_sync(m_sync_ts);
+    const size_t reserve = audio_frames(dtaudio);
+    const size_t max_size = std::min(m_waveform_samples + reserve, m_waveform_buf.size());
+    for(auto i = 0u; i < m_capture_channels; ++i)
+    {
+        if(m_capture.size(i) > max_size)
+            m_capture.pop(i, nullptr, m_capture.size(i) - max_size);
+        if(m_capture.size(i) <= reserve + window + 1) // a window and the sample after it before the sync point
+        {
+            HealthCounters::count(m_health.underruns);
+            return;
+        }
+    }
+
+    // trigger on the first channel, in the window of audio before the newest one so a full window follows the crossing
+    // the window starts at the crossing between the two samples, periodic signals don't jitter by a sample
+    auto total = m_capture.size(0);
+    m_capture.peek(0, m_waveform_buf.data(), total);
+    const auto last = total - reserve - window - 1;
+    const auto first = (last > window) ? last - window : 0;
+    const auto hit = DSPKernels::get().scope_trigger(&m_waveform_buf[first], last - first, m_scope_level);
+    auto start = last;
+    auto frac = 0.0f;
+    if(hit < last - first)
+    {
+        start = first + hit;
+        const auto a = m_waveform_buf[start];
+        const auto b = m_waveform_buf[start + 1];
+        frac = (m_scope_level - a) / (b - a); // b > level >= a
+    }
+    const auto back = total - reserve - start; // channels may hold different amounts, line them up on the newest sample
+
+    auto silent_channels = 0u;
+    for(auto channel = 0u; channel < m_capture_channels; ++channel)
+    {
+        if(channel > 0)
+        {
+            total = m_capture.size(channel);
+            m_capture.peek(channel, m_waveform_buf.data(), total);
+        }
+        const auto src = &m_waveform_buf[total - reserve - back];
+        const auto dst = m_decibels[channel].get();
+        auto peak = 0.0f;
+        for(size_t i = 0; i < window; ++i)
+        {
+            dst[i] = src[i] + (frac * (src[i + 1] - src[i]));
+            peak = std::max(peak, std::abs(dst[i]));
+        }
+        if(peak == 0.0f)
+            ++silent_channels;
+    }
+    m_last_silent = (silent_channels >= m_capture_channels);
+    m_waveform_written += window;
+
+    if(m_output_channels > m_capture_channels)
+        std::copy_n(m_decibels[0].get(), window, m_decibels[1].get());
+    else if(!m_stereo && (m_capture_channels > 1))
+        for(size_t i = 0; i < window; ++i)
+            m_decibels[0][i] = (m_decibels[0][i] + m_decibels[1][i]) * 0.5f;
+
+    if(m_normalize_volume && !m_last_silent)
+    {
+        const auto gain = std::pow(10.0f, std::min(m_volume_target - dbfs(m_input_rms), m_max_gain) / 20.0f);
+        for(auto channel = 0u; channel < display_channels; ++channel)
+            for(size_t i = 0; i < window; ++i)
+                m_decibels[channel][i] *= gain;
+    }
+}
+
+void WAVSource::tick_vectorscope([[maybe_unused]] float seconds)
+{
+    // every pair that reached the sync point since the last tick, the newest ones if there are more than a tick draws
+    // nothing new still publishes, the display goes on fading
+    m_scope_points = 0;
+    const auto dtcapture = m_tick_ts - m_capture_ts;
+    if(!m_show || (dtcapture > CAPTURE_TIMEOUT))
+    {
+        m_last_silent = true;
+        return;
+    }
+
+    const int64_t dtaudio = get_audio_sync(m_sync_ts);
+    const size_t reserve = audio_frames(dtaudio);
+    auto count = m_fft_size;
+    for(auto i = 0u; i < m_capture_channels; ++i)
+        count = std::min(count, (m_capture.size(i) > reserve) ? m_capture.size(i) - reserve : 0);
+
+    auto silent_channels = 0u;
+    for(auto channel = 0u; channel < m_capture_channels; ++channel)
+    {
+        const auto total = std::min(m_capture.size(channel), m_waveform_buf.size());
+        const auto fresh = (total > reserve) ? total - reserve : 0;
+        if(count > 0)
+        {
+            m_capture.peek(channel, m_waveform_buf.data(), total);
+            std::copy_n(&m_waveform_buf[fresh - count], count, m_decibels[channel].get());
+        }
+        m_capture.pop(channel, nullptr, fresh);
+
+        auto peak = 0.0f;
+        for(size_t i = 0; i < count; ++i)
+            peak = std::max(peak, std::abs(m_decibels[channel][i]));
+        if(peak == 0.0f)
+            ++silent_channels;
+    }
+    m_last_silent = (silent_channels >= m_capture_channels);
+    if(m_last_silent)
+        return;
+
+    if(m_output_channels > m_capture_channels)
+        std::copy_n(m_decibels[0].get(), count, m_decibels[1].get());
+    if(m_normalize_volume)
+    {
+        const auto gain = std::pow(10.0f, std::min(m_volume_target - dbfs(m_input_rms), m_max_gain) / 20.0f);
+        for(auto channel = 0u; channel < 2u; ++channel)
+            for(size_t i = 0; i < count; ++i)
+                m_decibels[channel][i] *= gain;
+    }
+    m_scope_points = count;
+}
+
+void WAVSource::tick_peak_hold(float seconds)
+{
+    PeakHold args;
+    args.channels = m_stereo ? 2u : 1u;
+    for(auto channel = 0u; channel < args.channels; ++channel)
+    {
+        args.db[channel] = m_display_db[channel];
+        args.peak[channel] = m_peak_db[channel].get();
+        args.timer[channel] = m_peak_timer[channel].get();
+    }
+    args.first_bin = m_first_bin;
+    args.last_bin = m_last_bin;
+    args.seconds = seconds;
+    args.fall = m_peak_fall_rate * seconds;
+    args.hold_time = m_peak_hold_time;
+    args.db_min = DB_MIN;
+    DSPKernels::get().peak_hold(args);
+}
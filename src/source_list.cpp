@@ -0,0 +1,202 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "source_list.hpp"
+#include <obs-module.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+    struct Entry
+    {
+        obs_source_t *source;   // not referenced, removed by its source_destroy before it is freed
+        std::string name;
+        std::string uuid;
+    };
+
+    // signals may come from any thread
+    std::mutex s_mtx;
+    std::vector<Entry> s_sources;
+    std::unordered_map<std::string, obs_source_t*> s_by_uuid;
+    bool s_connected = false;
+    std::atomic<uint64_t> s_generation = 0;
+
+    inline bool has_audio(const obs_source_t *source)
+    {
+        return (obs_source_get_output_flags(source) & OBS_SOURCE_AUDIO) != 0; // filter sources without audio
+    }
+
+    inline std::string source_uuid([[maybe_unused]] const obs_source_t *source)
+    {
+#if LIBOBS_API_MAJOR_VER >= 30
+        auto uuid = obs_source_get_uuid(source);
+        return (uuid != nullptr) ? uuid : "";
+#else
+        return {};
+#endif
+    }
+
+    // lock must be held
+    void remove(const obs_source_t *source)
+    {
+        std::erase_if(s_sources, [=](const auto& entry) { return entry.source == source; });
+        std::erase_if(s_by_uuid, [=](const auto& entry) { return entry.second == source; });
+    }
+
+    // lock must be held
+    void add(obs_source_t *source, const char *name)
+    {
+        remove(source);
+        s_sources.push_back({ source, (name != nullptr) ? name : "", source_uuid(source) });
+        const auto& entry = s_sources.back();
+        if(!entry.uuid.empty())
+            s_by_uuid[entry.uuid] = source;
+    }
+
+    void on_create([[maybe_unused]] void *data, calldata_t *cd)
+    {
+        auto source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+        if((source == nullptr) || !has_audio(source))
+            return;
+        auto name = obs_source_get_name(source);
+        {
+            std::lock_guard lock(s_mtx);
+            add(source, name);
+        }
+        s_generation.fetch_add(1, std::memory_order_release);
+    }
+
+    void on_destroy([[maybe_unused]] void *data, calldata_t *cd)
+    {
+        auto source = static_cast<const obs_source_t*>(calldata_ptr(cd, "source"));
+        {
+            std::lock_guard lock(s_mtx);
+            remove(source);
+        }
+        s_generation.fetch_add(1, std::memory_order_release);
+    }
+
+    void on_rename([[maybe_unused]] void *data, calldata_t *cd)
+    {
+        auto source = static_cast<const obs_source_t*>(calldata_ptr(cd, "source"));
+        auto name = calldata_string(cd, "new_name");
+        {
+            std::lock_guard lock(s_mtx);
+            for(auto& entry : s_sources)
+                if(entry.source == source)
+                    entry.name = (name != nullptr) ? name : "";
+        }
+        s_generation.fetch_add(1, std::memory_order_release);
+    }
+
+    bool enum_callback(void *data, obs_source_t *src)
+    {
+        if(has_audio(src))
+            static_cast<std::vector<obs_source_t*>*>(data)->push_back(src);
+        return true;
+    }
+}
+
+void AudioSourceList::start()
+{
+    auto handler = obs_get_signal_handler();
+    {
+        std::lock_guard lock(s_mtx);
+        if(s_connected || (handler == nullptr))
+            return;
+        signal_handler_connect(handler, "source_create", &on_create, nullptr);
+        signal_handler_connect(handler, "source_destroy", &on_destroy, nullptr);
+        signal_handler_connect(handler, "source_remove", &on_destroy, nullptr);
+        signal_handler_connect(handler, "source_rename", &on_rename, nullptr);
+        s_connected = true;
+    }
+
+    // sources created before the module loaded, usually none
+    // enumerated without our lock, obs holds its own while calling back
+    std::vector<obs_source_t*> existing;
+    obs_enum_sources(&enum_callback, &existing);
+    std::lock_guard lock(s_mtx);
+    for(auto source : existing)
+        if(std::none_of(s_sources.begin(), s_sources.end(), [&](const auto& e) { return e.source == source; }))
+            add(source, obs_source_get_name(source));
+}
+
+void AudioSourceList::stop()
+{
+    auto handler = obs_get_signal_handler();
+    std::lock_guard lock(s_mtx);
+    if(s_connected && (handler != nullptr))
+    {
+        signal_handler_disconnect(handler, "source_create", &on_create, nullptr);
+        signal_handler_disconnect(handler, "source_destroy", &on_destroy, nullptr);
+        signal_handler_disconnect(handler, "source_remove", &on_destroy, nullptr);
+        signal_handler_disconnect(handler, "source_rename", &on_rename, nullptr);
+    }
+    s_connected = false;
+    s_sources.clear();
+    s_by_uuid.clear();
+}
+
+std::vector<std::string> AudioSourceList::names()
+{
+    std::vector<std::string> ret;
+    std::lock_guard lock(s_mtx);
+    ret.reserve(s_sources.size());
+    for(const auto& entry : s_sources)
+        ret.push_back(entry.name);
+    return ret;
+}
+
+obs_source_t *AudioSourceList::get(const std::string& uuid)
+{
+    if(uuid.empty())
+        return nullptr;
+    // the reference is taken under the lock, a source on its way out gives none
+    std::lock_guard lock(s_mtx);
+    auto it = s_by_uuid.find(uuid);
+    return (it != s_by_uuid.end()) ? obs_source_get_ref(it->second) : nullptr;
+}
+
+std::string AudioSourceList::uuid_of(const std::string& name)
+{
+    std::lock_guard lock(s_mtx);
+    for(const auto& entry : s_sources)
+        if(entry.name == name)
+            return entry.uuid;
+    return {};
+}
+
+std::string AudioSourceList::name_of(const std::string& uuid)
+{
+    if(uuid.empty())
+        return {};
+    std::lock_guard lock(s_mtx);
+    for(const auto& entry : s_sources)
+        if(entry.uuid == uuid)
+            return entry.name;
+    return {};
+}
+
+uint64_t AudioSourceList::generation() noexcept
+{
+    return s_generation.load(std::memory_order_acquire);
+}
@@ -0,0 +1,48 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <obs-module.h>
+
+// Names of every public source with audio, for the audio source list in the properties.
+// Enumerated once on start and kept current from the global source_create, source_destroy,
+// source_remove and source_rename signals, so opening the properties doesn't walk every source.
+// generation() lets sources look for a lost capture only when something changed.
+// Sources are also kept by UUID (OBS 30 and up), which survives renames and is found without a scan.
+class AudioSourceList
+{
+public:
+    static void start();    // enumerate and connect the signals
+    static void stop();     // disconnect the signals
+
+    // in creation order, same as obs_enum_sources
+    static std::vector<std::string> names();
+
+    // strong reference to the source with the UUID, nullptr if there is none
+    static obs_source_t *get(const std::string& uuid);
+
+    // UUID of the first source with the name and name of the source with the UUID, empty if there is none
+    static std::string uuid_of(const std::string& name);
+    static std::string name_of(const std::string& uuid);
+
+    // bumped by every signal that can create, remove or rename an audio source
+    static uint64_t generation() noexcept;
+};
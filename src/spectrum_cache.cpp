@@ -0,0 +1,148 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "spectrum_cache.hpp"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace
+{
+    struct Entry
+    {
+        const void *owner = nullptr;
+        SpectrumKey key;
+        uint64_t frame_ts = 0;
+        std::vector<float> decibels[2];
+        std::vector<float> tsmooth[2];
+        bool silent = false;
+    };
+
+    // only a handful of distinct keys exist at once, linear search is fine
+    std::mutex s_mtx;
+    std::vector<Entry> s_entries;
+
+    inline uint32_t display_channels(const SpectrumKey& key) { return key.stereo ? 2u : 1u; }
+}
+
+bool SpectrumCache::fetch(const SpectrumKey& key, uint64_t frame_ts, float *const decibels[2], float *const tsmooth[2], bool& silent)
+{
+    std::lock_guard lock(s_mtx);
+    auto it = std::find_if(s_entries.begin(), s_entries.end(), [&](const Entry& e) { return e.key == key; });
+    if((it == s_entries.end()) || (it->frame_ts != frame_ts))
+        return false;
+
+    for(auto channel = 0u; channel < display_channels(key); ++channel)
+        std::copy(it->decibels[channel].begin(), it->decibels[channel].end(), decibels[channel]);
+    for(auto channel = 0u; channel < key.capture_channels; ++channel)
+        if((tsmooth[channel] != nullptr) && !it->tsmooth[channel].empty())
+            std::copy(it->tsmooth[channel].begin(), it->tsmooth[channel].end(), tsmooth[channel]);
+    silent = it->silent;
+    return true;
+}
+
+void SpectrumCache::publish(const void *owner, const SpectrumKey& key, uint64_t frame_ts, const float *const decibels[2], const float *const tsmooth[2], bool silent)
+{
+    std::lock_guard lock(s_mtx);
+    auto it = std::find_if(s_entries.begin(), s_entries.end(), [&](const Entry& e) { return e.key == key; });
+    if(it == s_entries.end())
+        it = s_entries.emplace(s_entries.end());
+    else if(it->frame_ts == frame_ts)
+        return; // someone beat us to it
+
+    // whoever published last owns the entry
+    const auto outsz = key.fft_size / 2;
+    const auto tsmoothsz = key.half_history ? outsz / 2 : outsz;
+    it->owner = owner;
+    it->key = key;
+    it->frame_ts = frame_ts;
+    it->silent = silent;
+    for(auto channel = 0u; channel < display_channels(key); ++channel)
+        it->decibels[channel].assign(decibels[channel], decibels[channel] + outsz);
+    for(auto channel = 0u; channel < key.capture_channels; ++channel)
+    {
+        if(tsmooth[channel] != nullptr)
+            it->tsmooth[channel].assign(tsmooth[channel], tsmooth[channel] + tsmoothsz);
+        else
+            it->tsmooth[channel].clear();
+    }
+}
+
+void SpectrumCache::release(const void *owner)
+{
+    std::lock_guard lock(s_mtx);
+    std::erase_if(s_entries, [=](const Entry& e) { return e.owner == owner; });
+}
+
+namespace
+{
+    struct TransformEntry
+    {
+        const void *owner = nullptr;
+        TransformKey key;
+        uint64_t frame_ts = 0;
+        std::vector<float> out;     // interleaved complex
+        bool silent[2] = {};
+    };
+
+    std::mutex s_transform_mtx;
+    std::vector<TransformEntry> s_transforms;
+}
+
+bool TransformCache::fetch(const TransformKey& key, uint64_t frame_ts, fftwf_complex *out, bool silent[2])
+{
+    std::lock_guard lock(s_transform_mtx);
+    auto it = std::find_if(s_transforms.begin(), s_transforms.end(), [&](const TransformEntry& e) { return e.key == key; });
+    if((it == s_transforms.end()) || (it->frame_ts != frame_ts))
+        return false;
+
+    const auto outsz = key.fft_size / 2;
+    for(auto channel = 0u; channel < key.fft_channels; ++channel)
+    {
+        std::memcpy(&out[channel * key.fft_size], &it->out[channel * outsz * 2], outsz * sizeof(fftwf_complex));
+        silent[channel] = it->silent[channel];
+    }
+    return true;
+}
+
+void TransformCache::publish(const void *owner, const TransformKey& key, uint64_t frame_ts, const fftwf_complex *out, const bool silent[2])
+{
+    std::lock_guard lock(s_transform_mtx);
+    auto it = std::find_if(s_transforms.begin(), s_transforms.end(), [&](const TransformEntry& e) { return e.key == key; });
+    if(it == s_transforms.end())
+        it = s_transforms.emplace(s_transforms.end());
+    else if(it->frame_ts == frame_ts)
+        return; // someone beat us to it
+
+    // packed without the gaps between channels
+    const auto outsz = key.fft_size / 2;
+    it->owner = owner;
+    it->key = key;
+    it->frame_ts = frame_ts;
+    it->out.resize(outsz * key.fft_channels * 2);
+    for(auto channel = 0u; channel < key.fft_channels; ++channel)
+    {
+        std::memcpy(&it->out[channel * outsz * 2], &out[channel * key.fft_size], outsz * sizeof(fftwf_complex));
+        it->silent[channel] = silent[channel];
+    }
+}
+
+void TransformCache::release(const void *owner)
+{
+    std::lock_guard lock(s_transform_mtx);
+    std::erase_if(s_transforms, [=](const TransformEntry& e) { return e.owner == owner; });
+}
@@ -0,0 +1,119 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <fftw3.h>
+
+class CaptureStream;
+
+// Everything that affects the output of tick_spectrum().
+// Two sources with equal keys produce the same spectrum from the same audio.
+struct SpectrumKey
+{
+    const CaptureStream *stream = nullptr;
+    int channel_base = 0;
+    uint32_t capture_channels = 0;
+    bool stereo = false;
+    bool mid_side = false;
+    bool downmix = false;
+    uint32_t mix_channels = 0;
+    std::array<float, 8> mix_weights{};     // MAX_AUDIO_CHANNELS, only set when downmixing
+    size_t fft_size = 0;
+    size_t stft_hop = 0;
+    bool stft_peak = false;
+    bool sliding_dft = false;
+    bool multires = false;
+    uint32_t decimation = 1;
+    std::vector<uint32_t> pruned_bins;      // only these bins are valid when not empty
+    size_t first_bin = 0;                   // bins outside of [first_bin, last_bin) are not updated
+    size_t last_bin = 0;
+    int window_func = 0;
+    int sine_exponent = 0;
+    bool bin_window = false;                // applied to the bins instead of the input
+    bool power_bands = false;               // linear power instead of dB
+    int tsmoothing = 0;
+    float gravity = 0.0f;
+    bool fast_peaks = false;
+    bool half_history = false;              // tsmooth holds fp16, half as many floats
+    float slope = 0.0f;
+    int64_t ts_offset = 0;
+    bool low_latency = false;
+    int floor = 0;
+    int cutoff_low = 0;
+    int cutoff_high = 0;
+    float rolloff_q = 0.0f;
+    float rolloff_rate = 0.0f;
+    bool normalize_volume = false;
+    float volume_target = 0.0f;
+    float max_gain = 0.0f;
+
+    bool operator==(const SpectrumKey&) const = default;
+};
+
+// Everything that affects the windowed input and its transform in tick_spectrum().
+// Sources with equal keys share one FFT per frame even when their spectra differ from the bins onward.
+// Only single frame ticks with a plain FFT are shared, see WAVSource::get_transform_key().
+struct TransformKey
+{
+    const CaptureStream *stream = nullptr;
+    int channel_base = 0;
+    uint32_t capture_channels = 0;
+    uint32_t fft_channels = 0;
+    bool downmix = false;
+    std::array<float, 8> mix_weights{};     // MAX_AUDIO_CHANNELS, only set when downmixing
+    size_t fft_size = 0;
+    int window_func = 0;
+    int sine_exponent = 0;
+    bool bin_window = false;                // the bins are published unwindowed
+    int64_t ts_offset = 0;
+    bool low_latency = false;
+
+    bool operator==(const TransformKey&) const = default;
+};
+
+// Process-wide cache of the most recent spectrum for each key.
+// The first source to tick in a frame publishes its result, others with the same key copy it.
+class SpectrumCache
+{
+public:
+    // copy the result for key if one was published during frame_ts
+    // decibels has one buffer per display channel, tsmooth one per capture channel (or null without smoothing)
+    static bool fetch(const SpectrumKey& key, uint64_t frame_ts, float *const decibels[2], float *const tsmooth[2], bool& silent);
+
+    // publish a result for frame_ts, owner keeps the entry until it calls release()
+    static void publish(const void *owner, const SpectrumKey& key, uint64_t frame_ts, const float *const decibels[2], const float *const tsmooth[2], bool silent);
+
+    static void release(const void *owner);
+};
+
+// Process-wide cache of the most recent transform for each key, the stage before SpectrumCache.
+// Holds bins [0, fft_size / 2) of each transformed channel, channels fft_size apart like the FFT output.
+class TransformCache
+{
+public:
+    // copy the transform for key if one was published during frame_ts, silent is per transformed channel
+    static bool fetch(const TransformKey& key, uint64_t frame_ts, fftwf_complex *out, bool silent[2]);
+
+    // publish a transform of every channel for frame_ts, owner keeps the entry until it calls release()
+    static void publish(const void *owner, const TransformKey& key, uint64_t frame_ts, const fftwf_complex *out, const bool silent[2]);
+
+    static void release(const void *owner);
+};
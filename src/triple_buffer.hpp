@@ -0,0 +1,76 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// Hands the newest value from one producer thread to one consumer thread, neither ever waits.
+// The producer fills back() and publish()es it, the consumer switches to the newest published
+// slot with acquire() and reads front() until its next acquire().
+// Values published faster than they are acquired are overwritten, only the latest survives.
+template<typename T>
+class TripleBuffer
+{
+public:
+    T& back() noexcept { return m_slots[m_back]; }
+    T& front() noexcept { return m_slots[m_front]; }
+    const T& front() const noexcept { return m_slots[m_front]; }
+
+    // producer, hand back() over, back() is a different slot afterwards
+    void publish() noexcept
+    {
+        m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // consumer, true if acquire() would switch slots, front() stays untouched
+    bool fresh() const noexcept { return (m_middle.load(std::memory_order_relaxed) & FRESH) != 0; }
+
+    // consumer, switch front() to the newest published slot
+    // returns false if nothing was published since the last call
+    bool acquire() noexcept
+    {
+        if((m_middle.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    // every slot, both sides must be idle
+    static constexpr std::size_t size() noexcept { return 3; }
+    T& operator[](std::size_t i) noexcept { return m_slots[i]; }
+    const T& operator[](std::size_t i) const noexcept { return m_slots[i]; }
+
+    // forget anything published, both sides must be idle
+    void reset() noexcept
+    {
+        m_front = 0;
+        m_middle.store(1, std::memory_order_relaxed);
+        m_back = 2;
+    }
+
+private:
+    static constexpr unsigned int INDEX = 3;
+    static constexpr unsigned int FRESH = 4;    // middle slot not acquired yet
+
+    // consumer, exchanged and producer index on their own cache lines
+    T m_slots[3]{};
+    unsigned int m_front = 0;
+    alignas(64) std::atomic<unsigned int> m_middle = 1;
+    alignas(64) unsigned int m_back = 2;
+};
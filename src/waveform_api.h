@@ -0,0 +1,112 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Read only analysis snapshots for other plugins, C so it can be included from anywhere.
+// Ask a waveform source's proc handler for one:
+//
+//     calldata_t cd = {0};
+//     proc_handler_call(obs_source_get_proc_handler(source), "get_spectrum", &cd);
+//     const struct waveform_snapshot *snap = calldata_ptr(&cd, "snapshot");
+//     if(snap && (snap->api_version == WAVEFORM_API_VERSION)) { ...read... }
+//     if(snap) snap->release(snap);
+//     calldata_free(&cd);
+//
+// "get_spectrum" gives the bins of the analyzed frequency range, "get_bands" the bars of bar modes,
+// both null until the source has published one after the first request.
+// A snapshot never changes once handed out and stays valid until released, however the source changes
+// meanwhile. Every consumer of the same analysis shares the same snapshot, nothing is copied per call.
+// "get_meter(out float left, out float right, out int audio_ts)" returns the meter levels by value.
+// "get_beat(out bool enabled, out float bpm, out float confidence, out float strength, out int beats, out int onsets,
+// out int audio_ts)" returns the beat detection state by value, with beat detection enabled in the source's settings.
+// beats and onsets count up from the last settings change, poll and compare for new ones. bpm is 0 without a tempo.
+// A source asked for any of these in the last second keeps analyzing while it's hidden.
+//
+// With "Envelope Signal" enabled a source emits "envelope(ptr source, float level, float db, ptr bands, int count,
+// int audio_ts)" on its own signal handler every video frame, outside its locks so handlers may call the procs above.
+// level is the overall envelope from 0 at the floor to 1 at the ceiling, db the same in dBFS. bands points to count
+// floats on the same scale, one per bar in bar modes or per channel in meter modes, null with count 0 in other modes.
+// It's only valid during the call. Attack and release come from the source's settings.
+
+#define WAVEFORM_API_VERSION 1
+
+struct waveform_snapshot
+{
+    uint32_t api_version;       // WAVEFORM_API_VERSION the layout below belongs to
+    uint32_t channels;          // 1 or 2
+    uint64_t sequence;          // increases with each snapshot of the source, equal means unchanged
+    uint64_t audio_ts;          // obs audio timestamp of the newest sample analyzed, ns
+    size_t count;               // values per channel
+    const float *values[2];     // dBFS, values[1] is null for a single channel
+    const float *frequencies;   // Hz each value starts at, count entries
+    void (*release)(const struct waveform_snapshot *snapshot);  // drop the reference this call handed out
+};
+
+// Shared memory export for other processes, enabled per source by naming it in the source's settings.
+// The mapping is "/<name>" for shm_open or "Local\\<name>" for OpenFileMapping, holding one waveform_shm_header.
+// Every video frame the source writes the graph it displays into the next of WAVEFORM_SHM_SLOTS frames,
+// each guarded by a sequence lock, then bumps latest. Readers never block the writer:
+//
+//     for(;;) {
+//         uint64_t n = atomic_load_explicit(&header->latest, memory_order_acquire);
+//         const struct waveform_shm_frame *f = &header->frames[n % WAVEFORM_SHM_SLOTS];
+//         uint64_t s = atomic_load_explicit(&f->seq, memory_order_acquire);
+//         if((n == 0) || (s & 1)) continue;           // nothing yet, or being written
+//         ...read or copy from f...
+//         atomic_thread_fence(memory_order_acquire);
+//         if(atomic_load_explicit(&f->seq, memory_order_relaxed) == s) break;  // else overwritten meanwhile
+//     }
+//
+// magic is cleared when the source stops exporting, reopen by name to follow it.
+
+#define WAVEFORM_SHM_MAGIC 0x46564157u // "WAVF"
+#define WAVEFORM_SHM_VERSION 1
+#define WAVEFORM_SHM_SLOTS 4
+#define WAVEFORM_SHM_MAX_BINS 32768
+#define WAVEFORM_SHM_MAX_BANDS 4096
+
+struct waveform_shm_frame
+{
+    uint64_t seq;               // odd while the frame is being written
+    uint64_t frame;             // number of this frame, see waveform_shm_header::latest
+    uint64_t audio_ts;          // obs audio timestamp of the newest sample analyzed, ns
+    uint32_t channels;          // 1 or 2
+    uint32_t bin_count;         // spectrum values per channel, 0 in waveform and meter modes
+    uint32_t first_bin;         // bins[c][i] is bin first_bin + i
+    float bin_hz;               // bin width, bin k starts at k * bin_hz
+    uint32_t band_count;        // bar values per channel, 0 outside bar modes
+    float meter[2];             // dBFS, meter mode
+    uint32_t reserved[3];
+    float bins[2][WAVEFORM_SHM_MAX_BINS];     // dBFS as displayed, after smoothing
+    float bands[2][WAVEFORM_SHM_MAX_BANDS];   // dBFS of each bar
+    float band_hz[WAVEFORM_SHM_MAX_BANDS];    // frequency each bar starts at
+};
+
+struct waveform_shm_header
+{
+    uint32_t magic;             // WAVEFORM_SHM_MAGIC while the source exports
+    uint32_t version;           // WAVEFORM_SHM_VERSION
+    uint32_t slots;             // WAVEFORM_SHM_SLOTS
+    uint32_t frame_size;        // sizeof(struct waveform_shm_frame)
+    uint64_t latest;            // newest complete frame, in frames[latest % slots], 0 before the first
+    uint32_t reserved[10];
+    struct waveform_shm_frame frames[WAVEFORM_SHM_SLOTS];
+};
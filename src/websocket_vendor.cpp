@@ -0,0 +1,414 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "websocket_vendor.hpp"
+#include "module.hpp"
+#include "source.hpp"
+#include "waveform_api.h"
+#include "log.hpp"
+#include <obs-module.h>
+#include <util/platform.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // obs-websocket-api.h
+    using RequestFn = void (*)(obs_data_t *request, obs_data_t *response, void *priv);
+    struct RequestCallback
+    {
+        RequestFn callback;
+        void *priv;
+    };
+
+    constexpr uint32_t MAX_RATE = 120;
+    constexpr uint32_t MAX_POINTS = 4096;
+
+    enum class Kind
+    {
+        BANDS,
+        SPECTRUM,
+        METER
+    };
+
+    struct Stream
+    {
+        std::string source;
+        Kind kind = Kind::BANDS;
+        uint32_t bits = 8;
+        uint32_t points = 0;
+        float floor = -90.0f;
+        float ceiling = 0.0f;
+        uint64_t period_ns = 0;
+        uint64_t next_ts = 0;
+        uint64_t sequence = 0;  // of the last frame sent, snapshot sequence or meter audio_ts
+    };
+
+    struct Frame
+    {
+        uint32_t channels = 0;
+        uint64_t sequence = 0;
+        uint64_t audio_ts = 0;
+        std::vector<float> values; // channel after channel, points or the source's count each
+        size_t count = 0;
+    };
+
+    proc_handler_t *s_ph = nullptr;     // obs-websocket's
+    void *s_vendor = nullptr;
+
+    // streams, taken by requests on obs-websocket's threads and the stream thread
+    std::mutex s_mtx;
+    std::condition_variable s_cv;
+    std::vector<Stream> s_streams;
+    bool s_stop = false;
+    std::thread s_thread;
+
+    bool vendor_call(const char *proc, calldata_t *cd)
+    {
+        calldata_set_ptr(cd, "vendor", s_vendor);
+        proc_handler_call(s_ph, proc, cd);
+        return calldata_bool(cd, "success");
+    }
+
+    // settings of a request, false with an error in the response if they don't make sense
+    bool parse_stream(obs_data_t *request, obs_data_t *response, Stream& stream)
+    {
+        const auto name = obs_data_get_string(request, "sourceName");
+        if((name == nullptr) || (*name == '\0'))
+        {
+            obs_data_set_string(response, "error", "sourceName missing");
+            return false;
+        }
+        stream.source = name;
+
+        const auto kind = obs_data_get_string(request, "kind");
+        if((kind == nullptr) || (*kind == '\0') || (strcmp(kind, "bands") == 0))
+            stream.kind = Kind::BANDS;
+        else if(strcmp(kind, "spectrum") == 0)
+            stream.kind = Kind::SPECTRUM;
+        else if(strcmp(kind, "meter") == 0)
+            stream.kind = Kind::METER;
+        else
+        {
+            obs_data_set_string(response, "error", "kind must be bands, spectrum or meter");
+            return false;
+        }
+
+        const auto bits = obs_data_get_int(request, "bits");
+        if((bits != 0) && (bits != 8) && (bits != 16))
+        {
+            obs_data_set_string(response, "error", "bits must be 8 or 16");
+            return false;
+        }
+        stream.bits = (bits == 16) ? 16 : 8;
+
+        const auto rate = obs_data_get_int(request, "rate");
+        stream.period_ns = 1000000000ull / (uint64_t)((rate > 0) ? std::min(rate, (long long)MAX_RATE) : 30ll);
+        stream.points = (uint32_t)std::clamp(obs_data_get_int(request, "points"), 0ll, (long long)MAX_POINTS);
+
+        // unset numbers read as 0, only the floor needs a default off 0
+        stream.floor = obs_data_has_user_value(request, "floor") ? (float)obs_data_get_double(request, "floor") : -90.0f;
+        stream.ceiling = (float)obs_data_get_double(request, "ceiling");
+        if(!(stream.ceiling > stream.floor))
+        {
+            obs_data_set_string(response, "error", "ceiling must be above floor");
+            return false;
+        }
+        return true;
+    }
+
+    // newest published analysis of a waveform source, false if there is none (yet)
+    bool read_frame(const Stream& stream, Frame& frame)
+    {
+        auto source = obs_get_source_by_name(stream.source.c_str());
+        if(source == nullptr)
+            return false;
+        auto ok = false;
+        const auto id = obs_source_get_id(source);
+        if((id != nullptr) && (strcmp(id, WAVSource::SOURCE_ID) == 0))
+        {
+            calldata_t cd = {};
+            const auto proc = obs_source_get_proc_handler(source);
+            if(stream.kind == Kind::METER)
+            {
+                if(proc_handler_call(proc, "get_meter", &cd))
+                {
+                    frame.channels = 2;
+                    frame.count = 1;
+                    frame.values = { (float)calldata_float(&cd, "left"), (float)calldata_float(&cd, "right") };
+                    frame.audio_ts = (uint64_t)calldata_int(&cd, "audio_ts");
+                    frame.sequence = frame.audio_ts;
+                    ok = true;
+                }
+            }
+            else if(proc_handler_call(proc, (stream.kind == Kind::BANDS) ? "get_bands" : "get_spectrum", &cd))
+            {
+                const auto snapshot = static_cast<const waveform_snapshot*>(calldata_ptr(&cd, "snapshot"));
+                if((snapshot != nullptr) && (snapshot->api_version == WAVEFORM_API_VERSION) && (snapshot->count > 0))
+                {
+                    frame.channels = snapshot->channels;
+                    frame.count = (stream.points > 0) ? stream.points : snapshot->count;
+                    frame.sequence = snapshot->sequence;
+                    frame.audio_ts = snapshot->audio_ts;
+                    frame.values.resize(frame.channels * frame.count);
+                    for(auto channel = 0u; channel < frame.channels; ++channel)
+                    {
+                        const auto src = snapshot->values[channel];
+                        auto dst = &frame.values[channel * frame.count];
+                        if(stream.points == 0)
+                        {
+                            std::copy(src, src + snapshot->count, dst);
+                            continue;
+                        }
+                        // the loudest value of each span, spans shorter than a value take the one they fall in
+                        for(size_t i = 0; i < frame.count; ++i)
+                        {
+                            const auto first = (i * snapshot->count) / frame.count;
+                            const auto last = std::max(((i + 1) * snapshot->count) / frame.count, first + 1);
+                            dst[i] = *std::max_element(src + first, src + last);
+                        }
+                    }
+                    ok = true;
+                }
+                if(snapshot != nullptr)
+                    snapshot->release(snapshot);
+            }
+            calldata_free(&cd);
+        }
+        obs_source_release(source);
+        return ok;
+    }
+
+    std::string base64(const std::vector<uint8_t>& bytes)
+    {
+        static constexpr char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string out;
+        out.reserve(((bytes.size() + 2) / 3) * 4);
+        for(size_t i = 0; i < bytes.size(); i += 3)
+        {
+            const auto left = bytes.size() - i;
+            const uint32_t word = ((uint32_t)bytes[i] << 16) | ((left > 1) ? ((uint32_t)bytes[i + 1] << 8) : 0u) | ((left > 2) ? bytes[i + 2] : 0u);
+            out += digits[(word >> 18) & 63];
+            out += digits[(word >> 12) & 63];
+            out += (left > 1) ? digits[(word >> 6) & 63] : '=';
+            out += (left > 2) ? digits[word & 63] : '=';
+        }
+        return out;
+    }
+
+    // the fields of a Frame event
+    void write_frame(const Stream& stream, const Frame& frame, obs_data_t *data)
+    {
+        const auto max = (float)((1u << stream.bits) - 1);
+        const auto scale = max / (stream.ceiling - stream.floor);
+        std::vector<uint8_t> bytes;
+        bytes.reserve(frame.values.size() * (stream.bits / 8));
+        for(auto value : frame.values)
+        {
+            const auto q = (uint32_t)std::lround(std::clamp((value - stream.floor) * scale, 0.0f, max));
+            bytes.push_back((uint8_t)q);
+            if(stream.bits == 16)
+                bytes.push_back((uint8_t)(q >> 8));
+        }
+
+        static constexpr const char *kinds[] = { "bands", "spectrum", "meter" };
+        obs_data_set_string(data, "sourceName", stream.source.c_str());
+        obs_data_set_string(data, "kind", kinds[(int)stream.kind]);
+        obs_data_set_int(data, "bits", stream.bits);
+        obs_data_set_int(data, "channels", frame.channels);
+        obs_data_set_int(data, "count", (long long)frame.count);
+        obs_data_set_int(data, "sequence", (long long)frame.sequence);
+        obs_data_set_int(data, "audioTs", (long long)frame.audio_ts);
+        obs_data_set_double(data, "floor", stream.floor);
+        obs_data_set_double(data, "ceiling", stream.ceiling);
+        obs_data_set_string(data, "data", base64(bytes).c_str());
+    }
+
+    void stream_thread()
+    {
+        std::vector<Stream> due;
+        Frame frame;
+        std::unique_lock lock(s_mtx);
+        while(!s_stop)
+        {
+            // sleep until the next stream is due, a request wakes us to recompute
+            auto next = UINT64_MAX;
+            for(const auto& stream : s_streams)
+                next = std::min(next, stream.next_ts);
+            const auto now = os_gettime_ns();
+            if(next > now)
+            {
+                if(next == UINT64_MAX)
+                    s_cv.wait(lock);
+                else
+                    s_cv.wait_for(lock, std::chrono::nanoseconds(next - now));
+                continue;
+            }
+
+            due.clear();
+            for(auto& stream : s_streams)
+            {
+                if(stream.next_ts > now)
+                    continue;
+                // a late thread skips ahead instead of bursting
+                stream.next_ts = std::max(stream.next_ts + stream.period_ns, now);
+                due.push_back(stream);
+            }
+            lock.unlock();
+
+            for(auto& stream : due)
+            {
+                if(!read_frame(stream, frame) || (frame.sequence == stream.sequence))
+                    continue;
+                stream.sequence = frame.sequence;
+                auto data = obs_data_create();
+                write_frame(stream, frame, data);
+                calldata_t cd = {};
+                calldata_set_string(&cd, "type", "Frame");
+                calldata_set_ptr(&cd, "data", data);
+                vendor_call("vendor_event_emit", &cd);
+                calldata_free(&cd);
+                obs_data_release(data);
+            }
+
+            lock.lock();
+            // remember what went out, unless the stream was replaced meanwhile
+            for(const auto& sent : due)
+                for(auto& stream : s_streams)
+                    if((stream.source == sent.source) && (stream.kind == sent.kind) && (stream.period_ns == sent.period_ns))
+                        stream.sequence = std::max(stream.sequence, sent.sequence);
+        }
+    }
+
+    void start_stream(obs_data_t *request, obs_data_t *response, [[maybe_unused]] void *priv)
+    {
+        Stream stream;
+        if(!parse_stream(request, response, stream))
+            return;
+        stream.next_ts = os_gettime_ns();
+        {
+            std::lock_guard lock(s_mtx);
+            std::erase_if(s_streams, [&](const Stream& s) { return s.source == stream.source; });
+            s_streams.push_back(std::move(stream));
+        }
+        s_cv.notify_one();
+    }
+
+    void stop_stream(obs_data_t *request, [[maybe_unused]] obs_data_t *response, [[maybe_unused]] void *priv)
+    {
+        const auto name = obs_data_get_string(request, "sourceName");
+        std::lock_guard lock(s_mtx);
+        if((name == nullptr) || (*name == '\0'))
+            s_streams.clear();
+        else
+            std::erase_if(s_streams, [&](const Stream& s) { return s.source == name; });
+    }
+
+    void get_frame(obs_data_t *request, obs_data_t *response, [[maybe_unused]] void *priv)
+    {
+        Stream stream;
+        if(!parse_stream(request, response, stream))
+            return;
+        Frame frame;
+        if(!read_frame(stream, frame))
+        {
+            obs_data_set_string(response, "error", "no waveform source of that name with a published frame of that kind");
+            return;
+        }
+        write_frame(stream, frame, response);
+    }
+
+    bool register_request(const char *type, RequestFn fn)
+    {
+        RequestCallback callback{ fn, nullptr }; // copied by obs-websocket
+        calldata_t cd = {};
+        calldata_set_string(&cd, "type", type);
+        calldata_set_ptr(&cd, "callback", &callback);
+        const auto ok = vendor_call("vendor_request_register", &cd);
+        calldata_free(&cd);
+        return ok;
+    }
+
+    bool unregister_request(const char *type)
+    {
+        calldata_t cd = {};
+        calldata_set_string(&cd, "type", type);
+        const auto ok = vendor_call("vendor_request_unregister", &cd);
+        calldata_free(&cd);
+        return ok;
+    }
+}
+
+void WebsocketVendor::start()
+{
+    calldata_t cd = {};
+    if(proc_handler_call(obs_get_proc_handler(), "obs_websocket_api_get_ph", &cd))
+        s_ph = static_cast<proc_handler_t*>(calldata_ptr(&cd, "ph"));
+    calldata_free(&cd);
+    if(s_ph == nullptr)
+        return; // obs-websocket isn't loaded
+
+    cd = {};
+    calldata_set_string(&cd, "name", MODULE_NAME);
+    proc_handler_call(s_ph, "vendor_register", &cd);
+    s_vendor = calldata_ptr(&cd, "vendor");
+    calldata_free(&cd);
+    if(s_vendor == nullptr)
+    {
+        LogWarn << "Failed to register the obs-websocket vendor";
+        return;
+    }
+
+    if(!register_request("StartStream", &start_stream) || !register_request("StopStream", &stop_stream) || !register_request("GetFrame", &get_frame))
+        LogWarn << "Failed to register obs-websocket vendor requests";
+
+    std::lock_guard lock(s_mtx);
+    s_stop = false;
+    if(!s_thread.joinable())
+        s_thread = std::thread(stream_thread);
+}
+
+void WebsocketVendor::stop()
+{
+    // obs-websocket may outlive this module, it mustn't keep calling into it
+    if(s_vendor != nullptr)
+    {
+        auto ok = unregister_request("StartStream");
+        ok = unregister_request("StopStream") && ok;
+        ok = unregister_request("GetFrame") && ok;
+        if(!ok)
+            LogWarn << "Failed to unregister obs-websocket vendor requests";
+    }
+
+    {
+        std::lock_guard lock(s_mtx);
+        s_stop = true;
+        s_streams.clear();
+    }
+    s_cv.notify_all();
+    if(s_thread.joinable())
+        s_thread.join();
+    s_vendor = nullptr;
+}
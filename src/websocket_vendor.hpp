@@ -0,0 +1,44 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+// obs-websocket 5 vendor "phandasm_waveform", for dashboards that would otherwise poll levels as JSON floats.
+// Talks to obs-websocket through the proc handler it registers, the same calls its obs-websocket-api.h makes,
+// so there is nothing to build against and nothing happens when obs-websocket isn't loaded.
+//
+// Requests:
+//   StartStream { sourceName, kind, bits, rate, points, floor, ceiling }
+//       emit a "Frame" event for the source rate times a second, replacing an earlier stream of the same source
+//       kind "bands" (default) for the bars of bar modes, "spectrum" for the bins, "meter" for the meter levels
+//       bits 8 (default) or 16, rate 1 to 120 Hz (default 30), points resamples to a fixed count (0 keeps the source's)
+//       floor and ceiling in dBFS map to 0 and the largest value (default -90 and 0)
+//   StopStream { sourceName }         stop streaming it, every stream without a name
+//   GetFrame { same as StartStream }  the fields of one Frame event in the response
+// Event "Frame" { sourceName, kind, bits, channels, count, sequence, audioTs, floor, ceiling, data }
+//   data is base64 of channels * count unsigned values, channel after channel, 16 bits little endian
+//   only emitted when the source published something new since the last one
+// Failed requests answer with an "error" string.
+//
+// Frames are read from the snapshots of waveform_api.h on a thread of our own, never inside a source's tick.
+class WebsocketVendor
+{
+public:
+    static void start();    // register with obs-websocket, after every module has loaded
+    static void stop();     // stop streaming, obs-websocket may be unloaded already
+};
@@ -0,0 +1,211 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Round trip of the capture log format, run by ctest.
+// A session of blocks and ticks goes through CaptureLog and is read back with CaptureReplay:
+// the interleaving, samples and flags have to come back as pushed, a truncated last record has to end the replay,
+// and the events drive the DSP kernels the way a profiling harness would.
+
+#include "capture_log.hpp"
+#include "capture_replay.hpp"
+#include "dsp_kernels.hpp"
+#include <obs-module.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t RATE = 48000;
+    constexpr uint32_t CHANNELS = 2;
+    constexpr uint32_t FRAMES = 1024;       // AUDIO_OUTPUT_FRAMES
+    constexpr uint32_t BLOCKS = 32;
+    constexpr uint32_t BURST_TICKS = 8192;  // several times what the tick ring holds
+    constexpr uint64_t TICK_BASE = 1ull << 40;
+    constexpr size_t HEADER_BYTES = 20;     // file header
+    constexpr size_t RECORD_BYTES = 24;     // record header
+
+    int s_failures = 0;
+
+    void check(bool ok, const char *what)
+    {
+        if(!ok)
+            ++s_failures;
+        std::printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    }
+
+    float sample(uint32_t block, uint32_t channel, uint32_t frame)
+    {
+        return (float)((block * 7919u + channel * 104729u + frame) % 2001u) / 1000.0f - 1.0f;
+    }
+
+    // what was pushed, in order
+    struct Expected
+    {
+        CaptureReplay::Type type;
+        uint64_t timestamp;
+        bool muted;
+        uint32_t block;
+    };
+
+    std::vector<Expected> write_session(const std::string& path)
+    {
+        std::vector<Expected> ret;
+        CaptureLog log;
+        if(!log.open(path, RATE))
+            return ret;
+
+        // the writer polls, so the burst overflows the tick ring before it wakes up
+        uint64_t tick = 0;
+        for(auto i = 0u; i < BURST_TICKS; ++i)
+            log.push_tick(TICK_BASE + tick++, 1.0f / 60.0f);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        std::vector<float> planes(CHANNELS * FRAMES);
+        for(auto block = 0u; block < BLOCKS; ++block)
+        {
+            audio_data audio = {};
+            for(auto channel = 0u; channel < CHANNELS; ++channel)
+            {
+                for(auto frame = 0u; frame < FRAMES; ++frame)
+                    planes[(channel * FRAMES) + frame] = sample(block, channel, frame);
+                audio.data[channel] = reinterpret_cast<uint8_t*>(&planes[channel * FRAMES]);
+            }
+            audio.frames = FRAMES;
+            audio.timestamp = (uint64_t)block * FRAMES * 1000000000ull / RATE;
+            const auto muted = (block % 5) == 3;
+            log.push_block(&audio, CHANNELS, muted, block);
+            ret.push_back({ CaptureReplay::Type::BLOCK, audio.timestamp, muted, block });
+            if((block % 2) == 1)
+            {
+                log.push_tick(TICK_BASE + tick, 1.0f / 60.0f);
+                ret.push_back({ CaptureReplay::Type::TICK, TICK_BASE + tick++, false, 0 });
+            }
+        }
+        log.close();
+        return ret;
+    }
+}
+
+int main()
+{
+    const auto path = (std::filesystem::temp_directory_path() / "waveform_capture_check.bin").string();
+    const auto expected = write_session(path);
+    check(!expected.empty(), "capture log created");
+
+    CaptureReplay replay;
+    check(replay.open(path) && (replay.sample_rate() == RATE), "capture log opened");
+
+    // the burst ticks come first, some of them dropped, the next record of a ring after a gap carries the lost flag
+    CaptureReplay::Event event;
+    uint64_t next_tick = TICK_BASE;
+    auto lost = false;
+    auto burst = 0u;
+    auto flags = true;
+    while(replay.next(event) && (event.type == CaptureReplay::Type::TICK) && (event.timestamp < TICK_BASE + BURST_TICKS))
+    {
+        flags = flags && (event.lost == (event.timestamp != next_tick));
+        lost = lost || event.lost;
+        next_tick = event.timestamp + 1;
+        ++burst;
+    }
+    check((burst > 0) && (burst < BURST_TICKS), "tick burst overflowed the ring");
+
+    // then the session exactly as pushed, its first record has been read already
+    const auto& kernels = DSPKernels::get();
+    auto in_order = true;
+    auto samples = true;
+    auto peaks = true;
+    auto blocks = 0u;
+    for(size_t i = 0; i < expected.size(); ++i)
+    {
+        if((i > 0) && !replay.next(event))
+        {
+            in_order = false;
+            break;
+        }
+        const auto& want = expected[i];
+        if((event.type != want.type) || (event.timestamp != want.timestamp))
+        {
+            in_order = false;
+            break;
+        }
+        if(event.type == CaptureReplay::Type::TICK)
+        {
+            flags = flags && !event.muted && (event.lost == (event.timestamp != next_tick)) && (event.seconds == 1.0f / 60.0f);
+            lost = lost || event.lost;
+            next_tick = event.timestamp + 1;
+            continue;
+        }
+        ++blocks;
+        flags = flags && (event.muted == want.muted) && !event.lost;
+        samples = samples && (event.channels == CHANNELS) && (event.frames == FRAMES) && (event.arrival_ts == want.block);
+        for(auto channel = 0u; samples && (channel < event.channels); ++channel)
+        {
+            auto peak = 0.0f;
+            for(auto frame = 0u; frame < FRAMES; ++frame)
+            {
+                samples = samples && (event.channel(channel)[frame] == sample(want.block, channel, frame));
+                peak = std::max(peak, std::abs(sample(want.block, channel, frame)));
+            }
+
+            // what a replay harness does with a block, through the kernels the source uses
+            peaks = peaks && (kernels.waveform_peak(event.channel(channel), event.frames) == peak);
+        }
+    }
+    check(in_order && !replay.next(event), "blocks and ticks in arrival order");
+    check(flags && lost, "muted and lost flags as pushed");
+    check(samples && (blocks == BLOCKS), "block samples as pushed");
+    check(peaks, "replayed blocks through the DSP kernels");
+    replay.close();
+
+    // a record cut short ends the replay after the records before it
+    const auto size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, size - 10);
+    auto records = 0u;
+    replay.open(path);
+    while(replay.next(event))
+        ++records;
+    check(records == burst + expected.size() - 1, "truncated final record rejected");
+
+    // as is a block claiming more frames than OBS ever delivers
+    std::filesystem::resize_file(path, HEADER_BYTES + RECORD_BYTES);
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        const uint8_t header[8] = { 1, 0, 1, 0, 0xff, 0xff, 0xff, 0xff };
+        file.seekp(HEADER_BYTES);
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    }
+    replay.open(path);
+    check(!replay.next(event), "oversized block rejected");
+    replay.close();
+    std::filesystem::remove(path);
+
+    if(s_failures > 0)
+    {
+        std::printf("%d capture checks failed\n", s_failures);
+        return 1;
+    }
+    return 0;
+}
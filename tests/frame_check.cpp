@@ -0,0 +1,183 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Round trip of the frame recording format, run by ctest.
+// Frames go through FrameRecorder and are loaded back with FramePlayback: values have to come back within fp16 rounding,
+// timestamps and layouts exactly, and a recording cut off in its last block has to load the blocks before it.
+
+#include "frame_recorder.hpp"
+#include "frame_playback.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr size_t FRAMES = 200;              // below the recorder's queue, none are dropped
+    constexpr size_t LAYOUT_CHANGE = 100;       // frame from which the layout is halved, a key frame mid block
+    constexpr size_t COUNT = 2048;              // values per channel, over a block's worth of frames in total
+    constexpr uint64_t FRAME_NS = 16666667;
+    constexpr float HALF_TOLERANCE = 1.0f / 2048.0f; // relative, fp16 has an 11 bit mantissa
+    constexpr size_t FILE_HEADER_BYTES = 16;
+    constexpr size_t BLOCK_HEADER_BYTES = 20;
+
+    int s_failures = 0;
+
+    void check(bool ok, const char *what)
+    {
+        if(!ok)
+            ++s_failures;
+        std::printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    }
+
+    size_t frame_count(size_t frame)
+    {
+        return (frame < LAYOUT_CHANGE) ? COUNT : COUNT / 2;
+    }
+
+    float value(size_t frame, uint32_t channel, size_t index)
+    {
+        return -100.0f * (float)((frame * 31 + channel * 977 + index * 7) % 1000) / 999.0f;
+    }
+
+    float hz(size_t frame, size_t index)
+    {
+        return (float)(index + 1) * ((frame < LAYOUT_CHANGE) ? 10.0f : 20.0f);
+    }
+
+    bool record(const std::string& path)
+    {
+        FrameRecorder recorder;
+        if(!recorder.open(path))
+            return false;
+        std::vector<float> values[2];
+        std::vector<float> freqs;
+        for(size_t frame = 0; frame < FRAMES; ++frame)
+        {
+            const auto count = frame_count(frame);
+            freqs.resize(count);
+            for(size_t i = 0; i < count; ++i)
+                freqs[i] = hz(frame, i);
+            FrameRecorder::Frame out;
+            out.frame_ts = 1000000000ull + (frame * FRAME_NS);
+            out.audio_ts = 5000000000ull + (frame * FRAME_NS);
+            out.channels = 2;
+            out.count = count;
+            out.hz = freqs.data();
+            for(auto channel = 0u; channel < 2; ++channel)
+            {
+                values[channel].resize(count);
+                for(size_t i = 0; i < count; ++i)
+                    values[channel][i] = value(frame, channel, i);
+                out.values[channel] = values[channel].data();
+            }
+            recorder.push(out);
+        }
+        recorder.close();
+        return true;
+    }
+
+    bool load(FramePlayback& playback, const std::string& path)
+    {
+        playback.open(path);
+        for(auto i = 0; (i < 1000) && !playback.ready(); ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        return playback.ready();
+    }
+
+    // frames first to last of the playback match what was recorded
+    bool compare(const FramePlayback& playback, size_t first, size_t last, float& deviation)
+    {
+        deviation = 0.0f;
+        for(auto frame = first; frame < last; ++frame)
+        {
+            FramePlayback::Frame in;
+            if(!playback.find(frame * FRAME_NS, in) || (in.index != frame) || (in.time != frame * FRAME_NS)
+                || (in.audio_ts != 5000000000ull + (frame * FRAME_NS)) || (in.channels != 2) || (in.count != frame_count(frame)))
+                return false;
+            for(size_t i = 0; i < in.count; ++i)
+            {
+                if(in.hz[i] != hz(frame, i))
+                    return false;
+                for(auto channel = 0u; channel < 2; ++channel)
+                {
+                    const auto want = value(frame, channel, i);
+                    const auto got = FramePlayback::from_half(in.values[(channel * in.count) + i]);
+                    deviation = std::max(deviation, std::abs(got - want) / std::max(std::abs(want), 1.0f));
+                }
+            }
+        }
+        return true;
+    }
+
+    // frames in the first block of the file
+    uint32_t first_block_frames(const std::string& path, size_t& block_end)
+    {
+        std::ifstream file(path, std::ios::binary);
+        uint32_t header[5] = {};
+        file.seekg(FILE_HEADER_BYTES);
+        file.read(reinterpret_cast<char*>(header), sizeof(header));
+        block_end = FILE_HEADER_BYTES + BLOCK_HEADER_BYTES + header[4];
+        return file ? header[2] : 0;
+    }
+}
+
+int main()
+{
+    const auto path = (std::filesystem::temp_directory_path() / "waveform_frame_check.bin").string();
+    check(record(path), "recording created");
+
+    FramePlayback playback;
+    float deviation = 0.0f;
+    check(load(playback, path), "recording loaded");
+    check(compare(playback, 0, FRAMES, deviation), "frames, timestamps and layouts as recorded");
+    check(deviation <= HALF_TOLERANCE, "values within fp16 rounding");
+    check(playback.duration() == (FRAMES - 1) * FRAME_NS, "duration of the recording");
+    playback.close();
+    std::printf("     max relative deviation %g\n", (double)deviation);
+
+    // the recording cut off in its last frame, then in the header of its last block
+    size_t block_end = 0;
+    const auto kept = first_block_frames(path, block_end);
+    const auto size = std::filesystem::file_size(path);
+    check((kept > 0) && (kept < FRAMES) && (block_end < size), "recording spans several blocks");
+    for(auto cut : { size - 10, block_end + 10 })
+    {
+        std::filesystem::resize_file(path, cut);
+        auto ok = load(playback, path) && compare(playback, 0, kept, deviation);
+        FramePlayback::Frame last;
+        ok = ok && playback.find(FRAMES * FRAME_NS, last) && (last.index == kept - 1);
+        check(ok, (cut == block_end + 10) ? "truncated block header rejected" : "truncated trailing frame rejected");
+        playback.close();
+    }
+    std::filesystem::remove(path);
+
+    if(s_failures > 0)
+    {
+        std::printf("%d frame checks failed\n", s_failures);
+        return 1;
+    }
+    return 0;
+}
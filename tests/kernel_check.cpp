@@ -0,0 +1,499 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Equivalence check of every kernel tier against the portable kernels, run by ctest.
+// Each tier this CPU supports gets the same deterministic inputs as the generic kernels,
+// one line per kernel with the largest deviation, any deviation beyond tolerance fails the test.
+
+#include "kernel_inputs.hpp"
+#include "dsp_kernels.hpp"
+#include "analysis_kernels.hpp"
+#include "iir_filterbank.hpp"
+#include "filter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr float DB_TOLERANCE = 1e-3f;       // dB, FMA and summation order differences stay well below
+    constexpr float RELATIVE_TOLERANCE = 1e-4f; // linear values, relative to the reference or to 1 below it
+    constexpr float HALF_TOLERANCE = 4e-3f;     // relative, fp16 smoothing history has an 11 bit mantissa
+    constexpr float MISMATCH = std::numeric_limits<float>::infinity(); // a flag or index differs
+
+    int s_failures = 0;
+
+    void report(const std::string& kernel, const char *tier, float deviation, float tolerance)
+    {
+        const auto ok = deviation <= tolerance; // NaN fails
+        if(!ok)
+            ++s_failures;
+        std::printf("%s %-48s %-10s max deviation %g\n", ok ? "ok  " : "FAIL", kernel.c_str(), tier, (double)deviation);
+    }
+
+    float max_abs(const float *out, const float *reference, size_t first, size_t last)
+    {
+        auto ret = 0.0f;
+        for(auto i = first; i < last; ++i)
+            ret = std::max(ret, std::abs(out[i] - reference[i]));
+        return ret;
+    }
+
+    float max_rel(const float *out, const float *reference, size_t first, size_t last)
+    {
+        auto ret = 0.0f;
+        for(auto i = first; i < last; ++i)
+            ret = std::max(ret, std::abs(out[i] - reference[i]) / std::max(std::abs(reference[i]), 1.0f));
+        return ret;
+    }
+
+    AlignedBuffer<float> make_buffer(size_t count, float value)
+    {
+        AlignedBuffer<float> ret;
+        ret.reset(count);
+        std::fill(ret.get(), ret.get() + count, value);
+        return ret;
+    }
+
+    AlignedBuffer<float> copy_buffer(const AlignedBuffer<float>& src)
+    {
+        AlignedBuffer<float> ret;
+        ret.reset(src.size());
+        std::copy(src.get(), src.get() + src.size(), ret.get());
+        return ret;
+    }
+
+    // interpolation, bands, filterbank, smoothing, dB heights and the IIR bands
+    void check_display(const DSPKernels& kernels, const char *tier)
+    {
+        const auto spectrum = make_spectrum();
+        const auto samples = spectrum.get();
+        const auto sz = spectrum.size();
+
+        // curve, one point per column
+        const auto points = make_indices(POINTS);
+        for(auto lanczos : { true, false })
+        {
+            auto kernel = lanczos ? make_lanczos_kernel(points, 4) : make_catrom_kernel(0.5f);
+            set_interior(kernel, points, sz);
+            auto reference = make_buffer(POINTS, 0.0f);
+            auto out = make_buffer(POINTS, 0.0f);
+            apply_interp_filter(samples, sz, points, kernel, std::span<float>(reference.get(), POINTS));
+            kernels.interp(samples, sz, points, kernel, std::span<float>(out.get(), POINTS));
+            report(lanczos ? "curve lanczos" : "curve catmull-rom", tier, max_abs(out.get(), reference.get(), 0, POINTS), DB_TOLERANCE);
+        }
+
+        // bars, every bin of a band
+        std::vector<int> band_widths;
+        std::vector<float> bins;
+        make_bands(BARS, band_widths, bins);
+        for(auto lanczos : { true, false })
+        {
+            if(kernels.bands == nullptr)
+                break;
+            auto kernel = lanczos ? make_lanczos_kernel(bins, 4) : make_catrom_kernel(0.5f);
+            set_interior(kernel, bins, sz);
+            auto reference = make_buffer(BARS, 0.0f);
+            auto out = make_buffer(BARS, 0.0f);
+            apply_interp_filter(samples, sz, band_widths, bins, kernel, std::span<float>(reference.get(), BARS));
+            kernels.bands(samples, sz, band_widths, bins, kernel, std::span<float>(out.get(), BARS));
+            report(lanczos ? "bars lanczos" : "bars catmull-rom", tier, max_abs(out.get(), reference.get(), 0, BARS), DB_TOLERANCE);
+        }
+
+        // perceptual bands, as if the spectrum came from a 48 kHz FFT
+        {
+            const auto bank = make_filterbank(BandScale::MEL, BARS, 20.0f, 20000.0f, 24000.0f / (float)sz, sz);
+            auto reference = make_buffer(BARS, 0.0f);
+            auto out = make_buffer(BARS, 0.0f);
+            apply_filterbank(samples, bank, std::span<float>(reference.get(), BARS));
+            kernels.filterbank(samples, bank, std::span<float>(out.get(), BARS));
+            report("bars mel filterbank", tier, max_abs(out.get(), reference.get(), 0, BARS), DB_TOLERANCE);
+        }
+
+        // smoothing filter over the curve
+        auto curve = make_buffer(POINTS, 0.0f);
+        {
+            auto kernel = make_catrom_kernel(0.5f);
+            set_interior(kernel, points, sz);
+            apply_interp_filter(samples, sz, points, kernel, std::span<float>(curve.get(), POINTS));
+        }
+        {
+            const auto gauss = make_gauss_kernel(2.0f);
+            auto reference = make_buffer(POINTS, 0.0f);
+            auto out = make_buffer(POINTS, 0.0f);
+            apply_filter(curve.get(), POINTS, gauss, std::span<float>(reference.get(), POINTS));
+            kernels.filter(curve.get(), POINTS, gauss, std::span<float>(out.get(), POINTS));
+            report("gauss filter", tier, max_abs(out.get(), reference.get(), 0, POINTS), DB_TOLERANCE);
+        }
+
+        // pixel heights of the curve and the index of the topmost point
+        {
+            auto reference = copy_buffer(curve);
+            auto out = copy_buffer(curve);
+            float miny_reference, miny;
+            const auto top_reference = map_db_heights(reference.get(), POINTS, 0.0f, 65.0f, 0.0f, 1080.0f, miny_reference);
+            const auto top = kernels.heights(out.get(), POINTS, 0.0f, 65.0f, 0.0f, 1080.0f, miny);
+            const auto deviation = std::max(max_abs(out.get(), reference.get(), 0, POINTS), std::abs(miny - miny_reference));
+            report("db heights", tier, (top == top_reference) ? deviation : MISMATCH, DB_TOLERANCE);
+        }
+
+        // third octave bands of two blocks of audio, the second runs on the state of the first
+        {
+            IIRFilterbank reference, bank;
+            reference.init(48000, 3, 20.0f, 20000.0f);
+            bank.init(48000, 3, 20.0f, 20000.0f);
+            const auto signal = make_signal(4096, 0x2468ace0u);
+            for(size_t offset = 0; offset < signal.size(); offset += 2048)
+            {
+                iir_bank(reference.pass(0, signal.get() + offset, 2048));
+                kernels.iir(bank.pass(0, signal.get() + offset, 2048));
+            }
+            std::vector<float> energy_reference(reference.bands()), energy(bank.bands());
+            reference.take_energy(0, energy_reference.data());
+            bank.take_energy(0, energy.data());
+            report("iir third octave bands", tier, max_rel(energy.data(), energy_reference.data(), 0, energy.size()), RELATIVE_TOLERANCE);
+        }
+    }
+
+    std::string variant_name(const SpectrumVariant& v)
+    {
+        std::string ret = "spectrum bins";
+        ret += v.power ? " power" : "";
+        ret += v.smooth ? " smooth" : "";
+        ret += v.fast_peaks ? " fast" : "";
+        ret += v.half_history ? " half" : "";
+        ret += v.accumulate ? " acc" : "";
+        ret += v.peak ? " peak" : "";
+        ret += v.onset ? " onset" : "";
+        ret += v.pair ? " pair" : "";
+        return ret;
+    }
+
+    // two frames through one variant, the second reads the history the first wrote
+    void run_bins(SpectrumBinsFn fn, bool pair, const fftwf_complex *const (&frames)[2][2], const float *gains, AlignedBuffer<float> (&out)[2], float (&flux)[2])
+    {
+        AlignedBuffer<float> history[2];
+        for(auto channel = 0; channel < 2; ++channel)
+        {
+            history[channel] = make_buffer(SPECTRUM_SIZE, 0.0f);
+            out[channel] = make_buffer(SPECTRUM_SIZE, 1.0f);
+        }
+        flux[0] = flux[1] = 0.0f;
+        for(const auto& frame : frames)
+        {
+            SpectrumBins args;
+            args.gains = gains;
+            args.flux = flux;
+            args.first_bin = 16; // 16 bin aligned like update() rounds them
+            args.last_bin = SPECTRUM_SIZE - 16;
+            args.gravity = 0.6f;
+            for(auto channel = 0; channel < (pair ? 2 : 1); ++channel)
+            {
+                args.in[channel] = frame[channel];
+                args.history[channel] = history[channel].get();
+                args.out[channel] = out[channel].get();
+            }
+            fn(args);
+        }
+    }
+
+    // the window through to dBFS, the reductions of the other modes and peak hold
+    void check_analysis(const DSPKernels& kernels, const char *tier)
+    {
+        constexpr size_t first = 16;
+        constexpr size_t last = SPECTRUM_SIZE - 16;
+
+        // every variant of the per bin pass
+        {
+            const AlignedBuffer<fftwf_complex> transforms[2][2] = {
+                { make_transform(SPECTRUM_SIZE, 1), make_transform(SPECTRUM_SIZE, 2) },
+                { make_transform(SPECTRUM_SIZE, 3), make_transform(SPECTRUM_SIZE, 4) }
+            };
+            const fftwf_complex *const frames[2][2] = {
+                { transforms[0][0].get(), transforms[0][1].get() },
+                { transforms[1][0].get(), transforms[1][1].get() }
+            };
+            auto gains = make_buffer(SPECTRUM_SIZE, 0.0f);
+            Lcg lcg{ 5 };
+            for(size_t i = 0; i < SPECTRUM_SIZE; ++i)
+                gains[i] = 0.5f + lcg.next();
+
+            for(auto bits = 0u; bits < 256u; ++bits)
+            {
+                SpectrumVariant v;
+                v.power = bits & 1;
+                v.smooth = bits & 2;
+                v.fast_peaks = bits & 4;
+                v.half_history = bits & 8;
+                v.accumulate = bits & 16;
+                v.peak = bits & 32;
+                v.onset = bits & 64;
+                v.pair = bits & 128;
+                if((v.fast_peaks && !v.smooth) || (v.half_history && !(v.smooth && kernels.half_history)) || (v.peak && !v.accumulate))
+                    continue;
+
+                auto rv = v;
+                rv.half_history = false;
+                AlignedBuffer<float> reference[2], out[2];
+                float flux_reference[2], flux[2];
+                run_bins(select_spectrum_bins_generic(rv), v.pair, frames, gains.get(), reference, flux_reference);
+                run_bins(kernels.bins(v), v.pair, frames, gains.get(), out, flux);
+                auto deviation = max_rel(out[0].get(), reference[0].get(), 0, SPECTRUM_SIZE);
+                if(v.pair)
+                    deviation = std::max(deviation, max_rel(out[1].get(), reference[1].get(), 0, SPECTRUM_SIZE));
+                if(v.onset)
+                    deviation = std::max(deviation, max_rel(flux, flux_reference, 0, 2));
+                report(variant_name(v), tier, deviation, v.half_history ? HALF_TOLERANCE : RELATIVE_TOLERANCE);
+            }
+        }
+
+        // frame average, channel mix and dBFS, with exact zeros for the db_min branch
+        for(auto bits = 0u; bits < 16u; ++bits)
+        {
+            SpectrumPostVariant v;
+            v.power = bits & 1;
+            v.mix = bits & 2;
+            v.stereo = bits & 4;
+            v.copy = bits & 8;
+            AlignedBuffer<float> input[2] = { make_buffer(SPECTRUM_SIZE, 0.0f), make_buffer(SPECTRUM_SIZE, 0.0f) };
+            Lcg lcg{ 6 };
+            for(size_t i = 0; i < SPECTRUM_SIZE; ++i)
+            {
+                input[0][i] = (i % 97 == 0) ? 0.0f : lcg.next() * 10.0f;
+                input[1][i] = (i % 89 == 0) ? 0.0f : lcg.next() * 10.0f;
+            }
+            AlignedBuffer<float> reference[2] = { copy_buffer(input[0]), copy_buffer(input[1]) };
+            AlignedBuffer<float> out[2] = { copy_buffer(input[0]), copy_buffer(input[1]) };
+            SpectrumPost args;
+            args.first_bin = first;
+            args.last_bin = last;
+            args.scale[0] = 0.5f;
+            args.scale[1] = 0.25f;
+            args.compensation = 3.0f;
+            args.db_min = -120.0f;
+            args.out[0] = reference[0].get();
+            args.out[1] = reference[1].get();
+            select_spectrum_post_generic(v)(args);
+            args.out[0] = out[0].get();
+            args.out[1] = out[1].get();
+            kernels.post(v)(args);
+            const auto deviation = std::max(max_abs(out[0].get(), reference[0].get(), first, last), max_abs(out[1].get(), reference[1].get(), first, last));
+            std::string name = "spectrum post";
+            name += v.power ? " power" : "";
+            name += v.mix ? " mix" : "";
+            name += v.stereo ? " stereo" : "";
+            name += v.copy ? " copy" : "";
+            report(name, tier, deviation, DB_TOLERANCE);
+        }
+
+        // windowing from an unaligned position in the ring, odd length for the tails
+        const auto signal = make_signal(8192, 0x13579bdfu);
+        {
+            constexpr size_t count = 4093;
+            auto window = make_buffer(count, 0.0f);
+            for(size_t i = 0; i < count; ++i)
+                window[i] = 0.5f - (0.5f * std::cos(6.2831853f * (float)i / (float)count));
+            for(auto windowed : { true, false })
+            {
+                auto reference = make_buffer(count, 0.0f);
+                auto out = make_buffer(count, 0.0f);
+                const auto wptr = windowed ? window.get() : nullptr;
+                const auto ret_reference = window_input_generic(reference.get(), signal.get() + 3, wptr, count);
+                const auto ret = kernels.window(out.get(), signal.get() + 3, wptr, count);
+                report(windowed ? "window input" : "window input without window", tier, (ret == ret_reference) ? max_abs(out.get(), reference.get(), 0, count) : MISMATCH, 1e-6f);
+            }
+            const auto silence = make_buffer(count, 0.0f);
+            auto out = make_buffer(count, 1.0f);
+            report("window input silence", tier, kernels.window(out.get(), silence.get() + 1, window.get(), count - 1) ? MISMATCH : max_abs(out.get(), silence.get(), 0, count - 1), 0.0f);
+
+            for(auto accumulate : { false, true })
+            {
+                auto reference = copy_buffer(window);
+                auto out = copy_buffer(window);
+                mix_input_generic(reference.get(), signal.get() + 5, 0.7f, count, accumulate);
+                kernels.mix(out.get(), signal.get() + 5, 0.7f, count, accumulate);
+                report(accumulate ? "mix input accumulate" : "mix input", tier, max_abs(out.get(), reference.get(), 0, count), 1e-6f);
+            }
+        }
+
+        // silence check on a dB spectrum, limits above, inside and below its range
+        {
+            const auto spectrum = make_spectrum();
+            auto deviation = 0.0f;
+            for(auto limit : { 0.0f, -40.0f, -100.0f })
+                if(kernels.below(spectrum.get(), first, last, limit) != all_below_generic(spectrum.get(), first, last, limit))
+                    deviation = MISMATCH;
+            report("all below", tier, deviation, 0.0f);
+        }
+
+        // meter blocks of interleaved frames
+        for(auto lanes : { 1u, 2u, 4u, 8u })
+        {
+            constexpr size_t frames = 501;
+            float peaks_reference[8], squares_reference[8], peaks[8], squares[8];
+            meter_reduce_generic(signal.get() + 1, frames, lanes, peaks_reference, squares_reference);
+            kernels.meter_reduce(signal.get() + 1, frames, lanes, peaks, squares);
+            const auto deviation = std::max(max_abs(peaks, peaks_reference, 0, lanes), max_rel(squares, squares_reference, 0, lanes));
+            report("meter reduce " + std::to_string(lanes) + " lanes", tier, deviation, RELATIVE_TOLERANCE);
+        }
+
+        // waveform columns, peaks then their dB in place in the ring
+        {
+            const auto peak = kernels.waveform_peak(signal.get() + 3, 997);
+            const auto peak_reference = waveform_peak_generic(signal.get() + 3, 997);
+            report("waveform peak", tier, std::abs(peak - peak_reference), 0.0f);
+        }
+        for(auto bits = 0u; bits < 8u; ++bits)
+        {
+            constexpr size_t ring = 1024;
+            AlignedBuffer<float> input[2] = { make_buffer(ring, 0.0f), make_buffer(ring, 0.0f) };
+            for(size_t i = 0; i < ring; ++i)
+            {
+                input[0][i] = (i % 61 == 0) ? 0.0f : std::abs(signal[i]);
+                input[1][i] = std::abs(signal[i + ring]);
+            }
+            AlignedBuffer<float> reference[2] = { copy_buffer(input[0]), copy_buffer(input[1]) };
+            AlignedBuffer<float> out[2] = { copy_buffer(input[0]), copy_buffer(input[1]) };
+            WaveformPost args;
+            args.pos = 37;
+            args.count = 611;
+            args.compensation = 2.5f;
+            args.db_min = -120.0f;
+            args.stereo = bits & 1;
+            args.mix = bits & 2;
+            args.copy = bits & 4;
+            if(args.mix && (args.stereo || args.copy))
+                continue;
+            args.values[0] = reference[0].get();
+            args.values[1] = reference[1].get();
+            waveform_post_generic(args);
+            args.values[0] = out[0].get();
+            args.values[1] = out[1].get();
+            kernels.waveform_post(args);
+            std::string name = "waveform post";
+            name += args.stereo ? " stereo" : "";
+            name += args.mix ? " mix" : "";
+            name += args.copy ? " copy" : "";
+            report(name, tier, std::max(max_abs(out[0].get(), reference[0].get(), 0, ring), max_abs(out[1].get(), reference[1].get(), 0, ring)), DB_TOLERANCE);
+        }
+
+        // scope trigger, the last rising crossing, including a level nothing crosses
+        {
+            auto deviation = 0.0f;
+            for(auto level : { 0.1f, -0.3f, 0.9f, 2.0f })
+                for(auto count : { (size_t)1000, (size_t)37, (size_t)5 })
+                    if(kernels.scope_trigger(signal.get() + 7, count, level) != scope_trigger_generic(signal.get() + 7, count, level))
+                        deviation = MISMATCH;
+            report("scope trigger", tier, deviation, 0.0f);
+        }
+
+        // peak hold over a few passes, some peaks held and some falling
+        for(auto channels : { 1u, 2u })
+        {
+            const auto spectrum = make_spectrum();
+            AlignedBuffer<float> db[2] = { copy_buffer(spectrum), copy_buffer(spectrum) };
+            AlignedBuffer<float> peak_reference[2], timer_reference[2], peak[2], timer[2];
+            Lcg lcg{ 7 };
+            for(auto channel = 0; channel < 2; ++channel)
+            {
+                peak_reference[channel] = make_buffer(SPECTRUM_SIZE, 0.0f);
+                timer_reference[channel] = make_buffer(SPECTRUM_SIZE, 0.0f);
+                for(size_t i = 0; i < SPECTRUM_SIZE; ++i)
+                {
+                    peak_reference[channel][i] = spectrum[i] + (10.0f * lcg.next()) - 3.0f;
+                    timer_reference[channel][i] = lcg.next() - 0.5f;
+                }
+                peak[channel] = copy_buffer(peak_reference[channel]);
+                timer[channel] = copy_buffer(timer_reference[channel]);
+            }
+            PeakHold args;
+            args.channels = channels;
+            args.first_bin = first;
+            args.last_bin = last;
+            args.seconds = 1.0f / 60.0f;
+            args.fall = 0.5f;
+            args.hold_time = 1.0f;
+            args.db_min = -120.0f;
+            for(auto pass = 0; pass < 4; ++pass)
+            {
+                for(auto channel = 0; channel < 2; ++channel)
+                {
+                    for(size_t i = 0; i < SPECTRUM_SIZE; ++i)
+                        db[channel][i] = spectrum[i] + (8.0f * lcg.next()) - 4.0f;
+                    args.db[channel] = db[channel].get();
+                }
+                for(auto channel = 0; channel < 2; ++channel)
+                {
+                    args.peak[channel] = peak_reference[channel].get();
+                    args.timer[channel] = timer_reference[channel].get();
+                }
+                peak_hold_generic(args);
+                for(auto channel = 0; channel < 2; ++channel)
+                {
+                    args.peak[channel] = peak[channel].get();
+                    args.timer[channel] = timer[channel].get();
+                }
+                kernels.peak_hold(args);
+            }
+            auto deviation = 0.0f;
+            for(auto channel = 0; channel < 2; ++channel)
+                deviation = std::max({ deviation, max_abs(peak[channel].get(), peak_reference[channel].get(), 0, SPECTRUM_SIZE), max_abs(timer[channel].get(), timer_reference[channel].get(), 0, SPECTRUM_SIZE) });
+            report(channels == 1 ? "peak hold" : "peak hold stereo", tier, deviation, 1e-5f);
+        }
+    }
+}
+
+int main()
+{
+    for(const auto& tier : cpu_tiers())
+    {
+        const auto kernels = DSPKernels::resolve(tier.levels);
+        check_display(kernels, tier.name);
+        check_analysis(kernels, tier.name);
+    }
+
+    // the running sum variant of the bars is portable but has its own rounding
+    {
+        const auto spectrum = make_spectrum();
+        std::vector<int> band_widths;
+        std::vector<float> bins;
+        make_bands(BARS, band_widths, bins);
+        std::vector<double> prefix;
+        for(auto lanczos : { true, false })
+        {
+            auto kernel = lanczos ? make_lanczos_kernel(bins, 4) : make_catrom_kernel(0.5f);
+            set_interior(kernel, bins, spectrum.size());
+            auto reference = make_buffer(BARS, 0.0f);
+            auto out = make_buffer(BARS, 0.0f);
+            apply_interp_filter(spectrum.get(), spectrum.size(), band_widths, bins, kernel, std::span<float>(reference.get(), BARS));
+            apply_interp_filter_prefix(spectrum.get(), spectrum.size(), band_widths, bins, kernel, prefix, std::span<float>(out.get(), BARS));
+            report(lanczos ? "bars lanczos" : "bars catmull-rom", "prefix", max_abs(out.get(), reference.get(), 0, BARS), DB_TOLERANCE);
+        }
+    }
+
+    if(s_failures > 0)
+    {
+        std::printf("%d kernel checks deviate beyond tolerance\n", s_failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,190 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "dsp_kernels.hpp"
+#include "aligned_buffer.hpp"
+#include "math_funcs.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#ifdef ENABLE_X86_SIMD
+#include "cpuinfo_x86.h"
+#endif
+
+// Deterministic inputs and the CPU tiers shared by the kernel check and the benchmark.
+// Everything comes from a fixed LCG so every platform and every run sees the same values.
+
+constexpr size_t SPECTRUM_SIZE = 4096;  // bins, an 8192 point FFT
+constexpr size_t POINTS = 1920;         // curve columns
+constexpr int BARS = 64;
+
+// one state per input, same values on every platform
+struct Lcg
+{
+    uint32_t state;
+
+    float next() noexcept // [0, 1)
+    {
+        state = (state * 1664525u) + 1013904223u;
+        return (float)(state >> 8) / (float)(1u << 24);
+    }
+};
+
+// every level at tier, what [cpu] tier selects when the CPU has it
+struct Tier
+{
+    const char *name;
+    DSPKernels::Levels levels;
+};
+
+inline Tier make_tier(const char *name, int level, bool fma, bool f16c)
+{
+    Tier ret{ name, {} };
+    ret.levels.interp = ret.levels.filter = ret.levels.filterbank = ret.levels.iir = ret.levels.analysis = level;
+    ret.levels.fma = fma;
+    ret.levels.f16c = f16c;
+    return ret;
+}
+
+// generic first, then every tier this CPU runs, the same detection as register_source()
+inline std::vector<Tier> cpu_tiers()
+{
+    std::vector<Tier> ret{ make_tier("generic", 0, false, false) };
+#ifdef ENABLE_X86_SIMD
+    const auto cpu = cpu_features::GetX86Info().features;
+    if(cpu.sse4_1)
+        ret.push_back(make_tier("sse4.1", 1, false, false));
+    if(cpu.avx)
+        ret.push_back(make_tier("avx", 2, false, false)); // Sandy Bridge, separate multiply and add
+    if(cpu.avx && cpu.fma3)
+        ret.push_back(make_tier("avx fma3", 2, true, false));
+    if(cpu.avx2 && cpu.fma3)
+        ret.push_back(make_tier("avx2", 3, true, cpu.f16c));
+    if(cpu.avx512f && cpu.avx2 && cpu.fma3)
+        ret.push_back(make_tier("avx512", 4, true, cpu.f16c));
+#elif defined(ENABLE_ARM_SIMD)
+    ret.push_back(make_tier("neon", 1, false, false));
+#ifdef ENABLE_ACCELERATE_FFT
+    ret.push_back(make_tier("accelerate", 2, false, false));
+#endif
+#endif // ENABLE_X86_SIMD
+    return ret;
+}
+
+// spectrum in dB, a tilted sweep of peaks over noise
+// the kernels expect AlignedBuffer storage like the source's buffers
+inline AlignedBuffer<float> make_spectrum()
+{
+    AlignedBuffer<float> ret;
+    ret.reset(SPECTRUM_SIZE);
+    Lcg lcg{ 0x12345678u };
+    for(size_t i = 0; i < SPECTRUM_SIZE; ++i)
+    {
+        const auto t = (float)i / (float)SPECTRUM_SIZE;
+        ret[i] = -30.0f - (40.0f * t) + (20.0f * std::sin(200.0f * t * t)) + (6.0f * lcg.next());
+    }
+    return ret;
+}
+
+// log spaced positions between bin 1 and the last bin, like a log scale graph
+inline std::vector<float> make_indices(size_t count)
+{
+    std::vector<float> ret(count);
+    for(size_t i = 0; i < count; ++i)
+        ret[i] = std::clamp(log_interp(1.0f, (float)(SPECTRUM_SIZE - 1), (float)i / (float)(count - 1)), 1.0f, (float)(SPECTRUM_SIZE - 1));
+    return ret;
+}
+
+// every bin of each of count log spaced bands, the same layout init_interp() builds for bars
+inline void make_bands(size_t count, std::vector<int>& band_widths, std::vector<float>& bins)
+{
+    const auto starts = make_indices(count + 1);
+    band_widths.assign(count, 0);
+    bins.clear();
+    for(size_t i = 0; i < count; ++i)
+    {
+        band_widths[i] = std::max((int)(starts[i + 1] - starts[i]), 1);
+        for(auto j = 0; j < band_widths[i]; ++j)
+            bins.push_back(starts[i] + (float)j);
+    }
+}
+
+// audio in [-1, 1], two sines over white noise
+inline AlignedBuffer<float> make_signal(size_t count, uint32_t seed)
+{
+    AlignedBuffer<float> ret;
+    ret.reset(count);
+    Lcg lcg{ seed };
+    for(size_t i = 0; i < count; ++i)
+    {
+        const auto t = (float)i / 48000.0f;
+        ret[i] = (0.5f * std::sin(6.2831853f * 440.0f * t)) + (0.25f * std::sin(6.2831853f * 3150.0f * t)) + (0.2f * ((2.0f * lcg.next()) - 1.0f));
+    }
+    return ret;
+}
+
+// log sine sweep from 20 Hz to 20 kHz over count samples at 48 kHz, -6 dBFS
+inline AlignedBuffer<float> make_sweep(size_t count)
+{
+    AlignedBuffer<float> ret;
+    ret.reset(count);
+    const auto duration = (double)count / 48000.0;
+    const auto k = std::log(20000.0 / 20.0);
+    for(size_t i = 0; i < count; ++i)
+    {
+        const auto t = (double)i / 48000.0;
+        const auto phase = 6.283185307179586 * 20.0 * duration / k * (std::exp(t / duration * k) - 1.0);
+        ret[i] = (float)(0.5 * std::sin(phase));
+    }
+    return ret;
+}
+
+// pink noise, Paul Kellet's economy filter over white noise from seed, about -10 dBFS
+inline AlignedBuffer<float> make_pink(size_t count, uint32_t seed)
+{
+    AlignedBuffer<float> ret;
+    ret.reset(count);
+    Lcg lcg{ seed };
+    float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+    for(size_t i = 0; i < count; ++i)
+    {
+        const auto white = (2.0f * lcg.next()) - 1.0f;
+        b0 = (0.99765f * b0) + (white * 0.0990460f);
+        b1 = (0.96300f * b1) + (white * 0.2965164f);
+        b2 = (0.57000f * b2) + (white * 1.0526913f);
+        ret[i] = (b0 + b1 + b2 + (white * 0.1848f)) * 0.1f;
+    }
+    return ret;
+}
+
+// transform output of a noisy frame, roughly the scale of a windowed full scale signal
+inline AlignedBuffer<fftwf_complex> make_transform(size_t count, uint32_t seed)
+{
+    AlignedBuffer<fftwf_complex> ret;
+    ret.reset(count);
+    Lcg lcg{ seed };
+    for(size_t i = 0; i < count; ++i)
+    {
+        ret[i][0] = ((2.0f * lcg.next()) - 1.0f) * 100.0f;
+        ret[i][1] = ((2.0f * lcg.next()) - 1.0f) * 100.0f;
+    }
+    return ret;
+}
@@ -0,0 +1,483 @@
+/*
+    Copyright (C) 2026 Devin Davila
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Timing of the per tick analysis and display kernels of every tier, outside of OBS.
+// A sine sweep, pink noise and silence run through emulated spectrum, meter and waveform ticks,
+// one line per signal, mode and size with the best time per tick of each tier the CPU runs.
+// Then the display filters on their own: kernel construction, smoothing and interpolation
+// across graph widths, radii and bar counts, and small transforms of several sources batched into one plan.
+
+#include "kernel_inputs.hpp"
+#include "dsp_kernels.hpp"
+#include "analysis_kernels.hpp"
+#include "filter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+#include <fftw3.h>
+
+namespace
+{
+    constexpr size_t TICK_FRAMES = 48000 / 60;  // new audio per tick at 60 fps
+    constexpr size_t SIGNAL_SIZE = 1 << 18;     // per channel, the largest window and every timed tick fit
+    constexpr float DB_MIN = -120.0f;
+    constexpr float FLOOR = -80.0f;             // graph range, silence below it skips the transform
+    constexpr float CEILING = 0.0f;
+
+    using Clock = std::chrono::steady_clock;
+
+    // best of a few batches of calls, the first batch also warms the caches
+    template<typename Fn>
+    double time_call(Fn&& fn)
+    {
+        constexpr auto batches = 5;
+        constexpr auto calls = 16;
+        auto best = std::numeric_limits<double>::max();
+        for(auto batch = 0; batch < batches; ++batch)
+        {
+            const auto start = Clock::now();
+            for(auto i = 0; i < calls; ++i)
+                fn();
+            best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start).count() / calls);
+        }
+        return best;
+    }
+
+    // stereo input, the channels are offset so they aren't identical
+    struct Signal
+    {
+        const char *name;
+        AlignedBuffer<float> channels[2];
+        AlignedBuffer<float> interleaved;   // meter ring layout
+    };
+
+    Signal make_input(const char *name, AlignedBuffer<float> left, AlignedBuffer<float> right)
+    {
+        Signal ret{ name, { std::move(left), std::move(right) }, {} };
+        ret.interleaved.reset(SIGNAL_SIZE * 2);
+        for(size_t i = 0; i < SIGNAL_SIZE; ++i)
+        {
+            ret.interleaved[i * 2] = ret.channels[0][i];
+            ret.interleaved[(i * 2) + 1] = ret.channels[1][i];
+        }
+        return ret;
+    }
+
+    AlignedBuffer<float> make_silence()
+    {
+        AlignedBuffer<float> ret;
+        ret.reset(SIGNAL_SIZE);
+        std::fill(ret.get(), ret.get() + SIGNAL_SIZE, 0.0f);
+        return ret;
+    }
+
+    // one line per signal, mode and size, tiers in cpu_tiers() order
+    void print(const std::string& label, const std::vector<Tier>& tiers, const std::vector<double>& ns)
+    {
+        std::printf("%s:", label.c_str());
+        for(size_t i = 0; i < tiers.size(); ++i)
+            std::printf("%s %s %.0f ns", (i == 0) ? "" : ",", tiers[i].name, ns[i]);
+        std::printf("\n");
+    }
+
+    // a stereo spectrum like tick_spectrum(): window from the capture, one batched transform,
+    // smoothed bins, dBFS, then a curve of width points or bars and their pixel heights
+    class SpectrumTick
+    {
+    public:
+        SpectrumTick(size_t fft_size, size_t width, bool bars)
+            : m_fft_size(fft_size), m_bins(fft_size / 2), m_width(bars ? (size_t)BARS : width), m_bars(bars)
+        {
+            m_input.reset(fft_size * 2);
+            m_output.reset(fft_size * 2);
+            const auto n = (int)fft_size;
+            m_plan = fftwf_plan_many_dft_r2c(1, &n, 2, m_input.get(), nullptr, 1, n, m_output.get(), nullptr, 1, n, FFTW_ESTIMATE);
+
+            m_window.reset(fft_size);
+            auto sum = 0.0f;
+            for(size_t i = 0; i < fft_size; ++i)
+            {
+                m_window[i] = 0.5f - (0.5f * std::cos(6.2831853f * (float)i / (float)fft_size));
+                sum += m_window[i];
+            }
+            m_gains.reset(m_bins);
+            std::fill(m_gains.get(), m_gains.get() + m_bins, 2.0f / sum);
+            for(auto channel = 0; channel < 2; ++channel)
+            {
+                m_history[channel].reset(m_bins);
+                m_decibels[channel].reset(m_bins);
+                m_heights[channel].reset(m_width + 1);
+                std::fill(m_history[channel].get(), m_history[channel].get() + m_bins, 0.0f);
+                std::fill(m_decibels[channel].get(), m_decibels[channel].get() + m_bins, DB_MIN);
+            }
+
+            // the display reads bins 20 Hz to 20 kHz at 48 kHz
+            const auto hz = 24000.0f / (float)m_bins;
+            m_first_bin = std::min((size_t)(20.0f / hz), m_bins) & ~(size_t)15;
+            m_last_bin = std::min(((size_t)(20000.0f / hz) + 15) & ~(size_t)15, m_bins);
+            if(bars)
+                m_bank = make_filterbank(BandScale::MEL, (size_t)BARS, 20.0f, 20000.0f, hz, m_bins);
+            else
+            {
+                m_points.resize(width);
+                for(size_t i = 0; i < width; ++i)
+                    m_points[i] = log_interp(20.0f / hz, 20000.0f / hz, (float)i / (float)(width - 1));
+                m_kernel = make_lanczos_kernel(m_points, 4);
+                set_interior(m_kernel, m_points, m_bins);
+                m_gauss = make_gauss_kernel(1.0f);
+                m_curve.reset(width);
+            }
+        }
+        ~SpectrumTick() { fftwf_destroy_plan(m_plan); }
+        SpectrumTick(const SpectrumTick&) = delete;
+        SpectrumTick& operator=(const SpectrumTick&) = delete;
+
+        void select(const DSPKernels& kernels)
+        {
+            m_kernels = &kernels;
+            SpectrumVariant variant;
+            variant.smooth = true;
+            variant.pair = true;
+            m_bins_fn = kernels.bins(variant);
+            SpectrumPostVariant post;
+            post.stereo = true;
+            m_post_fn = kernels.post(post);
+        }
+
+        void operator()(const Signal& signal)
+        {
+            const auto& kernels = *m_kernels;
+            const auto pos = m_pos;
+            m_pos = (m_pos + TICK_FRAMES) % (SIGNAL_SIZE - m_fft_size);
+
+            bool transform[2] = {};
+            for(auto channel = 0; channel < 2; ++channel)
+            {
+                const auto silent = !kernels.window(&m_input[channel * m_fft_size], signal.channels[channel].get() + pos, m_window.get(), m_fft_size);
+                transform[channel] = !silent || !kernels.below(m_decibels[channel].get(), m_first_bin, m_last_bin, FLOOR - 10.0f);
+            }
+            if(!transform[0] && !transform[1])
+                return; // silence that has already decayed, the display keeps its heights
+            fftwf_execute(m_plan);
+
+            SpectrumBins bins;
+            bins.gains = m_gains.get();
+            bins.first_bin = m_first_bin;
+            bins.last_bin = m_last_bin;
+            bins.gravity = 0.65f;
+            SpectrumPost post;
+            post.first_bin = m_first_bin;
+            post.last_bin = m_last_bin;
+            post.scale[0] = post.scale[1] = 1.0f;
+            post.db_min = DB_MIN;
+            for(auto channel = 0; channel < 2; ++channel)
+            {
+                bins.in[channel] = &m_output[channel * m_fft_size];
+                bins.history[channel] = m_history[channel].get();
+                bins.out[channel] = m_decibels[channel].get();
+                post.out[channel] = m_decibels[channel].get();
+            }
+            m_bins_fn(bins);
+            m_post_fn(post);
+
+            for(auto channel = 0; channel < 2; ++channel)
+            {
+                const std::span<float> heights(m_heights[channel].get(), m_width);
+                if(m_bars)
+                    kernels.filterbank(m_decibels[channel].get(), m_bank, heights);
+                else
+                {
+                    kernels.interp(m_decibels[channel].get(), m_bins, m_points, m_kernel, std::span<float>(m_curve.get(), m_width));
+                    kernels.filter(m_curve.get(), m_width, m_gauss, heights);
+                }
+                float miny;
+                kernels.heights(heights.data(), m_width, CEILING, CEILING - FLOOR, 0.0f, 1080.0f, miny);
+            }
+        }
+
+    private:
+        const size_t m_fft_size;
+        const size_t m_bins;
+        const size_t m_width;
+        const bool m_bars;
+        size_t m_pos = 0;
+        size_t m_first_bin = 0;
+        size_t m_last_bin = 0;
+        fftwf_plan m_plan = nullptr;
+        const DSPKernels *m_kernels = nullptr;
+        SpectrumBinsFn m_bins_fn = nullptr;
+        SpectrumPostFn m_post_fn = nullptr;
+        AlignedBuffer<float> m_input;
+        AlignedBuffer<fftwf_complex> m_output;
+        AlignedBuffer<float> m_window;
+        AlignedBuffer<float> m_gains;
+        AlignedBuffer<float> m_history[2];
+        AlignedBuffer<float> m_decibels[2];
+        AlignedBuffer<float> m_heights[2];
+        AlignedBuffer<float> m_curve;
+        std::vector<float> m_points;
+        Kernel<float> m_kernel;
+        Kernel<float> m_gauss;
+        Filterbank<float> m_bank;
+    };
+
+    // a waveform of width columns over one second, each tick adds the columns of its audio
+    // peak of every column, then dBFS of the new run of the ring
+    class WaveformTick
+    {
+    public:
+        explicit WaveformTick(size_t width)
+            : m_width(width), m_column(std::max<size_t>(48000 / width, 1))
+        {
+            for(auto& values : m_values)
+            {
+                values.reset(width);
+                std::fill(values.get(), values.get() + width, 0.0f);
+            }
+        }
+
+        void operator()(const DSPKernels& kernels, const Signal& signal)
+        {
+            const auto columns = std::max<size_t>(TICK_FRAMES / m_column, 1);
+            const auto head = m_head;
+            for(size_t i = 0; i < columns; ++i)
+            {
+                const auto src = m_pos + (i * m_column);
+                for(auto channel = 0; channel < 2; ++channel)
+                    m_values[channel][(head + i) % m_width] = kernels.waveform_peak(signal.channels[channel].get() + src, m_column);
+            }
+            m_pos = (m_pos + (columns * m_column)) % (SIGNAL_SIZE - TICK_FRAMES - m_column);
+            m_head = (head + columns) % m_width;
+
+            // the run wraps around the ring in two parts
+            WaveformPost post;
+            post.values[0] = m_values[0].get();
+            post.values[1] = m_values[1].get();
+            post.db_min = DB_MIN;
+            post.stereo = true;
+            post.pos = head;
+            post.count = std::min(columns, m_width - head);
+            kernels.waveform_post(post);
+            if(post.count < columns)
+            {
+                post.pos = 0;
+                post.count = columns - post.count;
+                kernels.waveform_post(post);
+            }
+        }
+
+    private:
+        const size_t m_width;
+        const size_t m_column;  // samples per column
+        size_t m_head = 0;
+        size_t m_pos = 0;
+        AlignedBuffer<float> m_values[2];
+    };
+
+    // small transforms of several stereo sources, each through the shared plan on its own buffers as the plugin runs them,
+    // against one plan over all of them, the best case for batching across sources: the sources window straight into
+    // the batch and read their bins straight out of it, nothing is gathered or scattered
+    void bench_batching(const Signal& signal)
+    {
+        constexpr int sources = 8;
+        constexpr int sizes[] = { 256, 512, 800, 1024, 2048 };
+        for(auto n : sizes)
+        {
+            const auto count = (size_t)n * 2 * sources;
+            AlignedBuffer<float> input;
+            AlignedBuffer<fftwf_complex> output;
+            input.reset(count);
+            output.reset(count);
+            const auto single = fftwf_plan_many_dft_r2c(1, &n, 2, input.get(), nullptr, 1, n, output.get(), nullptr, 1, n, FFTW_MEASURE);
+            const auto batch = fftwf_plan_many_dft_r2c(1, &n, 2 * sources, input.get(), nullptr, 1, n, output.get(), nullptr, 1, n, FFTW_MEASURE);
+            for(auto i = 0; i < 2 * sources; ++i)
+                std::copy_n(signal.channels[i % 2].get() + ((size_t)i * TICK_FRAMES), n, input.get() + ((size_t)i * n));
+
+            const auto separate = time_call([&] {
+                for(auto i = 0; i < sources; ++i)
+                    fftwf_execute_dft_r2c(single, input.get() + ((size_t)i * 2 * n), output.get() + ((size_t)i * 2 * n));
+                });
+            const auto batched = time_call([&] { fftwf_execute(batch); });
+            std::printf("batching %s %d stereo sources fft %d: per source %.0f ns, batched %.0f ns\n", signal.name, sources, n, separate, batched);
+            fftwf_destroy_plan(single);
+            fftwf_destroy_plan(batch);
+        }
+    }
+
+    // construction, done by update() whenever the layout changes, then every filter kernel per tier
+    void bench_filters(const std::vector<Tier>& tiers, const std::vector<DSPKernels>& kernels)
+    {
+        const auto spectrum = make_spectrum();
+        const auto samples = spectrum.get();
+        const auto sz = spectrum.size();
+        constexpr size_t widths[] = { 256, 640, 1280, 1920, 2560, 3840 };
+        constexpr int radii[] = { 1, 2, 4, 8 };
+        constexpr int bar_counts[] = { 8, 16, 32, 64, 128, 256 };
+
+        for(auto radius : radii)
+        {
+            const auto points = make_indices(1920);
+            const auto ns_gauss = time_call([&] { auto kernel = make_gauss_kernel((float)radius / 3.0f); });
+            const auto ns_lanczos = time_call([&] { auto kernel = make_lanczos_kernel(points, radius); });
+            std::printf("construction radius %d: make_gauss_kernel %.0f ns, make_lanczos_kernel (1920 points) %.0f ns\n", radius, ns_gauss, ns_lanczos);
+        }
+        std::printf("construction: make_catrom_kernel %.0f ns\n", time_call([] { auto kernel = make_catrom_kernel(0.5f); }));
+
+        AlignedBuffer<float> out;
+        out.reset(widths[std::size(widths) - 1]);
+        std::vector<double> ns(tiers.size());
+
+        // smoothing over the interpolated graph, radius = ceil(3 sigma)
+        AlignedBuffer<float> curve;
+        curve.reset(widths[std::size(widths) - 1]);
+        for(size_t i = 0; i < curve.size(); ++i)
+            curve[i] = samples[i % sz];
+        for(auto width : widths)
+        {
+            for(auto radius : radii)
+            {
+                const auto kernel = make_gauss_kernel((float)radius / 3.0f);
+                const std::span<float> span(out.get(), width);
+                for(size_t i = 0; i < tiers.size(); ++i)
+                    ns[i] = time_call([&] { kernels[i].filter(curve.get(), width, kernel, span); });
+                print("apply_filter width " + std::to_string(width) + " radius " + std::to_string(radius), tiers, ns);
+            }
+        }
+
+        // curve interpolation, lanczos is 8 taps and catmull-rom 4, the two specialized SIMD paths
+        for(auto width : widths)
+        {
+            const auto points = make_indices(width);
+            const std::span<float> span(out.get(), width);
+            for(auto lanczos : { true, false })
+            {
+                auto kernel = lanczos ? make_lanczos_kernel(points, 4) : make_catrom_kernel(0.5f);
+                set_interior(kernel, points, sz);
+                for(size_t i = 0; i < tiers.size(); ++i)
+                    ns[i] = time_call([&] { kernels[i].interp(samples, sz, points, kernel, span); });
+                print(std::string("curve ") + (lanczos ? "lanczos" : "catmull-rom") + " width " + std::to_string(width), tiers, ns);
+            }
+        }
+
+        // bar interpolation over every bin of each band, the generic tier has only the portable loop
+        // the running sum variant is portable, it's timed once after the tiers
+        std::vector<double> prefix;
+        for(auto bars : bar_counts)
+        {
+            std::vector<int> band_widths;
+            std::vector<float> bins;
+            make_bands((size_t)bars, band_widths, bins);
+            const std::span<float> span(out.get(), (size_t)bars);
+            for(auto lanczos : { true, false })
+            {
+                auto kernel = lanczos ? make_lanczos_kernel(bins, 4) : make_catrom_kernel(0.5f);
+                set_interior(kernel, bins, sz);
+                for(size_t i = 0; i < tiers.size(); ++i)
+                {
+                    const auto bands = kernels[i].bands;
+                    if(bands != nullptr)
+                        ns[i] = time_call([&] { bands(samples, sz, band_widths, bins, kernel, span); });
+                    else
+                        ns[i] = time_call([&] { apply_interp_filter(samples, sz, band_widths, bins, kernel, span); });
+                }
+                const auto label = std::string("bars ") + (lanczos ? "lanczos" : "catmull-rom") + " count " + std::to_string(bars);
+                print(label, tiers, ns);
+                std::printf("%s: prefix %.0f ns\n", label.c_str(), time_call([&] { apply_interp_filter_prefix(samples, sz, band_widths, bins, kernel, prefix, span); }));
+            }
+
+            const auto bank = make_filterbank(BandScale::MEL, (size_t)bars, 20.0f, 20000.0f, 24000.0f / (float)sz, sz);
+            for(size_t i = 0; i < tiers.size(); ++i)
+                ns[i] = time_call([&] { kernels[i].filterbank(samples, bank, span); });
+            print("bars mel filterbank count " + std::to_string(bars), tiers, ns);
+        }
+    }
+}
+
+int main()
+{
+    const auto tiers = cpu_tiers();
+    std::vector<DSPKernels> kernels;
+    for(const auto& tier : tiers)
+        kernels.push_back(DSPKernels::resolve(tier.levels));
+
+    const Signal signals[] = {
+        make_input("sine sweep", make_sweep(SIGNAL_SIZE), make_sweep(SIGNAL_SIZE)),
+        make_input("pink noise", make_pink(SIGNAL_SIZE, 0x0badf00du), make_pink(SIGNAL_SIZE, 0x5eed1234u)),
+        make_input("silence", make_silence(), make_silence())
+    };
+    constexpr size_t fft_sizes[] = { 512, 1024, 2048, 4096, 8192, 16384 };
+    constexpr size_t widths[] = { 640, 1920, 3840 };
+
+    std::vector<double> ns(tiers.size());
+    for(const auto& signal : signals)
+    {
+        // spectrum curves across transform sizes and graph widths, and bars across transform sizes
+        for(auto fft_size : fft_sizes)
+        {
+            for(auto width : widths)
+            {
+                SpectrumTick tick(fft_size, width, false);
+                for(size_t i = 0; i < tiers.size(); ++i)
+                {
+                    tick.select(kernels[i]);
+                    ns[i] = time_call([&] { tick(signal); });
+                }
+                print(std::string("spectrum curve ") + signal.name + " fft " + std::to_string(fft_size) + " width " + std::to_string(width), tiers, ns);
+            }
+            SpectrumTick tick(fft_size, 0, true);
+            for(size_t i = 0; i < tiers.size(); ++i)
+            {
+                tick.select(kernels[i]);
+                ns[i] = time_call([&] { tick(signal); });
+            }
+            print(std::string("spectrum bars ") + signal.name + " fft " + std::to_string(fft_size) + " count " + std::to_string(BARS), tiers, ns);
+        }
+
+        // meter, the peak and power of a tick of interleaved stereo frames
+        {
+            size_t pos = 0;
+            float peaks[2], squares[2];
+            for(size_t i = 0; i < tiers.size(); ++i)
+            {
+                ns[i] = time_call([&] {
+                    kernels[i].meter_reduce(signal.interleaved.get() + (pos * 2), TICK_FRAMES, 2, peaks, squares);
+                    pos = (pos + TICK_FRAMES) % (SIGNAL_SIZE - TICK_FRAMES);
+                    });
+            }
+            print(std::string("meter ") + signal.name, tiers, ns);
+        }
+
+        // waveform across graph widths
+        for(auto width : widths)
+        {
+            WaveformTick tick(width);
+            for(size_t i = 0; i < tiers.size(); ++i)
+                ns[i] = time_call([&] { tick(kernels[i], signal); });
+            print(std::string("waveform ") + signal.name + " width " + std::to_string(width), tiers, ns);
+        }
+    }
+    bench_batching(signals[1]);
+
+    bench_filters(tiers, kernels);
+    return 0;
+}